@@ -353,8 +353,13 @@ int main( void )
         }
         else
         {
-            /* go in low power */
-            hal_mcu_set_sleep_for_ms( sleep_time_ms );
+            /* go in low power, unless a radio event occurred during the modem runtime */
+            hal_mcu_disable_irq( );
+            if( smtc_modem_is_irq_flag_pending( ) == false )
+            {
+                hal_mcu_set_sleep_for_ms( sleep_time_ms );
+            }
+            hal_mcu_enable_irq( );
 
             if( tracker_ctx.airplane_mode == false )
             {
@@ -95,6 +95,10 @@
     ( FLASH_END_ADDR_OF_PAGE(                \
         FLASH_USER_INTERNAL_LOG_CTX_START_PAGE ) ) /* End @ of user tracker internal log ctx Flash area */
 
+#define FLASH_USER_INTERNAL_LOG_CTX_SPARE_PAGE ( 201 )
+
+#define FLASH_USER_INTERNAL_LOG_CTX_SPARE_ADDR ADDR_FLASH_PAGE( FLASH_USER_INTERNAL_LOG_CTX_SPARE_PAGE )
+
 #define FLASH_USER_TRACKER_CTX_START_PAGE ( 196 )
 
 #define FLASH_USER_TRACKER_CTX_START_ADDR ADDR_FLASH_PAGE( FLASH_USER_TRACKER_CTX_START_PAGE )
@@ -109,9 +113,46 @@
 #define FLASH_USER_MODEME_TRACKER_REGION_OFFSET ( 69 )
 
 #define TRACKER_CONTEXT_SIZE 128
-#define INTERNAL_LOG_CONTEXT_SIZE 32
 #define INTERNAL_LOG_SCAN_BUFFER 256
 
+/*!
+ * @brief Size of an internal log context record, a multiple of the flash double word. The records are appended to the
+ * internal log context page, the latest one with a valid CRC is the context. When the page is full, the next record
+ * goes in the spare page, and the full page is erased once it is written.
+ */
+#define INTERNAL_LOG_CONTEXT_SIZE 24
+#define INTERNAL_LOG_CONTEXT_CRC_INDEX 19
+
+/*!
+ * @brief Sequence number of the page of an internal log context record, followed by its complement. It grows by one
+ * at each page change, so that the newer page is known after a reset during a change. The records of the previous
+ * versions have no sequence number, these two bytes being erased.
+ */
+#define INTERNAL_LOG_CONTEXT_SEQUENCE_INDEX 20
+#define INTERNAL_LOG_CONTEXT_NO_SEQUENCE 0xFFFF
+
+/*!
+ * @brief Number of scans stored between two internal log context records. The scans stored after the latest record
+ * are found again, through their next scan address, when the internal log context is restored.
+ */
+#ifndef INTERNAL_LOG_CONTEXT_STORE_PERIOD
+#define INTERNAL_LOG_CONTEXT_STORE_PERIOD 8
+#endif
+
+/*!
+ * @brief Number of entries of the internal log index
+ */
+#ifndef INTERNAL_LOG_INDEX_SIZE
+#define INTERNAL_LOG_INDEX_SIZE 64
+#endif
+
+/*!
+ * @brief Initial number of scans between two entries of the internal log index, doubled each time the index is full
+ */
+#ifndef INTERNAL_LOG_INDEX_STEP
+#define INTERNAL_LOG_INDEX_STEP 8
+#endif
+
 /*!
  * @brief Tracker parameter limits
  */
@@ -125,6 +166,30 @@
  * --- PRIVATE TYPES -----------------------------------------------------------
  */
 
+/*!
+ * @brief Sparse index of the internal log: entry i points on the scan i * step + 1
+ */
+typedef struct
+{
+    tracker_internal_log_iterator_t entries[INTERNAL_LOG_INDEX_SIZE];
+    uint16_t                        nb_entries;
+    uint16_t                        step;
+    tracker_internal_log_iterator_t end;  //!< Points after the last indexed scan
+} tracker_internal_log_index_t;
+
+/*!
+ * @brief Internal log context records found in a page
+ */
+typedef struct
+{
+    uint32_t addr;                               //!< Flash address of the page
+    uint8_t  record[INTERNAL_LOG_CONTEXT_SIZE];  //!< Latest valid record
+    bool     record_found;                       //!< The page holds a valid record
+    uint16_t sequence;    //!< Sequence number of the latest valid record, or INTERNAL_LOG_CONTEXT_NO_SEQUENCE
+    uint16_t end_offset;  //!< Offset of the next record, the page size if the page cannot take one more
+    bool     is_erased;   //!< No byte of the records is written
+} tracker_internal_log_ctx_page_t;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE VARIABLES -------------------------------------------------------
@@ -175,6 +240,36 @@ uint32_t internal_log_scan_index = 1;
  */
 bool internal_log_tracker_settings_sent = false;
 
+/*!
+ * @brief Index of the scans stored in the internal log
+ */
+static tracker_internal_log_index_t internal_log_index;
+
+/*!
+ * @brief Iterator on the next scan sent during the read internal log command
+ */
+static tracker_internal_log_iterator_t internal_log_iterator;
+
+/*!
+ * @brief Internal log context page taking the records, the other page is erased
+ */
+static uint32_t internal_log_ctx_page_addr = FLASH_USER_INTERNAL_LOG_CTX_START_ADDR;
+
+/*!
+ * @brief Offset of the next internal log context record in the internal log context page
+ */
+static uint16_t internal_log_ctx_offset;
+
+/*!
+ * @brief Sequence number of the internal log context page
+ */
+static uint8_t internal_log_ctx_sequence;
+
+/*!
+ * @brief Number of scans in the latest internal log context record
+ */
+static uint16_t internal_log_ctx_nb_scan;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
@@ -225,6 +320,42 @@ static uint8_t tracker_get_remaining_memory_space( void );
  */
 static void tracker_store_internal_log_ctx( void );
 
+/*!
+ * @brief Read the latest internal log context record from the flash memory, and find where the next one goes. The
+ * other page is erased if a reset cut a page change.
+ *
+ * @param [out] ctx_buf buffer of INTERNAL_LOG_CONTEXT_SIZE bytes where is stored the latest record with a valid CRC,
+ * or the first record of the page if none is valid
+ */
+static void tracker_read_internal_log_ctx( uint8_t* ctx_buf );
+
+/*!
+ * @brief Read the internal log context records of a page
+ *
+ * @param [in] page_addr flash address of the page
+ * @param [out] page records found in the page
+ */
+static void tracker_read_internal_log_ctx_page( const uint32_t page_addr, tracker_internal_log_ctx_page_t* page );
+
+/*!
+ * @brief Erase both internal log context pages
+ */
+static void tracker_erase_internal_log_ctx( void );
+
+/*!
+ * @brief Add to the internal log context the scans stored after its latest record
+ */
+static void tracker_recover_internal_log_scans( void );
+
+/*!
+ * @brief Clear the double words of the scans cut by a reset: once later scans are stored, the cut length of one of
+ * them could otherwise reach the end of a later scan, and read the scans in between as a single one
+ *
+ * @param [in] start_addr flash address of the first scan cut
+ * @param [in] end_addr flash address following the scans cut
+ */
+static void tracker_clear_internal_log_cut_scans( const uint32_t start_addr, const uint32_t end_addr );
+
 /*!
  * @brief Restore the internal log of one given scan_number from the flash memory.
  *
@@ -241,6 +372,48 @@ static void tracker_get_one_scan_from_internal_log( uint16_t scan_number, uint8_
  */
 static void tracker_erase_internal_log( void );
 
+/*!
+ * @brief Build the internal log index from the scans stored in the flash memory
+ */
+static void tracker_build_internal_log_index( void );
+
+/*!
+ * @brief Add a scan at the end of the internal log index
+ *
+ * @param [in] scan_addr flash address of the scan
+ * @param [in] next_scan_addr flash address of the following scan
+ * @param [in] nb_jobs number of jobs stored in the scan
+ */
+static void tracker_add_scan_to_internal_log_index( const uint32_t scan_addr, const uint32_t next_scan_addr,
+                                                    const uint8_t nb_jobs );
+
+/*!
+ * @brief Read one scan from the internal log flash memory. A scan is complete when its next scan address, written
+ * last, follows it: the scans cut by a reset are skipped, up to the first double word which is erased or holds a
+ * complete scan, as their length may be cut too.
+ *
+ * @param [in,out] scan_addr flash address of the scan, moved after the scans cut by a reset
+ * @param [out] scan_buf buffer where is stored the scan, without its length field, of at least 8 bytes
+ * @param [in] scan_buf_len length of the buffer where is stored the scan
+ * @param [out] nb_jobs number of jobs stored in the scan
+ *
+ * @returns flash address of the following scan, 0 if no scan is stored at scan_addr
+ */
+static uint32_t tracker_read_internal_log_scan( uint32_t* scan_addr, uint8_t* scan_buf, const uint16_t scan_buf_len,
+                                                uint8_t* nb_jobs );
+
+/*!
+ * @brief Parse the elements of a scan of the internal log
+ *
+ * @param [in] scan_buf scan without its length field
+ * @param [in] scan_len length of the scan, including its length field
+ * @param [out] next_scan_addr flash address of the following scan, left unchanged if the scan does not end with it
+ *
+ * @returns number of jobs stored in the scan
+ */
+static uint8_t tracker_parse_internal_log_scan( const uint8_t* scan_buf, const uint16_t scan_len,
+                                                uint32_t* next_scan_addr );
+
 /*!
  * @brief Erase full user memory flash between end of the app and the contexts area
  */
@@ -281,7 +454,7 @@ static void tracker_check_app_ctx( void );
 tracker_return_status_t tracker_init_internal_log_ctx( void )
 {
     uint8_t ctx_buf[INTERNAL_LOG_CONTEXT_SIZE];
-    hal_flash_read_buffer( FLASH_USER_INTERNAL_LOG_CTX_START_ADDR, ctx_buf, INTERNAL_LOG_CONTEXT_SIZE );
+    tracker_read_internal_log_ctx( ctx_buf );
     tracker_ctx.internal_log_empty = ctx_buf[0];
 
     if( tracker_ctx.internal_log_empty == FLASH_BYTE_EMPTY_CONTENT )
@@ -294,6 +467,8 @@ tracker_return_status_t tracker_init_internal_log_ctx( void )
         tracker_ctx.flash_addr_end        = FLASH_USER_END_ADDR;
         tracker_ctx.flash_remaining_space = tracker_ctx.flash_addr_end - tracker_ctx.flash_addr_current;
         tracker_store_internal_log_ctx( );
+        tracker_recover_internal_log_scans( );
+        tracker_build_internal_log_index( );
     }
     else
     {
@@ -307,7 +482,7 @@ tracker_return_status_t tracker_restore_internal_log_ctx( void )
     uint8_t ctx_buf[INTERNAL_LOG_CONTEXT_SIZE];
     uint8_t index = 0;
 
-    hal_flash_read_buffer( FLASH_USER_INTERNAL_LOG_CTX_START_ADDR, ctx_buf, INTERNAL_LOG_CONTEXT_SIZE );
+    tracker_read_internal_log_ctx( ctx_buf );
 
     tracker_ctx.internal_log_flush_request = false;
     tracker_ctx.internal_log_empty         = ctx_buf[0];
@@ -361,6 +536,10 @@ tracker_return_status_t tracker_restore_internal_log_ctx( void )
             return TRACKER_ERROR;
         }
 
+        internal_log_ctx_nb_scan = tracker_ctx.nb_scan;
+        tracker_recover_internal_log_scans( );
+        tracker_build_internal_log_index( );
+
         /* Internal log context */
         HAL_DBG_TRACE_MSG( "#Internal log context:\n" );
         HAL_DBG_TRACE_PRINTF( "#\tnb_scan : %d\n", tracker_ctx.nb_scan );
@@ -388,6 +567,60 @@ void tracker_reset_internal_log( void )
     }
 }
 
+tracker_return_status_t tracker_internal_log_iterator_init( tracker_internal_log_iterator_t* iterator,
+                                                            uint16_t                         scan_number )
+{
+    uint8_t  scan_buf[INTERNAL_LOG_SCAN_BUFFER];
+    uint16_t entry_index;
+
+    if( ( scan_number == 0 ) || ( scan_number >= internal_log_index.end.scan_number ) )
+    {
+        return TRACKER_ERROR;
+    }
+
+    /* Start from the closest entry before the scan, then read the scans in between */
+    entry_index = ( scan_number - 1 ) / internal_log_index.step;
+    if( entry_index >= internal_log_index.nb_entries )
+    {
+        entry_index = internal_log_index.nb_entries - 1;
+    }
+    *iterator = internal_log_index.entries[entry_index];
+
+    while( iterator->scan_number < scan_number )
+    {
+        if( tracker_internal_log_iterator_next( iterator, scan_buf, INTERNAL_LOG_SCAN_BUFFER ) != TRACKER_SUCCESS )
+        {
+            return TRACKER_ERROR;
+        }
+    }
+
+    return TRACKER_SUCCESS;
+}
+
+tracker_return_status_t tracker_internal_log_iterator_next( tracker_internal_log_iterator_t* iterator,
+                                                            uint8_t* scan_buf, const uint16_t scan_buf_len )
+{
+    uint32_t next_scan_addr;
+    uint8_t  nb_jobs = 0;
+
+    if( ( iterator->scan_number == 0 ) || ( iterator->scan_number >= internal_log_index.end.scan_number ) )
+    {
+        return TRACKER_ERROR;
+    }
+
+    next_scan_addr = tracker_read_internal_log_scan( &iterator->scan_addr, scan_buf, scan_buf_len, &nb_jobs );
+    if( next_scan_addr == 0 )
+    {
+        return TRACKER_ERROR;
+    }
+
+    iterator->job_counter += nb_jobs;
+    iterator->scan_addr = next_scan_addr;
+    iterator->scan_number++;
+
+    return TRACKER_SUCCESS;
+}
+
 tracker_return_status_t tracker_restore_app_ctx( void )
 {
     uint8_t  ctx_buf[TRACKER_CONTEXT_SIZE];
@@ -751,31 +984,26 @@ void tracker_store_gnss_in_internal_log( const gnss_mw_event_data_scan_done_t* g
 
 void tracker_restore_internal_log( void )
 {
-    uint8_t   scan_buf[INTERNAL_LOG_SCAN_BUFFER];
-    uint16_t  scan_buf_index    = 0;
-    uint8_t   nb_elements       = 0;
-    uint8_t   nb_elements_index = 0;
-    uint8_t   tag_element       = 0;
-    uint16_t  scan_len          = 0;
-    uint16_t  nb_scan_index     = 1;
-    uint16_t  scan_number;
-    uint32_t  next_scan_addr = tracker_ctx.flash_addr_start;
-    time_t    scan_timestamp = 0;
-    struct tm epoch_time;
-    uint32_t  job_counter = 0;
+    uint8_t                         scan_buf[INTERNAL_LOG_SCAN_BUFFER];
+    uint16_t                        scan_buf_index    = 0;
+    uint8_t                         nb_elements       = 0;
+    uint8_t                         nb_elements_index = 0;
+    uint8_t                         tag_element       = 0;
+    uint16_t                        scan_number;
+    tracker_internal_log_iterator_t iterator;
+    time_t                          scan_timestamp = 0;
+    struct tm                       epoch_time;
+    uint32_t                        job_counter = 0;
 
     tracker_print_device_settings( );
 
-    while( nb_scan_index <= tracker_ctx.nb_scan )
+    if( tracker_internal_log_iterator_init( &iterator, 1 ) != TRACKER_SUCCESS )
     {
-        /* read the scan lentgh */
-        hal_flash_read_buffer( next_scan_addr, scan_buf, 2 );
-        scan_len = scan_buf[0];
-        scan_len += ( uint32_t ) scan_buf[1] << 8;
-
-        /* read the rest of the scan */
-        hal_flash_read_buffer( next_scan_addr + 2, scan_buf, scan_len - 2 );
+        return;
+    }
 
+    while( tracker_internal_log_iterator_next( &iterator, scan_buf, INTERNAL_LOG_SCAN_BUFFER ) == TRACKER_SUCCESS )
+    {
         nb_elements = scan_buf[scan_buf_index++];
 
         /* Scan number */
@@ -883,14 +1111,6 @@ void tracker_restore_internal_log( void )
                 job_counter++;
                 break;
             }
-            case TAG_NEXT_SCAN:
-            {
-                next_scan_addr = scan_buf[scan_buf_index++];
-                next_scan_addr += ( uint16_t ) scan_buf[scan_buf_index++] << 8;
-                next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 16;
-                next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 24;
-                break;
-            }
             default:
             {
                 scan_buf_index += len;
@@ -899,7 +1119,6 @@ void tracker_restore_internal_log( void )
             }
             nb_elements_index++;
         }
-        nb_scan_index++;
         nb_elements_index = 0;
         scan_buf_index    = 0;  // reset the index;
     }
@@ -2379,6 +2598,7 @@ static void tracker_store_internal_log( uint8_t* buffer, uint8_t nb_variable_ele
     uint32_t next_scan_addr  = 0;
     uint8_t  read_buffer[256];
     bool     memory_flash_is_empty = true;
+    uint8_t  nb_jobs               = 0;
 
     /* Next scan addr */
     buffer[len++] = TAG_NEXT_SCAN;
@@ -2415,8 +2635,16 @@ static void tracker_store_internal_log( uint8_t* buffer, uint8_t nb_variable_ele
     if( memory_flash_is_empty == true )
     {
         hal_flash_write_buffer( tracker_ctx.flash_addr_current, buffer, len );
-        tracker_ctx.flash_addr_current = next_scan_addr;
-        tracker_store_internal_log_ctx( );
+        nb_jobs = tracker_parse_internal_log_scan( buffer + 2, len, &next_scan_addr );
+        tracker_add_scan_to_internal_log_index( tracker_ctx.flash_addr_current, next_scan_addr, nb_jobs );
+        tracker_ctx.flash_addr_current    = next_scan_addr;
+        tracker_ctx.flash_remaining_space = tracker_ctx.flash_addr_end - tracker_ctx.flash_addr_current;
+
+        /* The scans stored since the latest context record are found again at the context restoration */
+        if( ( uint16_t )( tracker_ctx.nb_scan - internal_log_ctx_nb_scan ) >= INTERNAL_LOG_CONTEXT_STORE_PERIOD )
+        {
+            tracker_store_internal_log_ctx( );
+        }
 
         HAL_DBG_TRACE_PRINTF( "Internal Log memory space remaining: %d %%\n\n", tracker_get_remaining_memory_space( ) );
     }
@@ -2433,17 +2661,26 @@ static uint8_t tracker_get_remaining_memory_space( void )
 
 static void tracker_store_internal_log_ctx( void )
 {
-    uint8_t ctx_buf[INTERNAL_LOG_CONTEXT_SIZE];
-    uint8_t index           = 0;
-    uint8_t tracker_ctx_crc = 0;
+    uint8_t  ctx_buf[INTERNAL_LOG_CONTEXT_SIZE];
+    uint8_t  index           = 0;
+    uint8_t  tracker_ctx_crc = 0;
+    uint32_t full_page_addr  = 0;
 
-    if( tracker_ctx.internal_log_empty != FLASH_BYTE_EMPTY_CONTENT )
+    if( tracker_ctx.internal_log_empty == FLASH_BYTE_EMPTY_CONTENT )
     {
-        hal_flash_erase_page( FLASH_USER_INTERNAL_LOG_CTX_START_ADDR, 1 );
+        tracker_ctx.internal_log_empty = 1;
     }
-    else
+
+    /* Page full: go on in the other page, which is erased, with the next sequence number. The full page is erased
+     * once the record is written, so that a reset in between keeps a valid record. */
+    if( ( uint32_t )( internal_log_ctx_offset + INTERNAL_LOG_CONTEXT_SIZE ) > ADDR_FLASH_PAGE_SIZE )
     {
-        tracker_ctx.internal_log_empty = 1;
+        full_page_addr             = internal_log_ctx_page_addr;
+        internal_log_ctx_page_addr = ( full_page_addr == FLASH_USER_INTERNAL_LOG_CTX_START_ADDR )
+                                         ? FLASH_USER_INTERNAL_LOG_CTX_SPARE_ADDR
+                                         : FLASH_USER_INTERNAL_LOG_CTX_START_ADDR;
+        internal_log_ctx_offset = 0;
+        internal_log_ctx_sequence++;
     }
 
     ctx_buf[index++] = tracker_ctx.internal_log_empty;
@@ -2477,83 +2714,229 @@ static void tracker_store_internal_log_ctx( void )
     tracker_ctx_crc  = tracker_ctx_compute_crc( 0xFF, ctx_buf, index );
     ctx_buf[index++] = tracker_ctx_crc;
 
-    hal_flash_write_buffer( FLASH_USER_INTERNAL_LOG_CTX_START_ADDR, ctx_buf, index );
+    ctx_buf[index++] = internal_log_ctx_sequence;
+    ctx_buf[index++] = internal_log_ctx_sequence ^ 0xFF;
+
+    memset( ctx_buf + index, FLASH_BYTE_EMPTY_CONTENT, INTERNAL_LOG_CONTEXT_SIZE - index );
+
+    hal_flash_write_buffer( internal_log_ctx_page_addr + internal_log_ctx_offset, ctx_buf, INTERNAL_LOG_CONTEXT_SIZE );
+    internal_log_ctx_offset += INTERNAL_LOG_CONTEXT_SIZE;
+    internal_log_ctx_nb_scan = tracker_ctx.nb_scan;
+
+    if( full_page_addr != 0 )
+    {
+        hal_flash_erase_page( full_page_addr, 1 );
+    }
 }
 
-static void tracker_get_one_scan_from_internal_log( uint16_t scan_number, uint8_t* out_buffer,
-                                                    const uint16_t out_buffer_len, uint16_t* buffer_len )
+static void tracker_read_internal_log_ctx( uint8_t* ctx_buf )
 {
-    uint8_t   scan_buf[255];
-    uint16_t  scan_buf_index    = 0;
-    uint8_t   nb_elements       = 0;
-    uint8_t   nb_elements_index = 0;
-    uint8_t   tag_element       = 0;
-    uint16_t  scan_len          = 0;
-    uint16_t  nb_scan_index     = 1;
-    uint32_t  next_scan_addr    = tracker_ctx.flash_addr_start;
-    time_t    scan_timestamp    = 0;
-    struct tm epoch_time;
-    uint32_t  job_counter = 0;
+    tracker_internal_log_ctx_page_t  pages[2];
+    tracker_internal_log_ctx_page_t* active_page;
+    tracker_internal_log_ctx_page_t* other_page;
+
+    tracker_read_internal_log_ctx_page( FLASH_USER_INTERNAL_LOG_CTX_START_ADDR, &pages[0] );
+    tracker_read_internal_log_ctx_page( FLASH_USER_INTERNAL_LOG_CTX_SPARE_ADDR, &pages[1] );
+
+    /* Both pages hold records after a reset during a page change: the newer sequence number wins. A page without
+     * sequence number was written by a previous version, before any page change. */
+    if( ( pages[1].record_found == true ) &&
+        ( ( pages[0].record_found == false ) ||
+          ( ( pages[1].sequence != INTERNAL_LOG_CONTEXT_NO_SEQUENCE ) &&
+            ( ( pages[0].sequence == INTERNAL_LOG_CONTEXT_NO_SEQUENCE ) ||
+              ( ( int8_t )( pages[1].sequence - pages[0].sequence ) > 0 ) ) ) ) )
+    {
+        active_page = &pages[1];
+        other_page  = &pages[0];
+    }
+    else
+    {
+        active_page = &pages[0];
+        other_page  = &pages[1];
+    }
 
-    *buffer_len = 0;
+    if( active_page->record_found == true )
+    {
+        memcpy( ctx_buf, active_page->record, INTERNAL_LOG_CONTEXT_SIZE );
+    }
+    else
+    {
+        hal_flash_read_buffer( active_page->addr, ctx_buf, INTERNAL_LOG_CONTEXT_SIZE );
+        if( active_page->is_erased == false )
+        {
+            HAL_DBG_TRACE_WARNING( "No valid internal log context record\n" );
+        }
+    }
+
+    internal_log_ctx_page_addr = active_page->addr;
+    internal_log_ctx_offset    = active_page->end_offset;
+    internal_log_ctx_sequence =
+        ( active_page->sequence == INTERNAL_LOG_CONTEXT_NO_SEQUENCE ) ? 0 : ( uint8_t ) active_page->sequence;
 
-    /* Retrieve the scan_number flash address */
-    while( nb_scan_index <= scan_number )
+    /* The other page takes the records at the next page change */
+    if( other_page->is_erased == false )
     {
-        /* read the scan lentgh */
-        hal_flash_read_buffer( next_scan_addr, scan_buf, 2 );
-        scan_len = scan_buf[0];
-        scan_len += ( uint32_t ) scan_buf[1] << 8;
+        hal_flash_erase_page( other_page->addr, 1 );
+    }
+}
 
-        hal_flash_read_buffer( next_scan_addr + 2, scan_buf, scan_len - 2 );
+static void tracker_read_internal_log_ctx_page( const uint32_t page_addr, tracker_internal_log_ctx_page_t* page )
+{
+    uint8_t record_buf[INTERNAL_LOG_CONTEXT_SIZE];
+    bool    end_found = false;
 
-        nb_elements = scan_buf[scan_buf_index++];
+    page->addr         = page_addr;
+    page->record_found = false;
+    page->sequence     = INTERNAL_LOG_CONTEXT_NO_SEQUENCE;
+    page->end_offset   = ADDR_FLASH_PAGE_SIZE;
+    page->is_erased    = true;
 
-        scan_buf_index += 2;  // element which are always stored
+    for( uint16_t offset = 0; ( uint32_t )( offset + INTERNAL_LOG_CONTEXT_SIZE ) <= ADDR_FLASH_PAGE_SIZE;
+         offset += INTERNAL_LOG_CONTEXT_SIZE )
+    {
+        bool     record_is_empty = true;
+        uint16_t sequence        = INTERNAL_LOG_CONTEXT_NO_SEQUENCE;
 
-        while( nb_elements_index < nb_elements )
-        {
-            uint8_t len = 0;
-            tag_element = scan_buf[scan_buf_index++];  // get the element
-            len         = scan_buf[scan_buf_index++];  // get the size element
+        hal_flash_read_buffer( page_addr + offset, record_buf, INTERNAL_LOG_CONTEXT_SIZE );
 
-            switch( tag_element )
-            {
-            case TAG_GNSS_PATCH:
-            case TAG_GNSS_PCB:
+        for( uint8_t i = 0; i < INTERNAL_LOG_CONTEXT_SIZE; i++ )
+        {
+            if( record_buf[i] != FLASH_BYTE_EMPTY_CONTENT )
             {
-                uint8_t last_scan = scan_buf[scan_buf_index + 6];
-                if( last_scan == 1 )
-                {
-                    job_counter++;
-                }
-                scan_buf_index += len;
+                record_is_empty = false;
                 break;
             }
-            case TAG_WIFI:
-            {
-                job_counter++;
-                scan_buf_index += len;
-                break;
-            }
-            case TAG_NEXT_SCAN:
+        }
+
+        /* The records are appended: the first erased one ends the page */
+        if( record_is_empty == true )
+        {
+            if( end_found == false )
             {
-                next_scan_addr = scan_buf[scan_buf_index++];
-                next_scan_addr += ( uint16_t ) scan_buf[scan_buf_index++] << 8;
-                next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 16;
-                next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 24;
-                break;
+                end_found        = true;
+                page->end_offset = offset;
             }
-            default:
-                scan_buf_index += len;
-                break;
-            }
-            nb_elements_index++;
+            continue;
         }
-        nb_scan_index++;
-        nb_elements_index = 0;
-        scan_buf_index    = 0;  // reset the index;
+        page->is_erased = false;
+
+        /* Bytes written after the end, as left by an erase cut by a reset: no record can be appended any more */
+        if( end_found == true )
+        {
+            page->end_offset = ADDR_FLASH_PAGE_SIZE;
+            break;
+        }
+
+        /* A record cut by a reset has a wrong CRC or sequence number and is skipped */
+        if( ( record_buf[0] == FLASH_BYTE_EMPTY_CONTENT ) ||
+            ( record_buf[INTERNAL_LOG_CONTEXT_CRC_INDEX] !=
+              tracker_ctx_compute_crc( 0xFF, record_buf, INTERNAL_LOG_CONTEXT_CRC_INDEX ) ) )
+        {
+            continue;
+        }
+        if( ( record_buf[INTERNAL_LOG_CONTEXT_SEQUENCE_INDEX] ^ record_buf[INTERNAL_LOG_CONTEXT_SEQUENCE_INDEX + 1] ) ==
+            0xFF )
+        {
+            sequence = record_buf[INTERNAL_LOG_CONTEXT_SEQUENCE_INDEX];
+        }
+        else if( ( record_buf[INTERNAL_LOG_CONTEXT_SEQUENCE_INDEX] != FLASH_BYTE_EMPTY_CONTENT ) ||
+                 ( record_buf[INTERNAL_LOG_CONTEXT_SEQUENCE_INDEX + 1] != FLASH_BYTE_EMPTY_CONTENT ) )
+        {
+            continue;
+        }
+
+        /* Once a record has a sequence number, a record without one can only be a cut record */
+        if( ( sequence == INTERNAL_LOG_CONTEXT_NO_SEQUENCE ) && ( page->sequence != INTERNAL_LOG_CONTEXT_NO_SEQUENCE ) )
+        {
+            continue;
+        }
+        memcpy( page->record, record_buf, INTERNAL_LOG_CONTEXT_SIZE );
+        page->record_found = true;
+        page->sequence     = sequence;
+    }
+}
+
+static void tracker_recover_internal_log_scans( void )
+{
+    uint8_t  scan_buf[INTERNAL_LOG_SCAN_BUFFER];
+    uint32_t scan_addr;
+    uint32_t next_scan_addr;
+    uint8_t  nb_jobs            = 0;
+    uint16_t nb_recovered_scans = 0;
+    bool     ctx_has_changed    = false;
+
+    do
+    {
+        scan_addr      = tracker_ctx.flash_addr_current;
+        next_scan_addr = tracker_read_internal_log_scan( &scan_addr, scan_buf, INTERNAL_LOG_SCAN_BUFFER, &nb_jobs );
+
+        /* Go after the scans cut by a reset, which would prevent the next scans from being written */
+        if( scan_addr != tracker_ctx.flash_addr_current )
+        {
+            tracker_clear_internal_log_cut_scans( tracker_ctx.flash_addr_current, scan_addr );
+            tracker_ctx.flash_addr_current = scan_addr;
+            ctx_has_changed                = true;
+        }
+
+        if( next_scan_addr != 0 )
+        {
+            tracker_ctx.flash_addr_current = next_scan_addr;
+            tracker_ctx.nb_scan++;
+            nb_recovered_scans++;
+            ctx_has_changed = true;
+        }
+    } while( next_scan_addr != 0 );
+
+    if( ctx_has_changed == true )
+    {
+        HAL_DBG_TRACE_INFO( "%d internal log scans recovered\n", nb_recovered_scans );
+        tracker_store_internal_log_ctx( );
     }
+}
+
+static void tracker_clear_internal_log_cut_scans( const uint32_t start_addr, const uint32_t end_addr )
+{
+    const uint8_t cleared_buf[8] = { 0 };
+    uint8_t       read_buf[8];
+
+    /* A programmed double word can still be programmed to zero, which reads as a scan length too short */
+    for( uint32_t addr = start_addr; addr < end_addr; addr += 8 )
+    {
+        hal_flash_read_buffer( addr, read_buf, 8 );
+        if( memcmp( read_buf, cleared_buf, 8 ) != 0 )
+        {
+            hal_flash_write_buffer( addr, cleared_buf, 8 );
+        }
+    }
+}
+
+static void tracker_get_one_scan_from_internal_log( uint16_t scan_number, uint8_t* out_buffer,
+                                                    const uint16_t out_buffer_len, uint16_t* buffer_len )
+{
+    uint8_t   scan_buf[INTERNAL_LOG_SCAN_BUFFER];
+    uint16_t  scan_buf_index    = 0;
+    uint8_t   nb_elements       = 0;
+    uint8_t   nb_elements_index = 0;
+    uint8_t   tag_element       = 0;
+    time_t    scan_timestamp    = 0;
+    struct tm epoch_time;
+    uint32_t  job_counter = 0;
+
+    *buffer_len = 0;
+
+    /* Go on from the previous scan asked, or seek the scan_number through the internal log index */
+    if( ( internal_log_iterator.scan_number != scan_number ) &&
+        ( tracker_internal_log_iterator_init( &internal_log_iterator, scan_number ) != TRACKER_SUCCESS ) )
+    {
+        return;
+    }
+
+    if( tracker_internal_log_iterator_next( &internal_log_iterator, scan_buf, INTERNAL_LOG_SCAN_BUFFER ) !=
+        TRACKER_SUCCESS )
+    {
+        return;
+    }
+    job_counter = internal_log_iterator.job_counter;
 
     /* Get the scan asked */
 
@@ -2672,14 +3055,6 @@ static void tracker_get_one_scan_from_internal_log( uint16_t scan_number, uint8_
             }
             break;
         }
-        case TAG_NEXT_SCAN:
-        {
-            next_scan_addr = scan_buf[scan_buf_index++];
-            next_scan_addr += ( uint16_t ) scan_buf[scan_buf_index++] << 8;
-            next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 16;
-            next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 24;
-            break;
-        }
         default:
         {
             scan_buf_index += len;
@@ -2702,7 +3077,193 @@ static void tracker_erase_internal_log( void )
         hal_flash_erase_page( tracker_ctx.flash_addr_start, nb_page_to_erase );
     }
     /* Erase ctx */
+    tracker_erase_internal_log_ctx( );
+}
+
+static void tracker_erase_internal_log_ctx( void )
+{
     hal_flash_erase_page( FLASH_USER_INTERNAL_LOG_CTX_START_ADDR, 1 );
+    hal_flash_erase_page( FLASH_USER_INTERNAL_LOG_CTX_SPARE_ADDR, 1 );
+    internal_log_ctx_page_addr = FLASH_USER_INTERNAL_LOG_CTX_START_ADDR;
+    internal_log_ctx_offset    = 0;
+}
+
+static void tracker_build_internal_log_index( void )
+{
+    uint8_t  scan_buf[INTERNAL_LOG_SCAN_BUFFER];
+    uint32_t scan_addr;
+    uint32_t next_scan_addr;
+    uint8_t  nb_jobs = 0;
+
+    internal_log_index.nb_entries      = 0;
+    internal_log_index.step            = INTERNAL_LOG_INDEX_STEP;
+    internal_log_index.end.scan_number = 1;
+    internal_log_index.end.scan_addr   = tracker_ctx.flash_addr_start;
+    internal_log_index.end.job_counter = 0;
+
+    /* The read internal log command starts over */
+    internal_log_iterator.scan_number = 0;
+
+    while( internal_log_index.end.scan_number <= tracker_ctx.nb_scan )
+    {
+        scan_addr      = internal_log_index.end.scan_addr;
+        next_scan_addr = tracker_read_internal_log_scan( &scan_addr, scan_buf, INTERNAL_LOG_SCAN_BUFFER, &nb_jobs );
+        if( next_scan_addr == 0 )
+        {
+            HAL_DBG_TRACE_ERROR( "Internal log scan %d unreadable, index stopped\n",
+                                 internal_log_index.end.scan_number );
+            break;
+        }
+        tracker_add_scan_to_internal_log_index( scan_addr, next_scan_addr, nb_jobs );
+    }
+}
+
+static void tracker_add_scan_to_internal_log_index( const uint32_t scan_addr, const uint32_t next_scan_addr,
+                                                    const uint8_t nb_jobs )
+{
+    internal_log_index.end.scan_addr = scan_addr;
+
+    if( ( ( internal_log_index.end.scan_number - 1 ) % internal_log_index.step ) == 0 )
+    {
+        /* Index full: keep one entry out of two */
+        if( internal_log_index.nb_entries == INTERNAL_LOG_INDEX_SIZE )
+        {
+            for( uint16_t i = 0; i < ( INTERNAL_LOG_INDEX_SIZE / 2 ); i++ )
+            {
+                internal_log_index.entries[i] = internal_log_index.entries[2 * i];
+            }
+            internal_log_index.nb_entries = INTERNAL_LOG_INDEX_SIZE / 2;
+            internal_log_index.step *= 2;
+        }
+
+        if( ( ( internal_log_index.end.scan_number - 1 ) % internal_log_index.step ) == 0 )
+        {
+            internal_log_index.entries[internal_log_index.nb_entries++] = internal_log_index.end;
+        }
+    }
+
+    internal_log_index.end.job_counter += nb_jobs;
+    internal_log_index.end.scan_addr = next_scan_addr;
+    internal_log_index.end.scan_number++;
+}
+
+static uint32_t tracker_read_internal_log_scan( uint32_t* scan_addr, uint8_t* scan_buf, const uint16_t scan_buf_len,
+                                                uint8_t* nb_jobs )
+{
+    uint16_t scan_len;
+    uint32_t next_scan_addr;
+    bool     scan_is_cut = false;
+
+    /* A scan is only stored with more than INTERNAL_LOG_SCAN_BUFFER bytes left */
+    while( ( *scan_addr < tracker_ctx.flash_addr_end ) &&
+           ( ( tracker_ctx.flash_addr_end - *scan_addr ) > INTERNAL_LOG_SCAN_BUFFER ) )
+    {
+        bool double_word_is_erased = true;
+
+        /* read the first double word, holding the scan length: the internal log ends on an erased one */
+        hal_flash_read_buffer( *scan_addr, scan_buf, 8 );
+        for( uint8_t i = 0; i < 8; i++ )
+        {
+            if( scan_buf[i] != FLASH_BYTE_EMPTY_CONTENT )
+            {
+                double_word_is_erased = false;
+                break;
+            }
+        }
+        if( double_word_is_erased == true )
+        {
+            return 0;
+        }
+
+        scan_len = scan_buf[0];
+        scan_len += ( uint16_t ) scan_buf[1] << 8;
+
+        if( ( scan_len >= 8 ) && ( ( scan_len - 2 ) <= scan_buf_len ) )
+        {
+            /* read the rest of the scan */
+            hal_flash_read_buffer( *scan_addr + 2, scan_buf, scan_len - 2 );
+
+            next_scan_addr = 0;
+            *nb_jobs       = tracker_parse_internal_log_scan( scan_buf, scan_len, &next_scan_addr );
+            if( next_scan_addr == ( *scan_addr + scan_len ) )
+            {
+                return next_scan_addr;
+            }
+        }
+
+        if( scan_is_cut == false )
+        {
+            HAL_DBG_TRACE_WARNING( "Internal log scan cut at %08X, skipped\n", *scan_addr );
+            scan_is_cut = true;
+        }
+        *scan_addr += 8;
+    }
+
+    return 0;
+}
+
+static uint8_t tracker_parse_internal_log_scan( const uint8_t* scan_buf, const uint16_t scan_len,
+                                                uint32_t* next_scan_addr )
+{
+    uint16_t scan_buf_index = 0;
+    uint8_t  nb_elements    = scan_buf[scan_buf_index++];
+    uint8_t  nb_jobs        = 0;
+
+    scan_buf_index += 2;  // scan number
+
+    for( uint8_t nb_elements_index = 0; nb_elements_index < nb_elements; nb_elements_index++ )
+    {
+        /* Element beyond the scan, as in a scan cut by a reset */
+        if( ( scan_buf_index + 2 ) > ( scan_len - 2 ) )
+        {
+            break;
+        }
+
+        uint8_t tag_element = scan_buf[scan_buf_index++];  // get the element
+        uint8_t len         = scan_buf[scan_buf_index++];  // get the size element
+
+        if( ( scan_buf_index + len ) > ( scan_len - 2 ) )
+        {
+            break;
+        }
+
+        switch( tag_element )
+        {
+        case TAG_GNSS_PATCH:
+        case TAG_GNSS_PCB:
+        {
+            uint8_t last_scan = scan_buf[scan_buf_index + 6];
+            if( last_scan == 1 )
+            {
+                nb_jobs++;
+            }
+            break;
+        }
+        case TAG_WIFI:
+        {
+            nb_jobs++;
+            break;
+        }
+        case TAG_NEXT_SCAN:
+        {
+            /* Last element, in the last double word: elsewhere, it is the one of a later scan, read through the
+             * length of a scan cut by a reset */
+            if( ( nb_elements_index == ( nb_elements - 1 ) ) && ( ( scan_buf_index + len + 2 ) > ( scan_len - 8 ) ) )
+            {
+                *next_scan_addr = scan_buf[scan_buf_index];
+                *next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index + 1] << 8;
+                *next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index + 2] << 16;
+                *next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index + 3] << 24;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        scan_buf_index += len;
+    }
+
+    return nb_jobs;
 }
 
 static void tracker_erase_full_user_flash_memory( void )
@@ -2714,7 +3275,7 @@ static void tracker_erase_full_user_flash_memory( void )
     hal_flash_erase_page( hal_flash_get_user_start_addr( ), nb_page_to_erase );
 
     /* Erase ctx */
-    hal_flash_erase_page( FLASH_USER_INTERNAL_LOG_CTX_START_ADDR, 1 );
+    tracker_erase_internal_log_ctx( );
 }
 
 static bool smtc_board_get_almanac_dates( const void* context, uint32_t* oldest_almanac_date,
@@ -351,6 +351,16 @@ typedef struct
     uint32_t flash_remaining_space;
 } tracker_ctx_t;
 
+/*!
+ * @brief Internal log iterator, pointing on the next scan to read
+ */
+typedef struct
+{
+    uint16_t scan_number;  //!< Number of the next scan to read, starting at 1
+    uint32_t scan_addr;    //!< Flash address of the next scan to read
+    uint32_t job_counter;  //!< Number of jobs stored in the scans before the next scan to read
+} tracker_internal_log_iterator_t;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
@@ -419,6 +429,36 @@ void tracker_restore_internal_log( void );
  */
 void tracker_reset_internal_log( void );
 
+/*!
+ * @brief Point an internal log iterator on a given scan.
+ *
+ * @remark The scan is sought from the closest entry of the internal log index, built at the internal log context
+ * restoration and extended at each stored scan, so at most a few scans are read from the flash memory.
+ *
+ * @param [out] iterator Internal log iterator \ref tracker_internal_log_iterator_t
+ * @param [in] scan_number Number of the scan, starting at 1
+ *
+ * @returns TRACKER_SUCCESS if the scan is in the internal log, TRACKER_ERROR otherwise
+ */
+tracker_return_status_t tracker_internal_log_iterator_init( tracker_internal_log_iterator_t* iterator,
+                                                            uint16_t                         scan_number );
+
+/*!
+ * @brief Read the scan pointed by an internal log iterator and move the iterator on the following scan.
+ *
+ * @remark The scan is copied without its length field: nb elements, scan number then the elements, as stored by
+ * \ref tracker_store_wifi_in_internal_log and \ref tracker_store_gnss_in_internal_log. Once the scan is read,
+ * job_counter of the iterator includes the jobs of the scan.
+ *
+ * @param [in,out] iterator Internal log iterator \ref tracker_internal_log_iterator_t
+ * @param [out] scan_buf Buffer where is stored the scan
+ * @param [in] scan_buf_len Length of the buffer where is stored the scan
+ *
+ * @returns TRACKER_SUCCESS if a scan has been read, TRACKER_ERROR at the end of the internal log
+ */
+tracker_return_status_t tracker_internal_log_iterator_next( tracker_internal_log_iterator_t* iterator,
+                                                            uint8_t* scan_buf, const uint16_t scan_buf_len );
+
 /*!
  * @brief Parse the commands coming from outside.
  *
@@ -0,0 +1,247 @@
+/*!
+ * @file      almanac_delta.c
+ *
+ * @brief     LR11xx almanac update from a base image and a delta
+ *
+ * @copyright
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2022. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include "almanac_delta.h"
+#include "lr11xx_gnss.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*!
+ * @brief Position of the global almanac crc in the header block
+ */
+#define ALMANAC_DELTA_HEADER_CRC_INDEX 3
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*!
+ * @brief Blocks of the command being prepared
+ */
+static uint8_t almanac_delta_write_buffer[ALMANAC_DELTA_WRITE_NB_BLOCKS * ALMANAC_DELTA_BLOCK_SIZE];
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/*!
+ * @brief Get the position of a block in the image from its id
+ *
+ * @param [in] block Block
+ * @param [out] position Position of the block
+ *
+ * @returns True if the id is known
+ */
+static bool almanac_delta_get_position( const uint8_t* block, uint8_t* position );
+
+/*!
+ * @brief Get a block of the almanac made of a base image and a delta
+ *
+ * @param [in] base Base image
+ * @param [in] delta Delta, NULL for the base image alone
+ * @param [in] position Position of the block
+ *
+ * @returns Block
+ */
+static const uint8_t* almanac_delta_get_block( const uint8_t* base, const almanac_delta_t* delta,
+                                               const uint8_t position );
+
+/*!
+ * @brief Get the global almanac crc of the LR11xx
+ *
+ * @param [in] context Chip implementation context
+ * @param [out] almanac_crc Global almanac crc
+ *
+ * @returns True if read
+ */
+static bool almanac_delta_get_radio_crc( const void* context, uint32_t* almanac_crc );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void almanac_delta_init( almanac_delta_t* delta )
+{
+    memset( delta->slot, 0, sizeof( delta->slot ) );
+    delta->nb_blocks = 0;
+}
+
+almanac_delta_status_t almanac_delta_add( almanac_delta_t* delta, const uint8_t* base, const uint8_t* blocks,
+                                          const uint16_t size )
+{
+    for( uint16_t index = 0; ( index + ALMANAC_DELTA_BLOCK_SIZE ) <= size; index += ALMANAC_DELTA_BLOCK_SIZE )
+    {
+        const uint8_t* block = blocks + index;
+        uint8_t        position;
+
+        if( almanac_delta_get_position( block, &position ) == false )
+        {
+            return ALMANAC_DELTA_BAD_BLOCK;
+        }
+        if( delta->slot[position] != 0 )
+        {
+            memcpy( delta->blocks[delta->slot[position] - 1], block, ALMANAC_DELTA_BLOCK_SIZE );
+        }
+        else if( memcmp( base + ( position * ALMANAC_DELTA_BLOCK_SIZE ), block, ALMANAC_DELTA_BLOCK_SIZE ) != 0 )
+        {
+            if( delta->nb_blocks >= ALMANAC_DELTA_MAX_NB_BLOCKS )
+            {
+                return ALMANAC_DELTA_FULL;
+            }
+            memcpy( delta->blocks[delta->nb_blocks], block, ALMANAC_DELTA_BLOCK_SIZE );
+            delta->nb_blocks++;
+            delta->slot[position] = delta->nb_blocks;
+        }
+    }
+    return ALMANAC_DELTA_OK;
+}
+
+uint32_t almanac_delta_get_crc( const uint8_t* base, const almanac_delta_t* delta )
+{
+    const uint8_t* header = almanac_delta_get_block( base, delta, 0 ) + ALMANAC_DELTA_HEADER_CRC_INDEX;
+
+    return ( ( uint32_t ) header[0] << 0 ) + ( ( uint32_t ) header[1] << 8 ) + ( ( uint32_t ) header[2] << 16 ) +
+           ( ( uint32_t ) header[3] << 24 );
+}
+
+almanac_delta_status_t almanac_delta_update( const void* context, const uint8_t* base, const almanac_delta_t* delta )
+{
+    const uint32_t almanac_crc = almanac_delta_get_crc( base, delta );
+    uint32_t       radio_crc;
+
+    if( almanac_delta_get_radio_crc( context, &radio_crc ) == false )
+    {
+        return ALMANAC_DELTA_RADIO_ERROR;
+    }
+    if( radio_crc == almanac_crc )
+    {
+        return ALMANAC_DELTA_UP_TO_DATE;
+    }
+
+    // The whole image is written in a row, as required by the LR11xx, without any other command in between
+    uint8_t nb_blocks = 0;
+    for( uint8_t position = 0; position < ALMANAC_DELTA_NB_BLOCKS; position++ )
+    {
+        memcpy( &almanac_delta_write_buffer[nb_blocks * ALMANAC_DELTA_BLOCK_SIZE],
+                almanac_delta_get_block( base, delta, position ), ALMANAC_DELTA_BLOCK_SIZE );
+        nb_blocks++;
+
+        if( ( nb_blocks == ALMANAC_DELTA_WRITE_NB_BLOCKS ) || ( position == ( ALMANAC_DELTA_NB_BLOCKS - 1 ) ) )
+        {
+            if( lr11xx_gnss_almanac_update( context, almanac_delta_write_buffer, nb_blocks ) != LR11XX_STATUS_OK )
+            {
+                return ALMANAC_DELTA_RADIO_ERROR;
+            }
+            nb_blocks = 0;
+        }
+    }
+
+    if( almanac_delta_get_radio_crc( context, &radio_crc ) == false )
+    {
+        return ALMANAC_DELTA_RADIO_ERROR;
+    }
+    return ( radio_crc == almanac_crc ) ? ALMANAC_DELTA_OK : ALMANAC_DELTA_CRC_ERROR;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool almanac_delta_get_position( const uint8_t* block, uint8_t* position )
+{
+    if( block[0] == ALMANAC_DELTA_HEADER_ID )
+    {
+        *position = 0;
+        return true;
+    }
+    if( block[0] < LR11XX_GNSS_FULL_UPDATE_N_ALMANACS )
+    {
+        *position = block[0] + 1;
+        return true;
+    }
+    return false;
+}
+
+static const uint8_t* almanac_delta_get_block( const uint8_t* base, const almanac_delta_t* delta,
+                                               const uint8_t position )
+{
+    if( ( delta != NULL ) && ( delta->slot[position] != 0 ) )
+    {
+        return delta->blocks[delta->slot[position] - 1];
+    }
+    return base + ( position * ALMANAC_DELTA_BLOCK_SIZE );
+}
+
+static bool almanac_delta_get_radio_crc( const void* context, uint32_t* almanac_crc )
+{
+    lr11xx_gnss_context_status_bytestream_t context_status_bytestream;
+    lr11xx_gnss_context_status_t            context_status;
+
+    if( ( lr11xx_gnss_get_context_status( context, context_status_bytestream ) != LR11XX_STATUS_OK ) ||
+        ( lr11xx_gnss_parse_context_status_buffer( context_status_bytestream, &context_status ) !=
+          LR11XX_STATUS_OK ) )
+    {
+        return false;
+    }
+    *almanac_crc = context_status.global_almanac_crc;
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
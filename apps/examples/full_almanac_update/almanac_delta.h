@@ -0,0 +1,191 @@
+/*!
+ * @file      almanac_delta.h
+ *
+ * @brief     LR11xx almanac update from a base image and a delta
+ *
+ * @copyright
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2022. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ALMANAC_DELTA_H
+#define ALMANAC_DELTA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lr11xx_types.h"
+#include "lr11xx_gnss_types.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*
+ * An almanac image is made of a header block followed by a block per satellite, each block starting with its id: 0x80
+ * for the header, the satellite id otherwise. The LR11xx only accepts the whole image, written in a row.
+ *
+ * A delta is the list of the blocks which differ from a base image kept by the host, e.g. received by downlinks, so
+ * that the changed satellites only are sent over the air. The update streams the base image to the LR11xx, replacing
+ * the blocks of the delta on the fly, in commands of up to ALMANAC_DELTA_WRITE_NB_BLOCKS blocks, and is skipped when
+ * the global crc of the LR11xx already is the one of the result.
+ */
+
+/*!
+ * @brief Size of an almanac block in bytes
+ */
+#define ALMANAC_DELTA_BLOCK_SIZE LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE
+
+/*!
+ * @brief Number of blocks of an almanac image: header and satellites
+ */
+#define ALMANAC_DELTA_NB_BLOCKS ( LR11XX_GNSS_FULL_UPDATE_N_ALMANACS + 1 )
+
+/*!
+ * @brief Size of an almanac image in bytes
+ */
+#define ALMANAC_DELTA_IMAGE_SIZE ( ALMANAC_DELTA_NB_BLOCKS * ALMANAC_DELTA_BLOCK_SIZE )
+
+/*!
+ * @brief Id of the header block
+ */
+#define ALMANAC_DELTA_HEADER_ID 0x80
+
+/*!
+ * @brief Maximum number of blocks of a delta
+ */
+#ifndef ALMANAC_DELTA_MAX_NB_BLOCKS
+#define ALMANAC_DELTA_MAX_NB_BLOCKS 32
+#endif
+
+/*!
+ * @brief Number of blocks written per almanac update command, at most as many as fit in a command
+ */
+#ifndef ALMANAC_DELTA_WRITE_NB_BLOCKS
+#define ALMANAC_DELTA_WRITE_NB_BLOCKS ( ( LR11XX_CMD_LENGTH_MAX - 2 ) / ALMANAC_DELTA_BLOCK_SIZE )
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * @brief Almanac delta status
+ */
+typedef enum almanac_delta_status_e
+{
+    ALMANAC_DELTA_OK,           //!< Operation done
+    ALMANAC_DELTA_UP_TO_DATE,   //!< The LR11xx already holds the almanac, nothing written
+    ALMANAC_DELTA_BAD_BLOCK,    //!< Block with an unknown id
+    ALMANAC_DELTA_FULL,         //!< More than ALMANAC_DELTA_MAX_NB_BLOCKS blocks differ from the base
+    ALMANAC_DELTA_RADIO_ERROR,  //!< Command to the LR11xx failed
+    ALMANAC_DELTA_CRC_ERROR,    //!< Global crc of the LR11xx not updated
+} almanac_delta_status_t;
+
+/*!
+ * @brief Blocks replacing the ones of a base image
+ */
+typedef struct almanac_delta_s
+{
+    uint8_t slot[ALMANAC_DELTA_NB_BLOCKS];  //!< 1 + index in blocks of the block of each position, 0 if unchanged
+    uint8_t nb_blocks;                      //!< Number of blocks
+    uint8_t blocks[ALMANAC_DELTA_MAX_NB_BLOCKS][ALMANAC_DELTA_BLOCK_SIZE];  //!< Blocks in their order of arrival
+} almanac_delta_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ * @brief Empty a delta
+ *
+ * @param [out] delta Delta
+ */
+void almanac_delta_init( almanac_delta_t* delta );
+
+/*!
+ * @brief Add blocks to a delta
+ *
+ * @remark A block replaces the one with the same id already in the delta. Blocks equal to the ones of the base are not
+ * stored.
+ *
+ * @param [in,out] delta Delta
+ * @param [in] base Base image, ALMANAC_DELTA_IMAGE_SIZE bytes
+ * @param [in] blocks Blocks
+ * @param [in] size Size of the blocks in bytes, a multiple of ALMANAC_DELTA_BLOCK_SIZE
+ *
+ * @returns Operation status
+ */
+almanac_delta_status_t almanac_delta_add( almanac_delta_t* delta, const uint8_t* base, const uint8_t* blocks,
+                                          const uint16_t size );
+
+/*!
+ * @brief Get the global crc of the almanac made of a base image and a delta
+ *
+ * @param [in] base Base image, ALMANAC_DELTA_IMAGE_SIZE bytes
+ * @param [in] delta Delta, NULL for the base image alone
+ *
+ * @returns Global almanac crc
+ */
+uint32_t almanac_delta_get_crc( const uint8_t* base, const almanac_delta_t* delta );
+
+/*!
+ * @brief Write the almanac made of a base image and a delta to the LR11xx, unless it already holds it
+ *
+ * @param [in] context Chip implementation context
+ * @param [in] base Base image, ALMANAC_DELTA_IMAGE_SIZE bytes
+ * @param [in] delta Delta, NULL for the base image alone
+ *
+ * @returns ALMANAC_DELTA_OK when written, ALMANAC_DELTA_UP_TO_DATE when already held, an error otherwise
+ */
+almanac_delta_status_t almanac_delta_update( const void* context, const uint8_t* base, const almanac_delta_t* delta );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ALMANAC_DELTA_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -50,6 +50,7 @@
 #include "lr11xx_gnss_types.h"
 
 #include "almanac.h" /* Almanac image file, generated by the get_full_almanac.py python script provided */
+#include "almanac_delta.h"
 
 /*
  * -----------------------------------------------------------------------------
@@ -160,7 +161,13 @@ int main( void )
         /* Execute modem runtime, this function must be called again in sleep_time_ms milliseconds or sooner. */
         uint32_t sleep_time_ms = smtc_modem_run_engine( );
 
-        hal_mcu_set_sleep_for_ms( sleep_time_ms );
+        /* go in low power, unless a radio event occurred during the modem runtime */
+        hal_mcu_disable_irq( );
+        if( smtc_modem_is_irq_flag_pending( ) == false )
+        {
+            hal_mcu_set_sleep_for_ms( sleep_time_ms );
+        }
+        hal_mcu_enable_irq( );
     }
 }
 
@@ -179,80 +186,24 @@ static void on_modem_reset( uint16_t reset_count )
     smtc_board_led_pulse( smtc_board_get_led_tx_mask( ), true, 250 );
 }
 
-static bool get_almanac_crc( const void* ral_context, uint32_t* almanac_crc )
-{
-    lr11xx_status_t                         err;
-    lr11xx_gnss_context_status_bytestream_t context_status_bytestream;
-    lr11xx_gnss_context_status_t            context_status;
-
-    err = lr11xx_gnss_get_context_status( ral_context, context_status_bytestream );
-    if( err != LR11XX_STATUS_OK )
-    {
-        HAL_DBG_TRACE_ERROR( "Failed to get gnss context status\n" );
-        return false;
-    }
-
-    err = lr11xx_gnss_parse_context_status_buffer( context_status_bytestream, &context_status );
-    if( err != LR11XX_STATUS_OK )
-    {
-        HAL_DBG_TRACE_ERROR( "Failed to parse gnss context status to get almanac status\n" );
-        return false;
-    }
-
-    *almanac_crc = context_status.global_almanac_crc;
-
-    return true;
-}
-
 static bool almanac_update( const void* ral_context )
 {
-    uint32_t global_almanac_crc, local_almanac_crc;
-    local_almanac_crc =
-        ( full_almanac[6] << 24 ) + ( full_almanac[5] << 16 ) + ( full_almanac[4] << 8 ) + ( full_almanac[3] );
-
-    if( get_almanac_crc( ral_context, &global_almanac_crc ) == false )
-    {
-        HAL_DBG_TRACE_ERROR( "Failed to get almanac CRC before update\n" );
-        return false;
-    }
-    if( global_almanac_crc != local_almanac_crc )
-    {
-        HAL_DBG_TRACE_INFO( "Local almanac doesn't match LR11XX almanac -> start update\n" );
-
-        /* Load almanac in flash */
-        uint16_t almanac_idx = 0;
-        while( almanac_idx < sizeof( full_almanac ) )
-        {
-            if( lr11xx_gnss_almanac_update( ral_context, full_almanac + almanac_idx, 1 ) != LR11XX_STATUS_OK )
-            {
-                HAL_DBG_TRACE_ERROR( "Failed to update almanac\n" );
-                return false;
-            }
-            almanac_idx += LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE;
-        }
-
-        /* Check CRC again to confirm proper update */
-        if( get_almanac_crc( ral_context, &global_almanac_crc ) == false )
-        {
-            HAL_DBG_TRACE_ERROR( "Failed to get almanac CRC after update\n" );
-            return false;
-        }
-        if( global_almanac_crc != local_almanac_crc )
-        {
-            HAL_DBG_TRACE_ERROR( "Local almanac doesn't match LR11XX almanac -> update failed\n" );
-            return false;
-        }
-        else
-        {
-            HAL_DBG_TRACE_INFO( "Almanac update succeeded\n" );
-        }
-    }
-    else
+    /* The image is written in a row only if the LR11xx does not already hold it */
+    switch( almanac_delta_update( ral_context, full_almanac, NULL ) )
     {
+    case ALMANAC_DELTA_OK:
+        HAL_DBG_TRACE_INFO( "Local almanac doesn't match LR11XX almanac -> update succeeded\n" );
+        return true;
+    case ALMANAC_DELTA_UP_TO_DATE:
         HAL_DBG_TRACE_INFO( "Local almanac matches LR11XX almanac -> no update\n" );
+        return true;
+    case ALMANAC_DELTA_CRC_ERROR:
+        HAL_DBG_TRACE_ERROR( "Local almanac doesn't match LR11XX almanac -> update failed\n" );
+        return false;
+    default:
+        HAL_DBG_TRACE_ERROR( "Failed to update almanac\n" );
+        return false;
     }
-
-    return true;
 }
 
 /* --- EOF ------------------------------------------------------------------ */
@@ -245,8 +245,13 @@ int main( void )
         /* Execute modem runtime, this function must be called again in sleep_time_ms milliseconds or sooner. */
         uint32_t sleep_time_ms = smtc_modem_run_engine( );
 
-        /* go in low power */
-        hal_mcu_set_sleep_for_ms( sleep_time_ms );
+        /* go in low power, unless a radio event occurred during the modem runtime */
+        hal_mcu_disable_irq( );
+        if( smtc_modem_is_irq_flag_pending( ) == false )
+        {
+            hal_mcu_set_sleep_for_ms( sleep_time_ms );
+        }
+        hal_mcu_enable_irq( );
     }
 }
 
@@ -0,0 +1,111 @@
+/**
+ * @file      almanac_update_reference.c
+ *
+ * @brief     Block per command almanac update the delta update is checked against
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include "almanac_update_reference.h"
+#include "lr11xx_gnss.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Get the global almanac crc of the LR11xx
+ *
+ * @param [in]  context     Chip implementation context
+ * @param [out] almanac_crc Global almanac crc
+ *
+ * @return true if read
+ */
+static bool get_almanac_crc( const void* context, uint32_t* almanac_crc );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+bool almanac_update_reference( const void* context, const uint8_t* image )
+{
+    uint32_t global_almanac_crc;
+    uint32_t local_almanac_crc =
+        ( ( uint32_t ) image[6] << 24 ) + ( ( uint32_t ) image[5] << 16 ) + ( ( uint32_t ) image[4] << 8 ) + image[3];
+
+    if( get_almanac_crc( context, &global_almanac_crc ) == false )
+    {
+        return false;
+    }
+    if( global_almanac_crc == local_almanac_crc )
+    {
+        return true;
+    }
+
+    for( uint16_t almanac_idx = 0;
+         almanac_idx < ( ( LR11XX_GNSS_FULL_UPDATE_N_ALMANACS + 1 ) * LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE );
+         almanac_idx += LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE )
+    {
+        if( lr11xx_gnss_almanac_update( context, image + almanac_idx, 1 ) != LR11XX_STATUS_OK )
+        {
+            return false;
+        }
+    }
+
+    return ( get_almanac_crc( context, &global_almanac_crc ) == true ) && ( global_almanac_crc == local_almanac_crc );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool get_almanac_crc( const void* context, uint32_t* almanac_crc )
+{
+    lr11xx_gnss_context_status_bytestream_t context_status_bytestream;
+    lr11xx_gnss_context_status_t            context_status;
+
+    if( ( lr11xx_gnss_get_context_status( context, context_status_bytestream ) != LR11XX_STATUS_OK ) ||
+        ( lr11xx_gnss_parse_context_status_buffer( context_status_bytestream, &context_status ) !=
+          LR11XX_STATUS_OK ) )
+    {
+        return false;
+    }
+    *almanac_crc = context_status.global_almanac_crc;
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,196 @@
+/**
+ * @file      lr11xx_almanac_sim.c
+ *
+ * @brief     Almanac store of a simulated LR11xx, behind the LR11xx HAL
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "lr11xx_almanac_sim.h"
+#include "lr11xx_hal.h"
+#include "lr11xx_gnss_types.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define LR11XX_ALMANAC_SIM_ALMANAC_UPDATE_OC 0x040E
+#define LR11XX_ALMANAC_SIM_GET_CONTEXT_STATUS_OC 0x0416
+
+#define LR11XX_ALMANAC_SIM_NB_BLOCKS ( LR11XX_GNSS_FULL_UPDATE_N_ALMANACS + 1 )
+#define LR11XX_ALMANAC_SIM_IMAGE_SIZE ( LR11XX_ALMANAC_SIM_NB_BLOCKS * LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint8_t                    lr11xx_almanac_sim_image[LR11XX_ALMANAC_SIM_IMAGE_SIZE];
+static uint8_t                    lr11xx_almanac_sim_update[LR11XX_ALMANAC_SIM_IMAGE_SIZE];
+static uint16_t                   lr11xx_almanac_sim_nb_received;  // blocks of the update in progress
+static lr11xx_almanac_sim_stats_t lr11xx_almanac_sim_stats;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Get the opcode of a command, and abort an almanac update interrupted by another command
+ *
+ * @param [in] command        Command
+ * @param [in] command_length Command size in bytes
+ * @param [in] data_length    Data size in bytes
+ *
+ * @return Opcode
+ */
+static uint16_t lr11xx_almanac_sim_command( const uint8_t* command, const uint16_t command_length,
+                                            const uint16_t data_length );
+
+/**
+ * @brief Get the global crc of the store, as given by the header block
+ *
+ * @return Global almanac crc
+ */
+static uint32_t lr11xx_almanac_sim_get_crc( void );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void lr11xx_almanac_sim_init( const uint8_t* image )
+{
+    memcpy( lr11xx_almanac_sim_image, image, LR11XX_ALMANAC_SIM_IMAGE_SIZE );
+    lr11xx_almanac_sim_nb_received = 0;
+    memset( &lr11xx_almanac_sim_stats, 0, sizeof( lr11xx_almanac_sim_stats ) );
+}
+
+const uint8_t* lr11xx_almanac_sim_get_image( void )
+{
+    return lr11xx_almanac_sim_image;
+}
+
+lr11xx_almanac_sim_stats_t lr11xx_almanac_sim_get_stats( void )
+{
+    return lr11xx_almanac_sim_stats;
+}
+
+lr11xx_hal_status_t lr11xx_hal_write( const void* context, const uint8_t* command, const uint16_t command_length,
+                                      const uint8_t* data, const uint16_t data_length )
+{
+    if( lr11xx_almanac_sim_command( command, command_length, data_length ) != LR11XX_ALMANAC_SIM_ALMANAC_UPDATE_OC )
+    {
+        return LR11XX_HAL_STATUS_ERROR;
+    }
+
+    // The header block comes first, then the satellites in order
+    for( uint16_t index = 0; index < data_length; index += LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE )
+    {
+        const uint8_t id = ( lr11xx_almanac_sim_nb_received == 0 ) ? 0x80 : lr11xx_almanac_sim_nb_received - 1;
+
+        if( ( ( data_length - index ) < LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE ) || ( data[index] != id ) )
+        {
+            lr11xx_almanac_sim_nb_received = 0;
+            lr11xx_almanac_sim_stats.nb_aborts++;
+            return LR11XX_HAL_STATUS_ERROR;
+        }
+        memcpy( &lr11xx_almanac_sim_update[lr11xx_almanac_sim_nb_received * LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE],
+                &data[index], LR11XX_GNSS_SINGLE_ALMANAC_WRITE_SIZE );
+        lr11xx_almanac_sim_nb_received++;
+
+        if( lr11xx_almanac_sim_nb_received == LR11XX_ALMANAC_SIM_NB_BLOCKS )
+        {
+            memcpy( lr11xx_almanac_sim_image, lr11xx_almanac_sim_update, LR11XX_ALMANAC_SIM_IMAGE_SIZE );
+            lr11xx_almanac_sim_nb_received = 0;
+            lr11xx_almanac_sim_stats.nb_rewrites++;
+        }
+    }
+    return LR11XX_HAL_STATUS_OK;
+}
+
+lr11xx_hal_status_t lr11xx_hal_read( const void* context, const uint8_t* command, const uint16_t command_length,
+                                     uint8_t* data, const uint16_t data_length )
+{
+    const uint32_t almanac_crc = lr11xx_almanac_sim_get_crc( );
+
+    if( ( lr11xx_almanac_sim_command( command, command_length, data_length ) !=
+          LR11XX_ALMANAC_SIM_GET_CONTEXT_STATUS_OC ) ||
+        ( data_length != LR11XX_GNSS_CONTEXT_STATUS_LENGTH ) )
+    {
+        return LR11XX_HAL_STATUS_ERROR;
+    }
+
+    memset( data, 0, data_length );
+    data[0] = LR11XX_GNSS_DESTINATION_DMC;
+    data[1] = LR11XX_GNSS_DMC_STATUS;
+    data[2] = 0x01;
+    data[3] = ( uint8_t ) ( almanac_crc >> 0 );
+    data[4] = ( uint8_t ) ( almanac_crc >> 8 );
+    data[5] = ( uint8_t ) ( almanac_crc >> 16 );
+    data[6] = ( uint8_t ) ( almanac_crc >> 24 );
+    return LR11XX_HAL_STATUS_OK;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint16_t lr11xx_almanac_sim_command( const uint8_t* command, const uint16_t command_length,
+                                            const uint16_t data_length )
+{
+    const uint16_t opcode = ( ( uint16_t ) command[0] << 8 ) | command[1];
+
+    lr11xx_almanac_sim_stats.nb_commands++;
+    lr11xx_almanac_sim_stats.nb_bytes += command_length + data_length;
+
+    if( ( opcode != LR11XX_ALMANAC_SIM_ALMANAC_UPDATE_OC ) && ( lr11xx_almanac_sim_nb_received != 0 ) )
+    {
+        lr11xx_almanac_sim_nb_received = 0;
+        lr11xx_almanac_sim_stats.nb_aborts++;
+    }
+    return opcode;
+}
+
+static uint32_t lr11xx_almanac_sim_get_crc( void )
+{
+    return ( ( uint32_t ) lr11xx_almanac_sim_image[3] << 0 ) + ( ( uint32_t ) lr11xx_almanac_sim_image[4] << 8 ) +
+           ( ( uint32_t ) lr11xx_almanac_sim_image[5] << 16 ) + ( ( uint32_t ) lr11xx_almanac_sim_image[6] << 24 );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,89 @@
+/**
+ * @file      lr11xx_almanac_sim.h
+ *
+ * @brief     Almanac store of a simulated LR11xx, behind the LR11xx HAL
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_ALMANAC_SIM_H
+#define LR11XX_ALMANAC_SIM_H
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Counters of the simulated LR11xx
+ */
+typedef struct lr11xx_almanac_sim_stats_s
+{
+    uint32_t nb_commands;  //!< Commands on the SPI bus
+    uint32_t nb_bytes;     //!< Bytes on the SPI bus
+    uint32_t nb_rewrites;  //!< Almanac images written to the flash
+    uint32_t nb_aborts;    //!< Almanac updates not written in a row
+} lr11xx_almanac_sim_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Load an almanac image into the store and clear the counters
+ *
+ * @param [in] image Almanac image, header and 128 satellites
+ */
+void lr11xx_almanac_sim_init( const uint8_t* image );
+
+/**
+ * @brief Get the almanac image of the store
+ *
+ * @return Almanac image
+ */
+const uint8_t* lr11xx_almanac_sim_get_image( void );
+
+/**
+ * @brief Get the counters
+ *
+ * @return Counters since lr11xx_almanac_sim_init()
+ */
+lr11xx_almanac_sim_stats_t lr11xx_almanac_sim_get_stats( void );
+
+#endif  // LR11XX_ALMANAC_SIM_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,323 @@
+/**
+ * @file      main_almanac_update_benchmark.c
+ *
+ * @brief     Almanac update from a delta against the full image, on a simulated LR11xx
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "almanac.h"
+#include "almanac_delta.h"
+#include "almanac_update_reference.h"
+#include "lr11xx_almanac_sim.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define ALMANAC_BENCH_NB_ROUNDS_DEFAULT 100
+#define ALMANAC_BENCH_DOWNLINK_SIZE_DEFAULT 200
+
+/**
+ * @brief Numbers of satellites changed between the base image and the new one
+ */
+static const uint8_t almanac_bench_nb_changes[] = { 0, 1, 2, 4, 8, 16, ALMANAC_DELTA_MAX_NB_BLOCKS - 1 };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct almanac_bench_params_s
+{
+    uint32_t nb_rounds;
+    uint16_t downlink_size;
+    uint32_t seed;
+} almanac_bench_params_t;
+
+/**
+ * @brief Results of a number of changed satellites, summed over the rounds
+ */
+typedef struct almanac_bench_result_s
+{
+    uint32_t                   delta_bytes;  //!< Bytes of the deltas sent over the air
+    uint32_t                   nb_downlinks; //!< Downlinks carrying the deltas
+    lr11xx_almanac_sim_stats_t reference;    //!< LR11xx counters of the reference update
+    lr11xx_almanac_sim_stats_t delta;        //!< LR11xx counters of the delta update
+    uint32_t                   nb_errors;    //!< Updates whose result differs from the new image
+} almanac_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint8_t         new_almanac[ALMANAC_DELTA_IMAGE_SIZE];
+static almanac_delta_t delta;
+static uint32_t        random_state;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Update the LR11xx from the base image to images with nb_changes changed satellites, and check them
+ *
+ * @param [in]  params     Command line parameters
+ * @param [in]  nb_changes Number of changed satellites
+ * @param [out] result     Results
+ */
+static void almanac_bench_run( const almanac_bench_params_t* params, uint8_t nb_changes,
+                               almanac_bench_result_t* result );
+
+/**
+ * @brief Add the counters of an update to a sum
+ *
+ * @param [in,out] sum   Sum
+ * @param [in]     stats Counters of the update
+ */
+static void almanac_bench_add_stats( lr11xx_almanac_sim_stats_t* sum, lr11xx_almanac_sim_stats_t stats );
+
+/**
+ * @brief Xorshift pseudo-random generator
+ */
+static uint32_t almanac_bench_rand( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, almanac_bench_params_t* params );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    almanac_bench_params_t params = {
+        .nb_rounds     = ALMANAC_BENCH_NB_ROUNDS_DEFAULT,
+        .downlink_size = ALMANAC_BENCH_DOWNLINK_SIZE_DEFAULT,
+        .seed          = 1,
+    };
+    uint32_t nb_errors = 0;
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+
+    printf( "Almanac update benchmark: %u-byte downlinks, %u rounds, %u-byte image\n\n", params.downlink_size,
+            params.nb_rounds, ALMANAC_DELTA_IMAGE_SIZE );
+    printf( "  changed SV   delta bytes   downlinks   commands ref/delta   SPI bytes ref/delta   rewrites ref/delta\n" );
+    for( size_t i = 0; i < sizeof( almanac_bench_nb_changes ) / sizeof( almanac_bench_nb_changes[0] ); i++ )
+    {
+        almanac_bench_result_t result;
+        const double           nb_rounds = params.nb_rounds;
+
+        almanac_bench_run( &params, almanac_bench_nb_changes[i], &result );
+        printf( "  %10u   %11.0f   %9.1f   %8.1f / %-8.1f   %8.0f / %-8.0f   %8.2f / %.2f\n",
+                almanac_bench_nb_changes[i], result.delta_bytes / nb_rounds, result.nb_downlinks / nb_rounds,
+                result.reference.nb_commands / nb_rounds, result.delta.nb_commands / nb_rounds,
+                result.reference.nb_bytes / nb_rounds, result.delta.nb_bytes / nb_rounds,
+                result.reference.nb_rewrites / nb_rounds, result.delta.nb_rewrites / nb_rounds );
+        nb_errors += result.nb_errors;
+    }
+
+    if( nb_errors != 0 )
+    {
+        printf( "\nFAILED: %u updates differ from the new image\n", nb_errors );
+        return 1;
+    }
+    printf( "\nThe LR11xx holds the new image after every update\n" );
+    return 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void almanac_bench_run( const almanac_bench_params_t* params, uint8_t nb_changes,
+                               almanac_bench_result_t* result )
+{
+    const uint16_t downlink_size = ( params->downlink_size / ALMANAC_DELTA_BLOCK_SIZE ) * ALMANAC_DELTA_BLOCK_SIZE;
+    uint8_t        delta_blocks[ALMANAC_DELTA_MAX_NB_BLOCKS * ALMANAC_DELTA_BLOCK_SIZE];
+
+    memset( result, 0, sizeof( almanac_bench_result_t ) );
+    random_state = params->seed;
+
+    for( uint32_t round = 0; round < params->nb_rounds; round++ )
+    {
+        // New image: new global crc in the header, and nb_changes distinct satellites with new parameters
+        memcpy( new_almanac, full_almanac, ALMANAC_DELTA_IMAGE_SIZE );
+        if( nb_changes > 0 )
+        {
+            for( uint8_t i = 3; i < 7; i++ )
+            {
+                new_almanac[i] = ( uint8_t ) almanac_bench_rand( );
+            }
+        }
+        for( uint8_t change = 0; change < nb_changes; change++ )
+        {
+            uint8_t* block;
+            do
+            {
+                const uint8_t sv = almanac_bench_rand( ) % LR11XX_GNSS_FULL_UPDATE_N_ALMANACS;
+                block            = &new_almanac[( sv + 1 ) * ALMANAC_DELTA_BLOCK_SIZE];
+            } while( memcmp( block, &full_almanac[block - new_almanac], ALMANAC_DELTA_BLOCK_SIZE ) != 0 );
+            for( uint8_t i = 1; i < ALMANAC_DELTA_BLOCK_SIZE; i++ )
+            {
+                block[i] ^= ( uint8_t ) ( almanac_bench_rand( ) | 1 );
+            }
+        }
+
+        // Reference: the new image in full, one block per command
+        lr11xx_almanac_sim_init( full_almanac );
+        if( ( almanac_update_reference( NULL, new_almanac ) == false ) ||
+            ( memcmp( lr11xx_almanac_sim_get_image( ), new_almanac, ALMANAC_DELTA_IMAGE_SIZE ) != 0 ) )
+        {
+            result->nb_errors++;
+        }
+        almanac_bench_add_stats( &result->reference, lr11xx_almanac_sim_get_stats( ) );
+
+        // Delta: the changed blocks, computed by the server and sent in downlinks
+        uint16_t delta_size = 0;
+        for( uint8_t position = 0; position < ALMANAC_DELTA_NB_BLOCKS; position++ )
+        {
+            const uint16_t offset = position * ALMANAC_DELTA_BLOCK_SIZE;
+            if( memcmp( &new_almanac[offset], &full_almanac[offset], ALMANAC_DELTA_BLOCK_SIZE ) != 0 )
+            {
+                memcpy( &delta_blocks[delta_size], &new_almanac[offset], ALMANAC_DELTA_BLOCK_SIZE );
+                delta_size += ALMANAC_DELTA_BLOCK_SIZE;
+            }
+        }
+        result->delta_bytes += delta_size;
+
+        lr11xx_almanac_sim_init( full_almanac );
+        almanac_delta_init( &delta );
+        for( uint16_t offset = 0; offset < delta_size; offset += downlink_size )
+        {
+            const uint16_t size = ( ( delta_size - offset ) < downlink_size ) ? ( delta_size - offset ) : downlink_size;
+            if( almanac_delta_add( &delta, full_almanac, &delta_blocks[offset], size ) != ALMANAC_DELTA_OK )
+            {
+                result->nb_errors++;
+            }
+            result->nb_downlinks++;
+        }
+
+        const almanac_delta_status_t status = almanac_delta_update( NULL, full_almanac, &delta );
+        if( ( ( status != ALMANAC_DELTA_OK ) && ( status != ALMANAC_DELTA_UP_TO_DATE ) ) ||
+            ( ( status == ALMANAC_DELTA_UP_TO_DATE ) != ( nb_changes == 0 ) ) ||
+            ( memcmp( lr11xx_almanac_sim_get_image( ), new_almanac, ALMANAC_DELTA_IMAGE_SIZE ) != 0 ) )
+        {
+            result->nb_errors++;
+        }
+        almanac_bench_add_stats( &result->delta, lr11xx_almanac_sim_get_stats( ) );
+        if( ( result->reference.nb_aborts != 0 ) || ( result->delta.nb_aborts != 0 ) )
+        {
+            result->nb_errors++;
+        }
+    }
+}
+
+static void almanac_bench_add_stats( lr11xx_almanac_sim_stats_t* sum, lr11xx_almanac_sim_stats_t stats )
+{
+    sum->nb_commands += stats.nb_commands;
+    sum->nb_bytes += stats.nb_bytes;
+    sum->nb_rewrites += stats.nb_rewrites;
+    sum->nb_aborts += stats.nb_aborts;
+}
+
+static uint32_t almanac_bench_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, almanac_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:e:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_rounds = strtoul( optarg, NULL, 0 );
+            break;
+        case 's':
+            params->downlink_size = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n rounds] [-s downlink_size] [-e seed]\n", argv[0] );
+            return false;
+        }
+    }
+    if( params->nb_rounds == 0 || params->seed == 0 )
+    {
+        printf( "The number of rounds and the seed must be at least 1\n" );
+        return false;
+    }
+    if( params->downlink_size < ALMANAC_DELTA_BLOCK_SIZE )
+    {
+        printf( "The downlink must hold a block, %u bytes\n", ALMANAC_DELTA_BLOCK_SIZE );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
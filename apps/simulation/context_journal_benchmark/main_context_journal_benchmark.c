@@ -0,0 +1,520 @@
+/**
+ * @file      main_context_journal_benchmark.c
+ *
+ * @brief     Stores contexts in the context journal with power cuts, and checks the contexts restored after each cut
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "smtc_context_journal.h"
+#include "smtc_modem_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define JOURNAL_BENCH_NB_STORES_DEFAULT 200000
+#define JOURNAL_BENCH_CUT_PERIOD_DEFAULT 150
+#define JOURNAL_BENCH_REBOOT_PERIOD 100
+#define JOURNAL_BENCH_SEED_DEFAULT 1
+
+#define JOURNAL_BENCH_AREA_SIZE ( SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES * SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE )
+#define JOURNAL_BENCH_WRITE_UNIT 8
+#define JOURNAL_BENCH_CONTEXT_SIZE_MAX 300
+
+/**
+ * @brief Context sizes, of the order of the modem ones, the secure element context being the largest
+ */
+static const uint16_t journal_bench_context_sizes[MODEM_CONTEXT_TYPE_SIZE] = {
+    [CONTEXT_MODEM]          = 28,
+    [CONTEXT_LR1MAC]         = 60,
+    [CONTEXT_DEVNONCE]       = 36,
+    [CONTEXT_SECURE_ELEMENT] = JOURNAL_BENCH_CONTEXT_SIZE_MAX,
+};
+
+static const char* journal_bench_context_names[MODEM_CONTEXT_TYPE_SIZE] = {
+    [CONTEXT_MODEM]          = "modem",
+    [CONTEXT_LR1MAC]         = "lr1mac",
+    [CONTEXT_DEVNONCE]       = "devnonce",
+    [CONTEXT_SECURE_ELEMENT] = "secure element",
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct journal_bench_params_s
+{
+    uint32_t nb_stores;
+    uint32_t cut_period;
+    uint32_t seed;
+} journal_bench_params_t;
+
+/**
+ * @brief Results of a context
+ */
+typedef struct journal_bench_result_s
+{
+    uint32_t nb_stores;            //!< Stores
+    uint32_t nb_unchanged;         //!< Stores of an unchanged context
+    uint32_t nb_cuts;              //!< Stores cut by a power loss
+    uint32_t nb_cuts_page_change;  //!< Stores cut while the journal was changing page
+    uint32_t nb_cuts_kept;         //!< Cut stores restoring the previous context
+    uint32_t nb_cuts_stored;       //!< Cut stores restoring the new context
+    uint32_t nb_errors;            //!< Restores of a context that was neither stored nor being stored
+} journal_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint8_t                journal_area[JOURNAL_BENCH_AREA_SIZE];
+static smtc_context_journal_t journal_index;
+
+// Latest stored contexts
+static uint8_t contexts[MODEM_CONTEXT_TYPE_SIZE][JOURNAL_BENCH_CONTEXT_SIZE_MAX];
+static bool    is_stored[MODEM_CONTEXT_TYPE_SIZE];
+
+static jmp_buf  power_cut;
+static int32_t  power_cut_countdown = -1;  // Flash operations before the cut, -1 without cut
+static uint32_t nb_operations;             // Flash operations, 8-byte writes and page erases
+static bool     is_page_erased;            // A page has been erased by the current store
+static uint32_t nb_restarts;
+static uint32_t nb_page_erases;
+static uint64_t nb_bytes_written;
+static uint32_t nb_flash_errors;  // Writes of bytes that were not erased, or out of the area
+static uint32_t random_state;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Restart the device: the index of the journal is scanned again at the next access
+ */
+static void journal_bench_reboot( void );
+
+/**
+ * @brief Count the flash operations of a store, without changing the journal
+ *
+ * @param [in] type Context
+ * @param [in] data Context data
+ * @param [in] size Context size
+ *
+ * @return Number of 8-byte writes and page erases of the store
+ */
+static uint32_t journal_bench_count_operations( const modem_context_type_t type, const uint8_t* data,
+                                                const uint16_t size );
+
+/**
+ * @brief Restore all the contexts and compare them with the stored ones
+ *
+ * @param [in] cut_type  Context whose store was cut, MODEM_CONTEXT_TYPE_SIZE if none
+ * @param [in] cut_data  Context whose store was cut
+ * @param [out] result   Results, per context
+ *
+ * @return true if the cut store restores the new context
+ */
+static bool journal_bench_check( const modem_context_type_t cut_type, const uint8_t* cut_data,
+                                 journal_bench_result_t result[MODEM_CONTEXT_TYPE_SIZE] );
+
+/**
+ * @brief Count a flash operation, and cut the power when the countdown ends
+ *
+ * @return true if the power is cut by this operation
+ */
+static bool journal_bench_is_cut( void );
+
+/**
+ * @brief Xorshift pseudo-random generator
+ */
+static uint32_t journal_bench_rand( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, journal_bench_params_t* params );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    journal_bench_params_t params = {
+        .nb_stores  = JOURNAL_BENCH_NB_STORES_DEFAULT,
+        .cut_period = JOURNAL_BENCH_CUT_PERIOD_DEFAULT,
+        .seed       = JOURNAL_BENCH_SEED_DEFAULT,
+    };
+    journal_bench_result_t result[MODEM_CONTEXT_TYPE_SIZE] = { 0 };
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+    random_state = params.seed;
+
+    memset( journal_area, 0xFF, sizeof( journal_area ) );
+    memset( contexts, 0xFF, sizeof( contexts ) );
+    smtc_context_journal_set_data( &journal_index );
+
+    printf( "Context journal benchmark: %u stores, a power cut every %u stores, %u pages of %u bytes, seed %u\n\n",
+            params.nb_stores, params.cut_period, SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES,
+            SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE, params.seed );
+
+    for( uint32_t i = 0; i < params.nb_stores; i++ )
+    {
+        const modem_context_type_t type = ( modem_context_type_t )( journal_bench_rand( ) % MODEM_CONTEXT_TYPE_SIZE );
+        const uint16_t             size = journal_bench_context_sizes[type];
+        uint8_t                    data[JOURNAL_BENCH_CONTEXT_SIZE_MAX];
+
+        memcpy( data, contexts[type], size );
+        if( ( is_stored[type] == false ) || ( ( journal_bench_rand( ) % 4 ) != 0 ) )
+        {
+            // A few fields change, as the frame counters or the session of a new join
+            const uint32_t nb_changes = 1 + ( journal_bench_rand( ) % 3 );
+
+            for( uint32_t j = 0; j < nb_changes; j++ )
+            {
+                data[journal_bench_rand( ) % size] = ( uint8_t ) journal_bench_rand( );
+            }
+        }
+        else
+        {
+            result[type].nb_unchanged++;
+        }
+        result[type].nb_stores++;
+
+        // The power is cut at any flash operation of the store, a store writing nothing is not cut
+        if( ( journal_bench_rand( ) % params.cut_period ) == 0 )
+        {
+            const uint32_t nb_store_operations = journal_bench_count_operations( type, data, size );
+
+            if( nb_store_operations != 0 )
+            {
+                power_cut_countdown = ( int32_t )( journal_bench_rand( ) % nb_store_operations );
+            }
+        }
+        is_page_erased = false;
+
+        if( setjmp( power_cut ) == 0 )
+        {
+            smtc_context_journal_store( type, data, size );
+            power_cut_countdown = -1;
+            memcpy( contexts[type], data, size );
+            is_stored[type] = true;
+
+            if( ( journal_bench_rand( ) % JOURNAL_BENCH_REBOOT_PERIOD ) == 0 )
+            {
+                journal_bench_reboot( );
+                journal_bench_check( MODEM_CONTEXT_TYPE_SIZE, NULL, result );
+            }
+        }
+        else
+        {
+            // The store was cut: either context may be restored, the journal carries on with the restored one
+            power_cut_countdown = -1;
+            result[type].nb_cuts++;
+            if( is_page_erased == true )
+            {
+                result[type].nb_cuts_page_change++;
+            }
+            journal_bench_reboot( );
+            if( journal_bench_check( type, data, result ) == true )
+            {
+                result[type].nb_cuts_stored++;
+                memcpy( contexts[type], data, size );
+                is_stored[type] = true;
+            }
+            else
+            {
+                result[type].nb_cuts_kept++;
+            }
+        }
+    }
+
+    uint32_t nb_errors = 0;
+
+    printf( "Context          Stores  Unchanged     Cuts  in page change  restore previous  restore new  Errors\n" );
+    for( uint8_t type = 0; type < MODEM_CONTEXT_TYPE_SIZE; type++ )
+    {
+        printf( "%-14s  %7u  %9u  %7u  %14u  %16u  %11u  %6u\n", journal_bench_context_names[type],
+                result[type].nb_stores, result[type].nb_unchanged, result[type].nb_cuts,
+                result[type].nb_cuts_page_change, result[type].nb_cuts_kept, result[type].nb_cuts_stored,
+                result[type].nb_errors );
+        nb_errors += result[type].nb_errors;
+    }
+
+    printf( "\n%u restarts, %u page erases, %llu bytes written, %u writes over programmed flash\n", nb_restarts,
+            nb_page_erases, ( unsigned long long ) nb_bytes_written, nb_flash_errors );
+    printf( "Without the journal, each store erases a page: %u page erases\n", params.nb_stores );
+
+    if( ( nb_errors != 0 ) || ( nb_flash_errors != 0 ) )
+    {
+        printf( "\nFAILED: a restored context differs from the stored ones\n" );
+        return 1;
+    }
+    printf( "\nEvery restart restored the stored contexts, or the previous one of a cut store\n" );
+    return 0;
+}
+
+void smtc_modem_hal_context_restore( const modem_context_type_t ctx_type, uint8_t* buffer, const uint32_t size )
+{
+    // Nothing was stored before the journal
+    memset( buffer, 0xFF, size );
+}
+
+void smtc_modem_hal_context_store( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size )
+{
+}
+
+void smtc_modem_hal_context_journal_read( const uint32_t offset, uint8_t* buffer, const uint32_t size )
+{
+    if( ( offset + size ) > JOURNAL_BENCH_AREA_SIZE )
+    {
+        nb_flash_errors++;
+        memset( buffer, 0xFF, size );
+        return;
+    }
+    memcpy( buffer, &journal_area[offset], size );
+}
+
+void smtc_modem_hal_context_journal_write( const uint32_t offset, const uint8_t* buffer, const uint32_t size )
+{
+    if( ( ( offset % JOURNAL_BENCH_WRITE_UNIT ) != 0 ) || ( ( size % JOURNAL_BENCH_WRITE_UNIT ) != 0 ) ||
+        ( ( offset + size ) > JOURNAL_BENCH_AREA_SIZE ) )
+    {
+        nb_flash_errors++;
+        return;
+    }
+    for( uint32_t unit = 0; unit < size; unit += JOURNAL_BENCH_WRITE_UNIT )
+    {
+        uint8_t* flash = &journal_area[offset + unit];
+
+        for( uint32_t i = 0; i < JOURNAL_BENCH_WRITE_UNIT; i++ )
+        {
+            if( flash[i] != 0xFF )
+            {
+                nb_flash_errors++;
+            }
+        }
+        if( journal_bench_is_cut( ) == true )
+        {
+            // Programming only clears bits: the bits of a cut write are cleared or not
+            for( uint32_t i = 0; i < JOURNAL_BENCH_WRITE_UNIT; i++ )
+            {
+                flash[i] &= buffer[unit + i] | ( uint8_t ) journal_bench_rand( );
+            }
+            longjmp( power_cut, 1 );
+        }
+        for( uint32_t i = 0; i < JOURNAL_BENCH_WRITE_UNIT; i++ )
+        {
+            flash[i] &= buffer[unit + i];
+        }
+        nb_bytes_written += JOURNAL_BENCH_WRITE_UNIT;
+    }
+}
+
+void smtc_modem_hal_context_journal_erase_page( const uint32_t page )
+{
+    uint8_t* flash = &journal_area[page * SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE];
+
+    is_page_erased = true;
+    if( page >= SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES )
+    {
+        nb_flash_errors++;
+        return;
+    }
+    if( journal_bench_is_cut( ) == true )
+    {
+        // The bytes of a cut erase are erased or not
+        for( uint32_t i = 0; i < SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE; i++ )
+        {
+            if( ( journal_bench_rand( ) & 1 ) != 0 )
+            {
+                flash[i] = 0xFF;
+            }
+        }
+        longjmp( power_cut, 1 );
+    }
+    memset( flash, 0xFF, SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE );
+    nb_page_erases++;
+}
+
+void smtc_modem_hal_store_crashlog( uint8_t crashlog[CRASH_LOG_SIZE] )
+{
+    printf( "Panic in %s\n", ( const char* ) crashlog );
+}
+
+void smtc_modem_hal_set_crashlog_status( bool available )
+{
+}
+
+void smtc_modem_hal_reset_mcu( void )
+{
+    exit( 1 );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void journal_bench_reboot( void )
+{
+    memset( &journal_index, 0, sizeof( journal_index ) );
+    nb_restarts++;
+}
+
+static uint32_t journal_bench_count_operations( const modem_context_type_t type, const uint8_t* data,
+                                                const uint16_t size )
+{
+    static uint8_t               area[JOURNAL_BENCH_AREA_SIZE];
+    const smtc_context_journal_t index               = journal_index;
+    const uint32_t               nb_operations_start = nb_operations;
+    const uint32_t               nb_erases           = nb_page_erases;
+    const uint64_t               nb_bytes            = nb_bytes_written;
+
+    memcpy( area, journal_area, sizeof( area ) );
+    smtc_context_journal_store( type, data, size );
+
+    const uint32_t nb_store_operations = nb_operations - nb_operations_start;
+
+    memcpy( journal_area, area, sizeof( area ) );
+    journal_index    = index;
+    nb_page_erases   = nb_erases;
+    nb_bytes_written = nb_bytes;
+    return nb_store_operations;
+}
+
+static bool journal_bench_check( const modem_context_type_t cut_type, const uint8_t* cut_data,
+                                 journal_bench_result_t result[MODEM_CONTEXT_TYPE_SIZE] )
+{
+    bool is_cut_stored = false;
+
+    for( uint8_t type = 0; type < MODEM_CONTEXT_TYPE_SIZE; type++ )
+    {
+        const uint16_t size = journal_bench_context_sizes[type];
+        uint8_t        data[JOURNAL_BENCH_CONTEXT_SIZE_MAX];
+
+        smtc_context_journal_restore( ( modem_context_type_t ) type, data, size );
+        if( memcmp( data, contexts[type], size ) == 0 )
+        {
+            continue;
+        }
+        if( ( type == cut_type ) && ( memcmp( data, cut_data, size ) == 0 ) )
+        {
+            is_cut_stored = true;
+            continue;
+        }
+        result[type].nb_errors++;
+    }
+    return is_cut_stored;
+}
+
+static bool journal_bench_is_cut( void )
+{
+    nb_operations++;
+    if( power_cut_countdown < 0 )
+    {
+        return false;
+    }
+    if( power_cut_countdown == 0 )
+    {
+        return true;
+    }
+    power_cut_countdown--;
+    return false;
+}
+
+static uint32_t journal_bench_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, journal_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:c:e:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_stores = strtoul( optarg, NULL, 0 );
+            break;
+        case 'c':
+            params->cut_period = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n stores] [-c stores_per_power_cut] [-e seed]\n", argv[0] );
+            return false;
+        }
+    }
+    if( ( params->cut_period == 0 ) || ( params->seed == 0 ) )
+    {
+        printf( "The power cut period and the seed must be at least 1\n" );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,73 @@
+/**
+ * @file      crc32_reference.c
+ *
+ * @brief     Bitwise CRC-32 of the modem, replaced by the table-driven smtc_crc32.c
+ *
+ * These are crc_update() of smtc_modem_core/modem_services/modem_utilities.c and lr1mac_utilities_crc() of
+ * smtc_modem_core/lr1mac/src/lr1mac_utilities.c before smtc_crc32.c, suffixed by _reference.
+ *
+ * This is smtc_modem_core/radio_planner/src/radio_planner.c before its task heaps, with its public functions
+ * prefixed by rp_reference_ and its object renamed radio_planner_reference_t.
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "crc32_reference.h"
+
+uint32_t crc_reference_update( uint32_t crc, const uint8_t* buf, int len )
+{
+    crc = ~crc;
+    while( len-- > 0 )
+    {
+        crc = crc ^ *buf++;
+        for( int i = 0; i < 8; i++ )
+        {
+            uint32_t mask = -( crc & 1 );
+            crc           = ( crc >> 1 ) ^ ( 0xEDB88320 & mask );
+        }
+    }
+    return ~crc;
+}
+
+uint32_t lr1mac_utilities_crc_reference( const uint8_t* buf, int len )
+{
+    uint32_t crc = 0xFFFFFFFA;
+    while( len-- > 0 )
+    {
+        crc = crc ^ *buf++;
+        for( int i = 0; i < 8; i++ )
+        {
+            uint32_t mask = -( crc & 1 );
+            crc           = ( crc >> 1 ) ^ ( 0xEDB88320 & mask );
+        }
+    }
+    return ~crc + 3;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,427 @@
+/**
+ * @file      main_crc32_benchmark.c
+ *
+ * @brief     Checks the CRC-32 of the modem against its former bitwise code, and measures it
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+#include "crc32_reference.h"
+#include "lr1mac_utilities.h"
+#include "modem_utilities.h"
+#include "smtc_crc32.h"
+#include "smtc_modem_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define CRC32_BENCH_NB_BUFFERS_DEFAULT 20000
+#define CRC32_BENCH_NB_ITERATIONS_DEFAULT 2000
+#define CRC32_BENCH_NB_RUNS 10
+
+/**
+ * @brief Longest random buffer checked, in bytes, and the most parts it is split in
+ */
+#define CRC32_BENCH_BUFFER_SIZE_MAX 1024
+#define CRC32_BENCH_NB_PARTS_MAX 4
+
+/**
+ * @brief Room before the random buffers, so that they start at any alignment
+ */
+#define CRC32_BENCH_ALIGNMENT_MAX 8
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define CRC32_BENCH_UNIT "cycles"
+#else
+#define CRC32_BENCH_UNIT "ns"
+#endif
+
+/**
+ * @brief Buffer sizes of the benchmark, in bytes
+ *
+ * Header of a context journal record, a secure element context, the largest MACPayload, a file upload chunk, and a
+ * firmware image block.
+ */
+static const uint16_t crc32_bench_sizes[] = { 4, 48, 242, 1024, 4096 };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct crc32_bench_params_s
+{
+    uint32_t nb_buffers;
+    uint32_t nb_iterations;
+    uint32_t seed;
+} crc32_bench_params_t;
+
+/**
+ * @brief Checks that failed, by kind
+ */
+typedef struct crc32_bench_failures_s
+{
+    uint32_t whole;    //!< smtc_crc32() and crc() against the bitwise crc
+    uint32_t parts;    //!< smtc_crc32_init(), smtc_crc32_update() on each part and smtc_crc32_final()
+    uint32_t lr1mac;   //!< lr1mac_utilities_crc() against its bitwise code
+    uint32_t journal;  //!< Running crc of a record header then of its context, as the context journal
+} crc32_bench_failures_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint8_t  buffer_pool[CRC32_BENCH_ALIGNMENT_MAX + 4096];
+static uint32_t random_state = 1;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Check the CRC-32 against known answers
+ *
+ * @return Number of failed checks
+ */
+static uint32_t crc32_bench_check_known_answers( void );
+
+/**
+ * @brief Check the CRC-32 of a random buffer, whole and split in random parts, against the bitwise code
+ *
+ * @param [out] failures Checks that failed, by kind
+ */
+static void crc32_bench_check_random_buffer( crc32_bench_failures_t* failures );
+
+/**
+ * @brief Best time of a call, over CRC32_BENCH_NB_RUNS runs
+ *
+ * @param [in] run           Call measured
+ * @param [in] size          Size of the buffer, in bytes
+ * @param [in] nb_iterations Calls per run
+ *
+ * @return Time of a call, in CRC32_BENCH_UNIT
+ */
+static double crc32_bench_measure( uint32_t ( *run )( uint32_t crc, uint16_t size ), uint16_t size,
+                                   uint32_t nb_iterations );
+
+/**
+ * @brief Calls measured, each chained to the crc of the former call so that the calls cannot overlap
+ */
+static uint32_t crc32_bench_run_crc32( uint32_t crc, uint16_t size );
+static uint32_t crc32_bench_run_reference( uint32_t crc, uint16_t size );
+
+/**
+ * @brief Current time, in TSC cycles on x86 and in nanoseconds otherwise
+ */
+static uint64_t crc32_bench_ticks( void );
+
+/**
+ * @brief Xorshift pseudo-random generator
+ */
+static uint32_t crc32_bench_rand( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, crc32_bench_params_t* params );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    crc32_bench_params_t params = {
+        .nb_buffers    = CRC32_BENCH_NB_BUFFERS_DEFAULT,
+        .nb_iterations = CRC32_BENCH_NB_ITERATIONS_DEFAULT,
+        .seed          = 1,
+    };
+    crc32_bench_failures_t failures = { 0 };
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+    random_state = params.seed;
+
+#if defined( SMTC_CRC32_HAL )
+    printf( "CRC-32 benchmark: smtc_modem_hal_crc32_update(), bitwise here, %u random buffers, %u calls per run\n",
+            params.nb_buffers, params.nb_iterations );
+#elif defined( SMTC_CRC32_SLICE_BY_8 )
+    printf( "CRC-32 benchmark: slice-by-8 tables, %u random buffers, %u calls per run\n", params.nb_buffers,
+            params.nb_iterations );
+#else
+    printf( "CRC-32 benchmark: 4-bit table, %u random buffers, %u calls per run\n", params.nb_buffers,
+            params.nb_iterations );
+#endif
+
+    uint32_t nb_failed = crc32_bench_check_known_answers( );
+    for( uint32_t i = 0; i < params.nb_buffers; i++ )
+    {
+        crc32_bench_check_random_buffer( &failures );
+    }
+    nb_failed += failures.whole + failures.parts + failures.lr1mac + failures.journal;
+
+    printf( "\nRandom buffer checks failed: %u whole, %u in parts, %u lr1mac, %u journal\n", failures.whole,
+            failures.parts, failures.lr1mac, failures.journal );
+    if( nb_failed != 0 )
+    {
+        printf( "\nFAILED: %u checks\n", nb_failed );
+        return 1;
+    }
+    printf( "Every crc is the one of the bitwise code\n\n" );
+
+    printf( " Buffer   smtc_crc32 %-6s   bitwise %-6s   speedup\n", CRC32_BENCH_UNIT, CRC32_BENCH_UNIT );
+    printf( "  bytes      call   /byte       call   /byte\n" );
+    for( size_t i = 0; i < ( sizeof( crc32_bench_sizes ) / sizeof( crc32_bench_sizes[0] ) ); i++ )
+    {
+        const uint16_t size      = crc32_bench_sizes[i];
+        double         crc_time  = crc32_bench_measure( crc32_bench_run_crc32, size, params.nb_iterations );
+        double         reference = crc32_bench_measure( crc32_bench_run_reference, size, params.nb_iterations );
+
+        printf( "%7u  %8.0f  %6.2f   %8.0f  %6.2f   %7.1f\n", size, crc_time, crc_time / size, reference,
+                reference / size, reference / crc_time );
+    }
+    return 0;
+}
+
+uint32_t smtc_modem_hal_crc32_update( const uint32_t crc, const uint8_t* buffer, const uint32_t length )
+{
+    uint32_t running_crc = crc;
+
+    // Bit per bit, as a CRC unit, like the host HAL
+    for( uint32_t index = 0; index < length; index++ )
+    {
+        running_crc ^= buffer[index];
+        for( uint8_t bit = 0; bit < 8; bit++ )
+        {
+            running_crc = ( running_crc >> 1 ) ^ ( 0xEDB88320 & -( running_crc & 1 ) );
+        }
+    }
+    return running_crc;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint32_t crc32_bench_check_known_answers( void )
+{
+    const uint8_t check_string[] = "123456789";
+    uint32_t      nb_failed      = 0;
+
+    // Check value of CRC-32/ISO-HDLC, as zlib
+    if( smtc_crc32( check_string, 9 ) != 0xCBF43926 )
+    {
+        printf( "smtc_crc32(\"123456789\") is 0x%08X instead of 0xCBF43926\n", smtc_crc32( check_string, 9 ) );
+        nb_failed++;
+    }
+    if( smtc_crc32( check_string, 0 ) != 0 )
+    {
+        printf( "smtc_crc32() of no byte is 0x%08X instead of 0\n", smtc_crc32( check_string, 0 ) );
+        nb_failed++;
+    }
+    return nb_failed;
+}
+
+static void crc32_bench_check_random_buffer( crc32_bench_failures_t* failures )
+{
+    uint16_t length    = crc32_bench_rand( ) % ( CRC32_BENCH_BUFFER_SIZE_MAX + 1 );
+    uint8_t* buffer    = buffer_pool + crc32_bench_rand( ) % CRC32_BENCH_ALIGNMENT_MAX;
+    uint8_t  nb_parts  = 1 + crc32_bench_rand( ) % CRC32_BENCH_NB_PARTS_MAX;
+    uint16_t offset    = 0;
+    uint32_t crc_parts = smtc_crc32_init( );
+
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        buffer[i] = ( uint8_t ) crc32_bench_rand( );
+    }
+
+    const uint32_t reference = crc_reference_update( 0, buffer, length );
+
+    if( ( smtc_crc32( buffer, length ) != reference ) || ( crc( buffer, length ) != reference ) )
+    {
+        failures->whole++;
+    }
+
+    // The last part takes what is left
+    for( uint8_t part = 1; part <= nb_parts; part++ )
+    {
+        uint16_t part_length = length - offset;
+
+        if( part < nb_parts )
+        {
+            part_length = crc32_bench_rand( ) % ( part_length + 1 );
+        }
+
+        crc_parts = smtc_crc32_update( crc_parts, buffer + offset, part_length );
+        offset += part_length;
+    }
+    if( smtc_crc32_final( crc_parts ) != reference )
+    {
+        failures->parts++;
+    }
+
+    if( lr1mac_utilities_crc( buffer, length ) != lr1mac_utilities_crc_reference( buffer, length ) )
+    {
+        failures->lr1mac++;
+    }
+
+    // A journal record: a 4-byte header, then the context
+    if( length >= 4 )
+    {
+        uint32_t record_crc = smtc_crc32_update( smtc_crc32_init( ), buffer, 4 );
+
+        record_crc = smtc_crc32_final( smtc_crc32_update( record_crc, buffer + 4, length - 4 ) );
+        if( record_crc != crc_reference_update( crc_reference_update( 0, buffer, 4 ), buffer + 4, length - 4 ) )
+        {
+            failures->journal++;
+        }
+    }
+}
+
+static double crc32_bench_measure( uint32_t ( *run )( uint32_t crc, uint16_t size ), uint16_t size,
+                                   uint32_t nb_iterations )
+{
+    uint64_t best = UINT64_MAX;
+    uint32_t crc  = 0;
+
+    for( uint8_t r = 0; r < CRC32_BENCH_NB_RUNS; r++ )
+    {
+        uint64_t start = crc32_bench_ticks( );
+        for( uint32_t i = 0; i < nb_iterations; i++ )
+        {
+            crc = run( crc, size );
+        }
+        uint64_t ticks = crc32_bench_ticks( ) - start;
+        if( ticks < best )
+        {
+            best = ticks;
+        }
+    }
+
+    // Keep the calls from being optimized out
+    buffer_pool[0] ^= ( uint8_t ) crc;
+    return ( double ) best / nb_iterations;
+}
+
+static uint32_t crc32_bench_run_crc32( uint32_t crc, uint16_t size )
+{
+    buffer_pool[0] = ( uint8_t ) crc;
+    return smtc_crc32( buffer_pool, size );
+}
+
+static uint32_t crc32_bench_run_reference( uint32_t crc, uint16_t size )
+{
+    buffer_pool[0] = ( uint8_t ) crc;
+    return crc_reference_update( 0, buffer_pool, size );
+}
+
+static uint64_t crc32_bench_ticks( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+    return __rdtsc( );
+#else
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint64_t ) now.tv_sec * 1000000000u + ( uint64_t ) now.tv_nsec;
+#endif
+}
+
+static uint32_t crc32_bench_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, crc32_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:i:e:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_buffers = strtoul( optarg, NULL, 0 );
+            break;
+        case 'i':
+            params->nb_iterations = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n buffers] [-i calls per run] [-e seed]\n", argv[0] );
+            return false;
+        }
+    }
+    if( ( params->nb_iterations == 0 ) || ( params->seed == 0 ) )
+    {
+        printf( "The number of calls per run and the seed must be at least 1\n" );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,436 @@
+/**
+ * @file      main_crypto_benchmark.c
+ *
+ * @brief     Measures the soft crypto AES, AES-CTR and AES-CMAC over the LoRaWAN payload sizes
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#include <x86intrin.h>
+#endif
+
+#include "aes.h"
+#include "cmac.h"
+#include "smtc_modem_crypto.h"
+#include "smtc_modem_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define CRYPTO_BENCH_NB_ITERATIONS_DEFAULT 2000
+#define CRYPTO_BENCH_NB_RUNS 10
+#define CRYPTO_BENCH_PAYLOAD_SIZE_MAX 242
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define CRYPTO_BENCH_UNIT "cycles"
+#else
+#define CRYPTO_BENCH_UNIT "ns"
+#endif
+
+/**
+ * @brief Payload sizes of the benchmark, in bytes
+ *
+ * Largest FRMPayload of US915 DR0, of EU868 DR0 to DR2, of DR3 and of DR4 to DR7, then the largest MACPayload.
+ */
+static const uint8_t crypto_bench_payload_sizes[] = { 11, 51, 115, 222, 242 };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Known answer of a block encryption
+ */
+typedef struct crypto_bench_aes_vector_s
+{
+    uint8_t key_len;
+    uint8_t key[32];
+    uint8_t plain[16];
+    uint8_t cipher[16];
+} crypto_bench_aes_vector_t;
+
+/**
+ * @brief Known answer of a CMAC, over the first len bytes of crypto_bench_cmac_message
+ */
+typedef struct crypto_bench_cmac_vector_s
+{
+    uint8_t len;
+    uint8_t cmac[16];
+} crypto_bench_cmac_vector_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/**
+ * @brief FIPS-197 appendices B, C.1 and C.3
+ */
+static const crypto_bench_aes_vector_t crypto_bench_aes_vectors[] = {
+    { 16,
+      { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c },
+      { 0x32, 0x43, 0xf6, 0xa8, 0x88, 0x5a, 0x30, 0x8d, 0x31, 0x31, 0x98, 0xa2, 0xe0, 0x37, 0x07, 0x34 },
+      { 0x39, 0x25, 0x84, 0x1d, 0x02, 0xdc, 0x09, 0xfb, 0xdc, 0x11, 0x85, 0x97, 0x19, 0x6a, 0x0b, 0x32 } },
+    { 16,
+      { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f },
+      { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff },
+      { 0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30, 0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a } },
+    { 32,
+      { 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+        0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f },
+      { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff },
+      { 0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf, 0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89 } },
+};
+
+/**
+ * @brief RFC 4493 examples
+ */
+static const uint8_t crypto_bench_cmac_key[16] = { 0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+                                                   0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c };
+
+static const uint8_t crypto_bench_cmac_message[64] = {
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10,
+};
+
+static const crypto_bench_cmac_vector_t crypto_bench_cmac_vectors[] = {
+    { 0, { 0xbb, 0x1d, 0x69, 0x29, 0xe9, 0x59, 0x37, 0x28, 0x7f, 0xa3, 0x7d, 0x12, 0x9b, 0x75, 0x67, 0x46 } },
+    { 16, { 0x07, 0x0a, 0x16, 0xb4, 0x6b, 0x4d, 0x41, 0x44, 0xf7, 0x9b, 0xdd, 0x9d, 0xd0, 0x4a, 0x28, 0x7c } },
+    { 40, { 0xdf, 0xa6, 0x67, 0x47, 0xde, 0x9a, 0xe6, 0x30, 0x30, 0xca, 0x32, 0x61, 0x14, 0x97, 0xc8, 0x27 } },
+    { 64, { 0x51, 0xf0, 0xbe, 0xbf, 0x7e, 0x3b, 0x9d, 0x92, 0xfc, 0x49, 0x74, 0x17, 0x79, 0x36, 0x3c, 0xfe } },
+};
+
+static uint8_t  payload[CRYPTO_BENCH_PAYLOAD_SIZE_MAX];
+static uint8_t  payload_enc[CRYPTO_BENCH_PAYLOAD_SIZE_MAX];
+static uint32_t random_state = 1;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Check the block encryption, the CMAC and the payload encryption against known answers
+ *
+ * @return Number of failed checks
+ */
+static uint32_t crypto_bench_check( void );
+
+/**
+ * @brief Best time of a call to a crypto function, over CRYPTO_BENCH_NB_RUNS runs of nb_iterations calls
+ *
+ * @param [in] run           Function under test
+ * @param [in] size          Payload size given to the function
+ * @param [in] nb_iterations Number of calls per run
+ *
+ * @return Time of a call, in CRYPTO_BENCH_UNIT
+ */
+static double crypto_bench_measure( void ( *run )( uint8_t size ), uint8_t size, uint32_t nb_iterations );
+
+/**
+ * @brief Functions under test
+ *
+ * @param [in] size Payload size
+ */
+static void crypto_bench_run_aes_encrypt( uint8_t size );
+static void crypto_bench_run_payload_encrypt( uint8_t size );
+static void crypto_bench_run_cmac( uint8_t size );
+static void crypto_bench_run_mic( uint8_t size );
+
+/**
+ * @brief Current time, in CRYPTO_BENCH_UNIT
+ */
+static uint64_t crypto_bench_ticks( void );
+
+/**
+ * @brief Xorshift pseudo-random generator
+ */
+static uint32_t crypto_bench_rand( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc          Number of arguments
+ * @param [in]  argv          Arguments
+ * @param [out] nb_iterations Number of calls per run
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, uint32_t* nb_iterations );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    uint32_t nb_iterations = CRYPTO_BENCH_NB_ITERATIONS_DEFAULT;
+
+    if( parse_args( argc, argv, &nb_iterations ) == false )
+    {
+        return 1;
+    }
+
+    for( size_t i = 0; i < sizeof( payload ); i++ )
+    {
+        payload[i] = ( uint8_t ) crypto_bench_rand( );
+    }
+    smtc_secure_element_init( );
+    smtc_secure_element_set_key( SMTC_SE_APP_S_KEY, crypto_bench_cmac_key );
+    smtc_secure_element_set_key( SMTC_SE_NWK_S_ENC_KEY, crypto_bench_aes_vectors[1].key );
+
+#if defined( AES_ENC_T_TABLES )
+    printf( "Soft crypto benchmark: 32-bit T-table AES, %u calls per run\n", nb_iterations );
+#else
+    printf( "Soft crypto benchmark: byte-oriented AES, %u calls per run\n", nb_iterations );
+#endif
+
+    uint32_t nb_failed = crypto_bench_check( );
+    if( nb_failed != 0 )
+    {
+        printf( "\nFAILED: %u known answer checks\n", nb_failed );
+        return 1;
+    }
+    printf( "Known answer checks passed\n\n" );
+
+    double aes_time = crypto_bench_measure( crypto_bench_run_aes_encrypt, 16, nb_iterations );
+    printf( "aes_encrypt: %.0f %s/block, %.1f %s/byte\n\n", aes_time, CRYPTO_BENCH_UNIT, aes_time / 16,
+            CRYPTO_BENCH_UNIT );
+
+    printf( "Payload   CTR encrypt %-6s   CMAC with key %-6s   MIC with B0 %-6s\n", CRYPTO_BENCH_UNIT, CRYPTO_BENCH_UNIT,
+            CRYPTO_BENCH_UNIT );
+    printf( "  bytes      call   /byte        call   /byte        call   /byte\n" );
+    for( size_t i = 0; i < sizeof( crypto_bench_payload_sizes ); i++ )
+    {
+        const uint8_t size     = crypto_bench_payload_sizes[i];
+        double        ctr_time = crypto_bench_measure( crypto_bench_run_payload_encrypt, size, nb_iterations );
+        double        cmac     = crypto_bench_measure( crypto_bench_run_cmac, size, nb_iterations );
+        double        mic      = crypto_bench_measure( crypto_bench_run_mic, size, nb_iterations );
+
+        printf( "%7u  %8.0f  %6.1f    %8.0f  %6.1f    %8.0f  %6.1f\n", size, ctr_time, ctr_time / size, cmac,
+                cmac / size, mic, mic / size );
+    }
+    return 0;
+}
+
+void smtc_modem_hal_context_restore( const modem_context_type_t ctx_type, uint8_t* buffer, const uint32_t size )
+{
+    memset( buffer, 0, size );
+}
+
+void smtc_modem_hal_context_store( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size )
+{
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint32_t crypto_bench_check( void )
+{
+    uint32_t    nb_failed = 0;
+    aes_context ctx;
+    uint8_t     block[16];
+
+    for( size_t i = 0; i < sizeof( crypto_bench_aes_vectors ) / sizeof( crypto_bench_aes_vectors[0] ); i++ )
+    {
+        const crypto_bench_aes_vector_t* vector = &crypto_bench_aes_vectors[i];
+
+        aes_set_key( vector->key, vector->key_len, &ctx );
+        aes_encrypt( vector->plain, block, &ctx );
+        if( memcmp( block, vector->cipher, 16 ) != 0 )
+        {
+            printf( "aes_encrypt differs from FIPS-197 with a %u bits key\n", vector->key_len * 8 );
+            nb_failed++;
+        }
+    }
+
+    for( size_t i = 0; i < sizeof( crypto_bench_cmac_vectors ) / sizeof( crypto_bench_cmac_vectors[0] ); i++ )
+    {
+        const crypto_bench_cmac_vector_t* vector = &crypto_bench_cmac_vectors[i];
+        AES_CMAC_CTX                      cmac_ctx;
+
+        AES_CMAC_Init( &cmac_ctx );
+        AES_CMAC_SetKey( &cmac_ctx, crypto_bench_cmac_key );
+        AES_CMAC_Update( &cmac_ctx, crypto_bench_cmac_message, vector->len );
+        AES_CMAC_Final( block, &cmac_ctx );
+        if( memcmp( block, vector->cmac, 16 ) != 0 )
+        {
+            printf( "AES_CMAC differs from RFC 4493 over %u bytes\n", vector->len );
+            nb_failed++;
+        }
+    }
+
+    // The payload encryption is checked against the counter blocks of the LoRaWAN specification
+    aes_set_key( crypto_bench_cmac_key, 16, &ctx );
+    for( size_t i = 0; i < sizeof( crypto_bench_payload_sizes ); i++ )
+    {
+        const uint8_t size = crypto_bench_payload_sizes[i];
+        uint8_t       a_block[16] = { 0x01, 0, 0, 0, 0, 0x00, 0x04, 0x03, 0x02, 0x01, 0x0D, 0x0C, 0x0B, 0x0A, 0, 0 };
+        uint8_t       expected[CRYPTO_BENCH_PAYLOAD_SIZE_MAX];
+
+        for( uint8_t j = 0; j < size; j++ )
+        {
+            if( ( j % 16 ) == 0 )
+            {
+                a_block[15] = ( j / 16 ) + 1;
+                aes_encrypt( a_block, block, &ctx );
+            }
+            expected[j] = payload[j] ^ block[j % 16];
+        }
+        smtc_modem_crypto_payload_encrypt( payload, size, SMTC_SE_APP_S_KEY, 0x01020304, 0, 0x0A0B0C0D, payload_enc );
+        if( memcmp( payload_enc, expected, size ) != 0 )
+        {
+            printf( "smtc_modem_crypto_payload_encrypt differs from the counter blocks over %u bytes\n", size );
+            nb_failed++;
+        }
+    }
+    return nb_failed;
+}
+
+static double crypto_bench_measure( void ( *run )( uint8_t size ), uint8_t size, uint32_t nb_iterations )
+{
+    uint64_t best = UINT64_MAX;
+
+    for( uint8_t r = 0; r < CRYPTO_BENCH_NB_RUNS; r++ )
+    {
+        uint64_t start = crypto_bench_ticks( );
+        for( uint32_t i = 0; i < nb_iterations; i++ )
+        {
+            run( size );
+        }
+        uint64_t ticks = crypto_bench_ticks( ) - start;
+        if( ticks < best )
+        {
+            best = ticks;
+        }
+    }
+    return ( double ) best / nb_iterations;
+}
+
+static void crypto_bench_run_aes_encrypt( uint8_t size )
+{
+    static aes_context ctx;
+
+    if( ctx.rnd == 0 )
+    {
+        aes_set_key( crypto_bench_cmac_key, 16, &ctx );
+    }
+    // Chain the blocks so that the calls cannot overlap
+    aes_encrypt( payload_enc, payload_enc, &ctx );
+}
+
+static void crypto_bench_run_payload_encrypt( uint8_t size )
+{
+    smtc_modem_crypto_payload_encrypt( payload, size, SMTC_SE_APP_S_KEY, 0x01020304, 0, 0x0A0B0C0D, payload_enc );
+}
+
+static void crypto_bench_run_cmac( uint8_t size )
+{
+    AES_CMAC_CTX cmac_ctx;
+
+    AES_CMAC_Init( &cmac_ctx );
+    AES_CMAC_SetKey( &cmac_ctx, crypto_bench_cmac_key );
+    AES_CMAC_Update( &cmac_ctx, payload, size );
+    AES_CMAC_Final( payload_enc, &cmac_ctx );
+}
+
+static void crypto_bench_run_mic( uint8_t size )
+{
+    uint8_t  b0[16] = { 0x49, 0, 0, 0, 0, 0x00, 0x04, 0x03, 0x02, 0x01, 0x0D, 0x0C, 0x0B, 0x0A, 0x00, size };
+    uint32_t mic;
+
+    smtc_secure_element_compute_aes_cmac( b0, payload, size, SMTC_SE_NWK_S_ENC_KEY, &mic );
+}
+
+static uint64_t crypto_bench_ticks( void )
+{
+#if defined( __x86_64__ ) || defined( __i386__ )
+    return __rdtsc( );
+#else
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint64_t ) now.tv_sec * 1000000000u + ( uint64_t ) now.tv_nsec;
+#endif
+}
+
+static uint32_t crypto_bench_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, uint32_t* nb_iterations )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "i:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'i':
+            *nb_iterations = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-i calls_per_run]\n", argv[0] );
+            return false;
+        }
+    }
+    if( *nb_iterations == 0 )
+    {
+        printf( "The number of calls per run must be at least 1\n" );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
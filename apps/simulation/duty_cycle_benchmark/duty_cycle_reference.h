@@ -0,0 +1,157 @@
+/**
+ * @file      duty_cycle_reference.h
+ *
+ * @brief     Duty cycle before the running totals, to check smtc_duty_cycle.c against it
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef DUTY_CYCLE_REFERENCE_H
+#define DUTY_CYCLE_REFERENCE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "smtc_duty_cycle.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+// The index of the reference is computed in minutes
+#if( SMTC_DTC_SECONDS_BY_UNIT % 60 ) != 0
+#error "The reference duty cycle needs SMTC_DTC_SECONDS_BY_UNIT to be a multiple of 60"
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Duty cycle band before the running totals
+ */
+typedef struct smtc_dtc_reference_band_s
+{
+    uint32_t freq_min;
+    uint32_t freq_max;
+    uint16_t duty_cycle_regulation;
+    uint32_t toa_timestamp_ms;
+    uint8_t  index_previous;
+    uint16_t toa_sum_ms[SMTC_DTC_TOA_BUFF_SIZE];
+} smtc_dtc_reference_band_t;
+
+/**
+ * @brief Duty cycle object before the running totals
+ */
+typedef struct smtc_dtc_reference_s
+{
+    smtc_dtc_enablement_type_t enabled;
+    uint8_t                    number_of_bands;
+    smtc_dtc_reference_band_t  bands[SMTC_DTC_BANDS_MAX];
+} smtc_dtc_reference_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_init for the reference duty cycle
+ */
+void smtc_duty_cycle_reference_init( smtc_dtc_reference_t* dtc_obj );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_config for the reference duty cycle
+ */
+void smtc_duty_cycle_reference_config( smtc_dtc_reference_t* dtc_obj, uint8_t number_of_bands, uint8_t band_idx,
+                                       uint16_t duty_cycle_regulation, uint32_t freq_min, uint32_t freq_max );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_enable_set for the reference duty cycle
+ */
+uint8_t smtc_duty_cycle_reference_enable_set( smtc_dtc_reference_t* dtc_obj, smtc_dtc_enablement_type_t enable );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_enable_get for the reference duty cycle
+ */
+smtc_dtc_enablement_type_t smtc_duty_cycle_reference_enable_get( smtc_dtc_reference_t* dtc_obj );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_sum for the reference duty cycle
+ */
+void smtc_duty_cycle_reference_sum( smtc_dtc_reference_t* dtc_obj, uint32_t freq_hz, uint32_t toa_ms );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_update for the reference duty cycle
+ */
+void smtc_duty_cycle_reference_update( smtc_dtc_reference_t* dtc_obj );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_is_toa_accepted for the reference duty cycle
+ */
+bool smtc_duty_cycle_reference_is_toa_accepted( smtc_dtc_reference_t* dtc_obj, uint32_t freq_hz, uint32_t toa_ms );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_band_get_available_toa_ms for the reference duty cycle
+ */
+int32_t smtc_duty_cycle_reference_band_get_available_toa_ms( smtc_dtc_reference_t* dtc_obj, uint8_t band );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_is_channel_free for the reference duty cycle
+ */
+bool smtc_duty_cycle_reference_is_channel_free( smtc_dtc_reference_t* dtc_obj, uint32_t freq_hz );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_is_band_free for the reference duty cycle
+ */
+bool smtc_duty_cycle_reference_is_band_free( smtc_dtc_reference_t* dtc_obj, uint8_t band );
+
+/**
+ * @brief Same as @ref smtc_duty_cycle_get_next_free_time_ms for the reference duty cycle
+ */
+int32_t smtc_duty_cycle_reference_get_next_free_time_ms( smtc_dtc_reference_t* dtc_obj, uint8_t number_of_tx_freq,
+                                                         uint32_t* tx_freq_list );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // DUTY_CYCLE_REFERENCE_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,705 @@
+/**
+ * @file      main_duty_cycle_benchmark.c
+ *
+ * @brief     Replays random uplinks and queries on the duty cycle and on the reference duty cycle, and compares them
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "smtc_duty_cycle.h"
+#include "duty_cycle_reference.h"
+#include "smtc_modem_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define DTC_BENCH_NB_SEQUENCES_DEFAULT 400
+#define DTC_BENCH_NB_STEPS_DEFAULT 5000
+
+/**
+ * @brief Time origin of the sequences that cross the wrap-around of the millisecond clock
+ */
+#define DTC_BENCH_WRAP_AROUND_ORIGIN_MS ( 0xFFFFFFFFu - 4 * SMTC_DTC_PERIOD_MS )
+
+/**
+ * @brief Longest uplink of the busy sequences and of the quiet ones, in ms
+ */
+#define DTC_BENCH_BUSY_TOA_MAX_MS 3000
+#define DTC_BENCH_QUIET_TOA_MAX_MS 400
+
+/**
+ * @brief Queries timed, one per second of the mocked clock, with a 400 ms uplink every minute
+ */
+#define DTC_BENCH_NB_TIMED_QUERIES 200000
+
+/**
+ * @brief Trace records reserved per step: a step records one value per band at most
+ */
+#define DTC_BENCH_TRACE_PER_STEP SMTC_DTC_BANDS_MAX
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct dtc_bench_params_s
+{
+    uint32_t nb_sequences;
+    uint32_t nb_steps;
+    uint32_t seed;
+} dtc_bench_params_t;
+
+/**
+ * @brief Events of a trace
+ */
+typedef enum dtc_bench_event_e
+{
+    DTC_BENCH_EVENT_TOA_ACCEPTED,    //!< band: band of the uplink, value: the uplink is accepted
+    DTC_BENCH_EVENT_NEXT_FREE_TIME,  //!< value: next free time, or available time if negative
+    DTC_BENCH_EVENT_AVAILABLE_TOA,   //!< band: band queried, value: available TOA
+    DTC_BENCH_EVENT_CHANNEL_FREE,    //!< band: band of the channel, value: the channel is free
+} dtc_bench_event_t;
+
+/**
+ * @brief Trace record
+ */
+typedef struct dtc_bench_record_s
+{
+    uint32_t time_ms;
+    uint8_t  event;
+    uint8_t  band;
+    int32_t  value;
+} dtc_bench_record_t;
+
+/**
+ * @brief Trace of a sequence
+ */
+typedef struct dtc_bench_trace_s
+{
+    dtc_bench_record_t* records;
+    uint32_t            nb_records;
+    uint32_t            max_records;
+    uint32_t            nb_refused;  //!< Uplinks refused by the duty cycle
+} dtc_bench_trace_t;
+
+/**
+ * @brief Operations of a duty cycle under test
+ */
+typedef struct dtc_bench_duty_cycle_s
+{
+    void ( *init )( void );
+    void ( *sum )( uint32_t freq_hz, uint32_t toa_ms );
+    void ( *update )( void );
+    bool ( *is_toa_accepted )( uint32_t freq_hz, uint32_t toa_ms );
+    int32_t ( *band_get_available_toa_ms )( uint8_t band );
+    bool ( *is_channel_free )( uint32_t freq_hz );
+    int32_t ( *get_next_free_time_ms )( uint8_t number_of_tx_freq, uint32_t* tx_freq_list );
+} dtc_bench_duty_cycle_t;
+
+/**
+ * @brief Results of a kind of sequence
+ */
+typedef struct dtc_bench_result_s
+{
+    uint32_t nb_sequences;
+    uint64_t nb_records;
+    uint64_t nb_refused;
+    uint32_t nb_mismatches;
+} dtc_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static smtc_dtc_t           duty_cycle;
+static smtc_dtc_reference_t duty_cycle_reference;
+
+static dtc_bench_trace_t* trace;
+static uint32_t           now_ms;
+
+/**
+ * @brief Bands of EU868, as configured by region_eu_868.c
+ */
+static const uint16_t dtc_bench_band_regulation[SMTC_DTC_BANDS_MAX] = { 1000, 100, 100, 1000, 10, 100 };
+static const uint32_t dtc_bench_band_range[SMTC_DTC_BANDS_MAX][2]  = {
+    { 863000000, 865000000 }, { 865000000, 868000001 }, { 868000001, 868600001 },
+    { 868700000, 869200001 }, { 869400000, 869650001 }, { 869700000, 870000001 },
+};
+
+/**
+ * @brief Channels of the uplinks and queries, in every band
+ */
+static const uint32_t dtc_bench_channels[] = {
+    864100000, 864500000, 867100000, 867500000, 867900000, 868100000,
+    868300000, 868500000, 868800000, 869525000, 869850000,
+};
+
+#define DTC_BENCH_NB_CHANNELS ( sizeof( dtc_bench_channels ) / sizeof( dtc_bench_channels[0] ) )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Replay a sequence on a duty cycle
+ *
+ * @param [in]  params      Command line parameters
+ * @param [in]  ops         Duty cycle under test
+ * @param [in]  sequence_id Sequence number, the sequences with the same number are identical
+ * @param [out] out         Trace of the sequence
+ */
+static void dtc_bench_replay( const dtc_bench_params_t* params, const dtc_bench_duty_cycle_t* ops,
+                              uint32_t sequence_id, dtc_bench_trace_t* out );
+
+/**
+ * @brief Compare the traces of a sequence, and print the first difference
+ *
+ * @return true if the traces are identical
+ */
+static bool dtc_bench_compare( uint32_t sequence_id, const dtc_bench_trace_t* trace_duty_cycle,
+                               const dtc_bench_trace_t* trace_reference );
+
+/**
+ * @brief Time an update followed by a next free time query, as done by the stack before each uplink
+ *
+ * @param [in] ops Duty cycle under test
+ *
+ * @return Time of an update and a query, in nanoseconds
+ */
+static double dtc_bench_time_queries( const dtc_bench_duty_cycle_t* ops );
+
+/**
+ * @brief Add a record to the trace
+ */
+static void dtc_bench_record( dtc_bench_event_t event, uint8_t band, int32_t value );
+
+/**
+ * @brief Band of a channel
+ */
+static uint8_t dtc_bench_get_band( uint32_t freq_hz );
+
+/**
+ * @brief Integer hash used as pseudo-random generator, so that a draw does not depend on the former ones
+ */
+static uint32_t dtc_bench_hash( uint32_t x );
+
+/**
+ * @brief Current time, in nanoseconds
+ */
+static uint64_t dtc_bench_ns( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, dtc_bench_params_t* params );
+
+/**
+ * @brief Operations of the duty cycle
+ */
+static void    dtc_bench_init( void );
+static void    dtc_bench_sum( uint32_t freq_hz, uint32_t toa_ms );
+static void    dtc_bench_update( void );
+static bool    dtc_bench_is_toa_accepted( uint32_t freq_hz, uint32_t toa_ms );
+static int32_t dtc_bench_band_get_available_toa_ms( uint8_t band );
+static bool    dtc_bench_is_channel_free( uint32_t freq_hz );
+static int32_t dtc_bench_get_next_free_time_ms( uint8_t number_of_tx_freq, uint32_t* tx_freq_list );
+
+/**
+ * @brief Operations of the reference duty cycle
+ */
+static void    dtc_bench_reference_init( void );
+static void    dtc_bench_reference_sum( uint32_t freq_hz, uint32_t toa_ms );
+static void    dtc_bench_reference_update( void );
+static bool    dtc_bench_reference_is_toa_accepted( uint32_t freq_hz, uint32_t toa_ms );
+static int32_t dtc_bench_reference_band_get_available_toa_ms( uint8_t band );
+static bool    dtc_bench_reference_is_channel_free( uint32_t freq_hz );
+static int32_t dtc_bench_reference_get_next_free_time_ms( uint8_t number_of_tx_freq, uint32_t* tx_freq_list );
+
+/**
+ * @brief Duty cycles under test
+ */
+static const dtc_bench_duty_cycle_t dtc_bench_duty_cycle = {
+    .init                      = dtc_bench_init,
+    .sum                       = dtc_bench_sum,
+    .update                    = dtc_bench_update,
+    .is_toa_accepted           = dtc_bench_is_toa_accepted,
+    .band_get_available_toa_ms = dtc_bench_band_get_available_toa_ms,
+    .is_channel_free           = dtc_bench_is_channel_free,
+    .get_next_free_time_ms     = dtc_bench_get_next_free_time_ms,
+};
+
+static const dtc_bench_duty_cycle_t dtc_bench_duty_cycle_reference = {
+    .init                      = dtc_bench_reference_init,
+    .sum                       = dtc_bench_reference_sum,
+    .update                    = dtc_bench_reference_update,
+    .is_toa_accepted           = dtc_bench_reference_is_toa_accepted,
+    .band_get_available_toa_ms = dtc_bench_reference_band_get_available_toa_ms,
+    .is_channel_free           = dtc_bench_reference_is_channel_free,
+    .get_next_free_time_ms     = dtc_bench_reference_get_next_free_time_ms,
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    dtc_bench_params_t params = {
+        .nb_sequences = DTC_BENCH_NB_SEQUENCES_DEFAULT,
+        .nb_steps     = DTC_BENCH_NB_STEPS_DEFAULT,
+        .seed         = 1,
+    };
+    dtc_bench_trace_t  trace_duty_cycle;
+    dtc_bench_trace_t  trace_reference;
+    dtc_bench_result_t results[4]    = { 0 };
+    uint32_t           nb_mismatches = 0;
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+
+    trace_duty_cycle.max_records = params.nb_steps * DTC_BENCH_TRACE_PER_STEP;
+    trace_reference.max_records  = trace_duty_cycle.max_records;
+    trace_duty_cycle.records     = malloc( trace_duty_cycle.max_records * sizeof( dtc_bench_record_t ) );
+    trace_reference.records      = malloc( trace_reference.max_records * sizeof( dtc_bench_record_t ) );
+    if( ( trace_duty_cycle.records == NULL ) || ( trace_reference.records == NULL ) )
+    {
+        printf( "Cannot allocate the traces\n" );
+        return 1;
+    }
+
+    printf( "Duty cycle benchmark: %u sequences of %u steps, %u s slots, %u slots per band\n\n", params.nb_sequences,
+            params.nb_steps, SMTC_DTC_SECONDS_BY_UNIT, ( unsigned ) SMTC_DTC_TOA_BUFF_SIZE );
+    for( uint32_t s = 0; s < params.nb_sequences; s++ )
+    {
+        // A third of the sequences cross the wrap-around of the clock, half of them with busy bands
+        uint32_t            kind   = ( ( ( s % 3 ) == 0 ) ? 2 : 0 ) + ( s & 1 );
+        dtc_bench_result_t* result = &results[kind];
+
+        dtc_bench_replay( &params, &dtc_bench_duty_cycle, s, &trace_duty_cycle );
+        dtc_bench_replay( &params, &dtc_bench_duty_cycle_reference, s, &trace_reference );
+        result->nb_records += trace_reference.nb_records;
+        result->nb_refused += trace_reference.nb_refused;
+        result->nb_sequences++;
+        if( dtc_bench_compare( s, &trace_duty_cycle, &trace_reference ) == false )
+        {
+            result->nb_mismatches++;
+            if( kind < 2 )
+            {
+                nb_mismatches++;
+            }
+        }
+    }
+
+    printf( "\n clock origin   traffic   sequences   records/seq   refused/seq   mismatches\n" );
+    for( uint32_t kind = 0; kind < 4; kind++ )
+    {
+        const dtc_bench_result_t* result = &results[kind];
+
+        if( result->nb_sequences == 0 )
+        {
+            continue;
+        }
+        printf( "%13s   %7s   %9u   %11.0f   %11.1f   %10u\n", ( kind >= 2 ) ? "wrap-around" : "start",
+                ( ( kind & 1 ) != 0 ) ? "busy" : "quiet", result->nb_sequences,
+                ( double ) result->nb_records / result->nb_sequences,
+                ( double ) result->nb_refused / result->nb_sequences, result->nb_mismatches );
+    }
+
+    printf( "\nUpdate and next free time query: %.0f ns, %.0f ns with the reference duty cycle\n",
+            dtc_bench_time_queries( &dtc_bench_duty_cycle ),
+            dtc_bench_time_queries( &dtc_bench_duty_cycle_reference ) );
+
+    free( trace_duty_cycle.records );
+    free( trace_reference.records );
+    if( nb_mismatches != 0 )
+    {
+        printf( "\nFAILED: %u sequences differ from the reference duty cycle\n", nb_mismatches );
+        return 1;
+    }
+    printf( "\nThe duty cycles gave the same trace for every sequence that does not cross the wrap-around\n" );
+    return 0;
+}
+
+uint32_t smtc_modem_hal_get_time_in_ms( void )
+{
+    return now_ms;
+}
+
+void smtc_modem_hal_store_crashlog( uint8_t crashlog[CRASH_LOG_SIZE] )
+{
+    printf( "FAILED: panic in %s\n", crashlog );
+}
+
+void smtc_modem_hal_set_crashlog_status( bool available )
+{
+}
+
+void smtc_modem_hal_reset_mcu( void )
+{
+    exit( 1 );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void dtc_bench_replay( const dtc_bench_params_t* params, const dtc_bench_duty_cycle_t* ops,
+                              uint32_t sequence_id, dtc_bench_trace_t* out )
+{
+    uint32_t random  = params->seed + sequence_id;
+    uint32_t toa_max = ( ( sequence_id & 1 ) != 0 ) ? DTC_BENCH_BUSY_TOA_MAX_MS : DTC_BENCH_QUIET_TOA_MAX_MS;
+
+    now_ms          = ( ( sequence_id % 3 ) == 0 ) ? DTC_BENCH_WRAP_AROUND_ORIGIN_MS : 1000 + random * 7919u;
+    out->nb_records = 0;
+    out->nb_refused = 0;
+    trace           = out;
+
+    ops->init( );
+    for( uint32_t step = 0; step < params->nb_steps; step++ )
+    {
+        random          = dtc_bench_hash( random + 0x9E3779B9u );
+        uint32_t rand_1 = dtc_bench_hash( random );
+        uint32_t rand_2 = dtc_bench_hash( random + 1 );
+        uint32_t freq   = dtc_bench_channels[rand_2 % DTC_BENCH_NB_CHANNELS];
+
+        // Mostly a few seconds between two steps, sometimes minutes, and from time to time more than the period
+        switch( rand_1 % 50 )
+        {
+        case 0:
+            now_ms += rand_2 % ( 2 * SMTC_DTC_PERIOD_MS );
+            break;
+        case 1:
+        case 2:
+        case 3:
+        case 4:
+            now_ms += rand_2 % ( SMTC_DTC_PERIOD_MS / 2 );
+            break;
+        default:
+            now_ms += ( ( rand_1 & 0x100 ) != 0 ) ? rand_2 % 600000 : rand_2 % 3000;
+            break;
+        }
+
+        ops->update( );
+        switch( random % 8 )
+        {
+        case 0:
+        case 1:
+        case 2:
+        {
+            uint32_t toa_ms   = 1 + rand_1 % toa_max;
+            bool     accepted = ops->is_toa_accepted( freq, toa_ms );
+
+            dtc_bench_record( DTC_BENCH_EVENT_TOA_ACCEPTED, dtc_bench_get_band( freq ), accepted );
+            if( accepted == true )
+            {
+                ops->sum( freq, toa_ms );
+            }
+            else
+            {
+                out->nb_refused++;
+            }
+            break;
+        }
+        case 3:
+        case 4:
+        case 5:
+        {
+            uint32_t tx_freq_list[DTC_BENCH_NB_CHANNELS];
+            uint8_t  number_of_tx_freq = 1 + rand_1 % DTC_BENCH_NB_CHANNELS;
+
+            for( uint8_t i = 0; i < number_of_tx_freq; i++ )
+            {
+                tx_freq_list[i] = dtc_bench_channels[( rand_2 + i ) % DTC_BENCH_NB_CHANNELS];
+            }
+            dtc_bench_record( DTC_BENCH_EVENT_NEXT_FREE_TIME, 0,
+                              ops->get_next_free_time_ms( number_of_tx_freq, tx_freq_list ) );
+            break;
+        }
+        case 6:
+            for( uint8_t band = 0; band < SMTC_DTC_BANDS_MAX; band++ )
+            {
+                dtc_bench_record( DTC_BENCH_EVENT_AVAILABLE_TOA, band, ops->band_get_available_toa_ms( band ) );
+            }
+            break;
+        default:
+            dtc_bench_record( DTC_BENCH_EVENT_CHANNEL_FREE, dtc_bench_get_band( freq ), ops->is_channel_free( freq ) );
+            break;
+        }
+    }
+}
+
+static bool dtc_bench_compare( uint32_t sequence_id, const dtc_bench_trace_t* trace_duty_cycle,
+                               const dtc_bench_trace_t* trace_reference )
+{
+    uint32_t nb_records = ( trace_duty_cycle->nb_records < trace_reference->nb_records )
+                              ? trace_duty_cycle->nb_records
+                              : trace_reference->nb_records;
+
+    for( uint32_t i = 0; i < nb_records; i++ )
+    {
+        const dtc_bench_record_t* record           = &trace_duty_cycle->records[i];
+        const dtc_bench_record_t* record_reference = &trace_reference->records[i];
+
+        if( ( record->time_ms != record_reference->time_ms ) || ( record->event != record_reference->event ) ||
+            ( record->band != record_reference->band ) || ( record->value != record_reference->value ) )
+        {
+            printf( "Sequence %u, record %u: event %u band %u at %u ms (%d) instead of event %u band %u at %u ms "
+                    "(%d)\n",
+                    sequence_id, i, record->event, record->band, record->time_ms, record->value,
+                    record_reference->event, record_reference->band, record_reference->time_ms,
+                    record_reference->value );
+            return false;
+        }
+    }
+    if( trace_duty_cycle->nb_records != trace_reference->nb_records )
+    {
+        printf( "Sequence %u: %u records instead of %u\n", sequence_id, trace_duty_cycle->nb_records,
+                trace_reference->nb_records );
+        return false;
+    }
+    return true;
+}
+
+static double dtc_bench_time_queries( const dtc_bench_duty_cycle_t* ops )
+{
+    uint32_t tx_freq_list[DTC_BENCH_NB_CHANNELS];
+    int32_t  check = 0;
+
+    memcpy( tx_freq_list, dtc_bench_channels, sizeof( tx_freq_list ) );
+    now_ms = 1000;
+    ops->init( );
+
+    uint64_t start = dtc_bench_ns( );
+    for( uint32_t i = 0; i < DTC_BENCH_NB_TIMED_QUERIES; i++ )
+    {
+        now_ms += 1000;
+        if( ( i % 60 ) == 0 )
+        {
+            ops->sum( dtc_bench_channels[( i / 60 ) % DTC_BENCH_NB_CHANNELS], 400 );
+        }
+        ops->update( );
+        check += ops->get_next_free_time_ms( DTC_BENCH_NB_CHANNELS, tx_freq_list );
+    }
+    uint64_t end = dtc_bench_ns( );
+
+    // Keep the queries from being optimized out
+    if( check == INT32_MIN )
+    {
+        printf( "\n" );
+    }
+    return ( double ) ( end - start ) / DTC_BENCH_NB_TIMED_QUERIES;
+}
+
+static void dtc_bench_record( dtc_bench_event_t event, uint8_t band, int32_t value )
+{
+    if( trace->nb_records < trace->max_records )
+    {
+        trace->records[trace->nb_records] = ( dtc_bench_record_t ){
+            .time_ms = now_ms,
+            .event   = ( uint8_t ) event,
+            .band    = band,
+            .value   = value,
+        };
+    }
+    trace->nb_records++;
+}
+
+static uint8_t dtc_bench_get_band( uint32_t freq_hz )
+{
+    for( uint8_t band = 0; band < SMTC_DTC_BANDS_MAX; band++ )
+    {
+        if( ( freq_hz >= dtc_bench_band_range[band][0] ) && ( freq_hz < dtc_bench_band_range[band][1] ) )
+        {
+            return band;
+        }
+    }
+    return 0;
+}
+
+static uint32_t dtc_bench_hash( uint32_t x )
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint64_t dtc_bench_ns( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint64_t ) now.tv_sec * 1000000000u + ( uint64_t ) now.tv_nsec;
+}
+
+static bool parse_args( int argc, char** argv, dtc_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:e:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_sequences = strtoul( optarg, NULL, 0 );
+            break;
+        case 's':
+            params->nb_steps = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n sequences] [-s steps] [-e seed]\n", argv[0] );
+            return false;
+        }
+    }
+    if( ( params->nb_sequences == 0 ) || ( params->nb_steps == 0 ) )
+    {
+        printf( "The number of sequences and of steps must be at least 1\n" );
+        return false;
+    }
+    return true;
+}
+
+static void dtc_bench_init( void )
+{
+    smtc_duty_cycle_init( &duty_cycle );
+    for( uint8_t band = 0; band < SMTC_DTC_BANDS_MAX; band++ )
+    {
+        smtc_duty_cycle_config( &duty_cycle, SMTC_DTC_BANDS_MAX, band, dtc_bench_band_regulation[band],
+                                dtc_bench_band_range[band][0], dtc_bench_band_range[band][1] );
+    }
+    smtc_duty_cycle_enable_set( &duty_cycle, SMTC_DTC_ENABLED );
+}
+
+static void dtc_bench_sum( uint32_t freq_hz, uint32_t toa_ms )
+{
+    smtc_duty_cycle_sum( &duty_cycle, freq_hz, toa_ms );
+}
+
+static void dtc_bench_update( void )
+{
+    smtc_duty_cycle_update( &duty_cycle );
+}
+
+static bool dtc_bench_is_toa_accepted( uint32_t freq_hz, uint32_t toa_ms )
+{
+    return smtc_duty_cycle_is_toa_accepted( &duty_cycle, freq_hz, toa_ms );
+}
+
+static int32_t dtc_bench_band_get_available_toa_ms( uint8_t band )
+{
+    return smtc_duty_cycle_band_get_available_toa_ms( &duty_cycle, band );
+}
+
+static bool dtc_bench_is_channel_free( uint32_t freq_hz )
+{
+    return smtc_duty_cycle_is_channel_free( &duty_cycle, freq_hz );
+}
+
+static int32_t dtc_bench_get_next_free_time_ms( uint8_t number_of_tx_freq, uint32_t* tx_freq_list )
+{
+    return smtc_duty_cycle_get_next_free_time_ms( &duty_cycle, number_of_tx_freq, tx_freq_list );
+}
+
+static void dtc_bench_reference_init( void )
+{
+    smtc_duty_cycle_reference_init( &duty_cycle_reference );
+    for( uint8_t band = 0; band < SMTC_DTC_BANDS_MAX; band++ )
+    {
+        smtc_duty_cycle_reference_config( &duty_cycle_reference, SMTC_DTC_BANDS_MAX, band,
+                                          dtc_bench_band_regulation[band], dtc_bench_band_range[band][0],
+                                          dtc_bench_band_range[band][1] );
+    }
+    smtc_duty_cycle_reference_enable_set( &duty_cycle_reference, SMTC_DTC_ENABLED );
+}
+
+static void dtc_bench_reference_sum( uint32_t freq_hz, uint32_t toa_ms )
+{
+    smtc_duty_cycle_reference_sum( &duty_cycle_reference, freq_hz, toa_ms );
+}
+
+static void dtc_bench_reference_update( void )
+{
+    smtc_duty_cycle_reference_update( &duty_cycle_reference );
+}
+
+static bool dtc_bench_reference_is_toa_accepted( uint32_t freq_hz, uint32_t toa_ms )
+{
+    return smtc_duty_cycle_reference_is_toa_accepted( &duty_cycle_reference, freq_hz, toa_ms );
+}
+
+static int32_t dtc_bench_reference_band_get_available_toa_ms( uint8_t band )
+{
+    return smtc_duty_cycle_reference_band_get_available_toa_ms( &duty_cycle_reference, band );
+}
+
+static bool dtc_bench_reference_is_channel_free( uint32_t freq_hz )
+{
+    return smtc_duty_cycle_reference_is_channel_free( &duty_cycle_reference, freq_hz );
+}
+
+static int32_t dtc_bench_reference_get_next_free_time_ms( uint8_t number_of_tx_freq, uint32_t* tx_freq_list )
+{
+    return smtc_duty_cycle_reference_get_next_free_time_ms( &duty_cycle_reference, number_of_tx_freq, tx_freq_list );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
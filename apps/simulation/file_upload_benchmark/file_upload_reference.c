@@ -0,0 +1,163 @@
+/**
+ * @file      file_upload_reference.c
+ *
+ * @brief     Bit by bit file upload fragment generator the bit-scanning one is checked against
+ *
+ * This is file_upload_get_fragment() of smtc_modem_core/smtc_modem_services/src/file_upload/file_upload.c before the
+ * check bits of its coded chunks were bit-scanned, for a file in RAM.
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "file_upload_defs.h"
+#include "file_upload_reference.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// number of words per chunk
+#define CHUNK_NW ( 2 )
+
+// size of the file upload header
+#define FILE_UPLOAD_HEADER_SIZE ( 12 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+static uint32_t phash( uint32_t x );
+static uint32_t checkbits( uint32_t cid, uint32_t cct, uint32_t i );
+static void     function_xor( uint32_t* dst, const uint32_t* src, int32_t nw );
+
+/**
+ * @brief Get a chunk of the header and file
+ *
+ * @param [in]  file_upload Pointer to File Upload context
+ * @param [in]  i           Index of the chunk
+ * @param [out] chunk       Chunk
+ */
+static void get_chunk( const file_upload_t* file_upload, uint32_t i, uint32_t* chunk );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int32_t file_upload_reference_fragment( const file_upload_t* file_upload, uint8_t* buf, int32_t len, uint32_t fcnt )
+{
+    if( ( len - 3 ) < ( CHUNK_NW * 4 ) )
+    {
+        return 0;
+    }
+    len = len - 3;
+
+    uint32_t d = ( ( file_upload->sid & 0x03 ) << 14 ) | ( ( file_upload->session_counter & 0x0F ) << 10 ) |
+                 ( ( file_upload->cct - 1 ) & 0x03FF );
+    int32_t  n   = 0;
+    uint32_t cid = phash( fcnt );
+    buf[n++]     = FILE_UPLOAD_TOKEN;
+    buf[n++]     = d;
+    buf[n++]     = d >> 8;
+
+    while( len >= ( CHUNK_NW * 4 ) )
+    {
+        uint32_t dst[CHUNK_NW] = { 0 };
+        uint32_t src[CHUNK_NW];
+        uint32_t bits = 0;
+
+        for( uint32_t i = 0; i < file_upload->cct; i++ )
+        {
+            if( ( i & 31 ) == 0 )
+            {
+                bits = checkbits( cid, file_upload->cct, i >> 5 );
+            }
+            if( bits & 1 )
+            {
+                get_chunk( file_upload, i, src );
+                function_xor( dst, src, CHUNK_NW );
+            }
+            bits >>= 1;
+        }
+        memcpy( buf + n, dst, CHUNK_NW * 4 );
+        n += CHUNK_NW * 4;
+        len -= CHUNK_NW * 4;
+        cid++;
+    }
+    return n;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint32_t phash( uint32_t x )
+{
+    x = ( ( x >> 16 ) ^ x ) * 0x45d9f3b;
+    x = ( ( x >> 16 ) ^ x ) * 0x45d9f3b;
+    x = ( ( x >> 16 ) ^ x );
+    return x;
+}
+
+static uint32_t checkbits( uint32_t cid, uint32_t cct, uint32_t i )
+{
+    uint32_t ncw = ( cct + 31 ) >> 5;  // number of checkwords per chunk
+    return phash( cid * ncw + i );
+}
+
+static void function_xor( uint32_t* dst, const uint32_t* src, int32_t nw )
+{
+    while( nw-- > 0 )
+    {
+        *dst++ ^= *src++;
+    }
+}
+
+static void get_chunk( const file_upload_t* file_upload, uint32_t i, uint32_t* chunk )
+{
+    uint32_t w = i * CHUNK_NW;  // index of the first word in the header and file
+
+    for( uint32_t k = 0; k < CHUNK_NW; k++, w++ )
+    {
+        chunk[k] = ( w < ( FILE_UPLOAD_HEADER_SIZE / 4 ) ) ? file_upload->header[w]
+                                                           : file_upload->file_buf[w - ( FILE_UPLOAD_HEADER_SIZE / 4 )];
+    }
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,311 @@
+/**
+ * @file      main_file_upload_benchmark.c
+ *
+ * @brief     Host benchmark of the file upload fragment generation, checked against the bit by bit generator
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "file_upload.h"
+#include "file_upload_reference.h"
+#include "smtc_modem_services_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define FILE_UPLOAD_BENCH_NB_FRAGMENTS_DEFAULT 200
+#define FILE_UPLOAD_BENCH_FRAGMENT_SIZE_DEFAULT 242
+
+// largest file of a file upload session, FILE_UPLOAD_MAX_SIZE
+#define FILE_UPLOAD_BENCH_MAX_FILE_SIZE ( ( 8 * 1024 ) - 12 )
+
+/**
+ * @brief File sizes of the benchmark
+ */
+static const uint16_t file_upload_bench_sizes[] = { 64, 256, 1024, 4096, FILE_UPLOAD_BENCH_MAX_FILE_SIZE };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct file_upload_bench_params_s
+{
+    uint32_t nb_fragments;
+    uint8_t  fragment_size;
+    uint32_t seed;
+} file_upload_bench_params_t;
+
+/**
+ * @brief Results of a file size
+ */
+typedef struct file_upload_bench_result_s
+{
+    uint32_t fragment_len;  //!< Fragment size in bytes
+    uint64_t buffer_ns;     //!< Time spent in file_upload_get_fragment() for a file in RAM
+    uint64_t reader_ns;     //!< Time spent in file_upload_get_fragment() for a file read through a callback
+    uint64_t reference_ns;  //!< Time spent in the reference fragment generator
+    uint32_t nb_errors;     //!< Fragments that differ from the reference
+} file_upload_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+// The fragment generation reads the last chunk of a file in RAM in full
+static uint32_t      file[( FILE_UPLOAD_BENCH_MAX_FILE_SIZE + 8 ) / 4];
+static file_upload_t file_upload;
+static file_upload_t file_upload_reader;
+static uint32_t      random_state;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Generate nb_fragments fragments of a file, and check them
+ *
+ * @param [in]  params    Command line parameters
+ * @param [in]  file_size File size in bytes
+ * @param [out] result    Results
+ */
+static void file_upload_bench_run( const file_upload_bench_params_t* params, uint16_t file_size,
+                                   file_upload_bench_result_t* result );
+
+/**
+ * @brief Reader of the file, for the file upload attached with a reader
+ */
+static bool file_upload_bench_read( uint32_t offset, uint8_t* data, uint16_t size );
+
+/**
+ * @brief Current time, in nanoseconds
+ */
+static uint64_t file_upload_bench_ns( void );
+
+/**
+ * @brief Xorshift pseudo-random generator
+ */
+static uint32_t file_upload_bench_rand( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, file_upload_bench_params_t* params );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    file_upload_bench_params_t params = {
+        .nb_fragments  = FILE_UPLOAD_BENCH_NB_FRAGMENTS_DEFAULT,
+        .fragment_size = FILE_UPLOAD_BENCH_FRAGMENT_SIZE_DEFAULT,
+        .seed          = 1,
+    };
+    uint32_t nb_errors = 0;
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+
+    printf( "File upload benchmark: %u-byte fragments, %u fragments per file\n\n", params.fragment_size,
+            params.nb_fragments );
+    printf( "  file size   chunks   buffer frags/s   reader frags/s   reference frags/s   speedup\n" );
+    for( size_t i = 0; i < sizeof( file_upload_bench_sizes ) / sizeof( file_upload_bench_sizes[0] ); i++ )
+    {
+        file_upload_bench_result_t result;
+
+        file_upload_bench_run( &params, file_upload_bench_sizes[i], &result );
+        printf( "  %9u   %6u   %14.0f   %14.0f   %17.0f   %7.1f\n", file_upload_bench_sizes[i],
+                ( file_upload_bench_sizes[i] + 12 + 7 ) / 8, params.nb_fragments * 1e9 / ( double ) result.buffer_ns,
+                params.nb_fragments * 1e9 / ( double ) result.reader_ns,
+                params.nb_fragments * 1e9 / ( double ) result.reference_ns,
+                ( double ) result.reference_ns / ( double ) result.buffer_ns );
+        nb_errors += result.nb_errors;
+    }
+
+    if( nb_errors != 0 )
+    {
+        printf( "\nFAILED: %u fragments differ from the reference\n", nb_errors );
+        return 1;
+    }
+    printf( "\nAll the fragments match the reference\n" );
+    return 0;
+}
+
+void smtc_modem_services_aes_encrypt( const uint8_t* raw_buffer, uint16_t size, uint8_t aes_ctr_nonce[14],
+                                      uint8_t* enc_buffer )
+{
+    // The files are not enciphered by the benchmark
+    memmove( enc_buffer, raw_buffer, size );
+}
+
+void smtc_modem_services_aes_encrypt_at( const uint8_t* raw_buffer, uint16_t size, uint8_t aes_ctr_nonce[14],
+                                         uint16_t block_index, uint8_t* enc_buffer )
+{
+    memmove( enc_buffer, raw_buffer, size );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void file_upload_bench_run( const file_upload_bench_params_t* params, uint16_t file_size,
+                                   file_upload_bench_result_t* result )
+{
+    uint8_t fragment[255];
+    uint8_t fragment_reader[255];
+    uint8_t reference[255];
+
+    memset( result, 0, sizeof( file_upload_bench_result_t ) );
+    random_state = params->seed;
+
+    memset( file, 0, sizeof( file ) );
+    for( uint16_t i = 0; i < file_size; i++ )
+    {
+        ( ( uint8_t* ) file )[i] = ( uint8_t ) file_upload_bench_rand( );
+    }
+    file_upload_init( &file_upload, 1, file_size, 0, 200, FILE_UPLOAD_NOT_ENCRYPTED, 0 );
+    file_upload_attach_file_buffer( &file_upload, ( const uint8_t* ) file );
+    file_upload_prepare_upload( &file_upload );
+    file_upload_init( &file_upload_reader, 1, file_size, 0, 200, FILE_UPLOAD_NOT_ENCRYPTED, 0 );
+    file_upload_attach_file_reader( &file_upload_reader, file_upload_bench_read );
+    file_upload_prepare_upload( &file_upload_reader );
+
+    for( uint32_t f = 0; f < params->nb_fragments; f++ )
+    {
+        uint32_t fcnt = file_upload_bench_rand( );
+
+        uint64_t start = file_upload_bench_ns( );
+        int32_t  len   = file_upload_get_fragment( &file_upload, fragment, params->fragment_size, fcnt );
+        result->buffer_ns += file_upload_bench_ns( ) - start;
+
+        start = file_upload_bench_ns( );
+        file_upload_get_fragment( &file_upload_reader, fragment_reader, params->fragment_size, fcnt );
+        result->reader_ns += file_upload_bench_ns( ) - start;
+
+        start = file_upload_bench_ns( );
+        file_upload_reference_fragment( &file_upload, reference, params->fragment_size, fcnt );
+        result->reference_ns += file_upload_bench_ns( ) - start;
+
+        if( ( memcmp( fragment, reference, len ) != 0 ) || ( memcmp( fragment_reader, reference, len ) != 0 ) )
+        {
+            result->nb_errors++;
+        }
+        result->fragment_len = len;
+    }
+}
+
+static bool file_upload_bench_read( uint32_t offset, uint8_t* data, uint16_t size )
+{
+    memcpy( data, ( const uint8_t* ) file + offset, size );
+    return true;
+}
+
+static uint64_t file_upload_bench_ns( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint64_t ) now.tv_sec * 1000000000u + ( uint64_t ) now.tv_nsec;
+}
+
+static uint32_t file_upload_bench_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, file_upload_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:e:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_fragments = strtoul( optarg, NULL, 0 );
+            break;
+        case 's':
+            params->fragment_size = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n fragments] [-s fragment_size] [-e seed]\n", argv[0] );
+            return false;
+        }
+    }
+    if( params->nb_fragments == 0 || params->seed == 0 )
+    {
+        printf( "The number of fragments and the seed must be at least 1\n" );
+        return false;
+    }
+    if( params->fragment_size < 11 )
+    {
+        printf( "The fragment must hold a chunk, 11 bytes\n" );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,483 @@
+/**
+ * @file      main_fleet_simulator.c
+ *
+ * @brief     Discrete-event simulation of a fleet of LoRa Basics Modem devices sharing a gateway
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "main_fleet_simulator.h"
+#include "sim_channel.h"
+#include "sim_device.h"
+#include "sim_network_server.h"
+
+#include "smtc_modem_hal_sim.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/**
+ * @brief Number of LoRaWAN datarates reported
+ */
+#define FLEET_SIM_NB_DR 8
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Simulation parameters
+ */
+typedef struct fleet_sim_config_s
+{
+    uint32_t nb_devices;
+    uint32_t duration_s;
+    uint32_t uplink_period_s;
+    uint8_t  payload_size;
+    uint8_t  confirmed_percent;
+    float    radius_in_m;
+    uint32_t seed;
+    bool     trace_enabled;
+} fleet_sim_config_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static sim_device_t*                 devices;
+static sim_network_server_session_t* sessions;
+static sim_channel_t                 channel;
+static sim_network_server_t          network_server;
+static uint32_t                      random_state;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Radio transmission callback of all the devices: put the frame on the channel
+ */
+static void on_radio_tx( ral_sim_context_t* radio, const uint8_t* buffer, uint16_t size, uint32_t time_on_air_in_us );
+
+/**
+ * @brief Gateway reception callback: forward the frame to the network server and deliver its answer
+ */
+static void on_gateway_rx( void* context, const sim_channel_transmission_t* transmission,
+                           sim_channel_rx_status_t status );
+
+/**
+ * @brief Get the EU868 datarate of a LoRa modulation
+ */
+static uint8_t get_dr( const ral_lora_sf_t sf, const ral_lora_bw_t bw );
+
+/**
+ * @brief Random generator of the simulation setup (device placement and credentials)
+ */
+static uint32_t fleet_sim_rand( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @returns False if the simulation must not run
+ */
+static bool parse_args( int argc, char** argv, fleet_sim_config_t* config );
+
+/**
+ * @brief Print the simulation results
+ */
+static void print_report( const fleet_sim_config_t* config );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    fleet_sim_config_t config = {
+        .nb_devices        = FLEET_SIM_NB_DEVICES_DEFAULT,
+        .duration_s        = FLEET_SIM_DURATION_S_DEFAULT,
+        .uplink_period_s   = FLEET_SIM_UPLINK_PERIOD_S_DEFAULT,
+        .payload_size      = FLEET_SIM_PAYLOAD_SIZE_DEFAULT,
+        .confirmed_percent = FLEET_SIM_CONFIRMED_PERCENT_DEFAULT,
+        .radius_in_m       = FLEET_SIM_RADIUS_M_DEFAULT,
+        .seed              = FLEET_SIM_SEED_DEFAULT,
+        .trace_enabled     = false,
+    };
+
+    if( parse_args( argc, argv, &config ) == false )
+    {
+        return 1;
+    }
+
+    devices  = calloc( config.nb_devices, sizeof( sim_device_t ) );
+    sessions = calloc( config.nb_devices, sizeof( sim_network_server_session_t ) );
+    if( ( devices == NULL ) || ( sessions == NULL ) )
+    {
+        fprintf( stderr, "Not enough memory for %u devices\n", config.nb_devices );
+        return 1;
+    }
+
+    random_state = ( config.seed != 0 ) ? config.seed : 1;
+    smtc_modem_hal_sim_init( config.seed );
+    smtc_modem_hal_sim_set_trace_enabled( false );
+    smtc_modem_hal_sim_set_select_callback( sim_device_on_node_selected );
+    sim_channel_init( &channel, on_gateway_rx, NULL );
+    sim_network_server_init( &network_server, sessions, config.nb_devices, FLEET_SIM_NET_ID );
+
+    for( uint32_t i = 0; i < config.nb_devices; i++ )
+    {
+        sim_device_config_t device_config = {
+            .dev_eui           = { 0x00, 0x16, 0xC0, 0x01, ( uint8_t ) ( i >> 24 ), ( uint8_t ) ( i >> 16 ),
+                         ( uint8_t ) ( i >> 8 ), ( uint8_t ) i },
+            .join_eui          = { 0x00, 0x16, 0xC0, 0x01, 0xFF, 0xFE, 0x00, 0x01 },
+            .seed              = fleet_sim_rand( ),
+            .distance_in_m     = config.radius_in_m * sqrtf( ( float ) ( fleet_sim_rand( ) % 10001 ) / 10000.0f ),
+            .uplink_period_s   = config.uplink_period_s,
+            .payload_size      = config.payload_size,
+            .confirmed_percent = config.confirmed_percent,
+            .start_time_s      = fleet_sim_rand( ) % config.uplink_period_s,
+            .trace_enabled     = ( config.trace_enabled == true ) && ( i == 0 ),
+        };
+
+        for( int k = 0; k < 16; k++ )
+        {
+            device_config.app_key[k] = ( uint8_t ) fleet_sim_rand( );
+        }
+
+        sim_network_server_add_device( &network_server, device_config.dev_eui, device_config.join_eui,
+                                       device_config.app_key );
+        sim_device_init( &devices[i], i, &device_config, on_radio_tx );
+    }
+
+    const uint64_t end_time_in_us = ( uint64_t ) config.duration_s * 1000000;
+
+    for( ;; )
+    {
+        uint64_t next_time_in_us = end_time_in_us;
+        uint64_t time_in_us;
+
+        if( ( sim_channel_get_next_end_time( &channel, &time_in_us ) == true ) && ( time_in_us < next_time_in_us ) )
+        {
+            next_time_in_us = time_in_us;
+        }
+        for( uint32_t i = 0; i < config.nb_devices; i++ )
+        {
+            if( ( sim_device_get_next_action_time( &devices[i], &time_in_us ) == true ) &&
+                ( time_in_us < next_time_in_us ) )
+            {
+                next_time_in_us = time_in_us;
+            }
+        }
+
+        // Radio and timer interrupts of the devices come first
+        smtc_modem_hal_sim_node_t* node = smtc_modem_hal_sim_run_next_event( next_time_in_us );
+
+        if( node != NULL )
+        {
+            sim_device_process( ( sim_device_t* ) node->user_context );
+            continue;
+        }
+
+        if( next_time_in_us >= end_time_in_us )
+        {
+            break;
+        }
+
+        sim_channel_process( &channel, next_time_in_us );
+
+        for( uint32_t i = 0; i < config.nb_devices; i++ )
+        {
+            if( ( sim_device_get_next_action_time( &devices[i], &time_in_us ) == true ) &&
+                ( time_in_us <= next_time_in_us ) )
+            {
+                sim_device_select( &devices[i] );
+                sim_device_process( &devices[i] );
+            }
+        }
+    }
+
+    print_report( &config );
+
+    free( devices );
+    free( sessions );
+    return 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void on_radio_tx( ral_sim_context_t* radio, const uint8_t* buffer, uint16_t size, uint32_t time_on_air_in_us )
+{
+    sim_device_t* device = ( sim_device_t* ) radio->user_context;
+    const uint8_t dr     = get_dr( radio->lora_mod_params.sf, radio->lora_mod_params.bw );
+
+    sim_channel_add_transmission( &channel, smtc_modem_hal_sim_get_time_in_us( ), time_on_air_in_us, radio,
+                                  radio->output_pwr_in_dbm - device->path_loss_in_db, device, buffer, size );
+
+    device->stats.tx_time_in_us += time_on_air_in_us;
+    if( dr < FLEET_SIM_NB_DR )
+    {
+        device->stats.nb_tx_per_dr[dr]++;
+    }
+}
+
+static void on_gateway_rx( void* context, const sim_channel_transmission_t* transmission,
+                           sim_channel_rx_status_t status )
+{
+    uint8_t  downlink[SIM_NETWORK_SERVER_DOWNLINK_MAX_SIZE];
+    uint16_t downlink_size = 0;
+
+    if( ( status != SIM_CHANNEL_RX_OK ) ||
+        ( sim_network_server_process_uplink( &network_server, transmission->buffer, transmission->size,
+                                             get_dr( transmission->sf, transmission->bw ), transmission->snr_in_db,
+                                             downlink, &downlink_size ) == false ) )
+    {
+        return;
+    }
+
+    // The link is symmetric, downlinks are not subject to collisions
+    sim_device_t* device      = ( sim_device_t* ) transmission->emitter;
+    const float   rssi_in_dbm = FLEET_SIM_GATEWAY_TX_POWER_DBM - device->path_loss_in_db;
+    const float   snr_in_db   = sim_channel_get_snr_in_db( rssi_in_dbm, transmission->bw );
+
+    if( snr_in_db >= sim_channel_get_snr_floor_in_db( transmission->sf ) )
+    {
+        sim_device_select( device );
+        sim_device_set_downlink( device, downlink, downlink_size, ( int16_t ) rssi_in_dbm, ( int16_t ) snr_in_db );
+    }
+}
+
+static uint8_t get_dr( const ral_lora_sf_t sf, const ral_lora_bw_t bw )
+{
+    if( bw == RAL_LORA_BW_250_KHZ )
+    {
+        return 6;
+    }
+    return ( sf <= RAL_LORA_SF12 ) && ( sf >= RAL_LORA_SF7 ) ? ( uint8_t ) ( RAL_LORA_SF12 - sf ) : FLEET_SIM_NB_DR;
+}
+
+static uint32_t fleet_sim_rand( void )
+{
+    // xorshift32
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, fleet_sim_config_t* config )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:d:p:l:c:r:s:vh" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            config->nb_devices = strtoul( optarg, NULL, 0 );
+            break;
+        case 'd':
+            config->duration_s = strtoul( optarg, NULL, 0 );
+            break;
+        case 'p':
+            config->uplink_period_s = strtoul( optarg, NULL, 0 );
+            break;
+        case 'l':
+            config->payload_size = ( uint8_t ) strtoul( optarg, NULL, 0 );
+            break;
+        case 'c':
+            config->confirmed_percent = ( uint8_t ) strtoul( optarg, NULL, 0 );
+            break;
+        case 'r':
+            config->radius_in_m = strtof( optarg, NULL );
+            break;
+        case 's':
+            config->seed = strtoul( optarg, NULL, 0 );
+            break;
+        case 'v':
+            config->trace_enabled = true;
+            break;
+        case 'h':
+        default:
+            printf( "Usage: %s [-n devices] [-d duration_s] [-p uplink_period_s] [-l payload_size] "
+                    "[-c confirmed_percent] [-r radius_m] [-s seed] [-v]\n",
+                    argv[0] );
+            printf( "  -v prints the modem trace of the first device\n" );
+            return false;
+        }
+    }
+
+    if( ( config->nb_devices == 0 ) || ( config->uplink_period_s == 0 ) || ( config->confirmed_percent > 100 ) )
+    {
+        fprintf( stderr, "Invalid parameters\n" );
+        return false;
+    }
+    return true;
+}
+
+static void print_report( const fleet_sim_config_t* config )
+{
+    const sim_channel_stats_t*        ch = &channel.stats;
+    const sim_network_server_stats_t* ns = &network_server.stats;
+    uint32_t                          nb_joined         = 0;
+    uint64_t                          join_time_sum_us  = 0;
+    uint64_t                          tx_time_sum_us    = 0;
+    uint64_t                          tx_time_max_us    = 0;
+    uint32_t                          nb_join_requests  = 0;
+    uint32_t                          nb_uplinks        = 0;
+    uint32_t                          nb_confirmed      = 0;
+    uint32_t                          nb_acks           = 0;
+    uint32_t                          nb_dtc_blocked    = 0;
+    uint32_t                          nb_send_errors    = 0;
+    uint32_t                          nb_nvm_erases     = 0;
+    uint64_t                          nb_nvm_bytes      = 0;
+    uint32_t                          nb_tx_per_dr[FLEET_SIM_NB_DR]          = { 0 };
+    uint32_t                          final_dr[FLEET_SIM_NB_DR]              = { 0 };
+    float                             final_dr_distance_max[FLEET_SIM_NB_DR] = { 0 };
+
+    for( uint32_t i = 0; i < config->nb_devices; i++ )
+    {
+        const sim_device_stats_t* stats = &devices[i].stats;
+
+        if( stats->join_time_in_us != 0 )
+        {
+            nb_joined++;
+            join_time_sum_us += stats->join_time_in_us;
+            if( devices[i].lr1_mac.tx_data_rate < FLEET_SIM_NB_DR )
+            {
+                final_dr[devices[i].lr1_mac.tx_data_rate]++;
+                if( devices[i].distance_in_m > final_dr_distance_max[devices[i].lr1_mac.tx_data_rate] )
+                {
+                    final_dr_distance_max[devices[i].lr1_mac.tx_data_rate] = devices[i].distance_in_m;
+                }
+            }
+        }
+        tx_time_sum_us += stats->tx_time_in_us;
+        if( stats->tx_time_in_us > tx_time_max_us )
+        {
+            tx_time_max_us = stats->tx_time_in_us;
+        }
+        nb_join_requests += stats->nb_join_requests;
+        nb_uplinks += stats->nb_uplinks;
+        nb_confirmed += stats->nb_confirmed_uplinks;
+        nb_acks += stats->nb_acks;
+        nb_dtc_blocked += stats->nb_duty_cycle_blocked;
+        nb_send_errors += stats->nb_send_errors;
+
+        // Each store of the HAL erases a page
+        const smtc_modem_hal_sim_stats_t* node_stats = &devices[i].node.stats;
+        for( int ctx_type = 0; ctx_type < MODEM_CONTEXT_TYPE_SIZE; ctx_type++ )
+        {
+            nb_nvm_erases += node_stats->nb_context_stores[ctx_type];
+            nb_nvm_bytes += node_stats->nb_context_store_bytes[ctx_type];
+        }
+        nb_nvm_erases += node_stats->nb_context_journal_erases;
+        nb_nvm_bytes += node_stats->nb_context_journal_write_bytes;
+        for( int dr = 0; dr < FLEET_SIM_NB_DR; dr++ )
+        {
+            nb_tx_per_dr[dr] += stats->nb_tx_per_dr[dr];
+        }
+    }
+
+    const double duration_us = ( double ) config->duration_s * 1e6;
+
+    printf( "Fleet simulation: %u devices, %u s, uplink every %u s, %u bytes, %u%% confirmed, radius %.0f m, "
+            "seed %u\n",
+            config->nb_devices, config->duration_s, config->uplink_period_s, config->payload_size,
+            config->confirmed_percent, config->radius_in_m, config->seed );
+
+    printf( "\nChannel\n" );
+    printf( "  transmissions        %u\n", ch->nb_transmissions );
+    printf( "  received             %u (%.1f%%)\n", ch->nb_rx_ok,
+            ( ch->nb_transmissions != 0 ) ? 100.0 * ch->nb_rx_ok / ch->nb_transmissions : 0.0 );
+    printf( "  lost in collisions   %u\n", ch->nb_rx_collision );
+    printf( "  below sensitivity    %u\n", ch->nb_rx_below_sensitivity );
+    printf( "  captured             %u\n", ch->nb_rx_captured );
+    printf( "  not tracked          %u\n", ch->nb_dropped );
+    printf( "  gateway load         %.2f Erlang\n", ( double ) tx_time_sum_us / duration_us );
+
+    printf( "\nNetwork server\n" );
+    printf( "  join requests        %u, accepted %u\n", ns->nb_join_requests, ns->nb_join_accepts );
+    printf( "  uplinks              %u, duplicates %u, MIC errors %u\n", ns->nb_uplinks, ns->nb_duplicates,
+            ns->nb_mic_errors );
+    printf( "  ACKs sent            %u\n", ns->nb_acks );
+    printf( "  LinkADRReq sent      %u, LinkADRAns ok %u, ko %u\n", ns->nb_link_adr_reqs, ns->nb_link_adr_ans_ok,
+            ns->nb_link_adr_ans_ko );
+
+    printf( "\nDevices\n" );
+    printf( "  joined               %u / %u", nb_joined, config->nb_devices );
+    if( nb_joined != 0 )
+    {
+        printf( ", mean join time %.1f s", ( double ) join_time_sum_us / nb_joined / 1e6 );
+    }
+    printf( "\n" );
+    printf( "  join requests        %u\n", nb_join_requests );
+    printf( "  uplinks              %u, confirmed %u, acked %u\n", nb_uplinks, nb_confirmed, nb_acks );
+    printf( "  duty-cycle postponed %u\n", nb_dtc_blocked );
+    printf( "  refused by the stack %u\n", nb_send_errors );
+    printf( "  duty-cycle usage     mean %.3f%%, max %.3f%%\n",
+            100.0 * tx_time_sum_us / config->nb_devices / duration_us, 100.0 * tx_time_max_us / duration_us );
+    printf( "  NVM page erases      %u, %llu bytes written\n", nb_nvm_erases, ( unsigned long long ) nb_nvm_bytes );
+
+    printf( "\nDatarate     transmissions  joined devices at end  farthest of them\n" );
+    for( int dr = 0; dr < FLEET_SIM_NB_DR; dr++ )
+    {
+        if( ( nb_tx_per_dr[dr] != 0 ) || ( final_dr[dr] != 0 ) )
+        {
+            printf( "  DR%d        %13u  %21u  %14.0f m\n", dr, nb_tx_per_dr[dr], final_dr[dr],
+                    ( double ) final_dr_distance_max[dr] );
+        }
+    }
+}
+
+/* --- EOF ------------------------------------------------------------------ */
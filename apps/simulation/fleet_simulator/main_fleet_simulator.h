@@ -0,0 +1,100 @@
+/**
+ * @file      main_fleet_simulator.h
+ *
+ * @brief     Discrete-event simulation of a fleet of LoRa Basics Modem devices sharing a gateway
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAIN_FLEET_SIMULATOR_H
+#define MAIN_FLEET_SIMULATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- Simulation Configuration ------------------------------------------------
+ */
+
+/*!
+ * @brief Number of simulated devices (-n)
+ */
+#define FLEET_SIM_NB_DEVICES_DEFAULT 100
+
+/*!
+ * @brief Simulated duration, in [s] (-d)
+ */
+#define FLEET_SIM_DURATION_S_DEFAULT 3600
+
+/*!
+ * @brief Mean period between two uplinks of a device, in [s] (-p)
+ */
+#define FLEET_SIM_UPLINK_PERIOD_S_DEFAULT 300
+
+/*!
+ * @brief Application payload size, in [bytes] (-l)
+ */
+#define FLEET_SIM_PAYLOAD_SIZE_DEFAULT 12
+
+/*!
+ * @brief Share of confirmed uplinks, in [%] (-c)
+ */
+#define FLEET_SIM_CONFIRMED_PERCENT_DEFAULT 10
+
+/*!
+ * @brief Radius of the disk the devices are uniformly spread on, gateway at the center, in [m] (-r)
+ */
+#define FLEET_SIM_RADIUS_M_DEFAULT 300
+
+/*!
+ * @brief Seed of the simulation, the same seed gives the same run (-s)
+ */
+#define FLEET_SIM_SEED_DEFAULT 1
+
+/*!
+ * @brief Gateway downlink transmit power, in [dBm]
+ */
+#define FLEET_SIM_GATEWAY_TX_POWER_DBM 14
+
+/*!
+ * @brief NetID of the network server stand-in
+ */
+#define FLEET_SIM_NET_ID 0x000013
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MAIN_FLEET_SIMULATOR_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,348 @@
+/**
+ * @file      sim_channel.c
+ *
+ * @brief     Shared radio channel model of the fleet simulator
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sim_channel.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Get the earliest transmission over at the given time and not processed yet
+ *
+ * @param [in] channel      Channel
+ * @param [in] time_in_us   Current time
+ *
+ * @returns Transmission, NULL if none
+ */
+static sim_channel_transmission_t* sim_channel_get_next_ended( sim_channel_t* channel, const uint64_t time_in_us );
+
+/**
+ * @brief Resolve the gateway reception of a transmission against the ones overlapping it
+ *
+ * @param [in] channel      Channel
+ * @param [in] transmission Transmission
+ * @param [out] is_captured True if the transmission collided but was captured
+ *
+ * @returns Reception outcome
+ */
+static sim_channel_rx_status_t sim_channel_resolve( const sim_channel_t*              channel,
+                                                    const sim_channel_transmission_t* transmission, bool* is_captured );
+
+/**
+ * @brief Remove the processed transmissions which cannot overlap a transmission still to be resolved
+ *
+ * @param [in] channel      Channel
+ * @param [in] time_in_us   Current time
+ */
+static void sim_channel_purge( sim_channel_t* channel, const uint64_t time_in_us );
+
+/**
+ * @brief Get the bandwidth in Hz
+ *
+ * @param [in] bw LoRa bandwidth
+ *
+ * @returns Bandwidth in Hz
+ */
+static float sim_channel_get_bw_in_hz( const ral_lora_bw_t bw );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void sim_channel_init( sim_channel_t* channel, sim_channel_rx_callback_t rx_callback, void* rx_context )
+{
+    memset( channel, 0, sizeof( sim_channel_t ) );
+    channel->capture_threshold_in_db = SIM_CHANNEL_DEFAULT_CAPTURE_THRESHOLD_DB;
+    channel->rx_callback             = rx_callback;
+    channel->rx_context              = rx_context;
+}
+
+bool sim_channel_add_transmission( sim_channel_t* channel, const uint64_t start_time_in_us, const uint32_t toa_in_us,
+                                   const ral_sim_context_t* radio, const float rssi_in_dbm, void* emitter,
+                                   const uint8_t* buffer, const uint16_t size )
+{
+    channel->stats.nb_transmissions++;
+
+    if( ( radio->pkt_type != RAL_PKT_TYPE_LORA ) || ( channel->nb_transmissions >= SIM_CHANNEL_MAX_TRANSMISSIONS ) )
+    {
+        channel->stats.nb_dropped++;
+        return false;
+    }
+
+    sim_channel_transmission_t* transmission = &channel->transmissions[channel->nb_transmissions++];
+
+    transmission->start_time_in_us = start_time_in_us;
+    transmission->end_time_in_us   = start_time_in_us + toa_in_us;
+    transmission->freq_in_hz       = radio->rf_freq_in_hz;
+    transmission->sf               = radio->lora_mod_params.sf;
+    transmission->bw               = radio->lora_mod_params.bw;
+    transmission->rssi_in_dbm      = rssi_in_dbm;
+    transmission->snr_in_db        = sim_channel_get_snr_in_db( rssi_in_dbm, radio->lora_mod_params.bw );
+    transmission->emitter          = emitter;
+    transmission->size             = ( size < RAL_SIM_BUFFER_SIZE ) ? size : RAL_SIM_BUFFER_SIZE;
+    transmission->is_processed     = false;
+    memcpy( transmission->buffer, buffer, transmission->size );
+
+    return true;
+}
+
+bool sim_channel_get_next_end_time( const sim_channel_t* channel, uint64_t* end_time_in_us )
+{
+    bool is_found = false;
+
+    for( uint32_t i = 0; i < channel->nb_transmissions; i++ )
+    {
+        const sim_channel_transmission_t* transmission = &channel->transmissions[i];
+
+        if( ( transmission->is_processed == false ) &&
+            ( ( is_found == false ) || ( transmission->end_time_in_us < *end_time_in_us ) ) )
+        {
+            *end_time_in_us = transmission->end_time_in_us;
+            is_found        = true;
+        }
+    }
+    return is_found;
+}
+
+void sim_channel_process( sim_channel_t* channel, const uint64_t time_in_us )
+{
+    sim_channel_transmission_t* transmission;
+
+    while( ( transmission = sim_channel_get_next_ended( channel, time_in_us ) ) != NULL )
+    {
+        bool                    is_captured = false;
+        sim_channel_rx_status_t status      = sim_channel_resolve( channel, transmission, &is_captured );
+
+        transmission->is_processed = true;
+
+        switch( status )
+        {
+        case SIM_CHANNEL_RX_OK:
+            channel->stats.nb_rx_ok++;
+            if( is_captured == true )
+            {
+                channel->stats.nb_rx_captured++;
+            }
+            break;
+        case SIM_CHANNEL_RX_BELOW_SENSITIVITY:
+            channel->stats.nb_rx_below_sensitivity++;
+            break;
+        case SIM_CHANNEL_RX_COLLISION:
+        default:
+            channel->stats.nb_rx_collision++;
+            break;
+        }
+
+        if( channel->rx_callback != NULL )
+        {
+            channel->rx_callback( channel->rx_context, transmission, status );
+        }
+    }
+
+    sim_channel_purge( channel, time_in_us );
+}
+
+float sim_channel_get_path_loss_in_db( const float distance_in_m )
+{
+    float distance = ( distance_in_m > 1.0f ) ? distance_in_m : 1.0f;
+
+    return SIM_CHANNEL_PATH_LOSS_REF_DB +
+           10.0f * SIM_CHANNEL_PATH_LOSS_EXPONENT * log10f( distance / SIM_CHANNEL_PATH_LOSS_REF_DISTANCE_M );
+}
+
+float sim_channel_get_snr_in_db( const float rssi_in_dbm, const ral_lora_bw_t bw )
+{
+    // Thermal noise: -174 dBm/Hz
+    const float noise_floor_in_dbm = -174.0f + 10.0f * log10f( sim_channel_get_bw_in_hz( bw ) ) +
+                                     SIM_CHANNEL_NOISE_FIGURE_DB;
+
+    return rssi_in_dbm - noise_floor_in_dbm;
+}
+
+float sim_channel_get_snr_floor_in_db( const ral_lora_sf_t sf )
+{
+    switch( sf )
+    {
+    case RAL_LORA_SF5:
+        return -2.5f;
+    case RAL_LORA_SF6:
+        return -5.0f;
+    case RAL_LORA_SF7:
+        return -7.5f;
+    case RAL_LORA_SF8:
+        return -10.0f;
+    case RAL_LORA_SF9:
+        return -12.5f;
+    case RAL_LORA_SF10:
+        return -15.0f;
+    case RAL_LORA_SF11:
+        return -17.5f;
+    case RAL_LORA_SF12:
+    default:
+        return -20.0f;
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static sim_channel_transmission_t* sim_channel_get_next_ended( sim_channel_t* channel, const uint64_t time_in_us )
+{
+    sim_channel_transmission_t* next = NULL;
+
+    for( uint32_t i = 0; i < channel->nb_transmissions; i++ )
+    {
+        sim_channel_transmission_t* transmission = &channel->transmissions[i];
+
+        if( ( transmission->is_processed == false ) && ( transmission->end_time_in_us <= time_in_us ) &&
+            ( ( next == NULL ) || ( transmission->end_time_in_us < next->end_time_in_us ) ) )
+        {
+            next = transmission;
+        }
+    }
+    return next;
+}
+
+static sim_channel_rx_status_t sim_channel_resolve( const sim_channel_t*              channel,
+                                                    const sim_channel_transmission_t* transmission, bool* is_captured )
+{
+    if( transmission->snr_in_db < sim_channel_get_snr_floor_in_db( transmission->sf ) )
+    {
+        return SIM_CHANNEL_RX_BELOW_SENSITIVITY;
+    }
+
+    // Different spreading factors are considered orthogonal, only same frequency and same SF packets interfere
+    for( uint32_t i = 0; i < channel->nb_transmissions; i++ )
+    {
+        const sim_channel_transmission_t* other = &channel->transmissions[i];
+
+        if( ( other == transmission ) || ( other->freq_in_hz != transmission->freq_in_hz ) ||
+            ( other->sf != transmission->sf ) || ( other->bw != transmission->bw ) ||
+            ( other->start_time_in_us >= transmission->end_time_in_us ) ||
+            ( other->end_time_in_us <= transmission->start_time_in_us ) )
+        {
+            continue;
+        }
+
+        if( ( transmission->rssi_in_dbm - other->rssi_in_dbm ) < channel->capture_threshold_in_db )
+        {
+            return SIM_CHANNEL_RX_COLLISION;
+        }
+        *is_captured = true;
+    }
+    return SIM_CHANNEL_RX_OK;
+}
+
+static void sim_channel_purge( sim_channel_t* channel, const uint64_t time_in_us )
+{
+    // Future transmissions start after the current time, pending ones at their own start time
+    uint64_t oldest_start_in_us = time_in_us;
+
+    for( uint32_t i = 0; i < channel->nb_transmissions; i++ )
+    {
+        const sim_channel_transmission_t* transmission = &channel->transmissions[i];
+
+        if( ( transmission->is_processed == false ) && ( transmission->start_time_in_us < oldest_start_in_us ) )
+        {
+            oldest_start_in_us = transmission->start_time_in_us;
+        }
+    }
+
+    uint32_t nb_kept = 0;
+
+    for( uint32_t i = 0; i < channel->nb_transmissions; i++ )
+    {
+        const sim_channel_transmission_t* transmission = &channel->transmissions[i];
+
+        if( ( transmission->is_processed == true ) && ( transmission->end_time_in_us <= oldest_start_in_us ) )
+        {
+            continue;
+        }
+        if( nb_kept != i )
+        {
+            channel->transmissions[nb_kept] = *transmission;
+        }
+        nb_kept++;
+    }
+    channel->nb_transmissions = nb_kept;
+}
+
+static float sim_channel_get_bw_in_hz( const ral_lora_bw_t bw )
+{
+    switch( bw )
+    {
+    case RAL_LORA_BW_250_KHZ:
+        return 250000.0f;
+    case RAL_LORA_BW_500_KHZ:
+        return 500000.0f;
+    case RAL_LORA_BW_125_KHZ:
+    default:
+        return 125000.0f;
+    }
+}
+
+/* --- EOF ------------------------------------------------------------------ */
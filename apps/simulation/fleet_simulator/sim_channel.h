@@ -0,0 +1,236 @@
+/**
+ * @file      sim_channel.h
+ *
+ * @brief     Shared radio channel model of the fleet simulator
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIM_CHANNEL_H
+#define SIM_CHANNEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ral_defs.h"
+#include "ral_sim.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/**
+ * @brief Maximum number of transmissions tracked at the same time (on air or overlapping one on air)
+ */
+#ifndef SIM_CHANNEL_MAX_TRANSMISSIONS
+#define SIM_CHANNEL_MAX_TRANSMISSIONS 1024
+#endif
+
+/**
+ * @brief Default power difference for the strongest of two colliding packets to be demodulated, in dB
+ */
+#define SIM_CHANNEL_DEFAULT_CAPTURE_THRESHOLD_DB 6.0f
+
+/**
+ * @brief Log-distance path loss model: loss at the reference distance, reference distance and exponent
+ */
+#define SIM_CHANNEL_PATH_LOSS_REF_DB 127.41f
+#define SIM_CHANNEL_PATH_LOSS_REF_DISTANCE_M 40.0f
+#define SIM_CHANNEL_PATH_LOSS_EXPONENT 2.08f
+
+/**
+ * @brief Noise figure of the receivers, in dB
+ */
+#define SIM_CHANNEL_NOISE_FIGURE_DB 6.0f
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Outcome of a reception at the gateway
+ */
+typedef enum sim_channel_rx_status_e
+{
+    SIM_CHANNEL_RX_OK,                 //!< Packet demodulated
+    SIM_CHANNEL_RX_BELOW_SENSITIVITY,  //!< SNR below the demodulation floor of the spreading factor
+    SIM_CHANNEL_RX_COLLISION,          //!< Lost in a collision without capture
+} sim_channel_rx_status_t;
+
+/**
+ * @brief Transmission on the shared channel
+ */
+typedef struct sim_channel_transmission_s
+{
+    uint64_t      start_time_in_us;
+    uint64_t      end_time_in_us;
+    uint32_t      freq_in_hz;
+    ral_lora_sf_t sf;
+    ral_lora_bw_t bw;
+    float         rssi_in_dbm;  //!< Power received by the gateway
+    float         snr_in_db;    //!< SNR at the gateway, without interference
+    void*         emitter;      //!< Context of the transmitting device
+    uint8_t       buffer[RAL_SIM_BUFFER_SIZE];
+    uint16_t      size;
+    bool          is_processed;
+} sim_channel_transmission_t;
+
+/**
+ * @brief Called for each transmission once it is over, with the gateway reception outcome
+ */
+typedef void ( *sim_channel_rx_callback_t )( void* context, const sim_channel_transmission_t* transmission,
+                                             sim_channel_rx_status_t status );
+
+/**
+ * @brief Channel statistics
+ */
+typedef struct sim_channel_stats_s
+{
+    uint32_t nb_transmissions;
+    uint32_t nb_rx_ok;
+    uint32_t nb_rx_below_sensitivity;
+    uint32_t nb_rx_collision;
+    uint32_t nb_rx_captured;  //!< Packets demodulated in spite of a collision thanks to the capture effect
+    uint32_t nb_dropped;      //!< Transmissions not tracked because SIM_CHANNEL_MAX_TRANSMISSIONS was reached
+} sim_channel_stats_t;
+
+/**
+ * @brief Shared channel between the devices and a single gateway
+ */
+typedef struct sim_channel_s
+{
+    sim_channel_transmission_t transmissions[SIM_CHANNEL_MAX_TRANSMISSIONS];
+    uint32_t                   nb_transmissions;
+    float                      capture_threshold_in_db;
+    sim_channel_rx_callback_t  rx_callback;
+    void*                      rx_context;
+    sim_channel_stats_t        stats;
+} sim_channel_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Initialize the channel
+ *
+ * @param [out] channel     Channel
+ * @param [in]  rx_callback Gateway reception callback
+ * @param [in]  rx_context  Context given to the reception callback
+ */
+void sim_channel_init( sim_channel_t* channel, sim_channel_rx_callback_t rx_callback, void* rx_context );
+
+/**
+ * @brief Put a LoRa transmission on the channel
+ *
+ * @param [in] channel          Channel
+ * @param [in] start_time_in_us Start of the transmission
+ * @param [in] toa_in_us        Time-on-air
+ * @param [in] radio            Context of the transmitting radio (frequency and modulation)
+ * @param [in] rssi_in_dbm      Power received by the gateway
+ * @param [in] emitter          Context of the transmitting device
+ * @param [in] buffer           Frame
+ * @param [in] size             Frame size
+ *
+ * @returns False if the transmission cannot be tracked
+ */
+bool sim_channel_add_transmission( sim_channel_t* channel, const uint64_t start_time_in_us, const uint32_t toa_in_us,
+                                   const ral_sim_context_t* radio, const float rssi_in_dbm, void* emitter,
+                                   const uint8_t* buffer, const uint16_t size );
+
+/**
+ * @brief Get the end of the earliest transmission still on air
+ *
+ * @param [in]  channel         Channel
+ * @param [out] end_time_in_us  End time
+ *
+ * @returns False if no transmission is on air
+ */
+bool sim_channel_get_next_end_time( const sim_channel_t* channel, uint64_t* end_time_in_us );
+
+/**
+ * @brief Resolve all the transmissions over at the given time, in end time order
+ *
+ * @param [in] channel      Channel
+ * @param [in] time_in_us   Current time
+ */
+void sim_channel_process( sim_channel_t* channel, const uint64_t time_in_us );
+
+/**
+ * @brief Get the path loss at a given distance of the gateway
+ *
+ * @param [in] distance_in_m Distance in meters
+ *
+ * @returns Path loss in dB
+ */
+float sim_channel_get_path_loss_in_db( const float distance_in_m );
+
+/**
+ * @brief Get the SNR of a signal against the thermal noise of the receiver
+ *
+ * @param [in] rssi_in_dbm  Received power
+ * @param [in] bw           LoRa bandwidth
+ *
+ * @returns SNR in dB
+ */
+float sim_channel_get_snr_in_db( const float rssi_in_dbm, const ral_lora_bw_t bw );
+
+/**
+ * @brief Get the lowest SNR a LoRa spreading factor can be demodulated at
+ *
+ * @param [in] sf Spreading factor
+ *
+ * @returns SNR floor in dB
+ */
+float sim_channel_get_snr_floor_in_db( const ral_lora_sf_t sf );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SIM_CHANNEL_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,351 @@
+/**
+ * @file      sim_device.c
+ *
+ * @brief     Simulated end-device of the fleet simulator
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "sim_device.h"
+#include "sim_channel.h"
+
+#include "ralf_sim.h"
+#include "smtc_modem_hal.h"
+#include "smtc_modem_crypto.h"
+#include "smtc_secure_element.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/**
+ * @brief Delay before retrying an operation the stack refused for an unexpected reason, in seconds
+ */
+#define SIM_DEVICE_RETRY_DELAY_S 10
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Start a join or an uplink
+ *
+ * @param [in] device Device
+ */
+static void sim_device_start_action( sim_device_t* device );
+
+/**
+ * @brief Account for the end of a join or an uplink and schedule the next one
+ *
+ * @param [in] device Device
+ */
+static void sim_device_end_action( sim_device_t* device );
+
+/**
+ * @brief Schedule the next action after a delay
+ *
+ * @param [in] device       Device
+ * @param [in] delay_in_ms  Delay from now
+ */
+static void sim_device_schedule_in_ms( sim_device_t* device, const uint32_t delay_in_ms );
+
+/**
+ * @brief Get a random uplink interval, uniformly distributed in [period / 2, 3 * period / 2]
+ *
+ * @param [in] device Device
+ *
+ * @returns Interval in ms
+ */
+static uint32_t sim_device_get_uplink_interval_ms( sim_device_t* device );
+
+/**
+ * @brief Class A downlink callback of the stack (downlinks carrying application data)
+ *
+ * @param [in] context Device
+ */
+static void sim_device_on_downlink( void* context );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void sim_device_init( sim_device_t* device, const uint32_t id, const sim_device_config_t* config,
+                      ral_sim_tx_callback_t tx_callback )
+{
+    memset( device, 0, sizeof( sim_device_t ) );
+
+    device->id                = id;
+    device->distance_in_m     = config->distance_in_m;
+    device->path_loss_in_db   = sim_channel_get_path_loss_in_db( config->distance_in_m );
+    device->uplink_period_s   = config->uplink_period_s;
+    device->payload_size      = config->payload_size;
+    device->confirmed_percent = config->confirmed_percent;
+
+    smtc_modem_hal_sim_node_init( &device->node, config->seed );
+    device->node.user_context = device;
+    sim_device_select( device );
+    smtc_modem_hal_sim_set_trace_enabled( config->trace_enabled );
+
+    // Radio and radio planner, as done by smtc_modem_init
+    device->radio_context.tx_callback  = tx_callback;
+    device->radio_context.user_context = device;
+    device->radio_context.random_seed  = config->seed;
+    device->radio                      = ( ralf_t ) RALF_SIM_INSTANTIATE( &device->radio_context );
+
+    ral_reset( &( device->radio.ral ) );
+    ral_init( &( device->radio.ral ) );
+    ral_set_sleep( &( device->radio.ral ), true );
+    rp_init( &device->rp, &device->radio );
+    smtc_modem_hal_irq_config_radio_irq( rp_radio_irq_callback, &device->rp );
+
+    // Credentials, as done by the lorawan api
+    smtc_secure_element_init( );
+    smtc_secure_element_set_deveui( config->dev_eui );
+    smtc_secure_element_set_joineui( config->join_eui );
+    smtc_modem_crypto_set_key( SMTC_SE_NWK_KEY, config->app_key );
+    smtc_modem_crypto_set_key( SMTC_SE_APP_KEY, config->app_key );
+
+    lr1mac_core_init( &device->lr1_mac, &device->real, &device->lbt, &device->dtc, &device->rp,
+                      ACTIVATION_MODE_OTAA, SMTC_REAL_REGION_EU_868, sim_device_on_downlink, device );
+    lr1mac_core_set_region( &device->lr1_mac, SMTC_REAL_REGION_EU_868 );
+
+    device->next_action_time_in_us = ( uint64_t ) config->start_time_s * 1000000;
+    device->is_action_scheduled    = true;
+}
+
+void sim_device_select( sim_device_t* device )
+{
+    smtc_modem_hal_sim_select_node( &device->node );
+}
+
+void sim_device_on_node_selected( smtc_modem_hal_sim_node_t* node )
+{
+    sim_device_t* device = ( sim_device_t* ) node->user_context;
+
+    soft_se_set_data( ( device != NULL ) ? &device->se_data : NULL );
+    smtc_context_journal_set_data( ( device != NULL ) ? &device->journal : NULL );
+}
+
+void sim_device_process( sim_device_t* device )
+{
+    if( ( device->is_action_scheduled == true ) &&
+        ( smtc_modem_hal_sim_get_time_in_us( ) >= device->next_action_time_in_us ) )
+    {
+        device->is_action_scheduled = false;
+        if( device->is_busy == false )
+        {
+            sim_device_start_action( device );
+        }
+    }
+
+    if( device->is_busy == false )
+    {
+        return;
+    }
+
+    const lr1mac_states_t previous_state = device->lr1_mac.lr1mac_state;
+    lr1mac_states_t       state          = lr1mac_core_process( &device->lr1_mac );
+
+    if( ( previous_state == LWPSTATE_TX_WAIT ) && ( state == LWPSTATE_SEND ) )
+    {
+        // The wait is over: the transmission is started by the next call, as the modem supervisor would do
+        state = lr1mac_core_process( &device->lr1_mac );
+    }
+
+    switch( state )
+    {
+    case LWPSTATE_IDLE:
+        device->is_busy = false;
+        sim_device_end_action( device );
+        break;
+    case LWPSTATE_TX_WAIT:
+        // The stack waits for a retransmission time and has to be called again once it is reached
+        device->next_action_time_in_us = ( ( uint64_t ) device->lr1_mac.rtc_target_timer_ms + 1 ) * 1000;
+        device->is_action_scheduled    = true;
+        break;
+    default:
+        // Next step is triggered by a radio or timer event
+        break;
+    }
+}
+
+bool sim_device_get_next_action_time( const sim_device_t* device, uint64_t* time_in_us )
+{
+    *time_in_us = device->next_action_time_in_us;
+    return device->is_action_scheduled;
+}
+
+void sim_device_set_downlink( sim_device_t* device, const uint8_t* buffer, const uint16_t size,
+                              const int16_t rssi_in_dbm, const int16_t snr_in_db )
+{
+    ral_sim_set_rx_packet( &device->radio_context, buffer, size, rssi_in_dbm, snr_in_db, false );
+}
+
+uint8_t sim_device_get_dr( const sim_device_t* device )
+{
+    return device->lr1_mac.tx_data_rate;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void sim_device_start_action( sim_device_t* device )
+{
+    lr1_stack_mac_t* lr1_mac = &device->lr1_mac;
+    const uint32_t   now_ms  = smtc_modem_hal_get_time_in_ms( );
+
+    if( lr1_mac_joined_status_get( lr1_mac ) != JOINED )
+    {
+        // Join duty-cycle: the stack drops a join request sent too early
+        const int32_t wait_s =
+            ( int32_t ) ( lr1mac_core_next_join_time_second_get( lr1_mac ) - smtc_modem_hal_get_time_in_s( ) );
+
+        if( wait_s > 0 )
+        {
+            sim_device_schedule_in_ms( device, ( uint32_t ) wait_s * 1000 + 1 );
+            return;
+        }
+        if( lr1mac_core_join( lr1_mac, now_ms ) != OKLORAWAN )
+        {
+            device->stats.nb_send_errors++;
+            sim_device_schedule_in_ms( device, SIM_DEVICE_RETRY_DELAY_S * 1000 );
+            return;
+        }
+        device->last_uplink_mtype = JOIN_REQUEST;
+        device->is_busy           = true;
+        device->stats.nb_join_requests++;
+        return;
+    }
+
+    uint8_t       payload[255];
+    const uint8_t mtype = ( smtc_modem_hal_get_random_nb_in_range( 0, 99 ) < device->confirmed_percent )
+                              ? CONF_DATA_UP
+                              : UNCONF_DATA_UP;
+
+    for( uint8_t i = 0; i < device->payload_size; i++ )
+    {
+        payload[i] = ( uint8_t ) ( device->stats.nb_uplinks + i );
+    }
+
+    if( lr1mac_core_payload_send( lr1_mac, SIM_DEVICE_UPLINK_FPORT, true, payload, device->payload_size, mtype,
+                                  now_ms ) != OKLORAWAN )
+    {
+        const int32_t duty_cycle_ms = lr1mac_core_next_free_duty_cycle_ms_get( lr1_mac );
+
+        if( duty_cycle_ms > 0 )
+        {
+            device->stats.nb_duty_cycle_blocked++;
+            sim_device_schedule_in_ms( device, ( uint32_t ) duty_cycle_ms + 1 );
+        }
+        else
+        {
+            device->stats.nb_send_errors++;
+            sim_device_schedule_in_ms( device, sim_device_get_uplink_interval_ms( device ) );
+        }
+        return;
+    }
+
+    device->last_uplink_mtype = mtype;
+    device->is_busy           = true;
+    device->stats.nb_uplinks++;
+    if( mtype == CONF_DATA_UP )
+    {
+        device->stats.nb_confirmed_uplinks++;
+    }
+}
+
+static void sim_device_end_action( sim_device_t* device )
+{
+    lr1_stack_mac_t* lr1_mac = &device->lr1_mac;
+
+    if( lr1_mac_joined_status_get( lr1_mac ) != JOINED )
+    {
+        // Join failed, retry as soon as the join duty-cycle allows it
+        sim_device_schedule_in_ms( device, 0 );
+        return;
+    }
+
+    if( device->last_uplink_mtype == JOIN_REQUEST )
+    {
+        device->stats.join_time_in_us = smtc_modem_hal_sim_get_time_in_us( );
+    }
+    else if( ( device->last_uplink_mtype == CONF_DATA_UP ) && ( lr1mac_core_rx_ack_bit_get( lr1_mac ) != 0 ) )
+    {
+        device->stats.nb_acks++;
+    }
+    sim_device_schedule_in_ms( device, sim_device_get_uplink_interval_ms( device ) );
+}
+
+static void sim_device_schedule_in_ms( sim_device_t* device, const uint32_t delay_in_ms )
+{
+    device->next_action_time_in_us = smtc_modem_hal_sim_get_time_in_us( ) + ( uint64_t ) delay_in_ms * 1000;
+    device->is_action_scheduled    = true;
+}
+
+static uint32_t sim_device_get_uplink_interval_ms( sim_device_t* device )
+{
+    const uint32_t period_ms = device->uplink_period_s * 1000;
+
+    return smtc_modem_hal_get_random_nb_in_range( period_ms / 2, period_ms + period_ms / 2 );
+}
+
+static void sim_device_on_downlink( void* context )
+{
+    // Application downlinks are not generated by the network server stand-in
+    ( void ) context;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
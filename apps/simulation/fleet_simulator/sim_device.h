@@ -0,0 +1,221 @@
+/**
+ * @file      sim_device.h
+ *
+ * @brief     Simulated end-device of the fleet simulator
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIM_DEVICE_H
+#define SIM_DEVICE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "smtc_modem_hal_sim.h"
+#include "ral_sim.h"
+#include "ralf.h"
+#include "radio_planner.h"
+#include "lr1mac_core.h"
+#include "soft_se.h"
+#include "smtc_context_journal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/**
+ * @brief LoRaWAN port of the application uplinks
+ */
+#define SIM_DEVICE_UPLINK_FPORT 2
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Device configuration
+ */
+typedef struct sim_device_config_s
+{
+    uint8_t  dev_eui[8];
+    uint8_t  join_eui[8];
+    uint8_t  app_key[16];
+    uint32_t seed;                //!< Seed of the device random generators
+    float    distance_in_m;       //!< Distance to the gateway
+    uint32_t uplink_period_s;     //!< Mean period between two uplinks (uniform jitter of +/- 50%)
+    uint8_t  payload_size;        //!< Application payload size
+    uint8_t  confirmed_percent;   //!< Share of confirmed uplinks
+    uint32_t start_time_s;        //!< Power-on time
+    bool     trace_enabled;       //!< Modem trace output of the device
+} sim_device_config_t;
+
+/**
+ * @brief Device statistics
+ */
+typedef struct sim_device_stats_s
+{
+    uint32_t nb_join_requests;
+    uint32_t nb_uplinks;
+    uint32_t nb_confirmed_uplinks;
+    uint32_t nb_acks;
+    uint32_t nb_duty_cycle_blocked;  //!< Uplinks postponed because of the duty-cycle
+    uint32_t nb_send_errors;         //!< Uplinks rejected by the stack for another reason
+    uint64_t join_time_in_us;        //!< Time of the successful join (0 if not joined)
+    uint64_t tx_time_in_us;          //!< Cumulated time-on-air
+    uint32_t nb_tx_per_dr[16];       //!< Transmissions per datarate
+} sim_device_stats_t;
+
+/**
+ * @brief Simulated end-device: one radio, radio planner and LoRaWAN stack running on its own simulated MCU
+ */
+typedef struct sim_device_s
+{
+    uint32_t                  id;
+    smtc_modem_hal_sim_node_t node;
+    ral_sim_context_t         radio_context;
+    ralf_t                    radio;
+    radio_planner_t           rp;
+    lr1_stack_mac_t           lr1_mac;
+    smtc_real_t               real;
+    smtc_lbt_t                lbt;
+    smtc_dtc_t                dtc;
+    soft_se_data_t            se_data;
+    smtc_context_journal_t    journal;
+
+    float    distance_in_m;
+    float    path_loss_in_db;
+    uint32_t uplink_period_s;
+    uint8_t  payload_size;
+    uint8_t  confirmed_percent;
+
+    bool               is_busy;                  //!< A join or an uplink is in progress in the stack
+    bool               is_action_scheduled;      //!< A join or an uplink is scheduled at next_action_time_in_us
+    uint64_t           next_action_time_in_us;   //!< Time of the next join/uplink or of the next stack wake-up
+    uint8_t            last_uplink_mtype;
+    sim_device_stats_t stats;
+} sim_device_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Initialize a device and add it to the simulation
+ *
+ * @remark The simulation (@ref smtc_modem_hal_sim_init) has to be initialized first. The device is selected on return.
+ *
+ * @param [out] device      Device
+ * @param [in]  id          Device identifier
+ * @param [in]  config      Device configuration
+ * @param [in]  tx_callback Called on each transmission start, with the device as radio user context
+ */
+void sim_device_init( sim_device_t* device, const uint32_t id, const sim_device_config_t* config,
+                      ral_sim_tx_callback_t tx_callback );
+
+/**
+ * @brief Select a device: the modem HAL and the secure element then apply to it
+ *
+ * @param [in] device Device
+ */
+void sim_device_select( sim_device_t* device );
+
+/**
+ * @brief Hook to give to @ref smtc_modem_hal_sim_set_select_callback, switching the secure element data
+ *
+ * @param [in] node Selected node
+ */
+void sim_device_on_node_selected( smtc_modem_hal_sim_node_t* node );
+
+/**
+ * @brief Run the LoRaWAN stack of the device after one of its events, or at its scheduled action time
+ *
+ * @remark The device must be selected
+ *
+ * @param [in] device Device
+ */
+void sim_device_process( sim_device_t* device );
+
+/**
+ * @brief Get the time the device has to be processed at, if no event wakes it up before
+ *
+ * @param [in]  device      Device
+ * @param [out] time_in_us  Action time
+ *
+ * @returns False if no action is scheduled
+ */
+bool sim_device_get_next_action_time( const sim_device_t* device, uint64_t* time_in_us );
+
+/**
+ * @brief Queue a downlink for the next receive window of the device
+ *
+ * @remark The device must be selected
+ *
+ * @param [in] device       Device
+ * @param [in] buffer       Downlink frame
+ * @param [in] size         Downlink frame size
+ * @param [in] rssi_in_dbm  Received power
+ * @param [in] snr_in_db    SNR
+ */
+void sim_device_set_downlink( sim_device_t* device, const uint8_t* buffer, const uint16_t size,
+                              const int16_t rssi_in_dbm, const int16_t snr_in_db );
+
+/**
+ * @brief Get the current datarate of the device
+ *
+ * @param [in] device Device
+ *
+ * @returns Datarate
+ */
+uint8_t sim_device_get_dr( const sim_device_t* device );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SIM_DEVICE_H
+
+/* --- EOF ------------------------------------------------------------------ */
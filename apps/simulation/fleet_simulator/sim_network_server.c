@@ -0,0 +1,650 @@
+/**
+ * @file      sim_network_server.c
+ *
+ * @brief     Network server stand-in of the fleet simulator
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "sim_network_server.h"
+#include "sim_channel.h"
+
+#include "aes.h"
+#include "cmac.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define SIM_NS_MTYPE_JOIN_REQUEST 0x00
+#define SIM_NS_MTYPE_JOIN_ACCEPT 0x01
+#define SIM_NS_MTYPE_UNCONF_DATA_UP 0x02
+#define SIM_NS_MTYPE_UNCONF_DATA_DOWN 0x03
+#define SIM_NS_MTYPE_CONF_DATA_UP 0x04
+
+#define SIM_NS_JOIN_REQUEST_SIZE 23
+#define SIM_NS_JOIN_ACCEPT_SIZE 17
+#define SIM_NS_DATA_MIN_SIZE 12
+#define SIM_NS_MIC_SIZE 4
+
+#define SIM_NS_FCTRL_ADR 0x80
+#define SIM_NS_FCTRL_ADR_ACK_REQ 0x40
+#define SIM_NS_FCTRL_ACK 0x20
+#define SIM_NS_FCTRL_FOPTS_LEN_MASK 0x0F
+
+/**
+ * @brief Largest FPort 0 payload parsed for MAC command answers
+ */
+#define SIM_NS_MAC_CMDS_MAX_SIZE 64
+
+#define SIM_NS_CID_LINK_ADR 0x03
+
+/**
+ * @brief Channel mask sent with LinkADRReq: the 3 EU868 default channels
+ */
+#define SIM_NS_LINK_ADR_CH_MASK 0x0007
+
+/**
+ * @brief Join-accept RX1 delay and DLSettings (RX1DROffset 0, RX2 DR0)
+ */
+#define SIM_NS_RX1_DELAY_S 1
+#define SIM_NS_DL_SETTINGS 0x00
+
+/**
+ * @brief TX power variation of one EU868 TX power index, in dB
+ */
+#define SIM_NS_ADR_TX_POWER_STEP_DB 2.0f
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Process a join-request and build the join-accept
+ */
+static bool sim_ns_process_join_request( sim_network_server_t* ns, const uint8_t* buffer, const uint16_t size,
+                                         const uint8_t dr, uint8_t* downlink, uint16_t* downlink_size );
+
+/**
+ * @brief Process a data uplink and build the answer if any
+ */
+static bool sim_ns_process_data_up( sim_network_server_t* ns, const uint8_t* buffer, const uint16_t size,
+                                    const uint8_t dr, const float snr_in_db, uint8_t* downlink,
+                                    uint16_t* downlink_size );
+
+/**
+ * @brief Run the ADR algorithm of a session
+ *
+ * @returns True if the datarate or the TX power has to be changed
+ */
+static bool sim_ns_compute_adr( sim_network_server_session_t* session );
+
+/**
+ * @brief Get the demodulation floor of an EU868 LoRa datarate
+ *
+ * @returns SNR floor in dB
+ */
+static float sim_ns_get_snr_floor_in_db( const uint8_t dr );
+
+/**
+ * @brief Compute the 4 bytes MIC of a buffer, prefixed by a B0 block if not NULL
+ */
+static void sim_ns_compute_mic( const uint8_t key[16], const uint8_t* b0, const uint8_t* buffer, const uint16_t size,
+                                uint8_t mic[SIM_NS_MIC_SIZE] );
+
+/**
+ * @brief Fill a B0 block for a data frame MIC
+ */
+static void sim_ns_prepare_b0( uint8_t b0[16], const uint16_t size, const uint8_t dir, const uint32_t dev_addr,
+                               const uint32_t fcnt );
+
+/**
+ * @brief Decrypt (or encrypt) a FRMPayload with the LoRaWAN AES-CTR keystream
+ */
+static void sim_ns_decrypt_frm_payload( const uint8_t key[16], const uint8_t dir, const uint32_t dev_addr,
+                                        const uint32_t fcnt, const uint8_t* in, const uint16_t size, uint8_t* out );
+
+/**
+ * @brief Get the session of a device address
+ */
+static sim_network_server_session_t* sim_ns_get_session_by_dev_addr( sim_network_server_t* ns,
+                                                                     const uint32_t        dev_addr );
+
+static uint32_t sim_ns_read_u32( const uint8_t* buffer );
+static void     sim_ns_write_u32( uint8_t* buffer, const uint32_t value );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void sim_network_server_init( sim_network_server_t* ns, sim_network_server_session_t* sessions,
+                              const uint32_t max_sessions, const uint32_t net_id )
+{
+    memset( ns, 0, sizeof( sim_network_server_t ) );
+    memset( sessions, 0, max_sessions * sizeof( sim_network_server_session_t ) );
+    ns->sessions     = sessions;
+    ns->max_sessions = max_sessions;
+    ns->net_id       = net_id & 0x00FFFFFF;
+}
+
+bool sim_network_server_add_device( sim_network_server_t* ns, const uint8_t dev_eui[8], const uint8_t join_eui[8],
+                                    const uint8_t app_key[16] )
+{
+    if( ns->nb_sessions >= ns->max_sessions )
+    {
+        return false;
+    }
+
+    sim_network_server_session_t* session = &ns->sessions[ns->nb_sessions];
+
+    memset( session, 0, sizeof( sim_network_server_session_t ) );
+    memcpy( session->dev_eui, dev_eui, 8 );
+    memcpy( session->join_eui, join_eui, 8 );
+    memcpy( session->app_key, app_key, 16 );
+
+    // Type 0 NetID: the 6 LSBs of the NetID are the NwkID, the device index is the NwkAddr
+    session->dev_addr = ( ( ns->net_id & 0x3F ) << 25 ) | ( ns->nb_sessions + 1 );
+
+    ns->nb_sessions++;
+    return true;
+}
+
+bool sim_network_server_process_uplink( sim_network_server_t* ns, const uint8_t* buffer, const uint16_t size,
+                                        const uint8_t dr, const float snr_in_db,
+                                        uint8_t downlink[SIM_NETWORK_SERVER_DOWNLINK_MAX_SIZE],
+                                        uint16_t* downlink_size )
+{
+    if( size < 1 )
+    {
+        return false;
+    }
+
+    switch( buffer[0] >> 5 )
+    {
+    case SIM_NS_MTYPE_JOIN_REQUEST:
+        return sim_ns_process_join_request( ns, buffer, size, dr, downlink, downlink_size );
+    case SIM_NS_MTYPE_UNCONF_DATA_UP:
+    case SIM_NS_MTYPE_CONF_DATA_UP:
+        return sim_ns_process_data_up( ns, buffer, size, dr, snr_in_db, downlink, downlink_size );
+    default:
+        return false;
+    }
+}
+
+const sim_network_server_session_t* sim_network_server_get_session( const sim_network_server_t* ns,
+                                                                    const uint8_t                dev_eui[8] )
+{
+    for( uint32_t i = 0; i < ns->nb_sessions; i++ )
+    {
+        if( memcmp( ns->sessions[i].dev_eui, dev_eui, 8 ) == 0 )
+        {
+            return &ns->sessions[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool sim_ns_process_join_request( sim_network_server_t* ns, const uint8_t* buffer, const uint16_t size,
+                                         const uint8_t dr, uint8_t* downlink, uint16_t* downlink_size )
+{
+    uint8_t join_eui[8];
+    uint8_t dev_eui[8];
+    uint8_t mic[SIM_NS_MIC_SIZE];
+
+    ns->stats.nb_join_requests++;
+
+    if( size != SIM_NS_JOIN_REQUEST_SIZE )
+    {
+        return false;
+    }
+
+    // EUIs are sent LSB first
+    for( int i = 0; i < 8; i++ )
+    {
+        join_eui[i] = buffer[8 - i];
+        dev_eui[i]  = buffer[16 - i];
+    }
+
+    sim_network_server_session_t* session =
+        ( sim_network_server_session_t* ) sim_network_server_get_session( ns, dev_eui );
+
+    if( ( session == NULL ) || ( memcmp( session->join_eui, join_eui, 8 ) != 0 ) )
+    {
+        ns->stats.nb_unknown_devices++;
+        return false;
+    }
+
+    sim_ns_compute_mic( session->app_key, NULL, buffer, SIM_NS_JOIN_REQUEST_SIZE - SIM_NS_MIC_SIZE, mic );
+    if( memcmp( mic, &buffer[SIM_NS_JOIN_REQUEST_SIZE - SIM_NS_MIC_SIZE], SIM_NS_MIC_SIZE ) != 0 )
+    {
+        ns->stats.nb_mic_errors++;
+        return false;
+    }
+
+    // LoRaWAN 1.0.4: the DevNonce is a counter, a replayed value is rejected
+    const uint16_t dev_nonce = buffer[17] | ( buffer[18] << 8 );
+
+    if( ( session->has_dev_nonce == true ) && ( dev_nonce <= session->last_dev_nonce ) )
+    {
+        ns->stats.nb_duplicates++;
+        return false;
+    }
+    session->last_dev_nonce = dev_nonce;
+    session->has_dev_nonce  = true;
+
+    ns->join_nonce = ( ns->join_nonce + 1 ) & 0x00FFFFFF;
+
+    uint8_t join_accept[SIM_NS_JOIN_ACCEPT_SIZE];
+
+    join_accept[0] = SIM_NS_MTYPE_JOIN_ACCEPT << 5;
+    join_accept[1] = ( uint8_t ) ( ns->join_nonce );
+    join_accept[2] = ( uint8_t ) ( ns->join_nonce >> 8 );
+    join_accept[3] = ( uint8_t ) ( ns->join_nonce >> 16 );
+    join_accept[4] = ( uint8_t ) ( ns->net_id );
+    join_accept[5] = ( uint8_t ) ( ns->net_id >> 8 );
+    join_accept[6] = ( uint8_t ) ( ns->net_id >> 16 );
+    sim_ns_write_u32( &join_accept[7], session->dev_addr );
+    join_accept[11] = SIM_NS_DL_SETTINGS;
+    join_accept[12] = SIM_NS_RX1_DELAY_S;
+    sim_ns_compute_mic( session->app_key, NULL, join_accept, SIM_NS_JOIN_ACCEPT_SIZE - SIM_NS_MIC_SIZE,
+                        &join_accept[SIM_NS_JOIN_ACCEPT_SIZE - SIM_NS_MIC_SIZE] );
+
+    // The device decrypts the join-accept with an AES encryption, so the network encrypts it with a decryption
+    aes_context aes_ctx;
+
+    memset( &aes_ctx, 0, sizeof( aes_ctx ) );
+    aes_set_key( session->app_key, 16, &aes_ctx );
+    downlink[0] = join_accept[0];
+    aes_decrypt( &join_accept[1], &downlink[1], &aes_ctx );
+    *downlink_size = SIM_NS_JOIN_ACCEPT_SIZE;
+
+    // Session keys derivation: aes128_encrypt( AppKey, 0x01 | 0x02 | JoinNonce | NetID | DevNonce | pad16 )
+    uint8_t key_block[16] = { 0 };
+
+    memcpy( &key_block[1], &join_accept[1], 6 );
+    key_block[7] = ( uint8_t ) ( dev_nonce );
+    key_block[8] = ( uint8_t ) ( dev_nonce >> 8 );
+    key_block[0] = 0x01;
+    aes_encrypt( key_block, session->nwk_s_key, &aes_ctx );
+    key_block[0] = 0x02;
+    aes_encrypt( key_block, session->app_s_key, &aes_ctx );
+
+    session->is_joined           = true;
+    session->has_fcnt_up         = false;
+    session->fcnt_up             = 0;
+    session->fcnt_down           = 0;
+    session->nb_snr              = 0;
+    session->snr_index           = 0;
+    session->dr                  = dr;
+    session->tx_power_index      = 0;
+    session->is_link_adr_pending = false;
+
+    ns->stats.nb_join_accepts++;
+    return true;
+}
+
+static bool sim_ns_process_data_up( sim_network_server_t* ns, const uint8_t* buffer, const uint16_t size,
+                                    const uint8_t dr, const float snr_in_db, uint8_t* downlink,
+                                    uint16_t* downlink_size )
+{
+    if( size < SIM_NS_DATA_MIN_SIZE )
+    {
+        return false;
+    }
+
+    sim_network_server_session_t* session = sim_ns_get_session_by_dev_addr( ns, sim_ns_read_u32( &buffer[1] ) );
+
+    if( session == NULL )
+    {
+        ns->stats.nb_unknown_devices++;
+        return false;
+    }
+
+    const uint8_t  fctrl     = buffer[5];
+    const uint8_t  fopts_len = fctrl & SIM_NS_FCTRL_FOPTS_LEN_MASK;
+    const uint16_t fcnt16    = buffer[6] | ( buffer[7] << 8 );
+    uint32_t       fcnt      = fcnt16;
+
+    if( ( 8 + fopts_len + SIM_NS_MIC_SIZE ) > size )
+    {
+        return false;
+    }
+
+    if( session->has_fcnt_up == true )
+    {
+        fcnt = ( session->fcnt_up & 0xFFFF0000 ) | fcnt16;
+        if( fcnt < session->fcnt_up )
+        {
+            fcnt += 0x10000;
+        }
+    }
+
+    uint8_t b0[16];
+    uint8_t mic[SIM_NS_MIC_SIZE];
+
+    sim_ns_prepare_b0( b0, size - SIM_NS_MIC_SIZE, 0, session->dev_addr, fcnt );
+    sim_ns_compute_mic( session->nwk_s_key, b0, buffer, size - SIM_NS_MIC_SIZE, mic );
+    if( memcmp( mic, &buffer[size - SIM_NS_MIC_SIZE], SIM_NS_MIC_SIZE ) != 0 )
+    {
+        ns->stats.nb_mic_errors++;
+        return false;
+    }
+
+    const bool is_confirmed = ( ( buffer[0] >> 5 ) == SIM_NS_MTYPE_CONF_DATA_UP );
+    const bool is_duplicate = ( session->has_fcnt_up == true ) && ( fcnt == session->fcnt_up );
+    uint8_t    fopts[SIM_NETWORK_SERVER_DOWNLINK_MAX_SIZE - SIM_NS_DATA_MIN_SIZE];
+    uint8_t    fopts_out_len = 0;
+
+    session->fcnt_up     = fcnt;
+    session->has_fcnt_up = true;
+
+    if( is_duplicate == true )
+    {
+        ns->stats.nb_duplicates++;
+    }
+    else
+    {
+        ns->stats.nb_uplinks++;
+
+        // Answers to the MAC commands, only LinkADRAns is expected. The stack sends the answers that are not sticky
+        // in a dedicated FPort 0 frame, encrypted with the network session key.
+        uint8_t        mac_cmds[SIM_NS_MAC_CMDS_MAX_SIZE];
+        const uint8_t* mac_ans      = &buffer[8];
+        uint16_t       mac_ans_size = fopts_len;
+        const uint16_t fport_index  = 8 + fopts_len;
+        const uint16_t payload_size = size - SIM_NS_MIC_SIZE - fport_index - 1;
+
+        if( ( fopts_len == 0 ) && ( ( fport_index + 1 + SIM_NS_MIC_SIZE ) < size ) && ( buffer[fport_index] == 0 ) &&
+            ( payload_size <= SIM_NS_MAC_CMDS_MAX_SIZE ) )
+        {
+            sim_ns_decrypt_frm_payload( session->nwk_s_key, 0, session->dev_addr, fcnt, &buffer[fport_index + 1],
+                                        payload_size, mac_cmds );
+            mac_ans      = mac_cmds;
+            mac_ans_size = payload_size;
+        }
+
+        bool has_link_adr_ans = false;
+
+        for( uint16_t i = 0; ( i + 1 ) < mac_ans_size; )
+        {
+            if( mac_ans[i] != SIM_NS_CID_LINK_ADR )
+            {
+                break;
+            }
+            if( ( mac_ans[i + 1] & 0x07 ) == 0x07 )
+            {
+                // The SNR does not depend on the datarate: the history is kept, moved to the new TX power
+                const float tx_power_shift_in_db =
+                    SIM_NS_ADR_TX_POWER_STEP_DB *
+                    ( ( int ) session->pending_tx_power_index - ( int ) session->tx_power_index );
+
+                for( uint8_t j = 0; j < session->nb_snr; j++ )
+                {
+                    session->snr_history[j] -= tx_power_shift_in_db;
+                }
+                session->tx_power_index = session->pending_tx_power_index;
+                ns->stats.nb_link_adr_ans_ok++;
+            }
+            else
+            {
+                ns->stats.nb_link_adr_ans_ko++;
+            }
+            has_link_adr_ans = true;
+            i += 2;
+        }
+        if( ( session->is_link_adr_pending == true ) && ( has_link_adr_ans == false ) )
+        {
+            // The request or its answer was lost, a new decision will be taken
+            session->is_link_adr_pending = false;
+        }
+        if( has_link_adr_ans == true )
+        {
+            session->is_link_adr_pending = false;
+        }
+
+        session->dr                                = dr;
+        session->snr_history[session->snr_index++] = snr_in_db;
+        session->snr_index %= SIM_NETWORK_SERVER_ADR_HISTORY_SIZE;
+        if( session->nb_snr < SIM_NETWORK_SERVER_ADR_HISTORY_SIZE )
+        {
+            session->nb_snr++;
+        }
+
+        if( ( ( fctrl & SIM_NS_FCTRL_ADR ) != 0 ) && ( session->is_link_adr_pending == false ) &&
+            ( sim_ns_compute_adr( session ) == true ) )
+        {
+            fopts[fopts_out_len++] = SIM_NS_CID_LINK_ADR;
+            fopts[fopts_out_len++] = ( session->pending_dr << 4 ) | session->pending_tx_power_index;
+            fopts[fopts_out_len++] = ( uint8_t ) ( SIM_NS_LINK_ADR_CH_MASK );
+            fopts[fopts_out_len++] = ( uint8_t ) ( SIM_NS_LINK_ADR_CH_MASK >> 8 );
+            fopts[fopts_out_len++] = 0x01;  // ChMaskCntl 0, NbTrans 1
+            session->is_link_adr_pending = true;
+            ns->stats.nb_link_adr_reqs++;
+        }
+    }
+
+    if( ( is_confirmed == false ) && ( fopts_out_len == 0 ) && ( ( fctrl & SIM_NS_FCTRL_ADR_ACK_REQ ) == 0 ) )
+    {
+        return false;
+    }
+
+    // Unconfirmed data down without FPort: only the FHDR is sent
+    uint16_t index = 0;
+
+    downlink[index++] = SIM_NS_MTYPE_UNCONF_DATA_DOWN << 5;
+    sim_ns_write_u32( &downlink[index], session->dev_addr );
+    index += 4;
+    downlink[index++] = ( ( is_confirmed == true ) ? SIM_NS_FCTRL_ACK : 0 ) | fopts_out_len;
+    downlink[index++] = ( uint8_t ) ( session->fcnt_down );
+    downlink[index++] = ( uint8_t ) ( session->fcnt_down >> 8 );
+    memcpy( &downlink[index], fopts, fopts_out_len );
+    index += fopts_out_len;
+
+    sim_ns_prepare_b0( b0, index, 1, session->dev_addr, session->fcnt_down );
+    sim_ns_compute_mic( session->nwk_s_key, b0, downlink, index, &downlink[index] );
+    index += SIM_NS_MIC_SIZE;
+
+    *downlink_size = index;
+    session->fcnt_down++;
+    if( is_confirmed == true )
+    {
+        ns->stats.nb_acks++;
+    }
+    return true;
+}
+
+static bool sim_ns_compute_adr( sim_network_server_session_t* session )
+{
+    if( session->nb_snr < SIM_NETWORK_SERVER_ADR_HISTORY_MIN_SIZE )
+    {
+        return false;
+    }
+
+    float snr_max = session->snr_history[0];
+
+    for( uint8_t i = 1; i < session->nb_snr; i++ )
+    {
+        if( session->snr_history[i] > snr_max )
+        {
+            snr_max = session->snr_history[i];
+        }
+    }
+
+    // Fastest datarate keeping the margin above the demodulation floor of its spreading factor, then lowest TX power
+    // keeping it
+    uint8_t dr       = session->dr;
+    uint8_t tx_power = session->tx_power_index;
+
+    while( ( dr < SIM_NETWORK_SERVER_ADR_MAX_DR ) &&
+           ( ( snr_max - sim_ns_get_snr_floor_in_db( dr + 1 ) ) >= SIM_NETWORK_SERVER_ADR_MARGIN_DB ) )
+    {
+        dr++;
+    }
+
+    const float margin   = snr_max - sim_ns_get_snr_floor_in_db( dr ) - SIM_NETWORK_SERVER_ADR_MARGIN_DB;
+    int         nb_steps = ( int ) floorf( margin / SIM_NS_ADR_TX_POWER_STEP_DB );
+
+    while( ( nb_steps > 0 ) && ( tx_power < SIM_NETWORK_SERVER_ADR_MAX_TX_POWER_INDEX ) )
+    {
+        tx_power++;
+        nb_steps--;
+    }
+    while( ( nb_steps < 0 ) && ( tx_power > 0 ) )
+    {
+        tx_power--;
+        nb_steps++;
+    }
+
+    if( ( dr == session->dr ) && ( tx_power == session->tx_power_index ) )
+    {
+        return false;
+    }
+    session->pending_dr             = dr;
+    session->pending_tx_power_index = tx_power;
+    return true;
+}
+
+static float sim_ns_get_snr_floor_in_db( const uint8_t dr )
+{
+    // EU868 DR0 to DR5 are SF12 to SF7
+    return sim_channel_get_snr_floor_in_db( ( ral_lora_sf_t ) ( RAL_LORA_SF12 - ( ( dr < 5 ) ? dr : 5 ) ) );
+}
+
+static void sim_ns_compute_mic( const uint8_t key[16], const uint8_t* b0, const uint8_t* buffer, const uint16_t size,
+                                uint8_t mic[SIM_NS_MIC_SIZE] )
+{
+    AES_CMAC_CTX cmac_ctx;
+    uint8_t      cmac[AES_CMAC_DIGEST_LENGTH];
+
+    AES_CMAC_Init( &cmac_ctx );
+    AES_CMAC_SetKey( &cmac_ctx, key );
+    if( b0 != NULL )
+    {
+        AES_CMAC_Update( &cmac_ctx, b0, 16 );
+    }
+    AES_CMAC_Update( &cmac_ctx, buffer, size );
+    AES_CMAC_Final( cmac, &cmac_ctx );
+    memcpy( mic, cmac, SIM_NS_MIC_SIZE );
+}
+
+static void sim_ns_prepare_b0( uint8_t b0[16], const uint16_t size, const uint8_t dir, const uint32_t dev_addr,
+                               const uint32_t fcnt )
+{
+    memset( b0, 0, 16 );
+    b0[0] = 0x49;
+    b0[5] = dir;
+    sim_ns_write_u32( &b0[6], dev_addr );
+    sim_ns_write_u32( &b0[10], fcnt );
+    b0[15] = ( uint8_t ) size;
+}
+
+static void sim_ns_decrypt_frm_payload( const uint8_t key[16], const uint8_t dir, const uint32_t dev_addr,
+                                        const uint32_t fcnt, const uint8_t* in, const uint16_t size, uint8_t* out )
+{
+    aes_context aes_ctx;
+    uint8_t     a_block[16] = { 0 };
+    uint8_t     s_block[16];
+
+    memset( &aes_ctx, 0, sizeof( aes_ctx ) );
+    aes_set_key( key, 16, &aes_ctx );
+    a_block[0] = 0x01;
+    a_block[5] = dir;
+    sim_ns_write_u32( &a_block[6], dev_addr );
+    sim_ns_write_u32( &a_block[10], fcnt );
+
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        if( ( i % 16 ) == 0 )
+        {
+            a_block[15] = ( uint8_t ) ( ( i / 16 ) + 1 );
+            aes_encrypt( a_block, s_block, &aes_ctx );
+        }
+        out[i] = in[i] ^ s_block[i % 16];
+    }
+}
+
+static sim_network_server_session_t* sim_ns_get_session_by_dev_addr( sim_network_server_t* ns,
+                                                                     const uint32_t        dev_addr )
+{
+    const uint32_t index = ( dev_addr & 0x01FFFFFF ) - 1;
+
+    if( ( ( dev_addr >> 25 ) != ( ns->net_id & 0x3F ) ) || ( index >= ns->nb_sessions ) ||
+        ( ns->sessions[index].is_joined == false ) )
+    {
+        return NULL;
+    }
+    return &ns->sessions[index];
+}
+
+static uint32_t sim_ns_read_u32( const uint8_t* buffer )
+{
+    return ( uint32_t ) buffer[0] | ( ( uint32_t ) buffer[1] << 8 ) | ( ( uint32_t ) buffer[2] << 16 ) |
+           ( ( uint32_t ) buffer[3] << 24 );
+}
+
+static void sim_ns_write_u32( uint8_t* buffer, const uint32_t value )
+{
+    buffer[0] = ( uint8_t ) ( value );
+    buffer[1] = ( uint8_t ) ( value >> 8 );
+    buffer[2] = ( uint8_t ) ( value >> 16 );
+    buffer[3] = ( uint8_t ) ( value >> 24 );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,225 @@
+/**
+ * @file      sim_network_server.h
+ *
+ * @brief     Network server stand-in of the fleet simulator
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SIM_NETWORK_SERVER_H
+#define SIM_NETWORK_SERVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/**
+ * @brief Maximum size of a downlink built by the network server
+ */
+#define SIM_NETWORK_SERVER_DOWNLINK_MAX_SIZE 32
+
+/**
+ * @brief Number of uplink SNR measurements the ADR decision is based on
+ */
+#ifndef SIM_NETWORK_SERVER_ADR_HISTORY_SIZE
+#define SIM_NETWORK_SERVER_ADR_HISTORY_SIZE 20
+#endif
+
+/**
+ * @brief Number of uplink SNR measurements needed before the first ADR decision of a session
+ */
+#ifndef SIM_NETWORK_SERVER_ADR_HISTORY_MIN_SIZE
+#define SIM_NETWORK_SERVER_ADR_HISTORY_MIN_SIZE 6
+#endif
+
+/**
+ * @brief ADR installation margin, in dB
+ *
+ * The simulated channel has no fading, the margin only covers the SNR lost in the interferences
+ */
+#ifndef SIM_NETWORK_SERVER_ADR_MARGIN_DB
+#define SIM_NETWORK_SERVER_ADR_MARGIN_DB 5.0f
+#endif
+
+/**
+ * @brief Highest datarate and TX power index the ADR can assign (EU868: DR5 and 14 dBm - 14 dB)
+ */
+#define SIM_NETWORK_SERVER_ADR_MAX_DR 5
+#define SIM_NETWORK_SERVER_ADR_MAX_TX_POWER_INDEX 7
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Device session handled by the network server
+ */
+typedef struct sim_network_server_session_s
+{
+    // Provisioning
+    uint8_t dev_eui[8];
+    uint8_t join_eui[8];
+    uint8_t app_key[16];
+
+    // Session
+    bool     is_joined;
+    uint32_t dev_addr;
+    uint8_t  nwk_s_key[16];
+    uint8_t  app_s_key[16];
+    uint16_t last_dev_nonce;
+    bool     has_dev_nonce;
+    uint32_t fcnt_up;
+    bool     has_fcnt_up;
+    uint32_t fcnt_down;
+
+    // ADR
+    float   snr_history[SIM_NETWORK_SERVER_ADR_HISTORY_SIZE];
+    uint8_t nb_snr;
+    uint8_t snr_index;
+    uint8_t dr;
+    uint8_t tx_power_index;
+    bool    is_link_adr_pending;
+    uint8_t pending_dr;
+    uint8_t pending_tx_power_index;
+} sim_network_server_session_t;
+
+/**
+ * @brief Network server statistics
+ */
+typedef struct sim_network_server_stats_s
+{
+    uint32_t nb_join_requests;
+    uint32_t nb_join_accepts;
+    uint32_t nb_uplinks;
+    uint32_t nb_duplicates;
+    uint32_t nb_mic_errors;
+    uint32_t nb_unknown_devices;
+    uint32_t nb_acks;
+    uint32_t nb_link_adr_reqs;
+    uint32_t nb_link_adr_ans_ok;
+    uint32_t nb_link_adr_ans_ko;
+} sim_network_server_stats_t;
+
+/**
+ * @brief Network server stand-in (LoRaWAN 1.0.x, class A, EU868 parameters)
+ */
+typedef struct sim_network_server_s
+{
+    sim_network_server_session_t* sessions;
+    uint32_t                      nb_sessions;
+    uint32_t                      max_sessions;
+    uint32_t                      net_id;
+    uint32_t                      join_nonce;
+    sim_network_server_stats_t    stats;
+} sim_network_server_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Initialize the network server
+ *
+ * @param [out] ns              Network server
+ * @param [in]  sessions        Session storage
+ * @param [in]  max_sessions    Number of sessions in the storage
+ * @param [in]  net_id          Network identifier (24 bits)
+ */
+void sim_network_server_init( sim_network_server_t* ns, sim_network_server_session_t* sessions,
+                              const uint32_t max_sessions, const uint32_t net_id );
+
+/**
+ * @brief Provision a device
+ *
+ * @param [in] ns       Network server
+ * @param [in] dev_eui  DevEUI (MSB first)
+ * @param [in] join_eui JoinEUI (MSB first)
+ * @param [in] app_key  AppKey
+ *
+ * @returns False if the session storage is full
+ */
+bool sim_network_server_add_device( sim_network_server_t* ns, const uint8_t dev_eui[8], const uint8_t join_eui[8],
+                                    const uint8_t app_key[16] );
+
+/**
+ * @brief Process an uplink received by the gateway
+ *
+ * @param [in]  ns              Network server
+ * @param [in]  buffer          Uplink frame
+ * @param [in]  size            Uplink frame size
+ * @param [in]  dr              Datarate of the uplink
+ * @param [in]  snr_in_db       SNR of the uplink
+ * @param [out] downlink        Downlink frame to send in the device receive windows
+ * @param [out] downlink_size   Downlink frame size
+ *
+ * @returns True if a downlink has to be sent
+ */
+bool sim_network_server_process_uplink( sim_network_server_t* ns, const uint8_t* buffer, const uint16_t size,
+                                        const uint8_t dr, const float snr_in_db,
+                                        uint8_t downlink[SIM_NETWORK_SERVER_DOWNLINK_MAX_SIZE],
+                                        uint16_t* downlink_size );
+
+/**
+ * @brief Get the session of a device
+ *
+ * @param [in] ns       Network server
+ * @param [in] dev_eui  DevEUI (MSB first)
+ *
+ * @returns Session, NULL if the device is not provisioned
+ */
+const sim_network_server_session_t* sim_network_server_get_session( const sim_network_server_t* ns,
+                                                                    const uint8_t                dev_eui[8] );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SIM_NETWORK_SERVER_H
+
+/* --- EOF ------------------------------------------------------------------ */
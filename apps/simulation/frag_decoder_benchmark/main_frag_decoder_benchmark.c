@@ -0,0 +1,561 @@
+/**
+ * @file      main_frag_decoder_benchmark.c
+ *
+ * @brief     Decodes synthetic fragmentation sessions with the word-wise and the reference decoders
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "frag_decoder.h"
+#include "frag_decoder_reference.h"
+#include "nvmcu_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define FRAG_BENCH_NB_FRAG_DEFAULT 150
+#define FRAG_BENCH_FRAG_SIZE_DEFAULT 200
+#define FRAG_BENCH_NB_SESSIONS_DEFAULT 20
+#define FRAG_BENCH_SEED_DEFAULT 1
+
+/**
+ * @brief Pages erased by fragmented_data_block.c to write over a bit at 0 with a 1
+ */
+#define FRAG_BENCH_FLASH_PAGES_PER_ERASE 2
+
+/**
+ * @brief Share of the fragments lost in the benchmarked sessions, in percent
+ */
+static const uint8_t frag_bench_loss_percent[] = { 0, 5, 10, 20, 30, 40 };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Benchmark parameters
+ */
+typedef struct frag_bench_config_s
+{
+    uint16_t nb_frag;
+    uint8_t  frag_size;
+    uint32_t nb_sessions;
+    uint32_t seed;
+} frag_bench_config_t;
+
+/**
+ * @brief Decoding time of a decoder over the sessions of a loss rate
+ */
+typedef struct frag_bench_timing_s
+{
+    double total_us;
+    double call_max_us;
+} frag_bench_timing_t;
+
+/**
+ * @brief Decoder under test
+ */
+typedef struct frag_bench_decoder_s
+{
+    int32_t ( *init )( uint16_t frag_nb, uint8_t frag_size, FragDecoderCallbacks_t* callbacks );
+    FragDecoderSessionStatus_t ( *process )( uint16_t frag_counter, uint8_t* raw_data );
+    FragDecoderCallbacks_t callbacks;
+    uint8_t*               file;
+} frag_bench_decoder_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint8_t  file_original[FRAG_MAX_NB * FRAG_MAX_SIZE];
+static uint8_t  file_reference[FRAG_MAX_NB * FRAG_MAX_SIZE];
+static uint8_t  fragments[2 * FRAG_MAX_NB][FRAG_MAX_SIZE];
+static uint32_t random_state;
+
+/**
+ * @brief Flash behind the callbacks of the word-wise decoder: the file, and the parity matrix with
+ * FRAG_DECODER_MATRIX_IN_FLASH, FragDecoderGetMatrixMemorySize( ) bytes
+ */
+static uint8_t  file_word[FRAG_MAX_NB * FRAG_MAX_SIZE];
+static uint32_t file_word_size;
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+static uint8_t* matrix_word;
+static uint32_t matrix_word_size;
+#endif
+static uint32_t word_nb_calls;
+static uint32_t word_nb_writes;
+static uint32_t word_nb_erases;
+static bool     word_out_of_bounds;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Memory callbacks of the decoders
+ */
+static int8_t reference_write( uint32_t addr, uint8_t* data, uint32_t size );
+static int8_t reference_read( uint32_t addr, uint8_t* data, uint32_t size );
+static int8_t word_write( uint32_t addr, uint8_t* data, uint32_t size );
+static int8_t word_read( uint32_t addr, uint8_t* data, uint32_t size );
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+static int8_t word_matrix_write( uint32_t addr, uint8_t* data, uint32_t size );
+static int8_t word_matrix_read( uint32_t addr, uint8_t* data, uint32_t size );
+#endif
+
+/**
+ * @brief Write to the flash of the word-wise decoder, counting the page erases of fragmented_data_block.c: programming
+ * only clears bits, so a write setting a bit back to 1 erases FRAG_BENCH_FLASH_PAGES_PER_ERASE pages
+ *
+ * @param [in] flash      Flash region
+ * @param [in] flash_size Size of the flash region
+ * @param [in] addr       Address in the region
+ * @param [in] data       Data to write
+ * @param [in] size       Size of the data
+ *
+ * @return 0 on success, -1 out of the region
+ */
+static int8_t frag_bench_flash_write( uint8_t* flash, uint32_t flash_size, uint32_t addr, const uint8_t* data,
+                                      uint32_t size );
+
+/**
+ * @brief Read from the flash of the word-wise decoder
+ *
+ * @param [in]  flash      Flash region
+ * @param [in]  flash_size Size of the flash region
+ * @param [in]  addr       Address in the region
+ * @param [out] data       Data read
+ * @param [in]  size       Size of the data
+ *
+ * @return 0 on success, -1 out of the region
+ */
+static int8_t frag_bench_flash_read( const uint8_t* flash, uint32_t flash_size, uint32_t addr, uint8_t* data,
+                                     uint32_t size );
+
+/**
+ * @brief Build the uncoded and coded fragments of a random file
+ *
+ * The coded fragments follow the LoRa Alliance fragmented data block transport specification, with the fragment
+ * counter convention of the decoder.
+ */
+static void frag_bench_encode( const frag_bench_config_t* config );
+
+/**
+ * @brief Feed the received fragments to a decoder
+ *
+ * @param [in]     decoder  Decoder under test
+ * @param [in]     config   Benchmark parameters
+ * @param [in]     received Received fragments, indexed by fragment counter - 1
+ * @param [out]    status   Status returned for each received fragment
+ * @param [in,out] timing   Decoding time, updated
+ *
+ * @return Status of the session once all the fragments are fed
+ */
+static FragDecoderSessionStatus_t frag_bench_decode( const frag_bench_decoder_t* decoder,
+                                                     const frag_bench_config_t* config, const bool* received,
+                                                     FragDecoderSessionStatus_t* status, frag_bench_timing_t* timing );
+
+/**
+ * @brief Get the time in us of a monotonic clock
+ */
+static double frag_bench_time_us( void );
+
+/**
+ * @brief xorshift32 random generator
+ */
+static uint32_t frag_bench_rand( void );
+
+/**
+ * @brief Parse the command line
+ */
+static bool parse_args( int argc, char** argv, frag_bench_config_t* config );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    frag_bench_config_t config = {
+        .nb_frag     = FRAG_BENCH_NB_FRAG_DEFAULT,
+        .frag_size   = FRAG_BENCH_FRAG_SIZE_DEFAULT,
+        .nb_sessions = FRAG_BENCH_NB_SESSIONS_DEFAULT,
+        .seed        = FRAG_BENCH_SEED_DEFAULT,
+    };
+
+    if( parse_args( argc, argv, &config ) == false )
+    {
+        return 1;
+    }
+    random_state = ( config.seed != 0 ) ? config.seed : 1;
+
+    file_word_size = ( uint32_t ) config.nb_frag * config.frag_size;
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    matrix_word_size = FragDecoderGetMatrixMemorySize( config.nb_frag );
+    matrix_word      = malloc( matrix_word_size );
+    if( matrix_word == NULL )
+    {
+        return 1;
+    }
+#endif
+
+    const frag_bench_decoder_t reference = {
+        .init      = FragDecoderReferenceInit,
+        .process   = FragDecoderReferenceProcess,
+        .callbacks = { .FragDecoderWrite = reference_write, .FragDecoderRead = reference_read },
+        .file      = file_reference,
+    };
+    const frag_bench_decoder_t word = {
+        .init      = FragDecoderInit,
+        .process   = FragDecoderProcess,
+        .callbacks = { .FragDecoderWrite = word_write,
+                       .FragDecoderRead  = word_read,
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+                       .FragDecoderMatrixWrite = word_matrix_write,
+                       .FragDecoderMatrixRead  = word_matrix_read,
+#endif
+        },
+        .file      = file_word,
+    };
+
+    printf( "Fragmentation decoder benchmark: %u fragments of %u bytes, %u sessions per loss rate, seed %u\n",
+            config.nb_frag, config.frag_size, config.nb_sessions, config.seed );
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    printf( "Word-wise decoder matrix behind the callbacks: %u bytes of flash, %u bytes of cache\n\n", matrix_word_size,
+            FRAG_DECODER_CACHE_NB_LINES * FRAG_DECODER_CACHE_LINE_SIZE );
+#else
+    printf( "Word-wise decoder matrix in RAM\n\n" );
+#endif
+    printf( "Loss  Decoded   Failed  Mismatch   Reference total/worst call   Word-wise total/worst call  Speed-up  "
+            "Calls/session  Writes/session  Erases/session\n" );
+
+    uint32_t mismatch_total = 0;
+    for( size_t l = 0; l < sizeof( frag_bench_loss_percent ); l++ )
+    {
+        frag_bench_timing_t timing_reference = { 0 };
+        frag_bench_timing_t timing_word      = { 0 };
+        uint32_t            nb_decoded       = 0;
+        uint32_t            nb_failed       = 0;
+        uint32_t            nb_mismatch      = 0;
+
+        word_nb_calls  = 0;
+        word_nb_writes = 0;
+        word_nb_erases = 0;
+
+        for( uint32_t s = 0; s < config.nb_sessions; s++ )
+        {
+            bool                       received[2 * FRAG_MAX_NB];
+            FragDecoderSessionStatus_t status_reference[2 * FRAG_MAX_NB];
+            FragDecoderSessionStatus_t status_word[2 * FRAG_MAX_NB];
+
+            frag_bench_encode( &config );
+            for( uint16_t i = 0; i < 2 * config.nb_frag; i++ )
+            {
+                received[i] = ( frag_bench_rand( ) % 100 ) >= frag_bench_loss_percent[l];
+            }
+
+            FragDecoderSessionStatus_t rc_reference =
+                frag_bench_decode( &reference, &config, received, status_reference, &timing_reference );
+            FragDecoderSessionStatus_t rc_word =
+                frag_bench_decode( &word, &config, received, status_word, &timing_word );
+
+            const size_t file_size = ( size_t ) config.nb_frag * config.frag_size;
+            bool         mismatch  = ( rc_reference != rc_word ) || ( word_out_of_bounds == true ) ||
+                            ( memcmp( status_reference, status_word, 2 * config.nb_frag * sizeof( status_word[0] ) ) !=
+                              0 );
+            if( rc_word == FRAG_SESSION_OK )
+            {
+                mismatch = mismatch || ( memcmp( file_word, file_original, file_size ) != 0 ) ||
+                           ( memcmp( file_reference, file_original, file_size ) != 0 );
+                nb_decoded++;
+            }
+            else
+            {
+                nb_failed++;
+            }
+            if( mismatch == true )
+            {
+                nb_mismatch++;
+            }
+        }
+
+        printf( "%3u%%  %7u  %7u  %8u  %12.0f us %10.0f us  %12.0f us %10.0f us  %7.1fx  %13u  %14u  %14u\n",
+                frag_bench_loss_percent[l], nb_decoded, nb_failed, nb_mismatch, timing_reference.total_us,
+                timing_reference.call_max_us, timing_word.total_us, timing_word.call_max_us,
+                ( timing_word.total_us > 0 ) ? timing_reference.total_us / timing_word.total_us : 0,
+                word_nb_calls / config.nb_sessions, word_nb_writes / config.nb_sessions,
+                word_nb_erases / config.nb_sessions );
+        mismatch_total += nb_mismatch;
+    }
+
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    free( matrix_word );
+#endif
+    if( mismatch_total != 0 )
+    {
+        printf( "\nFAILED: %u sessions differ between the decoders or from the original file\n", mismatch_total );
+        return 1;
+    }
+    printf( "\nThe decoders returned the same statuses and the original file for every session\n" );
+    return 0;
+}
+
+uint8_t FlashErasePage( uint32_t page, uint8_t flash )
+{
+    return 1;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static int8_t reference_write( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    memcpy( &file_reference[addr], data, size );
+    return 0;
+}
+
+static int8_t reference_read( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    memcpy( data, &file_reference[addr], size );
+    return 0;
+}
+
+static int8_t word_write( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    return frag_bench_flash_write( file_word, file_word_size, addr, data, size );
+}
+
+static int8_t word_read( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    return frag_bench_flash_read( file_word, file_word_size, addr, data, size );
+}
+
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+static int8_t word_matrix_write( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    return frag_bench_flash_write( matrix_word, matrix_word_size, addr, data, size );
+}
+
+static int8_t word_matrix_read( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    return frag_bench_flash_read( matrix_word, matrix_word_size, addr, data, size );
+}
+#endif
+
+static int8_t frag_bench_flash_write( uint8_t* flash, uint32_t flash_size, uint32_t addr, const uint8_t* data,
+                                      uint32_t size )
+{
+    word_nb_calls++;
+    if( addr + size > flash_size )
+    {
+        word_out_of_bounds = true;
+        return -1;
+    }
+    word_nb_writes++;
+    for( uint32_t i = 0; i < size; i++ )
+    {
+        if( ( flash[addr + i] & data[i] ) != data[i] )
+        {
+            word_nb_erases += FRAG_BENCH_FLASH_PAGES_PER_ERASE;
+            break;
+        }
+    }
+    memcpy( &flash[addr], data, size );
+    return 0;
+}
+
+static int8_t frag_bench_flash_read( const uint8_t* flash, uint32_t flash_size, uint32_t addr, uint8_t* data,
+                                     uint32_t size )
+{
+    word_nb_calls++;
+    if( addr + size > flash_size )
+    {
+        word_out_of_bounds = true;
+        return -1;
+    }
+    memcpy( data, &flash[addr], size );
+    return 0;
+}
+
+static void frag_bench_encode( const frag_bench_config_t* config )
+{
+    const uint16_t m = config->nb_frag;
+
+    for( size_t i = 0; i < ( size_t ) m * config->frag_size; i++ )
+    {
+        file_original[i] = ( uint8_t ) frag_bench_rand( );
+    }
+    for( uint16_t i = 0; i < m; i++ )
+    {
+        memcpy( fragments[i], &file_original[i * config->frag_size], config->frag_size );
+    }
+
+    // Coded fragment n is the XOR of m / 2 uncoded fragments drawn with the PRBS23 generator
+    const uint32_t modulo = m + ( ( ( m & ( m - 1 ) ) == 0 ) ? 1 : 0 );
+    for( uint16_t n = m + 1; n <= 2 * m; n++ )
+    {
+        bool     used[FRAG_MAX_NB] = { false };
+        uint16_t nb_used           = 0;
+        int32_t  x                 = 1 + ( 1001 * n );
+
+        memset( fragments[n - 1], 0, config->frag_size );
+        while( nb_used < ( m >> 1 ) )
+        {
+            int32_t r = m;
+            while( r >= m )
+            {
+                x = ( x >> 1 ) + ( ( ( x & 0x01 ) ^ ( ( x & 0x20 ) >> 5 ) ) << 22 );
+                r = x % modulo;
+            }
+            if( used[r] == false )
+            {
+                used[r] = true;
+                nb_used++;
+                for( uint8_t k = 0; k < config->frag_size; k++ )
+                {
+                    fragments[n - 1][k] ^= fragments[r][k];
+                }
+            }
+        }
+    }
+}
+
+static FragDecoderSessionStatus_t frag_bench_decode( const frag_bench_decoder_t* decoder,
+                                                     const frag_bench_config_t* config, const bool* received,
+                                                     FragDecoderSessionStatus_t* status, frag_bench_timing_t* timing )
+{
+    FragDecoderSessionStatus_t rc = FRAG_SESSION_ONGOING;
+    uint8_t                    raw_data[FRAG_MAX_SIZE];
+
+    memset( status, 0xFF, 2 * config->nb_frag * sizeof( status[0] ) );
+    memset( decoder->file, 0, ( size_t ) config->nb_frag * config->frag_size );
+    if( decoder->file == file_word )
+    {
+        // The flash of the word-wise decoder is erased when the session is set up
+        memset( file_word, 0xFF, file_word_size );
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+        memset( matrix_word, 0xFF, matrix_word_size );
+#endif
+    }
+    decoder->init( config->nb_frag, config->frag_size, ( FragDecoderCallbacks_t* ) &decoder->callbacks );
+
+    for( uint16_t i = 0; ( i < 2 * config->nb_frag ) && ( rc == FRAG_SESSION_ONGOING ); i++ )
+    {
+        if( received[i] == false )
+        {
+            continue;
+        }
+        // The decoder uses the fragment buffer as scratch memory
+        memcpy( raw_data, fragments[i], config->frag_size );
+
+        double start_us = frag_bench_time_us( );
+        rc              = decoder->process( i + 1, raw_data );
+        double call_us  = frag_bench_time_us( ) - start_us;
+
+        status[i] = rc;
+        timing->total_us += call_us;
+        if( call_us > timing->call_max_us )
+        {
+            timing->call_max_us = call_us;
+        }
+    }
+    return rc;
+}
+
+static double frag_bench_time_us( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( double ) now.tv_sec * 1e6 + ( double ) now.tv_nsec / 1e3;
+}
+
+static uint32_t frag_bench_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, frag_bench_config_t* config )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:r:e:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            config->nb_frag = ( uint16_t ) strtoul( optarg, NULL, 0 );
+            break;
+        case 's':
+            config->frag_size = ( uint8_t ) strtoul( optarg, NULL, 0 );
+            break;
+        case 'r':
+            config->nb_sessions = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            config->seed = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n nb_frag] [-s frag_size] [-r sessions_per_loss_rate] [-e seed]\n", argv[0] );
+            return false;
+        }
+    }
+    if( ( config->nb_frag < 2 ) || ( config->nb_frag > FRAG_MAX_NB ) || ( config->frag_size == 0 ) ||
+        ( config->frag_size > FRAG_MAX_SIZE ) )
+    {
+        printf( "The number of fragments must be in [2:%u] and their size in [1:%u]\n", FRAG_MAX_NB, FRAG_MAX_SIZE );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
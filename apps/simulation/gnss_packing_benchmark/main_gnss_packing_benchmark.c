@@ -0,0 +1,471 @@
+/**
+ * @file      main_gnss_packing_benchmark.c
+ *
+ * @brief     Frames and airtime of the GNSS scan group uplinks, one NAV message per frame against packed frames
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gnss_queue.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define GNSS_PACKING_BENCH_NB_GROUPS_DEFAULT 100
+#define GNSS_PACKING_BENCH_GROUP_SIZE_DEFAULT 4
+#define GNSS_PACKING_BENCH_SEED_DEFAULT 1
+
+/**
+ * @brief Size of the LoRaWAN frame around the application payload (MHDR, FHDR without FOpts, FPort, MIC)
+ */
+#define GNSS_PACKING_BENCH_LORAWAN_OVERHEAD 13
+
+/**
+ * @brief Synthetic NAV messages: assisted scan with dopplers, 49 bytes for 10 SVs
+ */
+#define GNSS_PACKING_BENCH_NAV_SIZE( nb_svs ) ( 9 + ( 4 * ( nb_svs ) ) )
+#define GNSS_PACKING_BENCH_NAV_MIN_SVS 5
+
+/**
+ * @brief Maximum number of recorded NAV messages read from a file
+ */
+#define GNSS_PACKING_BENCH_MAX_RECORDED_NAVS 1024
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief LoRa data rate of the uplinks, BW 125 kHz and CR 4/5
+ */
+typedef struct gnss_packing_bench_datarate_s
+{
+    const char* name;
+    uint8_t     sf;
+    uint8_t     max_payload;  //!< Maximum application payload size
+} gnss_packing_bench_datarate_t;
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct gnss_packing_bench_params_s
+{
+    uint32_t    nb_groups;
+    uint8_t     group_size;
+    uint32_t    seed;
+    const char* recorded_navs_file;
+} gnss_packing_bench_params_t;
+
+/**
+ * @brief Uplinks of all the scan groups with an encoding, at a data rate
+ */
+typedef struct gnss_packing_bench_result_s
+{
+    uint32_t nb_frames;
+    uint32_t nb_phy_bytes;
+    double   airtime_ms;
+} gnss_packing_bench_result_t;
+
+/**
+ * @brief NAV message
+ */
+typedef struct gnss_packing_bench_nav_s
+{
+    uint8_t size;
+    uint8_t data[GNSS_RESULT_SIZE_MAX_MODE3];
+} gnss_packing_bench_nav_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static const gnss_packing_bench_datarate_t gnss_packing_bench_datarates[] = {
+    { .name = "EU868 DR0", .sf = 12, .max_payload = 51 },
+    { .name = "EU868 DR2", .sf = 10, .max_payload = 51 },
+    { .name = "EU868 DR3", .sf = 9, .max_payload = 115 },
+    { .name = "EU868 DR5", .sf = 7, .max_payload = 222 },
+};
+
+static gnss_packing_bench_nav_t recorded_navs[GNSS_PACKING_BENCH_MAX_RECORDED_NAVS];
+static uint32_t                 nb_recorded_navs;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Fill a scan group queue with the NAV messages of a scan group
+ *
+ * @param [in]  params Command line parameters
+ * @param [in]  group  Index of the scan group
+ * @param [out] queue  Scan group queue
+ */
+static void gnss_packing_bench_fill( const gnss_packing_bench_params_t* params, uint32_t group,
+                                     gnss_scan_group_queue_t* queue );
+
+/**
+ * @brief Check the NAV messages and metadata of a packed payload against the payloads of one NAV message each
+ *
+ * @param [in]     packed       Packed payload
+ * @param [in]     packed_size  Size of the packed payload
+ * @param [in]     queue        Scan group queue the payloads were popped from
+ * @param [in,out] nav_index    Index of the first NAV message of the packed payload, updated to the next one
+ *
+ * @return true if the packed payload decodes to the NAV messages of the queue
+ */
+static bool gnss_packing_bench_check( const uint8_t* packed, uint8_t packed_size, const gnss_scan_group_queue_t* queue,
+                                      uint8_t* nav_index );
+
+/**
+ * @brief LoRa time on air of an uplink, BW 125 kHz, CR 4/5, 8 preamble symbols, explicit header and CRC
+ *
+ * @param [in] sf           Spreading factor
+ * @param [in] payload_size Application payload size
+ *
+ * @return Time on air in milliseconds
+ */
+static double gnss_packing_bench_airtime_ms( uint8_t sf, uint8_t payload_size );
+
+/**
+ * @brief Add an uplink to a result
+ *
+ * @param [in,out] result       Result
+ * @param [in]     datarate     Data rate of the uplink
+ * @param [in]     payload_size Application payload size
+ */
+static void gnss_packing_bench_add_uplink( gnss_packing_bench_result_t* result,
+                                           const gnss_packing_bench_datarate_t* datarate, uint8_t payload_size );
+
+/**
+ * @brief Read recorded NAV messages from a file, one per line in hexadecimal, without the destination byte
+ *
+ * @param [in] file_name File name
+ *
+ * @return false if the file cannot be read or has no NAV message
+ */
+static bool gnss_packing_bench_read_navs( const char* file_name );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, gnss_packing_bench_params_t* params );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    gnss_packing_bench_params_t params = {
+        .nb_groups          = GNSS_PACKING_BENCH_NB_GROUPS_DEFAULT,
+        .group_size         = GNSS_PACKING_BENCH_GROUP_SIZE_DEFAULT,
+        .seed               = GNSS_PACKING_BENCH_SEED_DEFAULT,
+        .recorded_navs_file = NULL,
+    };
+    uint32_t nb_errors = 0;
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+    if( ( params.recorded_navs_file != NULL ) &&
+        ( gnss_packing_bench_read_navs( params.recorded_navs_file ) == false ) )
+    {
+        printf( "No NAV message read from %s\n", params.recorded_navs_file );
+        return 1;
+    }
+
+    printf( "GNSS packing benchmark: %u scan groups of %u scans (at most %u), %s NAV messages\n\n", params.nb_groups,
+            params.group_size, GNSS_SCAN_GROUP_SIZE_MAX,
+            ( params.recorded_navs_file != NULL ) ? "recorded" : "synthetic" );
+    printf( "  data rate   payload   encoding   frames/group   PHY bytes/group   airtime/group (ms)   "
+            "positions/airtime s\n" );
+    for( size_t dr = 0; dr < sizeof( gnss_packing_bench_datarates ) / sizeof( gnss_packing_bench_datarates[0] ); dr++ )
+    {
+        const gnss_packing_bench_datarate_t* datarate = &gnss_packing_bench_datarates[dr];
+        gnss_packing_bench_result_t          results[2] = { 0 };
+        const char*                          encodings[2] = { "per NAV", "packed" };
+        gnss_scan_group_queue_t              queue;
+        gnss_scan_group_queue_t              queue_packed;
+
+        gnss_scan_group_queue_reset_token( &queue );
+        for( uint32_t group = 0; group < params.nb_groups; group++ )
+        {
+            uint8_t* buffer;
+            uint8_t  buffer_size;
+            uint8_t  packed[GNSS_SCAN_PACKED_SIZE_MAX];
+            uint8_t  nav_index = 0;
+
+            gnss_scan_group_queue_increment_token( &queue );
+            gnss_packing_bench_fill( &params, group, &queue );
+            memcpy( &queue_packed, &queue, sizeof( queue ) );
+
+            while( gnss_scan_group_queue_pop( &queue, &buffer, &buffer_size ) == true )
+            {
+                gnss_packing_bench_add_uplink( &results[0], datarate, buffer_size );
+            }
+            while( gnss_scan_group_queue_pop_packed( &queue_packed, datarate->max_payload, packed, &buffer_size ) ==
+                   true )
+            {
+                const uint8_t first_nav_index = nav_index;
+
+                gnss_packing_bench_add_uplink( &results[1], datarate, buffer_size );
+
+                // A packed payload must fit, except a single NAV message already too large alone
+                if( ( gnss_packing_bench_check( packed, buffer_size, &queue, &nav_index ) == false ) ||
+                    ( ( buffer_size > datarate->max_payload ) && ( nav_index != ( first_nav_index + 1 ) ) ) )
+                {
+                    nb_errors++;
+                }
+            }
+            if( ( nav_index != queue.nb_scans_valid ) || ( queue_packed.nb_scans_sent != queue.nb_scans_sent ) )
+            {
+                nb_errors++;
+            }
+        }
+
+        for( size_t i = 0; i < 2; i++ )
+        {
+            printf( "  %-9s   %7u   %-8s   %12.2f   %15.1f   %18.1f   %19.2f\n", datarate->name, datarate->max_payload,
+                    encodings[i], ( double ) results[i].nb_frames / params.nb_groups,
+                    ( double ) results[i].nb_phy_bytes / params.nb_groups, results[i].airtime_ms / params.nb_groups,
+                    params.nb_groups / ( results[i].airtime_ms / 1000 ) );
+        }
+    }
+
+    if( nb_errors != 0 )
+    {
+        printf( "\nFAILED: %u packed payloads or scan groups differ from the payloads of one NAV message each\n",
+                nb_errors );
+        return 1;
+    }
+    printf( "\nThe packed payloads carry the same NAV messages, token and last NAV flag as one NAV message per "
+            "frame\n" );
+    return 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void gnss_packing_bench_fill( const gnss_packing_bench_params_t* params, uint32_t group,
+                                     gnss_scan_group_queue_t* queue )
+{
+    gnss_scan_t scan;
+
+    gnss_scan_group_queue_new( queue, params->group_size, GNSS_SCAN_GROUP_MODE_SENSITIVITY, 0 );
+    for( uint8_t i = 0; i < params->group_size; i++ )
+    {
+        memset( &scan, 0, sizeof( scan ) );
+        scan.nav_valid = true;
+        if( nb_recorded_navs != 0 )
+        {
+            const gnss_packing_bench_nav_t* nav = &recorded_navs[( group * params->group_size + i ) % nb_recorded_navs];
+
+            scan.detected_svs = GNSS_SCAN_SINGLE_NAV_MIN_SV;
+            scan.results_size = nav->size;
+            memcpy( &scan.results_buffer[GNSS_SCAN_METADATA_SIZE], nav->data, nav->size );
+        }
+        else
+        {
+            scan.detected_svs =
+                GNSS_PACKING_BENCH_NAV_MIN_SVS + ( rand( ) % ( GNSS_NB_SVS_MAX - GNSS_PACKING_BENCH_NAV_MIN_SVS + 1 ) );
+            scan.results_size = GNSS_PACKING_BENCH_NAV_SIZE( scan.detected_svs );
+            for( uint8_t j = 0; j < scan.results_size; j++ )
+            {
+                scan.results_buffer[GNSS_SCAN_METADATA_SIZE + j] = ( uint8_t ) rand( );
+            }
+            // The first byte of a NAV message is its status, never GNSS_SCAN_PACKED_MARKER
+            if( scan.results_buffer[GNSS_SCAN_METADATA_SIZE] == GNSS_SCAN_PACKED_MARKER )
+            {
+                scan.results_buffer[GNSS_SCAN_METADATA_SIZE] = ~GNSS_SCAN_PACKED_MARKER;
+            }
+        }
+        gnss_scan_group_queue_push( queue, &scan );
+    }
+}
+
+static bool gnss_packing_bench_check( const uint8_t* packed, uint8_t packed_size, const gnss_scan_group_queue_t* queue,
+                                      uint8_t* nav_index )
+{
+    uint8_t index = GNSS_SCAN_METADATA_SIZE;
+
+    if( ( packed[0] & 0x7F ) != ( queue->token & 0x7F ) )
+    {
+        return false;
+    }
+    // Several NAV messages are flagged by the marker, and each one but the last is preceded by its size
+    bool several = ( packed_size > index ) && ( packed[index] == GNSS_SCAN_PACKED_MARKER );
+    if( several == true )
+    {
+        index += GNSS_SCAN_PACKED_MARKER_SIZE;
+    }
+    while( index < packed_size )
+    {
+        const gnss_scan_t* scan = &queue->scans[*nav_index];
+        uint8_t            size = packed_size - index;
+
+        if( several == true )
+        {
+            size    = packed[index] & ~GNSS_SCAN_PACKED_NAV_SIZE_NEXT_IS_LAST;
+            several = ( packed[index] & GNSS_SCAN_PACKED_NAV_SIZE_NEXT_IS_LAST ) == 0;
+            index += GNSS_SCAN_PACKED_NAV_SIZE_SIZE;
+        }
+        if( ( *nav_index >= queue->nb_scans_valid ) || ( size != scan->results_size ) ||
+            ( ( index + size ) > packed_size ) ||
+            ( memcmp( &packed[index], &scan->results_buffer[GNSS_SCAN_METADATA_SIZE], size ) != 0 ) )
+        {
+            return false;
+        }
+        index += size;
+        *nav_index += 1;
+    }
+
+    // The last NAV flag is set on the payload carrying the last NAV message only
+    return ( ( packed[0] >> 7 ) == ( *nav_index == queue->nb_scans_valid ) );
+}
+
+static double gnss_packing_bench_airtime_ms( uint8_t sf, uint8_t payload_size )
+{
+    const double symbol_ms = ( double ) ( 1 << sf ) / 125;
+    const int    ldro      = ( sf >= 11 ) ? 1 : 0;
+    const int    numerator = 8 * ( payload_size + GNSS_PACKING_BENCH_LORAWAN_OVERHEAD ) - 4 * sf + 28 + 16;
+    int          nb_symbols;
+
+    nb_symbols = ( int ) ceil( ( double ) numerator / ( 4 * ( sf - 2 * ldro ) ) ) * 5;
+    if( nb_symbols < 0 )
+    {
+        nb_symbols = 0;
+    }
+    return ( 8 + 4.25 + 8 + nb_symbols ) * symbol_ms;
+}
+
+static void gnss_packing_bench_add_uplink( gnss_packing_bench_result_t* result,
+                                           const gnss_packing_bench_datarate_t* datarate, uint8_t payload_size )
+{
+    result->nb_frames += 1;
+    result->nb_phy_bytes += payload_size + GNSS_PACKING_BENCH_LORAWAN_OVERHEAD;
+    result->airtime_ms += gnss_packing_bench_airtime_ms( datarate->sf, payload_size );
+}
+
+static bool gnss_packing_bench_read_navs( const char* file_name )
+{
+    FILE* file = fopen( file_name, "r" );
+    char  line[4 * GNSS_RESULT_SIZE_MAX_MODE3];
+
+    if( file == NULL )
+    {
+        return false;
+    }
+    while( ( nb_recorded_navs < GNSS_PACKING_BENCH_MAX_RECORDED_NAVS ) &&
+           ( fgets( line, sizeof( line ), file ) != NULL ) )
+    {
+        gnss_packing_bench_nav_t* nav = &recorded_navs[nb_recorded_navs];
+        const char*               hex = line;
+        unsigned int              byte;
+        int                       length;
+
+        nav->size = 0;
+        while( ( nav->size < sizeof( nav->data ) ) && ( sscanf( hex, " %2x%n", &byte, &length ) == 1 ) )
+        {
+            nav->data[nav->size++] = ( uint8_t ) byte;
+            hex += length;
+        }
+        if( nav->size != 0 )
+        {
+            nb_recorded_navs++;
+        }
+    }
+    fclose( file );
+    return ( nb_recorded_navs != 0 );
+}
+
+static bool parse_args( int argc, char** argv, gnss_packing_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:g:s:f:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_groups = strtoul( optarg, NULL, 0 );
+            break;
+        case 'g':
+            params->group_size = strtoul( optarg, NULL, 0 );
+            break;
+        case 's':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        case 'f':
+            params->recorded_navs_file = optarg;
+            break;
+        default:
+            printf( "Usage: %s [-n nb_groups] [-g group_size] [-s seed] [-f recorded_navs_file]\n", argv[0] );
+            return false;
+        }
+    }
+    if( params->nb_groups == 0 )
+    {
+        printf( "The number of scan groups must be at least 1\n" );
+        return false;
+    }
+    if( ( params->group_size == 0 ) || ( params->group_size > GNSS_SCAN_GROUP_SIZE_MAX ) )
+    {
+        printf( "The scan group size must be in [1..%u]\n", GNSS_SCAN_GROUP_SIZE_MAX );
+        return false;
+    }
+    srand( params->seed );
+    return true;
+}
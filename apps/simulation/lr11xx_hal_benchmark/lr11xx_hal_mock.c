@@ -0,0 +1,298 @@
+/**
+ * @file      lr11xx_hal_mock.c
+ *
+ * @brief     MCU HAL mock of the LR11xx HAL, with the SPI bus and BUSY pin of a simulated LR11xx
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "lr11xx_hal_mock.h"
+#include "smtc_hal_options.h"
+#include "smtc_hal_gpio.h"
+#include "smtc_hal_spi.h"
+#include "smtc_hal_mcu.h"
+#include "smtc_hal_lp_timer.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define LR11XX_HAL_MOCK_SPI_ID 1
+
+#define LR11XX_HAL_MOCK_HASH_INIT 2166136261u
+#define LR11XX_HAL_MOCK_HASH_PRIME 16777619u
+
+/**
+ * @brief Values hashed for the NSS edges, out of the byte range
+ */
+#define LR11XX_HAL_MOCK_NSS_FALL 0x100
+#define LR11XX_HAL_MOCK_NSS_RISE 0x101
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+const lr11xx_hal_context_t lr11xx_hal_mock_context = {
+    .nss    = PA_4,
+    .busy   = PB_0,
+    .reset  = PA_0,
+    .spi_id = LR11XX_HAL_MOCK_SPI_ID,
+};
+
+static struct
+{
+    lr11xx_hal_mock_stats_t stats;
+    uint32_t                busy_length;
+    uint32_t                busy_remaining;  //!< Reads of the BUSY pin before it falls
+    bool                    sleeping;
+    bool                    nss_low;
+    bool                    irq_enabled;
+    uint16_t                nb_bytes;  //!< Bytes of the current transaction
+    uint8_t                 opcode[2];
+} mock;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Add a value to the bus hash
+ *
+ * @param [in] value Byte, or NSS edge
+ */
+static void lr11xx_hal_mock_hash( const uint32_t value );
+
+/**
+ * @brief Exchange a byte with the simulated LR11xx
+ *
+ * @param [in] out_data Byte sent
+ *
+ * @return Byte received
+ */
+static uint8_t lr11xx_hal_mock_exchange( const uint8_t out_data );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void lr11xx_hal_mock_init( const uint32_t busy_length )
+{
+    memset( &mock, 0, sizeof( mock ) );
+    mock.stats.bus_hash = LR11XX_HAL_MOCK_HASH_INIT;
+    mock.busy_length    = busy_length;
+    mock.irq_enabled    = true;
+}
+
+lr11xx_hal_mock_stats_t lr11xx_hal_mock_get_stats( void )
+{
+    return mock.stats;
+}
+
+void hal_gpio_set_value( const hal_gpio_pin_names_t pin, const hal_gpio_state_t value )
+{
+    if( pin != lr11xx_hal_mock_context.nss )
+    {
+        return;
+    }
+
+    if( value == HAL_GPIO_RESET )
+    {
+        // The LR11xx only takes a transaction with BUSY low, or the NSS glitch waking it up
+        if( ( mock.nss_low == true ) || ( mock.busy_remaining > 0 ) )
+        {
+            mock.stats.nb_framing_errors++;
+        }
+        mock.nss_low  = true;
+        mock.nb_bytes = 0;
+        mock.stats.nb_transactions++;
+        lr11xx_hal_mock_hash( LR11XX_HAL_MOCK_NSS_FALL );
+        return;
+    }
+
+    if( mock.nss_low == false )
+    {
+        mock.stats.nb_framing_errors++;
+        return;
+    }
+    mock.nss_low = false;
+    lr11xx_hal_mock_hash( LR11XX_HAL_MOCK_NSS_RISE );
+
+    if( mock.sleeping == true )
+    {
+        // Only the wake-up glitch, without any byte, is expected in sleep mode
+        if( mock.nb_bytes != 0 )
+        {
+            mock.stats.nb_framing_errors++;
+        }
+        mock.sleeping       = false;
+        mock.busy_remaining = mock.busy_length;
+    }
+    else if( ( mock.nb_bytes >= 2 ) && ( mock.opcode[0] == 0x01 ) && ( mock.opcode[1] == 0x1B ) )
+    {
+        // Set sleep: BUSY stays high until the wake-up glitch
+        mock.sleeping = true;
+    }
+    else
+    {
+        mock.busy_remaining = mock.busy_length;
+    }
+}
+
+uint32_t hal_gpio_get_value( const hal_gpio_pin_names_t pin )
+{
+    if( pin != lr11xx_hal_mock_context.busy )
+    {
+        return 0;
+    }
+
+    if( mock.sleeping == true )
+    {
+        mock.stats.nb_busy_spins++;
+        return 1;
+    }
+    if( mock.busy_remaining > 0 )
+    {
+        mock.busy_remaining--;
+        mock.stats.nb_busy_spins++;
+        return 1;
+    }
+    return 0;
+}
+
+void hal_gpio_wait_for_value( const hal_gpio_pin_names_t pin, const hal_gpio_state_t value )
+{
+    if( ( pin != lr11xx_hal_mock_context.busy ) || ( value != HAL_GPIO_RESET ) || ( mock.sleeping == true ) )
+    {
+        // BUSY never falls in sleep mode, the MCU would sleep forever
+        mock.stats.nb_framing_errors++;
+        return;
+    }
+    if( mock.busy_remaining > 0 )
+    {
+        mock.busy_remaining = 0;
+        mock.stats.nb_busy_sleeps++;
+    }
+}
+
+void hal_gpio_irq_enable( void )
+{
+    mock.irq_enabled = true;
+}
+
+void hal_gpio_irq_disable( void )
+{
+    mock.irq_enabled = false;
+}
+
+void hal_lp_timer_irq_enable( void )
+{
+}
+
+void hal_lp_timer_irq_disable( void )
+{
+}
+
+void hal_mcu_wait_us( const int32_t microseconds )
+{
+}
+
+uint16_t hal_spi_in_out( const uint32_t id, const uint16_t out_data )
+{
+    mock.stats.nb_spi_calls++;
+    mock.stats.nb_core_bytes++;
+    return lr11xx_hal_mock_exchange( ( uint8_t ) out_data );
+}
+
+void hal_spi_transfer( const uint32_t id, const uint8_t* out_data, uint8_t* in_data, const uint16_t length )
+{
+    mock.stats.nb_spi_calls++;
+#if( HAL_SPI_USE_DMA == HAL_FEATURE_ON )
+    if( length >= HAL_SPI_DMA_MIN_LENGTH )
+    {
+        mock.stats.nb_dma_bytes += length;
+    }
+    else
+#endif
+    {
+        mock.stats.nb_core_bytes += length;
+    }
+
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        const uint8_t data = lr11xx_hal_mock_exchange( ( out_data != NULL ) ? out_data[i] : 0x00 );
+        if( in_data != NULL )
+        {
+            in_data[i] = data;
+        }
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void lr11xx_hal_mock_hash( const uint32_t value )
+{
+    mock.stats.bus_hash = ( mock.stats.bus_hash ^ value ) * LR11XX_HAL_MOCK_HASH_PRIME;
+}
+
+static uint8_t lr11xx_hal_mock_exchange( const uint8_t out_data )
+{
+    // Bytes are only exchanged within a transaction, with the modem interrupts disabled
+    if( ( mock.nss_low == false ) || ( mock.irq_enabled == true ) )
+    {
+        mock.stats.nb_framing_errors++;
+    }
+    if( mock.nb_bytes < 2 )
+    {
+        mock.opcode[mock.nb_bytes] = out_data;
+    }
+    lr11xx_hal_mock_hash( out_data );
+
+    // The received bytes only depend on the position in the transaction and on the transaction
+    const uint8_t in_data = ( uint8_t ) ( ( mock.stats.nb_transactions * 151 ) + ( mock.nb_bytes * 29 ) + 0x5A );
+    mock.nb_bytes++;
+    return in_data;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,98 @@
+/**
+ * @file      lr11xx_hal_mock.h
+ *
+ * @brief     MCU HAL mock of the LR11xx HAL, with the SPI bus and BUSY pin of a simulated LR11xx
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_HAL_MOCK_H
+#define LR11XX_HAL_MOCK_H
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+#include "lr11xx_hal_context.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Counters of the mock
+ */
+typedef struct lr11xx_hal_mock_stats_s
+{
+    uint32_t nb_transactions;    //!< NSS low periods, wake-up glitches included
+    uint32_t nb_spi_calls;       //!< Calls to hal_spi_in_out() and hal_spi_transfer()
+    uint32_t nb_core_bytes;      //!< Bytes moved by the MCU core
+    uint32_t nb_dma_bytes;       //!< Bytes moved by the DMA
+    uint32_t nb_busy_spins;      //!< Reads of the BUSY pin while it is high
+    uint32_t nb_busy_sleeps;     //!< Sleeps until the BUSY falling edge
+    uint32_t nb_framing_errors;  //!< SPI transaction framing errors
+    uint32_t bus_hash;           //!< Hash of the NSS framing and of the bytes sent to the LR11xx
+} lr11xx_hal_mock_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC VARIABLES --------------------------------------------------------
+ */
+
+/**
+ * @brief LR11xx HAL context of the simulated LR11xx
+ */
+extern const lr11xx_hal_context_t lr11xx_hal_mock_context;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Wake the simulated LR11xx up and clear the counters
+ *
+ * @param [in] busy_length Reads of the BUSY pin during which it stays high after a command
+ */
+void lr11xx_hal_mock_init( const uint32_t busy_length );
+
+/**
+ * @brief Get the counters
+ *
+ * @return Counters since lr11xx_hal_mock_init()
+ */
+lr11xx_hal_mock_stats_t lr11xx_hal_mock_get_stats( void );
+
+#endif  // LR11XX_HAL_MOCK_H
+
+/* --- EOF ------------------------------------------------------------------ */
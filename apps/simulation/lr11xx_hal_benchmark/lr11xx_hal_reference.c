@@ -0,0 +1,194 @@
+/**
+ * @file      lr11xx_hal_reference.c
+ *
+ * @brief     Byte-wise LR11xx HAL, spinning on the BUSY pin, replaced by the bulk transfers of lr11xx_hal.c
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lr11xx_hal_reference.h"
+#include "lr11xx_hal_context.h"
+#include "smtc_hal_gpio.h"
+#include "smtc_hal_spi.h"
+#include "smtc_hal_mcu.h"
+#include "smtc_hal_lp_timer.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+typedef enum
+{
+    RADIO_SLEEP,
+    RADIO_AWAKE
+} radio_mode_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static radio_mode_t radio_mode = RADIO_AWAKE;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Spin until the BUSY pin is low, waking the LR11xx up first in sleep mode
+ */
+static void lr11xx_hal_reference_check_device_ready( const lr11xx_hal_context_t* lr11xx_context );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+lr11xx_hal_status_t lr11xx_hal_reference_write( const void* context, const uint8_t* command,
+                                                const uint16_t command_length, const uint8_t* data,
+                                                const uint16_t data_length )
+{
+    const lr11xx_hal_context_t* lr11xx_context = ( const lr11xx_hal_context_t* ) context;
+
+    lr11xx_hal_reference_check_device_ready( lr11xx_context );
+    hal_gpio_irq_disable( );
+    hal_lp_timer_irq_disable( );
+
+    hal_gpio_set_value( lr11xx_context->nss, 0 );
+    for( uint16_t i = 0; i < command_length; i++ )
+    {
+        hal_spi_in_out( lr11xx_context->spi_id, command[i] );
+    }
+    for( uint16_t i = 0; i < data_length; i++ )
+    {
+        hal_spi_in_out( lr11xx_context->spi_id, data[i] );
+    }
+    hal_gpio_set_value( lr11xx_context->nss, 1 );
+
+    if( ( command[0] == 0x01 ) && ( command[1] == 0x1B ) )
+    {
+        radio_mode = RADIO_SLEEP;
+        hal_mcu_wait_us( 500 );
+    }
+
+    hal_gpio_irq_enable( );
+    hal_lp_timer_irq_enable( );
+    return LR11XX_HAL_STATUS_OK;
+}
+
+lr11xx_hal_status_t lr11xx_hal_reference_read( const void* context, const uint8_t* command,
+                                               const uint16_t command_length, uint8_t* data,
+                                               const uint16_t data_length )
+{
+    const lr11xx_hal_context_t* lr11xx_context = ( const lr11xx_hal_context_t* ) context;
+
+    lr11xx_hal_reference_check_device_ready( lr11xx_context );
+    hal_gpio_irq_disable( );
+    hal_lp_timer_irq_disable( );
+
+    hal_gpio_set_value( lr11xx_context->nss, 0 );
+    for( uint16_t i = 0; i < command_length; i++ )
+    {
+        hal_spi_in_out( lr11xx_context->spi_id, command[i] );
+    }
+    hal_gpio_set_value( lr11xx_context->nss, 1 );
+
+    if( data_length > 0 )
+    {
+        lr11xx_hal_reference_check_device_ready( lr11xx_context );
+        hal_gpio_set_value( lr11xx_context->nss, 0 );
+        hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
+        for( uint16_t i = 0; i < data_length; i++ )
+        {
+            data[i] = hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
+        }
+        hal_gpio_set_value( lr11xx_context->nss, 1 );
+    }
+
+    hal_gpio_irq_enable( );
+    hal_lp_timer_irq_enable( );
+    return LR11XX_HAL_STATUS_OK;
+}
+
+lr11xx_hal_status_t lr11xx_hal_reference_direct_read( const void* context, uint8_t* data,
+                                                      const uint16_t data_length )
+{
+    const lr11xx_hal_context_t* lr11xx_context = ( const lr11xx_hal_context_t* ) context;
+
+    lr11xx_hal_reference_check_device_ready( lr11xx_context );
+    hal_gpio_irq_disable( );
+    hal_lp_timer_irq_disable( );
+
+    hal_gpio_set_value( lr11xx_context->nss, 0 );
+    for( uint16_t i = 0; i < data_length; i++ )
+    {
+        data[i] = hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
+    }
+    hal_gpio_set_value( lr11xx_context->nss, 1 );
+
+    hal_gpio_irq_enable( );
+    hal_lp_timer_irq_enable( );
+    return LR11XX_HAL_STATUS_OK;
+}
+
+lr11xx_hal_status_t lr11xx_hal_reference_wakeup( const void* context )
+{
+    lr11xx_hal_reference_check_device_ready( ( const lr11xx_hal_context_t* ) context );
+    return LR11XX_HAL_STATUS_OK;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void lr11xx_hal_reference_check_device_ready( const lr11xx_hal_context_t* lr11xx_context )
+{
+    if( radio_mode == RADIO_SLEEP )
+    {
+        hal_gpio_set_value( lr11xx_context->nss, 0 );
+        hal_gpio_set_value( lr11xx_context->nss, 1 );
+        radio_mode = RADIO_AWAKE;
+    }
+    while( hal_gpio_get_value( lr11xx_context->busy ) == 1 )
+    {
+    };
+}
+
+/* --- EOF ------------------------------------------------------------------ */
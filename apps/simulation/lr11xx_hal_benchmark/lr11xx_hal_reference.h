@@ -0,0 +1,79 @@
+/**
+ * @file      lr11xx_hal_reference.h
+ *
+ * @brief     Byte-wise LR11xx HAL, spinning on the BUSY pin, replaced by the bulk transfers of lr11xx_hal.c
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LR11XX_HAL_REFERENCE_H
+#define LR11XX_HAL_REFERENCE_H
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+#include "lr11xx_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Byte-wise lr11xx_hal_write()
+ */
+lr11xx_hal_status_t lr11xx_hal_reference_write( const void* context, const uint8_t* command,
+                                                const uint16_t command_length, const uint8_t* data,
+                                                const uint16_t data_length );
+
+/**
+ * @brief Byte-wise lr11xx_hal_read()
+ */
+lr11xx_hal_status_t lr11xx_hal_reference_read( const void* context, const uint8_t* command,
+                                               const uint16_t command_length, uint8_t* data,
+                                               const uint16_t data_length );
+
+/**
+ * @brief Byte-wise lr11xx_hal_direct_read()
+ */
+lr11xx_hal_status_t lr11xx_hal_reference_direct_read( const void* context, uint8_t* data,
+                                                      const uint16_t data_length );
+
+/**
+ * @brief Spinning lr11xx_hal_wakeup()
+ */
+lr11xx_hal_status_t lr11xx_hal_reference_wakeup( const void* context );
+
+#endif  // LR11XX_HAL_REFERENCE_H
+
+/* --- EOF ------------------------------------------------------------------ */
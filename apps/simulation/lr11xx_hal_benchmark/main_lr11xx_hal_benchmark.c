@@ -0,0 +1,381 @@
+/**
+ * @file      main_lr11xx_hal_benchmark.c
+ *
+ * @brief     Bulk SPI transfers and BUSY wait of the LR11xx HAL against its byte-wise version, on a mocked MCU HAL
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lr11xx_hal.h"
+#include "lr11xx_hal_mock.h"
+#include "lr11xx_hal_reference.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define LR11XX_HAL_BENCH_NB_ROUNDS_DEFAULT 100
+#define LR11XX_HAL_BENCH_BUSY_LENGTH_DEFAULT 500
+#define LR11XX_HAL_BENCH_NB_WIFI_RESULTS_DEFAULT 32
+#define LR11XX_HAL_BENCH_GNSS_RESULT_SIZE_DEFAULT 255
+
+/**
+ * @brief Almanac image, header and 128 satellites, written in commands of up to 25 blocks
+ */
+#define LR11XX_HAL_BENCH_ALMANAC_BLOCK_SIZE 20
+#define LR11XX_HAL_BENCH_ALMANAC_NB_BLOCKS 129
+#define LR11XX_HAL_BENCH_ALMANAC_MAX_NB_BLOCKS 25
+
+/**
+ * @brief Wi-Fi basic complete results, read by up to 46 results
+ */
+#define LR11XX_HAL_BENCH_WIFI_RESULT_SIZE 22
+#define LR11XX_HAL_BENCH_WIFI_MAX_NB_RESULTS 46
+
+#define LR11XX_HAL_BENCH_MAX_READ_SIZE 1024
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief LR11xx HAL under test
+ */
+typedef struct lr11xx_hal_bench_hal_s
+{
+    const char* name;
+    lr11xx_hal_status_t ( *write )( const void* context, const uint8_t* command, const uint16_t command_length,
+                                    const uint8_t* data, const uint16_t data_length );
+    lr11xx_hal_status_t ( *read )( const void* context, const uint8_t* command, const uint16_t command_length,
+                                   uint8_t* data, const uint16_t data_length );
+    lr11xx_hal_status_t ( *direct_read )( const void* context, uint8_t* data, const uint16_t data_length );
+    lr11xx_hal_status_t ( *wakeup )( const void* context );
+} lr11xx_hal_bench_hal_t;
+
+/**
+ * @brief Workloads
+ */
+typedef enum lr11xx_hal_bench_workload_e
+{
+    LR11XX_HAL_BENCH_ALMANAC,
+    LR11XX_HAL_BENCH_WIFI,
+    LR11XX_HAL_BENCH_GNSS,
+    LR11XX_HAL_BENCH_NB_WORKLOADS,
+} lr11xx_hal_bench_workload_t;
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct lr11xx_hal_bench_params_s
+{
+    uint32_t nb_rounds;
+    uint32_t busy_length;
+    uint16_t nb_wifi_results;
+    uint16_t gnss_result_size;
+} lr11xx_hal_bench_params_t;
+
+/**
+ * @brief Results of a workload with a HAL, summed over the rounds
+ */
+typedef struct lr11xx_hal_bench_result_s
+{
+    lr11xx_hal_mock_stats_t stats;
+    uint32_t                read_hash;  //!< Hash of the bytes read from the LR11xx
+} lr11xx_hal_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static const lr11xx_hal_bench_hal_t lr11xx_hal_bench_hals[] = {
+    {
+        .name        = "byte-wise",
+        .write       = lr11xx_hal_reference_write,
+        .read        = lr11xx_hal_reference_read,
+        .direct_read = lr11xx_hal_reference_direct_read,
+        .wakeup      = lr11xx_hal_reference_wakeup,
+    },
+    {
+        .name        = "bulk",
+        .write       = lr11xx_hal_write,
+        .read        = lr11xx_hal_read,
+        .direct_read = lr11xx_hal_direct_read,
+        .wakeup      = lr11xx_hal_wakeup,
+    },
+};
+
+static const char* lr11xx_hal_bench_workload_names[LR11XX_HAL_BENCH_NB_WORKLOADS] = {
+    "almanac write",
+    "Wi-Fi read",
+    "GNSS read",
+};
+
+static uint8_t almanac[LR11XX_HAL_BENCH_ALMANAC_NB_BLOCKS * LR11XX_HAL_BENCH_ALMANAC_BLOCK_SIZE];
+static uint8_t read_buffer[LR11XX_HAL_BENCH_MAX_READ_SIZE];
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Run the rounds of a workload with a HAL, each round putting the LR11xx to sleep at its end
+ *
+ * @param [in]  params   Command line parameters
+ * @param [in]  hal      LR11xx HAL
+ * @param [in]  workload Workload
+ * @param [out] result   Results
+ */
+static void lr11xx_hal_bench_run( const lr11xx_hal_bench_params_t* params, const lr11xx_hal_bench_hal_t* hal,
+                                  lr11xx_hal_bench_workload_t workload, lr11xx_hal_bench_result_t* result );
+
+/**
+ * @brief Add bytes read from the LR11xx to a hash
+ *
+ * @param [in,out] hash   Hash
+ * @param [in]     data   Bytes read
+ * @param [in]     length Number of bytes
+ */
+static void lr11xx_hal_bench_hash( uint32_t* hash, const uint8_t* data, uint16_t length );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, lr11xx_hal_bench_params_t* params );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    lr11xx_hal_bench_params_t params = {
+        .nb_rounds        = LR11XX_HAL_BENCH_NB_ROUNDS_DEFAULT,
+        .busy_length      = LR11XX_HAL_BENCH_BUSY_LENGTH_DEFAULT,
+        .nb_wifi_results  = LR11XX_HAL_BENCH_NB_WIFI_RESULTS_DEFAULT,
+        .gnss_result_size = LR11XX_HAL_BENCH_GNSS_RESULT_SIZE_DEFAULT,
+    };
+    uint32_t nb_errors = 0;
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+
+    for( uint16_t i = 0; i < sizeof( almanac ); i++ )
+    {
+        almanac[i] = ( uint8_t ) ( i * 7 + 3 );
+    }
+
+    printf( "LR11xx HAL benchmark: %u rounds, BUSY high for %u reads, %u Wi-Fi results, %u-byte GNSS result\n\n",
+            params.nb_rounds, params.busy_length, params.nb_wifi_results, params.gnss_result_size );
+    printf( "  workload        HAL         transactions   SPI calls   core bytes   DMA bytes   BUSY spins   "
+            "BUSY sleeps\n" );
+    for( lr11xx_hal_bench_workload_t workload = 0; workload < LR11XX_HAL_BENCH_NB_WORKLOADS; workload++ )
+    {
+        lr11xx_hal_bench_result_t results[sizeof( lr11xx_hal_bench_hals ) / sizeof( lr11xx_hal_bench_hals[0] )];
+        const double              nb_rounds = params.nb_rounds;
+
+        for( size_t i = 0; i < sizeof( lr11xx_hal_bench_hals ) / sizeof( lr11xx_hal_bench_hals[0] ); i++ )
+        {
+            const lr11xx_hal_mock_stats_t* stats = &results[i].stats;
+
+            lr11xx_hal_bench_run( &params, &lr11xx_hal_bench_hals[i], workload, &results[i] );
+            printf( "  %-14s  %-10s  %12.1f   %9.1f   %10.1f   %9.1f   %10.1f   %11.1f\n",
+                    lr11xx_hal_bench_workload_names[workload], lr11xx_hal_bench_hals[i].name,
+                    stats->nb_transactions / nb_rounds, stats->nb_spi_calls / nb_rounds,
+                    stats->nb_core_bytes / nb_rounds, stats->nb_dma_bytes / nb_rounds,
+                    stats->nb_busy_spins / nb_rounds, stats->nb_busy_sleeps / nb_rounds );
+
+            // Both HALs must put the same transactions on the bus and read the same bytes
+            if( ( stats->nb_framing_errors != 0 ) || ( stats->bus_hash != results[0].stats.bus_hash ) ||
+                ( results[i].read_hash != results[0].read_hash ) )
+            {
+                printf( "  %-14s  %-10s  %u framing errors, bus %s, read bytes %s\n",
+                        lr11xx_hal_bench_workload_names[workload], lr11xx_hal_bench_hals[i].name,
+                        stats->nb_framing_errors,
+                        ( stats->bus_hash == results[0].stats.bus_hash ) ? "same" : "different",
+                        ( results[i].read_hash == results[0].read_hash ) ? "same" : "different" );
+                nb_errors++;
+            }
+        }
+    }
+
+    if( nb_errors != 0 )
+    {
+        printf( "\nFAILED: %u runs differ from the byte-wise HAL\n", nb_errors );
+        return 1;
+    }
+    printf( "\nBoth HALs put the same transactions on the SPI bus, with BUSY low, and read the same bytes\n" );
+    return 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void lr11xx_hal_bench_run( const lr11xx_hal_bench_params_t* params, const lr11xx_hal_bench_hal_t* hal,
+                                  lr11xx_hal_bench_workload_t workload, lr11xx_hal_bench_result_t* result )
+{
+    const void*   context          = &lr11xx_hal_mock_context;
+    const uint8_t sleep_command[7] = { 0x01, 0x1B, 0x00, 0x00, 0x00, 0x00, 0x00 };
+
+    lr11xx_hal_mock_init( params->busy_length );
+    result->read_hash = 0;
+
+    for( uint32_t round = 0; round < params->nb_rounds; round++ )
+    {
+        switch( workload )
+        {
+        case LR11XX_HAL_BENCH_ALMANAC:
+        {
+            const uint8_t command[2] = { 0x04, 0x0E };
+
+            for( uint16_t block = 0; block < LR11XX_HAL_BENCH_ALMANAC_NB_BLOCKS;
+                 block += LR11XX_HAL_BENCH_ALMANAC_MAX_NB_BLOCKS )
+            {
+                const uint16_t nb_blocks =
+                    ( ( LR11XX_HAL_BENCH_ALMANAC_NB_BLOCKS - block ) < LR11XX_HAL_BENCH_ALMANAC_MAX_NB_BLOCKS )
+                        ? ( LR11XX_HAL_BENCH_ALMANAC_NB_BLOCKS - block )
+                        : LR11XX_HAL_BENCH_ALMANAC_MAX_NB_BLOCKS;
+                hal->write( context, command, sizeof( command ), &almanac[block * LR11XX_HAL_BENCH_ALMANAC_BLOCK_SIZE],
+                            nb_blocks * LR11XX_HAL_BENCH_ALMANAC_BLOCK_SIZE );
+            }
+            break;
+        }
+        case LR11XX_HAL_BENCH_WIFI:
+        {
+            for( uint16_t index = 0; index < params->nb_wifi_results; index += LR11XX_HAL_BENCH_WIFI_MAX_NB_RESULTS )
+            {
+                const uint16_t remaining  = params->nb_wifi_results - index;
+                const uint16_t nb_results = ( remaining < LR11XX_HAL_BENCH_WIFI_MAX_NB_RESULTS )
+                                                ? remaining
+                                                : LR11XX_HAL_BENCH_WIFI_MAX_NB_RESULTS;
+                const uint8_t  command[5] = { 0x03, 0x06, ( uint8_t ) index, ( uint8_t ) nb_results, 0x01 };
+
+                hal->read( context, command, sizeof( command ), read_buffer,
+                           nb_results * LR11XX_HAL_BENCH_WIFI_RESULT_SIZE );
+                lr11xx_hal_bench_hash( &result->read_hash, read_buffer,
+                                       nb_results * LR11XX_HAL_BENCH_WIFI_RESULT_SIZE );
+            }
+            break;
+        }
+        case LR11XX_HAL_BENCH_GNSS:
+        {
+            const uint8_t command[2] = { 0x04, 0x0D };
+
+            hal->read( context, command, sizeof( command ), read_buffer, params->gnss_result_size );
+            lr11xx_hal_bench_hash( &result->read_hash, read_buffer, params->gnss_result_size );
+
+            // The NAV message is also fetched with a direct read by the modem
+            hal->direct_read( context, read_buffer, params->gnss_result_size );
+            lr11xx_hal_bench_hash( &result->read_hash, read_buffer, params->gnss_result_size );
+            break;
+        }
+        default:
+            break;
+        }
+
+        hal->write( context, sleep_command, sizeof( sleep_command ), NULL, 0 );
+    }
+    hal->wakeup( context );
+
+    result->stats = lr11xx_hal_mock_get_stats( );
+}
+
+static void lr11xx_hal_bench_hash( uint32_t* hash, const uint8_t* data, uint16_t length )
+{
+    for( uint16_t i = 0; i < length; i++ )
+    {
+        *hash = ( ( *hash ^ data[i] ) * 16777619u ) + 1;
+    }
+}
+
+static bool parse_args( int argc, char** argv, lr11xx_hal_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:b:w:g:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_rounds = strtoul( optarg, NULL, 0 );
+            break;
+        case 'b':
+            params->busy_length = strtoul( optarg, NULL, 0 );
+            break;
+        case 'w':
+            params->nb_wifi_results = strtoul( optarg, NULL, 0 );
+            break;
+        case 'g':
+            params->gnss_result_size = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n rounds] [-b busy_length] [-w nb_wifi_results] [-g gnss_result_size]\n", argv[0] );
+            return false;
+        }
+    }
+    if( params->nb_rounds == 0 )
+    {
+        printf( "The number of rounds must be at least 1\n" );
+        return false;
+    }
+    if( ( params->nb_wifi_results > 255 ) ||
+        ( params->gnss_result_size > LR11XX_HAL_BENCH_MAX_READ_SIZE ) )
+    {
+        printf( "At most 255 Wi-Fi results and a %u-byte GNSS result are read\n", LR11XX_HAL_BENCH_MAX_READ_SIZE );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
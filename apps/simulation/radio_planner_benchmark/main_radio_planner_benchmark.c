@@ -0,0 +1,882 @@
+/**
+ * @file      main_radio_planner_benchmark.c
+ *
+ * @brief     Replays random task sequences on the radio planner and on the reference planner, and compares their traces
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "radio_planner.h"
+#include "radio_planner_reference.h"
+#include "smtc_modem_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define RP_BENCH_NB_SEQUENCES_DEFAULT 600
+#define RP_BENCH_NB_STEPS_DEFAULT 3000
+
+/**
+ * @brief Time origin of the sequences that cross the wrap-around of the millisecond clock
+ */
+#define RP_BENCH_WRAP_AROUND_ORIGIN_MS ( 0xFFFFFFFFu - 20000 )
+
+/**
+ * @brief Latency of the timer interrupt of a slow MCU, a scheduled task starting late if it exceeds the margin delay
+ */
+#define RP_BENCH_TIMER_LATENCY_MAX_MS 12
+
+/**
+ * @brief Trace records reserved per step: a step enqueues, aborts or runs an interrupt and the callbacks it triggers
+ */
+#define RP_BENCH_TRACE_PER_STEP 16
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct rp_bench_params_s
+{
+    uint32_t nb_sequences;
+    uint32_t nb_steps;
+    uint32_t seed;
+} rp_bench_params_t;
+
+/**
+ * @brief Events of a trace
+ */
+typedef enum rp_bench_event_e
+{
+    RP_BENCH_EVENT_ENQUEUE,      //!< value_1: task state, value_2: returned status
+    RP_BENCH_EVENT_ABORT,        //!< value_2: returned status
+    RP_BENCH_EVENT_TIMER_START,  //!< value_1: alarm in ms
+    RP_BENCH_EVENT_TIMER_IRQ,
+    RP_BENCH_EVENT_RADIO_IRQ,
+    RP_BENCH_EVENT_LAUNCH,    //!< value_1: task start time, value_2: task duration
+    RP_BENCH_EVENT_CALLBACK,  //!< value_1: status of the hook, value_2: its interrupt timestamp
+    RP_BENCH_EVENT_FINAL,     //!< value_1: task state, value_2: task start time
+} rp_bench_event_t;
+
+/**
+ * @brief Trace record
+ */
+typedef struct rp_bench_record_s
+{
+    uint32_t time_ms;
+    uint8_t  event;
+    uint8_t  hook_id;
+    uint32_t value_1;
+    uint32_t value_2;
+} rp_bench_record_t;
+
+/**
+ * @brief Trace of a sequence
+ */
+typedef struct rp_bench_trace_s
+{
+    rp_bench_record_t* records;
+    uint32_t           nb_records;
+    uint32_t           max_records;
+    rp_stats_t         stats;  //!< Statistics of the planner at the end of the sequence
+} rp_bench_trace_t;
+
+/**
+ * @brief Operations of a planner under test
+ */
+typedef struct rp_bench_planner_s
+{
+    void ( *init )( const ralf_t* radio );
+    void ( *hook_init )( uint8_t id, void ( *callback )( void* context ), void* hook );
+    rp_hook_status_t ( *task_enqueue )( const rp_task_t* task, const rp_radio_params_t* radio_params );
+    rp_hook_status_t ( *task_abort )( uint8_t hook_id );
+    void ( *get_status )( uint8_t id, uint32_t* irq_timestamp_ms, rp_status_t* status );
+    void ( *radio_irq )( void );
+    const rp_task_t* ( *get_task )( uint8_t id );
+    uint8_t ( *get_radio_task_id )( void );
+    rp_stats_t ( *get_stats )( void );
+} rp_bench_planner_t;
+
+/**
+ * @brief Mocked MCU timer, clock and radio
+ */
+typedef struct rp_bench_mock_s
+{
+    uint32_t now_ms;
+    bool     slow;  //!< The callbacks take a few ms and the timer expires late, so that the planner runs late
+    bool     timer_armed;
+    uint32_t timer_ms;
+    void ( *timer_callback )( void* context );
+    void*    timer_context;
+    bool     radio_irq_armed;
+    uint32_t radio_irq_ms;
+    uint32_t nb_callbacks;
+} rp_bench_mock_t;
+
+/**
+ * @brief Results of a kind of sequence
+ */
+typedef struct rp_bench_result_s
+{
+    uint32_t nb_sequences;
+    uint64_t nb_records;
+    uint64_t nb_aborted;  //!< Tasks aborted by the planner, the late ones included
+    uint64_t planner_ns;
+    uint64_t reference_ns;
+    uint32_t nb_mismatches;
+} rp_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static radio_planner_t           planner;
+static radio_planner_reference_t planner_reference;
+static ralf_t                    radio;
+
+static const rp_bench_planner_t* planner_under_test;
+static rp_bench_trace_t*         trace;
+static rp_bench_mock_t           mock;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Replay a sequence on a planner
+ *
+ * @param [in]  params      Command line parameters
+ * @param [in]  ops         Planner under test
+ * @param [in]  sequence_id Sequence number, the sequences with the same number are identical
+ * @param [out] out         Trace of the sequence
+ *
+ * @return Time spent in the sequence, in nanoseconds
+ */
+static uint64_t rp_bench_replay( const rp_bench_params_t* params, const rp_bench_planner_t* ops, uint32_t sequence_id,
+                                 rp_bench_trace_t* out );
+
+/**
+ * @brief Compare the traces of a sequence, and print the first difference
+ *
+ * @return true if the traces are identical
+ */
+static bool rp_bench_compare( uint32_t sequence_id, const rp_bench_trace_t* trace_planner,
+                              const rp_bench_trace_t* trace_reference );
+
+/**
+ * @brief Enqueue a random task
+ *
+ * @param [in] id     Hook id of the task
+ * @param [in] rand_1 Random state, and kind of task
+ * @param [in] rand_2 Random timing of the task
+ */
+static void rp_bench_enqueue( uint8_t id, uint32_t rand_1, uint32_t rand_2 );
+
+/**
+ * @brief Launch callback of the tasks, which arms the radio interrupt
+ */
+static void rp_bench_launch( void* context );
+
+/**
+ * @brief Hook callback, which enqueues a task again from time to time
+ */
+static void rp_bench_hook_callback( void* context );
+
+/**
+ * @brief Let the time go by in a callback, for the sequences where the planner runs late
+ *
+ * @param [in] id Hook id of the task
+ */
+static void rp_bench_callback_delay( uint8_t id );
+
+/**
+ * @brief Add a record to the trace
+ */
+static void rp_bench_record( rp_bench_event_t event, uint8_t hook_id, uint32_t value_1, uint32_t value_2 );
+
+/**
+ * @brief Integer hash used as pseudo-random generator, so that a draw does not depend on the former ones
+ */
+static uint32_t rp_bench_hash( uint32_t x );
+
+/**
+ * @brief Current time, in nanoseconds
+ */
+static uint64_t rp_bench_ns( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, rp_bench_params_t* params );
+
+/**
+ * @brief Operations of the radio planner
+ */
+static void             rp_bench_init( const ralf_t* ralf );
+static void             rp_bench_hook_init( uint8_t id, void ( *callback )( void* context ), void* hook );
+static rp_hook_status_t rp_bench_task_enqueue( const rp_task_t* task, const rp_radio_params_t* radio_params );
+static rp_hook_status_t rp_bench_task_abort( uint8_t hook_id );
+static void             rp_bench_get_status( uint8_t id, uint32_t* irq_timestamp_ms, rp_status_t* status );
+static void             rp_bench_radio_irq( void );
+static const rp_task_t* rp_bench_get_task( uint8_t id );
+static uint8_t          rp_bench_get_radio_task_id( void );
+static rp_stats_t       rp_bench_get_stats( void );
+
+/**
+ * @brief Operations of the reference planner
+ */
+static void             rp_bench_reference_init( const ralf_t* ralf );
+static void             rp_bench_reference_hook_init( uint8_t id, void ( *callback )( void* context ), void* hook );
+static rp_hook_status_t rp_bench_reference_task_enqueue( const rp_task_t* task, const rp_radio_params_t* radio_params );
+static rp_hook_status_t rp_bench_reference_task_abort( uint8_t hook_id );
+static void             rp_bench_reference_get_status( uint8_t id, uint32_t* irq_timestamp_ms, rp_status_t* status );
+static void             rp_bench_reference_radio_irq( void );
+static const rp_task_t* rp_bench_reference_get_task( uint8_t id );
+static uint8_t          rp_bench_reference_get_radio_task_id( void );
+static rp_stats_t       rp_bench_reference_get_stats( void );
+
+/**
+ * @brief Mocked radio driver
+ */
+static ral_status_t rp_bench_radio_set_sleep( const void* context, const bool retain_config );
+static ral_status_t rp_bench_radio_set_standby( const void* context, ral_standby_cfg_t standby_cfg );
+static ral_status_t rp_bench_radio_clear_irq_status( const void* context, const ral_irq_t irq );
+static ral_status_t rp_bench_radio_get_and_clear_irq_status( const void* context, ral_irq_t* irq );
+static ral_status_t rp_bench_radio_get_tx_consumption_in_ua( const void* context, const int8_t output_pwr_in_dbm,
+                                                             const uint32_t rf_freq_in_hz,
+                                                             uint32_t*      pwr_consumption_in_ua );
+static ral_status_t rp_bench_radio_get_lora_rx_consumption_in_ua( const void* context, const ral_lora_bw_t bw,
+                                                                  const bool rx_boosted,
+                                                                  uint32_t*  pwr_consumption_in_ua );
+
+/**
+ * @brief Planners under test
+ */
+static const rp_bench_planner_t rp_bench_planner = {
+    .init              = rp_bench_init,
+    .hook_init         = rp_bench_hook_init,
+    .task_enqueue      = rp_bench_task_enqueue,
+    .task_abort        = rp_bench_task_abort,
+    .get_status        = rp_bench_get_status,
+    .radio_irq         = rp_bench_radio_irq,
+    .get_task          = rp_bench_get_task,
+    .get_radio_task_id = rp_bench_get_radio_task_id,
+    .get_stats         = rp_bench_get_stats,
+};
+
+static const rp_bench_planner_t rp_bench_planner_reference = {
+    .init              = rp_bench_reference_init,
+    .hook_init         = rp_bench_reference_hook_init,
+    .task_enqueue      = rp_bench_reference_task_enqueue,
+    .task_abort        = rp_bench_reference_task_abort,
+    .get_status        = rp_bench_reference_get_status,
+    .radio_irq         = rp_bench_reference_radio_irq,
+    .get_task          = rp_bench_reference_get_task,
+    .get_radio_task_id = rp_bench_reference_get_radio_task_id,
+    .get_stats         = rp_bench_reference_get_stats,
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    rp_bench_params_t params = {
+        .nb_sequences = RP_BENCH_NB_SEQUENCES_DEFAULT,
+        .nb_steps     = RP_BENCH_NB_STEPS_DEFAULT,
+        .seed         = 1,
+    };
+    rp_bench_trace_t  trace_planner;
+    rp_bench_trace_t  trace_reference;
+    rp_bench_result_t results[4] = { 0 };
+    uint32_t          nb_mismatches = 0;
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+
+    radio.ral.driver.set_sleep                     = rp_bench_radio_set_sleep;
+    radio.ral.driver.set_standby                   = rp_bench_radio_set_standby;
+    radio.ral.driver.clear_irq_status              = rp_bench_radio_clear_irq_status;
+    radio.ral.driver.get_and_clear_irq_status      = rp_bench_radio_get_and_clear_irq_status;
+    radio.ral.driver.get_tx_consumption_in_ua      = rp_bench_radio_get_tx_consumption_in_ua;
+    radio.ral.driver.get_lora_rx_consumption_in_ua = rp_bench_radio_get_lora_rx_consumption_in_ua;
+
+    trace_planner.max_records   = params.nb_steps * RP_BENCH_TRACE_PER_STEP + RP_NB_HOOKS;
+    trace_reference.max_records = trace_planner.max_records;
+    trace_planner.records       = malloc( trace_planner.max_records * sizeof( rp_bench_record_t ) );
+    trace_reference.records     = malloc( trace_reference.max_records * sizeof( rp_bench_record_t ) );
+    if( ( trace_planner.records == NULL ) || ( trace_reference.records == NULL ) )
+    {
+        printf( "Cannot allocate the traces\n" );
+        return 1;
+    }
+
+    printf( "Radio planner benchmark: %u sequences of %u steps, %u hooks\n\n", params.nb_sequences, params.nb_steps,
+            RP_NB_HOOKS );
+    for( uint32_t s = 0; s < params.nb_sequences; s++ )
+    {
+        // A third of the sequences cross the wrap-around of the clock, half of them with a slow MCU
+        uint32_t           kind   = ( ( ( s % 3 ) == 0 ) ? 2 : 0 ) + ( s & 1 );
+        rp_bench_result_t* result = &results[kind];
+
+        result->planner_ns += rp_bench_replay( &params, &rp_bench_planner, s, &trace_planner );
+        result->reference_ns += rp_bench_replay( &params, &rp_bench_planner_reference, s, &trace_reference );
+        result->nb_records += trace_reference.nb_records;
+        for( uint8_t i = 0; i < RP_NB_HOOKS; i++ )
+        {
+            result->nb_aborted += trace_reference.stats.task_hook_aborted_nb[i];
+        }
+        result->nb_sequences++;
+        if( rp_bench_compare( s, &trace_planner, &trace_reference ) == false )
+        {
+            result->nb_mismatches++;
+            nb_mismatches++;
+        }
+    }
+
+    printf( "\n clock origin         MCU   sequences   records/seq   aborted/seq   planner us/seq   "
+            "reference us/seq   speedup   mismatches\n" );
+    for( uint32_t kind = 0; kind < 4; kind++ )
+    {
+        const rp_bench_result_t* result = &results[kind];
+
+        if( result->nb_sequences == 0 )
+        {
+            continue;
+        }
+        printf( "%13s   %9s   %9u   %11.0f   %11.1f   %14.1f   %16.1f   %7.2f   %10u\n",
+                ( kind >= 2 ) ? "wrap-around" : "start", ( ( kind & 1 ) != 0 ) ? "slow" : "fast",
+                result->nb_sequences, ( double ) result->nb_records / result->nb_sequences,
+                ( double ) result->nb_aborted / result->nb_sequences, result->planner_ns / 1e3 / result->nb_sequences,
+                result->reference_ns / 1e3 / result->nb_sequences,
+                ( double ) result->reference_ns / ( double ) result->planner_ns, result->nb_mismatches );
+    }
+
+    free( trace_planner.records );
+    free( trace_reference.records );
+    if( nb_mismatches != 0 )
+    {
+        printf( "\nFAILED: %u sequences differ from the reference planner\n", nb_mismatches );
+        return 1;
+    }
+    printf( "\nThe planners gave the same trace for every sequence\n" );
+    return 0;
+}
+
+void rp_hal_critical_section_begin( void )
+{
+}
+
+void rp_hal_critical_section_end( void )
+{
+}
+
+void rp_hal_timer_stop( void )
+{
+    mock.timer_armed = false;
+}
+
+void rp_hal_timer_start( void* rp, uint32_t alarm_in_ms, void ( *callback )( void* context ) )
+{
+    mock.timer_armed    = true;
+    mock.timer_ms       = mock.now_ms + alarm_in_ms;
+    if( mock.slow == true )
+    {
+        mock.timer_ms += rp_bench_hash( mock.timer_ms ) % RP_BENCH_TIMER_LATENCY_MAX_MS;
+    }
+    mock.timer_callback = callback;
+    mock.timer_context  = rp;
+    rp_bench_record( RP_BENCH_EVENT_TIMER_START, 0, alarm_in_ms, 0 );
+}
+
+uint32_t rp_hal_get_time_in_ms( void )
+{
+    return mock.now_ms;
+}
+
+uint32_t rp_hal_get_time_in_100us( void )
+{
+    return mock.now_ms * 10 + 3;
+}
+
+uint32_t rp_hal_get_radio_irq_timestamp_in_100us( void )
+{
+    return mock.now_ms * 10;
+}
+
+uint32_t rp_hal_get_radio_tcxo_startup_delay_ms( void )
+{
+    return 0;
+}
+
+void rp_hal_irq_clear_pending( void )
+{
+}
+
+void smtc_modem_hal_assert_fail( uint8_t* func, uint32_t line )
+{
+    printf( "FAILED: assert in %s line %u\n", func, line );
+    exit( 1 );
+}
+
+void smtc_modem_hal_store_crashlog( uint8_t crashlog[CRASH_LOG_SIZE] )
+{
+    printf( "FAILED: panic in %s\n", crashlog );
+}
+
+void smtc_modem_hal_set_crashlog_status( bool available )
+{
+}
+
+void smtc_modem_hal_reset_mcu( void )
+{
+    exit( 1 );
+}
+
+void smtc_modem_hal_stop_radio_tcxo( void )
+{
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint64_t rp_bench_replay( const rp_bench_params_t* params, const rp_bench_planner_t* ops, uint32_t sequence_id,
+                                 rp_bench_trace_t* out )
+{
+    uint32_t random = params->seed + sequence_id;
+
+    memset( &mock, 0, sizeof( mock ) );
+    mock.now_ms         = ( ( sequence_id % 3 ) == 0 ) ? RP_BENCH_WRAP_AROUND_ORIGIN_MS : 1000 + random * 7919u;
+    mock.slow           = ( sequence_id & 1 ) != 0;
+    out->nb_records     = 0;
+    trace               = out;
+
+    uint64_t start     = rp_bench_ns( );
+    planner_under_test = ops;
+    ops->init( &radio );
+    for( uint8_t i = 0; i < RP_NB_HOOKS; i++ )
+    {
+        ops->hook_init( i, rp_bench_hook_callback, ( void* ) ( uintptr_t ) i );
+    }
+
+    for( uint32_t step = 0; step < params->nb_steps; step++ )
+    {
+        random            = rp_bench_hash( random + 0x9E3779B9u );
+        uint32_t rand_1   = rp_bench_hash( random );
+        uint32_t rand_2   = rp_bench_hash( random + 1 );
+        uint8_t  hook_id  = rand_1 % RP_NB_HOOKS;
+
+        switch( random % 8 )
+        {
+        case 0:
+        case 1:
+        case 2:
+            rp_bench_enqueue( hook_id, rand_2, rp_bench_hash( rand_2 ) );
+            break;
+        case 3:
+            rp_bench_record( RP_BENCH_EVENT_ABORT, hook_id, 0, ops->task_abort( hook_id ) );
+            break;
+        default:
+        {
+            // Move the time to the next interrupt, if it comes soon enough
+            uint32_t target_ms = mock.now_ms + 1 + rand_1 % 300;
+            bool     timer_irq = false;
+            bool     radio_irq = false;
+
+            if( ( mock.timer_armed == true ) && ( ( int32_t )( mock.timer_ms - target_ms ) <= 0 ) )
+            {
+                target_ms = mock.timer_ms;
+                timer_irq = true;
+            }
+            if( ( mock.radio_irq_armed == true ) && ( ( int32_t )( mock.radio_irq_ms - target_ms ) <= 0 ) )
+            {
+                target_ms = mock.radio_irq_ms;
+                timer_irq = false;
+                radio_irq = true;
+            }
+            if( ( int32_t )( target_ms - mock.now_ms ) > 0 )
+            {
+                mock.now_ms = target_ms;
+            }
+            if( timer_irq == true )
+            {
+                mock.timer_armed = false;
+                rp_bench_record( RP_BENCH_EVENT_TIMER_IRQ, 0, 0, 0 );
+                mock.timer_callback( mock.timer_context );
+            }
+            else if( radio_irq == true )
+            {
+                mock.radio_irq_armed = false;
+                rp_bench_record( RP_BENCH_EVENT_RADIO_IRQ, 0, 0, 0 );
+                ops->radio_irq( );
+            }
+            break;
+        }
+        }
+    }
+
+    for( uint8_t i = 0; i < RP_NB_HOOKS; i++ )
+    {
+        const rp_task_t* task = ops->get_task( i );
+
+        rp_bench_record( RP_BENCH_EVENT_FINAL, i, task->state, task->start_time_ms );
+    }
+    out->stats = ops->get_stats( );
+    return rp_bench_ns( ) - start;
+}
+
+static bool rp_bench_compare( uint32_t sequence_id, const rp_bench_trace_t* trace_planner,
+                              const rp_bench_trace_t* trace_reference )
+{
+    uint32_t nb_records = ( trace_planner->nb_records < trace_reference->nb_records ) ? trace_planner->nb_records
+                                                                                       : trace_reference->nb_records;
+
+    for( uint32_t i = 0; i < nb_records; i++ )
+    {
+        const rp_bench_record_t* record           = &trace_planner->records[i];
+        const rp_bench_record_t* record_reference = &trace_reference->records[i];
+
+        if( ( record->time_ms != record_reference->time_ms ) || ( record->event != record_reference->event ) ||
+            ( record->hook_id != record_reference->hook_id ) || ( record->value_1 != record_reference->value_1 ) ||
+            ( record->value_2 != record_reference->value_2 ) )
+        {
+            printf( "Sequence %u, record %u: event %u hook %u at %u ms (%u, %u) instead of event %u hook %u at %u ms "
+                    "(%u, %u)\n",
+                    sequence_id, i, record->event, record->hook_id, record->time_ms, record->value_1, record->value_2,
+                    record_reference->event, record_reference->hook_id, record_reference->time_ms,
+                    record_reference->value_1, record_reference->value_2 );
+            return false;
+        }
+    }
+    if( trace_planner->nb_records != trace_reference->nb_records )
+    {
+        printf( "Sequence %u: %u records instead of %u\n", sequence_id, trace_planner->nb_records,
+                trace_reference->nb_records );
+        return false;
+    }
+    if( memcmp( &trace_planner->stats, &trace_reference->stats, sizeof( rp_stats_t ) ) != 0 )
+    {
+        printf( "Sequence %u: the statistics differ\n", sequence_id );
+        return false;
+    }
+    return true;
+}
+
+static void rp_bench_enqueue( uint8_t id, uint32_t rand_1, uint32_t rand_2 )
+{
+    rp_task_t         task         = { 0 };
+    rp_radio_params_t radio_params = { 0 };
+
+    task.hook_id                    = id;
+    task.state                      = ( ( rand_1 & 1 ) != 0 ) ? RP_TASK_STATE_ASAP : RP_TASK_STATE_SCHEDULE;
+    task.type                       = ( ( rand_1 & 2 ) != 0 ) ? RP_TASK_TYPE_TX_LORA : RP_TASK_TYPE_RX_LORA;
+    task.schedule_task_low_priority = ( ( rand_1 >> 2 ) & 3 ) == 0;
+    task.duration_time_ms           = 1 + ( rand_2 % 200 );
+    task.launch_task_callbacks      = rp_bench_launch;
+    if( ( ( rand_1 >> 4 ) & 7 ) == 0 )
+    {
+        // ASAP task long overdue, or scheduled task in the past
+        task.start_time_ms = mock.now_ms - ( rand_2 >> 12 ) % 5000;
+    }
+    else if( task.state == RP_TASK_STATE_ASAP )
+    {
+        task.start_time_ms = mock.now_ms + ( rand_2 >> 8 ) % 50;
+    }
+    else
+    {
+        task.start_time_ms = mock.now_ms + 1 + ( rand_2 >> 8 ) % 600;
+    }
+    rp_bench_record( RP_BENCH_EVENT_ENQUEUE, id, task.state,
+                     planner_under_test->task_enqueue( &task, &radio_params ) );
+}
+
+static void rp_bench_launch( void* context )
+{
+    uint8_t          id   = planner_under_test->get_radio_task_id( );
+    const rp_task_t* task = planner_under_test->get_task( id );
+
+    rp_bench_record( RP_BENCH_EVENT_LAUNCH, id, task->start_time_ms, task->duration_time_ms );
+    mock.radio_irq_armed = true;
+    mock.radio_irq_ms    = mock.now_ms + 1 + task->duration_time_ms / 2 +
+                        rp_bench_hash( mock.now_ms + id ) % ( task->duration_time_ms + 1 );
+    rp_bench_callback_delay( id );
+}
+
+static void rp_bench_hook_callback( void* context )
+{
+    uint8_t     id = ( uint8_t )( uintptr_t ) context;
+    rp_status_t status;
+    uint32_t    irq_timestamp_ms;
+
+    planner_under_test->get_status( id, &irq_timestamp_ms, &status );
+    rp_bench_record( RP_BENCH_EVENT_CALLBACK, id, status, irq_timestamp_ms );
+    rp_bench_callback_delay( id );
+
+    // Enqueue a task from the callback, as the stack does for its next window
+    uint32_t random = rp_bench_hash( ++mock.nb_callbacks * 31 + id );
+    if( ( random & 3 ) == 0 )
+    {
+        rp_bench_enqueue( id, rp_bench_hash( random ), rp_bench_hash( random + 1 ) );
+    }
+}
+
+static void rp_bench_callback_delay( uint8_t id )
+{
+    if( mock.slow == true )
+    {
+        mock.now_ms += rp_bench_hash( mock.now_ms * 11 + id ) % 4;
+    }
+}
+
+static void rp_bench_record( rp_bench_event_t event, uint8_t hook_id, uint32_t value_1, uint32_t value_2 )
+{
+    if( trace->nb_records < trace->max_records )
+    {
+        trace->records[trace->nb_records] = ( rp_bench_record_t ){
+            .time_ms = mock.now_ms,
+            .event   = ( uint8_t ) event,
+            .hook_id = hook_id,
+            .value_1 = value_1,
+            .value_2 = value_2,
+        };
+    }
+    trace->nb_records++;
+}
+
+static uint32_t rp_bench_hash( uint32_t x )
+{
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static uint64_t rp_bench_ns( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint64_t ) now.tv_sec * 1000000000u + ( uint64_t ) now.tv_nsec;
+}
+
+static bool parse_args( int argc, char** argv, rp_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:e:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_sequences = strtoul( optarg, NULL, 0 );
+            break;
+        case 's':
+            params->nb_steps = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n sequences] [-s steps] [-e seed]\n", argv[0] );
+            return false;
+        }
+    }
+    if( ( params->nb_sequences == 0 ) || ( params->nb_steps == 0 ) )
+    {
+        printf( "The number of sequences and of steps must be at least 1\n" );
+        return false;
+    }
+    return true;
+}
+
+static void rp_bench_init( const ralf_t* ralf )
+{
+    rp_init( &planner, ralf );
+}
+
+static void rp_bench_hook_init( uint8_t id, void ( *callback )( void* context ), void* hook )
+{
+    rp_hook_init( &planner, id, callback, hook );
+}
+
+static rp_hook_status_t rp_bench_task_enqueue( const rp_task_t* task, const rp_radio_params_t* radio_params )
+{
+    return rp_task_enqueue( &planner, task, NULL, 0, radio_params );
+}
+
+static rp_hook_status_t rp_bench_task_abort( uint8_t hook_id )
+{
+    return rp_task_abort( &planner, hook_id );
+}
+
+static void rp_bench_get_status( uint8_t id, uint32_t* irq_timestamp_ms, rp_status_t* status )
+{
+    rp_get_status( &planner, id, irq_timestamp_ms, status );
+}
+
+static void rp_bench_radio_irq( void )
+{
+    rp_radio_irq_callback( &planner );
+}
+
+static const rp_task_t* rp_bench_get_task( uint8_t id )
+{
+    return &planner.tasks[id];
+}
+
+static uint8_t rp_bench_get_radio_task_id( void )
+{
+    return planner.radio_task_id;
+}
+
+static rp_stats_t rp_bench_get_stats( void )
+{
+    return rp_get_stats( &planner );
+}
+
+static void rp_bench_reference_init( const ralf_t* ralf )
+{
+    rp_reference_init( &planner_reference, ralf );
+}
+
+static void rp_bench_reference_hook_init( uint8_t id, void ( *callback )( void* context ), void* hook )
+{
+    rp_reference_hook_init( &planner_reference, id, callback, hook );
+}
+
+static rp_hook_status_t rp_bench_reference_task_enqueue( const rp_task_t* task, const rp_radio_params_t* radio_params )
+{
+    return rp_reference_task_enqueue( &planner_reference, task, NULL, 0, radio_params );
+}
+
+static rp_hook_status_t rp_bench_reference_task_abort( uint8_t hook_id )
+{
+    return rp_reference_task_abort( &planner_reference, hook_id );
+}
+
+static void rp_bench_reference_get_status( uint8_t id, uint32_t* irq_timestamp_ms, rp_status_t* status )
+{
+    rp_reference_get_status( &planner_reference, id, irq_timestamp_ms, status );
+}
+
+static void rp_bench_reference_radio_irq( void )
+{
+    rp_reference_radio_irq_callback( &planner_reference );
+}
+
+static const rp_task_t* rp_bench_reference_get_task( uint8_t id )
+{
+    return &planner_reference.tasks[id];
+}
+
+static uint8_t rp_bench_reference_get_radio_task_id( void )
+{
+    return planner_reference.radio_task_id;
+}
+
+static rp_stats_t rp_bench_reference_get_stats( void )
+{
+    return rp_reference_get_stats( &planner_reference );
+}
+
+static ral_status_t rp_bench_radio_set_sleep( const void* context, const bool retain_config )
+{
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t rp_bench_radio_set_standby( const void* context, ral_standby_cfg_t standby_cfg )
+{
+    // The radio is stopped, its pending interrupt is lost
+    mock.radio_irq_armed = false;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t rp_bench_radio_clear_irq_status( const void* context, const ral_irq_t irq )
+{
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t rp_bench_radio_get_and_clear_irq_status( const void* context, ral_irq_t* irq )
+{
+    const rp_task_t* task = planner_under_test->get_task( planner_under_test->get_radio_task_id( ) );
+
+    *irq = ( task->type == RP_TASK_TYPE_TX_LORA ) ? RAL_IRQ_TX_DONE : RAL_IRQ_RX_TIMEOUT;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t rp_bench_radio_get_tx_consumption_in_ua( const void* context, const int8_t output_pwr_in_dbm,
+                                                             const uint32_t rf_freq_in_hz,
+                                                             uint32_t*      pwr_consumption_in_ua )
+{
+    *pwr_consumption_in_ua = 1;
+    return RAL_STATUS_OK;
+}
+
+static ral_status_t rp_bench_radio_get_lora_rx_consumption_in_ua( const void* context, const ral_lora_bw_t bw,
+                                                                  const bool rx_boosted,
+                                                                  uint32_t*  pwr_consumption_in_ua )
+{
+    *pwr_consumption_in_ua = 1;
+    return RAL_STATUS_OK;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
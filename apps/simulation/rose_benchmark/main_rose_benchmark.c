@@ -0,0 +1,521 @@
+/**
+ * @file      main_rose_benchmark.c
+ *
+ * @brief     Measures the frames per second of the ROSE stream encoder over window lengths and redundancy rates
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "rose.h"
+#include "rose_defs.h"
+#include "rose_reference.h"
+#include "rose_window_reference.h"
+#include "smtc_modem_services_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define ROSE_BENCH_NB_FRAMES_DEFAULT 2000
+#define ROSE_BENCH_FRAME_SIZE_DEFAULT 222
+#define ROSE_BENCH_RECORD_SIZE_DEFAULT 40
+#define ROSE_BENCH_UNIT_SIZE_DEFAULT 1
+#define ROSE_BENCH_NB_REPLAYS_DEFAULT 60
+
+/**
+ * @brief Steps of a replay, each adding a record, getting a frame or updating the window length
+ */
+#define ROSE_BENCH_REPLAY_NB_STEPS 5000
+
+/**
+ * @brief Pending octets above which no record is added during a replay
+ *
+ * With a window of up to ROSE_DEFAULT_WL octets, the pending records then fit in both encoders whatever the window
+ * length, the reference encoder keeping the end of its fifo for the rvec of the window.
+ */
+#define ROSE_BENCH_REPLAY_MAX_PENDING 300
+
+/**
+ * @brief Window lengths and redundancy rates of the benchmark
+ */
+static const uint16_t rose_bench_wls[] = { 64, 128, 256, 512 };
+static const uint8_t  rose_bench_rrs[] = { 110, 150, 200 };
+
+/**
+ * @brief Unit sizes of the replays, and window lengths the server asks for
+ */
+static const uint8_t  rose_bench_replay_unit_sizes[] = { 1, 1, 2, 4, 8 };
+static const uint16_t rose_bench_replay_wls[]        = { 16, 64, 128, 256, 512, 300, 100 };
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct rose_bench_params_s
+{
+    uint32_t nb_frames;
+    uint8_t  frame_size;
+    uint8_t  record_size;
+    uint8_t  unit_size;
+    uint32_t seed;
+    uint32_t nb_replays;
+} rose_bench_params_t;
+
+/**
+ * @brief Results of a setting
+ */
+typedef struct rose_bench_result_s
+{
+    uint64_t nb_units;      //!< Redundancy units sent
+    uint64_t get_data_ns;   //!< Time spent in ROSE_getData()
+    uint64_t reference_ns;  //!< Time spent in the reference redundancy generator
+    uint32_t nb_errors;     //!< Frames whose redundancy differs from the reference
+} rose_bench_result_t;
+
+/**
+ * @brief Results of the replays against the reference encoder
+ */
+typedef struct rose_bench_replay_result_s
+{
+    uint32_t nb_records;
+    uint32_t nb_frames;
+    uint32_t nb_commands;  //!< Downlink commands updating or acknowledging the window length
+    uint32_t nb_errors;    //!< Replays in which the encoders differ
+} rose_bench_replay_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static rose_t           rose;
+static rose_t           rose_before;
+static rose_reference_t rose_reference;
+static uint32_t         random_state;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Stream nb_frames frames with a window length and a redundancy rate, and check their redundancy
+ *
+ * @param [in]  params Command line parameters
+ * @param [in]  wl     Window length, in units
+ * @param [in]  rr     Redundancy rate, in percent
+ * @param [out] result Results
+ *
+ * @return false if the stream cannot be set up
+ */
+static bool rose_bench_run( const rose_bench_params_t* params, uint16_t wl, uint8_t rr, rose_bench_result_t* result );
+
+/**
+ * @brief Replay a random stream with the encoder and with the reference encoder, sliding its window with memmove()
+ *
+ * Records, frames and window length updates are drawn at random. The return codes, the frames and the state of the
+ * stream must be the same after each step.
+ *
+ * @param [in]    params Command line parameters
+ * @param [in]    replay Replay number, which selects the unit size, the window length and the flags
+ * @param [inout] result Results
+ *
+ * @return false if the encoders differ
+ */
+static bool rose_bench_replay( const rose_bench_params_t* params, uint32_t replay, rose_bench_replay_result_t* result );
+
+/**
+ * @brief Current time, in nanoseconds
+ */
+static uint64_t rose_bench_ns( void );
+
+/**
+ * @brief Xorshift pseudo-random generator
+ */
+static uint32_t rose_bench_rand( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, rose_bench_params_t* params );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    rose_bench_params_t params = {
+        .nb_frames   = ROSE_BENCH_NB_FRAMES_DEFAULT,
+        .frame_size  = ROSE_BENCH_FRAME_SIZE_DEFAULT,
+        .record_size = ROSE_BENCH_RECORD_SIZE_DEFAULT,
+        .unit_size   = ROSE_BENCH_UNIT_SIZE_DEFAULT,
+        .seed        = 1,
+        .nb_replays  = ROSE_BENCH_NB_REPLAYS_DEFAULT,
+    };
+    rose_bench_replay_result_t replay_result = { 0 };
+    uint32_t                   nb_errors     = 0;
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+
+    printf( "ROSE benchmark: %u-byte units, %u-byte frames, a %u-byte record per frame, %u frames per setting\n\n",
+            params.unit_size, params.frame_size, params.record_size, params.nb_frames );
+    printf( "   WL   RR   units/frame   getData frames/s   reference frames/s   speedup\n" );
+    for( size_t i = 0; i < sizeof( rose_bench_wls ) / sizeof( rose_bench_wls[0] ); i++ )
+    {
+        for( size_t j = 0; j < sizeof( rose_bench_rrs ); j++ )
+        {
+            rose_bench_result_t result;
+
+            if( rose_bench_run( &params, rose_bench_wls[i], rose_bench_rrs[j], &result ) == false )
+            {
+                printf( "%5u  %3u   window and record do not fit in ROSE_RING_SIZE (%u bytes)\n", rose_bench_wls[i],
+                        rose_bench_rrs[j], ROSE_RING_SIZE );
+                continue;
+            }
+            printf( "%5u  %3u   %11.1f   %16.0f   %18.0f   %7.1f\n", rose_bench_wls[i], rose_bench_rrs[j],
+                    ( double ) result.nb_units / params.nb_frames,
+                    params.nb_frames * 1e9 / ( double ) result.get_data_ns,
+                    params.nb_frames * 1e9 / ( double ) result.reference_ns,
+                    ( double ) result.reference_ns / ( double ) result.get_data_ns );
+            nb_errors += result.nb_errors;
+        }
+    }
+
+    for( uint32_t r = 0; r < params.nb_replays; r++ )
+    {
+        if( rose_bench_replay( &params, r, &replay_result ) == false )
+        {
+            replay_result.nb_errors++;
+        }
+    }
+    printf( "\nReplays against the memmove() window: %u streams, %u records, %u frames, %u window length commands\n",
+            params.nb_replays, replay_result.nb_records, replay_result.nb_frames, replay_result.nb_commands );
+
+    if( ( nb_errors != 0 ) || ( replay_result.nb_errors != 0 ) )
+    {
+        printf( "\nFAILED: %u frames differ from the reference redundancy, %u streams from the reference encoder\n",
+                nb_errors, replay_result.nb_errors );
+        return 1;
+    }
+    printf( "\nAll the redundancy units and the replayed streams match the reference\n" );
+    return 0;
+}
+
+void smtc_modem_services_aes_encrypt( const uint8_t* raw_buffer, uint16_t size, uint8_t aes_ctr_nonce[14],
+                                      uint8_t* enc_buffer )
+{
+    // The records are not enciphered by the benchmark
+    memmove( enc_buffer, raw_buffer, size );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool rose_bench_run( const rose_bench_params_t* params, uint16_t wl, uint8_t rr, rose_bench_result_t* result )
+{
+    uint8_t  record[255];
+    uint8_t  frame[255];
+    uint8_t  redundancy[255];
+    uint32_t fcntup = 0;
+
+    memset( result, 0, sizeof( rose_bench_result_t ) );
+    // Keep room for a record after the window
+    if( ROSE_init( &rose, wl, params->record_size + 2 + params->unit_size, rr, params->unit_size ) != ROSE_OK )
+    {
+        return false;
+    }
+    random_state = params->seed;
+
+    for( uint32_t f = 0; f < params->nb_frames; f++ )
+    {
+        if( ROSE_getFree( &rose ) >= params->record_size + 2 + params->unit_size )
+        {
+            for( uint8_t i = 0; i < params->record_size; i++ )
+            {
+                record[i] = ( uint8_t ) rose_bench_rand( );
+            }
+            ROSE_addRecord( &rose, record, params->record_size );
+        }
+
+        uint8_t size = params->frame_size;
+        rose_before  = rose;
+
+        uint64_t start = rose_bench_ns( );
+        ROSE_getData( &rose, fcntup, frame, &size );
+        result->get_data_ns += rose_bench_ns( ) - start;
+
+        if( size >= SDATA_HDR_LEN )
+        {
+            uint8_t  pctx = ( frame[SDATA_HDR_OFF] & SDATA_PCTX_FLAG ) ? SDATA_PCTX_LEN : 0;
+            uint8_t  sysc = frame[SDATA_HDR_OFF] & ~SDATA_PCTX_FLAG;
+            uint8_t  redc = ( size - SDATA_HDR_LEN - pctx ) / params->unit_size - sysc;
+            uint8_t* red  = &frame[SDATA_HDR_LEN + sysc * params->unit_size];
+
+            start = rose_bench_ns( );
+            rose_reference_redundancy( &rose_before, fcntup, redundancy, redc );
+            result->reference_ns += rose_bench_ns( ) - start;
+
+            if( memcmp( red, redundancy, redc * params->unit_size ) != 0 )
+            {
+                result->nb_errors++;
+            }
+            result->nb_units += redc;
+        }
+        fcntup++;
+    }
+    return true;
+}
+
+static bool rose_bench_replay( const rose_bench_params_t* params, uint32_t replay, rose_bench_replay_result_t* result )
+{
+    uint8_t  unit_size = rose_bench_replay_unit_sizes[replay % sizeof( rose_bench_replay_unit_sizes )];
+    uint16_t wl        = ( ( ( replay % 3 ) != 0 ) ? ROSE_DEFAULT_WL : ROSE_DEFAULT_WL / 2 ) / unit_size;
+    uint8_t  rr        = 110 + ( replay % 4 ) * 20;
+    uint8_t  flags     = 0;
+    uint8_t  record[255];
+    uint8_t  frame[255];
+    uint8_t  frame_reference[255];
+    uint32_t fcntup;
+
+    if( ( ROSE_init( &rose, wl, ROSE_DEFAULT_MINFREE, rr, unit_size ) != ROSE_OK ) ||
+        ( ROSE_reference_init( &rose_reference, wl, ROSE_DEFAULT_MINFREE, rr, unit_size ) != ROSE_OK ) )
+    {
+        printf( "Replay %u: the encoders cannot be set up\n", replay );
+        return false;
+    }
+    if( ( replay % 2 ) != 0 )
+    {
+        ROSE_enable_encryption( &rose );
+        ROSE_reference_enable_encryption( &rose_reference );
+    }
+    flags |= ( ( replay % 3 ) == 0 ) ? ROSE_FILLREDC : 0;
+    flags |= ( ( replay % 4 ) == 1 ) ? ROSE_LOW_LATENCY : 0;
+    flags |= ( ( replay % 5 ) == 2 ) ? ROSE_DROP_OVR : 0;
+    rose.flags |= flags;
+    rose_reference.flags |= flags;
+
+    random_state = ( params->seed ^ ( replay * 0x9E3779B9u ) ) | 1;
+    fcntup       = rose_bench_rand( ) % 1000;
+
+    for( uint32_t step = 0; step < ROSE_BENCH_REPLAY_NB_STEPS; step++ )
+    {
+        uint32_t    op = rose_bench_rand( ) % 200;
+        int         rc;
+        int         rc_reference;
+        const char* error = NULL;
+
+        if( op < 90 )
+        {
+            uint16_t nbytes = 1 + rose_bench_rand( ) % 120;
+
+            // The free space of the reference depends on the rvec length of its window, only add what fits in both
+            if( ( ROSE_getPending( &rose ) >= ROSE_BENCH_REPLAY_MAX_PENDING ) ||
+                ( ROSE_getFree( &rose ) < nbytes + 2 + unit_size ) ||
+                ( ROSE_reference_getFree( &rose_reference ) < nbytes + 2 + unit_size ) )
+            {
+                continue;
+            }
+            for( uint16_t i = 0; i < nbytes; i++ )
+            {
+                record[i] = ( uint8_t ) rose_bench_rand( );
+            }
+            rc           = ROSE_addRecord( &rose, record, nbytes );
+            rc_reference = ROSE_reference_addRecord( &rose_reference, record, nbytes );
+            result->nb_records++;
+            if( rc != rc_reference )
+            {
+                error = "ROSE_addRecord() return code";
+            }
+        }
+        else if( op < 199 )
+        {
+            uint8_t size           = 20 + rose_bench_rand( ) % 222;
+            uint8_t size_reference = size;
+
+            rc           = ROSE_getData( &rose, fcntup, frame, &size );
+            rc_reference = ROSE_reference_getData( &rose_reference, fcntup, frame_reference, &size_reference );
+            fcntup++;
+            result->nb_frames++;
+            if( ( rc != rc_reference ) || ( size != size_reference ) ||
+                ( memcmp( frame, frame_reference, size ) != 0 ) )
+            {
+                error = "ROSE_getData() frame";
+            }
+        }
+        else if( rose.unsent == rose.wl )
+        {
+            // The server updates the window length once the window is full, then it acknowledges it
+            uint8_t  cmd[4];
+            uint16_t new_wl = rose_bench_replay_wls[rose_bench_rand( ) % sizeof( rose_bench_replay_wls ) /
+                                                    sizeof( rose_bench_replay_wls[0] )];
+
+            // Keep the window within ROSE_DEFAULT_WL octets, the encoders refusing larger ones in different cases
+            if( ROSE_decWL( ROSE_encWL( new_wl ) ) * unit_size > ROSE_DEFAULT_WL )
+            {
+                new_wl = ROSE_DEFAULT_WL / unit_size;
+            }
+
+            cmd[0] = SCMD_FLAGS_SCMD;
+            cmd[0] |= ( ( rose_bench_rand( ) % 2 ) == 0 ) ? SCMD_FLAGS_UPDWL : 0;
+            cmd[0] |= ( ( rose_bench_rand( ) % 4 ) == 0 ) ? SCMD_FLAGS_ACKWL : 0;
+            cmd[0] |= ( ( rose_bench_rand( ) % 5 ) == 0 ) ? SCMD_FLAGS_SINFO : 0;
+            cmd[1] = ROSE_encWL( new_wl );
+            cmd[2] = 100 + rose_bench_rand( ) % 100;
+            cmd[3] = rose_bench_rand( ) % 10;
+            rc           = ROSE_processDnFrame( &rose, cmd, sizeof( cmd ) );
+            rc_reference = ROSE_reference_processDnFrame( &rose_reference, cmd, sizeof( cmd ) );
+            if( ( rc != rc_reference ) || ( rose.wl != rose_reference.wl ) )
+            {
+                error = "ROSE_processDnFrame() window length update";
+            }
+
+            cmd[0]       = SCMD_FLAGS_SCMD | SCMD_FLAGS_ACKWL;
+            cmd[1]       = ROSE_encWL( rose.wl );
+            rc           = ROSE_processDnFrame( &rose, cmd, sizeof( cmd ) );
+            rc_reference = ROSE_reference_processDnFrame( &rose_reference, cmd, sizeof( cmd ) );
+            result->nb_commands += 2;
+            if( ( rc != rc_reference ) || ( rose.wl != rose_reference.wl ) )
+            {
+                error = "ROSE_processDnFrame() window length acknowledgement";
+            }
+        }
+
+        if( ( error == NULL ) && ( ( ROSE_getPending( &rose ) != ROSE_reference_getPending( &rose_reference ) ) ||
+                                   ( ROSE_getStatus( &rose ) != ROSE_reference_getStatus( &rose_reference ) ) ||
+                                   ( ROSE_getSoff( &rose ) != ROSE_reference_getSoff( &rose_reference ) ) ) )
+        {
+            error = "stream state";
+        }
+        if( error != NULL )
+        {
+            printf( "Replay %u, step %u: the %s differs from the reference encoder\n", replay, step, error );
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint64_t rose_bench_ns( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint64_t ) now.tv_sec * 1000000000u + ( uint64_t ) now.tv_nsec;
+}
+
+static uint32_t rose_bench_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, rose_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:s:r:u:e:p:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_frames = strtoul( optarg, NULL, 0 );
+            break;
+        case 's':
+            params->frame_size = strtoul( optarg, NULL, 0 );
+            break;
+        case 'r':
+            params->record_size = strtoul( optarg, NULL, 0 );
+            break;
+        case 'u':
+            params->unit_size = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        case 'p':
+            params->nb_replays = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n frames] [-s frame_size] [-r record_size] [-u unit_size] [-e seed] [-p replays]\n",
+                    argv[0] );
+            return false;
+        }
+    }
+    if( params->nb_frames == 0 || params->seed == 0 )
+    {
+        printf( "The number of frames and the seed must be at least 1\n" );
+        return false;
+    }
+    if( params->frame_size < SDATA_HDR_LEN + SDATA_PCTX_LEN + params->unit_size || params->record_size == 0 ||
+        params->record_size > 253 )
+    {
+        printf( "The frame must hold a unit and the record size must be 1 to 253 bytes\n" );
+        return false;
+    }
+    if( params->unit_size != 1 && params->unit_size != 2 && params->unit_size != 4 && params->unit_size != 8 )
+    {
+        printf( "The unit size must be 1, 2, 4 or 8 bytes\n" );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
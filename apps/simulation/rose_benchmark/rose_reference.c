@@ -0,0 +1,109 @@
+/**
+ * @file      rose_reference.c
+ *
+ * @brief     Byte-wise ROSE redundancy generator the word-wise one is checked against
+ *
+ * This is buildRedundancyOctets() of smtc_modem_core/smtc_modem_services/src/stream/rose.c before its coefficients
+ * were bit-scanned and its units XORed in 32-bit words. It works on a copy of the stream state.
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+
+#include "rose_reference.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Pseudo random number generator prbs23
+ */
+static uint32_t prbs23( uint32_t x );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void rose_reference_redundancy( const rose_t* ROSE, uint32_t fcntup, uint8_t* redbuf, uint8_t n_units )
+{
+    uint32_t wl  = ROSE->wl;
+    uint32_t wlx = wl + ( ( ( wl - 1 ) & wl ) == 0 );  // fixup if wl=2^i => wlx = wl+1
+    uint8_t  rvec[( ROSE_RING_SIZE + 7 ) / 8];
+    memset( redbuf, 0, n_units * ROSE->unitsz );
+
+    for( int i = 0; i < n_units; i++ )
+    {
+        uint32_t nbCoeff = 0;
+        uint32_t x       = 1 + ( 1001 * ( fcntup ^ ( i << 8 ) ) );
+        memset( rvec, 0, sizeof( rvec ) );
+        while( nbCoeff < wl / 2 )
+        {  // 50% 1-bits
+            uint32_t r = 1 << 16;
+            while( r >= wl )
+            {  // only relevant for m=1
+                x = prbs23( x );
+                r = x % wlx;
+            }
+            int ri = r >> 3, rb = 1 << ( r & 7 );
+            if( ( rvec[ri] & rb ) == 0 )
+            {
+                nbCoeff += 1;
+                rvec[ri] |= rb;
+                const uint8_t* src = &ROSE->fifo[( ROSE->head + r * ROSE->unitsz ) & ( ROSE_RING_SIZE - 1 )];
+                for( int j = 0; j < ROSE->unitsz; j++ )
+                {
+                    redbuf[i * ROSE->unitsz + j] ^= src[j];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint32_t prbs23( uint32_t x )
+{
+    uint32_t b0 = x & 1;
+    uint32_t b1 = ( x & 0x20 ) >> 5;
+    return ( x >> 1 ) + ( ( b0 ^ b1 ) << 22 );
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,160 @@
+/**
+ * @file      rose_window_reference.h
+ *
+ * @brief     ROSE encoder sliding its window with memmove(), the circular window of the ROSE encoder is checked against
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef ROSE_WINDOW_REFERENCE_H
+#define ROSE_WINDOW_REFERENCE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+
+#include "rose.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/**
+ * @brief Size of the reference fifo: the window, the free buffer, then the rvec for wl=512
+ */
+#define ROSE_REFERENCE_FIFO_SIZE ( ROSE_DEFAULT_WL + ROSE_DEFAULT_MINFREE + ROSE_DEFAULT_WL / 8 )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Stream state before the circular window, the window always starting at the beginning of fifo
+ */
+typedef struct rose_reference_s
+{
+    uint8_t  flags;
+    uint8_t  pctxintv;  // include protocol context every Nth frame
+    uint8_t  framecnt;  // frame counter to include protocol context
+    uint8_t  rr;        // current redundancy rate
+    uint32_t soff;      // stream offset label (of unsent position)
+    int      redcnt;    // how many redundancy octets have been sent over redundancy pool
+    uint16_t wl;        // window length
+    uint16_t unsent;    // start of unsent systematic data
+    uint16_t fill;      // start of free buffer space
+    uint8_t  unitsz;
+    uint8_t  fifo[ROSE_REFERENCE_FIFO_SIZE];
+} rose_reference_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Same as @ref ROSE_init for the reference encoder
+ */
+int ROSE_reference_init( rose_reference_t* ROSE, uint16_t windowLen, uint16_t minfree, uint8_t redundancyRate,
+                         uint8_t unitsz );
+
+/**
+ * @brief Same as @ref ROSE_enable_encryption for the reference encoder
+ */
+int ROSE_reference_enable_encryption( rose_reference_t* ROSE );
+
+/**
+ * @brief Same as @ref ROSE_getData for the reference encoder
+ */
+int ROSE_reference_getData( rose_reference_t* ROSE, uint32_t fcntup, uint8_t* frmpayload, uint8_t* transferSize );
+
+/**
+ * @brief Same as @ref ROSE_cipher for the reference encoder
+ */
+void ROSE_reference_cipher( rose_reference_t* ROSE, uint32_t soff, uint8_t* data, uint8_t len );
+
+/**
+ * @brief Same as @ref ROSE_processDnFrame for the reference encoder
+ */
+int ROSE_reference_processDnFrame( rose_reference_t* ROSE, const uint8_t* frmpayload, uint8_t flen );
+
+/**
+ * @brief Same as @ref ROSE_addRecord for the reference encoder
+ */
+int ROSE_reference_addRecord( rose_reference_t* ROSE, const uint8_t* data, uint16_t nbytes );
+
+/**
+ * @brief Same as @ref ROSE_encWL for the reference encoder
+ */
+uint8_t ROSE_reference_encWL( uint16_t wl );
+
+/**
+ * @brief Same as @ref ROSE_decWL for the reference encoder
+ */
+uint16_t ROSE_reference_decWL( uint8_t wlcode );
+
+/**
+ * @brief Same as @ref ROSE_getPending for the reference encoder
+ */
+uint16_t ROSE_reference_getPending( rose_reference_t* ROSE );
+
+/**
+ * @brief Same as @ref ROSE_getFree for the reference encoder
+ */
+uint16_t ROSE_reference_getFree( rose_reference_t* ROSE );
+
+/**
+ * @brief Same as @ref ROSE_getStatus for the reference encoder
+ */
+int ROSE_reference_getStatus( rose_reference_t* ROSE );
+
+/**
+ * @brief Same as @ref ROSE_getSoff for the reference encoder
+ */
+uint32_t ROSE_reference_getSoff( rose_reference_t* ROSE );
+
+/**
+ * @brief Same as @ref ROSE_rvec_len for the reference encoder
+ */
+int ROSE_reference_rvec_len( rose_reference_t* ROSE );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // ROSE_WINDOW_REFERENCE_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,780 @@
+/**
+ * @file      main_tracker_log_benchmark.c
+ *
+ * @brief     Reads the scans of the tracker internal log through its index, and checks them against the linear walk
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "smtc_hal.h"
+#include "tracker_utility.h"
+#include "tracker_log_mock.h"
+#include "tracker_log_reference.h"
+#include "lr1110_trk1xks_board.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define TRACKER_LOG_BENCH_NB_SCANS_DEFAULT 2000
+#define TRACKER_LOG_BENCH_NB_LOOKUPS_DEFAULT 2000
+#define TRACKER_LOG_BENCH_NB_CUTS_DEFAULT 1000
+#define TRACKER_LOG_BENCH_SEED_DEFAULT 1
+
+/**
+ * @brief Internal log context pages, FLASH_USER_INTERNAL_LOG_CTX_START_PAGE and FLASH_USER_INTERNAL_LOG_CTX_SPARE_PAGE
+ * of tracker_utility.c
+ */
+#define TRACKER_LOG_BENCH_CTX_PAGE 195
+#define TRACKER_LOG_BENCH_CTX_SPARE_PAGE 201
+
+/**
+ * @brief Size of a stored scan at most, INTERNAL_LOG_SCAN_BUFFER of tracker_utility.c
+ */
+#define TRACKER_LOG_BENCH_SCAN_BUFFER 256
+
+/**
+ * @brief Flash operations before a power cut at any operation, at most
+ */
+#define TRACKER_LOG_BENCH_CUT_OPERATIONS 64
+
+/**
+ * @brief Flash operations of a context page change: the three double words of the first record of the other page,
+ * then the erase of the full page
+ */
+#define TRACKER_LOG_BENCH_PAGE_CHANGE_OPERATIONS 4
+
+/**
+ * @brief Size of the text of a scan, INTERNAL_LOG_BUFFER_LEN of tracker_utility.c
+ */
+#define TRACKER_LOG_BENCH_SCAN_TEXT_SIZE 3000
+
+/**
+ * @brief Size of the answer of the read internal log command, as sent over BLE
+ */
+#define TRACKER_LOG_BENCH_ANSWER_SIZE 255
+
+/**
+ * @brief Size of the NAV messages of a GNSS scan
+ */
+#define TRACKER_LOG_BENCH_NAV_SIZE_MIN 20
+#define TRACKER_LOG_BENCH_NAV_SIZE_MAX 40
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Command line parameters
+ */
+typedef struct tracker_log_bench_params_s
+{
+    uint32_t nb_scans;
+    uint32_t nb_lookups;
+    uint32_t nb_cuts;
+    uint32_t seed;
+} tracker_log_bench_params_t;
+
+/**
+ * @brief Kinds of power cut
+ */
+typedef enum tracker_log_bench_cut_e
+{
+    TRACKER_LOG_BENCH_CUT_ANY,          //!< At any flash operation
+    TRACKER_LOG_BENCH_CUT_PAGE_CHANGE,  //!< At a change of internal log context page
+    TRACKER_LOG_BENCH_CUT_SIZE,
+} tracker_log_bench_cut_t;
+
+/**
+ * @brief Results of a kind of power cut
+ */
+typedef struct tracker_log_bench_cut_result_s
+{
+    uint32_t nb_cuts;        //!< Power cuts
+    uint32_t nb_cut_erases;  //!< Power cuts during a page erase
+    uint32_t nb_scans_lost;  //!< Cuts restoring the internal log without the scan being stored
+    uint32_t nb_scans_kept;  //!< Cuts restoring the internal log with the scan being stored
+    uint32_t nb_errors;      //!< Cuts restoring another internal log, or losing or changing a stored scan
+} tracker_log_bench_cut_result_t;
+
+/**
+ * @brief Results of a kind of lookup
+ */
+typedef struct tracker_log_bench_result_s
+{
+    uint32_t nb_lookups;      //!< Scans read
+    uint32_t nb_reads;        //!< Flash reads through the index
+    uint64_t nb_bytes_read;   //!< Bytes read through the index
+    uint32_t nb_walk_reads;   //!< Flash reads of the linear walk
+    uint64_t nb_walk_bytes;   //!< Bytes read by the linear walk
+    uint32_t nb_differences;  //!< Scans whose text differs from the linear walk one
+} tracker_log_bench_result_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+extern tracker_ctx_t tracker_ctx;
+
+// State of the read internal log command of tracker_utility.c
+extern uint32_t internal_log_scan_index;
+extern uint16_t internal_log_buffer_len;
+extern bool     internal_log_tracker_settings_sent;
+
+static uint8_t  nav_buffers[GNSS_SCAN_GROUP_SIZE_MAX][TRACKER_LOG_BENCH_NAV_SIZE_MAX];
+static uint32_t scan_timestamp = 1640995200;
+static uint32_t random_state;
+
+// Hashes of the stored scans, by scan number, checked after each power cut
+static uint32_t scan_hashes[UINT16_MAX + 1];
+
+static tracker_log_mock_power_cut_t power_cut;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Start the tracker: restore the internal log context, or create a new one, as main_tracker_application.c
+ */
+static void tracker_log_bench_boot( void );
+
+/**
+ * @brief Store a random Wi-Fi or GNSS scan in the internal log
+ */
+static void tracker_log_bench_store_scan( void );
+
+/**
+ * @brief Read a scan with the read internal log command, from its first answer to its last one
+ *
+ * @param [in]  scan_number Number of the scan
+ * @param [out] text        Text of the scan
+ * @param [out] text_len    Length of the text
+ *
+ * @return false if the command answers nothing, as past the end of the internal log
+ */
+static bool tracker_log_bench_read_scan( const uint16_t scan_number, char* text, uint16_t* text_len );
+
+/**
+ * @brief Read a scan through the index and with the linear walk, and compare the texts
+ *
+ * @param [in]     scan_number Number of the scan
+ * @param [in,out] result      Results of the kind of lookup
+ */
+static void tracker_log_bench_lookup( const uint16_t scan_number, tracker_log_bench_result_t* result );
+
+/**
+ * @brief Ask for the scans past the end of the internal log, which must not be found
+ *
+ * @param [in,out] result Results of the lookups
+ */
+static void tracker_log_bench_lookup_past_the_end( tracker_log_bench_result_t* result );
+
+/**
+ * @brief Store scans and cut the power during some of the stores, then check the internal log restored after each cut
+ *
+ * @param [in]  nb_cuts   Power cuts
+ * @param [out] result    Results of each kind of power cut
+ * @param [out] nb_scans  Scans stored
+ * @param [out] nb_resets Erases of the internal log when the flash is full
+ */
+static void tracker_log_bench_run_power_cuts( const uint32_t nb_cuts, tracker_log_bench_cut_result_t* result,
+                                              uint32_t* nb_scans, uint32_t* nb_resets );
+
+/**
+ * @brief Check the internal log restored after a power cut during the store of a scan: the scan is either lost or
+ * stored, and the scans stored before read back unchanged
+ *
+ * @param [in]     nb_scan            Scans before the cut store
+ * @param [in]     flash_addr_current Write address before the cut store
+ * @param [in,out] result             Results of the kind of power cut
+ */
+static void tracker_log_bench_check_power_cut( const uint16_t nb_scan, const uint32_t flash_addr_current,
+                                               tracker_log_bench_cut_result_t* result );
+
+/**
+ * @brief Read the scans of the internal log from a given one, check their numbers and the hashes of the known ones,
+ * and keep the hashes of the others
+ *
+ * @param [in] first_scan     Number of the first scan read
+ * @param [in] nb_known_scans Scans whose hash is known
+ *
+ * @return true if every scan reads back, with its number and its hash, before the write address
+ */
+static bool tracker_log_bench_check_scans( const uint16_t first_scan, const uint16_t nb_known_scans );
+
+/**
+ * @brief FNV-1a hash of a scan
+ *
+ * @param [in] scan_buf Scan, as read by tracker_internal_log_iterator_next()
+ *
+ * @return Hash of the scan
+ */
+static uint32_t tracker_log_bench_hash( const uint8_t* scan_buf );
+
+/**
+ * @brief Print the results of a kind of lookup
+ *
+ * @param [in] name   Kind of lookup
+ * @param [in] result Results of the kind of lookup
+ */
+static void tracker_log_bench_print( const char* name, const tracker_log_bench_result_t* result );
+
+/**
+ * @brief Xorshift pseudo-random generator
+ */
+static uint32_t tracker_log_bench_rand( void );
+
+/**
+ * @brief Parse the command line
+ *
+ * @param [in]  argc   Number of arguments
+ * @param [in]  argv   Arguments
+ * @param [out] params Command line parameters
+ *
+ * @return false if the program must exit
+ */
+static bool parse_args( int argc, char** argv, tracker_log_bench_params_t* params );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+int main( int argc, char** argv )
+{
+    tracker_log_bench_params_t params = {
+        .nb_scans   = TRACKER_LOG_BENCH_NB_SCANS_DEFAULT,
+        .nb_lookups = TRACKER_LOG_BENCH_NB_LOOKUPS_DEFAULT,
+        .nb_cuts    = TRACKER_LOG_BENCH_NB_CUTS_DEFAULT,
+        .seed       = TRACKER_LOG_BENCH_SEED_DEFAULT,
+    };
+    tracker_log_bench_result_t sequential   = { 0 };
+    tracker_log_bench_result_t random_order = { 0 };
+    tracker_log_bench_result_t after_boot   = { 0 };
+    tracker_log_bench_result_t past_the_end = { 0 };
+    tracker_log_bench_cut_result_t cut_result[TRACKER_LOG_BENCH_CUT_SIZE] = { 0 };
+    uint32_t                       nb_cut_scans                           = 0;
+    uint32_t                       nb_resets                              = 0;
+    uint32_t                       nb_cut_errors                          = 0;
+
+    if( parse_args( argc, argv, &params ) == false )
+    {
+        return 1;
+    }
+    random_state = params.seed;
+
+    tracker_log_mock_init( FLASH_USER_START_PAGE );
+    tracker_ctx.gnss_antenna_sel = GNSS_PCB_ANTENNA;
+    tracker_log_bench_boot( );
+
+    for( uint32_t i = 0; i < params.nb_scans; i++ )
+    {
+        tracker_log_bench_store_scan( );
+    }
+
+    printf( "Tracker internal log benchmark: %u scans stored in %u bytes of flash, %u random lookups, seed %u\n\n",
+            tracker_ctx.nb_scan, tracker_ctx.flash_addr_current - tracker_ctx.flash_addr_start, params.nb_lookups,
+            params.seed );
+
+    for( uint16_t scan_number = 1; scan_number <= tracker_ctx.nb_scan; scan_number++ )
+    {
+        tracker_log_bench_lookup( scan_number, &sequential );
+    }
+    for( uint32_t i = 0; i < params.nb_lookups; i++ )
+    {
+        tracker_log_bench_lookup( 1 + ( tracker_log_bench_rand( ) % tracker_ctx.nb_scan ), &random_order );
+    }
+    tracker_log_bench_lookup_past_the_end( &past_the_end );
+
+    // The index is rebuilt at boot
+    const tracker_log_mock_stats_t boot_start = tracker_log_mock_get_stats( );
+
+    tracker_log_bench_boot( );
+
+    const tracker_log_mock_stats_t boot_end = tracker_log_mock_get_stats( );
+
+    for( uint32_t i = 0; i < params.nb_lookups; i++ )
+    {
+        tracker_log_bench_lookup( 1 + ( tracker_log_bench_rand( ) % tracker_ctx.nb_scan ), &after_boot );
+    }
+
+    printf( "Lookup               Scans  Reads/scan  Bytes/scan  Walk reads/scan  Walk bytes/scan  Differences\n" );
+    tracker_log_bench_print( "sequential", &sequential );
+    tracker_log_bench_print( "random", &random_order );
+    tracker_log_bench_print( "random after boot", &after_boot );
+    printf( "%-18s  %6u  %10s  %10s  %15s  %15s  %11u\n", "past the end", past_the_end.nb_lookups, "-", "-", "-",
+            "-", past_the_end.nb_differences );
+
+    printf( "\nIndex rebuilt at boot with %u flash reads, %llu bytes\n", boot_end.nb_reads - boot_start.nb_reads,
+            ( unsigned long long ) ( boot_end.nb_bytes_read - boot_start.nb_bytes_read ) );
+
+    const tracker_log_mock_stats_t stats = tracker_log_mock_get_stats( );
+
+    printf( "%u flash writes, internal log context pages %u and %u erased %u and %u times\n", stats.nb_writes,
+            TRACKER_LOG_BENCH_CTX_PAGE, TRACKER_LOG_BENCH_CTX_SPARE_PAGE,
+            tracker_log_mock_get_page_erases( TRACKER_LOG_BENCH_CTX_PAGE ),
+            tracker_log_mock_get_page_erases( TRACKER_LOG_BENCH_CTX_SPARE_PAGE ) );
+    printf( "%u flash accesses over programmed flash or out of the user flash\n", stats.nb_flash_errors );
+
+    if( ( sequential.nb_differences != 0 ) || ( random_order.nb_differences != 0 ) ||
+        ( after_boot.nb_differences != 0 ) || ( past_the_end.nb_differences != 0 ) || ( stats.nb_flash_errors != 0 ) )
+    {
+        printf( "\nFAILED: a scan read through the index differs from the linear walk\n" );
+        return 1;
+    }
+
+    if( params.nb_cuts > 0 )
+    {
+        tracker_log_bench_run_power_cuts( params.nb_cuts, cut_result, &nb_cut_scans, &nb_resets );
+
+        const tracker_log_mock_stats_t cut_stats = tracker_log_mock_get_stats( );
+
+        printf( "\n%u power cuts over %u scans stored, the internal log erased %u times when full\n\n", params.nb_cuts,
+                nb_cut_scans, nb_resets );
+        printf( "Power cut              Cuts  Erases cut  Scan lost  Scan stored  Errors\n" );
+        for( uint8_t kind = 0; kind < TRACKER_LOG_BENCH_CUT_SIZE; kind++ )
+        {
+            printf( "%-19s  %6u  %10u  %9u  %11u  %6u\n",
+                    ( kind == TRACKER_LOG_BENCH_CUT_ANY ) ? "any operation" : "context page change",
+                    cut_result[kind].nb_cuts, cut_result[kind].nb_cut_erases, cut_result[kind].nb_scans_lost,
+                    cut_result[kind].nb_scans_kept, cut_result[kind].nb_errors );
+            nb_cut_errors += cut_result[kind].nb_errors;
+        }
+        printf( "\nInternal log context pages %u and %u erased %u and %u times\n", TRACKER_LOG_BENCH_CTX_PAGE,
+                TRACKER_LOG_BENCH_CTX_SPARE_PAGE, tracker_log_mock_get_page_erases( TRACKER_LOG_BENCH_CTX_PAGE ),
+                tracker_log_mock_get_page_erases( TRACKER_LOG_BENCH_CTX_SPARE_PAGE ) );
+        printf( "%u flash accesses over programmed flash or out of the user flash\n", cut_stats.nb_flash_errors );
+
+        if( ( nb_cut_errors != 0 ) || ( cut_stats.nb_flash_errors != 0 ) )
+        {
+            printf( "\nFAILED: a power cut lost or changed the internal log\n" );
+            return 1;
+        }
+    }
+
+    printf( "\nEvery scan read through the index is the one of the linear walk" );
+    printf( ( params.nb_cuts > 0 ) ? ", and every power cut kept the internal log\n" : "\n" );
+    return 0;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static void tracker_log_bench_boot( void )
+{
+    if( tracker_restore_internal_log_ctx( ) != TRACKER_SUCCESS )
+    {
+        if( tracker_init_internal_log_ctx( ) != TRACKER_SUCCESS )
+        {
+            printf( "tracker_init_internal_log_ctx failed\n" );
+        }
+    }
+}
+
+static void tracker_log_bench_store_scan( void )
+{
+    scan_timestamp += 60 + ( tracker_log_bench_rand( ) % 600 );
+
+    if( ( tracker_log_bench_rand( ) % 2 ) == 0 )
+    {
+        wifi_mw_event_data_scan_done_t wifi_scan = { 0 };
+
+        wifi_scan.timestamp   = scan_timestamp;
+        wifi_scan.nbr_results = 1 + ( tracker_log_bench_rand( ) % WIFI_MAX_RESULTS );
+        for( uint8_t i = 0; i < wifi_scan.nbr_results; i++ )
+        {
+            wifi_scan.results[i].rssi    = -( int8_t )( 30 + ( tracker_log_bench_rand( ) % 70 ) );
+            wifi_scan.results[i].channel = ( lr11xx_wifi_channel_t )( 1 + ( tracker_log_bench_rand( ) % 14 ) );
+            wifi_scan.results[i].type = ( lr11xx_wifi_signal_type_result_t )( 1 + ( tracker_log_bench_rand( ) % 3 ) );
+            for( uint8_t j = 0; j < LR11XX_WIFI_MAC_ADDRESS_LENGTH; j++ )
+            {
+                wifi_scan.results[i].mac_address[j] = ( uint8_t ) tracker_log_bench_rand( );
+            }
+        }
+        tracker_store_wifi_in_internal_log( &wifi_scan );
+    }
+    else
+    {
+        gnss_mw_event_data_scan_done_t gnss_scan = { 0 };
+
+        // One group out of eight has no result, its scan is stored with the UTC time
+        gnss_scan.token          = ( uint8_t ) tracker_log_bench_rand( );
+        gnss_scan.nb_scans_valid = ( ( tracker_log_bench_rand( ) % 8 ) == 0 )
+                                       ? 0
+                                       : 1 + ( tracker_log_bench_rand( ) % GNSS_SCAN_GROUP_SIZE_MAX );
+        gnss_scan.context.mode = ( gnss_mw_mode_t )( tracker_log_bench_rand( ) % __GNSS_MW_MODE__SIZE );
+        for( uint8_t i = 0; i < gnss_scan.nb_scans_valid; i++ )
+        {
+            gnss_scan.scans[i].timestamp = scan_timestamp + i;
+            gnss_scan.scans[i].nb_svs    = 3 + ( tracker_log_bench_rand( ) % 10 );
+            gnss_scan.scans[i].nav       = nav_buffers[i];
+            gnss_scan.scans[i].nav_size =
+                TRACKER_LOG_BENCH_NAV_SIZE_MIN +
+                ( tracker_log_bench_rand( ) % ( TRACKER_LOG_BENCH_NAV_SIZE_MAX - TRACKER_LOG_BENCH_NAV_SIZE_MIN + 1 ) );
+            for( uint8_t j = 0; j < gnss_scan.scans[i].nav_size; j++ )
+            {
+                nav_buffers[i][j] = ( uint8_t ) tracker_log_bench_rand( );
+            }
+        }
+        tracker_store_gnss_in_internal_log( &gnss_scan );
+    }
+}
+
+static bool tracker_log_bench_read_scan( const uint16_t scan_number, char* text, uint16_t* text_len )
+{
+    uint8_t payload[] = { 1, READ_APP_INTERNAL_LOG_CMD, READ_APP_INTERNAL_LOG_LEN };
+    uint8_t answer[TRACKER_LOG_BENCH_ANSWER_SIZE];
+
+    // The command sends the scan in chunks, then goes to the next scan
+    internal_log_scan_index            = scan_number;
+    internal_log_buffer_len            = 0;
+    internal_log_tracker_settings_sent = true;
+    *text_len                          = 0;
+
+    while( internal_log_scan_index == scan_number )
+    {
+        tracker_parse_cmd( 0, payload, answer, sizeof( answer ), true );
+
+        // Element, command and answer length, then the progress and the text
+        const uint8_t answer_len = answer[2];
+
+        if( answer_len == 0 )
+        {
+            return false;
+        }
+        if( ( *text_len + answer_len - 1 ) > TRACKER_LOG_BENCH_SCAN_TEXT_SIZE )
+        {
+            return false;
+        }
+        memcpy( text + *text_len, &answer[4], answer_len - 1 );
+        *text_len += answer_len - 1;
+    }
+    return true;
+}
+
+static void tracker_log_bench_lookup( const uint16_t scan_number, tracker_log_bench_result_t* result )
+{
+    char     text[TRACKER_LOG_BENCH_SCAN_TEXT_SIZE];
+    char     walk_text[TRACKER_LOG_BENCH_SCAN_TEXT_SIZE];
+    uint16_t text_len      = 0;
+    uint16_t walk_text_len = 0;
+
+    const tracker_log_mock_stats_t start = tracker_log_mock_get_stats( );
+    const bool                     found = tracker_log_bench_read_scan( scan_number, text, &text_len );
+    const tracker_log_mock_stats_t end   = tracker_log_mock_get_stats( );
+
+    tracker_log_reference_get_one_scan( scan_number, ( uint8_t* ) walk_text, sizeof( walk_text ), &walk_text_len );
+
+    const tracker_log_mock_stats_t walk_end = tracker_log_mock_get_stats( );
+
+    result->nb_lookups++;
+    result->nb_reads += end.nb_reads - start.nb_reads;
+    result->nb_bytes_read += end.nb_bytes_read - start.nb_bytes_read;
+    result->nb_walk_reads += walk_end.nb_reads - end.nb_reads;
+    result->nb_walk_bytes += walk_end.nb_bytes_read - end.nb_bytes_read;
+
+    if( ( found == false ) || ( text_len != walk_text_len ) || ( memcmp( text, walk_text, text_len ) != 0 ) )
+    {
+        if( result->nb_differences == 0 )
+        {
+            printf( "Scan %u differs:\n%.*s\ninstead of:\n%.*s\n", scan_number, text_len, text, walk_text_len,
+                    walk_text );
+        }
+        result->nb_differences++;
+    }
+}
+
+static void tracker_log_bench_lookup_past_the_end( tracker_log_bench_result_t* result )
+{
+    tracker_internal_log_iterator_t iterator;
+    uint8_t                         scan_buf[TRACKER_LOG_BENCH_SCAN_TEXT_SIZE];
+    char                            text[TRACKER_LOG_BENCH_SCAN_TEXT_SIZE];
+    uint16_t                        text_len = 0;
+
+    // No scan 0, nor after the last one
+    result->nb_lookups += 3;
+    if( tracker_internal_log_iterator_init( &iterator, 0 ) == TRACKER_SUCCESS )
+    {
+        result->nb_differences++;
+    }
+    if( tracker_internal_log_iterator_init( &iterator, tracker_ctx.nb_scan + 1 ) == TRACKER_SUCCESS )
+    {
+        result->nb_differences++;
+    }
+    if( tracker_log_bench_read_scan( tracker_ctx.nb_scan + 1, text, &text_len ) == true )
+    {
+        result->nb_differences++;
+    }
+
+    // The iterator stops after the last scan
+    result->nb_lookups++;
+    if( ( tracker_internal_log_iterator_init( &iterator, tracker_ctx.nb_scan ) != TRACKER_SUCCESS ) ||
+        ( tracker_internal_log_iterator_next( &iterator, scan_buf, sizeof( scan_buf ) ) != TRACKER_SUCCESS ) ||
+        ( tracker_internal_log_iterator_next( &iterator, scan_buf, sizeof( scan_buf ) ) == TRACKER_SUCCESS ) )
+    {
+        result->nb_differences++;
+    }
+}
+
+static void tracker_log_bench_run_power_cuts( const uint32_t nb_cuts, tracker_log_bench_cut_result_t* result,
+                                              uint32_t* nb_scans, uint32_t* nb_resets )
+{
+    tracker_log_mock_init( FLASH_USER_START_PAGE );
+    tracker_log_bench_boot( );
+
+    for( uint32_t i = 0; i < nb_cuts; i++ )
+    {
+        const tracker_log_bench_cut_t kind = ( tracker_log_bench_cut_t )( i % TRACKER_LOG_BENCH_CUT_SIZE );
+
+        // Half of the cuts hit one of the next flash operations, the others the next change of context page
+        memset( &power_cut, 0, sizeof( power_cut ) );
+        if( kind == TRACKER_LOG_BENCH_CUT_ANY )
+        {
+            power_cut.addr          = ADDR_FLASH_PAGE_0;
+            power_cut.size          = UINT32_MAX;
+            power_cut.nb_operations = tracker_log_bench_rand( ) % TRACKER_LOG_BENCH_CUT_OPERATIONS;
+        }
+        else
+        {
+            power_cut.addr = ADDR_FLASH_PAGE( TRACKER_LOG_BENCH_CTX_PAGE );
+            power_cut.size = ( TRACKER_LOG_BENCH_CTX_SPARE_PAGE - TRACKER_LOG_BENCH_CTX_PAGE + 1 ) * ADDR_FLASH_PAGE_SIZE;
+            power_cut.from_page_start = true;
+            power_cut.nb_operations   = tracker_log_bench_rand( ) % TRACKER_LOG_BENCH_PAGE_CHANGE_OPERATIONS;
+        }
+
+        // The scans are stored until the cut
+        for( ;; )
+        {
+            const uint16_t                 nb_scan            = tracker_ctx.nb_scan;
+            const uint32_t                 flash_addr_current = tracker_ctx.flash_addr_current;
+            const tracker_log_mock_stats_t start              = tracker_log_mock_get_stats( );
+
+            // The internal log is erased when full, as by the flush command
+            if( tracker_ctx.flash_remaining_space <= TRACKER_LOG_BENCH_SCAN_BUFFER )
+            {
+                tracker_reset_internal_log( );
+                ( *nb_resets )++;
+                continue;
+            }
+
+            if( setjmp( power_cut.handler ) == 0 )
+            {
+                tracker_log_mock_set_power_cut( &power_cut );
+                tracker_log_bench_store_scan( );
+                tracker_log_mock_set_power_cut( NULL );
+
+                ( *nb_scans )++;
+                if( ( tracker_ctx.nb_scan != ( nb_scan + 1 ) ) ||
+                    ( tracker_log_bench_check_scans( tracker_ctx.nb_scan, nb_scan ) == false ) )
+                {
+                    if( result[kind].nb_errors == 0 )
+                    {
+                        printf( "Scan %u is not stored at 0x%08X\n", tracker_ctx.nb_scan, flash_addr_current );
+                    }
+                    result[kind].nb_errors++;
+                    break;
+                }
+            }
+            else
+            {
+                tracker_log_mock_set_power_cut( NULL );
+                ( *nb_scans )++;
+                if( tracker_log_mock_get_stats( ).nb_cut_erases != start.nb_cut_erases )
+                {
+                    result[kind].nb_cut_erases++;
+                }
+
+                // Restart, as after a reset
+                tracker_log_bench_boot( );
+                tracker_log_bench_check_power_cut( nb_scan, flash_addr_current, &result[kind] );
+                break;
+            }
+        }
+    }
+}
+
+static void tracker_log_bench_check_power_cut( const uint16_t nb_scan, const uint32_t flash_addr_current,
+                                               tracker_log_bench_cut_result_t* result )
+{
+    result->nb_cuts++;
+
+    // A cut scan is skipped, the next scan goes after it
+    if( ( tracker_ctx.nb_scan == nb_scan ) && ( tracker_ctx.flash_addr_current >= flash_addr_current ) )
+    {
+        result->nb_scans_lost++;
+    }
+    else if( ( tracker_ctx.nb_scan == ( nb_scan + 1 ) ) && ( tracker_ctx.flash_addr_current > flash_addr_current ) )
+    {
+        result->nb_scans_kept++;
+    }
+    else
+    {
+        if( result->nb_errors == 0 )
+        {
+            printf( "Power cut %u restores %u scans up to 0x%08X, instead of %u scans up to 0x%08X\n", result->nb_cuts,
+                    tracker_ctx.nb_scan, tracker_ctx.flash_addr_current, nb_scan, flash_addr_current );
+        }
+        result->nb_errors++;
+        return;
+    }
+
+    if( tracker_log_bench_check_scans( 1, nb_scan ) == false )
+    {
+        if( result->nb_errors == 0 )
+        {
+            printf( "Power cut %u changes the scans stored before it\n", result->nb_cuts );
+        }
+        result->nb_errors++;
+    }
+}
+
+static bool tracker_log_bench_check_scans( const uint16_t first_scan, const uint16_t nb_known_scans )
+{
+    tracker_internal_log_iterator_t iterator;
+    uint8_t                         scan_buf[TRACKER_LOG_BENCH_SCAN_BUFFER];
+
+    if( first_scan > tracker_ctx.nb_scan )
+    {
+        return true;
+    }
+    if( tracker_internal_log_iterator_init( &iterator, first_scan ) != TRACKER_SUCCESS )
+    {
+        return false;
+    }
+
+    for( uint16_t i = first_scan; i <= tracker_ctx.nb_scan; i++ )
+    {
+        memset( scan_buf, 0, sizeof( scan_buf ) );
+        if( tracker_internal_log_iterator_next( &iterator, scan_buf, sizeof( scan_buf ) ) != TRACKER_SUCCESS )
+        {
+            return false;
+        }
+
+        // Number of elements, then the scan number
+        const uint16_t number = scan_buf[1] | ( ( uint16_t ) scan_buf[2] << 8 );
+        const uint32_t hash   = tracker_log_bench_hash( scan_buf );
+
+        if( ( number != i ) || ( ( i <= nb_known_scans ) && ( hash != scan_hashes[i] ) ) )
+        {
+            return false;
+        }
+        scan_hashes[i] = hash;
+    }
+
+    return ( iterator.scan_addr <= tracker_ctx.flash_addr_current ) &&
+           ( tracker_internal_log_iterator_next( &iterator, scan_buf, sizeof( scan_buf ) ) != TRACKER_SUCCESS );
+}
+
+static uint32_t tracker_log_bench_hash( const uint8_t* scan_buf )
+{
+    uint32_t hash     = 2166136261u;
+    uint16_t scan_len = 3;
+
+    // Number of elements and scan number, then the tag and length of each element, the buffer goes on after the scan
+    for( uint8_t i = 0; ( i < scan_buf[0] ) && ( ( scan_len + 2 ) <= TRACKER_LOG_BENCH_SCAN_BUFFER ); i++ )
+    {
+        scan_len += 2 + scan_buf[scan_len + 1];
+    }
+    for( uint16_t i = 0; ( i < scan_len ) && ( i < TRACKER_LOG_BENCH_SCAN_BUFFER ); i++ )
+    {
+        hash = ( hash ^ scan_buf[i] ) * 16777619u;
+    }
+    return hash;
+}
+
+static void tracker_log_bench_print( const char* name, const tracker_log_bench_result_t* result )
+{
+    const double nb_lookups = ( result->nb_lookups != 0 ) ? result->nb_lookups : 1;
+
+    printf( "%-18s  %6u  %10.1f  %10.1f  %15.1f  %15.1f  %11u\n", name, result->nb_lookups,
+            result->nb_reads / nb_lookups, result->nb_bytes_read / nb_lookups, result->nb_walk_reads / nb_lookups,
+            result->nb_walk_bytes / nb_lookups, result->nb_differences );
+}
+
+static uint32_t tracker_log_bench_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+static bool parse_args( int argc, char** argv, tracker_log_bench_params_t* params )
+{
+    int opt;
+
+    while( ( opt = getopt( argc, argv, "n:l:c:e:h" ) ) != -1 )
+    {
+        switch( opt )
+        {
+        case 'n':
+            params->nb_scans = strtoul( optarg, NULL, 0 );
+            break;
+        case 'l':
+            params->nb_lookups = strtoul( optarg, NULL, 0 );
+            break;
+        case 'c':
+            params->nb_cuts = strtoul( optarg, NULL, 0 );
+            break;
+        case 'e':
+            params->seed = strtoul( optarg, NULL, 0 );
+            break;
+        default:
+            printf( "Usage: %s [-n scans] [-l random_lookups] [-c power_cuts] [-e seed]\n", argv[0] );
+            return false;
+        }
+    }
+    if( ( params->nb_scans == 0 ) || ( params->nb_scans > UINT16_MAX ) || ( params->seed == 0 ) )
+    {
+        printf( "The scans must be in [1..%u], and the seed at least 1\n", UINT16_MAX );
+        return false;
+    }
+    return true;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
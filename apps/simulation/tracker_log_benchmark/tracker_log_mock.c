@@ -0,0 +1,402 @@
+/**
+ * @file      tracker_log_mock.c
+ *
+ * @brief     RAM-backed flash HAL of the tracker, and stand-ins of the other functions tracker_utility.c calls
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "tracker_log_mock.h"
+#include "smtc_hal.h"
+#include "smtc_modem_api.h"
+#include "smtc_modem_hal.h"
+#include "apps_modem_common.h"
+#include "lr1110_trk1xks_board.h"
+#include "ralf.h"
+#include "lr11xx_bootloader.h"
+#include "lr11xx_gnss.h"
+#include "lr11xx_hal.h"
+#include "lr11xx_system.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+/**
+ * @brief Pages of the 1 MB flash of the STM32WB55xG
+ */
+#define TRACKER_LOG_MOCK_NB_PAGES 256
+#define TRACKER_LOG_MOCK_FLASH_SIZE ( TRACKER_LOG_MOCK_NB_PAGES * ADDR_FLASH_PAGE_SIZE )
+
+/**
+ * @brief Programming unit of the flash, a double word
+ */
+#define TRACKER_LOG_MOCK_WRITE_UNIT 8
+
+/**
+ * @brief UTC time of the first scan without GNSS result, 2022-01-01
+ */
+#define TRACKER_LOG_MOCK_UTC_TIME_START 1640995200
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/**
+ * @brief Modem radio, only passed to the LR11xx stand-ins
+ */
+ralf_t* modem_radio = NULL;
+
+static uint8_t                       flash[TRACKER_LOG_MOCK_FLASH_SIZE];
+static uint32_t                      page_erases[TRACKER_LOG_MOCK_NB_PAGES];
+static uint32_t                      flash_user_start_addr;
+static tracker_log_mock_stats_t      stats;
+static uint32_t                      utc_time = TRACKER_LOG_MOCK_UTC_TIME_START;
+static tracker_log_mock_power_cut_t* power_cut;
+static uint32_t                      random_state = 1;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Check that an area is in the flash
+ *
+ * @param [in] addr Flash address of the area
+ * @param [in] size Size of the area
+ *
+ * @return true if the whole area is in the flash
+ */
+static bool tracker_log_mock_is_in_flash( const uint32_t addr, const uint32_t size );
+
+/**
+ * @brief Count a flash operation, and tell whether the power is cut by it
+ *
+ * @param [in] addr     Flash address of the operation
+ * @param [in] is_write The operation is a write
+ *
+ * @return true if the power is cut by this operation
+ */
+static bool tracker_log_mock_is_cut( const uint32_t addr, const bool is_write );
+
+/**
+ * @brief Check that a double word is written with zeros, which the flash programs over a programmed double word
+ *
+ * @param [in] buffer Data written
+ * @param [in] unit   Offset of the double word in the data
+ * @param [in] size   Size of the data, the padding of the last double word being zeros
+ *
+ * @return true if the double word is written with zeros
+ */
+static bool tracker_log_mock_is_zero( const uint8_t* buffer, const uint32_t unit, const uint32_t size );
+
+/**
+ * @brief Xorshift pseudo-random generator, for the bits of the cut operations
+ */
+static uint32_t tracker_log_mock_rand( void );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void tracker_log_mock_init( const uint32_t user_start_page )
+{
+    memset( flash, FLASH_BYTE_EMPTY_CONTENT, sizeof( flash ) );
+    memset( page_erases, 0, sizeof( page_erases ) );
+    memset( &stats, 0, sizeof( stats ) );
+    flash_user_start_addr = ADDR_FLASH_PAGE( user_start_page );
+    utc_time              = TRACKER_LOG_MOCK_UTC_TIME_START;
+    power_cut             = NULL;
+    random_state          = 1;
+}
+
+tracker_log_mock_stats_t tracker_log_mock_get_stats( void )
+{
+    return stats;
+}
+
+uint32_t tracker_log_mock_get_page_erases( const uint32_t page )
+{
+    return ( page < TRACKER_LOG_MOCK_NB_PAGES ) ? page_erases[page] : 0;
+}
+
+void tracker_log_mock_set_power_cut( tracker_log_mock_power_cut_t* cut )
+{
+    power_cut = cut;
+}
+
+smtc_hal_status_t hal_flash_erase_page( uint32_t addr, uint8_t nb_page )
+{
+    const uint32_t page_addr = addr - ( ( addr - ADDR_FLASH_PAGE_0 ) % ADDR_FLASH_PAGE_SIZE );
+
+    if( ( addr < flash_user_start_addr ) ||
+        ( tracker_log_mock_is_in_flash( page_addr, nb_page * ADDR_FLASH_PAGE_SIZE ) == false ) )
+    {
+        stats.nb_flash_errors++;
+        return SMTC_HAL_FAILURE;
+    }
+    for( uint8_t i = 0; i < nb_page; i++ )
+    {
+        const uint32_t offset = page_addr - ADDR_FLASH_PAGE_0 + ( i * ADDR_FLASH_PAGE_SIZE );
+
+        if( tracker_log_mock_is_cut( ADDR_FLASH_PAGE_0 + offset, false ) == true )
+        {
+            // The bytes of a cut erase are erased or not
+            for( uint32_t j = 0; j < ADDR_FLASH_PAGE_SIZE; j++ )
+            {
+                if( ( tracker_log_mock_rand( ) & 1 ) != 0 )
+                {
+                    flash[offset + j] = FLASH_BYTE_EMPTY_CONTENT;
+                }
+            }
+            stats.nb_cut_erases++;
+            longjmp( power_cut->handler, 1 );
+        }
+        memset( &flash[offset], FLASH_BYTE_EMPTY_CONTENT, ADDR_FLASH_PAGE_SIZE );
+        page_erases[offset / ADDR_FLASH_PAGE_SIZE]++;
+        stats.nb_page_erases++;
+    }
+    return SMTC_HAL_SUCCESS;
+}
+
+smtc_hal_status_t hal_flash_write_buffer( uint32_t addr, const uint8_t* buffer, uint32_t size )
+{
+    // The padding of the last double word is programmed too, with zeros here
+    const uint32_t real_size =
+        ( size + TRACKER_LOG_MOCK_WRITE_UNIT - 1 ) / TRACKER_LOG_MOCK_WRITE_UNIT * TRACKER_LOG_MOCK_WRITE_UNIT;
+
+    stats.nb_writes++;
+    if( ( addr < flash_user_start_addr ) || ( ( ( addr - ADDR_FLASH_PAGE_0 ) % TRACKER_LOG_MOCK_WRITE_UNIT ) != 0 ) ||
+        ( tracker_log_mock_is_in_flash( addr, real_size ) == false ) )
+    {
+        stats.nb_flash_errors++;
+        return SMTC_HAL_FAILURE;
+    }
+    for( uint32_t unit = 0; unit < real_size; unit += TRACKER_LOG_MOCK_WRITE_UNIT )
+    {
+        // The bits of a cut write are cleared or not
+        const bool is_cut = tracker_log_mock_is_cut( addr + unit, true );
+
+        for( uint32_t i = unit; i < ( unit + TRACKER_LOG_MOCK_WRITE_UNIT ); i++ )
+        {
+            uint8_t* byte = &flash[addr - ADDR_FLASH_PAGE_0 + i];
+
+            // Programming only clears bits, and a double word is programmed once between two erases, unless it is
+            // programmed to zero
+            if( ( *byte != FLASH_BYTE_EMPTY_CONTENT ) && ( tracker_log_mock_is_zero( buffer, unit, size ) == false ) )
+            {
+                stats.nb_flash_errors++;
+            }
+            *byte &= ( ( i < size ) ? buffer[i] : 0x00 ) | ( is_cut ? ( uint8_t ) tracker_log_mock_rand( ) : 0x00 );
+        }
+        if( is_cut == true )
+        {
+            longjmp( power_cut->handler, 1 );
+        }
+        stats.nb_bytes_written += TRACKER_LOG_MOCK_WRITE_UNIT;
+    }
+    return SMTC_HAL_SUCCESS;
+}
+
+void hal_flash_read_buffer( uint32_t addr, uint8_t* buffer, uint32_t size )
+{
+    stats.nb_reads++;
+    if( tracker_log_mock_is_in_flash( addr, size ) == false )
+    {
+        stats.nb_flash_errors++;
+        memset( buffer, FLASH_BYTE_EMPTY_CONTENT, size );
+        return;
+    }
+    memcpy( buffer, &flash[addr - ADDR_FLASH_PAGE_0], size );
+    stats.nb_bytes_read += size;
+}
+
+uint32_t hal_flash_get_user_start_addr( void )
+{
+    return flash_user_start_addr;
+}
+
+void hal_flash_set_user_start_addr( uint32_t addr )
+{
+    flash_user_start_addr = addr;
+}
+
+void hal_mcu_delay_ms( uint32_t delay_ms )
+{
+}
+
+uint32_t apps_modem_common_get_utc_time( void )
+{
+    return utc_time++;
+}
+
+uint8_t smtc_modem_hal_get_voltage( void )
+{
+    return 0;
+}
+
+smtc_modem_return_code_t smtc_modem_get_status( uint8_t stack_id, smtc_modem_status_mask_t* status_mask )
+{
+    return SMTC_MODEM_RC_FAIL;
+}
+
+smtc_modem_return_code_t smtc_modem_connection_timeout_get_current_values(
+    uint8_t stack_id, uint16_t* nb_of_uplinks_before_network_controlled, uint16_t* nb_of_uplinks_before_reset )
+{
+    return SMTC_MODEM_RC_FAIL;
+}
+
+smtc_modem_return_code_t smtc_modem_suspend_before_user_radio_access( void )
+{
+    return SMTC_MODEM_RC_FAIL;
+}
+
+smtc_modem_return_code_t smtc_modem_resume_after_user_radio_access( void )
+{
+    return SMTC_MODEM_RC_FAIL;
+}
+
+void smtc_board_set_radio_in_dfu( const void* context )
+{
+}
+
+lr11xx_status_t lr11xx_system_get_version( const void* context, lr11xx_system_version_t* version )
+{
+    return LR11XX_STATUS_ERROR;
+}
+
+lr11xx_status_t lr11xx_bootloader_erase_flash( const void* context )
+{
+    return LR11XX_STATUS_ERROR;
+}
+
+lr11xx_status_t lr11xx_bootloader_write_flash_encrypted( const void* context, const uint32_t offset,
+                                                         const uint32_t* buffer, const uint8_t length )
+{
+    return LR11XX_STATUS_ERROR;
+}
+
+lr11xx_status_t lr11xx_gnss_almanac_update( const void* context, const uint8_t* blocks, const uint8_t nb_of_blocks )
+{
+    return LR11XX_STATUS_ERROR;
+}
+
+lr11xx_status_t lr11xx_gnss_get_almanac_age_for_satellite( const void* context, const lr11xx_gnss_satellite_id_t sv_id,
+                                                           uint16_t* almanac_age )
+{
+    return LR11XX_STATUS_ERROR;
+}
+
+lr11xx_status_t lr11xx_gnss_get_context_status( const void*                             context,
+                                                lr11xx_gnss_context_status_bytestream_t context_status_buffer )
+{
+    return LR11XX_STATUS_ERROR;
+}
+
+lr11xx_status_t lr11xx_gnss_parse_context_status_buffer(
+    const lr11xx_gnss_context_status_bytestream_t context_status_bytestream,
+    lr11xx_gnss_context_status_t*                 context_status )
+{
+    return LR11XX_STATUS_ERROR;
+}
+
+lr11xx_hal_status_t lr11xx_hal_reset( const void* context )
+{
+    return LR11XX_HAL_STATUS_ERROR;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static bool tracker_log_mock_is_in_flash( const uint32_t addr, const uint32_t size )
+{
+    return ( addr >= ADDR_FLASH_PAGE_0 ) && ( ( addr - ADDR_FLASH_PAGE_0 ) <= TRACKER_LOG_MOCK_FLASH_SIZE ) &&
+           ( size <= ( TRACKER_LOG_MOCK_FLASH_SIZE - ( addr - ADDR_FLASH_PAGE_0 ) ) );
+}
+
+static bool tracker_log_mock_is_cut( const uint32_t addr, const bool is_write )
+{
+    if( ( power_cut == NULL ) || ( addr < power_cut->addr ) || ( ( addr - power_cut->addr ) >= power_cut->size ) )
+    {
+        return false;
+    }
+    if( ( power_cut->is_counting == false ) &&
+        ( ( power_cut->from_page_start == false ) ||
+          ( ( is_write == true ) && ( ( ( addr - ADDR_FLASH_PAGE_0 ) % ADDR_FLASH_PAGE_SIZE ) == 0 ) ) ) )
+    {
+        power_cut->is_counting = true;
+    }
+    if( power_cut->is_counting == false )
+    {
+        return false;
+    }
+    if( power_cut->nb_operations == 0 )
+    {
+        return true;
+    }
+    power_cut->nb_operations--;
+    return false;
+}
+
+static bool tracker_log_mock_is_zero( const uint8_t* buffer, const uint32_t unit, const uint32_t size )
+{
+    for( uint32_t i = unit; ( i < ( unit + TRACKER_LOG_MOCK_WRITE_UNIT ) ) && ( i < size ); i++ )
+    {
+        if( buffer[i] != 0x00 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static uint32_t tracker_log_mock_rand( void )
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
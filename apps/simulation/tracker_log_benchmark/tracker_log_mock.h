@@ -0,0 +1,117 @@
+/**
+ * @file      tracker_log_mock.h
+ *
+ * @brief     RAM-backed flash HAL of the tracker, and stand-ins of the other functions tracker_utility.c calls
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRACKER_LOG_MOCK_H
+#define TRACKER_LOG_MOCK_H
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Counters of the mock
+ */
+typedef struct tracker_log_mock_stats_s
+{
+    uint32_t nb_reads;          //!< Calls to hal_flash_read_buffer()
+    uint64_t nb_bytes_read;     //!< Bytes read
+    uint32_t nb_writes;         //!< Calls to hal_flash_write_buffer()
+    uint64_t nb_bytes_written;  //!< Bytes programmed
+    uint32_t nb_page_erases;    //!< Pages erased
+    uint32_t nb_flash_errors;   //!< Writes of bytes that were not erased, and accesses out of the user flash
+    uint32_t nb_cut_erases;     //!< Page erases cut by a power cut
+} tracker_log_mock_stats_t;
+
+/**
+ * @brief Power cut at a flash operation, a double word write or a page erase. A cut write clears only part of the
+ * bits it should clear, and a cut erase erases only part of the bytes of the page.
+ */
+typedef struct tracker_log_mock_power_cut_s
+{
+    uint32_t addr;             //!< Start of the flash area whose operations are counted
+    uint32_t size;             //!< Size of the flash area
+    bool     from_page_start;  //!< Count only from the first write at the start of a page of the area
+    bool     is_counting;      //!< The operations are counted
+    uint32_t nb_operations;    //!< Operations left before the cut one
+    jmp_buf  handler;          //!< Jumped to at the cut, set by setjmp()
+} tracker_log_mock_power_cut_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Erase the whole flash and clear the counters
+ *
+ * @param [in] user_start_page First page of the user flash, after the application
+ */
+void tracker_log_mock_init( const uint32_t user_start_page );
+
+/**
+ * @brief Get the counters
+ *
+ * @return Counters since tracker_log_mock_init()
+ */
+tracker_log_mock_stats_t tracker_log_mock_get_stats( void );
+
+/**
+ * @brief Get the erases of a flash page
+ *
+ * @param [in] page Page number
+ *
+ * @return Erases of the page since tracker_log_mock_init()
+ */
+uint32_t tracker_log_mock_get_page_erases( const uint32_t page );
+
+/**
+ * @brief Cut the power at a flash operation, until the cut or the next call
+ *
+ * @param [in,out] cut Power cut, whose operations are counted down, NULL to stop cutting
+ */
+void tracker_log_mock_set_power_cut( tracker_log_mock_power_cut_t* cut );
+
+#endif  // TRACKER_LOG_MOCK_H
+
+/* --- EOF ------------------------------------------------------------------ */
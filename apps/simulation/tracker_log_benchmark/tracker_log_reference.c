@@ -0,0 +1,295 @@
+/**
+ * @file      tracker_log_reference.c
+ *
+ * @brief     Linear walk of the tracker internal log, replaced by the index of tracker_utility.c
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "tracker_log_reference.h"
+#include "smtc_hal.h"
+#include "tracker_utility.h"
+#include "lr11xx_wifi_types.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+extern tracker_ctx_t tracker_ctx;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Read 4 bytes from array buffer at index and interpret it as uint32_t LSB, and move the index after them
+ */
+static uint32_t get_uint32_from_array_at_index_and_inc( const uint8_t* array, uint16_t* index );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void tracker_log_reference_get_one_scan( uint16_t scan_number, uint8_t* out_buffer, const uint16_t out_buffer_len,
+                                         uint16_t* buffer_len )
+{
+    uint8_t   scan_buf[255];
+    uint16_t  scan_buf_index    = 0;
+    uint8_t   nb_elements       = 0;
+    uint8_t   nb_elements_index = 0;
+    uint8_t   tag_element       = 0;
+    uint16_t  scan_len          = 0;
+    uint16_t  nb_scan_index     = 1;
+    uint32_t  next_scan_addr    = tracker_ctx.flash_addr_start;
+    time_t    scan_timestamp    = 0;
+    struct tm epoch_time;
+    uint32_t  job_counter = 0;
+
+    *buffer_len = 0;
+
+    /* Retrieve the scan_number flash address */
+    while( nb_scan_index <= scan_number )
+    {
+        /* read the scan lentgh */
+        hal_flash_read_buffer( next_scan_addr, scan_buf, 2 );
+        scan_len = scan_buf[0];
+        scan_len += ( uint32_t ) scan_buf[1] << 8;
+
+        hal_flash_read_buffer( next_scan_addr + 2, scan_buf, scan_len - 2 );
+
+        nb_elements = scan_buf[scan_buf_index++];
+
+        scan_buf_index += 2;  // element which are always stored
+
+        while( nb_elements_index < nb_elements )
+        {
+            uint8_t len = 0;
+            tag_element = scan_buf[scan_buf_index++];  // get the element
+            len         = scan_buf[scan_buf_index++];  // get the size element
+
+            switch( tag_element )
+            {
+            case TAG_GNSS_PATCH:
+            case TAG_GNSS_PCB:
+            {
+                uint8_t last_scan = scan_buf[scan_buf_index + 6];
+                if( last_scan == 1 )
+                {
+                    job_counter++;
+                }
+                scan_buf_index += len;
+                break;
+            }
+            case TAG_WIFI:
+            {
+                job_counter++;
+                scan_buf_index += len;
+                break;
+            }
+            case TAG_NEXT_SCAN:
+            {
+                next_scan_addr = scan_buf[scan_buf_index++];
+                next_scan_addr += ( uint16_t ) scan_buf[scan_buf_index++] << 8;
+                next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 16;
+                next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 24;
+                break;
+            }
+            default:
+                scan_buf_index += len;
+                break;
+            }
+            nb_elements_index++;
+        }
+        nb_scan_index++;
+        nb_elements_index = 0;
+        scan_buf_index    = 0;  // reset the index;
+    }
+
+    /* Get the scan asked */
+
+    /* number elements to get */
+    nb_elements = scan_buf[scan_buf_index++];
+
+    /* Scan number */
+    scan_number = scan_buf[scan_buf_index++];
+    scan_number += ( uint16_t ) scan_buf[scan_buf_index++] << 8;
+
+    while( nb_elements_index < nb_elements )
+    {
+        uint8_t len = 0;
+        tag_element = scan_buf[scan_buf_index++];  // get the element
+        len         = scan_buf[scan_buf_index++];  // get the size element
+
+        switch( tag_element )
+        {
+        case TAG_GNSS_PATCH:
+        case TAG_GNSS_PCB:
+        {
+            /* Scan Timestamp */
+            scan_timestamp = get_uint32_from_array_at_index_and_inc( scan_buf, &scan_buf_index );
+            memcpy( &epoch_time, localtime( &scan_timestamp ), sizeof( struct tm ) );
+
+            uint16_t nav_len = len - GNSS_TOKEN_LEN - GNSS_NB_SAT_LEN - GNSS_TIMESTAMP_LEN -
+                               GNSS_LAST_SCAN_IN_GROUP_LEN - GNSS_PROFILE_LEN;
+            uint8_t token     = scan_buf[scan_buf_index++];
+            uint8_t nb_sat    = scan_buf[scan_buf_index++];
+            uint8_t last_scan = scan_buf[scan_buf_index++];
+            uint8_t profile   = scan_buf[scan_buf_index++];
+
+            /* Display Raw NAV Message*/
+            *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len,
+                                     "[%d-%d-%d %d:%d:%d.000] ", epoch_time.tm_year + 1900, epoch_time.tm_mon + 1,
+                                     epoch_time.tm_mday, epoch_time.tm_hour, epoch_time.tm_min, epoch_time.tm_sec );
+
+            *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len,
+                                     "[%ld - %d] ", job_counter, tag_element );
+
+            if( nav_len > 0 )
+            {
+                *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len, "01" );
+
+                for( uint16_t i = 0; i < nav_len; i++ )
+                {
+                    *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len,
+                                             "%02X", scan_buf[scan_buf_index++] );
+                }
+            }
+            else
+            {
+                *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len, "0007" );
+            }
+
+            *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len,
+                                     ",%d,%d,%d,%d\r\n", token, last_scan, nb_sat, profile );
+
+            break;
+        }
+        case TAG_WIFI:
+        {
+            int8_t                           wifi_rssi;
+            uint8_t                          wifi_data;
+            lr11xx_wifi_channel_t            wifi_channel;
+            lr11xx_wifi_signal_type_result_t wifi_type;
+            char                             wifi_type_char = 'B';
+
+            /* Scan Timestamp */
+            scan_timestamp = get_uint32_from_array_at_index_and_inc( scan_buf, &scan_buf_index );
+            memcpy( &epoch_time, localtime( &scan_timestamp ), sizeof( struct tm ) );
+
+            for( uint8_t i = 0; i < ( ( len - WIFI_TIMESTAMP_LEN ) / WIFI_SINGLE_BEACON_LEN ); i++ )
+            {
+                *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len,
+                                         "[%d-%d-%d %d:%d:%d.000] ", epoch_time.tm_year + 1900, epoch_time.tm_mon + 1,
+                                         epoch_time.tm_mday, epoch_time.tm_hour, epoch_time.tm_min, epoch_time.tm_sec );
+
+                *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len,
+                                         "[%ld - %d] ", job_counter, tag_element );
+
+                wifi_rssi = scan_buf[scan_buf_index++];
+
+                wifi_data    = scan_buf[scan_buf_index++];
+                wifi_channel = ( lr11xx_wifi_channel_t )( wifi_data & 0x0F );
+                wifi_type    = ( lr11xx_wifi_signal_type_result_t )( ( wifi_data & 0x30 ) >> 4 );
+
+                switch( wifi_type )
+                {
+                case LR11XX_WIFI_TYPE_RESULT_B:
+                    wifi_type_char = 'B';
+                    break;
+                case LR11XX_WIFI_TYPE_RESULT_G:
+                    wifi_type_char = 'G';
+                    break;
+                case LR11XX_WIFI_TYPE_RESULT_N:
+                    wifi_type_char = 'N';
+                    break;
+                default:
+                    break;
+                }
+
+                /* Display MAC address */
+                for( uint8_t i = 0; i < 5; i++ )
+                {
+                    *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len,
+                                             "%02X:", scan_buf[scan_buf_index++] );
+                }
+
+                *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len, "%02X,",
+                                         scan_buf[scan_buf_index++] );
+
+                /* Display Scan Information */
+                *buffer_len += snprintf( ( char* ) ( out_buffer + *buffer_len ), out_buffer_len - *buffer_len,
+                                         "CHANNEL_%d,TYPE_%c,%d,0,0,0,0\r\n", wifi_channel, wifi_type_char, wifi_rssi );
+            }
+            break;
+        }
+        case TAG_NEXT_SCAN:
+        {
+            next_scan_addr = scan_buf[scan_buf_index++];
+            next_scan_addr += ( uint16_t ) scan_buf[scan_buf_index++] << 8;
+            next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 16;
+            next_scan_addr += ( uint32_t ) scan_buf[scan_buf_index++] << 24;
+            break;
+        }
+        default:
+        {
+            scan_buf_index += len;
+        }
+        break;
+        }
+        nb_elements_index++;
+    }
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint32_t get_uint32_from_array_at_index_and_inc( const uint8_t* array, uint16_t* index )
+{
+    const uint16_t local_index = *index;
+    const uint32_t value = array[local_index] + ( array[local_index + 1] << 8 ) + ( array[local_index + 2] << 16 ) +
+                           ( array[local_index + 3] << 24 );
+    *index = local_index + 4;
+    return value;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -117,6 +117,25 @@
  */
 #define SMTC_MODEM_EXTENDED_UPLINK_ID_GNSS 1
 
+/**
+ * @brief Number of scans in a scan group of the GNSS_MW_MODE_STATIC mode [1..GNSS_SCAN_GROUP_SIZE_MAX]
+ */
+#ifndef GNSS_MW_MODE_STATIC_SCAN_GROUP_SIZE
+#define GNSS_MW_MODE_STATIC_SCAN_GROUP_SIZE 4
+#endif
+
+/**
+ * @brief Number of scans in a scan group of the GNSS_MW_MODE_MOBILE mode [1..GNSS_SCAN_GROUP_SIZE_MAX]
+ */
+#ifndef GNSS_MW_MODE_MOBILE_SCAN_GROUP_SIZE
+#define GNSS_MW_MODE_MOBILE_SCAN_GROUP_SIZE 2
+#endif
+
+#if( ( GNSS_MW_MODE_STATIC_SCAN_GROUP_SIZE > GNSS_SCAN_GROUP_SIZE_MAX ) || \
+     ( GNSS_MW_MODE_MOBILE_SCAN_GROUP_SIZE > GNSS_SCAN_GROUP_SIZE_MAX ) )
+#error "The scan group size of a mode exceeds GNSS_SCAN_GROUP_SIZE_MAX"
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -200,8 +219,8 @@ static gnss_scan_group_mode_t scan_group_mode = GNSS_SCAN_GROUP_MODE_SENSITIVITY
  * @brief Pre-defined scan modes to be selected by the user depending on the use case (STATIC, MOBILE...)
  */
 static gnss_mw_mode_desc_t modes[__GNSS_MW_MODE__SIZE] = {
-    { .scan_group_delay = 15, .scan_group_size = 4, .sv_min = 3 }, /* GNSS_MW_MODE_STATIC */
-    { .scan_group_delay = 0, .scan_group_size = 2, .sv_min = 5 },  /* GNSS_MW_MODE_MOBILE */
+    { .scan_group_delay = 15, .scan_group_size = GNSS_MW_MODE_STATIC_SCAN_GROUP_SIZE, .sv_min = 3 }, /* STATIC */
+    { .scan_group_delay = 0, .scan_group_size = GNSS_MW_MODE_MOBILE_SCAN_GROUP_SIZE, .sv_min = 5 },  /* MOBILE */
 };
 
 /*!
@@ -234,6 +253,11 @@ static uint8_t lorawan_port = GNSS_APP_PORT;
  */
 static bool scan_aggregate = false;
 
+/*!
+ * @brief Indicates if the scan results are packed in as few uplinks as possible, or sent one per uplink
+ */
+static bool send_packed = false;
+
 /*!
  * @brief Indicates sequence to "scan & send" or "scan only" mode
  */
@@ -287,7 +311,8 @@ static void gnss_mw_scan_rp_task_launch( void* context );
 static void gnss_mw_scan_rp_task_done( smtc_modem_rp_status_t* status );
 
 /*!
- * @brief Pop a result from the scan group queue, and send it over the air (uses extended API from LBM to send uplink)
+ * @brief Pop a result from the scan group queue, and send it over the air (uses extended API from LBM to send uplink).
+ * In packed mode, pop as many results as fit in the next uplink.
  *
  * @return a boolean set to true if a frame has been sent, set to false is there is nothing to be sent (queue empty or
  * bypass mode).
@@ -584,6 +609,14 @@ void gnss_mw_scan_aggregate( bool aggregate )
     scan_aggregate = aggregate;
 }
 
+void gnss_mw_send_packed( bool packed )
+{
+    MW_DBG_TRACE_INFO( "GNSS scan: set packed send mode to %s\n", packed ? "TRUE" : "FALSE" );
+
+    /* Set packed send current mode */
+    send_packed = packed;
+}
+
 void gnss_mw_send_bypass( bool no_send )
 {
     MW_DBG_TRACE_INFO( "GNSS scan: set scan only mode to %s (bypass send)\n", no_send ? "TRUE" : "FALSE" );
@@ -946,10 +979,12 @@ void gnss_mw_scan_rp_task_done( smtc_modem_rp_status_t* status )
 static bool gnss_mw_send_results( void )
 {
     bool success = false;
+    bool popped  = false;
 
     /* static variables because there is no copy done by LBM for extended send API */
     static uint8_t* buffer_to_send;
     static uint8_t  buffer_to_send_size;
+    static uint8_t  buffer_packed[GNSS_SCAN_PACKED_SIZE_MAX];
 
     /* Check if "no send "mode" is configured */
     if( send_bypass == true )
@@ -958,8 +993,23 @@ static bool gnss_mw_send_results( void )
         return false;
     }
 
-    /* Get the scan index to be sent from the scan group queue */
-    if( gnss_scan_group_queue_pop( &gnss_scan_group_queue, &buffer_to_send, &buffer_to_send_size ) == true )
+    if( send_packed == true )
+    {
+        uint8_t tx_max_payload;
+
+        /* Pack as many scan results as allowed by the next uplink */
+        MW_ASSERT_SMTC_MODEM_RC( smtc_modem_get_next_tx_max_payload( modem_stack_id, &tx_max_payload ) );
+        popped = gnss_scan_group_queue_pop_packed( &gnss_scan_group_queue, tx_max_payload, buffer_packed,
+                                                   &buffer_to_send_size );
+        buffer_to_send = buffer_packed;
+    }
+    else
+    {
+        /* Get the scan index to be sent from the scan group queue */
+        popped = gnss_scan_group_queue_pop( &gnss_scan_group_queue, &buffer_to_send, &buffer_to_send_size );
+    }
+
+    if( popped == true )
     {
         /* Send uplink */
         if( gnss_mw_send_frame( buffer_to_send, buffer_to_send_size ) == true )
@@ -302,6 +302,20 @@ void gnss_mw_set_port( uint8_t port );
  */
 void gnss_mw_scan_aggregate( bool aggregate );
 
+/**
+ * @brief Pack the results of a scan group in as few uplinks as possible, with the scan group metadata once per uplink.
+ * Each uplink takes as many NAV messages as allowed by its maximum payload size. An uplink with a single NAV message is
+ * the same as when the results are not packed, the others are flagged by a marker and each of their NAV messages but
+ * the last one is preceded by its size (see gnss_scan_group_queue_pop_packed()).
+ * The Application Server must decode the packed payload format, so a dedicated port should be set with
+ * gnss_mw_set_port().
+ *
+ * @param [in] packed Boolean to pack the results or not
+ *
+ * By default it is set to false, meaning that each NAV message is sent in its own uplink
+ */
+void gnss_mw_send_packed( bool packed );
+
 /**
  * @brief Bypass the "send" part of the "scan & send" sequence. Basically it is a "scan only" mode.
  * It can be used if the application wants to control how the scan results are sent over the air.
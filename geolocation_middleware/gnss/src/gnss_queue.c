@@ -126,6 +126,15 @@
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
  */
 
+/*!
+ * @brief Check if a queue has scan results left to be sent
+ *
+ * @param[in] queue Queue to check
+ *
+ * @return a boolean set to true if the scan group is valid and not all its results have been sent, false otherwise
+ */
+static bool gnss_scan_group_queue_has_results( gnss_scan_group_queue_t* queue );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -253,8 +262,7 @@ void gnss_scan_group_queue_push( gnss_scan_group_queue_t* queue, gnss_scan_t* sc
 
 bool gnss_scan_group_queue_pop( gnss_scan_group_queue_t* queue, uint8_t** buffer, uint8_t* buffer_size )
 {
-    if( ( queue != NULL ) && gnss_scan_group_queue_is_valid( queue ) &&
-        ( queue->nb_scans_sent < queue->nb_scans_valid ) && ( queue->abort == false ) )
+    if( gnss_scan_group_queue_has_results( queue ) == true )
     {
         const uint8_t index   = queue->nb_scans_sent;
         const uint8_t is_last = ( queue->nb_scans_sent == ( queue->nb_scans_valid - 1 ) );
@@ -287,9 +295,96 @@ bool gnss_scan_group_queue_pop( gnss_scan_group_queue_t* queue, uint8_t** buffer
     return false;
 }
 
+bool gnss_scan_group_queue_pop_packed( gnss_scan_group_queue_t* queue, uint8_t max_size, uint8_t* buffer,
+                                       uint8_t* buffer_size )
+{
+    if( gnss_scan_group_queue_has_results( queue ) == true )
+    {
+        const uint8_t first    = queue->nb_scans_sent;
+        uint8_t       nb_scans = 1;
+        uint8_t       size     = GNSS_SCAN_METADATA_SIZE + queue->scans[first].results_size;
+
+        if( max_size > GNSS_SCAN_PACKED_SIZE_MAX )
+        {
+            max_size = GNSS_SCAN_PACKED_SIZE_MAX;
+        }
+
+        /* Take the results in order while they fit, the first one even if it does not. A single result is sent as
+         * by gnss_scan_group_queue_pop(), the second one costs the marker, and each result added costs the size field
+         * of the one before it, the last one running to the end of the payload */
+        while( ( first + nb_scans ) < queue->nb_scans_valid )
+        {
+            uint8_t extra_size = GNSS_SCAN_PACKED_NAV_SIZE_SIZE + queue->scans[first + nb_scans].results_size;
+
+            if( nb_scans == 1 )
+            {
+                extra_size += GNSS_SCAN_PACKED_MARKER_SIZE;
+            }
+            if( ( size + extra_size ) > max_size )
+            {
+                break;
+            }
+            size += extra_size;
+            nb_scans += 1;
+        }
+
+        size = GNSS_SCAN_METADATA_SIZE;
+        if( nb_scans > 1 )
+        {
+            buffer[size] = GNSS_SCAN_PACKED_MARKER;
+            size += GNSS_SCAN_PACKED_MARKER_SIZE;
+        }
+        for( uint8_t i = 0; i < nb_scans; i++ )
+        {
+            const gnss_scan_t* scan = &queue->scans[first + i];
+
+            if( i < ( nb_scans - 1 ) )
+            {
+                buffer[size] = scan->results_size;
+                if( i == ( nb_scans - 2 ) )
+                {
+                    buffer[size] |= GNSS_SCAN_PACKED_NAV_SIZE_NEXT_IS_LAST;
+                }
+                size += GNSS_SCAN_PACKED_NAV_SIZE_SIZE;
+            }
+            memcpy( &buffer[size], &scan->results_buffer[GNSS_SCAN_METADATA_SIZE], scan->results_size );
+            size += scan->results_size;
+        }
+
+        /* Update queue info */
+        queue->nb_scans_sent += nb_scans;
+
+        /* Set scan group metadata once for all the packed results
+            | last NAV (1bit) | token (7bits) |
+            - token: scan group identifier
+            - last NAV: indicates if the last NAV message of a scan group is in the payload
+        */
+        buffer[0] = ( ( queue->nb_scans_sent == queue->nb_scans_valid ) << 7 ) | ( queue->token & 0x7F );
+
+        *buffer_size = size;
+
+        GNSS_QUEUE_TRACE_PRINTF( "%s: %d bytes\n", __FUNCTION__, size );
+        GNSS_QUEUE_PRINT( queue );
+
+        return true;
+    }
+
+    /* scan results to be sent */
+    *buffer_size = 0;
+    GNSS_QUEUE_TRACE_PRINTF( "%s: no scan result left in queue\n", __FUNCTION__ );
+
+    return false;
+}
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
  */
 
+static bool gnss_scan_group_queue_has_results( gnss_scan_group_queue_t* queue )
+{
+    return ( ( queue != NULL ) && gnss_scan_group_queue_is_valid( queue ) &&
+             ( queue->nb_scans_sent < queue->nb_scans_valid ) && ( queue->abort == false ) );
+}
+
 /* --- EOF ------------------------------------------------------------------ */
\ No newline at end of file
@@ -75,6 +75,33 @@ extern "C" {
  * @brief The minimum number of SV necessary for single NAV position solving
  */
 #define GNSS_SCAN_SINGLE_NAV_MIN_SV 6
+
+/**
+ * @brief First byte of a payload packing several NAV messages, after the metadata. A NAV message never starts with it,
+ * as it is the status of a NAV message without assistance position, which is not sent
+ */
+#define GNSS_SCAN_PACKED_MARKER 0x00
+
+/**
+ * @brief Number of bytes of the marker of a payload packing several NAV messages
+ */
+#define GNSS_SCAN_PACKED_MARKER_SIZE 1
+
+/**
+ * @brief Number of bytes of the size field preceding each NAV message but the last one in a packed payload
+ */
+#define GNSS_SCAN_PACKED_NAV_SIZE_SIZE 1
+
+/**
+ * @brief Flag of the size field of a NAV message in a packed payload, set if the next NAV message is the last one
+ */
+#define GNSS_SCAN_PACKED_NAV_SIZE_NEXT_IS_LAST 0x80
+
+/**
+ * @brief Maximum size of a packed payload (largest LoRaWAN application payload)
+ */
+#define GNSS_SCAN_PACKED_SIZE_MAX 242
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
@@ -210,6 +237,28 @@ void gnss_scan_group_queue_push( gnss_scan_group_queue_t* queue, gnss_scan_t* sc
  */
 bool gnss_scan_group_queue_pop( gnss_scan_group_queue_t* queue, uint8_t** buffer, uint8_t* buffer_size );
 
+/*!
+ * @brief Pack the next scan results into one payload to be sent over the air, with the scan group metadata only once.
+ * The results are packed in order, as many as fit in max_size, and at least one even if it does not fit.
+ * After this function call, nb_scans_sent is increased by the number of results packed (considered sent)
+ * A payload with a single NAV message is the same as the one returned by gnss_scan_group_queue_pop():
+ * | last NAV (1bit) | token (7bits) | NAV |
+ * A payload with several NAV messages starts with GNSS_SCAN_PACKED_MARKER, and the last NAV message runs to the end of
+ * the payload without a size: | last NAV (1bit) | token (7bits) | marker | NAV size | NAV | ... | NAV size | NAV | NAV |
+ * The size field preceding the last NAV message but one has GNSS_SCAN_PACKED_NAV_SIZE_NEXT_IS_LAST set.
+ * So packing never takes more frames or bytes than sending one NAV message per frame.
+ * The last NAV bit is set if the last result of the scan group is in the payload.
+ *
+ * @param[in] queue Queue from which the results are popped
+ * @param[in] max_size Maximum size of the payload, GNSS_SCAN_PACKED_SIZE_MAX at most
+ * @param[out] buffer Buffer of GNSS_SCAN_PACKED_SIZE_MAX bytes in which the payload is prepared
+ * @param[out] buffer_size Size of the payload to be sent
+ *
+ * @return a boolean set to true is a payload is ready to be sent, false if there is no result to be sent
+ */
+bool gnss_scan_group_queue_pop_packed( gnss_scan_group_queue_t* queue, uint8_t max_size, uint8_t* buffer,
+                                       uint8_t* buffer_size );
+
 #ifdef __cplusplus
 }
 #endif
@@ -56,8 +56,17 @@ extern "C" {
 
 /**
  * @brief Maximum number of GNSS scan in a scan group [1..32]
+ *
+ * It can be overridden at build time. Each scan of the group takes RAM in the scan group queue and in the SCAN_DONE
+ * event data.
  */
+#ifndef GNSS_SCAN_GROUP_SIZE_MAX
 #define GNSS_SCAN_GROUP_SIZE_MAX ( 4 )
+#endif
+
+#if( ( GNSS_SCAN_GROUP_SIZE_MAX < 1 ) || ( GNSS_SCAN_GROUP_SIZE_MAX > 32 ) )
+#error "GNSS_SCAN_GROUP_SIZE_MAX must be in [1..32]"
+#endif
 
 /*
  * -----------------------------------------------------------------------------
@@ -5,7 +5,7 @@
 #-----------------------------------------------------------------------------
 # Build system binaries
 #-----------------------------------------------------------------------------
-PREFIX = arm-none-eabi-
+PREFIX ?= arm-none-eabi-
 # The gcc compiler bin path can be either defined in make command via GCC_PATH variable (> make GCC_PATH=xxx)
 # either it can be added to the PATH environment variable.
 ifdef GCC_PATH
@@ -178,12 +178,15 @@ WFLAG += \
 	-Wno-unused-parameter \
 	-Wpedantic \
 	-fomit-frame-pointer \
-	-mabi=aapcs \
 	-fno-unroll-loops \
 	-ffast-math \
 	-ftree-vectorize \
 	$(BYPASS_FLAGS)
 
+ifneq ($(HOST_BUILD),yes)
+WFLAG += -mabi=aapcs
+endif
+
 # Allow linker to not link unused functions
 WFLAG += \
 	-ffunction-sections \
@@ -266,6 +269,26 @@ COMMON_C_DEFS += \
 	-DADD_SMTC_ALC_SYNC
 endif
 
+ifeq ($(CRYPTO_AES_T_TABLES),yes)
+COMMON_C_DEFS += \
+	-DAES_ENC_T_TABLES
+endif
+
+ifeq ($(CRC32_SLICE_BY_8),yes)
+COMMON_C_DEFS += \
+	-DSMTC_CRC32_SLICE_BY_8
+endif
+
+ifeq ($(CRC32_HAL),yes)
+COMMON_C_DEFS += \
+	-DSMTC_CRC32_HAL
+endif
+
+ifeq ($(ADD_SMTC_CONTEXT_JOURNAL),yes)
+COMMON_C_DEFS += \
+	-DADD_SMTC_CONTEXT_JOURNAL
+endif
+
 
 CFLAGS += -fno-builtin $(MCU_FLAGS) $(BOARD_C_DEFS) $(COMMON_C_DEFS) $(MODEM_C_DEFS) $(BOARD_C_INCLUDES) $(COMMON_C_INCLUDES) $(MODEM_C_INCLUDES) $(OPT) $(WFLAG) -MMD -MP -MF"$(@:%.o=%.d)"
 CFLAGS += -falign-functions=4
@@ -291,6 +314,8 @@ SMTC_MODEM_CORE_C_SOURCES += \
 	smtc_modem_core/modem_core/smtc_modem_test.c\
 	smtc_modem_core/modem_services/fifo_ctrl.c\
 	smtc_modem_core/modem_services/modem_utilities.c \
+	smtc_modem_core/modem_services/smtc_context_journal.c \
+	smtc_modem_core/modem_services/smtc_crc32.c \
 	smtc_modem_core/modem_services/smtc_modem_services_hal.c\
 	smtc_modem_core/modem_services/lorawan_certification.c\
 	smtc_modem_core/modem_supervisor/modem_supervisor.c
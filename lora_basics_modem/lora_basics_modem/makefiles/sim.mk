@@ -0,0 +1,51 @@
+##############################################################################
+# Definitions for the simulated radio (host build)
+##############################################################################
+TARGET = sim
+
+#-----------------------------------------------------------------------------
+# Host toolchain
+#-----------------------------------------------------------------------------
+# The modem is built with the native compiler, no MCU flags are needed
+HOST_BUILD = yes
+PREFIX =
+MCU_FLAGS =
+
+#-----------------------------------------------------------------------------
+# Common sources
+#-----------------------------------------------------------------------------
+SMTC_RAL_C_SOURCES += \
+	smtc_modem_core/smtc_ral/src/ral_sim.c
+
+SMTC_RALF_C_SOURCES += \
+	smtc_modem_core/smtc_ralf/src/ralf_sim.c
+
+SMTC_MODEM_CRYPTO_C_SOURCES += \
+	smtc_modem_core/smtc_modem_crypto/soft_secure_element/aes.c\
+	smtc_modem_core/smtc_modem_crypto/soft_secure_element/cmac.c\
+	smtc_modem_core/smtc_modem_crypto/soft_secure_element/soft_se.c
+
+# Modem HAL backed by a virtual clock and a RAM non-volatile storage
+SMTC_MODEM_CORE_C_SOURCES += \
+	smtc_modem_hal/host/smtc_modem_hal.c
+
+#-----------------------------------------------------------------------------
+# Includes
+#-----------------------------------------------------------------------------
+MODEM_C_INCLUDES =  \
+	-Ismtc_modem_core/smtc_modem_crypto/soft_secure_element\
+	-Ismtc_modem_hal/host
+
+#-----------------------------------------------------------------------------
+# Region
+#-----------------------------------------------------------------------------
+
+#-----------------------------------------------------------------------------
+# Radio specific compilation flags
+#-----------------------------------------------------------------------------
+MODEM_C_DEFS += \
+	-DRADIO_SIM
+
+# The inverse cipher is needed by the network server stand-in of the host simulations
+MODEM_C_DEFS += \
+	-DAES_DEC_PREKEYED
@@ -87,6 +87,19 @@ extern "C" {
  */
 #define SMTC_MODEM_D2D_PING_SLOTS_MASK_SIZE 16
 
+/**
+ * @brief Maximum number of radio planner hooks reported in the timing statistics
+ */
+#define SMTC_MODEM_RP_TIMING_NB_HOOKS_MAX 16
+
+/**
+ * @brief Number of bins of the radio planner timing histograms
+ *
+ * Bin 0 counts the values lower than or equal to 0, bin n counts the values in [2^(n-1), 2^n[ and the last bin counts
+ * all the values greater than or equal to 2^(SMTC_MODEM_RP_TIMING_NB_BINS-2)
+ */
+#define SMTC_MODEM_RP_TIMING_NB_BINS 8
+
 /**
  * @defgroup SMTC_MODEM_EVENT_DEF Event codes definitions
  * @{
@@ -211,6 +224,17 @@ typedef enum smtc_modem_file_upload_cipher_mode_e
     SMTC_MODEM_FILE_UPLOAD_AES_WITH_APPSKEY,  //!< Encrypt file using AES with appskey
 } smtc_modem_file_upload_cipher_mode_t;
 
+/**
+ * @brief Reader of a file to upload, for a file that is not held in RAM
+ *
+ * @param [in]  offset Offset in bytes of the data in the file
+ * @param [out] data   Buffer receiving the data
+ * @param [in]  size   Number of bytes to read
+ *
+ * @return true if the data was read, false otherwise
+ */
+typedef bool ( *smtc_modem_file_upload_read_t )( uint32_t offset, uint8_t* data, uint16_t size );
+
 /**
  * @brief Cipher mode for stream service
  */
@@ -456,6 +480,57 @@ typedef enum smtc_modem_d2d_class_b_tx_done_status_e
     SMTC_MODEM_EVENT_D2D_CLASS_B_TX_DONE_SENT     = 1,
 } smtc_modem_d2d_class_b_tx_done_status_t;
 
+/**
+ * @brief Radio planner timing trace events
+ */
+typedef enum smtc_modem_rp_timing_event_e
+{
+    SMTC_MODEM_RP_TIMING_EVENT_ARBITER = 0,  //!< Arbiter run, value is its execution time in 100µs
+    SMTC_MODEM_RP_TIMING_EVENT_LAUNCH,       //!< Task launch, value is the start lateness in ms
+    SMTC_MODEM_RP_TIMING_EVENT_IRQ,          //!< Radio IRQ, value is the IRQ to hook callback latency in 100µs
+    SMTC_MODEM_RP_TIMING_EVENT_LATE_ABORT,   //!< Task aborted because it was in the past, value is the delay in ms
+} smtc_modem_rp_timing_event_t;
+
+/**
+ * @brief Radio planner timing trace entry
+ */
+typedef struct smtc_modem_rp_timing_trace_s
+{
+    uint32_t                     timestamp_100us;  //!< Time of the event, from smtc_modem_hal_get_time_in_100us()
+    int32_t                      value;            //!< Measured value, depends on the event
+    smtc_modem_rp_timing_event_t event;            //!< Trace event
+    uint8_t                      hook_id;  //!< Radio planner hook of the task, nb_hooks if not related to a task
+} smtc_modem_rp_timing_trace_t;
+
+/**
+ * @brief Radio planner timing statistics of a hook
+ *
+ * The start lateness of a task is the time between its start time and the end of its launch callback, when the radio
+ * is started. A positive lateness means that the radio planner margin delay was too small for the task.
+ */
+typedef struct smtc_modem_rp_hook_timing_stats_s
+{
+    uint16_t start_lateness_ms[SMTC_MODEM_RP_TIMING_NB_BINS];      //!< Histogram of the start lateness
+    uint16_t launch_duration_100us[SMTC_MODEM_RP_TIMING_NB_BINS];  //!< Histogram of the launch callback duration
+    uint16_t irq_to_callback_100us[SMTC_MODEM_RP_TIMING_NB_BINS];  //!< Histogram of the IRQ to callback latency
+    int32_t  start_lateness_max_ms;      //!< Maximum start lateness, INT32_MIN if no task was launched
+    uint32_t launch_duration_max_100us;  //!< Maximum launch callback duration
+    uint32_t irq_to_callback_max_100us;  //!< Maximum radio IRQ to hook callback latency
+    uint32_t late_start_nb;              //!< Number of tasks started after their start time
+} smtc_modem_rp_hook_timing_stats_t;
+
+/**
+ * @brief Radio planner timing statistics
+ */
+typedef struct smtc_modem_rp_timing_stats_s
+{
+    uint8_t                           nb_hooks;  //!< Number of valid entries in hooks
+    smtc_modem_rp_hook_timing_stats_t hooks[SMTC_MODEM_RP_TIMING_NB_HOOKS_MAX];  //!< Statistics per hook
+    uint16_t arbiter_100us[SMTC_MODEM_RP_TIMING_NB_BINS];  //!< Histogram of the arbiter time, callbacks excluded
+    uint32_t arbiter_max_100us;                            //!< Maximum arbiter execution time
+    uint32_t late_abort_nb;  //!< Number of tasks aborted by the arbiter because they were in the past
+} smtc_modem_rp_timing_stats_t;
+
 /**
  * @brief Structure holding event-related data
  */
@@ -543,6 +618,22 @@ typedef struct smtc_modem_event_s
     } event_data;
 } smtc_modem_event_t;
 
+/**
+ * @brief Downlink read in place, see smtc_modem_get_downlink_data_view()
+ */
+typedef struct smtc_modem_downlink_view_s
+{
+    const uint8_t*                     data;  //!< Payload, valid until smtc_modem_release_downlink_data_view()
+    uint16_t                           length;
+    int8_t                             rssi;  //!< Signed value in dBm + 64
+    int8_t                             snr;   //!< Signed value in dB given in 0.25dB step
+    smtc_modem_event_downdata_window_t window;
+    uint8_t                            fport;
+    uint8_t                            fpending_bit;
+    uint32_t                           frequency_hz;
+    uint8_t                            datarate;
+} smtc_modem_downlink_view_t;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
@@ -564,6 +655,37 @@ typedef struct smtc_modem_event_s
 
 smtc_modem_return_code_t smtc_modem_get_event( smtc_modem_event_t* event, uint8_t* event_pending_count );
 
+/**
+ * @brief Get the oldest received downlink without copying it
+ *
+ * @remark The payload is read in place in the modem downlink fifo, it stays valid and is not overwritten by new
+ * downlinks until smtc_modem_release_downlink_data_view() is called. Downlinks received meanwhile are dropped if the
+ * fifo is full. The view must be released before smtc_modem_get_event() is called again.
+ *
+ * @remark A downlink released with smtc_modem_release_downlink_data_view() is not reported by
+ * smtc_modem_get_event(): the pending SMTC_MODEM_EVENT_DOWNDATA event only counts the downlinks left in the modem, and
+ * is removed once none is left.
+ *
+ * @param [out] view Payload and metadata of the downlink
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK            Command executed without errors
+ * @retval SMTC_MODEM_RC_INVALID       \p view is NULL
+ * @retval SMTC_MODEM_RC_FAIL          No downlink is available
+ * @retval SMTC_MODEM_RC_BUSY          Modem is currently in test mode
+ */
+smtc_modem_return_code_t smtc_modem_get_downlink_data_view( smtc_modem_downlink_view_t* view );
+
+/**
+ * @brief Release the downlink got with smtc_modem_get_downlink_data_view(), it is removed from the modem
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK            Command executed without errors
+ * @retval SMTC_MODEM_RC_FAIL          No downlink view is pending
+ * @retval SMTC_MODEM_RC_BUSY          Modem is currently in test mode
+ */
+smtc_modem_return_code_t smtc_modem_release_downlink_data_view( void );
+
 /**
  * @brief Get the modem firmware version
  *
@@ -646,6 +768,71 @@ smtc_modem_return_code_t smtc_modem_get_charge( uint32_t* charge_mah );
  */
 smtc_modem_return_code_t smtc_modem_reset_charge( void );
 
+/**
+ * @brief Get the radio planner timing statistics
+ *
+ * @remark The histograms are meant to tune the radio planner margin delay of a board from real data
+ *
+ * @param [out] timing_stats Radio planner timing statistics
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK            Command executed without errors
+ * @retval SMTC_MODEM_RC_INVALID       Parameter \p timing_stats is NULL
+ * @retval SMTC_MODEM_RC_BUSY          Modem is currently in test mode
+ */
+smtc_modem_return_code_t smtc_modem_get_rp_timing_stats( smtc_modem_rp_timing_stats_t* timing_stats );
+
+/**
+ * @brief Get the latest events of the radio planner timing trace, the oldest first
+ *
+ * @param [out] trace        Buffer receiving the trace entries
+ * @param [in]  trace_nb_max Maximum number of entries that can be written in \p trace
+ * @param [out] trace_nb     Number of entries written in \p trace
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK            Command executed without errors
+ * @retval SMTC_MODEM_RC_INVALID       Parameter \p trace or \p trace_nb is NULL
+ * @retval SMTC_MODEM_RC_BUSY          Modem is currently in test mode
+ */
+smtc_modem_return_code_t smtc_modem_get_rp_timing_trace( smtc_modem_rp_timing_trace_t* trace, uint8_t trace_nb_max,
+                                                         uint8_t* trace_nb );
+
+/**
+ * @brief Reset the radio planner timing statistics and trace
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK            Command executed without errors
+ * @retval SMTC_MODEM_RC_BUSY          Modem is currently in test mode
+ */
+smtc_modem_return_code_t smtc_modem_reset_rp_timing_stats( void );
+
+/**
+ * @brief Set the percentile of the measured radio launch latency covered by the radio planner margin
+ *
+ * The radio planner wakes up before each scheduled radio task by a margin delay. The margin is learnt from the latency
+ * between the planner timer expiry and the radio being ready, and never goes below the TCXO startup delay.
+ *
+ * @param [in] percentile Percentile in [1:100], 0 to use the fixed compile time margin
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK            Command executed without errors
+ * @retval SMTC_MODEM_RC_INVALID       \p percentile is greater than 100
+ * @retval SMTC_MODEM_RC_BUSY          Modem is currently in test mode
+ */
+smtc_modem_return_code_t smtc_modem_set_rp_margin_percentile( uint8_t percentile );
+
+/**
+ * @brief Get the margin delay currently used by the radio planner
+ *
+ * @param [out] margin_delay_ms Margin delay in ms
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK            Command executed without errors
+ * @retval SMTC_MODEM_RC_INVALID       \p margin_delay_ms is NULL
+ * @retval SMTC_MODEM_RC_BUSY          Modem is currently in test mode
+ */
+smtc_modem_return_code_t smtc_modem_get_rp_margin_delay_ms( uint32_t* margin_delay_ms );
+
 /**
  * @brief Get the Tx power offset in dB
  *
@@ -1384,6 +1571,9 @@ smtc_modem_return_code_t smtc_modem_get_next_tx_max_payload( uint8_t stack_id, u
 /**
  * @brief Request a LoRaWAN uplink
  *
+ * @remark The payload is copied and the uplink is queued behind the pending ones, up to MODEM_UPLINK_QUEUE_NB uplinks.
+ *         The queued uplinks are sent back-to-back as the duty cycle allows it, and each one ends with a
+ *         SMTC_MODEM_EVENT_TXDONE event.
  * @remark LoRaWAN NbTrans parameter can be set in mobile and custom ADR modes with @ref smtc_modem_set_nb_trans
  *
  * @param [in] stack_id       Stack identifier
@@ -1395,17 +1585,43 @@ smtc_modem_return_code_t smtc_modem_get_next_tx_max_payload( uint8_t stack_id, u
  * @return Modem return code as defined in @ref smtc_modem_return_code_t
  * @retval SMTC_MODEM_RC_OK                Command executed without errors
  * @retval SMTC_MODEM_RC_INVALID           \p fport is out of the [1:223] range or equal to the DM LoRaWAN FPort
- * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode
+ * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode, or the uplink queue is full
  * @retval SMTC_MODEM_RC_FAIL              Modem is not available (suspended, muted, or not joined)
  * @retval SMTC_MODEM_RC_INVALID_STACK_ID  Invalid \p stack_id
  */
 smtc_modem_return_code_t smtc_modem_request_uplink( uint8_t stack_id, uint8_t fport, bool confirmed,
                                                     const uint8_t* payload, uint8_t payload_length );
 
+/**
+ * @brief Request a LoRaWAN uplink that is dropped if it can't be sent in time
+ *
+ * @remark Same as @ref smtc_modem_request_uplink. If the uplink is still queued \p lifetime_s seconds after the
+ *         request, it is dropped and a SMTC_MODEM_EVENT_TXDONE event with SMTC_MODEM_EVENT_TXDONE_NOT_SENT status is
+ *         sent.
+ *
+ * @param [in] stack_id       Stack identifier
+ * @param [in] fport          LoRaWAN FPort on which the uplink is done
+ * @param [in] confirmed      Message type (true: confirmed, false: unconfirmed)
+ * @param [in] payload        Data to be sent
+ * @param [in] payload_length Number of bytes from payload to be sent
+ * @param [in] lifetime_s     Lifetime of the uplink in seconds, 0 to never drop it
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK                Command executed without errors
+ * @retval SMTC_MODEM_RC_INVALID           \p fport is out of the [1:223] range or equal to the DM LoRaWAN FPort
+ * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode, or the uplink queue is full
+ * @retval SMTC_MODEM_RC_FAIL              Modem is not available (suspended, muted, or not joined)
+ * @retval SMTC_MODEM_RC_INVALID_STACK_ID  Invalid \p stack_id
+ */
+smtc_modem_return_code_t smtc_modem_request_uplink_with_lifetime( uint8_t stack_id, uint8_t fport, bool confirmed,
+                                                                  const uint8_t* payload, uint8_t payload_length,
+                                                                  uint32_t lifetime_s );
+
 /**
  * @brief Request an immediate LoRaWAN uplink
  *
  * @remark It has higher priority than all other services and is not subject to duty cycle restrictions, if any
+ * @remark It is queued ahead of the pending uplinks requested with @ref smtc_modem_request_uplink
  * @remark LoRaWAN NbTrans parameter can be set in mobiles and custom ADR modes with @ref smtc_modem_set_nb_trans
  *
  * @param [in] stack_id       Stack identifier
@@ -1417,7 +1633,7 @@ smtc_modem_return_code_t smtc_modem_request_uplink( uint8_t stack_id, uint8_t fp
  * @return Modem return code as defined in @ref smtc_modem_return_code_t
  * @retval SMTC_MODEM_RC_OK                Command executed without errors
  * @retval SMTC_MODEM_RC_INVALID           \p fport is out of the [1:223] range or equal to the DM LoRaWAN FPort
- * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode
+ * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode, or the uplink queue is full
  * @retval SMTC_MODEM_RC_FAIL              Modem is not available (suspended, muted or not joined)
  * @retval SMTC_MODEM_RC_INVALID_STACK_ID  Invalid \p stack_id
  */
@@ -1437,7 +1653,7 @@ smtc_modem_return_code_t smtc_modem_request_emergency_uplink( uint8_t stack_id,
  * @return Modem return code as defined in @ref smtc_modem_return_code_t
  * @retval SMTC_MODEM_RC_OK                Command executed without errors
  * @retval SMTC_MODEM_RC_INVALID           \p fport is out of the [1:223] range or equal to the DM LoRaWAN FPort
- * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode
+ * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode, or the uplink queue is full
  * @retval SMTC_MODEM_RC_FAIL              Modem is not available (suspended, muted or not joined)
  * @retval SMTC_MODEM_RC_INVALID_STACK_ID  Invalid \p stack_id
  */
@@ -1466,6 +1682,33 @@ smtc_modem_return_code_t smtc_modem_file_upload_init( uint8_t stack_id, uint8_t
                                                       const uint8_t* file, uint16_t file_length,
                                                       uint32_t average_delay_s );
 
+/**
+ * @brief Create and initialize a file upload session, for a file read through a callback
+ *
+ * @remark The file is read once when the upload starts and again for each fragment sent, so it must stay readable
+ *         and unchanged until the end of the upload. The reader is called from the modem engine. If a fragment can't
+ *         be read, the upload is aborted with a SMTC_MODEM_EVENT_UPLOADDONE event with
+ *         SMTC_MODEM_EVENT_UPLOADDONE_ABORTED status.
+ *
+ * @param [in] stack_id        Stack identifier
+ * @param [in] index           Index on which the upload is done
+ * @param [in] cipher_mode     Cipher mode
+ * @param [in] read            Reader of the file
+ * @param [in] file_length     File size in bytes
+ * @param [in] average_delay_s Minimum delay between two file upload fragments in seconds (from the end of an uplink to
+ *                             the start of the next one)
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ * @retval SMTC_MODEM_RC_OK                Command executed without errors
+ * @retval SMTC_MODEM_RC_INVALID           \p file_length is equal to 0 or greater than 8180 bytes, or \p read is NULL
+ * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode, or a file upload is already ongoing
+ * @retval SMTC_MODEM_RC_INVALID_STACK_ID  Invalid \p stack_id
+ */
+smtc_modem_return_code_t smtc_modem_file_upload_init_with_reader( uint8_t stack_id, uint8_t index,
+                                                                  smtc_modem_file_upload_cipher_mode_t cipher_mode,
+                                                                  smtc_modem_file_upload_read_t read,
+                                                                  uint16_t file_length, uint32_t average_delay_s );
+
 /**
  * @brief Start the file upload session
  *
@@ -1474,7 +1717,8 @@ smtc_modem_return_code_t smtc_modem_file_upload_init( uint8_t stack_id, uint8_t
  * @return Modem return code as defined in @ref smtc_modem_return_code_t
  * @retval SMTC_MODEM_RC_OK                Command executed without errors
  * @retval SMTC_MODEM_RC_BUSY              Modem is currently in test mode, or a file upload is already ongoing
- * @retval SMTC_MODEM_RC_FAIL              Modem is not available (suspended, muted, or not joined)
+ * @retval SMTC_MODEM_RC_FAIL              Modem is not available (suspended, muted, or not joined), or the file
+ *                                         cannot be read
  * @retval SMTC_MODEM_RC_BAD_SIZE          Total data sent does not match the declared Size value in @ref
  *                                         smtc_modem_file_upload_init()
  * @retval SMTC_MODEM_RC_INVALID_STACK_ID  Invalid \p stack_id
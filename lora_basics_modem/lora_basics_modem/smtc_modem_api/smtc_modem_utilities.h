@@ -87,6 +87,16 @@ void smtc_modem_init( const ralf_t* radio, void ( *event_callback )( void ) );
  */
 uint32_t smtc_modem_run_engine( void );
 
+/**
+ * @brief Check if a radio or timer interrupt occurred since the last call to smtc_modem_run_engine()
+ * @remark The modem engine is not polled while it waits for the radio: this function must be called with the interrupts
+ * disabled, just before going to sleep. If it returns true, smtc_modem_run_engine() must be called again instead of
+ * sleeping
+ *
+ * @return true if smtc_modem_run_engine() must be called again now
+ */
+bool smtc_modem_is_irq_flag_pending( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,7 @@
 #include "modem_context.h"
 #include "smtc_modem_hal_dbg_trace.h"
 #include "smtc_modem_hal.h"
+#include "smtc_context_journal.h"
 #include "smtc_real.h"
 #include "device_management_defs.h"
 #include "lorawan_api.h"
@@ -504,6 +505,21 @@ void increment_asynchronous_msgnumber( uint8_t event_type, uint8_t status )
     increment_modem_event_count_and_status( event_type, status );
 }
 
+void remove_asynchronous_msg( uint8_t event_type )
+{
+    for( uint8_t i = 1; i <= asynchronous_msgnumber; i++ )
+    {
+        if( asynch_msg[i] == event_type )
+        {
+            // Keep the order of the other pending messages
+            memmove( &asynch_msg[i], &asynch_msg[i + 1], asynchronous_msgnumber - i );
+            asynchronous_msgnumber--;
+            break;
+        }
+    }
+    set_modem_event_count_and_status( event_type, 0, 0 );
+}
+
 uint8_t get_last_msg_event( void )
 {
     return asynch_msg[asynchronous_msgnumber];
@@ -660,30 +676,33 @@ void modem_supervisor_add_task_join( void )
     task_join.id       = JOIN_TASK;
     task_join.priority = TASK_HIGH_PRIORITY;
 
-    uint32_t current_time_s = smtc_modem_hal_get_time_in_s( );
-
-    task_join.time_to_execute_s = smtc_modem_hal_get_random_nb_in_range( 0, 5 );
+    uint32_t delay_s = smtc_modem_hal_get_random_nb_in_range( 0, 5 );
 
 #if defined( TEST_BYPASS_JOIN_DUTY_CYCLE )
     SMTC_MODEM_HAL_TRACE_WARNING( "BYPASS JOIN DUTY CYCLE activated\n" );
-    task_join.time_to_execute_s += current_time_s;
 #else
     if( lorawan_api_modem_certification_is_enabled( ) == false )
     {
         // current time is already taken in count in lr1mac time computation
-        task_join.time_to_execute_s += lorawan_api_next_join_time_second_get( );
+        int32_t join_delay_s =
+            ( int32_t )( lorawan_api_next_join_time_second_get( ) + delay_s - smtc_modem_hal_get_time_in_s( ) );
+        delay_s = ( join_delay_s > 0 ) ? ( uint32_t ) join_delay_s : 0;
+    }
+    else
+    {
+        delay_s = 0;
     }
 #endif
 
-    if( ( int32_t )( task_join.time_to_execute_s - current_time_s ) <= 0 )
+    if( delay_s == 0 )
     {
         SMTC_MODEM_HAL_TRACE_PRINTF( " Start a new join sequence now \n" );
     }
     else
     {
-        SMTC_MODEM_HAL_TRACE_PRINTF( " Start a new join sequence in %d seconds \n",
-                                     task_join.time_to_execute_s - current_time_s );
+        SMTC_MODEM_HAL_TRACE_PRINTF( " Start a new join sequence in %d seconds \n", delay_s );
     }
+    modem_supervisor_set_task_delay( &task_join, delay_s, 0 );
 
     set_modem_status_joining( true );
     modem_supervisor_add_task( &task_join );
@@ -692,10 +711,10 @@ void modem_supervisor_add_task_join( void )
 void modem_supervisor_add_task_dm_status( uint32_t next_execute )
 {
     smodem_task task_dm;
-    task_dm.id                = DM_TASK;
-    task_dm.priority          = TASK_LOW_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + next_execute;
+    task_dm.id         = DM_TASK;
+    task_dm.priority   = TASK_LOW_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay( &task_dm, next_execute, 0 );
     if( get_join_state( ) == MODEM_JOINED )
     {
         modem_supervisor_add_task( &task_dm );
@@ -705,21 +724,22 @@ void modem_supervisor_add_task_dm_status( uint32_t next_execute )
 void modem_supervisor_add_task_dm_status_now( void )
 {
     smodem_task task_dm;
-    task_dm.id                = DM_TASK_NOW;
-    task_dm.priority          = TASK_LOW_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) +
-                                smtc_modem_hal_get_random_nb_in_range( DM_STATUS_NOW_MIN_TIME, DM_STATUS_NOW_MAX_TIME );
+    task_dm.id         = DM_TASK_NOW;
+    task_dm.priority   = TASK_LOW_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay(
+        &task_dm, smtc_modem_hal_get_random_nb_in_range( DM_STATUS_NOW_MIN_TIME, DM_STATUS_NOW_MAX_TIME ), 0 );
     modem_supervisor_add_task( &task_dm );
 }
 void modem_supervisor_add_task_crash_log( uint32_t next_execute )
 {
     smodem_task task_dm;
-    task_dm.id                = CRASH_LOG_TASK;
-    task_dm.priority          = TASK_LOW_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + next_execute +
-                                smtc_modem_hal_get_random_nb_in_range( DM_STATUS_NOW_MIN_TIME, DM_STATUS_NOW_MAX_TIME );
+    task_dm.id         = CRASH_LOG_TASK;
+    task_dm.priority   = TASK_LOW_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay(
+        &task_dm,
+        next_execute + smtc_modem_hal_get_random_nb_in_range( DM_STATUS_NOW_MIN_TIME, DM_STATUS_NOW_MAX_TIME ), 0 );
     modem_supervisor_add_task( &task_dm );
 }
 
@@ -727,10 +747,10 @@ void modem_supervisor_add_task_crash_log( uint32_t next_execute )
 void modem_supervisor_add_task_clock_sync_time_req( uint32_t next_execute )
 {
     smodem_task task_dm;
-    task_dm.id                = CLOCK_SYNC_TIME_REQ_TASK;
-    task_dm.priority          = TASK_HIGH_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + next_execute;
+    task_dm.id         = CLOCK_SYNC_TIME_REQ_TASK;
+    task_dm.priority   = TASK_HIGH_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay( &task_dm, next_execute, 0 );
 
     modem_supervisor_add_task( &task_dm );
 }
@@ -760,10 +780,10 @@ bool modem_supervisor_is_clock_sync_running( void )
 void modem_supervisor_add_task_alc_sync_ans( uint32_t next_execute )
 {
     smodem_task task_dm;
-    task_dm.id                = ALC_SYNC_ANS_TASK;
-    task_dm.priority          = TASK_HIGH_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + next_execute;
+    task_dm.id         = ALC_SYNC_ANS_TASK;
+    task_dm.priority   = TASK_HIGH_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay( &task_dm, next_execute, 0 );
     if( get_join_state( ) == MODEM_JOINED )
     {
         modem_supervisor_add_task( &task_dm );
@@ -774,10 +794,10 @@ void modem_supervisor_add_task_alc_sync_ans( uint32_t next_execute )
 void modem_supervisor_add_task_alm_dbg_ans( uint32_t next_execute )
 {
     smodem_task task_dm;
-    task_dm.id                = DM_ALM_DBG_ANS;
-    task_dm.priority          = TASK_HIGH_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + next_execute;
+    task_dm.id         = DM_ALM_DBG_ANS;
+    task_dm.priority   = TASK_HIGH_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay( &task_dm, next_execute, 0 );
     if( get_join_state( ) == MODEM_JOINED )
     {
         modem_supervisor_add_task( &task_dm );
@@ -787,20 +807,20 @@ void modem_supervisor_add_task_alm_dbg_ans( uint32_t next_execute )
 void modem_supervisor_add_task_modem_mute( void )
 {
     smodem_task task_dm;
-    task_dm.id                = MUTE_TASK;
-    task_dm.priority          = TASK_MEDIUM_HIGH_PRIORITY;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + 86400;  // Every 24h
+    task_dm.id       = MUTE_TASK;
+    task_dm.priority = TASK_MEDIUM_HIGH_PRIORITY;
+    modem_supervisor_set_task_delay( &task_dm, 86400, 0 );  // Every 24h
     modem_supervisor_add_task( &task_dm );
 }
 
 void modem_supervisor_add_task_retrieve_dl( uint32_t next_execute )
 {
     smodem_task task_dm;
-    task_dm.id                = RETRIEVE_DL_TASK;
-    task_dm.priority          = TASK_LOW_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.sizeIn            = 0;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + next_execute;
+    task_dm.id         = RETRIEVE_DL_TASK;
+    task_dm.priority   = TASK_LOW_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    task_dm.sizeIn     = 0;
+    modem_supervisor_set_task_delay( &task_dm, next_execute, 0 );
     if( get_join_state( ) == MODEM_JOINED )
     {
         modem_supervisor_add_task( &task_dm );
@@ -810,10 +830,10 @@ void modem_supervisor_add_task_retrieve_dl( uint32_t next_execute )
 void modem_supervisor_add_task_frag( uint32_t next_execute )
 {
     smodem_task task_dm;
-    task_dm.id                = FRAG_TASK;
-    task_dm.priority          = TASK_HIGH_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + next_execute;
+    task_dm.id         = FRAG_TASK;
+    task_dm.priority   = TASK_HIGH_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay( &task_dm, next_execute, 0 );
     if( get_join_state( ) == MODEM_JOINED )
     {
         modem_supervisor_add_task( &task_dm );
@@ -827,11 +847,11 @@ void modem_supervisor_add_task_stream( void )
     // so this is safe even when it is going to be invalidated.
     smodem_task stream_task;
 
-    stream_task.id                = STREAM_TASK;
-    stream_task.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + smtc_modem_hal_get_random_nb_in_range( 1, 3 );
-    stream_task.priority          = TASK_HIGH_PRIORITY;
-    stream_task.fPort             = modem_get_stream_port( );
-    stream_task.fPort_present     = true;
+    stream_task.id = STREAM_TASK;
+    modem_supervisor_set_task_delay( &stream_task, smtc_modem_hal_get_random_nb_in_range( 1, 3 ), 0 );
+    stream_task.priority      = TASK_HIGH_PRIORITY;
+    stream_task.fPort         = modem_get_stream_port( );
+    stream_task.fPort_present = true;
     // stream_task.dataIn        not used in task
     // stream_task.sizeIn        not used in task
     // stream_task.PacketType    not used in task
@@ -846,9 +866,9 @@ void modem_supervisor_add_task_file_upload( uint32_t delay_in_s )
 {
     smodem_task upload_task;
 
-    upload_task.id                = FILE_UPLOAD_TASK;
-    upload_task.priority          = TASK_HIGH_PRIORITY;
-    upload_task.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + delay_in_s;
+    upload_task.id       = FILE_UPLOAD_TASK;
+    upload_task.priority = TASK_HIGH_PRIORITY;
+    modem_supervisor_set_task_delay( &upload_task, delay_in_s, 0 );
 
     modem_supervisor_add_task( &upload_task );
 }
@@ -857,10 +877,10 @@ void modem_supervisor_add_task_file_upload( uint32_t delay_in_s )
 void modem_supervisor_add_task_link_check_req( uint32_t delay_in_s )
 {
     smodem_task task_dm;
-    task_dm.id                = LINK_CHECK_REQ_TASK;
-    task_dm.priority          = TASK_HIGH_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + delay_in_s;
+    task_dm.id         = LINK_CHECK_REQ_TASK;
+    task_dm.priority   = TASK_HIGH_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay( &task_dm, delay_in_s, 0 );
     if( get_join_state( ) == MODEM_JOINED )
     {
         modem_supervisor_add_task( &task_dm );
@@ -870,10 +890,10 @@ void modem_supervisor_add_task_link_check_req( uint32_t delay_in_s )
 void modem_supervisor_add_task_device_time_req( uint32_t delay_in_s )
 {
     smodem_task task_dm;
-    task_dm.id                = DEVICE_TIME_REQ_TASK;
-    task_dm.priority          = TASK_HIGH_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + delay_in_s;
+    task_dm.id         = DEVICE_TIME_REQ_TASK;
+    task_dm.priority   = TASK_HIGH_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay( &task_dm, delay_in_s, 0 );
     if( get_join_state( ) == MODEM_JOINED )
     {
         modem_supervisor_add_task( &task_dm );
@@ -883,10 +903,10 @@ void modem_supervisor_add_task_device_time_req( uint32_t delay_in_s )
 void modem_supervisor_add_task_ping_slot_info_req( uint32_t delay_in_s )
 {
     smodem_task task_dm;
-    task_dm.id                = PING_SLOT_INFO_REQ_TASK;
-    task_dm.priority          = TASK_HIGH_PRIORITY;
-    task_dm.PacketType        = UNCONF_DATA_UP;
-    task_dm.time_to_execute_s = smtc_modem_hal_get_time_in_s( ) + delay_in_s;
+    task_dm.id         = PING_SLOT_INFO_REQ_TASK;
+    task_dm.priority   = TASK_HIGH_PRIORITY;
+    task_dm.PacketType = UNCONF_DATA_UP;
+    modem_supervisor_set_task_delay( &task_dm, delay_in_s, 0 );
     if( get_join_state( ) == MODEM_JOINED )
     {
         modem_supervisor_add_task( &task_dm );
@@ -1665,7 +1685,7 @@ void modem_store_context( void )
     };
 
     ctx.crc = crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 );
-    smtc_modem_hal_context_store( CONTEXT_MODEM, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    smtc_context_journal_store( CONTEXT_MODEM, ( uint8_t* ) &ctx, sizeof( ctx ) );
     modem_load_context( );
 }
 
@@ -1678,7 +1698,7 @@ void modem_load_context( void )
 {
     modem_context_nvm_t ctx;
 
-    smtc_modem_hal_context_restore( CONTEXT_MODEM, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    smtc_context_journal_restore( CONTEXT_MODEM, ( uint8_t* ) &ctx, sizeof( ctx ) );
 
     if( crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 ) == ctx.crc )
     {
@@ -1710,10 +1730,7 @@ void modem_context_factory_reset( void )
     };
 
     ctx.crc = crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 );
-    smtc_modem_hal_context_store( CONTEXT_MODEM, ( uint8_t* ) &ctx, sizeof( ctx ) );
-
-    // dummy context reading to ensure context store is done before exiting the function
-    smtc_modem_hal_context_restore( CONTEXT_LR1MAC, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    smtc_context_journal_store( CONTEXT_MODEM, ( uint8_t* ) &ctx, sizeof( ctx ) );
 
     is_modem_reset_requested = true;
     SMTC_MODEM_HAL_TRACE_INFO( "modem_context_factory_reset done\n" );
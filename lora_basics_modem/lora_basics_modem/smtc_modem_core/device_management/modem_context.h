@@ -182,6 +182,13 @@ void increment_asynchronous_msgnumber( uint8_t event_type, uint8_t status );
  */
 uint8_t get_last_msg_event( void );
 
+/*!
+ * \brief remove a pending asynchronous message and reset its counter
+ *
+ * \param [in] event_type type of asynchronous message
+ */
+void remove_asynchronous_msg( uint8_t event_type );
+
 /*!
  * \brief get asynchronous message number
  *
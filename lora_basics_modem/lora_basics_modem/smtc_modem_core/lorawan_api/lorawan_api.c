@@ -81,7 +81,10 @@ static struct
     lorawan_certification_t lorawan_certif_obj;
 } lr1mac_core_context;
 
+// Downlinks are stored contiguously with their metadata, the fifo is sized in bytes
+#ifndef FIFO_LORAWAN_SIZE
 #define FIFO_LORAWAN_SIZE 512
+#endif
 uint8_t fifo_buffer[FIFO_LORAWAN_SIZE];
 
 #define lr1_mac_obj lr1mac_core_context.lr1_mac_obj
@@ -190,8 +193,14 @@ void lorawan_api_class_c_downlink_callback( lr1mac_class_c_t* class_c_object )
     if( modem_supervisor_update_downlink_frame( class_c_object->rx_payload, class_c_object->rx_payload_size,
                                                 &( class_c_object->rx_metadata ), class_c_object->tx_ack_bit ) )
     {
-        if( fifo_ctrl_set( &fifo_ctrl_obj, class_c_object->rx_payload, class_c_object->rx_payload_size,
-                           &( class_c_object->rx_metadata ), sizeof( lr1mac_down_metadata_t ) ) != FIFO_STATUS_OK )
+        fifo_return_status_t fifo_status =
+            fifo_ctrl_set( &fifo_ctrl_obj, class_c_object->rx_payload, class_c_object->rx_payload_size,
+                           &( class_c_object->rx_metadata ), sizeof( lr1mac_down_metadata_t ) );
+        if( fifo_status == FIFO_STATUS_BUFFER_BORROWED )
+        {
+            SMTC_MODEM_HAL_TRACE_WARNING( "Fifo borrowed, downlink dropped\n" );
+        }
+        else if( fifo_status != FIFO_STATUS_OK )
         {
             smtc_modem_hal_mcu_panic( "Fifo problem\n" );
             return;
@@ -207,8 +216,14 @@ void lorawan_api_class_b_downlink_callback( smtc_ping_slot_t* class_b_object )
     if( modem_supervisor_update_downlink_frame( class_b_object->rx_payload, class_b_object->rx_payload_size,
                                                 &( class_b_object->rx_metadata ), class_b_object->tx_ack_bit ) )
     {
-        if( fifo_ctrl_set( &fifo_ctrl_obj, class_b_object->rx_payload, class_b_object->rx_payload_size,
-                           &( class_b_object->rx_metadata ), sizeof( lr1mac_down_metadata_t ) ) != FIFO_STATUS_OK )
+        fifo_return_status_t fifo_status =
+            fifo_ctrl_set( &fifo_ctrl_obj, class_b_object->rx_payload, class_b_object->rx_payload_size,
+                           &( class_b_object->rx_metadata ), sizeof( lr1mac_down_metadata_t ) );
+        if( fifo_status == FIFO_STATUS_BUFFER_BORROWED )
+        {
+            SMTC_MODEM_HAL_TRACE_WARNING( "Fifo borrowed, downlink dropped\n" );
+        }
+        else if( fifo_status != FIFO_STATUS_OK )
         {
             smtc_modem_hal_mcu_panic( "Fifo problem\n" );
             return;
@@ -226,10 +241,15 @@ void lorawan_api_class_b_beacon_callback( smtc_lr1_beacon_t* class_b_beacon_obje
                                                 class_b_beacon_object->beacon_buffer_length,
                                                 &( class_b_beacon_object->beacon_metadata.rx_metadata ), 0 ) )
     {
-        if( fifo_ctrl_set( &fifo_ctrl_obj, class_b_beacon_object->beacon_buffer,
+        fifo_return_status_t fifo_status =
+            fifo_ctrl_set( &fifo_ctrl_obj, class_b_beacon_object->beacon_buffer,
                            class_b_beacon_object->beacon_buffer_length,
-                           &( class_b_beacon_object->beacon_metadata.rx_metadata ),
-                           sizeof( lr1mac_down_metadata_t ) ) != FIFO_STATUS_OK )
+                           &( class_b_beacon_object->beacon_metadata.rx_metadata ), sizeof( lr1mac_down_metadata_t ) );
+        if( fifo_status == FIFO_STATUS_BUFFER_BORROWED )
+        {
+            SMTC_MODEM_HAL_TRACE_WARNING( "Fifo borrowed, downlink dropped\n" );
+        }
+        else if( fifo_status != FIFO_STATUS_OK )
         {
             smtc_modem_hal_mcu_panic( "Fifo problem\n" );
             return;
@@ -315,6 +335,11 @@ lr1mac_states_t lorawan_api_process( void )
     return lr1mac_core_process( &lr1_mac_obj );
 }
 
+uint32_t lorawan_api_next_process_delay_ms_get( void )
+{
+    return lr1mac_core_next_process_delay_ms_get( &lr1_mac_obj );
+}
+
 void lorawan_api_context_load( void )
 {
     lr1mac_core_context_load( &lr1_mac_obj );
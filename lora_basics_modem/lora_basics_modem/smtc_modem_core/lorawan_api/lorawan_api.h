@@ -209,6 +209,13 @@ void lorawan_api_dr_custom_set( uint32_t* custom_dr );
  */
 lr1mac_states_t lorawan_api_process( void );
 
+/**
+ * @brief Returns the delay before lorawan_api_process() has something to do without a radio planner event
+ *
+ * @return uint32_t 0 if the process has to be called now, else the delay in ms
+ */
+uint32_t lorawan_api_next_process_delay_ms_get( void );
+
 /**
  * @brief Reload the LoraWAN context saved in the flash
  */
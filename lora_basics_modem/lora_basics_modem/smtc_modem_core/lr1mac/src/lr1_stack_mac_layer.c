@@ -239,6 +239,7 @@ void lr1_stack_mac_tx_lora_launch_callback_for_rp( void* rp_void )
     smtc_modem_hal_assert( ral_set_dio_irq_params( &( rp->radio->ral ), RAL_IRQ_TX_DONE ) == RAL_STATUS_OK );
     smtc_modem_hal_assert( ral_set_pkt_payload( &( rp->radio->ral ), rp->payload[id], rp->payload_size[id] ) ==
                            RAL_STATUS_OK );
+    rp_task_radio_ready( rp );
     // Wait the exact expected time (ie target - tcxo startup delay)
     while( ( int32_t )( rp->tasks[id].start_time_ms - smtc_modem_hal_get_time_in_ms( ) ) > 0 )
     {
@@ -259,6 +260,7 @@ void lr1_stack_mac_tx_gfsk_launch_callback_for_rp( void* rp_void )
     smtc_modem_hal_assert( ral_set_dio_irq_params( &( rp->radio->ral ), RAL_IRQ_TX_DONE ) == RAL_STATUS_OK );
     smtc_modem_hal_assert( ral_set_pkt_payload( &( rp->radio->ral ), rp->payload[id], rp->payload_size[id] ) ==
                            RAL_STATUS_OK );
+    rp_task_radio_ready( rp );
     // Wait the exact expected time (ie target - tcxo startup delay)
     while( ( int32_t )( rp->tasks[id].start_time_ms - smtc_modem_hal_get_time_in_ms( ) ) > 0 )
     {
@@ -287,6 +289,7 @@ void lr1_stack_mac_tx_lr_fhss_launch_callback_for_rp( void* rp_void )
                                                     ( ral_lr_fhss_memory_state_t ) rp->radio_params[id].lr_fhss_state,
                                                     rp->radio_params[id].tx.lr_fhss.hop_sequence_id, rp->payload[id],
                                                     rp->payload_size[id] ) == RAL_STATUS_OK );
+    rp_task_radio_ready( rp );
     // Wait the exact expected time (ie target - tcxo startup delay)
     while( ( int32_t )( rp->tasks[id].start_time_ms - smtc_modem_hal_get_time_in_ms( ) ) > 0 )
     {
@@ -307,6 +310,7 @@ void lr1_stack_mac_rx_lora_launch_callback_for_rp( void* rp_void )
     smtc_modem_hal_assert( ral_set_dio_irq_params( &( rp->radio->ral ), RAL_IRQ_RX_DONE | RAL_IRQ_RX_TIMEOUT |
                                                                             RAL_IRQ_RX_HDR_ERROR |
                                                                             RAL_IRQ_RX_CRC_ERROR ) == RAL_STATUS_OK );
+    rp_task_radio_ready( rp );
     // Wait the exact expected time (ie target - tcxo startup delay)
     while( ( int32_t )( rp->tasks[id].start_time_ms - smtc_modem_hal_get_time_in_ms( ) ) > 0 )
     {
@@ -325,6 +329,7 @@ void lr1_stack_mac_rx_gfsk_launch_callback_for_rp( void* rp_void )
     smtc_modem_hal_assert( ralf_setup_gfsk( rp->radio, &rp->radio_params[id].rx.gfsk ) == RAL_STATUS_OK );
     smtc_modem_hal_assert( ral_set_dio_irq_params( &( rp->radio->ral ), RAL_IRQ_RX_DONE | RAL_IRQ_RX_TIMEOUT |
                                                                             RAL_IRQ_RX_CRC_ERROR ) == RAL_STATUS_OK );
+    rp_task_radio_ready( rp );
     // Wait the exact expected time (ie target - tcxo startup delay)
     while( ( int32_t )( rp->tasks[id].start_time_ms - smtc_modem_hal_get_time_in_ms( ) ) > 0 )
     {
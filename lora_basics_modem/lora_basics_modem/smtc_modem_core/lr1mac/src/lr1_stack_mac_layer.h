@@ -194,7 +194,7 @@ typedef struct lr1_stack_mac_s
     uint32_t               isr_tx_done_radio_timestamp;
     int16_t                fine_tune_board_setting_delay_ms[16];
     int32_t                rx_offset_ms;
-    uint32_t               timestamp_failsafe;
+    uint32_t               timestamp_failsafe_ms;
     uint8_t                type_of_ans_to_send;
     uint8_t                nwk_payload_index;
     lr1mac_states_t        lr1mac_state;
@@ -42,6 +42,7 @@
 #include "smtc_modem_hal_dbg_trace.h"
 #include "lr1mac_utilities.h"
 #include "smtc_modem_hal.h"
+#include "smtc_context_journal.h"
 #include "smtc_real.h"
 #include "smtc_real_defs.h"
 #include "smtc_real_defs_str.h"
@@ -65,7 +66,7 @@
  * -----------------------------------------------------------------------------
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
-#define FAILSAFE_DURATION 300U
+#define FAILSAFE_DURATION_MS 300000U
 
 #if( MODEM_HAL_DBG_TRACE == MODEM_HAL_FEATURE_ON )
 static const char* smtc_name_bw[]         = { "BW007", "BW010", "BW015", "BW020", "BW031", "BW041", "BW062",
@@ -198,8 +199,8 @@ lr1mac_states_t lr1mac_core_process( lr1_stack_mac_t* lr1_mac_obj )
 #endif
 
     if( ( lr1_mac_obj->lr1mac_state != LWPSTATE_IDLE ) &&
-        ( ( int32_t )( smtc_modem_hal_get_time_in_s( ) - failsafe_timstamp_get( lr1_mac_obj ) - FAILSAFE_DURATION ) >
-          0 ) )
+        ( ( int32_t )( smtc_modem_hal_get_time_in_ms( ) - failsafe_timstamp_get( lr1_mac_obj ) -
+                       FAILSAFE_DURATION_MS ) > 0 ) )
     {
         smtc_modem_hal_lr1mac_panic( "FAILSAFE EVENT OCCUR (lr1mac_state:0x%x)\n", lr1_mac_obj->lr1mac_state );
         lr1_mac_obj->lr1mac_state = LWPSTATE_ERROR;
@@ -377,6 +378,47 @@ lr1mac_states_t lr1mac_core_process( lr1_stack_mac_t* lr1_mac_obj )
     return ( lr1_mac_obj->lr1mac_state );
 }
 
+uint32_t lr1mac_core_next_process_delay_ms_get( lr1_stack_mac_t* lr1_mac_obj )
+{
+    int32_t delay_ms;
+
+    if( lr1_mac_obj->radio_process_state == RADIOSTATE_ABORTED_BY_RP )
+    {
+        return 0;
+    }
+
+    switch( lr1_mac_obj->lr1mac_state )
+    {
+    case LWPSTATE_SEND:
+        if( ( lr1_mac_obj->radio_process_state == RADIOSTATE_IDLE ) ||
+            ( lr1_mac_obj->radio_process_state == RADIOSTATE_TX_FINISHED ) )
+        {
+            return 0;
+        }
+        break;
+
+    case LWPSTATE_RX1:
+    case LWPSTATE_RX2:
+        if( lr1_mac_obj->radio_process_state == RADIOSTATE_RX_FINISHED )
+        {
+            return 0;
+        }
+        break;
+
+    case LWPSTATE_TX_WAIT:
+        delay_ms = ( int32_t )( lr1_mac_obj->rtc_target_timer_ms - smtc_modem_hal_get_time_in_ms( ) ) + 1;
+        return ( delay_ms > 0 ) ? ( uint32_t ) delay_ms : 0;
+
+    default:
+        return 0;
+    }
+
+    // Waiting for a radio planner event, up to the failsafe
+    delay_ms = ( int32_t )( failsafe_timstamp_get( lr1_mac_obj ) + FAILSAFE_DURATION_MS + 1 -
+                            smtc_modem_hal_get_time_in_ms( ) );
+    return ( delay_ms > 0 ) ? ( uint32_t ) delay_ms : 0;
+}
+
 /***********************************************************************************************/
 /*    End Of LoraWanProcess Method                                                             */
 /***********************************************************************************************/
@@ -396,10 +438,10 @@ status_lorawan_t lr1mac_core_join( lr1_stack_mac_t* lr1_mac_obj, uint32_t target
         SMTC_MODEM_HAL_TRACE_ERROR( "ABP DEVICE CAN'T PROCCED A JOIN REQUEST\n" );
         return ERRORLORAWAN;
     }
-    uint32_t current_timestamp       = smtc_modem_hal_get_time_in_s( );
-    lr1_mac_obj->timestamp_failsafe  = current_timestamp;
-    lr1_mac_obj->rtc_target_timer_ms = target_time_ms;
-    lr1_mac_obj->join_status         = JOINING;
+    uint32_t current_timestamp         = smtc_modem_hal_get_time_in_s( );
+    lr1_mac_obj->timestamp_failsafe_ms = smtc_modem_hal_get_time_in_ms( );
+    lr1_mac_obj->rtc_target_timer_ms   = target_time_ms;
+    lr1_mac_obj->join_status           = JOINING;
 
     smtc_real_init( lr1_mac_obj );
 
@@ -576,12 +618,12 @@ status_lorawan_t lr1mac_core_payload_send( lr1_stack_mac_t* lr1_mac_obj, uint8_t
         return ERRORLORAWAN;
     }
 
-    lr1_mac_obj->timestamp_failsafe  = smtc_modem_hal_get_time_in_s( );
-    lr1_mac_obj->rtc_target_timer_ms = target_time_ms;
-    lr1_mac_obj->app_payload_size    = size_in;
-    lr1_mac_obj->tx_fport            = fport;
-    lr1_mac_obj->tx_fport_present    = fport_enabled;
-    lr1_mac_obj->tx_mtype            = packet_type;
+    lr1_mac_obj->timestamp_failsafe_ms = smtc_modem_hal_get_time_in_ms( );
+    lr1_mac_obj->rtc_target_timer_ms   = target_time_ms;
+    lr1_mac_obj->app_payload_size      = size_in;
+    lr1_mac_obj->tx_fport              = fport;
+    lr1_mac_obj->tx_fport_present      = fport_enabled;
+    lr1_mac_obj->tx_mtype              = packet_type;
     // Because Network payload are sent unconfirmed, we have to keep the Rx ACK bit for the App layer
     lr1_mac_obj->rx_ack_bit = 0;
 
@@ -687,13 +729,8 @@ void lr1mac_core_context_save( lr1_stack_mac_t* lr1_mac_obj )
         lr1_mac_obj->mac_context.crc =
             lr1mac_utilities_crc( ( uint8_t* ) &( lr1_mac_obj->mac_context ), sizeof( lr1_mac_obj->mac_context ) - 4 );
 
-        smtc_modem_hal_context_store( CONTEXT_LR1MAC, ( uint8_t* ) &( lr1_mac_obj->mac_context ),
-                                      sizeof( lr1_mac_obj->mac_context ) );
-
-        // dummy context reading to ensure context store is done before exiting the function
-        mac_context_t dummy_context = { 0 };
-        smtc_modem_hal_context_restore( CONTEXT_LR1MAC, ( uint8_t* ) &dummy_context,
-                                        sizeof( lr1_mac_obj->mac_context ) );
+        smtc_context_journal_store( CONTEXT_LR1MAC, ( uint8_t* ) &( lr1_mac_obj->mac_context ),
+                                    sizeof( lr1_mac_obj->mac_context ) );
     }
 }
 /**************************************************/
@@ -726,12 +763,8 @@ void lr1mac_core_factory_reset( lr1_stack_mac_t* lr1_mac_obj )
     lr1_mac_obj->mac_context.crc =
         lr1mac_utilities_crc( ( uint8_t* ) &( lr1_mac_obj->mac_context ), sizeof( lr1_mac_obj->mac_context ) - 4 ) + 1;
 
-    smtc_modem_hal_context_store( CONTEXT_LR1MAC, ( uint8_t* ) &( lr1_mac_obj->mac_context ),
-                                  sizeof( lr1_mac_obj->mac_context ) );
-
-    // dummy context reading to ensure context store is done before exiting the function
-    mac_context_t dummy_context = { 0 };
-    smtc_modem_hal_context_restore( CONTEXT_LR1MAC, ( uint8_t* ) &dummy_context, sizeof( lr1_mac_obj->mac_context ) );
+    smtc_context_journal_store( CONTEXT_LR1MAC, ( uint8_t* ) &( lr1_mac_obj->mac_context ),
+                                sizeof( lr1_mac_obj->mac_context ) );
 }
 
 lr1mac_activation_mode_t lr1mac_core_get_activation_mode( lr1_stack_mac_t* lr1_mac_obj )
@@ -771,8 +804,8 @@ int16_t lr1mac_core_last_rssi_get( lr1_stack_mac_t* lr1_mac_obj )
 
 status_lorawan_t lr1mac_core_context_load( lr1_stack_mac_t* lr1_mac_obj )
 {
-    smtc_modem_hal_context_restore( CONTEXT_LR1MAC, ( uint8_t* ) &( lr1_mac_obj->mac_context ),
-                                    sizeof( lr1_mac_obj->mac_context ) );
+    smtc_context_journal_restore( CONTEXT_LR1MAC, ( uint8_t* ) &( lr1_mac_obj->mac_context ),
+                                  sizeof( lr1_mac_obj->mac_context ) );
 
     if( lr1mac_utilities_crc( ( uint8_t* ) &( lr1_mac_obj->mac_context ), sizeof( lr1_mac_obj->mac_context ) - 4 ) ==
         lr1_mac_obj->mac_context.crc )
@@ -1131,7 +1164,7 @@ static void copy_user_payload( lr1_stack_mac_t* lr1_mac_obj, const uint8_t* data
 
 static uint32_t failsafe_timstamp_get( lr1_stack_mac_t* lr1_mac_obj )
 {
-    return lr1_mac_obj->timestamp_failsafe;
+    return lr1_mac_obj->timestamp_failsafe_ms;
 }
 
 static rp_status_t rp_status_get( lr1_stack_mac_t* lr1_mac_obj )
@@ -1228,21 +1261,31 @@ static void save_devnonce_rst( const lr1_stack_mac_t* lr1_mac_obj )
 {
     lr1_counter_context_t ctx = { 0 };
 
-    ctx.devnonce = lr1_mac_obj->dev_nonce;
+    // The saved DevNonce is the last one that may have been used: it is only saved again once reached, or with a new
+    // number of reset or JoinNonce
+    smtc_context_journal_restore( CONTEXT_DEVNONCE, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    if( ( lr1mac_utilities_crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 ) == ctx.crc ) &&
+        ( lr1_mac_obj->dev_nonce <= ctx.devnonce ) && ( lr1_mac_obj->nb_of_reset == ctx.nb_reset ) &&
+        ( memcmp( lr1_mac_obj->join_nonce, ctx.join_nonce, sizeof( ctx.join_nonce ) ) == 0 ) )
+    {
+        return;
+    }
+
+    memset( &ctx, 0, sizeof( ctx ) );
+    ctx.devnonce = ( lr1_mac_obj->dev_nonce < ( 0xFFFF - ( SMTC_LR1MAC_DEVNONCE_SAVE_PERIOD - 1 ) ) )
+                       ? ( lr1_mac_obj->dev_nonce + ( SMTC_LR1MAC_DEVNONCE_SAVE_PERIOD - 1 ) )
+                       : 0xFFFF;
     ctx.nb_reset = lr1_mac_obj->nb_of_reset;
     memcpy( ctx.join_nonce, lr1_mac_obj->join_nonce, sizeof( ctx.join_nonce ) );
     ctx.crc = lr1mac_utilities_crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 );
 
-    smtc_modem_hal_context_store( CONTEXT_DEVNONCE, ( uint8_t* ) &ctx, sizeof( ctx ) );
-    // dummy context reading to ensure context store is done before exiting the function
-    lr1_counter_context_t dummy_context = { 0 };
-    smtc_modem_hal_context_restore( CONTEXT_DEVNONCE, ( uint8_t* ) &dummy_context, sizeof( dummy_context ) );
+    smtc_context_journal_store( CONTEXT_DEVNONCE, ( uint8_t* ) &ctx, sizeof( ctx ) );
 }
 
 static void load_devnonce_reset( lr1_stack_mac_t* lr1_mac_obj )
 {
     lr1_counter_context_t ctx = { 0 };
-    smtc_modem_hal_context_restore( CONTEXT_DEVNONCE, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    smtc_context_journal_restore( CONTEXT_DEVNONCE, ( uint8_t* ) &ctx, sizeof( ctx ) );
 
     if( lr1mac_utilities_crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 ) == ctx.crc )
     {
@@ -1274,7 +1317,7 @@ static void try_recover_nvm( lr1_stack_mac_t* lr1_mac_obj )
 
     mac_context_010007_t old_save_fmt;
 
-    smtc_modem_hal_context_restore( CONTEXT_LR1MAC, ( uint8_t* ) &old_save_fmt, sizeof( old_save_fmt ) );
+    smtc_context_journal_restore( CONTEXT_LR1MAC, ( uint8_t* ) &old_save_fmt, sizeof( old_save_fmt ) );
 
     if( lr1mac_utilities_crc( ( uint8_t* ) &( old_save_fmt ), sizeof( old_save_fmt ) - 4 ) == old_save_fmt.crc )
     {
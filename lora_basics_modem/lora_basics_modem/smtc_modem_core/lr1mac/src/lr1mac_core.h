@@ -140,6 +140,15 @@ void lr1mac_core_dr_custom_set( lr1_stack_mac_t* lr1_mac_obj, uint32_t* datarate
  */
 lr1mac_states_t lr1mac_core_process( lr1_stack_mac_t* lr1_mac_obj );
 
+/**
+ * @brief Returns the delay before lr1mac_core_process() has something to do without a radio planner event
+ * @remark The radio planner events wake the host up, they are not covered by this delay
+ *
+ * @param lr1_mac_obj
+ * @return uint32_t 0 if the process has to be called now, else the delay in ms
+ */
+uint32_t lr1mac_core_next_process_delay_ms_get( lr1_stack_mac_t* lr1_mac_obj );
+
 /**
  * @brief Reload the LoraWAN context saved in the flash
  *
@@ -97,7 +97,13 @@ extern "C" {
 #define GFSK_CRC_SEED                   (0x1D0F)
 #define GFSK_CRC_POLYNOMIAL             (0x1021)
 
-#define SMTC_LR1MAC_DEVNONCE_SAVE_PERIOD ( 1 )
+/*!
+ * Number of DevNonce values reserved by each save of the DevNonce: the join requests only save it once it is reached.
+ * After a reset up to SMTC_LR1MAC_DEVNONCE_SAVE_PERIOD - 1 values are skipped.
+ */
+#ifndef SMTC_LR1MAC_DEVNONCE_SAVE_PERIOD
+#define SMTC_LR1MAC_DEVNONCE_SAVE_PERIOD ( 8 )
+#endif
 
 #define LR1MAC_DEVICE_TIME_DELAY_TO_BE_NO_SYNC (4233600UL)  // 49 days -> 49×24×60×60
 
@@ -45,6 +45,7 @@
 
 #include "smtc_modem_hal.h"
 #include "smtc_modem_hal_dbg_trace.h"
+#include "smtc_crc32.h"
 
 void memcpy1( uint8_t* dst, const uint8_t* src, uint16_t size )
 {
@@ -73,17 +74,8 @@ void memset1( uint8_t* dst, uint8_t value, uint16_t size )
 
 uint32_t lr1mac_utilities_crc( uint8_t* buf, int len )
 {
-    uint32_t crc = 0xFFFFFFFA;
-    while( len-- > 0 )
-    {
-        crc = crc ^ *buf++;
-        for( int i = 0; i < 8; i++ )
-        {
-            uint32_t mask = -( crc & 1 );
-            crc           = ( crc >> 1 ) ^ ( 0xEDB88320 & mask );
-        }
-    }
-    return ~crc + 3;
+    // Seed and offset differ from the plain crc32, they are kept so that the stored contexts remain valid
+    return smtc_crc32_final( smtc_crc32_update( 0xFFFFFFFA, buf, ( uint32_t ) len ) ) + 3;
 }
 
 uint32_t lr1mac_utilities_get_symb_time_us( const uint16_t nb_symb, const ral_lora_sf_t sf, const ral_lora_bw_t bw )
@@ -108,6 +108,16 @@ static inline uint8_t smtc_duty_cycle_compute_index( uint32_t timestamp_ms, uint
  */
 static inline uint32_t smtc_duty_cycle_time_diff( uint32_t rtc_ms, uint32_t timestamp_ms );
 
+/**
+ * @brief Move the current index of a band to a RTC time and erase the obsolete TOA
+ *
+ * @remark Only the TOA saved from the oldest one up to the new index are erased, the oldest TOA is then the next one
+ *
+ * @param band_obj                  Band to move
+ * @param rtc_ms                    RTC ms
+ */
+static void smtc_duty_cycle_band_move( smtc_dtc_band_t* band_obj, uint32_t rtc_ms );
+
 /**
  * @brief Put band number in array if not already present
  *
@@ -172,52 +182,26 @@ void smtc_duty_cycle_sum( smtc_dtc_t* dtc_obj, uint32_t freq_hz, uint32_t toa_ms
         return;
     }
 
-    uint32_t rtc_time_now = smtc_modem_hal_get_time_in_ms( );
-    uint8_t  band         = smtc_duty_cycle_get_band( dtc_obj, freq_hz );
-    uint8_t  idx_previous = dtc_obj->bands[band].index_previous;
+    uint32_t         rtc_time_now = smtc_modem_hal_get_time_in_ms( );
+    smtc_dtc_band_t* band_obj     = &dtc_obj->bands[smtc_duty_cycle_get_band( dtc_obj, freq_hz )];
 
-    // compute index by delta to manage rtc_ms wrapping
-    uint32_t timestamp_diff = smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms );
-    uint8_t  idx_new        = smtc_duty_cycle_compute_index( timestamp_diff, idx_previous );
+    // Erase obsolete data and move to the current index
+    smtc_duty_cycle_band_move( band_obj, rtc_time_now );
 
     // Convert TOA to the resolution
     toa_ms = ( toa_ms < smtc_dtc_resolution_ms )
                  ? 1
                  : ( smtc_dtc_resolution_ms == 1 ) ? toa_ms : ( toa_ms / smtc_dtc_resolution_ms ) + 1;
 
-    // More than SMTC_DTC_PERIOD_MS since the last timestamp
-    if( smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms ) >= SMTC_DTC_PERIOD_MS )
+    // Sum TOA in the buffer of the current index
+    uint8_t  idx     = band_obj->index_previous;
+    uint16_t toa_sum = band_obj->toa_sum_ms[idx] + toa_ms;
+    if( band_obj->toa_sum_total == 0 )
     {
-        // Erase band cumulated TOA
-        memset( dtc_obj->bands[band].toa_sum_ms, 0, sizeof( dtc_obj->bands[band].toa_sum_ms ) );
+        band_obj->index_first = idx;
     }
-    else
-    {
-        // If we are on the same index since less than the time of one unit
-        if( ( idx_new == idx_previous ) && ( timestamp_diff < ( SMTC_DTC_SECONDS_BY_UNIT * 1000 ) ) )
-        {
-            // Sum TOA in same buffer
-            toa_ms += dtc_obj->bands[band].toa_sum_ms[idx_new];
-        }
-        else
-        {
-            // Erase obsolete data between last saved and the current
-            uint8_t i = idx_previous;
-            while( i != idx_new )
-            {
-                i++;
-                if( i >= SMTC_DTC_TOA_BUFF_SIZE )
-                {
-                    i = 0;
-                }
-                dtc_obj->bands[band].toa_sum_ms[i] = 0;
-            }
-        }
-    }
-    // Save the new TOA
-    dtc_obj->bands[band].toa_sum_ms[idx_new] = toa_ms;
-    dtc_obj->bands[band].toa_timestamp_ms    = rtc_time_now;
-    dtc_obj->bands[band].index_previous      = idx_new;
+    band_obj->toa_sum_total   = band_obj->toa_sum_total - band_obj->toa_sum_ms[idx] + toa_sum;
+    band_obj->toa_sum_ms[idx] = toa_sum;
 }
 
 void smtc_duty_cycle_update( smtc_dtc_t* dtc_obj )
@@ -230,38 +214,7 @@ void smtc_duty_cycle_update( smtc_dtc_t* dtc_obj )
 
     for( uint8_t band = 0; band < dtc_obj->number_of_bands; band++ )
     {
-        uint8_t idx_previous = dtc_obj->bands[band].index_previous;
-        // compute index by delta to manage rtc_ms wrapping
-        uint32_t timestamp_diff = smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms );
-        uint8_t  idx_new        = smtc_duty_cycle_compute_index( timestamp_diff, idx_previous );
-
-        // More than SMTC_DTC_PERIOD_MS since the last timestamp
-        if( smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms ) >= SMTC_DTC_PERIOD_MS )
-        {
-            // Erase band cumulated TOA, it's been over 1h
-            memset( dtc_obj->bands[band].toa_sum_ms, 0, sizeof( dtc_obj->bands[band].toa_sum_ms ) );
-            dtc_obj->bands[band].toa_timestamp_ms = rtc_time_now;
-            dtc_obj->bands[band].index_previous   = idx_new;
-        }
-        else
-        {
-            // Erase obsolete data between last saved and the current
-            uint8_t i = idx_previous;
-            while( i != idx_new )
-            {
-                i++;
-                if( i >= SMTC_DTC_TOA_BUFF_SIZE )
-                {
-                    i = 0;
-                }
-                // If equal do not erase the TOA
-                if( ( i != idx_new ) ||
-                    ( ( i == idx_new ) && ( timestamp_diff >= ( SMTC_DTC_SECONDS_BY_UNIT * 1000 ) ) ) )
-                {
-                    dtc_obj->bands[band].toa_sum_ms[i] = 0;
-                }
-            }
-        }
+        smtc_duty_cycle_band_move( &dtc_obj->bands[band], rtc_time_now );
     }
 }
 
@@ -400,41 +353,24 @@ int32_t smtc_duty_cycle_get_next_free_time_ms( smtc_dtc_t* dtc_obj, uint8_t numb
 
         for( uint8_t j = 0; j < tmp_band_dtc_full_index; j++ )
         {
-            uint8_t band = tmp_band_dtc_full[j];
+            smtc_dtc_band_t* band_obj = &dtc_obj->bands[tmp_band_dtc_full[j]];
 
-            uint8_t idx_previous = dtc_obj->bands[band].index_previous;
-            // compute index by delta to manage rtc_ms wrapping
-            uint32_t timestamp_diff = smtc_duty_cycle_time_diff( rtc_time_now, dtc_obj->bands[band].toa_timestamp_ms );
-            uint8_t  idx_new        = smtc_duty_cycle_compute_index( timestamp_diff, idx_previous );
+            smtc_duty_cycle_band_move( band_obj, rtc_time_now );
+            if( band_obj->toa_sum_total == 0 )
+            {
+                // TOA erased since the band was found full
+                next_available_slot_ms_tmp = 0;
+                break;
+            }
 
             // compute time between now and the end of this index
             uint32_t next_available_slot_ms =
                 ( SMTC_DTC_SECONDS_BY_UNIT * 1000UL ) - ( rtc_time_now % ( SMTC_DTC_SECONDS_BY_UNIT * 1000UL ) );
 
-            uint8_t idx_empty_counter = 0;
-
-            uint8_t i = idx_new;
-            do
-            {
-                i++;
-                if( i >= SMTC_DTC_TOA_BUFF_SIZE )
-                {
-                    i = 0;
-                }
-                if( dtc_obj->bands[band].toa_sum_ms[i] != 0 )
-                {
-                    break;
-                }
-                if( i != idx_previous )
-                {
-                    idx_empty_counter++;
-                }
-
-                if( idx_empty_counter > SMTC_DTC_TOA_BUFF_SIZE )
-                {
-                    smtc_modem_hal_lr1mac_panic( );
-                }
-            } while( i != idx_previous );
+            // the oldest TOA is erased after the empty indexes following the current one
+            uint32_t idx_empty_counter =
+                ( band_obj->index_first + SMTC_DTC_TOA_BUFF_SIZE - band_obj->index_previous - 1 ) %
+                SMTC_DTC_TOA_BUFF_SIZE;
 
             next_available_slot_ms += idx_empty_counter * SMTC_DTC_SECONDS_BY_UNIT * 1000UL;
             if( next_available_slot_ms_tmp > next_available_slot_ms )
@@ -467,26 +403,13 @@ static uint8_t smtc_duty_cycle_get_band( smtc_dtc_t* dtc_obj, uint32_t freq_hz )
 
 static uint32_t smtc_duty_cycle_get_band_consumed_time_ms( smtc_dtc_t* dtc_obj, uint8_t band )
 {
-    uint32_t toa_ms = 0;
-    for( uint8_t i = 0; i < SMTC_DTC_TOA_BUFF_SIZE; i++ )
-    {
-        toa_ms += dtc_obj->bands[band].toa_sum_ms[i];
-    }
-
     // Convert to the resolution
-    toa_ms *= smtc_dtc_resolution_ms;
-    return toa_ms;
+    return dtc_obj->bands[band].toa_sum_total * smtc_dtc_resolution_ms;
 }
 
 static inline uint8_t smtc_duty_cycle_compute_index( uint32_t timestamp_ms, uint8_t idx_previous )
 {
-    uint8_t idx_new =
-        ( ( ( timestamp_ms / 60000UL ) % ( ( ( SMTC_DTC_PERIOD_MS / 1000UL ) + SMTC_DTC_SECONDS_BY_UNIT ) / 60 ) ) /
-          ( SMTC_DTC_SECONDS_BY_UNIT / 60 ) );
-
-    idx_new += idx_previous;
-    idx_new %= SMTC_DTC_TOA_BUFF_SIZE;
-    return idx_new;
+    return ( ( timestamp_ms / ( SMTC_DTC_SECONDS_BY_UNIT * 1000UL ) ) + idx_previous ) % SMTC_DTC_TOA_BUFF_SIZE;
 }
 
 static inline uint32_t smtc_duty_cycle_time_diff( uint32_t rtc_ms, uint32_t timestamp_ms )
@@ -494,6 +417,42 @@ static inline uint32_t smtc_duty_cycle_time_diff( uint32_t rtc_ms, uint32_t time
     return ( rtc_ms - ( timestamp_ms - ( timestamp_ms % ( SMTC_DTC_SECONDS_BY_UNIT * 1000UL ) ) ) );
 }
 
+static void smtc_duty_cycle_band_move( smtc_dtc_band_t* band_obj, uint32_t rtc_ms )
+{
+    // compute index by delta to manage rtc_ms wrapping
+    uint32_t timestamp_diff = smtc_duty_cycle_time_diff( rtc_ms, band_obj->toa_timestamp_ms );
+    uint8_t  idx_new        = smtc_duty_cycle_compute_index( timestamp_diff, band_obj->index_previous );
+
+    // More than SMTC_DTC_PERIOD_MS since the last timestamp
+    if( timestamp_diff >= SMTC_DTC_PERIOD_MS )
+    {
+        // Erase band cumulated TOA, it's been over 1h
+        memset( band_obj->toa_sum_ms, 0, sizeof( band_obj->toa_sum_ms ) );
+        band_obj->toa_sum_total = 0;
+    }
+    else if( band_obj->toa_sum_total != 0 )
+    {
+        // Number of indexes elapsed, and position of the oldest TOA after the previous index
+        uint32_t idx_elapsed = ( idx_new + SMTC_DTC_TOA_BUFF_SIZE - band_obj->index_previous ) % SMTC_DTC_TOA_BUFF_SIZE;
+        uint32_t idx_first =
+            ( ( band_obj->index_first + SMTC_DTC_TOA_BUFF_SIZE - band_obj->index_previous - 1 ) %
+              SMTC_DTC_TOA_BUFF_SIZE ) +
+            1;
+
+        // Erase obsolete data from the oldest one, then skip the empty indexes up to the next TOA
+        while( ( band_obj->toa_sum_total != 0 ) &&
+               ( ( idx_first <= idx_elapsed ) || ( band_obj->toa_sum_ms[band_obj->index_first] == 0 ) ) )
+        {
+            band_obj->toa_sum_total -= band_obj->toa_sum_ms[band_obj->index_first];
+            band_obj->toa_sum_ms[band_obj->index_first] = 0;
+            band_obj->index_first = ( band_obj->index_first + 1 ) % SMTC_DTC_TOA_BUFF_SIZE;
+            idx_first++;
+        }
+    }
+    band_obj->toa_timestamp_ms = rtc_ms;
+    band_obj->index_previous   = idx_new;
+}
+
 static void smtc_duty_cycle_put_band_in_array( smtc_dtc_t* dtc_obj, uint8_t* tmp_band, uint8_t band,
                                                uint8_t* tmp_band_index )
 {
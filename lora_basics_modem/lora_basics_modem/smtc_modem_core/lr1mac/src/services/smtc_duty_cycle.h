@@ -58,17 +58,20 @@ extern "C" {
 // clang-format off
 #define SMTC_DTC_BANDS_MAX          ( 6 )                      // Number of ETSI band supported by this algo
 #define SMTC_DTC_PERIOD_MS          ( 3600000UL )              // Number of miliseconds in one period (3600000 for period 1h)
-#define SMTC_DTC_SECONDS_BY_UNIT    ( 120 )                    // Sum TOA by step of N seconds, MIN VALUE IS 60s to avoid division by 0
+#ifndef SMTC_DTC_SECONDS_BY_UNIT
+#define SMTC_DTC_SECONDS_BY_UNIT    ( 120 )                    // Sum TOA by step of N seconds, a divider of the period, MIN VALUE IS 15s
+#endif
 #define SMTC_DTC_TOA_BUFF_SIZE      ( ( SMTC_DTC_PERIOD_MS / 1000UL ) / SMTC_DTC_SECONDS_BY_UNIT )  // Buffer size to sum all TOA over one period
 
-#if SMTC_DTC_SECONDS_BY_UNIT < 60
-#warning "SMTC_DTC_SECONDS_BY_UNIT must be greater or equal to 60"
-#undef SMTC_DTC_SECONDS_BY_UNIT
-#define SMTC_DTC_SECONDS_BY_UNIT 60
+#if( ( SMTC_DTC_PERIOD_MS / 1000UL ) % SMTC_DTC_SECONDS_BY_UNIT ) != 0
+#error "SMTC_DTC_SECONDS_BY_UNIT must divide the period"
+#endif
+#if( SMTC_DTC_TOA_BUFF_SIZE > 240 )
+#error "SMTC_DTC_SECONDS_BY_UNIT must be greater or equal to 15"
 #endif
 
 //
-// Represention of the current configuration
+// Represention of the default configuration, the TOA buffer takes 2 * SMTC_DTC_TOA_BUFF_SIZE bytes per band
 //
 // index                       0     1     2                  28    29   0
 // 16bits array to save TOA {[    ][    ][    ][    ...    ][    ][    ][    ]}
@@ -92,8 +95,10 @@ typedef struct smtc_dtc_band_s
     uint32_t freq_min;
     uint32_t freq_max;
     uint16_t duty_cycle_regulation;  // 1000->0.1%, 100->1%, 10->10%
-    uint32_t toa_timestamp_ms;       // last access to the array when adding the TOA or reset all TOA
-    uint8_t  index_previous;
+    uint32_t toa_timestamp_ms;       // last access to the array when adding the TOA, updating or reset all TOA
+    uint8_t  index_previous;         // index of toa_timestamp_ms in the array
+    uint8_t  index_first;            // index of the oldest TOA in the array, if toa_sum_total is not 0
+    uint32_t toa_sum_total;          // sum of toa_sum_ms
     uint16_t toa_sum_ms[SMTC_DTC_TOA_BUFF_SIZE];  // Store all TOA by step of SMTC_DTC_SECONDS_BY_UNIT
 } smtc_dtc_band_t;
 
@@ -169,7 +174,9 @@ void smtc_duty_cycle_sum( smtc_dtc_t* dtc_obj, uint32_t freq_hz, uint32_t toa_ms
 /**
  * @brief  Update Time On Air
  *
- * @remark smtc_duty_cycle_update() must be called before check Duty Cycle available
+ * @remark smtc_duty_cycle_update() must be called before check Duty Cycle available. It only erases TOA when a step
+ *         of SMTC_DTC_SECONDS_BY_UNIT has elapsed since the last call, the consumed TOA of a band is then read in
+ *         constant time.
  *
  * @param dtc_obj                   Contains the duty cycle context
  */
@@ -73,7 +73,7 @@ typedef struct smtc_multicast_key_s
  * --- PRIVATE VARIABLES -------------------------------------------------------
  */
 
-static smtc_multicast_key_t smtc_mc_skey_tab[LR1MAC_MC_NUMBER_OF_SESSION] = {
+static const smtc_multicast_key_t smtc_mc_skey_tab[LR1MAC_MC_NUMBER_OF_SESSION] = {
     {
         .mc_app_skey = SMTC_SE_MC_APP_S_KEY_0,
         .mc_ntw_skey = SMTC_SE_MC_NWK_S_KEY_0,
@@ -130,6 +130,12 @@
 #define MODEM_FW_VERSION_PATCH 8
 #endif
 
+// Radio planner hooks and histogram bins reported by smtc_modem_get_rp_timing_stats()
+#define MODEM_RP_TIMING_NB_HOOKS \
+    ( ( RP_NB_HOOKS < SMTC_MODEM_RP_TIMING_NB_HOOKS_MAX ) ? RP_NB_HOOKS : SMTC_MODEM_RP_TIMING_NB_HOOKS_MAX )
+#define MODEM_RP_TIMING_NB_BINS \
+    ( ( RP_TIMING_NB_BINS < SMTC_MODEM_RP_TIMING_NB_BINS ) ? RP_TIMING_NB_BINS : SMTC_MODEM_RP_TIMING_NB_BINS )
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -141,7 +147,6 @@
  */
 
 #if !defined( LR1110_MODEM_E )
-static uint8_t   modem_buffer[242];
 static uint32_t* upload_pdata;
 static uint32_t  upload_size;
 
@@ -165,7 +170,6 @@ static bool stream_bypass_enabled = false;
 
 #else  // !defined( LR1110_MODEM_E )
 
-uint8_t modem_buffer[242];
 #if defined( ADD_SMTC_FILE_UPLOAD )
 static struct
 {
@@ -229,7 +233,28 @@ static bool is_modem_connected( );
 static smtc_modem_return_code_t smtc_modem_send_empty_tx( uint8_t f_port, bool f_port_present, bool confirmed );
 
 static smtc_modem_return_code_t smtc_modem_send_tx( uint8_t f_port, bool confirmed, const uint8_t* payload,
-                                                    uint8_t payload_length, bool emergency, uint8_t tx_buffer_id );
+                                                    uint8_t payload_length, bool emergency, uint8_t tx_buffer_id,
+                                                    uint32_t lifetime_s );
+
+static bool modem_downlink_view_get( smtc_modem_downlink_view_t* view );
+
+#if defined( ADD_SMTC_FILE_UPLOAD )
+/**
+ * @brief Create and initialize a file upload session, for a file in RAM or read through a callback
+ *
+ * @param [in] index           Index on which the upload is done
+ * @param [in] cipher_mode     Cipher mode
+ * @param [in] file            File buffer, unused if read is not NULL
+ * @param [in] read            Reader of the file, NULL if the file is in RAM
+ * @param [in] file_length     File size in bytes
+ * @param [in] average_delay_s Minimum delay between two file upload fragments in seconds
+ *
+ * @return Modem return code as defined in @ref smtc_modem_return_code_t
+ */
+static smtc_modem_return_code_t modem_file_upload_init( uint8_t index, smtc_modem_file_upload_cipher_mode_t cipher_mode,
+                                                        const uint8_t* file, smtc_modem_file_upload_read_t read,
+                                                        uint16_t file_length, uint32_t average_delay_s );
+#endif  // ADD_SMTC_FILE_UPLOAD
 
 smtc_modem_event_user_radio_access_status_t convert_rp_to_user_radio_access_status( rp_status_t rp_status );
 smtc_modem_rp_radio_status_t                convert_rp_to_user_radio_access_rp_status( rp_status_t rp_status );
@@ -296,6 +321,9 @@ void smtc_modem_init( const ralf_t* radio, void ( *callback_event )( void ) )
 
 uint32_t smtc_modem_run_engine( void )
 {
+    // The interrupts raised from now on are handled by the next call
+    rp_clear_irq_flag( &modem_radio_planner );
+
     uint8_t nb_downlink = fifo_ctrl_get_nb_elt( lorawan_api_get_fifo_obj( ) );
 
     if( nb_downlink > 0 )
@@ -307,6 +335,11 @@ uint32_t smtc_modem_run_engine( void )
     return modem_supervisor_engine( );
 }
 
+bool smtc_modem_is_irq_flag_pending( void )
+{
+    return rp_get_irq_flag( &modem_radio_planner );
+}
+
 /* ------------ Modem Generic Api ------------*/
 
 smtc_modem_return_code_t smtc_modem_get_event( smtc_modem_event_t* event, uint8_t* event_pending_count )
@@ -337,32 +370,27 @@ smtc_modem_return_code_t smtc_modem_get_event( smtc_modem_event_t* event, uint8_
             event->event_data.reset.count = lorawan_api_nb_reset_get( );
             break;
         case SMTC_MODEM_EVENT_DOWNDATA: {
-            lr1mac_down_metadata_t metadata;
-            uint8_t                metadata_len;
-
-            fifo_ctrl_get( lorawan_api_get_fifo_obj( ), event->event_data.downdata.data,
-                           &( event->event_data.downdata.length ), SMTC_MODEM_MAX_DOWNLINK_LENGTH, &metadata,
-                           &metadata_len, sizeof( lr1mac_down_metadata_t ) );
+            smtc_modem_downlink_view_t view = { 0 };
 
-            if( ( metadata.rx_rssi >= -128 ) && ( metadata.rx_rssi <= 63 ) )
+            // The downlink is copied once, from the fifo to the event
+            if( modem_downlink_view_get( &view ) == true )
             {
-                event->event_data.downdata.rssi = ( int8_t )( metadata.rx_rssi + 64 );
-            }
-            else if( metadata.rx_rssi > 63 )
-            {
-                event->event_data.downdata.rssi = 127;
-            }
-            else if( metadata.rx_rssi < -128 )
-            {
-                event->event_data.downdata.rssi = -128;
+                if( view.length > SMTC_MODEM_MAX_DOWNLINK_LENGTH )
+                {
+                    view.length = SMTC_MODEM_MAX_DOWNLINK_LENGTH;
+                }
+                memcpy( event->event_data.downdata.data, view.data, view.length );
+                fifo_ctrl_release( lorawan_api_get_fifo_obj( ) );
             }
 
-            event->event_data.downdata.snr          = metadata.rx_snr << 2;
-            event->event_data.downdata.window       = ( smtc_modem_event_downdata_window_t ) metadata.rx_window;
-            event->event_data.downdata.fport        = metadata.rx_fport;
-            event->event_data.downdata.fpending_bit = metadata.rx_fpending_bit;
-            event->event_data.downdata.frequency_hz = metadata.rx_frequency_hz;
-            event->event_data.downdata.datarate     = metadata.rx_datarate;
+            event->event_data.downdata.length       = view.length;
+            event->event_data.downdata.rssi         = view.rssi;
+            event->event_data.downdata.snr          = view.snr;
+            event->event_data.downdata.window       = view.window;
+            event->event_data.downdata.fport        = view.fport;
+            event->event_data.downdata.fpending_bit = view.fpending_bit;
+            event->event_data.downdata.frequency_hz = view.frequency_hz;
+            event->event_data.downdata.datarate     = view.datarate;
             break;
         }
 #if defined( ADD_SMTC_FILE_UPLOAD )
@@ -471,6 +499,40 @@ smtc_modem_return_code_t smtc_modem_get_event( smtc_modem_event_t* event, uint8_
     return return_code;
 }
 
+smtc_modem_return_code_t smtc_modem_get_downlink_data_view( smtc_modem_downlink_view_t* view )
+{
+    RETURN_BUSY_IF_TEST_MODE( );
+    RETURN_INVALID_IF_NULL( view );
+
+    if( modem_downlink_view_get( view ) == false )
+    {
+        return SMTC_MODEM_RC_FAIL;
+    }
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_release_downlink_data_view( void )
+{
+    RETURN_BUSY_IF_TEST_MODE( );
+
+    if( fifo_ctrl_release( lorawan_api_get_fifo_obj( ) ) != FIFO_STATUS_OK )
+    {
+        return SMTC_MODEM_RC_FAIL;
+    }
+
+    // The released downlink must not be reported again by a pending SMTC_MODEM_EVENT_DOWNDATA
+    uint8_t nb_downlink = fifo_ctrl_get_nb_elt( lorawan_api_get_fifo_obj( ) );
+    if( nb_downlink == 0 )
+    {
+        remove_asynchronous_msg( SMTC_MODEM_EVENT_DOWNDATA );
+    }
+    else if( get_modem_event_count( SMTC_MODEM_EVENT_DOWNDATA ) > nb_downlink )
+    {
+        set_modem_event_count_and_status( SMTC_MODEM_EVENT_DOWNDATA, nb_downlink, 0 );
+    }
+    return SMTC_MODEM_RC_OK;
+}
+
 smtc_modem_return_code_t smtc_modem_get_modem_version( smtc_modem_version_t* firmware_version )
 {
     RETURN_BUSY_IF_TEST_MODE( );
@@ -551,6 +613,96 @@ smtc_modem_return_code_t smtc_modem_reset_charge( void )
     return return_code;
 }
 
+smtc_modem_return_code_t smtc_modem_get_rp_timing_stats( smtc_modem_rp_timing_stats_t* timing_stats )
+{
+    RETURN_BUSY_IF_TEST_MODE( );
+    RETURN_INVALID_IF_NULL( timing_stats );
+
+    const rp_timing_stats_t* rp_timing_stats = rp_get_timing_stats( &modem_radio_planner );
+
+    memset( timing_stats, 0, sizeof( smtc_modem_rp_timing_stats_t ) );
+    timing_stats->nb_hooks = MODEM_RP_TIMING_NB_HOOKS;
+    for( uint8_t i = 0; i < timing_stats->nb_hooks; i++ )
+    {
+        const rp_hook_timing_stats_t*      rp_hook = &rp_timing_stats->hooks[i];
+        smtc_modem_rp_hook_timing_stats_t* hook    = &timing_stats->hooks[i];
+
+        for( uint8_t bin = 0; bin < MODEM_RP_TIMING_NB_BINS; bin++ )
+        {
+            hook->start_lateness_ms[bin]     = rp_hook->start_lateness_ms[bin];
+            hook->launch_duration_100us[bin] = rp_hook->launch_duration_100us[bin];
+            hook->irq_to_callback_100us[bin] = rp_hook->irq_to_callback_100us[bin];
+        }
+        hook->start_lateness_max_ms     = rp_hook->start_lateness_max_ms;
+        hook->launch_duration_max_100us = rp_hook->launch_duration_max_100us;
+        hook->irq_to_callback_max_100us = rp_hook->irq_to_callback_max_100us;
+        hook->late_start_nb             = rp_hook->late_start_nb;
+    }
+    for( uint8_t bin = 0; bin < MODEM_RP_TIMING_NB_BINS; bin++ )
+    {
+        timing_stats->arbiter_100us[bin] = rp_timing_stats->arbiter_100us[bin];
+    }
+    timing_stats->arbiter_max_100us = rp_timing_stats->arbiter_max_100us;
+    timing_stats->late_abort_nb     = rp_timing_stats->late_abort_nb;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_rp_timing_trace( smtc_modem_rp_timing_trace_t* trace, uint8_t trace_nb_max,
+                                                         uint8_t* trace_nb )
+{
+    RETURN_BUSY_IF_TEST_MODE( );
+    RETURN_INVALID_IF_NULL( trace );
+    RETURN_INVALID_IF_NULL( trace_nb );
+
+    const rp_timing_stats_t* rp_timing_stats = rp_get_timing_stats( &modem_radio_planner );
+
+    uint8_t nb = ( rp_timing_stats->trace_nb < trace_nb_max ) ? rp_timing_stats->trace_nb : trace_nb_max;
+
+    // The latest entries are returned, starting with the oldest one
+    for( uint8_t i = 0; i < nb; i++ )
+    {
+        const rp_timing_trace_t* rp_trace =
+            &rp_timing_stats->trace[( rp_timing_stats->trace_index + RP_TIMING_TRACE_NB - nb + i ) % RP_TIMING_TRACE_NB];
+
+        trace[i].timestamp_100us = rp_trace->timestamp_100us;
+        trace[i].value           = rp_trace->value;
+        trace[i].event           = ( smtc_modem_rp_timing_event_t ) rp_trace->event;
+        trace[i].hook_id         = ( rp_trace->hook_id < MODEM_RP_TIMING_NB_HOOKS ) ? rp_trace->hook_id
+                                                                                    : MODEM_RP_TIMING_NB_HOOKS;
+    }
+    *trace_nb = nb;
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_reset_rp_timing_stats( void )
+{
+    RETURN_BUSY_IF_TEST_MODE( );
+
+    rp_reset_timing_stats( &modem_radio_planner );
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_set_rp_margin_percentile( uint8_t percentile )
+{
+    RETURN_BUSY_IF_TEST_MODE( );
+
+    if( percentile > 100 )
+    {
+        return SMTC_MODEM_RC_INVALID;
+    }
+    rp_set_margin_percentile( &modem_radio_planner, percentile );
+    return SMTC_MODEM_RC_OK;
+}
+
+smtc_modem_return_code_t smtc_modem_get_rp_margin_delay_ms( uint32_t* margin_delay_ms )
+{
+    RETURN_BUSY_IF_TEST_MODE( );
+    RETURN_INVALID_IF_NULL( margin_delay_ms );
+
+    *margin_delay_ms = modem_radio_planner.margin_delay;
+    return SMTC_MODEM_RC_OK;
+}
+
 smtc_modem_return_code_t smtc_modem_get_tx_power_offset_db( uint8_t stack_id, int8_t* tx_pwr_offset_db )
 {
     UNUSED( stack_id );
@@ -1663,9 +1815,23 @@ smtc_modem_return_code_t smtc_modem_request_uplink( uint8_t stack_id, uint8_t f_
     RETURN_INVALID_IF_NULL( payload );
 
     smtc_modem_return_code_t return_code = SMTC_MODEM_RC_OK;
-    return_code                          = smtc_modem_send_tx( f_port, confirmed, payload, payload_length, false, 0 );
+    return_code                          = smtc_modem_send_tx( f_port, confirmed, payload, payload_length, false, 0, 0 );
+    return return_code;
+}
+
+smtc_modem_return_code_t smtc_modem_request_uplink_with_lifetime( uint8_t stack_id, uint8_t f_port, bool confirmed,
+                                                                  const uint8_t* payload, uint8_t payload_length,
+                                                                  uint32_t lifetime_s )
+{
+    UNUSED( stack_id );
+    RETURN_BUSY_IF_TEST_MODE( );
+    RETURN_INVALID_IF_NULL( payload );
+
+    smtc_modem_return_code_t return_code = SMTC_MODEM_RC_OK;
+    return_code = smtc_modem_send_tx( f_port, confirmed, payload, payload_length, false, 0, lifetime_s );
     return return_code;
 }
+
 smtc_modem_return_code_t smtc_modem_request_extended_uplink( uint8_t stack_id, uint8_t f_port, bool confirmed,
                                                              const uint8_t* payload, uint8_t payload_length,
                                                              uint8_t extended_uplink_id,
@@ -1692,7 +1858,7 @@ smtc_modem_return_code_t smtc_modem_request_extended_uplink( uint8_t stack_id, u
     if( ( extended_uplink_id == 1 ) || ( extended_uplink_id == 2 ) )
     {
         modem_set_extended_callback( lbm_notification_callback, extended_uplink_id );
-        return_code = smtc_modem_send_tx( f_port, confirmed, payload, payload_length, false, extended_uplink_id );
+        return_code = smtc_modem_send_tx( f_port, confirmed, payload, payload_length, false, extended_uplink_id, 0 );
     }
     else
     {
@@ -1740,7 +1906,7 @@ smtc_modem_return_code_t smtc_modem_request_emergency_uplink( uint8_t stack_id,
     RETURN_INVALID_IF_NULL( payload );
 
     smtc_modem_return_code_t return_code = SMTC_MODEM_RC_OK;
-    return_code                          = smtc_modem_send_tx( f_port, confirmed, payload, payload_length, true, 0 );
+    return_code                          = smtc_modem_send_tx( f_port, confirmed, payload, payload_length, true, 0, 0 );
     return return_code;
 }
 
@@ -1764,47 +1930,32 @@ smtc_modem_return_code_t smtc_modem_file_upload_init( uint8_t stack_id, uint8_t
     UNUSED( stack_id );
     RETURN_BUSY_IF_TEST_MODE( );
 
-    if( file_length == 0 )
-    {
-        SMTC_MODEM_HAL_TRACE_ERROR( "Upload initialization fails: size = 0 is not allowed\n" );
-        return SMTC_MODEM_RC_INVALID;
-    }
-    else if( cipher_mode > SMTC_MODEM_FILE_UPLOAD_AES_WITH_APPSKEY )
-    {
-        return SMTC_MODEM_RC_INVALID;
-    }
-    else if( ( modem_get_upload_state( ) == MODEM_UPLOAD_INIT_AND_FILLED ) ||
-             ( modem_get_upload_state( ) == MODEM_UPLOAD_ON_GOING ) )
-    {
-        SMTC_MODEM_HAL_TRACE_ERROR( "File Upload still in going\n" );
-        return SMTC_MODEM_RC_BUSY;
-    }
-    else if( file == NULL )
+    if( file == NULL )
     {
         SMTC_MODEM_HAL_TRACE_ERROR( "Upload file data is null\n" );
         return SMTC_MODEM_RC_INVALID;
     }
-    // save current file size and buff  (to keep hw modem compatiblity if needed)
-    upload_size  = file_length;
-    upload_pdata = ( uint32_t* ) file;
+    return modem_file_upload_init( index, cipher_mode, file, NULL, file_length, average_delay_s );
+#else   // ADD_SMTC_FILE_UPLOAD
+    return SMTC_MODEM_RC_FAIL;
+#endif  // ADD_SMTC_FILE_UPLOAD
+}
 
-    // get the next modem upload session counter
-    uint8_t next_session_counter = modem_context_compute_and_get_next_dm_upload_sctr( );
+smtc_modem_return_code_t smtc_modem_file_upload_init_with_reader( uint8_t stack_id, uint8_t index,
+                                                                  smtc_modem_file_upload_cipher_mode_t cipher_mode,
+                                                                  smtc_modem_file_upload_read_t read,
+                                                                  uint16_t file_length, uint32_t average_delay_s )
+{
+#if defined( ADD_SMTC_FILE_UPLOAD )
+    UNUSED( stack_id );
+    RETURN_BUSY_IF_TEST_MODE( );
 
-    if( file_upload_init( &( smtc_modem_services_ctx.file_upload_ctx ), UPLOAD_SID, ( uint32_t ) file_length,
-                          average_delay_s, index, ( uint8_t ) cipher_mode, next_session_counter ) != FILE_UPLOAD_OK )
+    if( read == NULL )
     {
-        SMTC_MODEM_HAL_TRACE_ERROR( "Upload initialization fails\n" );
+        SMTC_MODEM_HAL_TRACE_ERROR( "Upload file reader is null\n" );
         return SMTC_MODEM_RC_INVALID;
     }
-    SMTC_MODEM_HAL_TRACE_PRINTF( "%s, cipher_mode: %d, size:%d, average_delay:%d, session counter:%d", __func__,
-                                 cipher_mode, file_length, average_delay_s, next_session_counter );
-    // attach the file
-    file_upload_attach_file_buffer( &( smtc_modem_services_ctx.file_upload_ctx ), file );
-
-    modem_set_upload_state( MODEM_UPLOAD_INIT_AND_FILLED );
-
-    return SMTC_MODEM_RC_OK;
+    return modem_file_upload_init( index, cipher_mode, NULL, read, file_length, average_delay_s );
 #else   // ADD_SMTC_FILE_UPLOAD
     return SMTC_MODEM_RC_FAIL;
 #endif  // ADD_SMTC_FILE_UPLOAD
@@ -1832,7 +1983,11 @@ smtc_modem_return_code_t smtc_modem_file_upload_start( uint8_t stack_id )
     }
 
     // ready to prepare the file to be uploaded
-    file_upload_prepare_upload( &( smtc_modem_services_ctx.file_upload_ctx ) );
+    if( file_upload_prepare_upload( &( smtc_modem_services_ctx.file_upload_ctx ) ) != FILE_UPLOAD_OK )
+    {
+        SMTC_MODEM_HAL_TRACE_ERROR( "File upload cannot read the file\n" );
+        return SMTC_MODEM_RC_FAIL;
+    }
 
     // add the first upload task in scheduler
     modem_supervisor_add_task_file_upload( smtc_modem_hal_get_random_nb_in_range( 0, 2 ) );
@@ -2956,15 +3111,22 @@ static smtc_modem_return_code_t smtc_modem_send_empty_tx( uint8_t f_port, bool f
     }
     else
     {
-        task_send.priority          = TASK_HIGH_PRIORITY;
-        task_send.id                = SEND_TASK;
-        task_send.fPort             = f_port;
-        task_send.fPort_present     = f_port_present;
-        task_send.PacketType        = confirmed;
-        task_send.sizeIn            = 0;
-        task_send.time_to_execute_s = smtc_modem_hal_get_time_in_s( );
-
-        if( modem_supervisor_add_task( &task_send ) != TASK_VALID )
+        task_send.priority      = TASK_HIGH_PRIORITY;
+        task_send.id            = SEND_TASK;
+        task_send.fPort         = f_port;
+        task_send.fPort_present = f_port_present;
+        task_send.PacketType    = confirmed;
+        task_send.dataIn        = NULL;
+        task_send.sizeIn        = 0;
+        task_send.deadline_s    = 0;
+        modem_supervisor_set_task_delay( &task_send, 0, 0 );
+
+        eTask_valid_t task_valid = modem_supervisor_add_task( &task_send );
+        if( task_valid == TASK_BUSY )
+        {
+            return_code = SMTC_MODEM_RC_BUSY;
+        }
+        else if( task_valid != TASK_VALID )
         {
             return_code = SMTC_MODEM_RC_FAIL;
         }
@@ -2973,7 +3135,8 @@ static smtc_modem_return_code_t smtc_modem_send_empty_tx( uint8_t f_port, bool f
 }
 
 static smtc_modem_return_code_t smtc_modem_send_tx( uint8_t f_port, bool confirmed, const uint8_t* payload,
-                                                    uint8_t payload_length, bool emergency, uint8_t tx_buffer_id )
+                                                    uint8_t payload_length, bool emergency, uint8_t tx_buffer_id,
+                                                    uint32_t lifetime_s )
 {
     smtc_modem_return_code_t return_code = SMTC_MODEM_RC_OK;
     smodem_task              task_send;
@@ -2994,7 +3157,6 @@ static smtc_modem_return_code_t smtc_modem_send_tx( uint8_t f_port, bool confirm
         if( emergency == true )
         {
             task_send.priority = TASK_VERY_HIGH_PRIORITY;
-            lorawan_api_duty_cycle_enable_set( SMTC_DTC_PARTIAL_DISABLED );
         }
         else
         {
@@ -3003,9 +3165,9 @@ static smtc_modem_return_code_t smtc_modem_send_tx( uint8_t f_port, bool confirm
         switch( tx_buffer_id )
         {
         case 0:
-            memcpy( modem_buffer, payload, payload_length );
+            // The payload is copied in the uplink queue of the modem supervisor
             task_send.id     = SEND_TASK;
-            task_send.dataIn = modem_buffer;
+            task_send.dataIn = payload;
             break;
         case 1:
             task_send.id     = SEND_TASK_EXTENDED_1;
@@ -3020,24 +3182,70 @@ static smtc_modem_return_code_t smtc_modem_send_tx( uint8_t f_port, bool confirm
         default:
             return SMTC_MODEM_RC_FAIL;
         }
-        task_send.fPort             = f_port;
-        task_send.fPort_present     = true;
-        task_send.PacketType        = confirmed;
-        task_send.sizeIn            = payload_length;
-        task_send.time_to_execute_s = smtc_modem_hal_get_time_in_s( );
+        task_send.fPort         = f_port;
+        task_send.fPort_present = true;
+        task_send.PacketType    = confirmed;
+        task_send.sizeIn        = payload_length;
+        task_send.deadline_s    = ( lifetime_s > 0 ) ? smtc_modem_hal_get_time_in_s( ) + lifetime_s : 0;
+        modem_supervisor_set_task_delay( &task_send, 0, 0 );
 
         // SMTC_MODEM_HAL_TRACE_INFO( "add task user tx payload with payload size = %d \n ", payload_length );
-        if( modem_supervisor_add_task( &task_send ) != TASK_VALID )
+        eTask_valid_t task_valid = modem_supervisor_add_task( &task_send );
+        if( task_valid == TASK_BUSY )
+        {
+            return_code = SMTC_MODEM_RC_BUSY;
+        }
+        else if( task_valid != TASK_VALID )
         {
             return_code = SMTC_MODEM_RC_FAIL;
         }
+        else if( emergency == true )
+        {
+            lorawan_api_duty_cycle_enable_set( SMTC_DTC_PARTIAL_DISABLED );
+        }
     }
 
-    //@todo indicate that can't accept a new task because task already enqueued     //   SetModemBusy ();
-
     return return_code;
 }
 
+static bool modem_downlink_view_get( smtc_modem_downlink_view_t* view )
+{
+    const uint8_t*         metadata_in_fifo;
+    uint8_t                metadata_len;
+    lr1mac_down_metadata_t metadata = { 0 };
+
+    if( fifo_ctrl_borrow( lorawan_api_get_fifo_obj( ), &view->data, &view->length, &metadata_in_fifo,
+                          &metadata_len ) != FIFO_STATUS_OK )
+    {
+        return false;
+    }
+
+    // The metadata are not aligned in the fifo
+    memcpy( &metadata, metadata_in_fifo,
+            ( metadata_len < sizeof( lr1mac_down_metadata_t ) ) ? metadata_len : sizeof( lr1mac_down_metadata_t ) );
+
+    if( ( metadata.rx_rssi >= -128 ) && ( metadata.rx_rssi <= 63 ) )
+    {
+        view->rssi = ( int8_t )( metadata.rx_rssi + 64 );
+    }
+    else if( metadata.rx_rssi > 63 )
+    {
+        view->rssi = 127;
+    }
+    else if( metadata.rx_rssi < -128 )
+    {
+        view->rssi = -128;
+    }
+
+    view->snr          = metadata.rx_snr << 2;
+    view->window       = ( smtc_modem_event_downdata_window_t ) metadata.rx_window;
+    view->fport        = metadata.rx_fport;
+    view->fpending_bit = metadata.rx_fpending_bit;
+    view->frequency_hz = metadata.rx_frequency_hz;
+    view->datarate     = metadata.rx_datarate;
+    return true;
+}
+
 smtc_modem_event_user_radio_access_status_t convert_rp_to_user_radio_access_status( rp_status_t rp_status )
 {
     smtc_modem_event_user_radio_access_status_t user_radio_access_status = SMTC_MODEM_EVENT_USER_RADIO_ACCESS_UNKNOWN;
@@ -3215,4 +3423,55 @@ void callback_rp_user_radio_access_2( void* ctx )
 }
 #endif  // !LR1110_MODEM_E
 
+#if defined( ADD_SMTC_FILE_UPLOAD )
+static smtc_modem_return_code_t modem_file_upload_init( uint8_t index, smtc_modem_file_upload_cipher_mode_t cipher_mode,
+                                                        const uint8_t* file, smtc_modem_file_upload_read_t read,
+                                                        uint16_t file_length, uint32_t average_delay_s )
+{
+    if( file_length == 0 )
+    {
+        SMTC_MODEM_HAL_TRACE_ERROR( "Upload initialization fails: size = 0 is not allowed\n" );
+        return SMTC_MODEM_RC_INVALID;
+    }
+    else if( cipher_mode > SMTC_MODEM_FILE_UPLOAD_AES_WITH_APPSKEY )
+    {
+        return SMTC_MODEM_RC_INVALID;
+    }
+    else if( ( modem_get_upload_state( ) == MODEM_UPLOAD_INIT_AND_FILLED ) ||
+             ( modem_get_upload_state( ) == MODEM_UPLOAD_ON_GOING ) )
+    {
+        SMTC_MODEM_HAL_TRACE_ERROR( "File Upload still in going\n" );
+        return SMTC_MODEM_RC_BUSY;
+    }
+    // save current file size and buff  (to keep hw modem compatiblity if needed)
+    upload_size  = file_length;
+    upload_pdata = ( uint32_t* ) file;
+
+    // get the next modem upload session counter
+    uint8_t next_session_counter = modem_context_compute_and_get_next_dm_upload_sctr( );
+
+    if( file_upload_init( &( smtc_modem_services_ctx.file_upload_ctx ), UPLOAD_SID, ( uint32_t ) file_length,
+                          average_delay_s, index, ( uint8_t ) cipher_mode, next_session_counter ) != FILE_UPLOAD_OK )
+    {
+        SMTC_MODEM_HAL_TRACE_ERROR( "Upload initialization fails\n" );
+        return SMTC_MODEM_RC_INVALID;
+    }
+    SMTC_MODEM_HAL_TRACE_PRINTF( "%s, cipher_mode: %d, size:%d, average_delay:%d, session counter:%d", __func__,
+                                 cipher_mode, file_length, average_delay_s, next_session_counter );
+    // attach the file
+    if( read != NULL )
+    {
+        file_upload_attach_file_reader( &( smtc_modem_services_ctx.file_upload_ctx ), read );
+    }
+    else
+    {
+        file_upload_attach_file_buffer( &( smtc_modem_services_ctx.file_upload_ctx ), file );
+    }
+
+    modem_set_upload_state( MODEM_UPLOAD_INIT_AND_FILLED );
+
+    return SMTC_MODEM_RC_OK;
+}
+#endif  // ADD_SMTC_FILE_UPLOAD
+
 /* --- EOF ------------------------------------------------------------------ */
@@ -61,6 +61,8 @@
 #include "sx126x_hal.h"
 #elif defined( LR11XX )
 #include "lr11xx_hal.h"
+#elif defined( RADIO_SIM )
+#include "ral_sim.h"
 #else
 #error "Please select radio board.."
 #endif
@@ -437,6 +439,8 @@ smtc_modem_return_code_t smtc_modem_test_tx_cw( uint32_t frequency_hz, int8_t tx
     lora_param.mod_params.bw = RAL_LORA_BW_125_KHZ;
 #elif defined( LR11XX )
     lora_param.mod_params.bw = RAL_LORA_BW_125_KHZ;
+#elif defined( RADIO_SIM )
+    lora_param.mod_params.bw = RAL_LORA_BW_125_KHZ;
 #endif
     lora_param.mod_params.cr = smtc_real_get_coding_rate( modem_test_context.lr1_mac_obj );
     lora_param.sync_word     = smtc_real_get_sync_word( modem_test_context.lr1_mac_obj );
@@ -725,7 +729,7 @@ smtc_modem_return_code_t smtc_modem_test_direct_radio_write( uint8_t* command, u
 #elif defined( LR11XX_TRANSCEIVER )
     if( lr11xx_hal_write( modem_test_context.rp->radio->ral.context, command, command_length, data, data_length ) !=
         LR11XX_HAL_STATUS_OK )
-#elif defined( LR1110_MODEM_E )
+#elif defined( LR1110_MODEM_E ) || defined( RADIO_SIM )
     return SMTC_MODEM_RC_FAIL;
 #else
 #error "Please select radio board.."
@@ -753,7 +757,7 @@ smtc_modem_return_code_t smtc_modem_test_direct_radio_read( uint8_t* command, ui
 #elif defined( LR11XX_TRANSCEIVER )
     if( lr11xx_hal_read( modem_test_context.rp->radio->ral.context, command, command_length, data, data_length ) !=
         LR11XX_HAL_STATUS_OK )
-#elif defined( LR1110_MODEM_E )
+#elif defined( LR1110_MODEM_E ) || defined( RADIO_SIM )
     return SMTC_MODEM_RC_FAIL;
 #else
 #error "Please select radio board.."
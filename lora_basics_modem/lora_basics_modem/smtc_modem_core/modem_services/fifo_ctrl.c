@@ -51,6 +51,10 @@
 
 #define LEN_DATA_SIZE ( 2 )
 #define LEN_METADATA_SIZE ( 1 )
+#define LEN_HEADER_SIZE ( LEN_DATA_SIZE + LEN_METADATA_SIZE )
+
+// Data length written at the end of the buffer when it is skipped, a real element is always shorter than the buffer
+#define PADDING_MARKER ( 0xFFFF )
 
 /*
  * -----------------------------------------------------------------------------
@@ -72,6 +76,8 @@ static fifo_return_status_t ctrl_set( fifo_ctrl_t* ctrl, const uint8_t* buffer,
 static fifo_return_status_t ctrl_get( fifo_ctrl_t* ctrl, uint8_t* buffer, uint16_t* data_len,
                                       const uint16_t data_buffer_size, void* metadata, uint8_t* metadata_len,
                                       const uint8_t metadata_buffer_size );
+
+static void ctrl_skip_padding( fifo_ctrl_t* ctrl );
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -89,6 +95,7 @@ void fifo_ctrl_clear( fifo_ctrl_t* ctrl )
     ctrl->read_offset  = 0;
     ctrl->write_offset = 0;
     ctrl->nb_element   = 0;
+    ctrl->borrowed     = false;
     ctrl->write_cnt    = 0;
     ctrl->read_cnt     = 0;
     ctrl->drop_cnt     = 0;
@@ -122,9 +129,57 @@ fifo_return_status_t fifo_ctrl_get( fifo_ctrl_t* ctrl, uint8_t* buffer, uint16_t
                                     const uint16_t data_buffer_size, void* metadata, uint8_t* metadata_len,
                                     const uint8_t metadata_buffer_size )
 {
+    fifo_return_status_t ret = FIFO_STATUS_BUFFER_BORROWED;
+
     smtc_modem_hal_disable_modem_irq( );
-    fifo_return_status_t ret =
-        ctrl_get( ctrl, buffer, data_len, data_buffer_size, metadata, metadata_len, metadata_buffer_size );
+    if( ctrl->borrowed == false )
+    {
+        ret = ctrl_get( ctrl, buffer, data_len, data_buffer_size, metadata, metadata_len, metadata_buffer_size );
+    }
+    smtc_modem_hal_enable_modem_irq( );
+
+    return ret;
+}
+
+fifo_return_status_t fifo_ctrl_borrow( fifo_ctrl_t* ctrl, const uint8_t** data, uint16_t* data_len,
+                                       const uint8_t** metadata, uint8_t* metadata_len )
+{
+    if( ( data == NULL ) || ( data_len == NULL ) || ( metadata == NULL ) || ( metadata_len == NULL ) )
+    {
+        return FIFO_STATUS_PARAM_ERROR;
+    }
+
+    smtc_modem_hal_disable_modem_irq( );
+    if( ctrl->nb_element == 0 )
+    {
+        smtc_modem_hal_enable_modem_irq( );
+        return FIFO_STATUS_BUFFER_EMPTY;
+    }
+
+    ctrl_skip_padding( ctrl );
+
+    // The element is contiguous, it can be read in place
+    const uint8_t* element = ctrl->buffer + ctrl->read_offset;
+    *data_len              = ( ( uint16_t ) element[0] << 8 ) + element[1];
+    *metadata_len          = element[2];
+    *metadata              = element + LEN_HEADER_SIZE;
+    *data                  = element + LEN_HEADER_SIZE + *metadata_len;
+    ctrl->borrowed         = true;
+    smtc_modem_hal_enable_modem_irq( );
+
+    return FIFO_STATUS_OK;
+}
+
+fifo_return_status_t fifo_ctrl_release( fifo_ctrl_t* ctrl )
+{
+    fifo_return_status_t ret = FIFO_STATUS_PARAM_ERROR;
+
+    smtc_modem_hal_disable_modem_irq( );
+    if( ctrl->borrowed == true )
+    {
+        ctrl->borrowed = false;
+        ret            = ctrl_get( ctrl, NULL, NULL, 0, NULL, NULL, 0 );
+    }
     smtc_modem_hal_enable_modem_irq( );
 
     return ret;
@@ -142,68 +197,77 @@ fifo_return_status_t fifo_ctrl_set( fifo_ctrl_t* ctrl, const uint8_t* buffer, co
 static fifo_return_status_t ctrl_set( fifo_ctrl_t* ctrl, const uint8_t* buffer, const uint16_t buffer_len,
                                       const void* metadata, const uint8_t metadata_len )
 {
-    uint16_t total_write_len = LEN_DATA_SIZE + LEN_METADATA_SIZE + metadata_len + buffer_len;
+    uint32_t total_write_len = LEN_HEADER_SIZE + metadata_len + buffer_len;
+    uint32_t end_len;
+    uint32_t padding_len;
 
     if( total_write_len > ctrl->buffer_size )
     {
         return FIFO_STATUS_BUFFER_TOO_SMALL;
     }
 
-    while( ctrl->free_space < total_write_len )
+    while( 1 )
     {
-        // Not enough free space --> Remove oldest
-        ctrl_get( ctrl, NULL, NULL, 0, NULL, NULL, 0 );
-        ctrl->drop_cnt += 1;
-    }
-
-    // Write data length - 2 bytes MSB first
-    ctrl->buffer[ctrl->write_offset] = ( uint8_t )( buffer_len >> 8 );
-    ctrl->write_offset += 1;
-    ctrl->write_offset %= ctrl->buffer_size;
-    ctrl->buffer[ctrl->write_offset] = ( uint8_t )( buffer_len );
-    ctrl->write_offset += 1;
-    ctrl->write_offset %= ctrl->buffer_size;
+        if( ctrl->nb_element == 0 )
+        {
+            // Restart from the beginning of the buffer, no need to skip its end
+            ctrl->read_offset  = 0;
+            ctrl->write_offset = 0;
+            ctrl->free_space   = ctrl->buffer_size;
+        }
 
-    // Write metadata length
-    ctrl->buffer[ctrl->write_offset] = metadata_len;
-    ctrl->write_offset += 1;
-    ctrl->write_offset %= ctrl->buffer_size;
+        // The end of the buffer is skipped if the element does not fit in it
+        end_len     = ( uint32_t ) ctrl->buffer_size - ctrl->write_offset;
+        padding_len = ( end_len < total_write_len ) ? end_len : 0;
 
-    // Write metadata
-    if( metadata_len != 0 )
-    {
-        if( ( ctrl->write_offset + metadata_len ) > ctrl->buffer_size )
+        if( ctrl->free_space >= ( padding_len + total_write_len ) )
         {
-            memcpy( ctrl->buffer + ctrl->write_offset, ( uint8_t* ) metadata, ctrl->buffer_size - ctrl->write_offset );
-            memcpy( ctrl->buffer, ( uint8_t* ) metadata + ctrl->buffer_size - ctrl->write_offset,
-                    metadata_len - ( ctrl->buffer_size - ctrl->write_offset ) );
+            break;
         }
-        else
+
+        if( ctrl->borrowed == true )
         {
-            memcpy( ctrl->buffer + ctrl->write_offset, ( uint8_t* ) metadata, metadata_len );
+            // The oldest element cannot be removed --> drop the new one
+            ctrl->drop_cnt += 1;
+            return FIFO_STATUS_BUFFER_BORROWED;
         }
-        ctrl->write_offset += metadata_len;
-        ctrl->write_offset %= ctrl->buffer_size;
+
+        // Not enough free space --> Remove oldest
+        ctrl_get( ctrl, NULL, NULL, 0, NULL, NULL, 0 );
+        ctrl->drop_cnt += 1;
     }
 
-    // Write data
-    if( buffer_len != 0 )
+    if( padding_len != 0 )
     {
-        if( ( ctrl->write_offset + buffer_len ) > ctrl->buffer_size )
+        // A too short end of buffer is skipped by the reader without marker
+        if( padding_len >= LEN_HEADER_SIZE )
         {
-            memcpy( ctrl->buffer + ctrl->write_offset, buffer, ctrl->buffer_size - ctrl->write_offset );
-            memcpy( ctrl->buffer, buffer + ctrl->buffer_size - ctrl->write_offset,
-                    buffer_len - ( ctrl->buffer_size - ctrl->write_offset ) );
-        }
-        else
-        {
-            memcpy( ctrl->buffer + ctrl->write_offset, buffer, buffer_len );
+            ctrl->buffer[ctrl->write_offset]     = ( uint8_t )( PADDING_MARKER >> 8 );
+            ctrl->buffer[ctrl->write_offset + 1] = ( uint8_t )( PADDING_MARKER );
         }
+        ctrl->free_space -= padding_len;
+        ctrl->write_offset = 0;
+    }
 
-        ctrl->write_offset += buffer_len;
-        ctrl->write_offset %= ctrl->buffer_size;
+    uint8_t* element = ctrl->buffer + ctrl->write_offset;
+
+    // Write data length - 2 bytes MSB first, then metadata length
+    element[0] = ( uint8_t )( buffer_len >> 8 );
+    element[1] = ( uint8_t )( buffer_len );
+    element[2] = metadata_len;
+
+    if( metadata_len != 0 )
+    {
+        memcpy( element + LEN_HEADER_SIZE, ( const uint8_t* ) metadata, metadata_len );
+    }
+    if( buffer_len != 0 )
+    {
+        memcpy( element + LEN_HEADER_SIZE + metadata_len, buffer, buffer_len );
     }
 
+    ctrl->write_offset += total_write_len;
+    ctrl->write_offset %= ctrl->buffer_size;
+
     ctrl->free_space -= total_write_len;
     ctrl->nb_element += 1;
     ctrl->write_cnt += 1;
@@ -220,10 +284,12 @@ static fifo_return_status_t ctrl_get( fifo_ctrl_t* ctrl, uint8_t* buffer, uint16
         return FIFO_STATUS_BUFFER_EMPTY;
     }
 
+    ctrl_skip_padding( ctrl );
+
     // Read data & metadata size (read_offset update is done later if input param are ok)
-    uint16_t read_data_len = ( ( uint16_t ) ctrl->buffer[ctrl->read_offset] ) << 8;
-    read_data_len += ( ( uint16_t ) ctrl->buffer[( ctrl->read_offset + 1 ) % ctrl->buffer_size] );
-    uint8_t read_metadata_len = ctrl->buffer[( ctrl->read_offset + 2 ) % ctrl->buffer_size];
+    const uint8_t* element           = ctrl->buffer + ctrl->read_offset;
+    uint16_t       read_data_len     = ( ( uint16_t ) element[0] << 8 ) + element[1];
+    uint8_t        read_metadata_len = element[2];
 
     // Buffer & metadata are NULL --> drop old message --> don't check/update size of buffer
     if( ( buffer != NULL ) && ( metadata != NULL ) )
@@ -243,47 +309,39 @@ static fifo_return_status_t ctrl_get( fifo_ctrl_t* ctrl, uint8_t* buffer, uint16
         }
     }
 
-    // Update read offset (only if there is no error)
-    ctrl->read_offset += ( LEN_DATA_SIZE + LEN_METADATA_SIZE );
-    ctrl->read_offset %= ctrl->buffer_size;
-
     // Copy metadata (if required)
     if( ( metadata != NULL ) && ( read_metadata_len != 0 ) )
     {
-        if( ( ctrl->read_offset + read_metadata_len ) > ctrl->buffer_size )
-        {
-            memcpy( ( uint8_t* ) metadata, ctrl->buffer + ctrl->read_offset, ctrl->buffer_size - ctrl->read_offset );
-            memcpy( ( uint8_t* ) metadata + ctrl->buffer_size - ctrl->read_offset, ctrl->buffer,
-                    read_metadata_len - ( ctrl->buffer_size - ctrl->read_offset ) );
-        }
-        else
-        {
-            memcpy( ( uint8_t* ) metadata, ctrl->buffer + ctrl->read_offset, read_metadata_len );
-        }
+        memcpy( ( uint8_t* ) metadata, element + LEN_HEADER_SIZE, read_metadata_len );
     }
-    ctrl->read_offset += read_metadata_len;
-    ctrl->read_offset %= ctrl->buffer_size;
 
     // Copy data (if required)
     if( ( buffer != NULL ) && ( read_data_len != 0 ) )
     {
-        if( ( ctrl->read_offset + read_data_len ) > ctrl->buffer_size )
-        {
-            memcpy( buffer, ctrl->buffer + ctrl->read_offset, ctrl->buffer_size - ctrl->read_offset );
-            memcpy( buffer + ctrl->buffer_size - ctrl->read_offset, ctrl->buffer,
-                    read_data_len - ( ctrl->buffer_size - ctrl->read_offset ) );
-        }
-        else
-        {
-            memcpy( buffer, ctrl->buffer + ctrl->read_offset, read_data_len );
-        }
+        memcpy( buffer, element + LEN_HEADER_SIZE + read_metadata_len, read_data_len );
     }
-    ctrl->read_offset += read_data_len;
+
+    // Update read offset (only if there is no error)
+    ctrl->read_offset += ( LEN_HEADER_SIZE + read_metadata_len + read_data_len );
     ctrl->read_offset %= ctrl->buffer_size;
 
-    ctrl->free_space += ( LEN_DATA_SIZE + LEN_METADATA_SIZE + read_metadata_len + read_data_len );
+    ctrl->free_space += ( LEN_HEADER_SIZE + read_metadata_len + read_data_len );
     ctrl->nb_element -= 1;
     ctrl->read_cnt += 1;
 
     return FIFO_STATUS_OK;
 }
+
+static void ctrl_skip_padding( fifo_ctrl_t* ctrl )
+{
+    uint16_t end_len = ctrl->buffer_size - ctrl->read_offset;
+
+    // The end of the buffer is skipped when it is too short for a header or holds the padding marker
+    if( ( end_len < LEN_HEADER_SIZE ) ||
+        ( ( ( ( uint16_t ) ctrl->buffer[ctrl->read_offset] << 8 ) + ctrl->buffer[ctrl->read_offset + 1] ) ==
+          PADDING_MARKER ) )
+    {
+        ctrl->free_space += end_len;
+        ctrl->read_offset = 0;
+    }
+}
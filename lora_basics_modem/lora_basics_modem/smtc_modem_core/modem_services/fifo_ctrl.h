@@ -43,7 +43,8 @@ extern "C" {
  * -----------------------------------------------------------------------------
  * --- DEPENDENCIES ------------------------------------------------------------
  */
-#include <stdint.h>  // C99 types
+#include <stdint.h>   // C99 types
+#include <stdbool.h>  // bool type
 
 /*
  * -----------------------------------------------------------------------------
@@ -68,9 +69,12 @@ typedef enum fifo_return_status_e
     FIFO_STATUS_BUFFER_EMPTY,      // Only for get function
     FIFO_STATUS_BUFFER_TOO_SMALL,  // For get: not enough space in buffer to read data from fifo
                                    // For set: fifo is not big enough to save data + metadata
+    FIFO_STATUS_BUFFER_BORROWED,   // For get: the oldest element is borrowed
+                                   // For set: the oldest element is borrowed, the new one is dropped
 } fifo_return_status_t;
 
 // Internal structure to manage fifo - don't modify it
+// Each element is stored contiguously, the end of the buffer is skipped when an element does not fit in it
 typedef struct fifo_ctrl_s
 {
     uint8_t* buffer;
@@ -79,6 +83,7 @@ typedef struct fifo_ctrl_s
     uint16_t write_offset;
     uint16_t free_space;
     uint16_t nb_element;
+    bool     borrowed;  // The oldest element is borrowed, it cannot be dropped
 
     // Stat
     uint32_t write_cnt;
@@ -147,9 +152,31 @@ fifo_return_status_t fifo_ctrl_get( fifo_ctrl_t* ctrl, uint8_t* buffer, uint16_t
                                     const uint16_t data_buffer_size, void* metadata, uint8_t* metadata_len,
                                     const uint8_t metadata_buffer_size );
 
+/**
+ * @brief Borrow the oldest element of the fifo, without copying it
+ *      The element stays in the fifo, and is not dropped by fifo_ctrl_set(), until fifo_ctrl_release() is called
+ *
+ * @param ctrl          fifo manager
+ * @param data          pointer to the data of the element
+ * @param data_len      length of the data
+ * @param metadata      pointer to the metadata of the element, not aligned
+ * @param metadata_len  length of the metadata
+ * @return fifo_return_status_t return status
+ */
+fifo_return_status_t fifo_ctrl_borrow( fifo_ctrl_t* ctrl, const uint8_t** data, uint16_t* data_len,
+                                       const uint8_t** metadata, uint8_t* metadata_len );
+
+/**
+ * @brief Remove the element borrowed with fifo_ctrl_borrow() from the fifo
+ *
+ * @param ctrl  fifo manager
+ * @return fifo_return_status_t return status, FIFO_STATUS_PARAM_ERROR if no element is borrowed
+ */
+fifo_return_status_t fifo_ctrl_release( fifo_ctrl_t* ctrl );
+
 /**
  * @brief Save a new element in the fifo
- *      If there is not enough free space, the oldest element will be removed
+ *      If there is not enough free space, the oldest element will be removed, unless it is borrowed
  *
  * @param ctrl          fifo manager
  * @param buffer        buffer to save
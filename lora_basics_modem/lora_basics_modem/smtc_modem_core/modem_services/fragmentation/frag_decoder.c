@@ -34,8 +34,10 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #include "lr1mac_utilities.h"
 #include "frag_decoder.h"
 #include "smtc_modem_hal.h"
@@ -61,16 +63,26 @@
  *
  *
  * Global
- *  MatrixM2B [R][R/8]          little parity matrix
+ *  MatrixM2B [R][R/32]         little parity matrix
  *  FragNbMissingIndex [M]      Fragment i is the Nth missing
- *  S[R/8]
+ *  S[R/32]
  *
  * Local
- *  matrixRow [M/8]             Ci in the paper
+ *  matrixRow [M/32]            Ci in the paper
  *  matrixDataTemp [L]          Coded fragment, Si in the paper
- *  dataTempVector [R/8]        Line of MatrixM2B
- *  dataTempVector2 [R/8]       Line of MatrixM2B
+ *  dataTempVector [R/32]       Line of MatrixM2B
+ *  dataTempVector2 [R/32]      Line of MatrixM2B
+ *
+ * Bit arrays are stored in 32-bit words, bit i being the bit (i % 32) of word (i / 32), so that rows are combined a
+ * word at a time and the first one of a row is found with a count trailing zeros.
+ *
+ * With FRAG_DECODER_MATRIX_IN_FLASH, MatrixM2B and FragNbMissingIndex are stored behind the matrix callbacks, apart
+ * from the file:
  *
+ *  MissingIndexAddr = 0        FragNbMissingIndex [min(M, R)]
+ *  MatrixM2BAddr               MatrixM2B for min(M, R) lost fragments, from the next cache line
+ *
+ * They are only accessed through a write-back direct-mapped cache of FRAG_DECODER_CACHE_NB_LINES lines.
  */
 
 #if defined( UNIT_TEST_DBG )
@@ -91,7 +103,7 @@
 #define PARITY_ARRAY_PRINT( name, array, rows, cols )             \
     {                                                             \
         SMTC_MODEM_HAL_TRACE_PRINTF( "\n%s\n", name );            \
-        uint8_t tmp[16];                                          \
+        uint32_t tmp[BITARRAY_WORDS( FRAG_MAX_FRAME_LOSS )];      \
         for( size_t _i = 0; _i < ( rows ); _i++ )                 \
         {                                                         \
             FragExtractLineFromBinaryMatrix( tmp, _i, ( cols ) ); \
@@ -129,8 +141,27 @@
 #define DATA_PRINT_FRAG( ... )
 #endif  // TEST
 
-// This computes the number of bytes needed to store N bits.
-#define BITARRAY_BYTES( N ) ( ( ( N ) + 7 ) >> 3 )
+// This computes the number of 32-bit words needed to store N bits.
+#define BITARRAY_WORDS( N ) ( ( ( N ) + 31 ) >> 5 )
+
+// This computes the number of 32-bit words of the M2B matrix for N missing fragments.
+#define M2B_WORDS( N ) ( ( BITARRAY_WORDS( N ) * ( BITARRAY_WORDS( N ) + 1 ) ) << 4 )
+
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+// Tag of an empty cache line
+#define FRAG_CACHE_TAG_NONE UINT32_MAX
+
+// This rounds a size or an address up to the next cache line
+#define FRAG_CACHE_ALIGN( N ) \
+    ( ( ( N ) + FRAG_DECODER_CACHE_LINE_SIZE - 1 ) / FRAG_DECODER_CACHE_LINE_SIZE * FRAG_DECODER_CACHE_LINE_SIZE )
+
+typedef struct
+{
+    uint32_t Tag;  // Address of the line divided by FRAG_DECODER_CACHE_LINE_SIZE
+    bool     Dirty;
+    uint8_t  Data[FRAG_DECODER_CACHE_LINE_SIZE];
+} FragCacheLine_t;
+#endif
 
 typedef struct
 {
@@ -146,28 +177,27 @@ typedef struct
      *
      * This stores a triangular superior matrix. The "PushLine" and "ExtractLine" functions
      * manage the compression and bit layout.
-     * We will store at most L*(L+1)/2 bits, with L the maximum number of missing fragments
-     * that we can tolerate.
-     *
-     * NbElems = FRAG_MAX_FRAME_LOSS * (FRAG_MAX_FRAME_LOSS + 1) / 2
+     * Row i only stores the words holding its bits i to L-1, with L the maximum number of
+     * missing fragments that we can tolerate: the 32 first rows use L/32 words, the 32 next
+     * rows one word less, and so on.
      *
-     * // (N+7)/8 is the correct floor function for 8 bits/byte
-     * NbBytes = (NbElems + 7) >> 3
+     * NbWords = 32 * (L/32) * (L/32 + 1) / 2
      *
      */
-#define M2B_NB_ELEM ( FRAG_MAX_FRAME_LOSS * ( FRAG_MAX_FRAME_LOSS + 1 ) >> 1 )
-#define M2B_STORAGE_SIZE ( BITARRAY_BYTES( M2B_NB_ELEM ) )
-    uint8_t MatrixM2B[M2B_STORAGE_SIZE];
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    uint32_t MatrixM2BAddr;
+#else
+#define M2B_STORAGE_WORDS ( M2B_WORDS( FRAG_MAX_FRAME_LOSS ) )
+    uint32_t MatrixM2B[M2B_STORAGE_WORDS];
+#endif
 
     /*
      * BitArray containing if fragment {I} is missing or not.
-     * This is used to quickly check if a fragment is missing or not.
-     * We could trade memory consumption with computation time by
-     * iterating through FragMissingIndex every time we want to check
-     * if a fragment is missing or not. The gain is small though (32 bytes for 256 fragments)
+     * This is used to quickly check if a fragment is missing or not, and to get its
+     * rank among the missing fragments by counting the missing ones before it.
      */
-#define MISSING_STORAGE_SIZE ( BITARRAY_BYTES( FRAG_MAX_NB ) )
-    uint8_t FragMissing[MISSING_STORAGE_SIZE];
+#define MISSING_STORAGE_WORDS ( BITARRAY_WORDS( FRAG_MAX_NB ) )
+    uint32_t FragMissing[MISSING_STORAGE_WORDS];
 
     /*
      * Array containing Status.FragNbLost elements.
@@ -175,12 +205,22 @@ typedef struct
      * at the Nth position in this array.
      * I.e. if fragments #4 and #7 are missing (1-indexed), the content is [3, 6]
      * Type is a uint16_t because we might have more than 255 uncoded fragments.
-     * We could also remove this if we do an exhaustive search through FragMissing, by keeping count
-     * of the real index and the number of missing bits set to 1.
      */
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    uint32_t MissingIndexAddr;
+#else
     uint16_t FragMissingIndex[FRAG_MAX_FRAME_LOSS];
+#endif
+
+    uint32_t S[BITARRAY_WORDS( FRAG_MAX_FRAME_LOSS )];
 
-    uint8_t S[BITARRAY_BYTES( FRAG_MAX_FRAME_LOSS )];
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    /*
+     * Cache of MatrixM2B and FragMissingIndex, line i holds the addresses whose line
+     * number is i modulo FRAG_DECODER_CACHE_NB_LINES.
+     */
+    FragCacheLine_t Cache[FRAG_DECODER_CACHE_NB_LINES];
+#endif
 
     FragDecoderStatus_t Status;
 } FragDecoder_t;
@@ -210,7 +250,7 @@ static void GetRow( uint8_t* src, uint16_t row, uint16_t size );
  *
  * \retval parity         Parity value at the given index
  */
-STATIC uint8_t GetParity( uint16_t index, uint8_t* matrixRow );
+STATIC uint8_t GetParity( uint16_t index, uint32_t* matrixRow );
 
 /*!
  * \brief Sets the parity value on the given row of the parity matrix
@@ -219,7 +259,7 @@ STATIC uint8_t GetParity( uint16_t index, uint8_t* matrixRow );
  * \param [IN/OUT] matrixRow Pointer to the parity matrix.
  * \param [IN]     parity    The parity value to be set in the parity matrix
  */
-STATIC void SetParity( uint16_t index, uint8_t* matrixRow, uint8_t parity );
+STATIC void SetParity( uint16_t index, uint32_t* matrixRow, uint8_t parity );
 
 /*!
  * \brief Check if the provided value is a power of 2
@@ -231,7 +271,7 @@ STATIC void SetParity( uint16_t index, uint8_t* matrixRow, uint8_t parity );
 static bool IsPowerOfTwo( uint32_t x );
 
 /*!
- * \brief XOrs two data lines
+ * \brief XOrs two data lines, 32 bits at a time
  *
  * \param [IN]  line1  1st Data line to be XORed
  * \param [IN]  line2  2nd Data line to be XORed
@@ -250,7 +290,7 @@ static void XorDataLine( uint8_t* line1, uint8_t* line2, int32_t size );
  *
  * \param [OUT] result XOR( line1, line2 ) result stored in line1
  */
-static void XorParityLine( uint8_t* line1, uint8_t* line2, int32_t size );
+static void XorParityLine( uint32_t* line1, uint32_t* line2, int32_t size );
 
 /*!
  * \brief Generates a pseudo random number : PRBS23
@@ -268,7 +308,7 @@ static int32_t FragPrbs23( int32_t value );
  * \param [IN]  m         Fragment number
  * \param [OUT] matrixRow Parity matrix
  */
-STATIC void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t* matrixRow );
+STATIC void FragGetParityMatrixRow( int32_t n, int32_t m, uint32_t* matrixRow );
 
 /*!
  * \brief Finds the index of the first one in a bit array
@@ -277,7 +317,7 @@ STATIC void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t* matrixRow );
  * \param [IN] size     Bit array size
  * \retval index        The index of the first 1 in the bit array
  */
-static uint16_t BitArrayFindFirstOne( uint8_t* bitArray, uint16_t size );
+static uint16_t BitArrayFindFirstOne( uint32_t* bitArray, uint16_t size );
 
 /*!
  * \brief Checks if the provided bit array only contains zeros
@@ -286,7 +326,7 @@ static uint16_t BitArrayFindFirstOne( uint8_t* bitArray, uint16_t size );
  * \param [IN] size     Bit array size
  * \retval isAllZeros   [0: Contains ones, 1: Contains all zeros]
  */
-static uint8_t BitArrayIsAllZeros( uint8_t* bitArray, uint16_t size );
+static uint8_t BitArrayIsAllZeros( uint32_t* bitArray, uint16_t size );
 
 /*!
  * \brief Finds & marks missing fragments
@@ -307,15 +347,60 @@ static void FragFindMissingFrags( uint16_t counter );
 static uint16_t FragFindMissingIndex( uint16_t x );
 
 /*!
- * \brief Find the index of missing fragment x in the small table
+ * \brief Stores the index (frag counter) of the x th missing frag
+ *
+ * \param [IN] x     x th missing frag
+ * \param [IN] index The counter value associated to the x th missing frag
+ */
+static void FragSetMissingIndex( uint16_t x, uint16_t index );
+
+/*!
+ * \brief Reads words of the M2B binary matrix
  *
- * \param [IN] fragCounter      Number of the missing fragment (1-indexed)
+ * \param [IN]  offset  Index of the first word in the matrix
+ * \param [OUT] dst     Destination words
+ * \param [IN]  nbWords Number of words to read
+ */
+static void FragMatrixRead( uint32_t offset, uint32_t* dst, uint16_t nbWords );
+
+/*!
+ * \brief Writes words of the M2B binary matrix
+ *
+ * \param [IN] offset  Index of the first word in the matrix
+ * \param [IN] src     Source words
+ * \param [IN] nbWords Number of words to write
+ */
+static void FragMatrixWrite( uint32_t offset, const uint32_t* src, uint16_t nbWords );
+
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+/*!
+ * \brief Gets the cache line holding an address, loading it through the callbacks on a miss
+ *
+ * \param [IN] tag     Address of the line divided by FRAG_DECODER_CACHE_LINE_SIZE
+ * \retval line        The cache line
+ */
+static FragCacheLine_t* FragCacheGetLine( uint32_t tag );
+
+/*!
+ * \brief Reads or writes bytes behind the callbacks through the cache
+ *
+ * \param [IN]     addr  Address of the first byte
+ * \param [IN/OUT] data  Bytes read or to be written
+ * \param [IN]     size  Number of bytes
+ * \param [IN]     write True to write data, false to read it
+ */
+static void FragCacheAccess( uint32_t addr, uint8_t* data, uint32_t size, bool write );
+#endif
+
+/*!
+ * \brief Gets the offset in words of a row of the M2B binary matrix
+ *
+ * \param [IN] rowIndex  Matrix row index           Max FRAG_MAX_FRAME_LOSS
+ * \param [IN] bitsInRow Number of bits in one row. Max FRAG_MAX_FRAME_LOSS
  *
- * \retval index    The index of the missing fragment in the small matrix. (0-indexed)
- *                  If the index is not found, FRAG_MAX_FRAME_LOSS is returned
- *                  to indicate an error, and the caller should check this condition.
+ * \retval offset        Index of the first word of the row in FragDecoder.MatrixM2B
  */
-static uint16_t FragFindMissing( uint16_t fragCounter );
+static uint32_t FragGetBinaryMatrixRowOffset( uint16_t rowIndex, uint16_t bitsInRow );
 
 /*!
  * \brief Extacts a row from the M2B binary matrix and expands it to a bitArray
@@ -324,7 +409,7 @@ static uint16_t FragFindMissing( uint16_t fragCounter );
  * \param [IN] rowIndex  Matrix row index           Max FRAG_MAX_FRAME_LOSS
  * \param [IN] bitsInRow Number of bits in one row. Max FRAG_MAX_FRAME_LOSS
  */
-STATIC void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+STATIC void FragExtractLineFromBinaryMatrix( uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*!
  * \brief Collapses and Pushs a row of a bit array to the M2B matrix
@@ -333,7 +418,20 @@ STATIC void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowInde
  * \param [IN] rowIndex  Matrix row index           Max FRAG_MAX_FRAME_LOSS
  * \param [IN] bitsInRow Number of bits in one row. Max FRAG_MAX_FRAME_LOSS
  */
-STATIC void FragPushLineToBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+STATIC void FragPushLineToBinaryMatrix( uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+
+#if defined( FRAG_DECODER_INCREMENTAL )
+/*!
+ * \brief Gets a bit of a row of the M2B binary matrix
+ *
+ * \param [IN] rowIndex  Matrix row index           Max FRAG_MAX_FRAME_LOSS
+ * \param [IN] column    Index of the bit, not below rowIndex
+ * \param [IN] bitsInRow Number of bits in one row. Max FRAG_MAX_FRAME_LOSS
+ *
+ * \retval bit           Value of the bit
+ */
+static uint8_t FragGetBinaryMatrixBit( uint16_t rowIndex, uint16_t column, uint16_t bitsInRow );
+#endif
 
 /*
  *=============================================================================
@@ -345,7 +443,11 @@ static FragDecoder_t FragDecoder;
 
 int32_t FragDecoderInit( uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t* callbacks )
 {
-    if( !callbacks || !callbacks->FragDecoderWrite || !callbacks->FragDecoderRead )
+    if( !callbacks || !callbacks->FragDecoderWrite || !callbacks->FragDecoderRead
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+        || !callbacks->FragDecoderMatrixWrite || !callbacks->FragDecoderMatrixRead
+#endif
+    )
     {
         SMTC_MODEM_HAL_TRACE_ERROR( "FRAG No callback defined!\n" );
         return FRAG_SESSION_ERROR;
@@ -365,30 +467,47 @@ int32_t FragDecoderInit( uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks
     FragDecoder.Status.FragNbLost   = 0;
     FragDecoder.M2BLine             = 0;
 
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    // The missing fragment index and the matrix rows are always written before being read, only drop the cache
+    FragDecoder.MissingIndexAddr = 0;
+    FragDecoder.MatrixM2BAddr    = FRAG_CACHE_ALIGN( ( uint32_t ) MIN( fragNb, FRAG_MAX_FRAME_LOSS ) * 2 );
+    for( uint16_t i = 0; i < FRAG_DECODER_CACHE_NB_LINES; i++ )
+    {
+        FragDecoder.Cache[i].Tag   = FRAG_CACHE_TAG_NONE;
+        FragDecoder.Cache[i].Dirty = false;
+    }
+#else
     // Initialize missing fragments index array
     for( uint16_t i = 0; i < FRAG_MAX_FRAME_LOSS; i++ )
     {
         FragDecoder.FragMissingIndex[i] = 0;
     }
-    for( size_t i = 0; i < MISSING_STORAGE_SIZE; i++ )
+#endif
+    for( size_t i = 0; i < MISSING_STORAGE_WORDS; i++ )
     {
         FragDecoder.FragMissing[i] = 0;
     }
 
     // Initialize parity matrix
-    for( uint32_t i = 0; i < BITARRAY_BYTES( FRAG_MAX_FRAME_LOSS ); i++ )
+    for( uint32_t i = 0; i < BITARRAY_WORDS( FRAG_MAX_FRAME_LOSS ); i++ )
     {
         FragDecoder.S[i] = 0;
     }
 
-    for( uint32_t i = 0; i < M2B_STORAGE_SIZE; i++ )
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    SMTC_MODEM_HAL_TRACE_INFO( "Missing %3d bytes\n", MISSING_STORAGE_WORDS * 4 );
+    SMTC_MODEM_HAL_TRACE_INFO( "Cache   %3d bytes\n", FRAG_DECODER_CACHE_NB_LINES * FRAG_DECODER_CACHE_LINE_SIZE );
+    SMTC_MODEM_HAL_TRACE_INFO( "Matrix  %d bytes\n", FragDecoderGetMatrixMemorySize( fragNb ) );
+#else
+    for( uint32_t i = 0; i < M2B_STORAGE_WORDS; i++ )
     {
-        FragDecoder.MatrixM2B[i] = 0xFF;
+        FragDecoder.MatrixM2B[i] = 0;
     }
 
-    SMTC_MODEM_HAL_TRACE_INFO( "Missing %3d bytes\n", MISSING_STORAGE_SIZE );
-    SMTC_MODEM_HAL_TRACE_INFO( "MIndex  %3d bytes\n", FRAG_MAX_FRAME_LOSS );
-    SMTC_MODEM_HAL_TRACE_INFO( "M2B     %3d bytes\n", M2B_STORAGE_SIZE );
+    SMTC_MODEM_HAL_TRACE_INFO( "Missing %3d bytes\n", MISSING_STORAGE_WORDS * 4 );
+    SMTC_MODEM_HAL_TRACE_INFO( "MIndex  %3d bytes\n", FRAG_MAX_FRAME_LOSS * 2 );
+    SMTC_MODEM_HAL_TRACE_INFO( "M2B     %3d bytes\n", M2B_STORAGE_WORDS * 4 );
+#endif
 
     // Initialize final uncoded data buffer ( FRAG_MAX_NB * FRAG_MAX_SIZE )
     // erase Delta update storage pages
@@ -412,21 +531,33 @@ uint32_t FragDecoderGetMaxFileSize( void )
     return FRAG_MAX_NB * FRAG_MAX_SIZE;
 }
 
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+uint32_t FragDecoderGetMatrixMemorySize( uint16_t fragNb )
+{
+    uint16_t maxLost = MIN( fragNb, FRAG_MAX_FRAME_LOSS );
+    uint32_t size    = FRAG_CACHE_ALIGN( ( uint32_t ) maxLost * 2 );
+
+    size += M2B_WORDS( ( uint32_t ) maxLost ) * 4;
+    // The cache reads and writes back whole lines
+    return FRAG_CACHE_ALIGN( size );
+}
+#endif
+
 FragDecoderSessionStatus_t FragDecoderProcess( uint16_t fragCounter, uint8_t* rawData )
 {
     uint16_t firstOneInRow = 0;
     int32_t  first         = 0;
     int32_t  noInfo        = 0;
 
-    uint8_t matrixRow[( FRAG_MAX_NB >> 3 ) + 1];
-    uint8_t matrixDataTemp[FRAG_MAX_SIZE];
-    uint8_t dataTempVector[( FRAG_MAX_FRAME_LOSS >> 3 ) + 1];
-    uint8_t dataTempVector2[( FRAG_MAX_FRAME_LOSS >> 3 ) + 1];
+    uint32_t matrixRow[BITARRAY_WORDS( FRAG_MAX_NB )];
+    uint8_t  matrixDataTemp[FRAG_MAX_SIZE];
+    uint32_t dataTempVector[BITARRAY_WORDS( FRAG_MAX_FRAME_LOSS )];
+    uint32_t dataTempVector2[BITARRAY_WORDS( FRAG_MAX_FRAME_LOSS )];
 
-    memset1( matrixRow, 0, ( FRAG_MAX_NB >> 3 ) + 1 );
+    memset1( ( uint8_t* ) matrixRow, 0, sizeof( matrixRow ) );
     memset1( matrixDataTemp, 0, FRAG_MAX_SIZE );
-    memset1( dataTempVector, 0, ( FRAG_MAX_FRAME_LOSS >> 3 ) + 1 );
-    memset1( dataTempVector2, 0, ( FRAG_MAX_FRAME_LOSS >> 3 ) + 1 );
+    memset1( ( uint8_t* ) dataTempVector, 0, sizeof( dataTempVector ) );
+    memset1( ( uint8_t* ) dataTempVector2, 0, sizeof( dataTempVector2 ) );
 
     SMTC_MODEM_HAL_TRACE_INFO( "FragProcess cnt %d nb_frag %d frag_size %d\n", fragCounter, FragDecoder.FragNb,
                                FragDecoder.FragSize );
@@ -492,47 +623,47 @@ FragDecoderSessionStatus_t FragDecoderProcess( uint16_t fragCounter, uint8_t* ra
 
     SMTC_MODEM_HAL_TRACE_INFO( "Checking if this fragments brings interesting information\n" );
     DATA_PRINT_FRAG( "Raw", rawData, FragDecoder.FragSize );
-    for( int32_t i = 0; i < FragDecoder.FragNb; i++ )
+    // Rank of the first fragment of the current word among the missing ones
+    uint16_t nbMissingBefore = 0;
+    for( uint16_t w = 0; w < BITARRAY_WORDS( FragDecoder.FragNb ); w++ )
     {
-        if( GetParity( i, matrixRow ) == 1 )  // This fragment brings potentially new data for missing frag i
+        uint32_t missing  = FragDecoder.FragMissing[w];
+        uint32_t received = matrixRow[w] & ~missing;
+        uint32_t unknown  = matrixRow[w] & missing;
+
+        // These fragments have already been received, remove them from the coded one
+        while( received != 0 )
         {
-            if( GetParity( i, FragDecoder.FragMissing ) == 0 )  // Nope, already received
-            {
-                SetParity( i, matrixRow, 0 );
-                GetRow( matrixDataTemp, i, FragDecoder.FragSize );
-                XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
-                SMTC_MODEM_HAL_TRACE_INFO( "Fragment %d already received\n", i + 1 );
-                DATA_PRINT_FRAG( "XOR", rawData, FragDecoder.FragSize );
-            }
-            else  // New unknown data, store it somewhere
-            {
-                // Fill the "little" boolean matrix m2b
-                // - Fragment {fragCounter} can give information on fragment {i}.
-                // - Fragment {i} is the {n}th missing, we need to find n
-                // Warning, we need to give the real fragCounter (1-indexed)
-                uint16_t nth = FragFindMissing( i + 1 );
-                if( nth >= FRAG_MAX_FRAME_LOSS )
-                {
-                    // We didn't find it, maybe we have too many frames lost?
-                    // We panic, because this should really not happen
-                    // and means we have a deeper source of errors.
-                    smtc_modem_hal_mcu_panic( "Could not find missing fragment %d in FragMissingIndex\n", i + 1 );
-                }
+            uint16_t i = ( w << 5 ) + __builtin_ctz( received );
+            received &= received - 1;
+
+            GetRow( matrixDataTemp, i, FragDecoder.FragSize );
+            XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
+            SMTC_MODEM_HAL_TRACE_INFO( "Fragment %d already received\n", i + 1 );
+            DATA_PRINT_FRAG( "XOR", rawData, FragDecoder.FragSize );
+        }
+        matrixRow[w] &= missing;
 
-                // - We store that this fragment {fragCounter} can retrieve data for the {n}th in dataTempVector
-                SMTC_MODEM_HAL_TRACE_INFO(
-                    "Fragment %d could bring new data for fragment %d (missing #%d) (total %d)\n", fragCounter, i + 1,
-                    nth, FragDecoder.Status.FragNbLost );
-                SMTC_MODEM_HAL_TRACE_INFO( "SetParity for missing %d\n", nth );
+        // New unknown data, store it somewhere
+        while( unknown != 0 )
+        {
+            uint32_t bit = __builtin_ctz( unknown );
+            unknown &= unknown - 1;
 
-                SetParity( nth, dataTempVector, 1 );
-                if( first == 0 )
-                {
-                    // Used to tell that we received at least one useful redundant fragment
-                    first = 1;
-                }
-            }
+            // Fill the "little" boolean matrix m2b
+            // - Fragment {fragCounter} can give information on fragment {i}.
+            // - Fragment {i} is the {n}th missing, the missing fragments are stored in increasing order
+            uint16_t nth = nbMissingBefore + __builtin_popcount( missing & ( ( 1UL << bit ) - 1 ) );
+
+            // - We store that this fragment {fragCounter} can retrieve data for the {n}th in dataTempVector
+            SMTC_MODEM_HAL_TRACE_INFO( "Fragment %d could bring new data for fragment %d (missing #%d) (total %d)\n",
+                                       fragCounter, ( w << 5 ) + bit + 1, nth, FragDecoder.Status.FragNbLost );
+
+            SetParity( nth, dataTempVector, 1 );
+            // Used to tell that we received at least one useful redundant fragment
+            first = 1;
         }
+        nbMissingBefore += __builtin_popcount( missing );
     }
     PARITY_LINE_PRINT( "matrixRow", matrixRow, 0, FragDecoder.FragNb );
 
@@ -544,10 +675,38 @@ FragDecoderSessionStatus_t FragDecoderProcess( uint16_t fragCounter, uint8_t* ra
     if( first > 0 )
     {
         int32_t li;
-        int32_t lj;
 
         // Manage a new line in MatrixM2B
         PARITY_LINE_PRINT( "S", FragDecoder.S, 0, FRAG_MAX_FRAME_LOSS );
+#if defined( FRAG_DECODER_INCREMENTAL )
+        // The rows of MatrixM2B are fully reduced, none of them has a one in the column of another one: a single pass
+        // removes all the already diagonalized missing fragments from the coded one
+        for( uint16_t w = firstOneInRow >> 5; w < BITARRAY_WORDS( FragDecoder.Status.FragNbLost ); w++ )
+        {
+            uint32_t known = dataTempVector[w] & FragDecoder.S[w];
+            while( known != 0 )
+            {
+                uint16_t row = ( w << 5 ) + __builtin_ctz( known );
+                known &= known - 1;
+
+                FragExtractLineFromBinaryMatrix( dataTempVector2, row, FragDecoder.Status.FragNbLost );
+                XorParityLine( dataTempVector, dataTempVector2, FragDecoder.Status.FragNbLost );
+
+                li = FragFindMissingIndex( row );
+                GetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
+                DATA_PRINT_FRAG( "XOR2", rawData, FragDecoder.FragSize );
+            }
+        }
+        if( BitArrayIsAllZeros( dataTempVector, FragDecoder.Status.FragNbLost ) )
+        {
+            noInfo = 1;
+        }
+        else
+        {
+            firstOneInRow = BitArrayFindFirstOne( dataTempVector, FragDecoder.Status.FragNbLost );
+        }
+#else
         while( GetParity( firstOneInRow, FragDecoder.S ) == 1 )
         {
             // Row already diagonalized exist & ( FragDecoder.MatrixM2B[firstOneInRow][0] )
@@ -567,6 +726,7 @@ FragDecoderSessionStatus_t FragDecoderProcess( uint16_t fragCounter, uint8_t* ra
             }
             firstOneInRow = BitArrayFindFirstOne( dataTempVector, FragDecoder.Status.FragNbLost );
         }
+#endif
 
         if( noInfo == 0 )
         {
@@ -578,29 +738,64 @@ FragDecoderSessionStatus_t FragDecoderProcess( uint16_t fragCounter, uint8_t* ra
             SetParity( firstOneInRow, FragDecoder.S, 1 );
             FragDecoder.M2BLine++;
             DATA_PRINT_FRAG( "SAVE", rawData, FragDecoder.FragSize );
+
+#if defined( FRAG_DECODER_INCREMENTAL )
+            // Remove the new row from the rows above having a one in its column, only the rows below
+            // firstOneInRow can, as each row only holds the bits right of its diagonal
+            for( uint16_t w = 0; w <= ( firstOneInRow >> 5 ); w++ )
+            {
+                uint32_t rows = FragDecoder.S[w];
+                if( w == ( firstOneInRow >> 5 ) )
+                {
+                    rows &= ( 1UL << ( firstOneInRow & 31 ) ) - 1;
+                }
+                while( rows != 0 )
+                {
+                    uint16_t row = ( w << 5 ) + __builtin_ctz( rows );
+                    rows &= rows - 1;
+
+                    if( FragGetBinaryMatrixBit( row, firstOneInRow, FragDecoder.Status.FragNbLost ) == 0 )
+                    {
+                        continue;
+                    }
+                    FragExtractLineFromBinaryMatrix( dataTempVector2, row, FragDecoder.Status.FragNbLost );
+                    XorParityLine( dataTempVector2, dataTempVector, FragDecoder.Status.FragNbLost );
+                    FragPushLineToBinaryMatrix( dataTempVector2, row, FragDecoder.Status.FragNbLost );
+
+                    li = FragFindMissingIndex( row );
+                    GetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                    XorDataLine( matrixDataTemp, rawData, FragDecoder.FragSize );
+                    SetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                }
+            }
+#endif
         }
 
         if( FragDecoder.M2BLine == FragDecoder.Status.FragNbLost )
         {
+#if !defined( FRAG_DECODER_INCREMENTAL )
             // Then last step diagonalized
             // Step 5 from the paper
             if( FragDecoder.Status.FragNbLost > 1 )
             {
-                int32_t i, j;
+                int32_t i;
+                int32_t lj;
 
                 for( i = ( FragDecoder.Status.FragNbLost - 2 ); i >= 0; i-- )
                 {
                     li = FragFindMissingIndex( i );
                     GetRow( matrixDataTemp, li, FragDecoder.FragSize );
-                    for( j = ( FragDecoder.Status.FragNbLost - 1 ); j > i; j-- )
+
+                    // The rows below i are already solved, remove the ones right of the diagonal of row i
+                    FragExtractLineFromBinaryMatrix( dataTempVector2, i, FragDecoder.Status.FragNbLost );
+                    SetParity( i, dataTempVector2, 0 );
+                    for( uint16_t w = i >> 5; w < BITARRAY_WORDS( FragDecoder.Status.FragNbLost ); w++ )
                     {
-                        FragExtractLineFromBinaryMatrix( dataTempVector2, i, FragDecoder.Status.FragNbLost );
-                        FragExtractLineFromBinaryMatrix( dataTempVector, j, FragDecoder.Status.FragNbLost );
-                        if( GetParity( j, dataTempVector2 ) == 1 )
+                        uint32_t ones = dataTempVector2[w];
+                        while( ones != 0 )
                         {
-                            XorParityLine( dataTempVector2, dataTempVector, FragDecoder.Status.FragNbLost );
-
-                            lj = FragFindMissingIndex( j );
+                            lj = FragFindMissingIndex( ( w << 5 ) + __builtin_ctz( ones ) );
+                            ones &= ones - 1;
 
                             GetRow( rawData, lj, FragDecoder.FragSize );
                             XorDataLine( matrixDataTemp, rawData, FragDecoder.FragSize );
@@ -609,6 +804,7 @@ FragDecoderSessionStatus_t FragDecoderProcess( uint16_t fragCounter, uint8_t* ra
                     SetRow( matrixDataTemp, li, FragDecoder.FragSize );
                 }
             }
+#endif
 
             SMTC_MODEM_HAL_TRACE_INFO( "Session reconstructed, FragNbLost %d\n", FragDecoder.Status.FragNbLost );
             return FRAG_SESSION_OK;
@@ -653,49 +849,55 @@ static void GetRow( uint8_t* dst, uint16_t row, uint16_t size )
     }
 }
 
-STATIC uint8_t GetParity( uint16_t index, uint8_t* matrixRow )
-{
-    uint8_t parity;
-    parity = matrixRow[index >> 3];
-    parity = ( parity >> ( 7 - ( index % 8 ) ) ) & 0x01;
-    return parity;
-}
-
-STATIC void SetParity( uint16_t index, uint8_t* matrixRow, uint8_t parity )
+STATIC uint8_t GetParity( uint16_t index, uint32_t* matrixRow )
 {
-    uint8_t mask          = 0xFF - ( 1 << ( 7 - ( index % 8 ) ) );
-    parity                = parity << ( 7 - ( index % 8 ) );
-    matrixRow[index >> 3] = ( matrixRow[index >> 3] & mask ) + parity;
+    return ( matrixRow[index >> 5] >> ( index & 31 ) ) & 0x01;
 }
 
-static bool IsPowerOfTwo( uint32_t x )
+STATIC void SetParity( uint16_t index, uint32_t* matrixRow, uint8_t parity )
 {
-    uint8_t sumBit = 0;
+    uint32_t mask = 1UL << ( index & 31 );
 
-    for( uint8_t i = 0; i < 32; i++ )
+    if( parity != 0 )
     {
-        sumBit += ( x & ( 1 << i ) ) >> i;
+        matrixRow[index >> 5] |= mask;
     }
-    if( sumBit == 1 )
+    else
     {
-        return true;
+        matrixRow[index >> 5] &= ~mask;
     }
-    return false;
+}
+
+static bool IsPowerOfTwo( uint32_t x )
+{
+    return ( x != 0 ) && ( ( x & ( x - 1 ) ) == 0 );
 }
 
 static void XorDataLine( uint8_t* line1, uint8_t* line2, int32_t size )
 {
-    for( int32_t i = 0; i < size; i++ )
+    int32_t i = 0;
+
+    // The data lines have no alignment guarantee, memcpy lets the compiler pick the best word access
+    for( ; ( i + 4 ) <= size; i += 4 )
+    {
+        uint32_t word1;
+        uint32_t word2;
+        memcpy( &word1, &line1[i], sizeof( word1 ) );
+        memcpy( &word2, &line2[i], sizeof( word2 ) );
+        word1 ^= word2;
+        memcpy( &line1[i], &word1, sizeof( word1 ) );
+    }
+    for( ; i < size; i++ )
     {
         line1[i] = line1[i] ^ line2[i];
     }
 }
 
-static void XorParityLine( uint8_t* line1, uint8_t* line2, int32_t size )
+static void XorParityLine( uint32_t* line1, uint32_t* line2, int32_t size )
 {
-    for( int32_t i = 0; i < size; i++ )
+    for( int32_t i = 0; i < BITARRAY_WORDS( size ); i++ )
     {
-        SetParity( i, line1, ( GetParity( i, line1 ) ^ GetParity( i, line2 ) ) );
+        line1[i] ^= line2[i];
     }
 }
 
@@ -704,10 +906,9 @@ static int32_t FragPrbs23( int32_t value )
     int32_t b0 = value & 0x01;
     int32_t b1 = ( value & 0x20 ) >> 5;
     return ( value >> 1 ) + ( ( b0 ^ b1 ) << 22 );
-    ;
 }
 
-STATIC void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t* matrixRow )
+STATIC void FragGetParityMatrixRow( int32_t n, int32_t m, uint32_t* matrixRow )
 {
     int32_t mTemp;
     int32_t x;
@@ -724,7 +925,7 @@ STATIC void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t* matrixRow )
     }
 
     x = 1 + ( 1001 * n );
-    for( uint32_t i = 0; i < ( ( m >> 3 ) + 1 ); i++ )
+    for( int32_t i = 0; i < BITARRAY_WORDS( m ); i++ )
     {
         matrixRow[i] = 0;
     }
@@ -744,28 +945,32 @@ STATIC void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t* matrixRow )
     }
 }
 
-static uint16_t BitArrayFindFirstOne( uint8_t* bitArray, uint16_t size )
+static uint16_t BitArrayFindFirstOne( uint32_t* bitArray, uint16_t size )
 {
-    for( uint16_t i = 0; i < size; i++ )
+    for( uint16_t i = 0; i < BITARRAY_WORDS( size ); i++ )
     {
-        if( GetParity( i, bitArray ) == 1 )
+        if( bitArray[i] != 0 )
         {
-            return i;
+            uint16_t index = ( i << 5 ) + __builtin_ctz( bitArray[i] );
+            return ( index < size ) ? index : 0;
         }
     }
     return 0;
 }
 
-static uint8_t BitArrayIsAllZeros( uint8_t* bitArray, uint16_t size )
+static uint8_t BitArrayIsAllZeros( uint32_t* bitArray, uint16_t size )
 {
-    for( uint16_t i = 0; i < size; i++ )
+    uint32_t ones = 0;
+
+    for( uint16_t i = 0; i < ( size >> 5 ); i++ )
     {
-        if( GetParity( i, bitArray ) == 1 )
-        {
-            return 0;
-        }
+        ones |= bitArray[i];
+    }
+    if( ( size & 31 ) != 0 )
+    {
+        ones |= bitArray[size >> 5] & ( ( 1UL << ( size & 31 ) ) - 1 );
     }
-    return 1;
+    return ( ones == 0 ) ? 1 : 0;
 }
 
 /*!
@@ -784,7 +989,7 @@ static void FragFindMissingFrags( uint16_t counter )
             SMTC_MODEM_HAL_TRACE_INFO( "Fragment %d is missing, store it at index %d\n", i + 1, i );
             SetParity( i, FragDecoder.FragMissing, 1 );
             // Nth missing fragment is number i+1 (we keep the 0-indexed value)
-            FragDecoder.FragMissingIndex[FragDecoder.Status.FragNbLost] = i;
+            FragSetMissingIndex( FragDecoder.Status.FragNbLost, i );
             FragDecoder.Status.FragNbLost++;
         }
     }
@@ -812,29 +1017,104 @@ static void FragFindMissingFrags( uint16_t counter )
  */
 static uint16_t FragFindMissingIndex( uint16_t x )
 {
-    SMTC_MODEM_HAL_TRACE_INFO( "FragFindMissingIndex x %d -> %d\n", x, FragDecoder.FragMissingIndex[x] );
-    return FragDecoder.FragMissingIndex[x];
+    uint16_t index;
+
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    FragCacheAccess( FragDecoder.MissingIndexAddr + ( ( uint32_t ) x << 1 ), ( uint8_t* ) &index, sizeof( index ),
+                     false );
+#else
+    index = FragDecoder.FragMissingIndex[x];
+#endif
+    SMTC_MODEM_HAL_TRACE_INFO( "FragFindMissingIndex x %d -> %d\n", x, index );
+    return index;
 }
 
-/*!
- * \brief Find the index of missing fragment x in the small table
- *
- * \param [IN] fragCounter      Number of the missing fragment (1-indexed)
- *
- * \retval index    The index of the missing fragment in the small matrix. (0-indexed)
- *                  If the index is not found, FRAG_MAX_FRAME_LOSS is returned
- *                  to indicate an error, and the caller should check this condition.
- */
-static uint16_t FragFindMissing( uint16_t fragCounter )
+static void FragSetMissingIndex( uint16_t x, uint16_t index )
+{
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    FragCacheAccess( FragDecoder.MissingIndexAddr + ( ( uint32_t ) x << 1 ), ( uint8_t* ) &index, sizeof( index ),
+                     true );
+#else
+    FragDecoder.FragMissingIndex[x] = index;
+#endif
+}
+
+static void FragMatrixRead( uint32_t offset, uint32_t* dst, uint16_t nbWords )
+{
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    FragCacheAccess( FragDecoder.MatrixM2BAddr + ( offset << 2 ), ( uint8_t* ) dst, ( uint32_t ) nbWords << 2, false );
+#else
+    memcpy( dst, &FragDecoder.MatrixM2B[offset], ( size_t ) nbWords << 2 );
+#endif
+}
+
+static void FragMatrixWrite( uint32_t offset, const uint32_t* src, uint16_t nbWords )
 {
-    for( uint16_t i = 0; i < FragDecoder.Status.FragNbLost; i++ )
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    FragCacheAccess( FragDecoder.MatrixM2BAddr + ( offset << 2 ), ( uint8_t* ) src, ( uint32_t ) nbWords << 2, true );
+#else
+    memcpy( &FragDecoder.MatrixM2B[offset], src, ( size_t ) nbWords << 2 );
+#endif
+}
+
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+static FragCacheLine_t* FragCacheGetLine( uint32_t tag )
+{
+    FragCacheLine_t* line = &FragDecoder.Cache[tag % FRAG_DECODER_CACHE_NB_LINES];
+
+    if( line->Tag != tag )
+    {
+        if( line->Dirty == true )
+        {
+            FragDecoder.Callbacks->FragDecoderMatrixWrite( line->Tag * FRAG_DECODER_CACHE_LINE_SIZE, line->Data,
+                                                           FRAG_DECODER_CACHE_LINE_SIZE );
+            line->Dirty = false;
+        }
+        FragDecoder.Callbacks->FragDecoderMatrixRead( tag * FRAG_DECODER_CACHE_LINE_SIZE, line->Data,
+                                                      FRAG_DECODER_CACHE_LINE_SIZE );
+        line->Tag = tag;
+    }
+    return line;
+}
+
+static void FragCacheAccess( uint32_t addr, uint8_t* data, uint32_t size, bool write )
+{
+    while( size > 0 )
     {
-        if( FragDecoder.FragMissingIndex[i] == fragCounter - 1 )
+        FragCacheLine_t* line  = FragCacheGetLine( addr / FRAG_DECODER_CACHE_LINE_SIZE );
+        uint32_t         pos   = addr % FRAG_DECODER_CACHE_LINE_SIZE;
+        uint32_t         chunk = MIN( size, FRAG_DECODER_CACHE_LINE_SIZE - pos );
+
+        if( write == true )
+        {
+            memcpy( &line->Data[pos], data, chunk );
+            line->Dirty = true;
+        }
+        else
         {
-            return i;
+            memcpy( data, &line->Data[pos], chunk );
         }
+        addr += chunk;
+        data += chunk;
+        size -= chunk;
     }
-    return FRAG_MAX_FRAME_LOSS;
+}
+#endif
+
+/*!
+ * \brief Gets the offset in words of a row of the M2B binary matrix
+ * Row i starts at its word i / 32, the rows of the 32 row block k are
+ * k words shorter than the rows of the first block.
+ *
+ * \param [IN] rowIndex  Matrix row index           Max FRAG_MAX_FRAME_LOSS
+ * \param [IN] bitsInRow Number of bits in one row. Max FRAG_MAX_FRAME_LOSS
+ */
+static uint32_t FragGetBinaryMatrixRowOffset( uint16_t rowIndex, uint16_t bitsInRow )
+{
+    uint32_t rowWords = BITARRAY_WORDS( bitsInRow );
+    uint32_t block    = rowIndex >> 5;
+
+    return ( ( block * rowWords - ( ( block * ( block - 1 ) ) >> 1 ) ) << 5 ) + ( rowIndex & 31 ) * ( rowWords - block );
 }
 
 /*!
@@ -846,34 +1126,16 @@ static uint16_t FragFindMissing( uint16_t fragCounter )
  * \param [IN] rowIndex  Matrix row index           Max FRAG_MAX_FRAME_LOSS
  * \param [IN] bitsInRow Number of bits in one row. Max FRAG_MAX_FRAME_LOSS
  */
-STATIC void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+STATIC void FragExtractLineFromBinaryMatrix( uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
 {
-    uint32_t findByte      = 0;
-    uint32_t findBitInByte = 0;
+    uint16_t first = rowIndex >> 5;
 
-    if( rowIndex > 0 )
-    {
-        findByte      = ( rowIndex * bitsInRow - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 ) ) >> 3;
-        findBitInByte = ( rowIndex * bitsInRow - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 ) ) % 8;
-    }
-    if( rowIndex > 0 )
-    {
-        for( uint16_t i = 0; i < rowIndex; i++ )
-        {
-            SetParity( i, bitArray, 0 );
-        }
-    }
-    for( uint16_t i = rowIndex; i < bitsInRow; i++ )
+    for( uint16_t i = 0; i < first; i++ )
     {
-        SetParity( i, bitArray, ( FragDecoder.MatrixM2B[findByte] >> ( 7 - findBitInByte ) ) & 0x01 );
-
-        findBitInByte++;
-        if( findBitInByte == 8 )
-        {
-            findBitInByte = 0;
-            findByte++;
-        }
+        bitArray[i] = 0;
     }
+    FragMatrixRead( FragGetBinaryMatrixRowOffset( rowIndex, bitsInRow ), &bitArray[first],
+                    BITARRAY_WORDS( bitsInRow ) - first );
 }
 
 /*!
@@ -884,32 +1146,27 @@ STATIC void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowInde
  * \param [IN] rowIndex  Matrix row index.          Max FRAG_MAX_FRAME_LOSS
  * \param [IN] bitsInRow Number of bits in one row. Max FRAG_MAX_FRAME_LOSS
  */
-STATIC void FragPushLineToBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+STATIC void FragPushLineToBinaryMatrix( uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
 {
-    uint32_t findByte      = 0;
-    uint32_t findBitInByte = 0;
+    uint32_t offset = FragGetBinaryMatrixRowOffset( rowIndex, bitsInRow );
+    uint16_t first  = rowIndex >> 5;
+    // Bits left of the diagonal are ignored
+    uint32_t diagonalWord = bitArray[first] & ~( ( 1UL << ( rowIndex & 31 ) ) - 1 );
 
-    if( rowIndex > 0 )
-    {
-        findByte      = ( rowIndex * bitsInRow - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 ) ) >> 3;
-        findBitInByte = ( rowIndex * bitsInRow - ( ( rowIndex * ( rowIndex - 1 ) ) >> 1 ) ) % 8;
-    }
-    SMTC_MODEM_HAL_TRACE_PRINTF( "PushLine row %d nb_bits %d | findByte %d bitInByte %d\n", rowIndex, bitsInRow,
-                                 findByte, findBitInByte );
+    SMTC_MODEM_HAL_TRACE_PRINTF( "PushLine row %d nb_bits %d | offset %d\n", rowIndex, bitsInRow, offset );
 
-    for( uint16_t i = rowIndex; i < bitsInRow; i++ )
-    {
-        if( GetParity( i, bitArray ) == 0 )
-        {
-            FragDecoder.MatrixM2B[findByte] =
-                FragDecoder.MatrixM2B[findByte] & ( 0xFF - ( 1 << ( 7 - findBitInByte ) ) );
-        }
-        findBitInByte++;
-        if( findBitInByte == 8 )
-        {
-            findBitInByte = 0;
-            findByte++;
-        }
-    }
+    FragMatrixWrite( offset, &diagonalWord, 1 );
+    FragMatrixWrite( offset + 1, &bitArray[first + 1], BITARRAY_WORDS( bitsInRow ) - first - 1 );
     PARITY_ARRAY_PRINT( "M2B", FragDecoder.MatrixM2B, bitsInRow, bitsInRow );
 }
+
+#if defined( FRAG_DECODER_INCREMENTAL )
+static uint8_t FragGetBinaryMatrixBit( uint16_t rowIndex, uint16_t column, uint16_t bitsInRow )
+{
+    uint32_t word;
+
+    FragMatrixRead( FragGetBinaryMatrixRowOffset( rowIndex, bitsInRow ) + ( column >> 5 ) - ( rowIndex >> 5 ), &word,
+                    1 );
+    return ( word >> ( column & 31 ) ) & 0x01;
+}
+#endif
@@ -43,13 +43,61 @@
  * The following parameters have an impact on the memory footprint.
  * The major contributors are the parity matrix and missing fragment index.
  *
- * Heap size >=   FRAG_MAX_FRAME_LOSS * (FRAG_MAX_FRAME_LOSS + 1) / 2 / 8
+ * Heap size >=   4 * 32 * W * (W + 1) / 2, with W = FRAG_MAX_FRAME_LOSS / 32 rounded up
  *              + 2 * FRAG_MAX_FRAME_LOSS
  *              + FRAG_MAX_NB / 8
  *
- * Stack size >= FRAG_MAX_NB
+ * Stack size >= FRAG_MAX_SIZE + FRAG_MAX_NB / 8 + FRAG_MAX_FRAME_LOSS / 4
+ *
+ * When FRAG_DECODER_MATRIX_IN_FLASH is defined, the parity matrix and the missing fragment index are stored in a memory
+ * of their own, through the FragDecoderMatrixWrite/FragDecoderMatrixRead callbacks, and only a cache of them is kept in
+ * RAM:
+ *
+ * Heap size >=   FRAG_DECODER_CACHE_NB_LINES * FRAG_DECODER_CACHE_LINE_SIZE
+ *              + FRAG_MAX_FRAME_LOSS / 8
+ *              + FRAG_MAX_NB / 8
+ *
+ * The memory behind the matrix callbacks must then hold FragDecoderGetMatrixMemorySize( fragNb ) bytes, and is
+ * written a whole cache line at a time.
+ *
+ * By default the missing fragments are solved by a back-substitution once enough coded fragments are received, so the
+ * call to FragDecoderProcess() completing the session reads about FRAG_MAX_FRAME_LOSS^2 / 2 rows. When
+ * FRAG_DECODER_INCREMENTAL is defined, the parity matrix is kept fully reduced as the coded fragments arrive: each call
+ * reads and writes at most 2 * FRAG_MAX_FRAME_LOSS rows and the session completes without a final step, at the cost
+ * of more row writes over the session.
  */
 
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+
+#ifndef FRAG_MAX_NB
+#define FRAG_MAX_NB 4096
+#endif
+
+#ifndef FRAG_MAX_SIZE
+#define FRAG_MAX_SIZE 200
+#endif
+
+#ifndef FRAG_MAX_FRAME_LOSS
+#define FRAG_MAX_FRAME_LOSS 1024
+#endif
+
+/*!
+ * Number of lines of the RAM cache of the parity matrix and missing fragment index
+ */
+#ifndef FRAG_DECODER_CACHE_NB_LINES
+#define FRAG_DECODER_CACHE_NB_LINES 8
+#endif
+
+/*!
+ * Size in bytes of a line of the RAM cache, a multiple of 4.
+ * Each line is read and written back as a whole through the callbacks.
+ */
+#ifndef FRAG_DECODER_CACHE_LINE_SIZE
+#define FRAG_DECODER_CACHE_LINE_SIZE 64
+#endif
+
+#else
+
 /*!
  * Maximum number of uncoded fragment that can be handled.
  *
@@ -75,6 +123,8 @@
  */
 #define FRAG_MAX_FRAME_LOSS 64
 
+#endif  // FRAG_DECODER_MATRIX_IN_FLASH
+
 /*!
  * \brief This return code indicates the state of the session
  */
@@ -125,6 +175,28 @@ typedef struct sFragDecoderCallbacks
      * \retval status Read operation status [0: Success, -1 Fail]
      */
     int8_t ( *FragDecoderRead )( uint32_t addr, uint8_t* data, uint32_t size );
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    /*!
+     * Writes `data` buffer of `size` starting at address `addr` of the parity matrix memory
+     *
+     * \param [IN] addr Address start index to write to.
+     * \param [IN] data Data buffer to be written.
+     * \param [IN] size Size of data buffer to be written.
+     *
+     * \retval status Write operation status [0: Success, -1 Fail]
+     */
+    int8_t ( *FragDecoderMatrixWrite )( uint32_t addr, uint8_t* data, uint32_t size );
+    /*!
+     * Reads `data` buffer of `size` starting at address `addr` of the parity matrix memory
+     *
+     * \param [IN] addr Address start index to read from.
+     * \param [OUT] data Data buffer to be read.
+     * \param [IN] size Size of data buffer to be read.
+     *
+     * \retval status Read operation status [0: Success, -1 Fail]
+     */
+    int8_t ( *FragDecoderMatrixRead )( uint32_t addr, uint8_t* data, uint32_t size );
+#endif
 } FragDecoderCallbacks_t;
 
 /*!
@@ -142,6 +214,18 @@ int32_t FragDecoderInit( uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks
  */
 uint32_t FragDecoderGetMaxFileSize( void );
 
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+/*!
+ * \brief Gets the size of the memory behind the matrix callbacks needed by a decoding session, for the parity matrix
+ *        and the missing fragment index
+ *
+ * \param [IN] fragNb   Number of expected fragments (without redundancy packets)
+ *
+ * \retval size Memory size in bytes
+ */
+uint32_t FragDecoderGetMatrixMemorySize( uint16_t fragNb );
+#endif
+
 /*!
  * \brief Gets the current file size that is configured in the decoding session
  *
@@ -178,7 +262,7 @@ FragDecoderStatus_t FragDecoderGetStatus( void );
  * \param [IN] m            Number of non-coded fragments
  * \param [OUT] matrixRow   Destination array
  */
-void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t* matrixRow );
+void FragGetParityMatrixRow( int32_t n, int32_t m, uint32_t* matrixRow );
 
 /*!
  * \brief Gets the binary triangular-sup matrix row from M2B
@@ -187,7 +271,7 @@ void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t* matrixRow );
  * \param [IN] rowIndex    Index of the requested row
  * \param [IN] bitsInRow   Size of the matrix
  */
-void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+void FragExtractLineFromBinaryMatrix( uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*!
  * \brief Store the binary triangular-sup matrix row to M2B
@@ -196,23 +280,23 @@ void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint
  * \param [IN] rowIndex    Index of the requested row
  * \param [IN] bitsInRow   Size of the matrix
  */
-void FragPushLineToBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+void FragPushLineToBinaryMatrix( uint32_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*!
- * \brief Gets the bit stored in a binary array
+ * \brief Gets the bit stored in a binary array of 32-bit words
  *
  * \param [IN] index        Index of the requested bit
  * \param [IN] matrixRow    Source array
  */
-uint8_t GetParity( uint16_t index, uint8_t* matrixRow );
+uint8_t GetParity( uint16_t index, uint32_t* matrixRow );
 
 /*!
- * \brief Sets the bit stored in a binary array
+ * \brief Sets the bit stored in a binary array of 32-bit words
  *
  * \param [IN] index        Index of the requested bit
  * \param [IN] matrixRow    Destination array
  */
-void SetParity( uint16_t index, uint8_t* matrixRow, uint8_t parity );
+void SetParity( uint16_t index, uint32_t* matrixRow, uint8_t parity );
 #endif
 
 #endif  // __FRAG_DECODER_H__
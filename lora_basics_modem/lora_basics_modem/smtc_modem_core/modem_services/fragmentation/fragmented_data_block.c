@@ -239,6 +239,65 @@ void frag_context_reset( void )
     nb_frag_coded_received       = 0;
 }
 
+/*!
+ * \brief Program data in flash, erasing its pages only when needed
+ *
+ * Programming only clears bits: the data is programmed over the current content when it does not set a bit back to 1,
+ * otherwise the 2 pages holding it are read, erased and written back with the data.
+ *
+ * \param [IN] target_address Flash address to write to.
+ * \param [IN] data           Data buffer to be written.
+ * \param [IN] size           Size of data buffer to be written.
+ *
+ * \retval status Write operation status [0: Success, -1 Fail]
+ */
+static int8_t frag_flash_program( uint32_t target_address, const uint8_t* data, uint32_t size )
+{
+    const uint8_t* flash        = ( const uint8_t* ) target_address;
+    bool           erase_needed = false;
+    uint32_t*      copy_page    = POOL_MEM.StartOfPoolMem;
+
+    for( uint32_t i = 0; i < size; i++ )
+    {
+        if( ( flash[i] & data[i] ) != data[i] )
+        {
+            erase_needed = true;
+            break;
+        }
+    }
+
+    if( erase_needed == false )
+    {
+        // Program the words holding the data, their other bytes keep the flash content
+        uint32_t first_word = target_address & ~3UL;
+        uint32_t end_word   = ( target_address + size + 3 ) & ~3UL;
+
+        memcpy( ( uint8_t* ) copy_page, ( uint8_t* ) first_word, end_word - first_word );
+        memcpy( ( uint8_t* ) copy_page + ( target_address - first_word ), data, size );
+        if( FlashWrite( ( first_word - FLASH_BASE ) >> 2, copy_page, ( end_word - first_word ) >> 2, 0, MainFlash ) !=
+            1 )
+        {
+            DEBUG_PRINT( DBG_FATAL, "Flash write error:%x\n", target_address );
+            return -1;
+        }
+        return 0;
+    }
+
+    target_address     = ( target_address - FLASH_BASE );
+    uint8_t page_start = target_address >> 11;
+    DEBUG_PRINT( DBG_NOTE, "page is %d\n", page_start );
+    memcpy( ( uint8_t* ) copy_page, ( uint8_t* ) ( ( page_start << 11 ) + FLASH_BASE ), 4096 );
+    memcpy( ( uint8_t* ) copy_page + ( target_address - ( page_start << 11 ) ), data, size );
+    FlashErasePage( page_start, MainFlash );
+    FlashErasePage( page_start + 1, MainFlash );
+    if( FlashWrite( ( page_start << 11 ) >> 2, copy_page, 1024, 0, MainFlash ) != 1 )
+    {
+        DEBUG_PRINT( DBG_FATAL, "Flash write error:%x\n", target_address );
+        return -1;
+    }
+    return 0;
+}
+
 /*!
  * \brief Write fragment to memory, callback for frag_decoder
  *
@@ -274,21 +333,7 @@ int8_t frag_decoder_write_fl( uint32_t addr, uint8_t* data, uint32_t size )
     // write
     DEBUG_PRINT( DBG_NOTE, "Flash write addr:%x,data:%x,size:%d\n", target_address, *data, size );
 
-    target_address       = ( target_address - FLASH_BASE );
-    uint8_t   page_start = target_address >> 11;
-    uint32_t* copy_page  = POOL_MEM.StartOfPoolMem;
-    DEBUG_PRINT( DBG_NOTE, "page is %d\n", page_start );
-    memcpy( ( uint8_t* ) copy_page, ( uint8_t* ) ( ( page_start << 11 ) + FLASH_BASE ), 4096 );
-    DEBUG_PRINT( DBG_NOTE, "page is %d\n", page_start );
-    memcpy( ( uint8_t* ) copy_page + ( target_address - ( page_start << 11 ) ), data, size );
-    FlashErasePage( page_start, MainFlash );
-    FlashErasePage( page_start + 1, MainFlash );
-    if( FlashWrite( ( page_start << 11 ) >> 2, copy_page, 1024, 0, MainFlash ) != 1 )
-    {
-        DEBUG_PRINT( DBG_FATAL, "Flash write error:%x\n", target_address );
-        return -1;
-    }
-    return 0;
+    return frag_flash_program( target_address, data, size );
 }
 
 /*!
@@ -339,10 +384,59 @@ int8_t frag_decoder_read_fl( uint32_t addr, uint8_t* data, uint32_t size )
     return -1;
 }
 
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+/*!
+ * \brief Write parity matrix to memory, callback for frag_decoder
+ *
+ * Writes `data` buffer of `size` starting at address `addr` of the parity matrix region
+ *
+ * \param [IN] addr Address start index to write to.
+ * \param [IN] data Data buffer to be written.
+ * \param [IN] size Size of data buffer to be written.
+ *
+ * \retval status Write operation status [0: Success, -1 Fail]
+ */
+int8_t frag_decoder_matrix_write_fl( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    if( ( data == NULL ) || ( ( addr + size ) > FRAG_MATRIX_SIZE_MAX ) )
+    {
+        DEBUG_PRINT( DBG_FATAL, "Flash matrix write error address out of limit:%x\n", addr + size );
+        return -1;
+    }
+    return frag_flash_program( FLASH_FRAG_MATRIX + addr, data, size );
+}
+
+/*!
+ * \brief Read parity matrix from memory, callback for frag_decoder
+ *
+ * Reads `data` buffer of `size` starting at address `addr` of the parity matrix region
+ *
+ * \param [IN] addr Address start index to read from.
+ * \param [IN] data Data buffer to be read.
+ * \param [IN] size Size of data buffer to be read.
+ *
+ * \retval status Read operation status [0: Success, -1 Fail]
+ */
+int8_t frag_decoder_matrix_read_fl( uint32_t addr, uint8_t* data, uint32_t size )
+{
+    if( ( data == NULL ) || ( ( addr + size ) > FRAG_MATRIX_SIZE_MAX ) )
+    {
+        DEBUG_PRINT( DBG_FATAL, "Flash matrix read error address out of limit:%x\n", addr + size );
+        return -1;
+    }
+    memcpy( data, ( uint8_t* ) ( FLASH_FRAG_MATRIX + addr ), size );
+    return 0;
+}
+#endif
+
 // Callback structure passed to frag_decoder
 static FragDecoderCallbacks_t frag_decoder_callbacks = {
     .FragDecoderWrite = frag_decoder_write_fl,
     .FragDecoderRead  = frag_decoder_read_fl,
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    .FragDecoderMatrixWrite = frag_decoder_matrix_write_fl,
+    .FragDecoderMatrixRead  = frag_decoder_matrix_read_fl,
+#endif
 };
 
 void frag_session_print( void )
@@ -1175,6 +1269,14 @@ void frag_construct_frag_session_setup_answer( void )
         SMTC_MODEM_HAL_TRACE_ERROR( "FragSessionSetup: Not enough memory\n" );
         frag_session_setup_ans |= ( 1 << FRAG_SESSION_SETUP_NO_MEMORY );
     }
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+    // The decoder stores its parity matrix in a flash region of its own
+    else if( FragDecoderGetMatrixMemorySize( frag_session_setup_req.nb_frag ) > FRAG_MATRIX_SIZE_MAX )
+    {
+        SMTC_MODEM_HAL_TRACE_ERROR( "FragSessionSetup: Not enough memory for the parity matrix\n" );
+        frag_session_setup_ans |= ( 1 << FRAG_SESSION_SETUP_NO_MEMORY );
+    }
+#endif
 
     if( frag_session_setup_req.control.frag_algo != 0 )
     {
@@ -1223,7 +1325,15 @@ void frag_construct_frag_session_setup_answer( void )
         session_cnt_prev = frag_session_setup_req.session_cnt;
 
         // Initialize underlying frag_decoder
-
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+        // The parity matrix lines are then programmed over erased flash, their pages are only erased again when a
+        // line sets a bit back to 1
+        for( uint32_t page = ( FLASH_FRAG_MATRIX - FLASH_BASE ) >> 11;
+             page < ( ( FLASH_FRAG_MATRIX + FRAG_MATRIX_SIZE_MAX - FLASH_BASE ) >> 11 ); page++ )
+        {
+            FlashErasePage( page, MainFlash );
+        }
+#endif
         rc = FragDecoderInit( frag_session_setup_req.nb_frag, frag_session_setup_req.frag_size,
                               &frag_decoder_callbacks );
         switch( rc )
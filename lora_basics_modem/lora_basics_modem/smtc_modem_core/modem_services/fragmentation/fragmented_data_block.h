@@ -108,6 +108,17 @@ extern "C" {
 #define FLASH_BASE ( uint32_t ) 0x80000
 #define FLASH_DELTA_UPDATE ( uint32_t ) 0xB6800
 
+#if defined( FRAG_DECODER_MATRIX_IN_FLASH )
+// Flash region of the parity matrix and missing fragment index of the decoder, apart from the data block. The default
+// holds the matrix of a full data block in 51-byte fragments. It must be reserved by the platform memory map.
+#ifndef FRAG_MATRIX_SIZE_MAX
+#define FRAG_MATRIX_SIZE_MAX ( 26 * 1024 )
+#endif
+#ifndef FLASH_FRAG_MATRIX
+#define FLASH_FRAG_MATRIX ( FLASH_DELTA_UPDATE - FRAG_MATRIX_SIZE_MAX )
+#endif
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
@@ -33,20 +33,11 @@
  */
 
 #include "modem_utilities.h"
+#include "smtc_crc32.h"
 
 uint32_t crc( const uint8_t* buf, int len )
 {
-    uint32_t crc = 0xFFFFFFFF;
-    while( len-- > 0 )
-    {
-        crc = crc ^ *buf++;
-        for( int i = 0; i < 8; i++ )
-        {
-            uint32_t mask = -( crc & 1 );
-            crc           = ( crc >> 1 ) ^ ( 0xEDB88320 & mask );
-        }
-    }
-    return ~crc;
+    return smtc_crc32( buf, ( uint32_t ) len );
 }
 uint32_t compute_crc_fw( void )
 {
@@ -0,0 +1,460 @@
+/*!
+ * \file      smtc_context_journal.c
+ *
+ * \brief     Journal of the modem contexts in non volatile memory
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+#include <stdint.h>   // C99 types
+#include <stdbool.h>  // bool type
+#include <string.h>
+
+#include "smtc_context_journal.h"
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_dbg_trace.h"
+#include "smtc_crc32.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/**
+ * @brief Size of a record of size bytes of context, rounded up to the write unit of the HAL
+ */
+#define JOURNAL_RECORD_LENGTH( size ) \
+    ( ( JOURNAL_RECORD_HEADER_SIZE + ( size ) + JOURNAL_WRITE_UNIT - 1 ) & ~( JOURNAL_WRITE_UNIT - 1 ) )
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define JOURNAL_PAGE_SIZE SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE
+#define JOURNAL_NB_PAGES SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES
+
+#if( JOURNAL_NB_PAGES < 2 ) || ( JOURNAL_NB_PAGES > 255 )
+#error "SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES must be in [2, 255]"
+#endif
+#if( JOURNAL_PAGE_SIZE > 65536 ) || ( ( JOURNAL_PAGE_SIZE % 32 ) != 0 )
+#error "SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE must be a multiple of 32, up to 64 KB"
+#endif
+
+#define JOURNAL_WRITE_UNIT 8
+#define JOURNAL_CHUNK_SIZE 32  // Size of the buffer of the copies, multiple of JOURNAL_WRITE_UNIT
+
+#define JOURNAL_PAGE_MAGIC 0x4C424D4A
+#define JOURNAL_PAGE_COMMITTED 0x00000000
+#define JOURNAL_PAGE_HEADER_SIZE 16
+#define JOURNAL_RECORD_HEADER_SIZE 8
+
+#define JOURNAL_NO_PAGE 0xFF
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/**
+ * @brief Header of a page, the first 8 bytes are written when the page is erased and the last 8 bytes once the latest
+ * records have been copied to it
+ */
+typedef struct journal_page_header_s
+{
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t state;
+    uint32_t rfu;
+} journal_page_header_t;
+
+/**
+ * @brief Header of a record, followed by the context and padded with 0xFF
+ */
+typedef struct journal_record_header_s
+{
+    uint8_t  type;
+    uint8_t  rfu;
+    uint16_t size;
+    uint32_t crc;  // crc of the first 4 bytes of the header and of the context
+} journal_record_header_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static smtc_context_journal_t  journal_default;
+static smtc_context_journal_t* journal = &journal_default;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+#if defined( ADD_SMTC_CONTEXT_JOURNAL )
+/**
+ * @brief Scan the pages to find the active one, and its records to find the latest one of each context
+ */
+static void journal_mount( void );
+
+/**
+ * @brief Compute the crc of a record of the journal
+ *
+ * @param [in] address Address of the record in the journal area
+ * @param [in] header  Header of the record
+ *
+ * @return Crc of the record
+ */
+static uint32_t journal_record_crc( const uint32_t address, const journal_record_header_t* header );
+
+/**
+ * @brief Compare the latest record of a context with a buffer
+ *
+ * @param [in] ctx_type Type of the context
+ * @param [in] buffer   Buffer to compare to
+ * @param [in] size     Buffer size in bytes
+ *
+ * @return true if the record holds the same bytes
+ */
+static bool journal_record_equals( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size );
+
+/**
+ * @brief Write a record
+ *
+ * @param [in] address  Address of the record in the journal area
+ * @param [in] ctx_type Type of the context
+ * @param [in] buffer   Context
+ * @param [in] size     Context size in bytes
+ */
+static void journal_write_record( const uint32_t address, const modem_context_type_t ctx_type, const uint8_t* buffer,
+                                  const uint32_t size );
+
+/**
+ * @brief Move to the next page: copy the latest records to it, except the one of the stored context, then write the
+ * stored context and commit the page
+ *
+ * @param [in] ctx_type Type of the stored context
+ * @param [in] buffer   Stored context
+ * @param [in] size     Stored context size in bytes
+ */
+static void journal_next_page( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size );
+#endif  // ADD_SMTC_CONTEXT_JOURNAL
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void smtc_context_journal_restore( const modem_context_type_t ctx_type, uint8_t* buffer, const uint32_t size )
+{
+#if defined( ADD_SMTC_CONTEXT_JOURNAL )
+    if( ctx_type >= MODEM_CONTEXT_TYPE_SIZE )
+    {
+        smtc_modem_hal_mcu_panic( "restore context %d not supported\n", ctx_type );
+        return;
+    }
+    if( journal->is_mounted == false )
+    {
+        journal_mount( );
+    }
+
+    if( journal->record_offset[ctx_type] == 0 )
+    {
+        // Not in the journal yet: context stored before the journal was enabled, or erased memory
+        smtc_modem_hal_context_restore( ctx_type, buffer, size );
+        return;
+    }
+
+    uint32_t address = ( journal->active_page * JOURNAL_PAGE_SIZE ) + journal->record_offset[ctx_type];
+    uint32_t length  = ( size < journal->record_size[ctx_type] ) ? size : journal->record_size[ctx_type];
+
+    smtc_modem_hal_context_journal_read( address + JOURNAL_RECORD_HEADER_SIZE, buffer, length );
+    memset( buffer + length, 0xFF, size - length );
+#else
+    smtc_modem_hal_context_restore( ctx_type, buffer, size );
+#endif  // ADD_SMTC_CONTEXT_JOURNAL
+}
+
+void smtc_context_journal_store( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size )
+{
+#if defined( ADD_SMTC_CONTEXT_JOURNAL )
+    if( ( ctx_type >= MODEM_CONTEXT_TYPE_SIZE ) ||
+        ( JOURNAL_RECORD_LENGTH( size ) > ( JOURNAL_PAGE_SIZE - JOURNAL_PAGE_HEADER_SIZE ) ) )
+    {
+        smtc_modem_hal_mcu_panic( "store context %d of %u bytes not supported\n", ctx_type, size );
+        return;
+    }
+    if( journal->is_mounted == false )
+    {
+        journal_mount( );
+    }
+
+    if( ( journal->record_offset[ctx_type] != 0 ) && ( journal_record_equals( ctx_type, buffer, size ) == true ) )
+    {
+        return;
+    }
+
+    if( ( journal->active_page == JOURNAL_NO_PAGE ) ||
+        ( ( journal->write_offset + JOURNAL_RECORD_LENGTH( size ) ) > JOURNAL_PAGE_SIZE ) )
+    {
+        journal_next_page( ctx_type, buffer, size );
+        return;
+    }
+
+    journal_write_record( ( journal->active_page * JOURNAL_PAGE_SIZE ) + journal->write_offset, ctx_type, buffer,
+                          size );
+    journal->record_offset[ctx_type] = journal->write_offset;
+    journal->record_size[ctx_type]   = size;
+    journal->write_offset += JOURNAL_RECORD_LENGTH( size );
+#else
+    smtc_modem_hal_context_store( ctx_type, buffer, size );
+
+    // dummy context reading to ensure context store is done before exiting the function
+    uint8_t dummy[4];
+    smtc_modem_hal_context_restore( ctx_type, dummy, ( size < sizeof( dummy ) ) ? size : sizeof( dummy ) );
+#endif  // ADD_SMTC_CONTEXT_JOURNAL
+}
+
+void smtc_context_journal_set_data( smtc_context_journal_t* data )
+{
+    journal = ( data != NULL ) ? data : &journal_default;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+#if defined( ADD_SMTC_CONTEXT_JOURNAL )
+static void journal_mount( void )
+{
+    journal_page_header_t page_header;
+
+    memset( journal, 0, sizeof( smtc_context_journal_t ) );
+    journal->is_mounted   = true;
+    journal->active_page  = JOURNAL_NO_PAGE;
+    journal->write_offset = JOURNAL_PAGE_SIZE;
+
+    // The active page is the committed page with the latest sequence number
+    for( uint32_t page = 0; page < JOURNAL_NB_PAGES; page++ )
+    {
+        smtc_modem_hal_context_journal_read( page * JOURNAL_PAGE_SIZE, ( uint8_t* ) &page_header,
+                                             sizeof( page_header ) );
+        if( ( page_header.magic == JOURNAL_PAGE_MAGIC ) && ( page_header.state == JOURNAL_PAGE_COMMITTED ) &&
+            ( ( journal->active_page == JOURNAL_NO_PAGE ) ||
+              ( ( int32_t )( page_header.sequence - journal->sequence ) > 0 ) ) )
+        {
+            journal->active_page = page;
+            journal->sequence    = page_header.sequence;
+        }
+    }
+    if( journal->active_page == JOURNAL_NO_PAGE )
+    {
+        return;
+    }
+
+    uint32_t page_address = journal->active_page * JOURNAL_PAGE_SIZE;
+    uint32_t offset       = JOURNAL_PAGE_HEADER_SIZE;
+
+    while( ( offset + JOURNAL_RECORD_HEADER_SIZE ) <= JOURNAL_PAGE_SIZE )
+    {
+        journal_record_header_t header;
+
+        smtc_modem_hal_context_journal_read( page_address + offset, ( uint8_t* ) &header, sizeof( header ) );
+        if( ( header.type == 0xFF ) && ( header.size == 0xFFFF ) && ( header.crc == 0xFFFFFFFF ) )
+        {
+            // Erased memory: end of the journal
+            break;
+        }
+        if( ( header.type >= MODEM_CONTEXT_TYPE_SIZE ) ||
+            ( header.size > ( JOURNAL_PAGE_SIZE - offset - JOURNAL_RECORD_HEADER_SIZE ) ) )
+        {
+            // Header of a record interrupted by a reset: the rest of the page is not trusted to be erased
+            offset = JOURNAL_PAGE_SIZE;
+            break;
+        }
+        // A record interrupted by a reset is skipped, the previous one of the context is kept
+        if( journal_record_crc( page_address + offset, &header ) == header.crc )
+        {
+            journal->record_offset[header.type] = offset;
+            journal->record_size[header.type]   = header.size;
+        }
+        offset += JOURNAL_RECORD_LENGTH( header.size );
+    }
+    journal->write_offset = offset;
+}
+
+static uint32_t journal_record_crc( const uint32_t address, const journal_record_header_t* header )
+{
+    uint8_t  chunk[JOURNAL_CHUNK_SIZE];
+    uint32_t record_crc = smtc_crc32_update( smtc_crc32_init( ), ( const uint8_t* ) header, 4 );
+
+    for( uint32_t index = 0; index < header->size; index += JOURNAL_CHUNK_SIZE )
+    {
+        uint32_t length =
+            ( ( header->size - index ) < JOURNAL_CHUNK_SIZE ) ? ( header->size - index ) : JOURNAL_CHUNK_SIZE;
+
+        smtc_modem_hal_context_journal_read( address + JOURNAL_RECORD_HEADER_SIZE + index, chunk, length );
+        record_crc = smtc_crc32_update( record_crc, chunk, length );
+    }
+    return smtc_crc32_final( record_crc );
+}
+
+static bool journal_record_equals( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size )
+{
+    uint8_t  chunk[JOURNAL_CHUNK_SIZE];
+    uint32_t address = ( journal->active_page * JOURNAL_PAGE_SIZE ) + journal->record_offset[ctx_type];
+
+    if( journal->record_size[ctx_type] != size )
+    {
+        return false;
+    }
+    for( uint32_t index = 0; index < size; index += JOURNAL_CHUNK_SIZE )
+    {
+        uint32_t length = ( ( size - index ) < JOURNAL_CHUNK_SIZE ) ? ( size - index ) : JOURNAL_CHUNK_SIZE;
+
+        smtc_modem_hal_context_journal_read( address + JOURNAL_RECORD_HEADER_SIZE + index, chunk, length );
+        if( memcmp( chunk, buffer + index, length ) != 0 )
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void journal_write_record( const uint32_t address, const modem_context_type_t ctx_type, const uint8_t* buffer,
+                                  const uint32_t size )
+{
+    uint8_t                 chunk[JOURNAL_CHUNK_SIZE];
+    journal_record_header_t header = {
+        .type = ( uint8_t ) ctx_type,
+        .rfu  = 0xFF,
+        .size = ( uint16_t ) size,
+    };
+    const uint32_t length = JOURNAL_RECORD_LENGTH( size );
+
+    uint32_t record_crc = smtc_crc32_update( smtc_crc32_init( ), ( const uint8_t* ) &header, 4 );
+    header.crc          = smtc_crc32_final( smtc_crc32_update( record_crc, buffer, size ) );
+
+    // The record is written in order, so that a record interrupted by a reset is detected by its crc
+    for( uint32_t index = 0; index < length; index += JOURNAL_CHUNK_SIZE )
+    {
+        uint32_t chunk_length = ( ( length - index ) < JOURNAL_CHUNK_SIZE ) ? ( length - index ) : JOURNAL_CHUNK_SIZE;
+
+        for( uint32_t i = 0; i < chunk_length; i++ )
+        {
+            uint32_t position = index + i;
+
+            if( position < JOURNAL_RECORD_HEADER_SIZE )
+            {
+                chunk[i] = ( ( const uint8_t* ) &header )[position];
+            }
+            else if( ( position - JOURNAL_RECORD_HEADER_SIZE ) < size )
+            {
+                chunk[i] = buffer[position - JOURNAL_RECORD_HEADER_SIZE];
+            }
+            else
+            {
+                chunk[i] = 0xFF;
+            }
+        }
+        smtc_modem_hal_context_journal_write( address + index, chunk, chunk_length );
+    }
+}
+
+static void journal_next_page( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size )
+{
+    uint8_t               chunk[JOURNAL_CHUNK_SIZE];
+    uint16_t              record_offset[MODEM_CONTEXT_TYPE_SIZE] = { 0 };
+    journal_page_header_t page_header                            = {
+        .magic    = JOURNAL_PAGE_MAGIC,
+        .sequence = journal->sequence + 1,
+        .state    = JOURNAL_PAGE_COMMITTED,
+        .rfu      = 0xFFFFFFFF,
+    };
+    uint32_t page   = ( journal->active_page + 1 ) % JOURNAL_NB_PAGES;
+    uint32_t offset = JOURNAL_PAGE_HEADER_SIZE;
+
+    if( journal->active_page == JOURNAL_NO_PAGE )
+    {
+        page                 = 0;
+        page_header.sequence = 0;
+    }
+
+    smtc_modem_hal_context_journal_erase_page( page );
+    smtc_modem_hal_context_journal_write( page * JOURNAL_PAGE_SIZE, ( const uint8_t* ) &page_header, 8 );
+
+    for( uint8_t type = 0; type < MODEM_CONTEXT_TYPE_SIZE; type++ )
+    {
+        if( ( type == ctx_type ) || ( journal->record_offset[type] == 0 ) )
+        {
+            continue;
+        }
+
+        uint32_t from   = ( journal->active_page * JOURNAL_PAGE_SIZE ) + journal->record_offset[type];
+        uint32_t length = JOURNAL_RECORD_LENGTH( journal->record_size[type] );
+
+        for( uint32_t index = 0; index < length; index += JOURNAL_CHUNK_SIZE )
+        {
+            uint32_t chunk_length =
+                ( ( length - index ) < JOURNAL_CHUNK_SIZE ) ? ( length - index ) : JOURNAL_CHUNK_SIZE;
+
+            smtc_modem_hal_context_journal_read( from + index, chunk, chunk_length );
+            smtc_modem_hal_context_journal_write( ( page * JOURNAL_PAGE_SIZE ) + offset + index, chunk, chunk_length );
+        }
+        record_offset[type] = offset;
+        offset += length;
+    }
+
+    if( ( offset + JOURNAL_RECORD_LENGTH( size ) ) > JOURNAL_PAGE_SIZE )
+    {
+        smtc_modem_hal_mcu_panic( "context journal page too small\n" );
+        return;
+    }
+    journal_write_record( ( page * JOURNAL_PAGE_SIZE ) + offset, ctx_type, buffer, size );
+    record_offset[ctx_type] = offset;
+    offset += JOURNAL_RECORD_LENGTH( size );
+
+    // The page replaces the previous one once committed
+    smtc_modem_hal_context_journal_write( ( page * JOURNAL_PAGE_SIZE ) + 8, ( const uint8_t* ) &page_header.state, 8 );
+
+    journal->active_page           = page;
+    journal->sequence              = page_header.sequence;
+    journal->write_offset          = offset;
+    journal->record_size[ctx_type] = size;
+    memcpy( journal->record_offset, record_offset, sizeof( record_offset ) );
+}
+#endif  // ADD_SMTC_CONTEXT_JOURNAL
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,143 @@
+/*!
+ * \file      smtc_context_journal.h
+ *
+ * \brief     Journal of the modem contexts in non volatile memory
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __SMTC_CONTEXT_JOURNAL_H__
+#define __SMTC_CONTEXT_JOURNAL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>   // C99 types
+#include <stdbool.h>  // bool type
+
+#include "smtc_modem_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*
+ * The modem stores its contexts through smtc_context_journal_store() and smtc_context_journal_restore().
+ *
+ * Without ADD_SMTC_CONTEXT_JOURNAL, they call smtc_modem_hal_context_store() and smtc_modem_hal_context_restore(): on
+ * most MCUs each store erases a flash page.
+ *
+ * With ADD_SMTC_CONTEXT_JOURNAL, the contexts are appended as records, protected by a crc, to the active page of the
+ * area of smtc_modem_hal_context_journal_read/write/erase_page(). A store of an unchanged context writes nothing. When
+ * the active page is full, the latest record of each context is copied to the next page, which becomes the active one
+ * once the copy is complete: the pages are erased in turn, and a reset during a store keeps the previous context. The
+ * records are indexed once, by a scan of the active page, and are then read directly.
+ *
+ * A record takes 8 bytes plus the context, rounded up to 8 bytes. With B bytes of records appended per day, each page
+ * is erased B / ( NB_PAGES * ( PAGE_SIZE - 16 - L ) ) times a day, L being the size of the latest records, which are
+ * copied to each new page.
+ *
+ * A context that is not in the journal yet is read with smtc_modem_hal_context_restore(), so the contexts stored
+ * before the journal was enabled are kept.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Index of the journal in RAM
+ */
+typedef struct smtc_context_journal_s
+{
+    bool     is_mounted;                              //!< The active page has been scanned
+    uint8_t  active_page;                             //!< Page holding the records
+    uint32_t sequence;                                //!< Number of the active page, incremented by each page change
+    uint32_t write_offset;                            //!< Offset of the next record in the active page
+    uint16_t record_offset[MODEM_CONTEXT_TYPE_SIZE];  //!< Offset of the latest record of each context, 0 if none
+    uint16_t record_size[MODEM_CONTEXT_TYPE_SIZE];    //!< Size of the latest record of each context
+} smtc_context_journal_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Restores a context
+ *
+ * @remark The bytes beyond the stored size read 0xFF, as erased memory
+ *
+ * @param [in] ctx_type   Type of modem context that need to be restored
+ * @param [out] buffer    Buffer pointer to write to
+ * @param [in] size       Buffer size to read in bytes
+ */
+void smtc_context_journal_restore( const modem_context_type_t ctx_type, uint8_t* buffer, const uint32_t size );
+
+/**
+ * @brief Stores a context
+ *
+ * @remark The context is in the non volatile memory when the function returns
+ *
+ * @param [in] ctx_type   Type of modem context that need to be saved
+ * @param [in] buffer     Buffer pointer to write from
+ * @param [in] size       Buffer size to write in bytes
+ */
+void smtc_context_journal_store( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size );
+
+/**
+ * @brief Select the index of the journal
+ *
+ * By default the journal uses its own internal index. Selecting another one allows several LoRaWAN stacks to run in
+ * the same process (e.g. host simulation), each one with its own non volatile memory. A zeroed index is scanned again
+ * at the next access.
+ *
+ * @param [in] data Index, NULL to go back to the internal index
+ */
+void smtc_context_journal_set_data( smtc_context_journal_t* data );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __SMTC_CONTEXT_JOURNAL_H__
+
+/* --- EOF ------------------------------------------------------------------ */
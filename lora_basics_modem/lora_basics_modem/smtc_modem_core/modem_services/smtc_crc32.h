@@ -0,0 +1,129 @@
+/*!
+ * \file      smtc_crc32.h
+ *
+ * \brief     CRC-32 of the modem integrity checks
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __SMTC_CRC32_H__
+#define __SMTC_CRC32_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>  // C99 types
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*
+ * CRC-32 of IEEE 802.3 (reflected polynomial 0xEDB88320, as zlib), computed:
+ * - by default 4 bits at a time, with a 64-byte table;
+ * - with SMTC_CRC32_SLICE_BY_8, 8 bytes at a time, with 8 KB of tables; or
+ * - with SMTC_CRC32_HAL, by smtc_modem_hal_crc32_update() (e.g. CRC unit of the MCU).
+ *
+ * The data can be processed in several parts:
+ *     crc = smtc_crc32_init( );
+ *     crc = smtc_crc32_update( crc, part1, size1 );
+ *     crc = smtc_crc32_update( crc, part2, size2 );
+ *     crc = smtc_crc32_final( crc );
+ */
+
+/**
+ * @brief Initial value of the running crc
+ */
+#define SMTC_CRC32_INIT 0xFFFFFFFF
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Get the initial value of the running crc
+ *
+ * @return SMTC_CRC32_INIT
+ */
+uint32_t smtc_crc32_init( void );
+
+/**
+ * @brief Update the running crc with the next part of the data
+ *
+ * @param [in] crc    Running crc
+ * @param [in] buffer Next part of the data
+ * @param [in] length Size of the part in bytes
+ *
+ * @return Running crc
+ */
+uint32_t smtc_crc32_update( uint32_t crc, const uint8_t* buffer, uint32_t length );
+
+/**
+ * @brief Get the crc of the data from the running crc
+ *
+ * @param [in] crc Running crc
+ *
+ * @return Crc of the data
+ */
+uint32_t smtc_crc32_final( uint32_t crc );
+
+/**
+ * @brief Compute the crc of a buffer
+ *
+ * @param [in] buffer Data
+ * @param [in] length Size of the data in bytes
+ *
+ * @return Crc of the data
+ */
+uint32_t smtc_crc32( const uint8_t* buffer, uint32_t length );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __SMTC_CRC32_H__
+
+/* --- EOF ------------------------------------------------------------------ */
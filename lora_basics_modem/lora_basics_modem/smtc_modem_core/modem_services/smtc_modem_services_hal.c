@@ -91,6 +91,16 @@ void smtc_modem_services_aes_encrypt( const uint8_t* raw_buffer, uint16_t size,
     }
 }
 
+void smtc_modem_services_aes_encrypt_at( const uint8_t* raw_buffer, uint16_t size, uint8_t aes_ctr_nonce[14],
+                                         uint16_t block_index, uint8_t* enc_buffer )
+{
+    if( smtc_modem_crypto_service_encrypt_at( raw_buffer, size, aes_ctr_nonce, block_index, enc_buffer ) !=
+        SMTC_MODEM_CRYPTO_RC_SUCCESS )
+    {
+        smtc_modem_hal_mcu_panic( "Encryption of lfu failed\n" );
+    }
+}
+
 uint32_t smtc_modem_services_get_time_s( void )
 {
     return smtc_modem_hal_get_compensated_time_in_s( );
@@ -39,6 +39,7 @@
 
 #include <stdint.h>   // C99 types
 #include <stdbool.h>  // bool type
+#include <string.h>   // memcpy
 
 #include "modem_supervisor.h"
 
@@ -213,6 +214,31 @@ static void check_class_b_to_generate_event( void );
 static void backoff_mobile_static( void );
 static void send_task_update( uint8_t event_type );
 
+/**
+ * @brief Copy an uplink and its payload in the queue of SEND_TASK
+ *
+ * @param [in] task The uplink, SEND_TASK id
+ * @return eTask_valid_t TASK_BUSY if the queue or its payload pool is full
+ */
+static eTask_valid_t uplink_queue_add( const smodem_task* task );
+
+/**
+ * @brief Remove an uplink from the queue of SEND_TASK and pack the payload pool
+ *
+ * @param [in] index Index of the uplink in the queue
+ */
+static void uplink_queue_remove( uint8_t index );
+
+/**
+ * @brief Mirror the first uplink of the queue in the SEND_TASK slot, or finish SEND_TASK if the queue is empty
+ */
+static void uplink_queue_arm( void );
+
+/**
+ * @brief Drop the queued uplinks whose deadline is reached, a TXDONE event is sent for each of them
+ */
+static void uplink_queue_drop_expired( void );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -292,7 +318,9 @@ void modem_supervisor_init_task( void )
         task_manager.modem_task[i].priority = TASK_FINISH;
         task_manager.modem_task[i].id       = ( task_id_t ) i;
     }
-    task_manager.next_task_id = IDLE_TASK;
+    task_manager.next_task_id           = IDLE_TASK;
+    task_manager.uplink_queue.nb_uplink = 0;
+    task_manager.uplink_queue.pool_used = 0;
 }
 
 eTask_priority modem_supervisor_get_task_priority( task_id_t id )
@@ -324,15 +352,21 @@ eTask_valid_t modem_supervisor_add_task( smodem_task* task )
     // in case of a previous task is already enqueue , the new task remove the old one.
     // as soon as a task has been elected by the modem supervisor , the task is managed by the stack itself and a new
     // task could be added inside the modem supervisor.
+    // The user uplinks are the exception: they are queued and SEND_TASK always holds the first of them.
+    if( task->id == SEND_TASK )
+    {
+        return uplink_queue_add( task );
+    }
     if( task->id < NUMBER_OF_TASKS )
     {
-        task_manager.modem_task[task->id].time_to_execute_s = task->time_to_execute_s;
-        task_manager.modem_task[task->id].priority          = task->priority;
-        task_manager.modem_task[task->id].fPort             = task->fPort;
-        task_manager.modem_task[task->id].fPort_present     = task->fPort_present;
-        task_manager.modem_task[task->id].dataIn            = task->dataIn;
-        task_manager.modem_task[task->id].sizeIn            = task->sizeIn;
-        task_manager.modem_task[task->id].PacketType        = task->PacketType;
+        task_manager.modem_task[task->id].time_to_execute_ms = task->time_to_execute_ms;
+        task_manager.modem_task[task->id].postponed_s        = task->postponed_s;
+        task_manager.modem_task[task->id].priority           = task->priority;
+        task_manager.modem_task[task->id].fPort              = task->fPort;
+        task_manager.modem_task[task->id].fPort_present      = task->fPort_present;
+        task_manager.modem_task[task->id].dataIn             = task->dataIn;
+        task_manager.modem_task[task->id].sizeIn             = task->sizeIn;
+        task_manager.modem_task[task->id].PacketType         = task->PacketType;
 
         return TASK_VALID;
     }
@@ -340,6 +374,14 @@ eTask_valid_t modem_supervisor_add_task( smodem_task* task )
     return TASK_NOT_VALID;
 }
 
+void modem_supervisor_set_task_delay( smodem_task* task, uint32_t delay_s, uint32_t delay_ms )
+{
+    // A date in ms is only valid up to 2^31 ms ahead, wait in steps beyond MODEM_MAX_TIME seconds
+    uint32_t step_s          = MIN( delay_s, MODEM_MAX_TIME );
+    task->time_to_execute_ms = smtc_modem_hal_get_time_in_ms( ) + ( step_s * 1000 ) + delay_ms;
+    task->postponed_s        = delay_s - step_s;
+}
+
 void modem_supervisor_launch_task( task_id_t id )
 {
     status_lorawan_t send_status = ERRORLORAWAN;
@@ -380,6 +422,25 @@ void modem_supervisor_launch_task( task_id_t id )
             send_task_update_needed = false;
             SMTC_MODEM_HAL_TRACE_WARNING( "The payload can't be send! internal code: %x\n", send_status );
         }
+
+        if( ( id == SEND_TASK ) && ( task_manager.uplink_queue.nb_uplink > 0 ) )
+        {
+            int32_t dtc_ms = lorawan_api_next_free_duty_cycle_ms_get( );
+
+            if( ( send_status != OKLORAWAN ) && ( dtc_ms > 0 ) )
+            {
+                // Held back by the duty cycle: keep the uplink at the head of the queue and try again when it allows
+                task_manager.uplink_queue.uplink[0].time_to_execute_ms = smtc_modem_hal_get_time_in_ms( ) + dtc_ms;
+                uplink_queue_arm( );
+                task_manager.next_task_id = IDLE_TASK;
+            }
+            else
+            {
+                // The payload has been copied by the stack, or it can't be sent and send_task_update reports a
+                // SMTC_MODEM_EVENT_TXDONE_NOT_SENT event: the next uplink is armed when this one is done
+                uplink_queue_remove( 0 );
+            }
+        }
         break;
     }
 
@@ -523,7 +584,15 @@ void modem_supervisor_launch_task( task_id_t id )
         file_upload_chunk_size =
             file_upload_get_fragment( file_upload_context, file_upload_chunk_payload,
                                       ( max_payload_size > 100 ) ? 100 : max_payload_size, lorawan_api_fcnt_up_get( ) );
-        if( file_upload_chunk_size > 0 )
+        if( file_upload_chunk_size < 0 )
+        {
+            // The file can't be read anymore => abort upload and generate event
+            SMTC_MODEM_HAL_TRACE_ERROR( "File upload aborted, the file cannot be read\n" );
+            increment_asynchronous_msgnumber( SMTC_MODEM_EVENT_UPLOADDONE, SMTC_MODEM_EVENT_UPLOADDONE_ABORTED );
+            set_modem_status_file_upload( false );
+            modem_set_upload_state( MODEM_UPLOAD_FINISHED );
+        }
+        else if( file_upload_chunk_size > 0 )
         {
             send_status =
                 lorawan_api_payload_send( get_modem_dm_port( ), true, file_upload_chunk_payload, file_upload_chunk_size,
@@ -799,6 +868,8 @@ void modem_supervisor_update_task( task_id_t id )
 
     case SEND_TASK:
         send_task_update( SMTC_MODEM_EVENT_TXDONE );
+        // Send the next queued uplink as soon as the duty cycle allows it
+        uplink_queue_arm( );
         break;
 
     case SEND_TASK_EXTENDED_1:
@@ -958,48 +1029,50 @@ uint32_t modem_supervisor_scheduler( void )
     }
 
     eTask_priority next_task_priority = TASK_FINISH;
-    int32_t        next_task_time     = MODEM_MAX_TIME;
+    int32_t        next_task_time_ms  = MODEM_MAX_TIME * 1000;
+    uint32_t       now_ms             = smtc_modem_hal_get_time_in_ms( );
 
-    // Find the highest priority task in the past
+    // Find the highest priority task in the past, or else the least in the future for wake up
     for( task_id_t i = 0; i < NUMBER_OF_TASKS; i++ )
     {
-        if( task_manager.modem_task[i].priority != TASK_FINISH )
+        smodem_task* task = &task_manager.modem_task[i];
+
+        if( task->priority == TASK_FINISH )
         {
-            int32_t next_task_time_tmp =
-                ( int32_t )( task_manager.modem_task[i].time_to_execute_s - smtc_modem_hal_get_time_in_s( ) );
+            continue;
+        }
 
-            if( ( next_task_time_tmp <= 0 ) && ( task_manager.modem_task[i].priority < next_task_priority ) )
-            {
-                next_task_priority        = task_manager.modem_task[i].priority;
-                next_task_time            = next_task_time_tmp;
-                task_manager.next_task_id = ( task_id_t ) i;
-            }
+        int32_t task_time_ms = ( int32_t )( task->time_to_execute_ms - now_ms );
+
+        // The delay beyond MODEM_MAX_TIME is waited in several steps
+        if( ( task_time_ms <= 0 ) && ( task->postponed_s > 0 ) )
+        {
+            uint32_t step_s = MIN( task->postponed_s, MODEM_MAX_TIME );
+            task->time_to_execute_ms += step_s * 1000;
+            task->postponed_s -= step_s;
+            task_time_ms = ( int32_t )( task->time_to_execute_ms - now_ms );
         }
-    }
 
-    // No task in the past was found, select the least in the future for wake up
-    if( next_task_priority == TASK_FINISH )
-    {
-        for( task_id_t i = 0; i < NUMBER_OF_TASKS; i++ )
+        if( task_time_ms <= 0 )
         {
-            if( task_manager.modem_task[i].priority != TASK_FINISH )
+            if( task->priority < next_task_priority )
             {
-                int32_t next_task_time_tmp =
-                    ( int32_t )( task_manager.modem_task[i].time_to_execute_s - smtc_modem_hal_get_time_in_s( ) );
-                if( next_task_time_tmp < next_task_time )
-                {
-                    next_task_time            = next_task_time_tmp;
-                    task_manager.next_task_id = ( task_id_t ) i;
-                }
+                next_task_priority        = task->priority;
+                next_task_time_ms         = task_time_ms;
+                task_manager.next_task_id = ( task_id_t ) i;
             }
         }
+        else if( ( next_task_priority == TASK_FINISH ) && ( task_time_ms < next_task_time_ms ) )
+        {
+            next_task_time_ms = task_time_ms;
+        }
     }
 
-    if( next_task_time > 0 )
+    if( next_task_time_ms > 0 )
     {
-        task_manager.sleep_duration = next_task_time;
+        task_manager.sleep_duration = next_task_time_ms;
         task_manager.next_task_id   = IDLE_TASK;
-        return ( next_task_time * 1000 );
+        return ( next_task_time_ms );
     }
     else
     {
@@ -1043,7 +1116,9 @@ uint32_t modem_supervisor_engine( void )
     if( ( LpState != LWPSTATE_IDLE ) && ( LpState != LWPSTATE_ERROR ) && ( LpState != LWPSTATE_INVALID ) )
     {
         LpState = lorawan_api_process( );
-        return ( CALL_LR1MAC_PERIOD_MS );
+        // The stack is driven by the radio planner events, which wake the host up: only wait for its own deadlines
+        uint32_t process_delay_ms = lorawan_api_next_process_delay_ms_get( );
+        return ( MIN( process_delay_ms, MODEM_EVENT_WAIT_MAX_MS ) );
     }
 
     backoff_mobile_static( );
@@ -1056,6 +1131,8 @@ uint32_t modem_supervisor_engine( void )
         task_manager.next_task_id = IDLE_TASK;
     }
 
+    uplink_queue_drop_expired( );
+
     uint8_t msgnumber_tmp;
     do
     {
@@ -1583,5 +1660,122 @@ static void send_task_update( uint8_t event_type )
     else
     {
         lorawan_api_duty_cycle_enable_set( SMTC_DTC_ENABLED );
+        // Keep it partially disabled for the emergency uplink queued behind this one
+        if( ( task_manager.uplink_queue.nb_uplink > 0 ) &&
+            ( task_manager.uplink_queue.uplink[0].priority == TASK_VERY_HIGH_PRIORITY ) )
+        {
+            lorawan_api_duty_cycle_enable_set( SMTC_DTC_PARTIAL_DISABLED );
+        }
+    }
+}
+
+static eTask_valid_t uplink_queue_add( const smodem_task* task )
+{
+    suplink_queue* queue = &task_manager.uplink_queue;
+
+    if( ( queue->nb_uplink >= MODEM_UPLINK_QUEUE_NB ) ||
+        ( ( queue->pool_used + task->sizeIn ) > MODEM_UPLINK_QUEUE_POOL_SIZE ) )
+    {
+        SMTC_MODEM_HAL_TRACE_WARNING( "Uplink queue full (%d uplinks, %d bytes)\n", queue->nb_uplink,
+                                      queue->pool_used );
+        return TASK_BUSY;
+    }
+
+    // Insert behind the uplinks of higher or same priority
+    uint8_t index = queue->nb_uplink;
+    while( ( index > 0 ) && ( queue->uplink[index - 1].priority > task->priority ) )
+    {
+        queue->uplink[index] = queue->uplink[index - 1];
+        index--;
+    }
+
+    smodem_uplink* uplink      = &queue->uplink[index];
+    uplink->time_to_execute_ms = task->time_to_execute_ms;
+    uplink->deadline_s         = task->deadline_s;
+    uplink->priority           = task->priority;
+    uplink->fPort              = task->fPort;
+    uplink->fPort_present      = task->fPort_present;
+    uplink->PacketType         = task->PacketType;
+    uplink->sizeIn             = task->sizeIn;
+    uplink->offset             = queue->pool_used;
+    if( task->sizeIn > 0 )
+    {
+        memcpy( &queue->pool[queue->pool_used], task->dataIn, task->sizeIn );
+    }
+    queue->pool_used += task->sizeIn;
+    queue->nb_uplink++;
+
+    uplink_queue_arm( );
+    return TASK_VALID;
+}
+
+static void uplink_queue_remove( uint8_t index )
+{
+    suplink_queue* queue  = &task_manager.uplink_queue;
+    uint16_t       offset = queue->uplink[index].offset;
+    uint8_t        size   = queue->uplink[index].sizeIn;
+
+    memmove( &queue->pool[offset], &queue->pool[offset + size], queue->pool_used - ( offset + size ) );
+    queue->pool_used -= size;
+
+    for( uint8_t i = index; i < ( queue->nb_uplink - 1 ); i++ )
+    {
+        queue->uplink[i] = queue->uplink[i + 1];
+    }
+    queue->nb_uplink--;
+
+    for( uint8_t i = 0; i < queue->nb_uplink; i++ )
+    {
+        if( queue->uplink[i].offset > offset )
+        {
+            queue->uplink[i].offset -= size;
+        }
+    }
+}
+
+static void uplink_queue_arm( void )
+{
+    const suplink_queue* queue = &task_manager.uplink_queue;
+    smodem_task*         task  = &task_manager.modem_task[SEND_TASK];
+
+    if( queue->nb_uplink == 0 )
+    {
+        task->priority = TASK_FINISH;
+        return;
     }
-}
\ No newline at end of file
+
+    task->time_to_execute_ms = queue->uplink[0].time_to_execute_ms;
+    task->postponed_s        = 0;
+    task->deadline_s         = queue->uplink[0].deadline_s;
+    task->priority           = queue->uplink[0].priority;
+    task->fPort              = queue->uplink[0].fPort;
+    task->fPort_present      = queue->uplink[0].fPort_present;
+    task->PacketType         = queue->uplink[0].PacketType;
+    task->dataIn             = &queue->pool[queue->uplink[0].offset];
+    task->sizeIn             = queue->uplink[0].sizeIn;
+}
+
+static void uplink_queue_drop_expired( void )
+{
+    suplink_queue* queue   = &task_manager.uplink_queue;
+    uint32_t       now     = smtc_modem_hal_get_time_in_s( );
+    bool           dropped = false;
+
+    for( uint8_t i = queue->nb_uplink; i > 0; i-- )
+    {
+        uint32_t deadline_s = queue->uplink[i - 1].deadline_s;
+        if( ( deadline_s != 0 ) && ( ( int32_t )( now - deadline_s ) >= 0 ) )
+        {
+            SMTC_MODEM_HAL_TRACE_WARNING( "Uplink on port %d dropped, deadline reached\n",
+                                          queue->uplink[i - 1].fPort );
+            uplink_queue_remove( i - 1 );
+            increment_asynchronous_msgnumber( SMTC_MODEM_EVENT_TXDONE, MODEM_TX_FAILED );
+            dropped = true;
+        }
+    }
+
+    if( dropped == true )
+    {
+        uplink_queue_arm( );
+    }
+}
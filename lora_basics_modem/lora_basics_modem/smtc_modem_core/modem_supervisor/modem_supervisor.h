@@ -70,6 +70,28 @@ extern "C" {
 #define CALL_LR1MAC_PERIOD_MS 400
 #define MODEM_MAX_ALARM_S 0x7FFFFFFF
 
+/*!
+ * Maximum delay before the engine is called again while the LoRaWAN stack waits for a radio planner event.
+ * The event itself wakes the host up, see smtc_modem_is_irq_flag_pending()
+ */
+#ifndef MODEM_EVENT_WAIT_MAX_MS
+#define MODEM_EVENT_WAIT_MAX_MS 10000
+#endif
+
+/*!
+ * Number of application uplinks that can be queued behind SEND_TASK
+ */
+#ifndef MODEM_UPLINK_QUEUE_NB
+#define MODEM_UPLINK_QUEUE_NB 4
+#endif
+
+/*!
+ * Size in bytes of the pool holding the payloads of the queued uplinks
+ */
+#ifndef MODEM_UPLINK_QUEUE_POOL_SIZE
+#define MODEM_UPLINK_QUEUE_POOL_SIZE 512
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
@@ -129,8 +151,9 @@ typedef enum
  */
 typedef enum eTask_valid
 {
-    TASK_VALID,     //!< Task valid
-    TASK_NOT_VALID  //!< Task not valid
+    TASK_VALID,      //!< Task valid
+    TASK_NOT_VALID,  //!< Task not valid
+    TASK_BUSY        //!< Task valid but the uplink queue is full
 } eTask_valid_t;
 
 typedef enum e_tx_mode
@@ -145,26 +168,57 @@ typedef enum e_tx_mode
  */
 typedef struct smodem_task
 {
-    task_id_t      id;                 //!< Type ID of the task
-    uint32_t       time_to_execute_s;  //!< The date to execute the task in second
-    eTask_priority priority;           //!< The priority
-    uint8_t        fPort;              //!< LoRaWAN frame port
-    bool           fPort_present;      //!< LoRaWAN frame port
-    const uint8_t* dataIn;             //!< Data in task
-    uint8_t        sizeIn;             //!< Data length in byte(s)
-    uint8_t        PacketType;         //!< LoRaWAN packet type ( Tx confirmed/Unconfirmed )
+    task_id_t      id;                  //!< Type ID of the task
+    uint32_t       time_to_execute_ms;  //!< The date to execute the task in ms, see modem_supervisor_set_task_delay()
+    uint32_t       postponed_s;         //!< Delay left beyond MODEM_MAX_TIME, waited once time_to_execute_ms is reached
+    eTask_priority priority;            //!< The priority
+    uint8_t        fPort;               //!< LoRaWAN frame port
+    bool           fPort_present;       //!< LoRaWAN frame port
+    const uint8_t* dataIn;              //!< Data in task
+    uint8_t        sizeIn;              //!< Data length in byte(s)
+    uint8_t        PacketType;          //!< LoRaWAN packet type ( Tx confirmed/Unconfirmed )
+    uint32_t       deadline_s;          //!< SEND_TASK only: date after which the uplink is dropped, 0 for none
 } smodem_task;
 
+/*!
+ * \typedef smodem_uplink
+ * \brief   Application uplink waiting in the queue of SEND_TASK
+ */
+typedef struct smodem_uplink
+{
+    uint32_t       time_to_execute_ms;  //!< The date to execute the uplink in ms
+    uint32_t       deadline_s;          //!< The date after which the uplink is dropped, 0 for none
+    eTask_priority priority;            //!< The priority
+    uint8_t        fPort;               //!< LoRaWAN frame port
+    bool           fPort_present;       //!< LoRaWAN frame port
+    uint8_t        PacketType;          //!< LoRaWAN packet type ( Tx confirmed/Unconfirmed )
+    uint8_t        sizeIn;              //!< Data length in byte(s)
+    uint16_t       offset;              //!< Offset of the data in the pool
+} smodem_uplink;
+
+/*!
+ * \typedef suplink_queue
+ * \brief   Queue of the application uplinks, the first one is mirrored in the SEND_TASK slot
+ */
+typedef struct suplink_queue
+{
+    smodem_uplink uplink[MODEM_UPLINK_QUEUE_NB];  //!< Ordered by priority, then by request order
+    uint8_t       nb_uplink;
+    uint16_t      pool_used;  //!< The payloads are packed at the start of the pool
+    uint8_t       pool[MODEM_UPLINK_QUEUE_POOL_SIZE];
+} suplink_queue;
+
 /*!
  * \typedef stask_manager
  * \brief   Supervisor task manager
  */
 typedef struct stask_manager
 {
-    smodem_task modem_task[NUMBER_OF_TASKS];
-    task_id_t   current_task_id;
-    task_id_t   next_task_id;
-    uint32_t    sleep_duration;
+    smodem_task   modem_task[NUMBER_OF_TASKS];
+    task_id_t     current_task_id;
+    task_id_t     next_task_id;
+    uint32_t      sleep_duration;  //!< Delay to the next task in ms
+    suplink_queue uplink_queue;
 
 } stask_manager;
 
@@ -226,12 +280,22 @@ eTask_valid_t modem_supervisor_remove_task( task_id_t id );
 
 /*!
  * \brief   Add a task in supervisor
- * \remark
+ * \remark  A task replaces the pending task of the same id, except SEND_TASK: its payload is copied and queued
+ *          behind the pending uplinks of higher or equal priority, and the uplinks are sent back-to-back.
  * \param task*  smodem_task
- * \retval eTask_valid_t
+ * \retval eTask_valid_t TASK_BUSY if the uplink queue or its payload pool is full
  */
 eTask_valid_t modem_supervisor_add_task( smodem_task* task );
 
+/*!
+ * \brief   Set the date of a task from now
+ * \remark  The date is kept in ms, the part of the delay beyond MODEM_MAX_TIME seconds is waited in several steps
+ * \param task*     smodem_task
+ * \param delay_s   Delay in second
+ * \param delay_ms  Delay in ms, added to delay_s
+ */
+void modem_supervisor_set_task_delay( smodem_task* task, uint32_t delay_s, uint32_t delay_ms );
+
 /**
  * @brief
  *
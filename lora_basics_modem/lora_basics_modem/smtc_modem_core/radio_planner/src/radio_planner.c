@@ -39,6 +39,17 @@
 
 #include <string.h>
 
+//
+// Private planner types
+//
+
+/**
+ * @brief rp_task_heap_cmp_t order of the tasks in a heap
+ *
+ * @return true if the task id_a has to be before the task id_b
+ */
+typedef bool ( *rp_task_heap_cmp_t )( const radio_planner_t* rp, const uint8_t id_a, const uint8_t id_b );
+
 //
 // Private planner utilities declaration
 //
@@ -76,11 +87,104 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
 static void rp_irq_get_status( radio_planner_t* rp, const uint8_t hook_id );
 
 /**
- * @brief rp_task_compute_ranking compute the ranking of the different tasks inside the radio planer
+ * @brief rp_task_queue_add add a scheduled or asap task to the heaps, or update its position if already there
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param hook_id id of the task
+ */
+static void rp_task_queue_add( radio_planner_t* rp, const uint8_t hook_id );
+
+/**
+ * @brief rp_task_queue_remove remove a task from the heaps, if there
  *
  * @param rp pointer to the radioplaner object itself
+ * @param hook_id id of the task
  */
-static void rp_task_compute_ranking( radio_planner_t* rp );
+static void rp_task_queue_remove( radio_planner_t* rp, const uint8_t hook_id );
+
+/**
+ * @brief rp_task_abort_late abort the scheduled tasks whose start time is in the past
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param now the current time in ms
+ */
+static void rp_task_abort_late( radio_planner_t* rp, const uint32_t now );
+
+/**
+ * @brief rp_task_heap_collect_before list the tasks of a heap ordered by start time that end before a given time
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param heap heap ordered by start time
+ * @param time tasks ending before this time are listed
+ * @param now the current time in ms, tasks ending before now are ignored
+ * @param hook_ids list of the ids of the tasks, completed by the function
+ * @param nb_hook_ids number of ids in the list, updated by the function
+ */
+static void rp_task_heap_collect_before( const radio_planner_t* rp, const rp_task_heap_t* heap, const uint32_t time,
+                                         const uint32_t now, uint8_t* hook_ids, uint8_t* nb_hook_ids );
+
+/**
+ * @brief rp_task_heap_init empty a heap
+ *
+ * @param heap the heap
+ */
+static void rp_task_heap_init( rp_task_heap_t* heap );
+
+/**
+ * @brief rp_task_heap_push add a task to a heap, or restore its position if its key has changed
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param heap the heap
+ * @param cmp the order of the heap
+ * @param hook_id id of the task
+ */
+static void rp_task_heap_push( const radio_planner_t* rp, rp_task_heap_t* heap, rp_task_heap_cmp_t cmp,
+                               const uint8_t hook_id );
+
+/**
+ * @brief rp_task_heap_remove remove a task from a heap, if there
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param heap the heap
+ * @param cmp the order of the heap
+ * @param hook_id id of the task
+ */
+static void rp_task_heap_remove( const radio_planner_t* rp, rp_task_heap_t* heap, rp_task_heap_cmp_t cmp,
+                                 const uint8_t hook_id );
+
+/**
+ * @brief rp_task_heap_sift move an element up or down a heap until the heap order is restored
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param heap the heap
+ * @param cmp the order of the heap
+ * @param position position of the element in the heap
+ */
+static void rp_task_heap_sift( const radio_planner_t* rp, rp_task_heap_t* heap, rp_task_heap_cmp_t cmp,
+                               uint8_t position );
+
+/**
+ * @brief rp_task_heap_top return the first task of a heap
+ *
+ * @param heap the heap
+ * @return uint8_t id of the first task, RP_NB_HOOKS if the heap is empty
+ */
+static uint8_t rp_task_heap_top( const rp_task_heap_t* heap );
+
+/**
+ * @brief rp_task_is_earlier order by start time, then by hook id
+ */
+static bool rp_task_is_earlier( const radio_planner_t* rp, const uint8_t id_a, const uint8_t id_b );
+
+/**
+ * @brief rp_task_is_older order by initial start time, then by hook id
+ */
+static bool rp_task_is_older( const radio_planner_t* rp, const uint8_t id_a, const uint8_t id_b );
+
+/**
+ * @brief rp_task_has_higher_priority order by priority (value 0 is the highest priority), then by hook id
+ */
+static bool rp_task_has_higher_priority( const radio_planner_t* rp, const uint8_t id_a, const uint8_t id_b );
 
 /**
  * @brief rp_task_launch_current call  the launch callback of the new running task
@@ -109,15 +213,6 @@ static uint8_t rp_task_select_next( radio_planner_t* rp, const uint32_t now );
  */
 static rp_next_state_status_t rp_task_get_next( radio_planner_t* rp, uint32_t* duration, uint8_t* task_id,
                                                 const uint32_t now );
-/**
- * @brief rp_task_find_highest_priority utilities to classify priority task (value 0 is the highest priority)
- *
- * @param vector a vector of value to classify from the lowest to the highest
- * @param length size of the vector
- * @return uint8_t index of the vector to indicate the position inside the vector of the minimum value
- */
-static uint8_t rp_task_find_highest_priority( uint8_t* vector, uint8_t length );
-
 /**
  * @brief rp_get_pkt_payload get the receive payload
  *
@@ -178,6 +273,22 @@ static void rp_timer_irq_callback( void* obj );
  */
 static void rp_hook_callback( radio_planner_t* rp, uint8_t id );
 
+/**
+ * @brief rp_irq_latency_update update the timing statistics with the latency between a radio irq and its hook callback
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param hook_id id of the hook about to be called
+ */
+static void rp_irq_latency_update( radio_planner_t* rp, const uint8_t hook_id );
+
+/**
+ * @brief rp_margin_update add a latency sample and compute the margin delay from its percentile
+ *
+ * @param rp pointer to the radioplaner object itself
+ * @param latency_ms latency between the timer expiry and the radio being ready in ms
+ */
+static void rp_margin_update( radio_planner_t* rp, const uint32_t latency_ms );
+
 /**
  * @brief rp_task_print debug print function for rp
  *
@@ -207,12 +318,17 @@ void rp_init( radio_planner_t* rp, const ralf_t* radio )
         rp->hook_callbacks[i]                   = NULL;
         rp->status[i]                           = RP_STATUS_TASK_INIT;
     }
+    rp_task_heap_init( &rp->schedule_heap );
+    rp_task_heap_init( &rp->asap_heap );
+    rp_task_heap_init( &rp->priority_heap );
     rp->priority_task.type  = RP_TASK_TYPE_NONE;
     rp->priority_task.state = RP_TASK_STATE_FINISHED;
     rp_stats_init( &rp->stats );
+    rp_timing_stats_init( &rp->timing_stats );
 
     rp->next_state_status = RP_STATUS_NO_MORE_TASK_SCHEDULE;
     rp->margin_delay      = RP_MARGIN_DELAY;
+    rp->margin.percentile = RP_MARGIN_PERCENTILE;
 }
 
 rp_hook_status_t rp_hook_init( radio_planner_t* rp, const uint8_t id, void ( *callback )( void* context ), void* hook )
@@ -311,7 +427,7 @@ rp_hook_status_t rp_task_enqueue( radio_planner_t* rp, const rp_task_t* task, ui
     }
     rp->tasks[hook_id].start_time_init_ms = rp->tasks[hook_id].start_time_ms;
     SMTC_MODEM_HAL_RP_TRACE_PRINTF( "RP: Task #%u enqueue with #%u priority\n", hook_id, rp->tasks[hook_id].priority );
-    rp_task_compute_ranking( rp );
+    rp_task_queue_add( rp, hook_id );
     if( rp->semaphore_radio == 0 )
     {
         rp_task_arbiter( rp, __func__ );
@@ -344,6 +460,7 @@ rp_hook_status_t rp_task_abort( radio_planner_t* rp, const uint8_t hook_id )
     else
     {
         rp->tasks[hook_id].state = RP_TASK_STATE_ABORTED;
+        rp_task_queue_remove( rp, hook_id );
 
         if( rp->semaphore_radio == 0 )
         {
@@ -382,6 +499,45 @@ rp_stats_t rp_get_stats( const radio_planner_t* rp )
     return rp->stats;
 }
 
+const rp_timing_stats_t* rp_get_timing_stats( const radio_planner_t* rp )
+{
+    return &rp->timing_stats;
+}
+
+void rp_reset_timing_stats( radio_planner_t* rp )
+{
+    rp_hal_critical_section_begin( );
+    rp_timing_stats_init( &rp->timing_stats );
+    rp_hal_critical_section_end( );
+}
+
+bool rp_get_irq_flag( const radio_planner_t* rp )
+{
+    return rp->irq_flag;
+}
+
+void rp_clear_irq_flag( radio_planner_t* rp )
+{
+    rp->irq_flag = false;
+}
+
+void rp_task_radio_ready( radio_planner_t* rp )
+{
+    rp->margin.ready_time_ms = rp_hal_get_time_in_ms( );
+    rp->margin.ready         = true;
+}
+
+void rp_set_margin_percentile( radio_planner_t* rp, const uint8_t percentile )
+{
+    rp_hal_critical_section_begin( );
+    rp->margin.percentile = ( percentile > 100 ) ? 100 : percentile;
+    // Start learning again from the default margin
+    memset( rp->margin.latency_ms, 0, sizeof( rp->margin.latency_ms ) );
+    rp->margin.nb_samples = 0;
+    rp->margin_delay      = RP_MARGIN_DELAY;
+    rp_hal_critical_section_end( );
+}
+
 void rp_radio_irq( radio_planner_t* rp )
 {
     if( rp->tasks[rp->radio_task_id].state < RP_TASK_STATE_ABORTED )
@@ -403,6 +559,7 @@ void rp_radio_irq( radio_planner_t* rp )
         if( ( rp->status[rp->radio_task_id] == RP_STATUS_CAD_NEGATIVE ) &&
             ( rp->tasks[rp->radio_task_id].type == RP_TASK_TYPE_CAD_TO_TX ) )
         {
+            rp_irq_latency_update( rp, rp->radio_task_id );
             rp_hook_callback( rp, rp->radio_task_id );
             return;
         }
@@ -411,6 +568,7 @@ void rp_radio_irq( radio_planner_t* rp )
         if( ( rp->status[rp->radio_task_id] == RP_STATUS_CAD_POSITIVE ) &&
             ( rp->tasks[rp->radio_task_id].type == RP_TASK_TYPE_CAD_TO_RX ) )
         {
+            rp_irq_latency_update( rp, rp->radio_task_id );
             rp_hook_callback( rp, rp->radio_task_id );
             return;
         }
@@ -418,8 +576,10 @@ void rp_radio_irq( radio_planner_t* rp )
 
         // Have to call rp_task_free before rp_hook_callback because the callback can enqueued a task and so call the
         // arbiter
+        rp_task_queue_remove( rp, rp->radio_task_id );
         rp_task_free( rp, &rp->tasks[rp->radio_task_id] );
         smtc_modem_hal_assert( ral_set_sleep( &( rp->radio->ral ), true ) == RAL_STATUS_OK );
+        rp_irq_latency_update( rp, rp->radio_task_id );
         rp_hook_callback( rp, rp->radio_task_id );
 
         rp_task_call_aborted( rp );
@@ -453,34 +613,37 @@ static void rp_task_free( const radio_planner_t* rp, rp_task_t* task )
 
 static void rp_task_update_time( radio_planner_t* rp, uint32_t now )
 {
-    for( int32_t i = 0; i < RP_NB_HOOKS; i++ )
+    uint8_t id;
+
+    // An asap task is automatically switch in schedule task after RP_TASK_ASAP_TO_SCHEDULE_TRIG_TIME ms, the oldest
+    // ones are on top of the asap heap
+    while( ( ( id = rp_task_heap_top( &rp->asap_heap ) ) != RP_NB_HOOKS ) &&
+           ( ( int32_t )( now - rp->tasks[id].start_time_init_ms ) > RP_TASK_ASAP_TO_SCHEDULE_TRIG_TIME ) )
     {
-        if( rp->tasks[i].state == RP_TASK_STATE_ASAP )
+        rp->tasks[id].state = RP_TASK_STATE_SCHEDULE;
+        // Schedule the task @ now + RP_TASK_RE_SCHEDULE_OFFSET_TIME
+        // seconds
+        rp->tasks[id].start_time_ms = now + RP_TASK_RE_SCHEDULE_OFFSET_TIME;
+        if( rp->tasks[id].schedule_task_low_priority == true )
         {
-            if( ( int32_t )( now - rp->tasks[i].start_time_init_ms ) > 0 )
-            {
-                rp->tasks[i].start_time_ms = now;
-            }
-            // An asap task is automatically switch in schedule task after RP_TASK_ASAP_TO_SCHEDULE_TRIG_TIME ms
+            rp->tasks[id].priority = ( RP_TASK_STATE_ASAP * RP_NB_HOOKS ) + id;
+        }
+        else
+        {
+            rp->tasks[id].priority = ( rp->tasks[id].state * RP_NB_HOOKS ) + id;
+        }
 
-            if( ( int32_t )( now - rp->tasks[i].start_time_init_ms ) > RP_TASK_ASAP_TO_SCHEDULE_TRIG_TIME )
-            {
-                rp->tasks[i].state = RP_TASK_STATE_SCHEDULE;
-                // Schedule the task @ now + RP_TASK_RE_SCHEDULE_OFFSET_TIME
-                // seconds
-                rp->tasks[i].start_time_ms = now + RP_TASK_RE_SCHEDULE_OFFSET_TIME;
-                if( rp->tasks[i].schedule_task_low_priority == true )
-                {
-                    rp->tasks[i].priority = ( RP_TASK_STATE_ASAP * RP_NB_HOOKS ) + i;
-                }
-                else
-                {
-                    rp->tasks[i].priority = ( rp->tasks[i].state * RP_NB_HOOKS ) + i;
-                }
-
-                SMTC_MODEM_HAL_RP_TRACE_PRINTF( "RP: WARNING - SWITCH TASK FROM ASAP TO SCHEDULE \n" );
-                rp_task_compute_ranking( rp );
-            }
+        SMTC_MODEM_HAL_RP_TRACE_PRINTF( "RP: WARNING - SWITCH TASK FROM ASAP TO SCHEDULE \n" );
+        rp_task_queue_add( rp, id );
+    }
+
+    // Update time for the remaining ASAP tasks to now
+    for( uint8_t i = 0; i < rp->asap_heap.size; i++ )
+    {
+        id = rp->asap_heap.hook_ids[i];
+        if( ( int32_t )( now - rp->tasks[id].start_time_init_ms ) > 0 )
+        {
+            rp->tasks[id].start_time_ms = now;
         }
     }
 
@@ -497,7 +660,10 @@ static void rp_task_update_time( radio_planner_t* rp, uint32_t now )
 
 static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
 {
-    uint32_t now = rp_hal_get_time_in_ms( );
+    // The time spent in the callbacks called by the arbiter is not part of its execution time
+    uint32_t arbiter_start_100us = rp_hal_get_time_in_100us( );
+    uint32_t callback_time_100us = rp->callback_time_100us;
+    uint32_t now                 = rp_hal_get_time_in_ms( );
 
     // Update time for ASAP task to now. But, also extended duration in case of running task is a RX task
     rp_task_update_time( rp, now );
@@ -516,9 +682,12 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
             if( rp->priority_task.state != RP_TASK_STATE_RUNNING )
             {
                 rp->stats.rp_error++;
+                rp_timing_stats_late_abort_update( &rp->timing_stats, rp_hal_get_time_in_100us( ),
+                                                   rp->priority_task.hook_id, delay );
                 SMTC_MODEM_HAL_TRACE_ERROR( " RP: ERROR - delay #%d - hook #%d\n", delay, rp->priority_task.hook_id );
 
                 rp->tasks[rp->priority_task.hook_id].state = RP_TASK_STATE_ABORTED;
+                rp_task_queue_remove( rp, rp->priority_task.hook_id );
             }
         }
         // Case where the high priority task is in the future
@@ -551,6 +720,7 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
 
                     rp->radio_task_id                  = rp->priority_task.hook_id;
                     rp->tasks[rp->radio_task_id].state = RP_TASK_STATE_RUNNING;
+                    rp_task_queue_remove( rp, rp->radio_task_id );
                     rp_task_launch_current( rp );
                 }  // else case already managed during enqueue task
             }
@@ -558,6 +728,7 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
             {  // Radio is sleeping start priority task on radio
                 rp->radio_task_id                  = rp->priority_task.hook_id;
                 rp->tasks[rp->radio_task_id].state = RP_TASK_STATE_RUNNING;
+                rp_task_queue_remove( rp, rp->radio_task_id );
                 rp_task_launch_current( rp );
             }
         }
@@ -573,6 +744,7 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
                 SMTC_MODEM_HAL_TRACE_WARNING( " RP: Aborted task with hook #%u - not a priority task\n ",
                                               rp->timer_hook_id );
                 rp->tasks[rp->timer_hook_id].state = RP_TASK_STATE_ABORTED;
+                rp_task_queue_remove( rp, rp->timer_hook_id );
             }
         }
         // Execute the garbage collection if the radio isn't running
@@ -601,6 +773,11 @@ static void rp_task_arbiter( radio_planner_t* rp, const char* caller_func_name )
         rp_task_call_aborted( rp );
         SMTC_MODEM_HAL_RP_TRACE_PRINTF( " RP: No more active tasks\n" );
     }
+
+    uint32_t arbiter_end_100us = rp_hal_get_time_in_100us( );
+    rp_timing_stats_arbiter_update(
+        &rp->timing_stats, arbiter_end_100us,
+        ( arbiter_end_100us - arbiter_start_100us ) - ( rp->callback_time_100us - callback_time_100us ) );
 }
 
 static void rp_irq_get_status( radio_planner_t* rp, const uint8_t hook_id )
@@ -680,20 +857,37 @@ static void rp_irq_get_status( radio_planner_t* rp, const uint8_t hook_id )
     }
 }
 
-static void rp_task_compute_ranking( radio_planner_t* rp )
+static void rp_task_queue_add( radio_planner_t* rp, const uint8_t hook_id )
 {
-    uint8_t rank;
-    uint8_t ranks_temp[RP_NB_HOOKS];
-
-    for( int32_t i = 0; i < RP_NB_HOOKS; i++ )
+    // The task may move from the asap heap to the schedule heap
+    rp_task_queue_remove( rp, hook_id );
+    if( rp->tasks[hook_id].state == RP_TASK_STATE_ASAP )
     {
-        ranks_temp[i] = rp->tasks[i].priority;
+        rp_task_heap_push( rp, &rp->asap_heap, rp_task_is_older, hook_id );
     }
-    for( int32_t i = 0; i < RP_NB_HOOKS; i++ )
+    else
+    {
+        rp_task_heap_push( rp, &rp->schedule_heap, rp_task_is_earlier, hook_id );
+    }
+    rp_task_heap_push( rp, &rp->priority_heap, rp_task_has_higher_priority, hook_id );
+}
+
+static void rp_task_queue_remove( radio_planner_t* rp, const uint8_t hook_id )
+{
+    rp_task_heap_remove( rp, &rp->schedule_heap, rp_task_is_earlier, hook_id );
+    rp_task_heap_remove( rp, &rp->asap_heap, rp_task_is_older, hook_id );
+    rp_task_heap_remove( rp, &rp->priority_heap, rp_task_has_higher_priority, hook_id );
+}
+
+static void rp_task_abort_late( radio_planner_t* rp, const uint32_t now )
+{
+    uint8_t id;
+
+    while( ( ( id = rp_task_heap_top( &rp->schedule_heap ) ) != RP_NB_HOOKS ) &&
+           ( ( int32_t )( rp->tasks[id].start_time_ms - now ) < 0 ) )
     {
-        rank             = rp_task_find_highest_priority( &( ranks_temp[0] ), RP_NB_HOOKS );
-        ranks_temp[rank] = 0xFF;
-        rp->rankings[i]  = rank;
+        rp->tasks[id].state = RP_TASK_STATE_ABORTED;
+        rp_task_queue_remove( rp, id );
     }
 }
 
@@ -709,58 +903,86 @@ static void rp_task_launch_current( radio_planner_t* rp )
     else
     {
         rp_task_print( rp, &rp->tasks[id] );
+        uint32_t start_time_ms      = rp->tasks[id].start_time_ms;
+        uint32_t launch_start_100us = rp_hal_get_time_in_100us( );
+        rp->margin.ready            = false;
         rp->tasks[id].launch_task_callbacks( ( void* ) rp );
+        uint32_t launch_end_100us = rp_hal_get_time_in_100us( );
+
+        // Only the scheduled tasks launched on timer expiry tell how much margin the board needs
+        if( ( rp->margin.ready == true ) && ( rp->margin.alarm_expired == true ) &&
+            ( rp->priority_task.state == RP_TASK_STATE_SCHEDULE ) )
+        {
+            int32_t latency_ms = ( int32_t )( rp->margin.ready_time_ms - rp->margin.alarm_time_ms );
+            rp_margin_update( rp, ( latency_ms > 0 ) ? ( uint32_t ) latency_ms : 0 );
+        }
+
+        // The launch callback returns once the radio is started, after the task start time if the margin is too small
+        rp->callback_time_100us += launch_end_100us - launch_start_100us;
+        rp_timing_stats_launch_update( &rp->timing_stats, launch_end_100us, id,
+                                       ( int32_t )( rp_hal_get_time_in_ms( ) - start_time_ms ),
+                                       launch_end_100us - launch_start_100us );
     }
 }
 
 static uint8_t rp_task_select_next( radio_planner_t* rp, const uint32_t now )
 {
-    uint8_t  hook_to_exe_tmp      = 0xFF;
+    uint8_t  hook_ids[RP_NB_HOOKS];
+    uint8_t  nb_hook_ids          = 0;
+    uint8_t  hook_to_exe_tmp      = RP_NB_HOOKS;
     uint32_t hook_time_to_exe_tmp = 0;
     uint32_t time_tmp             = 0;
-    uint8_t  rank                 = 0;
-    uint8_t  hook_id              = 0;
 
-    for( hook_id = 0; hook_id < RP_NB_HOOKS; hook_id++ )
-    {  // Garbage collector
-        if( ( rp->tasks[hook_id].state == RP_TASK_STATE_SCHEDULE ) &&
-            ( ( ( int32_t )( rp->tasks[hook_id].start_time_ms - now ) < 0 ) ) )
-        {
-            rp->tasks[hook_id].state = RP_TASK_STATE_ABORTED;
-        }
-    }
-    for( hook_id = 0; hook_id < RP_NB_HOOKS; hook_id++ )
+    // Garbage collector
+    rp_task_abort_late( rp, now );
+
+    // Highest priority task between the queued ones and the running one
+    hook_to_exe_tmp = rp_task_heap_top( &rp->priority_heap );
+    if( ( rp->tasks[rp->radio_task_id].state == RP_TASK_STATE_RUNNING ) &&
+        ( ( hook_to_exe_tmp == RP_NB_HOOKS ) ||
+          ( rp_task_has_higher_priority( rp, rp->radio_task_id, hook_to_exe_tmp ) == true ) ) )
     {
-        rank = rp->rankings[hook_id];
-        if( ( ( rp->tasks[rank].state < RP_TASK_STATE_RUNNING ) &&
-              ( ( int32_t )( rp->tasks[rank].start_time_ms - now ) >= 0 ) ) ||
-            ( rp->tasks[rank].state == RP_TASK_STATE_RUNNING ) )
-        {
-            hook_to_exe_tmp      = rp->tasks[rank].hook_id;
-            hook_time_to_exe_tmp = rp->tasks[rank].start_time_ms;
-            break;
-        }
+        hook_to_exe_tmp = rp->radio_task_id;
     }
-    if( hook_id == RP_NB_HOOKS )
+    if( hook_to_exe_tmp == RP_NB_HOOKS )
     {
         return RP_NO_MORE_TASK;
     }
+    hook_time_to_exe_tmp = rp->tasks[hook_to_exe_tmp].start_time_ms;
 
-    for( int32_t i = hook_id; i < RP_NB_HOOKS; i++ )
+    // A lower priority task is selected instead if it ends before the selected one starts: only the tasks starting
+    // before the highest priority one are candidates
+    rp_task_heap_collect_before( rp, &rp->schedule_heap, hook_time_to_exe_tmp, now, hook_ids, &nb_hook_ids );
+    rp_task_heap_collect_before( rp, &rp->asap_heap, hook_time_to_exe_tmp, now, hook_ids, &nb_hook_ids );
+    if( ( rp->tasks[rp->radio_task_id].state == RP_TASK_STATE_RUNNING ) && ( rp->radio_task_id != hook_to_exe_tmp ) )
     {
-        rank = rp->rankings[i];
-        if( ( ( rp->tasks[rank].state < RP_TASK_STATE_RUNNING ) &&
-              ( ( int32_t )( rp->tasks[rank].start_time_ms - now ) >= 0 ) ) ||
-            ( rp->tasks[rank].state == RP_TASK_STATE_RUNNING ) )
+        time_tmp = rp->tasks[rp->radio_task_id].start_time_ms + rp->tasks[rp->radio_task_id].duration_time_ms;
+        if( ( ( int32_t )( time_tmp - hook_time_to_exe_tmp ) < 0 ) && ( ( int32_t )( time_tmp - now ) >= 0 ) )
         {
-            time_tmp = rp->tasks[rank].start_time_ms + rp->tasks[rank].duration_time_ms;
+            hook_ids[nb_hook_ids++] = rp->radio_task_id;
+        }
+    }
 
-            int32_t tmp = ( int32_t )( time_tmp - hook_time_to_exe_tmp );
-            if( ( tmp < 0 ) && ( ( int32_t )( time_tmp - now ) >= 0 ) )
-            {
-                hook_to_exe_tmp      = rp->tasks[rank].hook_id;
-                hook_time_to_exe_tmp = rp->tasks[rank].start_time_ms;
-            }
+    // Candidates are considered by decreasing priority
+    for( uint8_t i = 1; i < nb_hook_ids; i++ )
+    {
+        uint8_t id = hook_ids[i];
+        uint8_t j  = i;
+
+        while( ( j > 0 ) && ( rp_task_has_higher_priority( rp, id, hook_ids[j - 1] ) == true ) )
+        {
+            hook_ids[j] = hook_ids[j - 1];
+            j--;
+        }
+        hook_ids[j] = id;
+    }
+    for( uint8_t i = 0; i < nb_hook_ids; i++ )
+    {
+        time_tmp = rp->tasks[hook_ids[i]].start_time_ms + rp->tasks[hook_ids[i]].duration_time_ms;
+        if( ( int32_t )( time_tmp - hook_time_to_exe_tmp ) < 0 )
+        {
+            hook_to_exe_tmp      = hook_ids[i];
+            hook_time_to_exe_tmp = rp->tasks[hook_ids[i]].start_time_ms;
         }
     }
     rp->priority_task = rp->tasks[hook_to_exe_tmp];
@@ -770,62 +992,168 @@ static uint8_t rp_task_select_next( radio_planner_t* rp, const uint32_t now )
 static rp_next_state_status_t rp_task_get_next( radio_planner_t* rp, uint32_t* duration, uint8_t* task_id,
                                                 const uint32_t now )
 {
-    uint8_t  hook_id  = 0;
-    uint8_t  index    = 0;
-    uint32_t time_tmp = now;
-
-    for( hook_id = 0; hook_id < RP_NB_HOOKS; hook_id++ )
-    {  // Garbage collector
-        if( ( rp->tasks[hook_id].state == RP_TASK_STATE_SCHEDULE ) &&
-            ( ( ( int32_t )( rp->tasks[hook_id].start_time_ms - time_tmp ) < 0 ) ) )
-        {
-            rp->tasks[hook_id].state = RP_TASK_STATE_ABORTED;
-        }
-    }
-    for( hook_id = 0; hook_id < RP_NB_HOOKS; hook_id++ )
+    uint8_t index = RP_NB_HOOKS;
+
+    // Garbage collector
+    rp_task_abort_late( rp, now );
+
+    // Earliest scheduled task, compared to the asap tasks that start in the future
+    index = rp_task_heap_top( &rp->schedule_heap );
+    for( uint8_t i = 0; i < rp->asap_heap.size; i++ )
     {
-        if( ( rp->tasks[hook_id].state < RP_TASK_STATE_RUNNING ) &&
-            ( ( ( int32_t )( rp->tasks[hook_id].start_time_ms - time_tmp ) >= 0 ) ) )
+        uint8_t id = rp->asap_heap.hook_ids[i];
+
+        if( ( ( int32_t )( rp->tasks[id].start_time_ms - now ) >= 0 ) &&
+            ( ( index == RP_NB_HOOKS ) || ( rp_task_is_earlier( rp, id, index ) == true ) ) )
         {
-            time_tmp = rp->tasks[hook_id].start_time_ms;
-            index    = hook_id;
-            break;
+            index = id;
         }
     }
-    if( hook_id == RP_NB_HOOKS )
+    if( index == RP_NB_HOOKS )
     {
         return RP_STATUS_NO_MORE_TASK_SCHEDULE;
     }
 
-    for( uint8_t i = hook_id; i < RP_NB_HOOKS; i++ )
+    *task_id  = index;
+    *duration = rp->tasks[index].start_time_ms - now;
+    return RP_STATUS_HAVE_TO_SET_TIMER;
+}
+
+static void rp_task_heap_collect_before( const radio_planner_t* rp, const rp_task_heap_t* heap, const uint32_t time,
+                                         const uint32_t now, uint8_t* hook_ids, uint8_t* nb_hook_ids )
+{
+    uint8_t positions[RP_NB_HOOKS];
+    uint8_t nb_positions = 0;
+
+    if( heap->size > 0 )
+    {
+        positions[nb_positions++] = 0;
+    }
+    while( nb_positions > 0 )
     {
-        if( ( rp->tasks[i].state < RP_TASK_STATE_RUNNING ) &&
-            ( ( int32_t )( rp->tasks[i].start_time_ms - time_tmp ) < 0 ) &&
-            ( ( int32_t )( rp->tasks[i].start_time_ms - now ) >= 0 ) )
+        const uint8_t    position = positions[--nb_positions];
+        const rp_task_t* task     = &rp->tasks[heap->hook_ids[position]];
+        const uint32_t   end_time = task->start_time_ms + task->duration_time_ms;
+
+        // The tasks below in the heap do not start earlier
+        if( ( int32_t )( task->start_time_ms - time ) >= 0 )
+        {
+            continue;
+        }
+        if( ( ( int32_t )( end_time - time ) < 0 ) && ( ( int32_t )( end_time - now ) >= 0 ) )
         {
-            time_tmp = rp->tasks[i].start_time_ms;
-            index    = i;
+            hook_ids[( *nb_hook_ids )++] = heap->hook_ids[position];
+        }
+        for( uint16_t child = ( 2 * position ) + 1; ( child <= ( 2 * position ) + 2 ) && ( child < heap->size );
+             child++ )
+        {
+            positions[nb_positions++] = ( uint8_t ) child;
         }
     }
-    *task_id  = index;
-    *duration = time_tmp - now;
-    return RP_STATUS_HAVE_TO_SET_TIMER;
 }
 
-static uint8_t rp_task_find_highest_priority( uint8_t* vector, uint8_t length )
+static void rp_task_heap_init( rp_task_heap_t* heap )
+{
+    heap->size = 0;
+    memset( heap->index, RP_NB_HOOKS, sizeof( heap->index ) );
+}
+
+static void rp_task_heap_push( const radio_planner_t* rp, rp_task_heap_t* heap, rp_task_heap_cmp_t cmp,
+                               const uint8_t hook_id )
+{
+    if( heap->index[hook_id] == RP_NB_HOOKS )
+    {
+        heap->hook_ids[heap->size] = hook_id;
+        heap->index[hook_id]       = heap->size;
+        heap->size++;
+    }
+    rp_task_heap_sift( rp, heap, cmp, heap->index[hook_id] );
+}
+
+static void rp_task_heap_remove( const radio_planner_t* rp, rp_task_heap_t* heap, rp_task_heap_cmp_t cmp,
+                                 const uint8_t hook_id )
+{
+    const uint8_t position = heap->index[hook_id];
+
+    if( position == RP_NB_HOOKS )
+    {
+        return;
+    }
+    heap->size--;
+    heap->index[hook_id] = RP_NB_HOOKS;
+    if( position != heap->size )
+    {
+        // The last element takes the free position
+        heap->hook_ids[position]              = heap->hook_ids[heap->size];
+        heap->index[heap->hook_ids[position]] = position;
+        rp_task_heap_sift( rp, heap, cmp, position );
+    }
+}
+
+static void rp_task_heap_sift( const radio_planner_t* rp, rp_task_heap_t* heap, rp_task_heap_cmp_t cmp,
+                               uint8_t position )
 {
-    uint8_t priority_high = 0xFF;
-    uint8_t index         = 0;
+    uint8_t hook_id = heap->hook_ids[position];
 
-    for( int32_t i = 0; i < length; i++ )
+    while( position > 0 )
     {
-        if( vector[i] <= priority_high )
+        const uint8_t parent = ( position - 1 ) / 2;
+
+        if( cmp( rp, hook_id, heap->hook_ids[parent] ) == false )
         {
-            priority_high = vector[i];
-            index         = i;
+            break;
+        }
+        heap->hook_ids[position]              = heap->hook_ids[parent];
+        heap->index[heap->hook_ids[position]] = position;
+        position                              = parent;
+    }
+    for( ;; )
+    {
+        uint16_t child = ( 2 * position ) + 1;
+
+        if( child >= heap->size )
+        {
+            break;
+        }
+        if( ( ( child + 1 ) < heap->size ) && ( cmp( rp, heap->hook_ids[child + 1], heap->hook_ids[child] ) == true ) )
+        {
+            child++;
+        }
+        if( cmp( rp, heap->hook_ids[child], hook_id ) == false )
+        {
+            break;
         }
+        heap->hook_ids[position]              = heap->hook_ids[child];
+        heap->index[heap->hook_ids[position]] = position;
+        position                              = ( uint8_t ) child;
     }
-    return index;
+    heap->hook_ids[position] = hook_id;
+    heap->index[hook_id]     = position;
+}
+
+static uint8_t rp_task_heap_top( const rp_task_heap_t* heap )
+{
+    return ( heap->size > 0 ) ? heap->hook_ids[0] : RP_NB_HOOKS;
+}
+
+static bool rp_task_is_earlier( const radio_planner_t* rp, const uint8_t id_a, const uint8_t id_b )
+{
+    const int32_t delta = ( int32_t )( rp->tasks[id_a].start_time_ms - rp->tasks[id_b].start_time_ms );
+
+    return ( delta < 0 ) || ( ( delta == 0 ) && ( id_a < id_b ) );
+}
+
+static bool rp_task_is_older( const radio_planner_t* rp, const uint8_t id_a, const uint8_t id_b )
+{
+    const int32_t delta = ( int32_t )( rp->tasks[id_a].start_time_init_ms - rp->tasks[id_b].start_time_init_ms );
+
+    return ( delta < 0 ) || ( ( delta == 0 ) && ( id_a < id_b ) );
+}
+
+static bool rp_task_has_higher_priority( const radio_planner_t* rp, const uint8_t id_a, const uint8_t id_b )
+{
+    return ( rp->tasks[id_a].priority < rp->tasks[id_b].priority ) ||
+           ( ( rp->tasks[id_a].priority == rp->tasks[id_b].priority ) && ( id_a > id_b ) );
 }
 
 rp_hook_status_t rp_get_pkt_payload( radio_planner_t* rp, const rp_task_t* task )
@@ -867,12 +1195,15 @@ rp_hook_status_t rp_get_pkt_payload( radio_planner_t* rp, const rp_task_t* task
 static void rp_set_alarm( radio_planner_t* rp, const uint32_t alarm_in_ms )
 {
     rp_hal_timer_stop( );
+    rp->margin.alarm_time_ms = rp_hal_get_time_in_ms( ) + alarm_in_ms;
     rp_hal_timer_start( rp, alarm_in_ms, rp_timer_irq_callback );
 }
 
 static void rp_timer_irq( radio_planner_t* rp )
 {
+    rp->margin.alarm_expired = true;
     rp_task_arbiter( rp, __func__ );
+    rp->margin.alarm_expired = false;
 }
 
 static void rp_task_call_aborted( radio_planner_t* rp )
@@ -897,11 +1228,13 @@ static void rp_task_call_aborted( radio_planner_t* rp )
 void rp_radio_irq_callback( void* obj )
 {
     rp_radio_irq( ( radio_planner_t* ) obj );
+    ( ( radio_planner_t* ) obj )->irq_flag = true;
 }
 
 static void rp_timer_irq_callback( void* obj )
 {
     rp_timer_irq( ( radio_planner_t* ) obj );
+    ( ( radio_planner_t* ) obj )->irq_flag = true;
 }
 
 static void rp_hook_callback( radio_planner_t* rp, uint8_t id )
@@ -916,7 +1249,76 @@ static void rp_hook_callback( radio_planner_t* rp, uint8_t id )
         smtc_modem_hal_mcu_panic( );
         return;
     }
+    uint32_t callback_start_100us = rp_hal_get_time_in_100us( );
     rp->hook_callbacks[id]( rp->hooks[id] );
+    rp->callback_time_100us += rp_hal_get_time_in_100us( ) - callback_start_100us;
+}
+
+static void rp_irq_latency_update( radio_planner_t* rp, const uint8_t hook_id )
+{
+    uint32_t now_100us = rp_hal_get_time_in_100us( );
+
+    rp_timing_stats_irq_update( &rp->timing_stats, now_100us, hook_id, now_100us - rp->irq_timestamp_100us[hook_id] );
+}
+
+static void rp_margin_update( radio_planner_t* rp, const uint32_t latency_ms )
+{
+    rp_margin_t* margin = &rp->margin;
+
+    if( margin->percentile == 0 )
+    {
+        return;
+    }
+
+    // Halve the histogram once full so that the oldest samples fade out
+    if( margin->nb_samples >= RP_MARGIN_NB_SAMPLES_WINDOW )
+    {
+        margin->nb_samples = 0;
+        for( uint8_t i = 0; i <= RP_MARGIN_DELAY_MAX; i++ )
+        {
+            margin->latency_ms[i] >>= 1;
+            margin->nb_samples += margin->latency_ms[i];
+        }
+    }
+    margin->latency_ms[( latency_ms < RP_MARGIN_DELAY_MAX ) ? latency_ms : RP_MARGIN_DELAY_MAX]++;
+    margin->nb_samples++;
+
+    // The latency is measured with a 1 ms clock, keep 1 ms more than the percentile
+    uint32_t margin_delay = rp->margin_delay;
+    if( margin->nb_samples >= RP_MARGIN_NB_SAMPLES_MIN )
+    {
+        uint32_t target_nb = ( ( uint32_t ) margin->nb_samples * margin->percentile + 99 ) / 100;
+        uint32_t count     = 0;
+        uint8_t  bin       = 0;
+        while( ( bin < RP_MARGIN_DELAY_MAX ) && ( ( count += margin->latency_ms[bin] ) < target_nb ) )
+        {
+            bin++;
+        }
+        margin_delay = bin + 1;
+    }
+    // A launch that used up the whole margin raises it at once
+    if( latency_ms >= rp->margin_delay )
+    {
+        margin_delay = latency_ms + 1;
+    }
+
+    if( margin_delay > RP_MARGIN_DELAY_MAX )
+    {
+        margin_delay = RP_MARGIN_DELAY_MAX;
+    }
+    // The tasks enqueued at now + margin_delay - TCXO startup delay must not start in the past: the floor wins over
+    // RP_MARGIN_DELAY_MAX with a long TCXO startup delay
+    uint32_t margin_delay_min = rp_hal_get_radio_tcxo_startup_delay_ms( ) + RP_MARGIN_DELAY_MIN;
+    if( margin_delay < margin_delay_min )
+    {
+        margin_delay = margin_delay_min;
+    }
+
+    if( margin_delay != rp->margin_delay )
+    {
+        SMTC_MODEM_HAL_RP_TRACE_PRINTF( " RP: Margin delay set to %lu ms (latency %lu ms)\n", margin_delay, latency_ms );
+        rp->margin_delay = margin_delay;
+    }
 }
 
 //
@@ -48,6 +48,7 @@ extern "C" {
 
 #include "radio_planner_types.h"
 #include "radio_planner_stats.h"
+#include "radio_planner_timing_stats.h"
 #include "radio_planner_hal.h"
 #include "radio_planner_hook_id_defs.h"
 
@@ -78,13 +79,17 @@ typedef struct radio_planner_s
     rp_task_t         tasks[RP_NB_HOOKS];
     uint8_t*          payload[RP_NB_HOOKS];
     uint16_t          payload_size[RP_NB_HOOKS];
-    uint8_t           rankings[RP_NB_HOOKS];
     void*             hooks[RP_NB_HOOKS];
     rp_status_t       status[RP_NB_HOOKS];
     ral_irq_t         raw_radio_irq[RP_NB_HOOKS];
     uint32_t          irq_timestamp_ms[RP_NB_HOOKS];
     uint32_t          irq_timestamp_100us[RP_NB_HOOKS];
+    rp_task_heap_t    schedule_heap;  //!< Scheduled tasks ordered by start time
+    rp_task_heap_t    asap_heap;      //!< ASAP tasks ordered by initial start time
+    rp_task_heap_t    priority_heap;  //!< Scheduled and ASAP tasks ordered by priority
     rp_stats_t        stats;
+    rp_timing_stats_t timing_stats;
+    uint32_t          callback_time_100us;  //!< Time spent in the launch and hook callbacks
     uint8_t           hook_to_execute;
     uint32_t          hook_to_execute_time_ms;
     uint8_t           radio_task_id;
@@ -96,6 +101,8 @@ typedef struct radio_planner_s
     rp_next_state_status_t next_state_status;
     const ralf_t*          radio;
     uint32_t               margin_delay;
+    rp_margin_t            margin;
+    volatile bool          irq_flag;  //!< Set on each radio or timer interrupt, the host has to run its engine
 } radio_planner_t;
 
 /*
@@ -148,11 +155,60 @@ rp_hook_status_t rp_task_enqueue( radio_planner_t* rp, const rp_task_t* task, ui
  */
 rp_hook_status_t rp_task_abort( radio_planner_t* rp, const uint8_t hook_id );
 
+/*!
+ * Report that the radio of the running task is configured and only waits for the task start time
+ *
+ * To be called by the launch callbacks just before waiting for the task start time. The latency from the radio planner
+ * timer expiry to this point is used to learn the margin delay.
+ *
+ * \param [in/out] rp Radio planner data structure
+ */
+void rp_task_radio_ready( radio_planner_t* rp );
+
+/*!
+ * Set the percentile of the measured launch latency covered by the margin delay
+ *
+ * \param [in/out] rp         Radio planner data structure
+ * \param [in]     percentile Percentile in [1:100], 0 to use the fixed RP_MARGIN_DELAY
+ */
+void rp_set_margin_percentile( radio_planner_t* rp, const uint8_t percentile );
+
 /*!
  *
  */
 rp_stats_t rp_get_stats( const radio_planner_t* rp );
 
+/*!
+ * Get the timing statistics and trace of the radio planner
+ *
+ * \param [in] rp Radio planner data structure
+ * \retval timing_stats Timing statistics, updated by the radio planner
+ */
+const rp_timing_stats_t* rp_get_timing_stats( const radio_planner_t* rp );
+
+/*!
+ * Clear the timing statistics and trace of the radio planner
+ *
+ * \param [in/out] rp Radio planner data structure
+ */
+void rp_reset_timing_stats( radio_planner_t* rp );
+
+/*!
+ * Get the flag set by the radio and timer interrupts of the radio planner
+ *
+ * \param [in] rp Radio planner data structure
+ *
+ * \return true if an interrupt occurred since the last call to rp_clear_irq_flag()
+ */
+bool rp_get_irq_flag( const radio_planner_t* rp );
+
+/*!
+ * Clear the flag set by the radio and timer interrupts of the radio planner
+ *
+ * \param [in/out] rp Radio planner data structure
+ */
+void rp_clear_irq_flag( radio_planner_t* rp );
+
 /*!
  *
  */
@@ -105,11 +105,21 @@ uint32_t rp_hal_get_time_in_ms( void )
     return smtc_modem_hal_get_time_in_ms( );
 }
 
+uint32_t rp_hal_get_time_in_100us( void )
+{
+    return smtc_modem_hal_get_time_in_100us( );
+}
+
 uint32_t rp_hal_get_radio_irq_timestamp_in_100us( void )
 {
     return smtc_modem_hal_get_radio_irq_timestamp_in_100us( );
 }
 
+uint32_t rp_hal_get_radio_tcxo_startup_delay_ms( void )
+{
+    return smtc_modem_hal_get_radio_tcxo_startup_delay_ms( );
+}
+
 void rp_hal_irq_clear_pending( void )
 {
     smtc_modem_hal_radio_irq_clear_pending( );
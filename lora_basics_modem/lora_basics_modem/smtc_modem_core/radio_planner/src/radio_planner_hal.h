@@ -99,6 +99,13 @@ void rp_hal_timer_start( void* rp, uint32_t alarm_in_ms, void ( *callback )( voi
  */
 uint32_t rp_hal_get_time_in_ms( void );
 
+/**
+ * @brief Gets current time in 100µs
+ *
+ * @return uint32_t
+ */
+uint32_t rp_hal_get_time_in_100us( void );
+
 /**
  * @brief Gets the time in 100µs at which the last radio IRQ occurred
  *
@@ -106,6 +113,13 @@ uint32_t rp_hal_get_time_in_ms( void );
  */
 uint32_t rp_hal_get_radio_irq_timestamp_in_100us( void );
 
+/**
+ * @brief Gets the TCXO startup delay in ms, zero if the board has no TCXO
+ *
+ * @return uint32_t
+ */
+uint32_t rp_hal_get_radio_tcxo_startup_delay_ms( void );
+
 /*!
  *
  */
@@ -0,0 +1,263 @@
+/*!
+ * \file      radio_planner_timing_stats.h
+ *
+ * \brief     Radio planner timing statistics
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2022. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef __RADIO_PLANNER_TIMING_STATS_H__
+#define __RADIO_PLANNER_TIMING_STATS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>   // C99 types
+#include <stdbool.h>  // bool type
+
+#include <string.h>  // for memset
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * Number of bins of the timing histograms
+ *
+ * Bin 0 counts the values lower than or equal to 0, bin n counts the values in [2^(n-1), 2^n[ and the last bin counts
+ * all the values greater than or equal to 2^(RP_TIMING_NB_BINS-2)
+ */
+#define RP_TIMING_NB_BINS 8
+
+/*!
+ * Number of entries of the timing trace ring buffer
+ */
+#ifndef RP_TIMING_TRACE_NB
+#define RP_TIMING_TRACE_NB 16
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/*!
+ * Events recorded in the timing trace
+ */
+typedef enum rp_timing_event_e
+{
+    RP_TIMING_EVENT_ARBITER,     //!< Arbiter run, value is its execution time in 100µs
+    RP_TIMING_EVENT_LAUNCH,      //!< Task launch, value is the start lateness in ms
+    RP_TIMING_EVENT_IRQ,         //!< Radio IRQ, value is the IRQ to hook callback latency in 100µs
+    RP_TIMING_EVENT_LATE_ABORT,  //!< Task aborted by the arbiter because it is in the past, value is the delay in ms
+} rp_timing_event_t;
+
+/*!
+ * Timing trace entry
+ */
+typedef struct rp_timing_trace_s
+{
+    uint32_t timestamp_100us;  //!< Time of the event
+    int32_t  value;            //!< Measured value, depends on the event
+    uint8_t  event;            //!< Event as defined in @ref rp_timing_event_t
+    uint8_t  hook_id;          //!< Hook of the task, RP_NB_HOOKS if the event is not related to a task
+} rp_timing_trace_t;
+
+/*!
+ * Timing statistics of a hook
+ *
+ * The start lateness is the time between the start time of a task and the end of its launch callback, where the radio
+ * is started: a positive value means that the margin delay was too small for this task.
+ */
+typedef struct rp_hook_timing_stats_s
+{
+    uint16_t start_lateness_ms[RP_TIMING_NB_BINS];
+    uint16_t launch_duration_100us[RP_TIMING_NB_BINS];
+    uint16_t irq_to_callback_100us[RP_TIMING_NB_BINS];
+    int32_t  start_lateness_max_ms;
+    uint32_t launch_duration_max_100us;
+    uint32_t irq_to_callback_max_100us;
+    uint32_t late_start_nb;
+} rp_hook_timing_stats_t;
+
+/*!
+ * Timing statistics of the radio planner
+ */
+typedef struct rp_timing_stats_s
+{
+    rp_hook_timing_stats_t hooks[RP_NB_HOOKS];
+    uint16_t               arbiter_100us[RP_TIMING_NB_BINS];
+    uint32_t               arbiter_max_100us;
+    uint32_t               late_abort_nb;
+    rp_timing_trace_t      trace[RP_TIMING_TRACE_NB];
+    uint8_t                trace_index;  //!< Position of the next entry in the trace
+    uint8_t                trace_nb;     //!< Number of valid entries in the trace
+} rp_timing_stats_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/*!
+ *
+ */
+static inline void rp_timing_stats_init( rp_timing_stats_t* timing_stats )
+{
+    memset( timing_stats, 0, sizeof( rp_timing_stats_t ) );
+    for( int32_t i = 0; i < RP_NB_HOOKS; i++ )
+    {
+        timing_stats->hooks[i].start_lateness_max_ms = INT32_MIN;
+    }
+}
+
+/*!
+ * Count a value in a histogram, the counters saturate
+ */
+static inline void rp_timing_stats_histogram_add( uint16_t histogram[RP_TIMING_NB_BINS], int32_t value )
+{
+    uint8_t bin = 0;
+
+    while( ( value > 0 ) && ( bin < ( RP_TIMING_NB_BINS - 1 ) ) )
+    {
+        value >>= 1;
+        bin++;
+    }
+    if( histogram[bin] < UINT16_MAX )
+    {
+        histogram[bin]++;
+    }
+}
+
+/*!
+ * Add an event to the trace, the oldest one is overwritten when the trace is full
+ */
+static inline void rp_timing_stats_trace_add( rp_timing_stats_t* timing_stats, uint32_t timestamp_100us,
+                                              rp_timing_event_t event, uint8_t hook_id, int32_t value )
+{
+    rp_timing_trace_t* trace = &timing_stats->trace[timing_stats->trace_index];
+
+    trace->timestamp_100us = timestamp_100us;
+    trace->value           = value;
+    trace->event           = ( uint8_t ) event;
+    trace->hook_id         = hook_id;
+
+    timing_stats->trace_index = ( timing_stats->trace_index + 1 ) % RP_TIMING_TRACE_NB;
+    if( timing_stats->trace_nb < RP_TIMING_TRACE_NB )
+    {
+        timing_stats->trace_nb++;
+    }
+}
+
+/*!
+ *
+ */
+static inline void rp_timing_stats_arbiter_update( rp_timing_stats_t* timing_stats, uint32_t timestamp_100us,
+                                                   uint32_t duration_100us )
+{
+    rp_timing_stats_histogram_add( timing_stats->arbiter_100us, ( int32_t ) duration_100us );
+    if( duration_100us > timing_stats->arbiter_max_100us )
+    {
+        timing_stats->arbiter_max_100us = duration_100us;
+    }
+    rp_timing_stats_trace_add( timing_stats, timestamp_100us, RP_TIMING_EVENT_ARBITER, RP_NB_HOOKS,
+                               ( int32_t ) duration_100us );
+}
+
+/*!
+ *
+ */
+static inline void rp_timing_stats_launch_update( rp_timing_stats_t* timing_stats, uint32_t timestamp_100us,
+                                                  uint8_t hook_id, int32_t start_lateness_ms,
+                                                  uint32_t duration_100us )
+{
+    rp_hook_timing_stats_t* hook = &timing_stats->hooks[hook_id];
+
+    rp_timing_stats_histogram_add( hook->start_lateness_ms, start_lateness_ms );
+    if( start_lateness_ms > hook->start_lateness_max_ms )
+    {
+        hook->start_lateness_max_ms = start_lateness_ms;
+    }
+    if( start_lateness_ms > 0 )
+    {
+        hook->late_start_nb++;
+    }
+    rp_timing_stats_histogram_add( hook->launch_duration_100us, ( int32_t ) duration_100us );
+    if( duration_100us > hook->launch_duration_max_100us )
+    {
+        hook->launch_duration_max_100us = duration_100us;
+    }
+    rp_timing_stats_trace_add( timing_stats, timestamp_100us, RP_TIMING_EVENT_LAUNCH, hook_id, start_lateness_ms );
+}
+
+/*!
+ *
+ */
+static inline void rp_timing_stats_irq_update( rp_timing_stats_t* timing_stats, uint32_t timestamp_100us,
+                                               uint8_t hook_id, uint32_t latency_100us )
+{
+    rp_hook_timing_stats_t* hook = &timing_stats->hooks[hook_id];
+
+    rp_timing_stats_histogram_add( hook->irq_to_callback_100us, ( int32_t ) latency_100us );
+    if( latency_100us > hook->irq_to_callback_max_100us )
+    {
+        hook->irq_to_callback_max_100us = latency_100us;
+    }
+    rp_timing_stats_trace_add( timing_stats, timestamp_100us, RP_TIMING_EVENT_IRQ, hook_id,
+                               ( int32_t ) latency_100us );
+}
+
+/*!
+ *
+ */
+static inline void rp_timing_stats_late_abort_update( rp_timing_stats_t* timing_stats, uint32_t timestamp_100us,
+                                                      uint8_t hook_id, int32_t delay_ms )
+{
+    timing_stats->late_abort_nb++;
+    rp_timing_stats_trace_add( timing_stats, timestamp_100us, RP_TIMING_EVENT_LATE_ABORT, hook_id, delay_ms );
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // __RADIO_PLANNER_TIMING_STATS_H__
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -89,6 +89,34 @@ extern "C" {
 #define RP_MARGIN_DELAY                             8
 #endif
 
+/*!
+ * Percentile of the measured timer to radio ready latency covered by the margin, 0 keeps RP_MARGIN_DELAY
+ */
+#ifndef RP_MARGIN_PERCENTILE
+#define RP_MARGIN_PERCENTILE                        95
+#endif
+
+/*!
+ * Bounds of the learned margin, the lower one is added to the TCXO startup delay and wins over the upper one
+ */
+#ifndef RP_MARGIN_DELAY_MIN
+#define RP_MARGIN_DELAY_MIN                         2
+#endif
+
+#ifndef RP_MARGIN_DELAY_MAX
+#define RP_MARGIN_DELAY_MAX                         30
+#endif
+
+/*!
+ * Number of latency samples needed before the margin is lowered below RP_MARGIN_DELAY
+ */
+#define RP_MARGIN_NB_SAMPLES_MIN                    16
+
+/*!
+ * The latency histogram is halved each time it holds this number of samples, to follow the board behaviour
+ */
+#define RP_MARGIN_NB_SAMPLES_WINDOW                 64
+
 
 
 /*!
@@ -221,6 +249,30 @@ typedef struct rp_task_s
     uint32_t duration_time_ms;
 } rp_task_t;
 
+/*!
+ * Binary min-heap of hook ids, ordered by one of the task keys (start time or priority)
+ */
+typedef struct rp_task_heap_s
+{
+    uint8_t hook_ids[RP_NB_HOOKS];  //!< Heap of hook ids, the first one is the minimum
+    uint8_t index[RP_NB_HOOKS];     //!< Position of each hook in hook_ids, RP_NB_HOOKS if not in the heap
+    uint8_t size;
+} rp_task_heap_t;
+
+/*!
+ * Margin learnt from the latency between the radio planner timer and the radio being ready to start
+ */
+typedef struct rp_margin_s
+{
+    uint16_t latency_ms[RP_MARGIN_DELAY_MAX + 1];  //!< Latency histogram, 1 ms per bin, the last one saturates
+    uint16_t nb_samples;
+    uint8_t  percentile;     //!< Percentile covered by the margin, 0 to keep RP_MARGIN_DELAY
+    uint32_t alarm_time_ms;  //!< Time at which the radio planner timer is expected to expire
+    bool     alarm_expired;  //!< Set while the arbiter runs on timer expiry
+    uint32_t ready_time_ms;  //!< Time at which the launched task reported its radio ready
+    bool     ready;
+} rp_margin_t;
+
 /*!
  *
  */
@@ -46,6 +46,8 @@
 #include "lr11xx_crypto_engine.h"
 #include "smtc_modem_hal.h"
 #include "smtc_modem_hal_dbg_trace.h"
+#include "smtc_context_journal.h"
+#include "smtc_crc32.h"
 
 #include "modem_context.h"
 
@@ -81,6 +83,11 @@
  */
 #define JOIN_ACCEPT_FRAME_MAX_SIZE 33
 
+/**
+ * Number of AES-CTR counter blocks encrypted in one lr11xx command
+ */
+#define LR11XX_CE_CTR_NB_BLOCKS 4
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -130,15 +137,6 @@ static const void*      lr11xx_ctx;
  */
 static lr11xx_crypto_keys_idx_t convert_key_id_from_se_to_lr11xx( smtc_se_key_identifier_t key_id );
 
-/**
- * @brief CRC function for lr11xx se context security
- *
- * @param [in] buf  Data buffer
- * @param [in] len Length of the data
- * @return uint32_t
- */
-uint32_t lr11xx_ce_crc( const uint8_t* buf, int len );
-
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -326,6 +324,48 @@ smtc_se_return_code_t smtc_secure_element_aes_encrypt( const uint8_t* buffer, ui
     return status;
 }
 
+smtc_se_return_code_t smtc_secure_element_aes_ctr_encrypt( const uint8_t* buffer, uint16_t size,
+                                                           smtc_se_key_identifier_t key_id, const uint8_t a_block[16],
+                                                           uint8_t* enc_buffer )
+{
+    if( ( buffer == NULL ) || ( enc_buffer == NULL ) || ( a_block == NULL ) )
+    {
+        return SMTC_SE_RC_ERROR_NPE;
+    }
+
+    // The counter blocks of LR11XX_CE_CTR_NB_BLOCKS blocks are encrypted in one lr11xx command
+    uint8_t  ctr_blocks[LR11XX_CE_CTR_NB_BLOCKS * 16];
+    uint8_t  s_blocks[LR11XX_CE_CTR_NB_BLOCKS * 16];
+    uint16_t ctr   = ( ( uint16_t ) a_block[14] << 8 ) | a_block[15];
+    uint16_t index = 0;
+
+    while( index < size )
+    {
+        uint16_t chunk_size = ( ( size - index ) > sizeof( s_blocks ) ) ? sizeof( s_blocks ) : ( size - index );
+        uint16_t nb_blocks  = ( chunk_size + 15 ) >> 4;
+
+        for( uint16_t i = 0; i < nb_blocks; i++ )
+        {
+            memcpy( &ctr_blocks[i << 4], a_block, 14 );
+            ctr_blocks[( i << 4 ) + 14] = ( ctr >> 8 ) & 0xFF;
+            ctr_blocks[( i << 4 ) + 15] = ctr & 0xFF;
+            ctr++;
+        }
+
+        smtc_se_return_code_t status = smtc_secure_element_aes_encrypt( ctr_blocks, nb_blocks << 4, key_id, s_blocks );
+        if( status != SMTC_SE_RC_SUCCESS )
+        {
+            return status;
+        }
+        for( uint16_t i = 0; i < chunk_size; i++ )
+        {
+            enc_buffer[index + i] = buffer[index + i] ^ s_blocks[i];
+        }
+        index += chunk_size;
+    }
+    return SMTC_SE_RC_SUCCESS;
+}
+
 smtc_se_return_code_t smtc_secure_element_derive_and_store_key( uint8_t* input, smtc_se_key_identifier_t rootkey_id,
                                                                 smtc_se_key_identifier_t targetkey_id )
 {
@@ -480,9 +520,9 @@ smtc_se_return_code_t smtc_secure_element_store_context( void )
     lr11xx_ce_context_nvm_t ctx = {
         .data = lr11xx_ce_data,
     };
-    ctx.crc = lr11xx_ce_crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 );
+    ctx.crc = smtc_crc32( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 );
 
-    smtc_modem_hal_context_store( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    smtc_context_journal_store( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
     smtc_secure_element_restore_context( );
     return SMTC_SE_RC_SUCCESS;
 }
@@ -490,8 +530,8 @@ smtc_se_return_code_t smtc_secure_element_store_context( void )
 smtc_se_return_code_t smtc_secure_element_restore_context( void )
 {
     lr11xx_ce_context_nvm_t ctx;
-    smtc_modem_hal_context_restore( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
-    if( lr11xx_ce_crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 ) == ctx.crc )
+    smtc_context_journal_restore( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    if( smtc_crc32( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 ) == ctx.crc )
     {
         lr11xx_ce_data = ctx.data;
         return SMTC_SE_RC_SUCCESS;
@@ -591,19 +631,4 @@ static lr11xx_crypto_keys_idx_t convert_key_id_from_se_to_lr11xx( smtc_se_key_id
     }
     return id;
 }
-
-uint32_t lr11xx_ce_crc( const uint8_t* buf, int len )
-{
-    uint32_t crc = 0xFFFFFFFF;
-    while( len-- > 0 )
-    {
-        crc = crc ^ *buf++;
-        for( int i = 0; i < 8; i++ )
-        {
-            uint32_t mask = -( crc & 1 );
-            crc           = ( crc >> 1 ) ^ ( 0xEDB88320 & mask );
-        }
-    }
-    return ~crc;
-}
 /* --- EOF ------------------------------------------------------------------ */
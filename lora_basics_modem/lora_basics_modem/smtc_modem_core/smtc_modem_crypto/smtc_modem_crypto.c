@@ -199,11 +199,7 @@ smtc_modem_crypto_return_code_t smtc_modem_crypto_payload_encrypt( const uint8_t
         return SMTC_MODEM_CRYPTO_RC_ERROR_NPE;
     }
 
-    uint16_t buffer_idx = 0;
-    uint16_t ctr        = 1;
-    uint8_t  sBlock[16] = { 0 };
-    uint8_t  aBlock[16] = { 0 };
-    int16_t  local_size = size;
+    uint8_t aBlock[16] = { 0 };
 
     aBlock[0] = 0x01;
 
@@ -219,23 +215,11 @@ smtc_modem_crypto_return_code_t smtc_modem_crypto_payload_encrypt( const uint8_t
     aBlock[12] = ( frame_counter >> 16 ) & 0xFF;
     aBlock[13] = ( frame_counter >> 24 ) & 0xFF;
 
-    while( local_size > 0 )
-    {
-        aBlock[15] = ctr & 0xFF;
-
-        ctr++;
-
-        if( smtc_secure_element_aes_encrypt( aBlock, 16, key_id, sBlock ) != SMTC_SE_RC_SUCCESS )
-        {
-            return SMTC_MODEM_CRYPTO_RC_ERROR_SECURE_ELEMENT;
-        }
+    aBlock[15] = 0x01;
 
-        for( uint8_t i = 0; i < ( ( local_size > 16 ) ? 16 : local_size ); i++ )
-        {
-            enc_buffer[buffer_idx + i] = buffer[buffer_idx + i] ^ sBlock[i];
-        }
-        local_size -= 16;
-        buffer_idx += 16;
+    if( smtc_secure_element_aes_ctr_encrypt( buffer, size, key_id, aBlock, enc_buffer ) != SMTC_SE_RC_SUCCESS )
+    {
+        return SMTC_MODEM_CRYPTO_RC_ERROR_SECURE_ELEMENT;
     }
 
     return SMTC_MODEM_CRYPTO_RC_SUCCESS;
@@ -457,39 +441,31 @@ smtc_modem_crypto_return_code_t smtc_modem_crypto_get_class_b_rand( uint32_t bea
 
 smtc_modem_crypto_return_code_t smtc_modem_crypto_service_encrypt( const uint8_t* clear_buff, uint16_t len,
                                                                    uint8_t nonce[14], uint8_t* enc_buff )
+{
+    return smtc_modem_crypto_service_encrypt_at( clear_buff, len, nonce, 0, enc_buff );
+}
+
+smtc_modem_crypto_return_code_t smtc_modem_crypto_service_encrypt_at( const uint8_t* clear_buff, uint16_t len,
+                                                                      uint8_t nonce[14], uint16_t block_index,
+                                                                      uint8_t* enc_buff )
 {
     if( ( clear_buff == 0 ) || ( enc_buff == 0 ) )
     {
         return SMTC_MODEM_CRYPTO_RC_ERROR_NPE;
     }
 
-    uint16_t index       = 0;
-    uint16_t ctr         = 1;
-    uint8_t  s_block[16] = { 0 };
     uint8_t  a_block[16] = { 0 };
-    int16_t  local_size  = len;
+    uint16_t ctr         = block_index + 1;
 
-    // first copy the 14 bytes of nonce into a_block first 14 bytes
+    // first copy the 14 bytes of nonce into a_block first 14 bytes, the counter starts at 1 for the first block
     memcpy( a_block, nonce, 14 );
+    a_block[14] = ( ctr >> 8 ) & 0xFF;
+    a_block[15] = ctr & 0xFF;
 
-    while( local_size > 0 )
+    if( smtc_secure_element_aes_ctr_encrypt( clear_buff, len, SMTC_SE_APP_S_KEY, a_block, enc_buff ) !=
+        SMTC_SE_RC_SUCCESS )
     {
-        a_block[15] = ctr & 0xFF;
-        a_block[14] = ( ctr >> 8 ) & 0xFF;
-
-        ctr++;
-
-        if( smtc_secure_element_aes_encrypt( a_block, 16, SMTC_SE_APP_S_KEY, s_block ) != SMTC_SE_RC_SUCCESS )
-        {
-            return SMTC_MODEM_CRYPTO_RC_ERROR_SECURE_ELEMENT;
-        }
-
-        for( uint8_t i = 0; i < ( ( local_size > 16 ) ? 16 : local_size ); i++ )
-        {
-            enc_buff[index + i] = clear_buff[index + i] ^ s_block[i];
-        }
-        local_size -= 16;
-        index += 16;
+        return SMTC_MODEM_CRYPTO_RC_ERROR_SECURE_ELEMENT;
     }
 
     return SMTC_MODEM_CRYPTO_RC_SUCCESS;
@@ -262,6 +262,20 @@ smtc_modem_crypto_return_code_t smtc_modem_crypto_get_class_b_rand( uint32_t bea
 smtc_modem_crypto_return_code_t smtc_modem_crypto_service_encrypt( const uint8_t* clear_buff, uint16_t len,
                                                                    uint8_t nonce[14], uint8_t* enc_buff );
 
+/**
+ * @brief Encryption function for modem services, for a part of a buffer
+ *
+ * @param [in]  clear_buff  Clear buffer
+ * @param [in]  len         Buffer length
+ * @param [in]  nonce       Nonce to be used
+ * @param [in]  block_index Index of the first 16 bytes block of the part in the whole buffer
+ * @param [out] enc_buff    Encrypted buffer
+ * @return smtc_modem_crypto_return_code_t
+ */
+smtc_modem_crypto_return_code_t smtc_modem_crypto_service_encrypt_at( const uint8_t* clear_buff, uint16_t len,
+                                                                      uint8_t nonce[14], uint16_t block_index,
+                                                                      uint8_t* enc_buff );
+
 #ifdef __cplusplus
 }
 #endif
@@ -64,6 +64,15 @@
 
 #include "aes.h"
 
+/* the byte-oriented encryption rounds are still used by the 'on the fly' keying versions */
+#if !defined( AES_ENC_T_TABLES ) || defined( AES_ENC_128_OTFK ) || defined( AES_ENC_256_OTFK )
+#  define AES_ENC_BYTE_ROUNDS
+#endif
+
+#if defined( AES_ENC_T_TABLES ) && !defined( USE_TABLES )
+#  error "AES_ENC_T_TABLES requires USE_TABLES"
+#endif
+
 //#if defined( HAVE_UINT_32T )
 //  typedef unsigned long uint32_t;
 //#endif
@@ -197,8 +206,20 @@ static const uint8_t sbox[256]  =  sb_data(f1);
 static const uint8_t isbox[256] = isb_data(f1);
 #endif
 
+#if defined( AES_ENC_BYTE_ROUNDS )
 static const uint8_t gfm2_sbox[256] = sb_data(f2);
 static const uint8_t gfm3_sbox[256] = sb_data(f3);
+#endif
+
+#if defined( AES_ENC_T_TABLES )
+/*  Combined S box and mix column table: the column { 2.S(x), S(x), S(x), 3.S(x) }
+    with the first row in the least significant byte. The tables of the other
+    rows are obtained by rotating it
+*/
+#define t_w(x)  ( ( uint32_t )f2(x) | ( ( uint32_t )(x) << 8 ) \
+                | ( ( uint32_t )(x) << 16 ) | ( ( uint32_t )f3(x) << 24 ) )
+static const uint32_t t_fn[256] = sb_data(t_w);
+#endif
 
 #if defined( AES_DEC_PREKEYED )
 static const uint8_t gfmul_9[256] = mm_data(f9);
@@ -373,6 +394,8 @@ static void xor_block( void *d, const void *s )
 #endif
 }
 
+#if defined( AES_ENC_BYTE_ROUNDS ) || defined( AES_DEC_PREKEYED ) || defined( AES_DEC_128_OTFK ) || defined( AES_DEC_256_OTFK )
+
 static void copy_and_key( void *d, const void *s, const void *k )
 {
 #if defined( HAVE_UINT_32T )
@@ -408,6 +431,10 @@ static void add_round_key( uint8_t d[N_BLOCK], const uint8_t k[N_BLOCK] )
     xor_block(d, k);
 }
 
+#endif
+
+#if defined( AES_ENC_BYTE_ROUNDS )
+
 static void shift_sub_rows( uint8_t st[N_BLOCK] )
 {   uint8_t tt;
 
@@ -424,6 +451,8 @@ static void shift_sub_rows( uint8_t st[N_BLOCK] )
     st[ 7] = s_box(st[ 3]); st[ 3] = s_box( tt );
 }
 
+#endif
+
 #if defined( AES_DEC_PREKEYED )
 
 static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
@@ -444,6 +473,8 @@ static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
 
 #endif
 
+#if defined( AES_ENC_BYTE_ROUNDS )
+
 #if defined( VERSION_1 )
   static void mix_sub_columns( uint8_t dt[N_BLOCK] )
   { uint8_t st[N_BLOCK];
@@ -473,6 +504,8 @@ static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
     dt[15] = gfm3_sb(st[12]) ^ s_box(st[1]) ^ s_box(st[6]) ^ gfm2_sb(st[11]);
   }
 
+#endif
+
 #if defined( AES_DEC_PREKEYED )
 
 #if defined( VERSION_1 )
@@ -565,6 +598,63 @@ return_type aes_set_key( const uint8_t key[], length_type keylen, aes_context ct
 
 /*  Encrypt a single block of 16 bytes */
 
+#if defined( AES_ENC_T_TABLES )
+
+/*  The state is held as four 32-bit columns, the first row in the least
+    significant byte, so that a round is 16 table lookups and rotations
+*/
+
+#define word_in(p)      ( ( uint32_t )(p)[0] | ( ( uint32_t )(p)[1] << 8 ) \
+                        | ( ( uint32_t )(p)[2] << 16 ) | ( ( uint32_t )(p)[3] << 24 ) )
+#define word_out(p, x)  { (p)[0] = ( uint8_t )(x); (p)[1] = ( uint8_t )((x) >> 8); \
+                          (p)[2] = ( uint8_t )((x) >> 16); (p)[3] = ( uint8_t )((x) >> 24); }
+#define rot_w(x, n)     ( ( (x) << (n) ) | ( (x) >> (32 - (n)) ) )
+
+#define t_col(s0, s1, s2, s3)   ( t_fn[(s0) & 0xff] ^ rot_w(t_fn[((s1) >> 8) & 0xff], 8) \
+                                ^ rot_w(t_fn[((s2) >> 16) & 0xff], 16) ^ rot_w(t_fn[(s3) >> 24], 24) )
+#define s_col(s0, s1, s2, s3)   ( ( uint32_t )s_box((s0) & 0xff) | ( ( uint32_t )s_box(((s1) >> 8) & 0xff) << 8 ) \
+                                | ( ( uint32_t )s_box(((s2) >> 16) & 0xff) << 16 ) | ( ( uint32_t )s_box((s3) >> 24) << 24 ) )
+
+return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
+{
+    if( ctx->rnd )
+    {
+        const uint8_t *k = ctx->ksch;
+        uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+        uint8_t r;
+
+        s0 = word_in(in     ) ^ word_in(k     );
+        s1 = word_in(in +  4) ^ word_in(k +  4);
+        s2 = word_in(in +  8) ^ word_in(k +  8);
+        s3 = word_in(in + 12) ^ word_in(k + 12);
+
+        for( r = 1 ; r < ctx->rnd ; ++r )
+        {
+            k += N_BLOCK;
+            t0 = t_col(s0, s1, s2, s3) ^ word_in(k     );
+            t1 = t_col(s1, s2, s3, s0) ^ word_in(k +  4);
+            t2 = t_col(s2, s3, s0, s1) ^ word_in(k +  8);
+            t3 = t_col(s3, s0, s1, s2) ^ word_in(k + 12);
+            s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+        }
+
+        k += N_BLOCK;
+        t0 = s_col(s0, s1, s2, s3) ^ word_in(k     );
+        t1 = s_col(s1, s2, s3, s0) ^ word_in(k +  4);
+        t2 = s_col(s2, s3, s0, s1) ^ word_in(k +  8);
+        t3 = s_col(s3, s0, s1, s2) ^ word_in(k + 12);
+        word_out(out     , t0);
+        word_out(out +  4, t1);
+        word_out(out +  8, t2);
+        word_out(out + 12, t3);
+    }
+    else
+        return ( uint8_t )-1;
+    return 0;
+}
+
+#else
+
 return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
 {
     if( ctx->rnd )
@@ -592,6 +682,8 @@ return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const
     return 0;
 }
 
+#endif
+
 /* CBC encrypt a number of blocks (input and return an IV) */
 
 return_type aes_cbc_encrypt( const uint8_t *in, uint8_t *out,
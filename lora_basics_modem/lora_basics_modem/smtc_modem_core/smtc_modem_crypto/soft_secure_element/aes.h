@@ -44,6 +44,9 @@ extern "C" {
 #  define AES_DEC_PREKEYED  /* AES decryption with a precomputed key schedule  */
 #endif
 #if 0
+#  define AES_ENC_T_TABLES  /* AES encryption on 32-bit columns with a 1 KB table */
+#endif
+#if 0
 #  define AES_ENC_128_OTFK  /* AES encryption with 'on the fly' 128 bit keying */
 #endif
 #if 0
@@ -41,12 +41,15 @@
 #include <stdbool.h>  // bool type
 
 #include "smtc_secure_element.h"
+#include "soft_se.h"
 
 #include "aes.h"
 #include "cmac.h"
 
 #include "smtc_modem_hal.h"
 #include "smtc_modem_hal_dbg_trace.h"
+#include "smtc_context_journal.h"
+#include "smtc_crc32.h"
 
 #include <string.h>  //for memset, memcpy
 
@@ -60,11 +63,6 @@
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
-/*!
- * Number of keys supported in soft secure element
- */
-#define SOFT_SE_NUMBER_OF_KEYS 23
-
 /*!
  * JoinAccept frame maximum size
  */
@@ -80,6 +78,13 @@
  */
 #define LORAMAC_MHDR_FIELD_SIZE 1
 
+/*!
+ * Number of expanded AES key schedules kept, the least recently used one is replaced
+ */
+#ifndef SOFT_SE_KEY_SCHEDULE_CACHE_SIZE
+#define SOFT_SE_KEY_SCHEDULE_CACHE_SIZE 4
+#endif
+
 #define SOFT_SE_KEY_LIST                                                                                             \
     {                                                                                                                \
         {                                                                                                            \
@@ -280,30 +285,6 @@
  * --- PRIVATE TYPES -----------------------------------------------------------
  */
 
-/**
- * @brief Key structure definition for the soft-se
- *
- * @struct soft_se_key_t
- */
-typedef struct soft_se_key_s
-{
-    smtc_se_key_identifier_t key_id;                       //!< Key identifier
-    uint8_t                  key_value[SMTC_SE_KEY_SIZE];  //!< Key value
-} soft_se_key_t;
-
-/**
- * @brief Structure for data needed by soft secure element
- *
- * @struct soft_se_data_t
- */
-typedef struct soft_se_data_s
-{
-    uint8_t       deveui[SMTC_SE_EUI_SIZE];          //!< DevEUI storage
-    uint8_t       joineui[SMTC_SE_EUI_SIZE];         //!< Join EUI storage
-    uint8_t       pin[SMTC_SE_PIN_SIZE];             //!< pin storage
-    soft_se_key_t key_list[SOFT_SE_NUMBER_OF_KEYS];  //!< The key list
-} soft_se_data_t;
-
 /**
  * @brief Struture for soft secure element context saving in NVM
  *
@@ -315,12 +296,35 @@ typedef struct soft_se_context_nvm_s
     uint32_t       crc;
 } soft_se_context_nvm_t;
 
+/**
+ * @brief Expanded AES key schedule of a key of the list
+ *
+ * @struct soft_se_key_schedule_t
+ */
+typedef struct soft_se_key_schedule_s
+{
+    smtc_se_key_identifier_t key_id;    //!< Key identifier
+    uint32_t                 last_use;  //!< Value of the use counter when the entry was last used, 0 if free
+    aes_context              aes_ctx;   //!< Expanded key schedule
+} soft_se_key_schedule_t;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE VARIABLES -------------------------------------------------------
  */
 
-static soft_se_data_t soft_se_data = { 0 };
+static soft_se_data_t soft_se_data_default = { 0 };
+
+/*!
+ * Data of the soft secure element in use
+ */
+static soft_se_data_t* soft_se_data = &soft_se_data_default;
+
+/*!
+ * Expanded key schedules of the last used keys of soft_se_data
+ */
+static soft_se_key_schedule_t soft_se_key_schedules[SOFT_SE_KEY_SCHEDULE_CACHE_SIZE];
+static uint32_t               soft_se_key_schedule_use_cnt;
 
 /*
  * -----------------------------------------------------------------------------
@@ -340,6 +344,22 @@ static soft_se_data_t soft_se_data = { 0 };
  */
 static smtc_se_return_code_t get_key_by_id( smtc_se_key_identifier_t key_id, soft_se_key_t** key_item );
 
+/**
+ * @brief Gets the expanded AES key schedule of a key, expanding it on a cache miss
+ *
+ * @param [in] key_id Key identifier
+ * @param [out] aes_ctx Expanded key schedule reference
+ * @return smtc_se_return_code_t
+ */
+static smtc_se_return_code_t get_key_schedule_by_id( smtc_se_key_identifier_t key_id, const aes_context** aes_ctx );
+
+/**
+ * @brief Drops the expanded AES key schedule of a key, to be called when its value changes
+ *
+ * @param [in] key_id Key identifier, SMTC_SE_NO_KEY to drop all of them
+ */
+static void invalidate_key_schedule( smtc_se_key_identifier_t key_id );
+
 /**
  * @brief Computes a CMAC of a message using provided initial Bx block
  *
@@ -355,20 +375,17 @@ static smtc_se_return_code_t get_key_by_id( smtc_se_key_identifier_t key_id, sof
 static smtc_se_return_code_t compute_cmac( uint8_t* mic_bx_buffer, const uint8_t* buffer, uint16_t size,
                                            smtc_se_key_identifier_t key_id, uint32_t* cmac );
 
-/**
- * @brief CRC function for soft se context security
- *
- * @param [in] buf  Data buffer
- * @param [in] len Length of the data
- * @return uint32_t
- */
-uint32_t soft_ce_crc( const uint8_t* buf, int len );
-
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
  */
 
+void soft_se_set_data( soft_se_data_t* data )
+{
+    soft_se_data = ( data != NULL ) ? data : &soft_se_data_default;
+    invalidate_key_schedule( SMTC_SE_NO_KEY );
+}
+
 smtc_se_return_code_t smtc_secure_element_init( void )
 {
     soft_se_data_t local_data = { .deveui   = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
@@ -376,7 +393,8 @@ smtc_se_return_code_t smtc_secure_element_init( void )
                                   .pin      = { 0x00, 0x00, 0x00, 0x00 },
                                   .key_list = SOFT_SE_KEY_LIST };
     // init soft secure element data euis and pin to 0 and key_list with empty lut
-    memcpy( ( uint8_t* ) &soft_se_data, ( uint8_t* ) &local_data, sizeof( local_data ) );
+    memcpy( ( uint8_t* ) soft_se_data, ( uint8_t* ) &local_data, sizeof( local_data ) );
+    invalidate_key_schedule( SMTC_SE_NO_KEY );
 
     SMTC_MODEM_HAL_TRACE_INFO( "Use soft secure element for cryptographic functionalities\n" );
 
@@ -393,8 +411,10 @@ smtc_se_return_code_t smtc_secure_element_set_key( smtc_se_key_identifier_t key_
 
     for( uint8_t i = 0; i < SOFT_SE_NUMBER_OF_KEYS; i++ )
     {
-        if( soft_se_data.key_list[i].key_id == key_id )
+        if( soft_se_data->key_list[i].key_id == key_id )
         {
+            invalidate_key_schedule( key_id );
+
             if( ( key_id == SMTC_SE_MC_KEY_0 ) || ( key_id == SMTC_SE_MC_KEY_1 ) || ( key_id == SMTC_SE_MC_KEY_2 ) ||
                 ( key_id == SMTC_SE_MC_KEY_3 ) )
             {  // Decrypt the key if its a Mckey
@@ -403,12 +423,12 @@ smtc_se_return_code_t smtc_secure_element_set_key( smtc_se_key_identifier_t key_
 
                 rc = smtc_secure_element_aes_encrypt( key, 16, SMTC_SE_MC_KE_KEY, decrypted_key );
 
-                memcpy( soft_se_data.key_list[i].key_value, decrypted_key, SMTC_SE_KEY_SIZE );
+                memcpy( soft_se_data->key_list[i].key_value, decrypted_key, SMTC_SE_KEY_SIZE );
                 return rc;
             }
             else
             {
-                memcpy( &( soft_se_data.key_list[i].key_value ), key, SMTC_SE_KEY_SIZE );
+                memcpy( &( soft_se_data->key_list[i].key_value ), key, SMTC_SE_KEY_SIZE );
                 return SMTC_SE_RC_SUCCESS;
             }
         }
@@ -469,21 +489,16 @@ smtc_se_return_code_t smtc_secure_element_aes_encrypt( const uint8_t* buffer, ui
         return SMTC_SE_RC_ERROR_BUF_SIZE;
     }
 
-    aes_context aes_ctx;
-    memset( &aes_ctx, 0, sizeof( aes_context ) );
-
-    soft_se_key_t*        key_item;
-    smtc_se_return_code_t rc = get_key_by_id( key_id, &key_item );
+    const aes_context*    aes_ctx;
+    smtc_se_return_code_t rc = get_key_schedule_by_id( key_id, &aes_ctx );
 
     if( rc == SMTC_SE_RC_SUCCESS )
     {
-        aes_set_key( key_item->key_value, 16, &aes_ctx );
-
-        uint8_t block = 0;
+        uint16_t block = 0;
 
         while( size != 0 )
         {
-            aes_encrypt( &buffer[block], &enc_buffer[block], &aes_ctx );
+            aes_encrypt( &buffer[block], &enc_buffer[block], aes_ctx );
             block = block + 16;
             size  = size - 16;
         }
@@ -491,6 +506,46 @@ smtc_se_return_code_t smtc_secure_element_aes_encrypt( const uint8_t* buffer, ui
     return rc;
 }
 
+smtc_se_return_code_t smtc_secure_element_aes_ctr_encrypt( const uint8_t* buffer, uint16_t size,
+                                                           smtc_se_key_identifier_t key_id, const uint8_t a_block[16],
+                                                           uint8_t* enc_buffer )
+{
+    if( ( buffer == NULL ) || ( enc_buffer == NULL ) || ( a_block == NULL ) )
+    {
+        return SMTC_SE_RC_ERROR_NPE;
+    }
+
+    const aes_context*    aes_ctx;
+    smtc_se_return_code_t rc = get_key_schedule_by_id( key_id, &aes_ctx );
+
+    if( rc == SMTC_SE_RC_SUCCESS )
+    {
+        uint8_t  ctr_block[16];
+        uint8_t  s_block[16];
+        uint16_t ctr   = ( ( uint16_t ) a_block[14] << 8 ) | a_block[15];
+        uint16_t index = 0;
+
+        memcpy( ctr_block, a_block, 16 );
+        while( index < size )
+        {
+            uint16_t block_size = ( ( size - index ) > 16 ) ? 16 : ( size - index );
+
+            ctr_block[14] = ( ctr >> 8 ) & 0xFF;
+            ctr_block[15] = ctr & 0xFF;
+            ctr++;
+
+            aes_encrypt( ctr_block, s_block, aes_ctx );
+            for( uint8_t i = 0; i < block_size; i++ )
+            {
+                enc_buffer[index + i] = buffer[index + i] ^ s_block[i];
+            }
+            index += block_size;
+        }
+        memset( s_block, 0, sizeof( s_block ) );
+    }
+    return rc;
+}
+
 smtc_se_return_code_t smtc_secure_element_derive_and_store_key( uint8_t* input, smtc_se_key_identifier_t rootkey_id,
                                                                 smtc_se_key_identifier_t targetkey_id )
 {
@@ -601,7 +656,7 @@ smtc_se_return_code_t smtc_secure_element_set_deveui( const uint8_t deveui[SMTC_
     {
         return SMTC_SE_RC_ERROR_NPE;
     }
-    memcpy( soft_se_data.deveui, deveui, SMTC_SE_EUI_SIZE );
+    memcpy( soft_se_data->deveui, deveui, SMTC_SE_EUI_SIZE );
     return SMTC_SE_RC_SUCCESS;
 }
 
@@ -611,7 +666,7 @@ smtc_se_return_code_t smtc_secure_element_get_deveui( uint8_t deveui[SMTC_SE_EUI
     {
         return SMTC_SE_RC_ERROR_NPE;
     }
-    memcpy( deveui, soft_se_data.deveui, SMTC_SE_EUI_SIZE );
+    memcpy( deveui, soft_se_data->deveui, SMTC_SE_EUI_SIZE );
     return SMTC_SE_RC_SUCCESS;
 }
 
@@ -621,7 +676,7 @@ smtc_se_return_code_t smtc_secure_element_set_joineui( const uint8_t joineui[SMT
     {
         return SMTC_SE_RC_ERROR_NPE;
     }
-    memcpy( soft_se_data.joineui, joineui, SMTC_SE_EUI_SIZE );
+    memcpy( soft_se_data->joineui, joineui, SMTC_SE_EUI_SIZE );
     return SMTC_SE_RC_SUCCESS;
 }
 
@@ -631,7 +686,7 @@ smtc_se_return_code_t smtc_secure_element_get_joineui( uint8_t joineui[SMTC_SE_E
     {
         return SMTC_SE_RC_ERROR_NPE;
     }
-    memcpy( joineui, soft_se_data.joineui, SMTC_SE_EUI_SIZE );
+    memcpy( joineui, soft_se_data->joineui, SMTC_SE_EUI_SIZE );
     return SMTC_SE_RC_SUCCESS;
 }
 
@@ -642,7 +697,7 @@ smtc_se_return_code_t smtc_secure_element_set_pin( const uint8_t pin[SMTC_SE_PIN
         return SMTC_SE_RC_ERROR_NPE;
     }
 
-    memcpy( soft_se_data.pin, pin, SMTC_SE_PIN_SIZE );
+    memcpy( soft_se_data->pin, pin, SMTC_SE_PIN_SIZE );
     return SMTC_SE_RC_SUCCESS;
 }
 
@@ -652,18 +707,18 @@ smtc_se_return_code_t smtc_secure_element_get_pin( uint8_t pin[SMTC_SE_PIN_SIZE]
     {
         return SMTC_SE_RC_ERROR_NPE;
     }
-    memcpy( pin, soft_se_data.pin, SMTC_SE_EUI_SIZE );
+    memcpy( pin, soft_se_data->pin, SMTC_SE_EUI_SIZE );
     return SMTC_SE_RC_SUCCESS;
 }
 
 smtc_se_return_code_t smtc_secure_element_store_context( void )
 {
     soft_se_context_nvm_t ctx = {
-        .data = soft_se_data,
+        .data = *soft_se_data,
     };
-    ctx.crc = soft_ce_crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 );
+    ctx.crc = smtc_crc32( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 );
 
-    smtc_modem_hal_context_store( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    smtc_context_journal_store( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
     smtc_secure_element_restore_context( );
     return SMTC_SE_RC_SUCCESS;
 }
@@ -671,10 +726,15 @@ smtc_se_return_code_t smtc_secure_element_store_context( void )
 smtc_se_return_code_t smtc_secure_element_restore_context( void )
 {
     soft_se_context_nvm_t ctx;
-    smtc_modem_hal_context_restore( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
-    if( soft_ce_crc( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 ) == ctx.crc )
+    smtc_context_journal_restore( CONTEXT_SECURE_ELEMENT, ( uint8_t* ) &ctx, sizeof( ctx ) );
+    if( smtc_crc32( ( uint8_t* ) &ctx, sizeof( ctx ) - 4 ) == ctx.crc )
     {
-        soft_se_data = ctx.data;
+        // The context is restored after each store: keep the key schedules while the keys are the same
+        if( memcmp( soft_se_data->key_list, ctx.data.key_list, sizeof( ctx.data.key_list ) ) != 0 )
+        {
+            invalidate_key_schedule( SMTC_SE_NO_KEY );
+        }
+        *soft_se_data = ctx.data;
         return SMTC_SE_RC_SUCCESS;
     }
     else
@@ -685,7 +745,8 @@ smtc_se_return_code_t smtc_secure_element_restore_context( void )
                                       .pin      = { 0x00, 0x00, 0x00, 0x00 },
                                       .key_list = SOFT_SE_KEY_LIST };
         // init soft secure element data euis and pin to 0 and key_list with empty lut
-        memcpy( ( uint8_t* ) &soft_se_data, ( uint8_t* ) &local_data, sizeof( local_data ) );
+        memcpy( ( uint8_t* ) soft_se_data, ( uint8_t* ) &local_data, sizeof( local_data ) );
+        invalidate_key_schedule( SMTC_SE_NO_KEY );
         return SMTC_SE_RC_ERROR;
     }
 }
@@ -698,15 +759,66 @@ static smtc_se_return_code_t get_key_by_id( smtc_se_key_identifier_t key_id, sof
 {
     for( uint8_t i = 0; i < SOFT_SE_NUMBER_OF_KEYS; i++ )
     {
-        if( soft_se_data.key_list[i].key_id == key_id )
+        if( soft_se_data->key_list[i].key_id == key_id )
         {
-            *key_item = &( soft_se_data.key_list[i] );
+            *key_item = &( soft_se_data->key_list[i] );
             return SMTC_SE_RC_SUCCESS;
         }
     }
     return SMTC_SE_RC_ERROR_INVALID_KEY_ID;
 }
 
+static smtc_se_return_code_t get_key_schedule_by_id( smtc_se_key_identifier_t key_id, const aes_context** aes_ctx )
+{
+    soft_se_key_schedule_t* entry = &soft_se_key_schedules[0];
+
+    // 0 is kept to flag the free entries
+    if( ++soft_se_key_schedule_use_cnt == 0 )
+    {
+        invalidate_key_schedule( SMTC_SE_NO_KEY );
+        soft_se_key_schedule_use_cnt = 1;
+    }
+    for( uint8_t i = 0; i < SOFT_SE_KEY_SCHEDULE_CACHE_SIZE; i++ )
+    {
+        if( ( soft_se_key_schedules[i].last_use != 0 ) && ( soft_se_key_schedules[i].key_id == key_id ) )
+        {
+            soft_se_key_schedules[i].last_use = soft_se_key_schedule_use_cnt;
+            *aes_ctx                          = &soft_se_key_schedules[i].aes_ctx;
+            return SMTC_SE_RC_SUCCESS;
+        }
+        // Free entries have a last use of 0, so they are replaced first
+        if( ( soft_se_key_schedule_use_cnt - soft_se_key_schedules[i].last_use ) >
+            ( soft_se_key_schedule_use_cnt - entry->last_use ) )
+        {
+            entry = &soft_se_key_schedules[i];
+        }
+    }
+
+    soft_se_key_t*        key_item;
+    smtc_se_return_code_t rc = get_key_by_id( key_id, &key_item );
+
+    if( rc == SMTC_SE_RC_SUCCESS )
+    {
+        memset( &entry->aes_ctx, 0, sizeof( aes_context ) );
+        aes_set_key( key_item->key_value, 16, &entry->aes_ctx );
+        entry->key_id   = key_id;
+        entry->last_use = soft_se_key_schedule_use_cnt;
+        *aes_ctx        = &entry->aes_ctx;
+    }
+    return rc;
+}
+
+static void invalidate_key_schedule( smtc_se_key_identifier_t key_id )
+{
+    for( uint8_t i = 0; i < SOFT_SE_KEY_SCHEDULE_CACHE_SIZE; i++ )
+    {
+        if( ( key_id == SMTC_SE_NO_KEY ) || ( soft_se_key_schedules[i].key_id == key_id ) )
+        {
+            memset( &soft_se_key_schedules[i], 0, sizeof( soft_se_key_schedule_t ) );
+        }
+    }
+}
+
 static smtc_se_return_code_t compute_cmac( uint8_t* mic_bx_buffer, const uint8_t* buffer, uint16_t size,
                                            smtc_se_key_identifier_t key_id, uint32_t* cmac )
 {
@@ -720,13 +832,14 @@ static smtc_se_return_code_t compute_cmac( uint8_t* mic_bx_buffer, const uint8_t
 
     AES_CMAC_Init( aes_cmac_ctx );
 
-    soft_se_key_t* key_item;
+    const aes_context* aes_ctx;
 
-    smtc_se_return_code_t rc = get_key_by_id( key_id, &key_item );
+    smtc_se_return_code_t rc = get_key_schedule_by_id( key_id, &aes_ctx );
 
     if( rc == SMTC_SE_RC_SUCCESS )
     {
-        AES_CMAC_SetKey( aes_cmac_ctx, key_item->key_value );
+        // Same as AES_CMAC_SetKey( ), without expanding the key again
+        memcpy( &aes_cmac_ctx->rijndael, aes_ctx, sizeof( aes_context ) );
 
         if( mic_bx_buffer != NULL )
         {
@@ -745,19 +858,4 @@ static smtc_se_return_code_t compute_cmac( uint8_t* mic_bx_buffer, const uint8_t
     return rc;
 }
 
-uint32_t soft_ce_crc( const uint8_t* buf, int len )
-{
-    uint32_t crc = 0xFFFFFFFF;
-    while( len-- > 0 )
-    {
-        crc = crc ^ *buf++;
-        for( int i = 0; i < 8; i++ )
-        {
-            uint32_t mask = -( crc & 1 );
-            crc           = ( crc >> 1 ) ^ ( 0xEDB88320 & mask );
-        }
-    }
-    return ~crc;
-}
-
 /* --- EOF ------------------------------------------------------------------ */
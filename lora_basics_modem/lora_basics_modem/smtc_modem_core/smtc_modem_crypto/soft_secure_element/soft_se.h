@@ -0,0 +1,118 @@
+/**
+ * @file      soft_se.h
+ *
+ * @brief     Soft secure element specific definitions
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SOFT_SE_H
+#define SOFT_SE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>   // C99 types
+#include <stdbool.h>  // bool type
+
+#include "smtc_secure_element.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/*!
+ * Number of keys supported in soft secure element
+ */
+#define SOFT_SE_NUMBER_OF_KEYS 23
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Key structure definition for the soft-se
+ *
+ * @struct soft_se_key_t
+ */
+typedef struct soft_se_key_s
+{
+    smtc_se_key_identifier_t key_id;                       //!< Key identifier
+    uint8_t                  key_value[SMTC_SE_KEY_SIZE];  //!< Key value
+} soft_se_key_t;
+
+/**
+ * @brief Structure for data needed by soft secure element
+ *
+ * @struct soft_se_data_t
+ */
+typedef struct soft_se_data_s
+{
+    uint8_t       deveui[SMTC_SE_EUI_SIZE];          //!< DevEUI storage
+    uint8_t       joineui[SMTC_SE_EUI_SIZE];         //!< Join EUI storage
+    uint8_t       pin[SMTC_SE_PIN_SIZE];             //!< pin storage
+    soft_se_key_t key_list[SOFT_SE_NUMBER_OF_KEYS];  //!< The key list
+} soft_se_data_t;
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Select the data used by the soft secure element
+ *
+ * By default the soft secure element works on its own internal data. Selecting another storage allows several
+ * LoRaWAN stacks to run in the same process (e.g. host simulation), each one switching to its own data before calling
+ * the stack.
+ *
+ * @param [in] data Data storage, NULL to go back to the internal data
+ */
+void soft_se_set_data( soft_se_data_t* data );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SOFT_SE_H
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -69,6 +69,16 @@ typedef enum file_upload_encrypt_mode
     FILE_UPLOAD_ENCRYPTED     = 0x01   //!< File Upload encrypted
 } file_upload_encrypt_mode_t;
 
+/**
+ * @brief Read callback of a file that is not held in RAM
+ *
+ * @param [in]  offset Offset in the file of the first byte to read
+ * @param [out] data   Buffer receiving the bytes
+ * @param [in]  size   Number of bytes to read
+ * @return true if the bytes are read
+ */
+typedef bool ( *file_upload_read_t )( uint32_t offset, uint8_t* data, uint16_t size );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE VARIABLES -------------------------------------------------------
@@ -82,6 +92,7 @@ typedef struct file_upload_s
     file_upload_encrypt_mode_t encrypt_mode;     // file upload encryptio mode
     uint8_t                    session_counter;  // session counter
     uint32_t*                  file_buf;         // data buffer
+    file_upload_read_t         file_read;        // reader of the file, NULL if it is in file_buf
     uint32_t                   file_len;         // file len
     uint32_t                   header[3];        // Current file upload header
     uint16_t                   cct;              // chunk count
@@ -125,8 +136,11 @@ file_upload_return_code_t file_upload_process_file_done_frame( file_upload_t* fi
 /**
  * @brief Once the file is attached to the current upload session, a preparation must be called before start
  *
+ * @remark A file attached with file_upload_attach_file_reader() is read once to be hashed, and once more to hash its
+ *         encrypted data if it is encrypted. It is not modified.
+ *
  * @param [in] file_upload Pointer to File Upload context
- * @return file_upload_return_code_t
+ * @return file_upload_return_code_t FILE_UPLOAD_ERROR if the file cannot be read
  */
 file_upload_return_code_t file_upload_prepare_upload( file_upload_t* file_upload );
 
@@ -145,7 +159,8 @@ uint32_t file_upload_get_average_delay_in_s( file_upload_t* file_upload );
  * @param [in] buf         buffer that will contain the fragment
  * @param [in] len         buffer size
  * @param [in] fcnt        frame counter
- * @return int32_t Return the number of pending byte(s)
+ * @return int32_t Return the number of pending byte(s), 0 if the buffer is too small for a chunk or -1 if the file
+ *                 cannot be read
  */
 int32_t file_upload_get_fragment( file_upload_t* file_upload, uint8_t* buf, int32_t len, uint32_t fcnt );
 
@@ -168,6 +183,17 @@ bool file_upload_is_data_remaining( file_upload_t* file_upload );
  */
 void file_upload_attach_file_buffer( file_upload_t* file_upload, const uint8_t* file );
 
+/**
+ * @brief Attach a file read through a callback, instead of a buffer holding the whole file
+ *
+ * @remark Each fragment reads the file once, in order, FILE_UPLOAD_READ_BUFFER_SIZE bytes at a time. An encrypted file
+ *         is encrypted again as it is read. The last chunk is padded with zeros.
+ *
+ * @param [in] file_upload Pointer to File Upload context
+ * @param [in] read        Reader of the file
+ */
+void file_upload_attach_file_reader( file_upload_t* file_upload, file_upload_read_t read );
+
 #ifdef __cplusplus
 }
 #endif
@@ -88,6 +88,18 @@ typedef enum radio_return_code_e
 void smtc_modem_services_aes_encrypt( const uint8_t* raw_buffer, uint16_t size, uint8_t aes_ctr_nonce[14],
                                       uint8_t* enc_buffer );
 
+/**
+ * @brief Computes the LoRaMAC payload encryption of a part of a buffer
+ *
+ * @param [in]  raw_buffer    Data buffer
+ * @param [in]  size          Data buffer size
+ * @param [in]  aes_ctr_nonce The AES CTR nonce to be used for encryption
+ * @param [in]  block_index   Index of the first 16 bytes block of the part in the whole buffer
+ * @param [out] enc_buffer    Encrypted buffer
+ */
+void smtc_modem_services_aes_encrypt_at( const uint8_t* raw_buffer, uint16_t size, uint8_t aes_ctr_nonce[14],
+                                         uint16_t block_index, uint8_t* enc_buffer );
+
 /**
  * @brief  Return elapsed time in seconds since a global common epoch.
  *
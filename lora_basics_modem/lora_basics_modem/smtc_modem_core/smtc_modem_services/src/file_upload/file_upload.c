@@ -92,11 +92,48 @@
 // number of words per chunk
 #define CHUNK_NW ( 2 )
 
+// maximum number of chunks in a fragment, for the largest LoRaWAN payload
+#define FILE_UPLOAD_MAX_CHUNKS_PER_FRAGMENT ( ( 242 - 3 ) / ( CHUNK_NW * 4 ) )
+
+// Size of the buffer a file attached with a reader is read into, a multiple of the AES block size
+#ifndef FILE_UPLOAD_READ_BUFFER_SIZE
+#define FILE_UPLOAD_READ_BUFFER_SIZE ( 64 )
+#endif
+
+#if( FILE_UPLOAD_READ_BUFFER_SIZE % 16 ) != 0
+#error "FILE_UPLOAD_READ_BUFFER_SIZE must be a multiple of 16"
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
  */
 
+/**
+ * @brief SHA256 of data given in several parts
+ */
+typedef struct sha256_ctx_s
+{
+    uint32_t state[8];
+    union
+    {
+        uint8_t  bytes[64];
+        uint32_t words[16];
+    } block;       // bytes not yet hashed
+    uint32_t len;  // number of bytes given
+} sha256_ctx_t;
+
+/**
+ * @brief Reader of the words of a file attached with a reader, in order
+ */
+typedef struct file_upload_reader_s
+{
+    uint8_t  buffer[FILE_UPLOAD_READ_BUFFER_SIZE];
+    uint32_t offset;     // offset in the file of the next buffer
+    uint16_t pos;        // position in the buffer of the next word
+    uint8_t  nonce[14];  // encryption nonce, if the file is encrypted
+} file_upload_reader_t;
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE VARIABLES -------------------------------------------------------
@@ -109,8 +146,76 @@
 
 static uint32_t phash( uint32_t x );
 static uint32_t checkbits( uint32_t cid, uint32_t cct, uint32_t i );
-static void     function_xor( uint32_t* dst, uint32_t* src, int32_t nw );
-static void     gen_chunk( file_upload_t* file_upload, uint32_t* dst, uint32_t* src, uint32_t cct, uint32_t cid );
+STATIC_INLINE void function_xor( uint32_t* dst, const uint32_t* src, int32_t nw );
+
+/**
+ * @brief Generate the coded chunks of a fragment
+ *
+ * The chunks of the file are read once, in order, by groups of 32 matching a check word. Each coded chunk is the XOR of
+ * the chunks of the group whose check bit is set, the set bits are scanned from the lowest one.
+ *
+ * @param [in]  file_upload Pointer to File Upload context
+ * @param [out] dst         Coded chunks
+ * @param [in]  nb_chunks   Number of coded chunks, at most FILE_UPLOAD_MAX_CHUNKS_PER_FRAGMENT
+ * @param [in]  cid         Identifier of the first coded chunk, the next ones follow
+ * @return false if the file cannot be read
+ */
+static bool gen_chunks( file_upload_t* file_upload, uint32_t dst[][CHUNK_NW], uint32_t nb_chunks, uint32_t cid );
+
+/**
+ * @brief Get consecutive chunks of the header and file, the chunks of a file attached with a reader are got in order
+ *
+ * @param [in]  file_upload Pointer to File Upload context
+ * @param [in]  reader      Reader of the file, unused if the file is in RAM
+ * @param [in]  first       Index of the first chunk
+ * @param [in]  nb_chunks   Number of chunks
+ * @param [out] chunks      Chunks
+ * @return false if the file cannot be read
+ */
+static bool get_chunks( file_upload_t* file_upload, file_upload_reader_t* reader, uint32_t first, uint32_t nb_chunks,
+                        uint32_t chunks[][CHUNK_NW] );
+
+/**
+ * @brief Read the next words of a file attached with a reader, the words after the end of the file are zero
+ *
+ * @param [in]  file_upload Pointer to File Upload context
+ * @param [in]  reader      Reader of the file
+ * @param [out] words       Words
+ * @param [in]  nw          Number of words
+ * @return false if the file cannot be read
+ */
+static bool reader_get_words( file_upload_t* file_upload, file_upload_reader_t* reader, uint32_t* words, uint32_t nw );
+
+/**
+ * @brief Read a part of a file attached with a reader, and encrypt it
+ *
+ * @param [in]  file_upload Pointer to File Upload context
+ * @param [in]  offset      Offset in the file, a multiple of 16 if the part is encrypted
+ * @param [out] buffer      Part of the file
+ * @param [in]  size        Size of the part, within the file
+ * @param [in]  nonce       Encryption nonce, NULL to keep the part plain
+ * @return false if the file cannot be read
+ */
+static bool read_file( file_upload_t* file_upload, uint32_t offset, uint8_t* buffer, uint16_t size, uint8_t* nonce );
+
+/**
+ * @brief Compute SHA256 of a file attached with a reader, plain or encrypted
+ *
+ * @param [in]  file_upload Pointer to File Upload context
+ * @param [out] hash        Contains the computed hash
+ * @param [in]  nonce       Encryption nonce, NULL to hash the plain file
+ * @return false if the file cannot be read
+ */
+static bool sha256_file( file_upload_t* file_upload, uint32_t* hash, uint8_t* nonce );
+
+/**
+ * @brief Get the encryption nonce of the file
+ *
+ * @param [in]  file_upload Pointer to File Upload context
+ * @param [in]  hash        First word of the hash of the plain file
+ * @param [out] nonce       Encryption nonce
+ */
+static void get_nonce( file_upload_t* file_upload, uint32_t hash, uint8_t nonce[14] );
 
 /**
  * @brief Compute SHA256
@@ -121,6 +226,30 @@ static void     gen_chunk( file_upload_t* file_upload, uint32_t* dst, uint32_t*
  */
 static void sha256( uint32_t* hash, const uint8_t* msg, uint32_t len );
 
+/**
+ * @brief Start a SHA256 computation over data given in several parts
+ *
+ * @param [in] ctx SHA256 context
+ */
+static void sha256_init( sha256_ctx_t* ctx );
+
+/**
+ * @brief Add data to a SHA256 computation
+ *
+ * @param [in] ctx SHA256 context
+ * @param [in] msg input buffer
+ * @param [in] len input buffer length
+ */
+static void sha256_update( sha256_ctx_t* ctx, const uint8_t* msg, uint32_t len );
+
+/**
+ * @brief End a SHA256 computation
+ *
+ * @param [in] ctx  SHA256 context
+ * @param [in] hash Contains the computed hash
+ */
+static void sha256_final( sha256_ctx_t* ctx, uint32_t* hash );
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -155,37 +284,57 @@ file_upload_return_code_t file_upload_init( file_upload_t* file_upload, uint32_t
 
 void file_upload_attach_file_buffer( file_upload_t* file_upload, const uint8_t* file )
 {
-    file_upload->file_buf = ( uint32_t* ) file;
+    file_upload->file_buf  = ( uint32_t* ) file;
+    file_upload->file_read = NULL;
+}
+
+void file_upload_attach_file_reader( file_upload_t* file_upload, file_upload_read_t read )
+{
+    file_upload->file_buf  = NULL;
+    file_upload->file_read = read;
 }
 
 file_upload_return_code_t file_upload_prepare_upload( file_upload_t* file_upload )
 {
     uint32_t hash[8];
-    sha256( hash, ( unsigned char* ) file_upload->file_buf, file_upload->file_len );
+    if( file_upload->file_read != NULL )
+    {
+        if( sha256_file( file_upload, hash, NULL ) == false )
+        {
+            LOG_ERROR( "FileUpload cannot read the file\n" );
+            return FILE_UPLOAD_ERROR;
+        }
+    }
+    else
+    {
+        sha256( hash, ( unsigned char* ) file_upload->file_buf, file_upload->file_len );
+    }
     file_upload->header[1] = hash[0];
     file_upload->header[2] = hash[1];
 
     if( file_upload->encrypt_mode == FILE_UPLOAD_ENCRYPTED )
     {
         // encrypt using AppSKey with "upload" category and file size and hash as diversification data
-        uint8_t nonce[14] = { 0 };
-
-        nonce[0] = 0x01;
-
-        nonce[5]  = FILE_UPLOAD_DIRECTION;
-        nonce[6]  = file_upload->file_len & 0xFF;
-        nonce[7]  = ( file_upload->file_len >> 8 ) & 0xFF;
-        nonce[8]  = ( file_upload->file_len >> 16 ) & 0xFF;
-        nonce[9]  = ( file_upload->file_len >> 24 ) & 0xFF;
-        nonce[10] = hash[0] & 0xFF;
-        nonce[11] = ( hash[0] >> 8 ) & 0xFF;
-        nonce[12] = ( hash[0] >> 16 ) & 0xFF;
-        nonce[13] = ( hash[0] >> 24 ) & 0xFF;
-        smtc_modem_services_aes_encrypt( ( uint8_t* ) file_upload->file_buf, file_upload->file_len, nonce,
-                                         ( uint8_t* ) file_upload->file_buf );
-
-        // compute hash over encrypted data
-        sha256( hash, ( unsigned char* ) file_upload->file_buf, file_upload->file_len );
+        uint8_t nonce[14];
+        get_nonce( file_upload, hash[0], nonce );
+
+        if( file_upload->file_read != NULL )
+        {
+            // The file is left plain, it is encrypted again each time it is read
+            if( sha256_file( file_upload, hash, nonce ) == false )
+            {
+                LOG_ERROR( "FileUpload cannot read the file\n" );
+                return FILE_UPLOAD_ERROR;
+            }
+        }
+        else
+        {
+            smtc_modem_services_aes_encrypt( ( uint8_t* ) file_upload->file_buf, file_upload->file_len, nonce,
+                                             ( uint8_t* ) file_upload->file_buf );
+
+            // compute hash over encrypted data
+            sha256( hash, ( unsigned char* ) file_upload->file_buf, file_upload->file_len );
+        }
 
         // hash over plain data (first byte)
         file_upload->header[2] = file_upload->header[1];
@@ -206,20 +355,31 @@ int32_t file_upload_get_fragment( file_upload_t* file_upload, uint8_t* buf, int3
     // counter, 10bit chunk count-1
     uint32_t d = ( ( file_upload->sid & 0x03 ) << 14 ) | ( ( file_upload->session_counter & 0x0F ) << 10 ) |
                  ( ( file_upload->cct - 1 ) & 0x03FF );
-    int32_t n     = 0;
-    buf[n++]      = FILE_UPLOAD_TOKEN;
-    buf[n++]      = d;
-    buf[n++]      = d >> 8;
-    uint32_t  cid = phash( fcnt );
-    uint32_t* src = &file_upload->file_buf[0];
+    int32_t n = 0;
+    buf[n++]  = FILE_UPLOAD_TOKEN;
+    buf[n++]  = d;
+    buf[n++]  = d >> 8;
 
+    uint32_t cid = phash( fcnt );
+
+    // the coded chunks are generated in one pass over the file, by batches that fit in a LoRaWAN payload
     while( len >= ( CHUNK_NW * 4 ) )
     {
-        uint32_t tmp[CHUNK_NW];
-        gen_chunk( file_upload, tmp, src, file_upload->cct, cid++ );
-        memcpy( buf + n, tmp, CHUNK_NW * 4 );
-        n += ( CHUNK_NW * 4 );
-        len -= ( CHUNK_NW * 4 );
+        uint32_t chunks[FILE_UPLOAD_MAX_CHUNKS_PER_FRAGMENT][CHUNK_NW];
+        uint32_t nb_chunks = len / ( CHUNK_NW * 4 );
+        if( nb_chunks > FILE_UPLOAD_MAX_CHUNKS_PER_FRAGMENT )
+        {
+            nb_chunks = FILE_UPLOAD_MAX_CHUNKS_PER_FRAGMENT;
+        }
+        if( gen_chunks( file_upload, chunks, nb_chunks, cid ) == false )
+        {
+            LOG_ERROR( "FileUpload cannot read the file\n" );
+            return -1;
+        }
+        memcpy( buf + n, chunks, nb_chunks * CHUNK_NW * 4 );
+        n += nb_chunks * CHUNK_NW * 4;
+        len -= nb_chunks * CHUNK_NW * 4;
+        cid += nb_chunks;
     }
     if( n > 0 )
     {
@@ -269,43 +429,150 @@ uint32_t file_upload_get_average_delay_in_s( file_upload_t* file_upload )
  * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
  */
 
-static void gen_chunk( file_upload_t* file_upload, uint32_t* dst, uint32_t* src, uint32_t cct, uint32_t cid )
+static bool gen_chunks( file_upload_t* file_upload, uint32_t dst[][CHUNK_NW], uint32_t nb_chunks, uint32_t cid )
 {
-    memset( dst, 0, CHUNK_NW * 4 );
-    uint32_t bits = 0;  // initialized to make compiler happy
-    for( uint32_t i = 0; i < cct; i++ )
+    uint32_t             src[32][CHUNK_NW];
+    file_upload_reader_t reader;
+
+    memset( dst, 0, nb_chunks * CHUNK_NW * 4 );
+    if( file_upload->file_read != NULL )
     {
-        if( ( i & 31 ) == 0 )
+        reader.offset = 0;
+        reader.pos    = FILE_UPLOAD_READ_BUFFER_SIZE;
+        if( file_upload->encrypt_mode == FILE_UPLOAD_ENCRYPTED )
         {
-            bits = checkbits( cid, cct, i >> 5 );
+            // header[2] holds the hash over plain data
+            get_nonce( file_upload, file_upload->header[2], reader.nonce );
         }
-        if( bits == 0 )
+    }
+    for( uint32_t i = 0; i < file_upload->cct; i += 32 )
+    {
+        uint32_t nb_src = ( ( file_upload->cct - i ) > 32 ) ? 32 : ( file_upload->cct - i );
+        uint32_t mask   = ( nb_src == 32 ) ? 0xFFFFFFFF : ( ( 1UL << nb_src ) - 1 );
+
+        if( get_chunks( file_upload, &reader, i, nb_src, src ) == false )
         {
-            continue;
+            return false;
         }
-        if( bits & 1 )
+        for( uint32_t j = 0; j < nb_chunks; j++ )
         {
-            if( i == 0 )
+            uint32_t bits          = checkbits( cid + j, file_upload->cct, i >> 5 ) & mask;
+            uint32_t acc[CHUNK_NW] = { 0 };
+
+            while( bits != 0 )
             {
-                uint32_t tmp[2];
-                tmp[0] = file_upload->header[0];
-                tmp[1] = file_upload->header[1];
-                function_xor( dst, tmp, CHUNK_NW );
+                function_xor( acc, src[__builtin_ctz( bits )], CHUNK_NW );
+                bits &= bits - 1;
             }
-            else if( i == 1 )
+            function_xor( dst[j], acc, CHUNK_NW );
+        }
+    }
+    return true;
+}
+
+static bool get_chunks( file_upload_t* file_upload, file_upload_reader_t* reader, uint32_t first, uint32_t nb_chunks,
+                        uint32_t chunks[][CHUNK_NW] )
+{
+    uint32_t* words = chunks[0];
+    uint32_t  w     = first * CHUNK_NW;      // index of the first word in the header and file
+    uint32_t  nw    = nb_chunks * CHUNK_NW;  // number of words
+
+    while( ( nw > 0 ) && ( w < ( FILE_UPLOAD_HEADER_SIZE / 4 ) ) )
+    {
+        *words++ = file_upload->header[w++];
+        nw--;
+    }
+    if( nw == 0 )
+    {
+        return true;
+    }
+    if( file_upload->file_read != NULL )
+    {
+        return reader_get_words( file_upload, reader, words, nw );
+    }
+    memcpy( words, file_upload->file_buf + w - ( FILE_UPLOAD_HEADER_SIZE / 4 ), nw * 4 );
+    return true;
+}
+
+static bool reader_get_words( file_upload_t* file_upload, file_upload_reader_t* reader, uint32_t* words, uint32_t nw )
+{
+    while( nw-- > 0 )
+    {
+        if( reader->pos == FILE_UPLOAD_READ_BUFFER_SIZE )
+        {
+            uint16_t size = 0;
+            if( reader->offset < file_upload->file_len )
             {
-                uint32_t tmp[2];
-                tmp[0] = file_upload->header[2];
-                tmp[1] = *( src );
-                function_xor( dst, tmp, CHUNK_NW );
+                size = ( ( file_upload->file_len - reader->offset ) > FILE_UPLOAD_READ_BUFFER_SIZE )
+                           ? FILE_UPLOAD_READ_BUFFER_SIZE
+                           : ( file_upload->file_len - reader->offset );
             }
-            else
+            memset( &reader->buffer[size], 0, FILE_UPLOAD_READ_BUFFER_SIZE - size );
+            if( ( size > 0 ) &&
+                ( read_file( file_upload, reader->offset, reader->buffer, size,
+                             ( file_upload->encrypt_mode == FILE_UPLOAD_ENCRYPTED ) ? reader->nonce : NULL ) == false ) )
             {
-                function_xor( dst, src + ( CHUNK_NW * i ) - 3, CHUNK_NW );
+                return false;
             }
+            reader->offset += FILE_UPLOAD_READ_BUFFER_SIZE;
+            reader->pos = 0;
+        }
+        memcpy( words++, &reader->buffer[reader->pos], 4 );
+        reader->pos += 4;
+    }
+    return true;
+}
+
+static bool read_file( file_upload_t* file_upload, uint32_t offset, uint8_t* buffer, uint16_t size, uint8_t* nonce )
+{
+    if( file_upload->file_read( offset, buffer, size ) == false )
+    {
+        return false;
+    }
+    if( nonce != NULL )
+    {
+        // The key stream of the part starts with the block of its offset
+        smtc_modem_services_aes_encrypt_at( buffer, size, nonce, offset / 16, buffer );
+    }
+    return true;
+}
+
+static bool sha256_file( file_upload_t* file_upload, uint32_t* hash, uint8_t* nonce )
+{
+    uint8_t      buffer[FILE_UPLOAD_READ_BUFFER_SIZE];
+    sha256_ctx_t ctx;
+
+    sha256_init( &ctx );
+    for( uint32_t offset = 0; offset < file_upload->file_len; offset += FILE_UPLOAD_READ_BUFFER_SIZE )
+    {
+        uint16_t size = ( ( file_upload->file_len - offset ) > FILE_UPLOAD_READ_BUFFER_SIZE )
+                            ? FILE_UPLOAD_READ_BUFFER_SIZE
+                            : ( file_upload->file_len - offset );
+        if( read_file( file_upload, offset, buffer, size, nonce ) == false )
+        {
+            return false;
         }
-        bits >>= 1;
+        sha256_update( &ctx, buffer, size );
     }
+    sha256_final( &ctx, hash );
+    return true;
+}
+
+static void get_nonce( file_upload_t* file_upload, uint32_t hash, uint8_t nonce[14] )
+{
+    memset( nonce, 0, 14 );
+
+    nonce[0] = 0x01;
+
+    nonce[5]  = FILE_UPLOAD_DIRECTION;
+    nonce[6]  = file_upload->file_len & 0xFF;
+    nonce[7]  = ( file_upload->file_len >> 8 ) & 0xFF;
+    nonce[8]  = ( file_upload->file_len >> 16 ) & 0xFF;
+    nonce[9]  = ( file_upload->file_len >> 24 ) & 0xFF;
+    nonce[10] = hash & 0xFF;
+    nonce[11] = ( hash >> 8 ) & 0xFF;
+    nonce[12] = ( hash >> 16 ) & 0xFF;
+    nonce[13] = ( hash >> 24 ) & 0xFF;
 }
 
 // 32bit pseudo hash
@@ -323,7 +590,7 @@ static uint32_t checkbits( uint32_t cid, uint32_t cct, uint32_t i )
     return phash( cid * ncw + i );
 }
 
-static void function_xor( uint32_t* dst, uint32_t* src, int32_t nw )
+STATIC_INLINE void function_xor( uint32_t* dst, const uint32_t* src, int32_t nw )
 {
     while( nw-- > 0 )
     {
@@ -390,48 +657,64 @@ static void sha256_do( uint32_t* state, const uint8_t* block )
 
 static void sha256( uint32_t* hash, const uint8_t* msg, uint32_t len )
 {
-    uint32_t state[8] = {
-        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
-    };
+    sha256_ctx_t ctx;
+
+    sha256_init( &ctx );
+    sha256_update( &ctx, msg, len );
+    sha256_final( &ctx, hash );
+}
+
+static void sha256_init( sha256_ctx_t* ctx )
+{
+    static const uint32_t H0[8] = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+
+    memcpy( ctx->state, H0, sizeof( H0 ) );
+    ctx->len = 0;
+}
+
+static void sha256_update( sha256_ctx_t* ctx, const uint8_t* msg, uint32_t len )
+{
+    uint32_t used = ctx->len & 63;
 
-    uint32_t bitlen = len << 3;
-    while( 1 )
+    ctx->len += len;
+    if( used != 0 )
     {
-        if( len < 64 )
+        uint32_t n = ( len > ( 64 - used ) ) ? ( 64 - used ) : len;
+        memcpy( &ctx->block.bytes[used], msg, n );
+        msg += n;
+        len -= n;
+        if( ( used + n ) < 64 )
         {
-            union
-            {
-                uint8_t  bytes[64];
-                uint32_t words[16];
-            } tmp;
-            memset( tmp.words, 0, sizeof( tmp ) );
-            memcpy( tmp.bytes, msg, len );
-            tmp.bytes[len] = 0x80;
-            if( len < 56 )
-            {
-            last:
-                tmp.words[15] = ENDIAN_n2b32( bitlen );
-                sha256_do( state, tmp.bytes );
-                int i;
-                for( i = 0; i < 8; i++ )
-                {
-                    hash[i] = ENDIAN_n2b32( state[i] );
-                }
-                break;
-            }
-            else
-            {
-                sha256_do( state, tmp.bytes );
-                memset( tmp.words, 0, sizeof( tmp ) );
-                goto last;
-            }
-        }
-        else
-        {
-            sha256_do( state, msg );
-            msg += 64;
-            len -= 64;
+            return;
         }
+        sha256_do( ctx->state, ctx->block.bytes );
+    }
+    while( len >= 64 )
+    {
+        sha256_do( ctx->state, msg );
+        msg += 64;
+        len -= 64;
+    }
+    memcpy( ctx->block.bytes, msg, len );
+}
+
+static void sha256_final( sha256_ctx_t* ctx, uint32_t* hash )
+{
+    uint32_t used = ctx->len & 63;
+
+    memset( &ctx->block.bytes[used], 0, 64 - used );
+    ctx->block.bytes[used] = 0x80;
+    if( used >= 56 )
+    {
+        sha256_do( ctx->state, ctx->block.bytes );
+        memset( ctx->block.words, 0, sizeof( ctx->block ) );
+    }
+    ctx->block.words[15] = ENDIAN_n2b32( ctx->len << 3 );
+    sha256_do( ctx->state, ctx->block.bytes );
+    for( int i = 0; i < 8; i++ )
+    {
+        hash[i] = ENDIAN_n2b32( ctx->state[i] );
     }
 }
 
@@ -87,6 +87,7 @@ STATIC void os_wlsbf4( uint8_t* buf, uint32_t v )
 //
 //
 //   <--------------------------------ROSE_FIFO_SIZE---------->
+//   <------------------------ROSE_RING_SIZE--------->
 //   <------wl----->                                  <--wl8-->
 //   +--------------+------------------+-------------+--------+
 //   |  redundancy  |.  pending_send   |.     free   |  rvec  |
@@ -95,7 +96,10 @@ STATIC void os_wlsbf4( uint8_t* buf, uint32_t v )
 //                   |                  |
 //          octet with label soff      fill
 //
-//
+//  The first ROSE_RING_SIZE octets are a circular buffer: unit 0 of the
+//  window is stored at 'head', so that the window slides without moving
+//  the data. Offsets (unsent, fill) are counted in units from 'head'.
+//  Octets after 'fill' are always zero.
 //
 //  SDATA message:
 //            0  -    6      7
@@ -108,32 +112,104 @@ STATIC void os_wlsbf4( uint8_t* buf, uint32_t v )
 //      ...
 //
 
+// Position in the ring of unit off
+STATIC_INLINE uint16_t ringPos( rose_t* ROSE, int off )
+{
+    return ( ROSE->head + off * ROSE->unitsz ) & ( ROSE_RING_SIZE - 1 );
+}
+
 STATIC void clearFifo( rose_t* ROSE, int off, int len )
 {
-    int sz = ROSE->unitsz;
-    memset( &ROSE->fifo[off * sz], 0, len * sz );
+    uint16_t pos = ringPos( ROSE, off );
+    int      n   = MIN( len * ROSE->unitsz, ROSE_RING_SIZE - pos );
+    memset( &ROSE->fifo[pos], 0, n );
+    memset( &ROSE->fifo[0], 0, len * ROSE->unitsz - n );
 }
 
-STATIC void shiftFifo( rose_t* ROSE, int dest, int src, int len )
+// Drop the first units of the window, the data is not moved
+STATIC void slideFifo( rose_t* ROSE, int shift )
 {
-    int sz = ROSE->unitsz;
-    memmove( &ROSE->fifo[dest * sz], &ROSE->fifo[src * sz], len * sz );
+    clearFifo( ROSE, 0, shift );
+    ROSE->head = ringPos( ROSE, shift );
 }
 
 STATIC void drainFifo( rose_t* ROSE, uint8_t* dest, int src, int len )
 {
-    int sz = ROSE->unitsz;
-    memcpy( dest, &ROSE->fifo[src * sz], len * sz );
+    uint16_t pos = ringPos( ROSE, src );
+    int      n   = MIN( len * ROSE->unitsz, ROSE_RING_SIZE - pos );
+    memcpy( dest, &ROSE->fifo[pos], n );
+    memcpy( dest + n, &ROSE->fifo[0], len * ROSE->unitsz - n );
+}
+
+STATIC void fillFifo( rose_t* ROSE, int dest, const uint8_t* src, int len )
+{
+    uint16_t pos = ringPos( ROSE, dest );
+    int      n   = MIN( len * ROSE->unitsz, ROSE_RING_SIZE - pos );
+    memcpy( &ROSE->fifo[pos], src, n );
+    memcpy( &ROSE->fifo[0], src + n, len * ROSE->unitsz - n );
+}
+
+// XOR into dest the units whose bit is set in rvec, a unit is never split by the end of the ring
+// The units are loaded in 32-bit words when sz allows, the FIFO is not aligned so they are copied.
+// sz is a constant for each caller, so that the loop is specialized for each unit size.
+STATIC_INLINE void xorUnitsSz( rose_t* ROSE, uint8_t* dest, const uint8_t* rvec, const int sz )
+{
+    const uint8_t* fifo   = ROSE->fifo;
+    uint16_t       head   = ROSE->head;
+    int            nbytes = ( ROSE->wl + 7 ) / 8;
+    uint32_t       acc[2] = { 0, 0 };
+    for( int ri = 0; ri < nbytes; ri++ )
+    {
+        for( uint32_t bits = rvec[ri]; bits != 0; bits &= bits - 1 )
+        {
+            const uint8_t* src = &fifo[( head + ( ( ri << 3 ) + __builtin_ctz( bits ) ) * sz ) & ( ROSE_RING_SIZE - 1 )];
+            uint32_t       w[2];
+            if( sz == 1 )
+            {
+                acc[0] ^= src[0];
+            }
+            else if( sz == 2 )
+            {
+                acc[0] ^= ( uint32_t ) src[0] | ( ( uint32_t ) src[1] << 8 );
+            }
+            else
+            {
+                memcpy( w, src, sz );
+                acc[0] ^= w[0];
+                acc[1] ^= ( sz == 8 ) ? w[1] : 0;
+            }
+        }
+    }
+    if( sz <= 2 )
+    {
+        dest[0] = acc[0];
+        if( sz == 2 )
+        {
+            dest[1] = acc[0] >> 8;
+        }
+    }
+    else
+    {
+        memcpy( dest, acc, sz );
+    }
 }
 
-STATIC_INLINE void xorUnit( rose_t* ROSE, uint8_t* dest, int destidx, const uint8_t* src, int srcidx )
+STATIC void xorUnits( rose_t* ROSE, uint8_t* dest, const uint8_t* rvec )
 {
-    int sz = ROSE->unitsz;
-    dest += destidx * sz;
-    src += srcidx * sz;
-    for( int i = 0; i < sz; i++ )
+    switch( ROSE->unitsz )
     {
-        dest[i] ^= src[i];
+    case 1:
+        xorUnitsSz( ROSE, dest, rvec, 1 );
+        break;
+    case 2:
+        xorUnitsSz( ROSE, dest, rvec, 2 );
+        break;
+    case 4:
+        xorUnitsSz( ROSE, dest, rvec, 4 );
+        break;
+    default:
+        xorUnitsSz( ROSE, dest, rvec, 8 );
+        break;
     }
 }
 
@@ -207,14 +283,26 @@ STATIC int32_t diluteRedCnt( rose_t* ROSE, uint16_t n )
 // Write an XOR combination of fragments into buffer pfrag
 // Selection of fragment is controlled by AppCnt
 //
+// The coefficients of a unit are first drawn into rvec, then the selected
+// units are XORed in one pass: the combination does not depend on the
+// order of the draws, only on the set of coefficients.
+//
 STATIC void buildRedundancyOctets( rose_t* ROSE, uint32_t fcntup, uint8_t* redbuf, uint8_t n_units )
 {
     // ASSERT(n_units <= ROSE->wl);
     uint32_t wl   = ROSE->wl;
     uint32_t wlx  = wl + ( ( ( wl - 1 ) & wl ) == 0 );  // fixup if wl=2^i => wlx = wl+1
     uint8_t* rvec = get_rvec( ROSE );                   // holds pseudo random bit vector
-    uint8_t* redp = ROSE->fifo;                         // redundancy pool
-    memset( redbuf, 0, n_units * ROSE->unitsz );
+
+    // x % wlx is computed as x - wlx * ( ( x * m ) >> k ), with m = ceil( 2^k / wlx ):
+    // exact for x < 2^23 as soon as 2^k >= 2^23 * wlx. The seed may be larger,
+    // prbs23 brings it below 2^23 within 9 steps.
+    uint8_t k = 23;
+    while( ( 1UL << ( k - 23 ) ) < wlx )
+    {
+        k++;
+    }
+    uint32_t m = ( ( ( uint64_t ) 1 << k ) + wlx - 1 ) / wlx;
 
     for( int i = 0; i < n_units; i++ )
     {
@@ -227,16 +315,15 @@ STATIC void buildRedundancyOctets( rose_t* ROSE, uint32_t fcntup, uint8_t* redbu
             while( r >= wl )
             {  // only relevant for m=1
                 x = prbs23( x );
-                r = x % wlx;
-            }
-            int ri = r >> 3, rb = 1 << ( r & 7 );
-            if( ( rvec[ri] & rb ) == 0 )
-            {
-                nbCoeff += 1;
-                rvec[ri] |= rb;
-                xorUnit( ROSE, redbuf, i, redp, r );
+                r = ( x < ( 1UL << 23 ) ) ? x - wlx * ( uint32_t )( ( ( uint64_t ) x * m ) >> k ) : x % wlx;
             }
+            // Without a branch: a coefficient is drawn again about once in three draws
+            int     ri  = r >> 3, rb = 1 << ( r & 7 );
+            uint8_t old = rvec[ri];
+            rvec[ri]    = old | rb;
+            nbCoeff += ( old & rb ) == 0;
         }
+        xorUnits( ROSE, &redbuf[i * ROSE->unitsz], rvec );  // from redundancy pool
     }
 }
 
@@ -290,7 +377,7 @@ int ROSE_init( rose_t* ROSE, uint16_t windowLen, uint16_t minfree, uint8_t redun
 {
     memset( ROSE, 0, sizeof( rose_t ) );
 
-    if( ( unitsz != 1 && unitsz != 2 && unitsz != 4 && unitsz != 8 ) || ROSE_FIFO_SIZE % unitsz != 0 )
+    if( ( unitsz != 1 && unitsz != 2 && unitsz != 4 && unitsz != 8 ) || ROSE_RING_SIZE % unitsz != 0 )
     {
         LOG_ERROR( "ROSE_BAD_UNITSZ\n" );
         return ROSE_BAD_UNITSZ;
@@ -298,7 +385,7 @@ int ROSE_init( rose_t* ROSE, uint16_t windowLen, uint16_t minfree, uint8_t redun
     uint16_t wl  = ROSE_decWL( ROSE_encWL( windowLen ) );
     ROSE->wl     = wl;
     ROSE->unitsz = unitsz;
-    if( &ROSE->fifo[wl * unitsz + minfree] > get_rvec( ROSE ) )
+    if( wl * unitsz + minfree > ROSE_RING_SIZE )
     {
         LOG_ERROR( "ROSE_NOMEM\n" );
         return ROSE_NOMEM;
@@ -343,7 +430,7 @@ uint32_t ROSE_getSoff( rose_t* ROSE )
 
 uint16_t ROSE_getFree( rose_t* ROSE )
 {
-    return get_rvec( ROSE ) - &ROSE->fifo[ROSE->fill * ROSE->unitsz];
+    return ROSE_RING_SIZE - ROSE->fill * ROSE->unitsz;
 }
 
 uint16_t ROSE_getPending( rose_t* ROSE )
@@ -484,8 +571,7 @@ addHdr:
         ROSE->unsent -= shift;
         ROSE->redcnt = diluteRedCnt( ROSE, shift );
         LOG_INFO( "DILUTE: ROSE->redcnt %d shift %d\n", ROSE->redcnt, shift );
-        shiftFifo( ROSE, 0, shift, ROSE->fill );
-        clearFifo( ROSE, ROSE->fill, shift );
+        slideFifo( ROSE, shift );
     }
     if( sysc + redc == 0 )
     {
@@ -563,9 +649,8 @@ int ROSE_processDnFrame( rose_t* ROSE, const uint8_t* frmpayload, uint8_t flen )
         //
         //
         // Case 2: we want to increase WL.
-        //   In this case we need to ensure that the free space is big enough
-        //   to accomodate the additional redundancy + rvec space before
-        //   shifting
+        //   In this case we need to ensure that the ring is big enough
+        //   to accomodate the additional redundancy before shifting
         //
         //   <--------------------------------ROSE_FIFO_SIZE----------->
         //   <---------WL-------->                           <---WL/8-->
@@ -576,13 +661,10 @@ int ROSE_processDnFrame( rose_t* ROSE, const uint8_t* frmpayload, uint8_t flen )
         //                       |                  |
         //                     unsent             fill
         //
-        int      wl      = ROSE_decWL( frmpayload[SCMD_WL_OFF] );
-        int      rveclen = MAX( 16, ( wl + 7 ) / 8 );
-        uint8_t* rvec    = &ROSE->fifo[ROSE_FIFO_SIZE - rveclen];
-        if( &ROSE->fifo[ROSE->fill * ROSE->unitsz] > rvec )
+        int wl = ROSE_decWL( frmpayload[SCMD_WL_OFF] );
+        if( wl * ROSE->unitsz > ROSE_RING_SIZE )
         {
-            // Ignore change request if bigger WL would lead
-            // to overwriting FIFO contents thru increased rvec space.
+            // Ignore change request if bigger WL would not fit in the ring
             LOG_WARN( "Ignoring WL increase to avoid overwriting pending data\n" );
         }
         else
@@ -594,13 +676,12 @@ int ROSE_processDnFrame( rose_t* ROSE, const uint8_t* frmpayload, uint8_t flen )
                 // Here we decrease WL, we can always do it.
                 ROSE->fill -= shift;
                 ROSE->unsent -= shift;
-                shiftFifo( ROSE, 0, shift, ROSE->fill );
-                clearFifo( ROSE, ROSE->fill, shift );
+                slideFifo( ROSE, shift );
                 // Update redcnt
                 // this is very important to ensure that we continue sending
                 // redundancy data when WL is reduced
-                ROSE->redcnt = diluteRedCnt( ROSE, shift );
-                rvec         = get_rvec( ROSE );  // old - bigger rvec
+                ROSE->redcnt  = diluteRedCnt( ROSE, shift );
+                uint8_t* rvec = get_rvec( ROSE );  // old - bigger rvec
                 memset( rvec, 0, &ROSE->fifo[ROSE_FIFO_SIZE] - rvec );
             }
             // We don't shift pending data when we increase WL, because that
@@ -623,11 +704,14 @@ int ROSE_addRecord( rose_t* ROSE, const uint8_t* data, uint16_t nbytes )
     if( nbytes == 0 || nbytes >= 0xFF )
         return ROSE_BAD_DATALEN;
     uint16_t n       = ( 2 + nbytes + ROSE->unitsz - 1 ) / ROSE->unitsz;
-    uint16_t freeEnd = ( get_rvec( ROSE ) - &ROSE->fifo[0] ) / ROSE->unitsz;
+    uint16_t freeEnd = ROSE_RING_SIZE / ROSE->unitsz;
     uint16_t free    = freeEnd - ROSE->fill;
     if( n > free )
         return ROSE_OVERRUN;
-    uint8_t* p = &ROSE->fifo[ROSE->fill * ROSE->unitsz];
+    // The record is built in place, unless it is split by the end of the ring
+    uint8_t  rec[( 2 + 0xFE + 7 ) & ~7];
+    uint16_t pos = ringPos( ROSE, ROSE->fill );
+    uint8_t* p   = ( pos + n * ROSE->unitsz <= ROSE_RING_SIZE ) ? &ROSE->fifo[pos] : rec;
     memcpy( p + 1, data, nbytes );
 
     if( ( ROSE->flags & ROSE_CIPHER_REC ) != 0 )
@@ -654,6 +738,10 @@ int ROSE_addRecord( rose_t* ROSE, const uint8_t* data, uint16_t nbytes )
         }
     }
     p[0] = REC_TAG + ( rj - j );
+    if( p == rec )
+    {
+        fillFifo( ROSE, ROSE->fill, rec, n );
+    }
     ROSE->fill += n;
     return ROSE_OK;
 }
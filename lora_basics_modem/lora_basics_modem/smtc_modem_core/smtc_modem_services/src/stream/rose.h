@@ -45,16 +45,22 @@
 #define ROSE_DEFAULT_RR 110       // default redundancy rate (110%)
 #define ROSE_DEFAULT_PCTXINTV 8   // include protocol context in every N+1st frame
 
-#ifndef ROSE_FIFO_SIZE
+// Circular buffer holding the window and the data to send, must be a power of two
+#ifndef ROSE_RING_SIZE
 #if defined( CFG_simul )
-#define ROSE_FIFO_SIZE 10240  // bigger - for performance analysis
+#define ROSE_RING_SIZE 8192  // bigger - for performance analysis
 #else
-#define ROSE_FIFO_SIZE                         \
-    ( ROSE_DEFAULT_WL + ROSE_DEFAULT_MINFREE + \
-      ROSE_DEFAULT_WL / 8 )  // big enough for wl=512 minfree=512 + rvec for wl=512
+#define ROSE_RING_SIZE ( ROSE_DEFAULT_WL + ROSE_DEFAULT_MINFREE )  // big enough for wl=512 minfree=512
 #endif
 #endif
 
+#if( ROSE_RING_SIZE & ( ROSE_RING_SIZE - 1 ) ) != 0
+#error "ROSE_RING_SIZE must be a power of two"
+#endif
+
+#define ROSE_RVEC_SIZE ( ROSE_DEFAULT_WL / 8 )  // rvec for wl=512
+#define ROSE_FIFO_SIZE ( ROSE_RING_SIZE + ROSE_RVEC_SIZE )
+
 /*!
  *  \brief ROSE Status codes
  */
@@ -102,6 +108,7 @@ typedef struct rose_s
     uint16_t wl;        // window length
     uint16_t unsent;    // start of unsent systematic data
     uint16_t fill;      // start of free buffer space
+    uint16_t head;      // position in the ring of the first octet of the window
     uint8_t  unitsz;
     uint8_t  fifo[ROSE_FIFO_SIZE];
 } rose_t;
@@ -0,0 +1,860 @@
+/**
+ * @file      ral_sim.c
+ *
+ * @brief     Radio abstraction layer implementation for the simulated (host) radio
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "ral_sim.h"
+#include "ral_sim_bsp.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+// Simple consumption model: a fixed part plus a part proportional to the positive output power
+#define RAL_SIM_TX_CONSUMPTION_BASE_UA 15000
+#define RAL_SIM_TX_CONSUMPTION_UA_PER_DBM 4000
+
+#define RAL_SIM_GFSK_RX_CONSUMPTION 5400
+#define RAL_SIM_GFSK_RX_BOOSTED_CONSUMPTION 7500
+
+#define RAL_SIM_LORA_RX_CONSUMPTION 5700
+#define RAL_SIM_LORA_RX_BOOSTED_CONSUMPTION 7800
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Get the bandwidth in Hz of a LoRa bandwidth
+ *
+ * @param [in] bw LoRa bandwidth
+ *
+ * @returns Bandwidth in Hz
+ */
+static uint32_t ral_sim_get_lora_bw_in_hz( const ral_lora_bw_t bw );
+
+/**
+ * @brief Get the LoRa symbol duration
+ *
+ * @param [in] mod_p LoRa modulation parameters
+ *
+ * @returns Symbol duration in microseconds
+ */
+static uint32_t ral_sim_get_lora_symbol_time_in_us( const ral_lora_mod_params_t* mod_p );
+
+/**
+ * @brief Start a radio operation ending with an interrupt after a given duration
+ *
+ * @param [in] ctx          Simulated radio context
+ * @param [in] mode         Radio mode during the operation
+ * @param [in] duration_us  Operation duration in microseconds
+ * @param [in] irq          Interrupt raised at the end of the operation
+ */
+static void ral_sim_start_operation( ral_sim_context_t* ctx, const ral_sim_mode_t mode, const uint32_t duration_us,
+                                     const ral_irq_t irq );
+
+/**
+ * @brief Stop the running radio operation, if any
+ *
+ * @param [in] ctx   Simulated radio context
+ * @param [in] mode  Radio mode after the operation
+ */
+static void ral_sim_stop_operation( ral_sim_context_t* ctx, const ral_sim_mode_t mode );
+
+/**
+ * @brief Start the reception of the queued packet
+ *
+ * @param [in] ctx Simulated radio context
+ */
+static void ral_sim_start_rx_packet( ral_sim_context_t* ctx );
+
+/**
+ * @brief Get the time-on-air of the current Tx configuration
+ *
+ * @param [in] ctx Simulated radio context
+ * @param [in] payload_length Payload length in bytes
+ *
+ * @returns Time-on-air in microseconds
+ */
+static uint32_t ral_sim_get_current_time_on_air_in_us( const ral_sim_context_t* ctx, const uint16_t payload_length );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+void ral_sim_set_rx_packet( ral_sim_context_t* context, const uint8_t* buffer, const uint16_t size,
+                            const int16_t rssi_in_dbm, const int16_t snr_in_db, const bool crc_error )
+{
+    context->rx_size = ( size < RAL_SIM_BUFFER_SIZE ) ? size : RAL_SIM_BUFFER_SIZE;
+    memcpy( context->rx_buffer, buffer, context->rx_size );
+
+    context->lora_rx_pkt_status.rssi_pkt_in_dbm        = rssi_in_dbm;
+    context->lora_rx_pkt_status.snr_pkt_in_db          = snr_in_db;
+    context->lora_rx_pkt_status.signal_rssi_pkt_in_dbm = rssi_in_dbm;
+    context->gfsk_rx_pkt_status.rx_status =
+        ( crc_error == true ) ? RAL_RX_STATUS_CRC_ERROR : RAL_RX_STATUS_PKT_RECEIVED;
+    context->gfsk_rx_pkt_status.rssi_sync_in_dbm = rssi_in_dbm;
+    context->gfsk_rx_pkt_status.rssi_avg_in_dbm  = rssi_in_dbm;
+
+    context->rx_packet_crc_error    = crc_error;
+    context->rx_packet_is_available = true;
+
+    // A packet arriving while the radio is listening is received right away
+    if( context->mode == RAL_SIM_MODE_RX )
+    {
+        ral_sim_start_rx_packet( context );
+    }
+}
+
+void ral_sim_start_scan( ral_sim_context_t* context, const uint32_t duration_in_ms, const ral_irq_t irq )
+{
+    context->irq_mask |= irq;
+    ral_sim_start_operation( context, RAL_SIM_MODE_SCAN, duration_in_ms * 1000, irq );
+}
+
+bool ral_sim_process_irq( const void* context )
+{
+    ral_sim_context_t* ctx    = ( ral_sim_context_t* ) context;
+    ral_irq_t          raised = ctx->irq_pending;
+
+    ctx->irq_pending = RAL_IRQ_NONE;
+    ctx->irq_status |= raised;
+
+    if( ctx->mode == RAL_SIM_MODE_CAD )
+    {
+        bool is_busy = ( ( raised & RAL_IRQ_CAD_OK ) == RAL_IRQ_CAD_OK );
+
+        if( ( ctx->lora_cad_params.cad_exit_mode == RAL_LORA_CAD_RX ) && ( is_busy == true ) )
+        {
+            ctx->mode = RAL_SIM_MODE_STANDBY;
+            ral_sim_set_rx( context, ctx->lora_cad_params.cad_timeout_in_ms );
+        }
+        else if( ( ctx->lora_cad_params.cad_exit_mode == RAL_LORA_CAD_LBT ) && ( is_busy == false ) )
+        {
+            ctx->mode = RAL_SIM_MODE_STANDBY;
+            ral_sim_set_tx( context );
+        }
+        else
+        {
+            ctx->mode = RAL_SIM_MODE_STANDBY;
+        }
+    }
+    else
+    {
+        ctx->mode = RAL_SIM_MODE_STANDBY;
+    }
+
+    return ( ( raised & ctx->irq_mask ) != 0 );
+}
+
+uint32_t ral_sim_get_lora_time_on_air_in_us( const ral_lora_pkt_params_t* pkt_p, const ral_lora_mod_params_t* mod_p )
+{
+    const int32_t sf      = ( int32_t ) mod_p->sf;
+    const int32_t de      = ( mod_p->ldro != 0 ) ? 1 : 0;
+    const int32_t ih      = ( pkt_p->header_type == RAL_LORA_PKT_IMPLICIT ) ? 1 : 0;
+    const int32_t crc     = ( pkt_p->crc_is_on == true ) ? 1 : 0;
+    int32_t       cr_base = 5;
+
+    switch( mod_p->cr )
+    {
+    case RAL_LORA_CR_4_5:
+    case RAL_LORA_CR_LI_4_5:
+        cr_base = 5;
+        break;
+    case RAL_LORA_CR_4_6:
+    case RAL_LORA_CR_LI_4_6:
+        cr_base = 6;
+        break;
+    case RAL_LORA_CR_4_7:
+        cr_base = 7;
+        break;
+    case RAL_LORA_CR_4_8:
+    case RAL_LORA_CR_LI_4_8:
+        cr_base = 8;
+        break;
+    default:
+        break;
+    }
+
+    // Number of payload symbols from the LoRa modem datasheet formula
+    int32_t num = ( 8 * ( int32_t ) pkt_p->pld_len_in_bytes ) - ( 4 * sf ) + 28 + ( 16 * crc ) - ( 20 * ih );
+    int32_t den = 4 * ( sf - ( 2 * de ) );
+    int32_t nb_symb_payload = 8;
+    if( ( num > 0 ) && ( den > 0 ) )
+    {
+        nb_symb_payload += ( ( num + den - 1 ) / den ) * cr_base;
+    }
+
+    // Preamble lasts ( n_preamble + 4.25 ) symbols: count quarters of symbols to stay in integer arithmetic
+    uint64_t nb_quarter_symb =
+        ( 4 * ( uint64_t ) pkt_p->preamble_len_in_symb ) + 17 + ( 4 * ( uint64_t ) nb_symb_payload );
+    uint64_t bw_in_hz        = ral_sim_get_lora_bw_in_hz( mod_p->bw );
+
+    if( bw_in_hz == 0 )
+    {
+        return 0;
+    }
+    return ( uint32_t ) ( ( nb_quarter_symb * ( ( uint64_t ) 1 << sf ) * 1000000 + ( 4 * bw_in_hz ) - 1 ) /
+                          ( 4 * bw_in_hz ) );
+}
+
+uint32_t ral_sim_get_gfsk_time_on_air_in_us( const ral_gfsk_pkt_params_t* pkt_p, const ral_gfsk_mod_params_t* mod_p )
+{
+    uint32_t nb_bits = pkt_p->preamble_len_in_bits + pkt_p->sync_word_len_in_bits;
+
+    if( pkt_p->header_type == RAL_GFSK_PKT_VAR_LEN )
+    {
+        nb_bits += 8;
+    }
+    if( pkt_p->address_filtering != RAL_GFSK_ADDRESS_FILTERING_DISABLE )
+    {
+        nb_bits += 8;
+    }
+    nb_bits += 8 * ( uint32_t ) pkt_p->pld_len_in_bytes;
+
+    switch( pkt_p->crc_type )
+    {
+    case RAL_GFSK_CRC_1_BYTE:
+    case RAL_GFSK_CRC_1_BYTE_INV:
+        nb_bits += 8;
+        break;
+    case RAL_GFSK_CRC_2_BYTES:
+    case RAL_GFSK_CRC_2_BYTES_INV:
+        nb_bits += 16;
+        break;
+    case RAL_GFSK_CRC_3_BYTES:
+        nb_bits += 24;
+        break;
+    default:
+        break;
+    }
+
+    if( mod_p->br_in_bps == 0 )
+    {
+        return 0;
+    }
+    return ( uint32_t ) ( ( ( uint64_t ) nb_bits * 1000000 + mod_p->br_in_bps - 1 ) / mod_p->br_in_bps );
+}
+
+bool ral_sim_handles_part( const char* part_number )
+{
+    return ( strcmp( "sim", part_number ) == 0 );
+}
+
+ral_status_t ral_sim_reset( const void* context )
+{
+    ral_sim_context_t* ctx = ( ral_sim_context_t* ) context;
+
+    ral_sim_stop_operation( ctx, RAL_SIM_MODE_STANDBY );
+    ctx->irq_status             = RAL_IRQ_NONE;
+    ctx->irq_mask               = RAL_IRQ_NONE;
+    ctx->rx_packet_is_available = false;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_init( const void* context )
+{
+    ral_sim_context_t* ctx = ( ral_sim_context_t* ) context;
+
+    if( ctx->random_seed == 0 )
+    {
+        ctx->random_seed = 1;
+    }
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_wakeup( const void* context )
+{
+    ral_sim_context_t* ctx = ( ral_sim_context_t* ) context;
+
+    if( ctx->mode == RAL_SIM_MODE_SLEEP )
+    {
+        ctx->mode = RAL_SIM_MODE_STANDBY;
+    }
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_sleep( const void* context, const bool retain_config )
+{
+    ral_sim_stop_operation( ( ral_sim_context_t* ) context, RAL_SIM_MODE_SLEEP );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_standby( const void* context, ral_standby_cfg_t standby_cfg )
+{
+    ral_sim_stop_operation( ( ral_sim_context_t* ) context, RAL_SIM_MODE_STANDBY );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_fs( const void* context )
+{
+    ral_sim_stop_operation( ( ral_sim_context_t* ) context, RAL_SIM_MODE_FS );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_tx( const void* context )
+{
+    ral_sim_context_t* ctx         = ( ral_sim_context_t* ) context;
+    uint32_t           toa_in_us   = ral_sim_get_current_time_on_air_in_us( ctx, ctx->tx_size );
+    ral_irq_t          irq_to_send = RAL_IRQ_TX_DONE;
+
+    if( ctx->tx_callback != NULL )
+    {
+        ctx->tx_callback( ctx, ctx->tx_buffer, ctx->tx_size, toa_in_us );
+    }
+    ral_sim_start_operation( ctx, RAL_SIM_MODE_TX, toa_in_us, irq_to_send );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_rx( const void* context, const uint32_t timeout_in_ms )
+{
+    ral_sim_context_t* ctx        = ( ral_sim_context_t* ) context;
+    uint32_t           timeout_us = 0;
+
+    if( ctx->rx_packet_is_available == true )
+    {
+        ctx->mode = RAL_SIM_MODE_RX;
+        ral_sim_start_rx_packet( ctx );
+        return RAL_STATUS_OK;
+    }
+
+    // The symbol timeout stops the reception if no preamble is detected, the timeout stops it in any case
+    if( ( ctx->pkt_type == RAL_PKT_TYPE_LORA ) && ( ctx->lora_symb_nb_timeout != 0 ) )
+    {
+        timeout_us = ctx->lora_symb_nb_timeout * ral_sim_get_lora_symbol_time_in_us( &ctx->lora_mod_params );
+    }
+    if( ( timeout_in_ms != 0 ) && ( timeout_in_ms != RAL_RX_TIMEOUT_CONTINUOUS_MODE ) )
+    {
+        if( ( timeout_us == 0 ) || ( ( timeout_in_ms * 1000 ) < timeout_us ) )
+        {
+            timeout_us = timeout_in_ms * 1000;
+        }
+    }
+
+    if( timeout_us == 0 )
+    {
+        // Continuous reception, only a queued packet ends it
+        ral_sim_stop_operation( ctx, RAL_SIM_MODE_RX );
+    }
+    else
+    {
+        ral_sim_start_operation( ctx, RAL_SIM_MODE_RX, timeout_us, RAL_IRQ_RX_TIMEOUT );
+    }
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_cfg_rx_boosted( const void* context, const bool enable_boost_mode )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_rx_tx_fallback_mode( const void* context, const ral_fallback_modes_t ral_fallback_mode )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_stop_timer_on_preamble( const void* context, const bool enable )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_rx_duty_cycle( const void* context, const uint32_t rx_time_in_ms,
+                                        const uint32_t sleep_time_in_ms )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_set_lora_cad( const void* context )
+{
+    ral_sim_context_t* ctx     = ( ral_sim_context_t* ) context;
+    uint32_t           nb_symb = ( uint32_t ) 1 << ctx->lora_cad_params.cad_symb_nb;
+    ral_irq_t          irq     = RAL_IRQ_CAD_DONE;
+
+    if( ctx->cad_channel_busy == true )
+    {
+        irq |= RAL_IRQ_CAD_OK;
+    }
+    // Add half a symbol for the CAD processing
+    ral_sim_start_operation( ctx, RAL_SIM_MODE_CAD,
+                             ( ( 2 * nb_symb ) + 1 ) * ral_sim_get_lora_symbol_time_in_us( &ctx->lora_mod_params ) / 2,
+                             irq );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_tx_cw( const void* context )
+{
+    ral_sim_stop_operation( ( ral_sim_context_t* ) context, RAL_SIM_MODE_TX );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_tx_infinite_preamble( const void* context )
+{
+    ral_sim_stop_operation( ( ral_sim_context_t* ) context, RAL_SIM_MODE_TX );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_cal_img( const void* context, const uint16_t freq1_in_mhz, const uint16_t freq2_in_mhz )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_tx_cfg( const void* context, const int8_t output_pwr_in_dbm, const uint32_t rf_freq_in_hz )
+{
+    ral_sim_context_t* ctx = ( ral_sim_context_t* ) context;
+
+    ctx->output_pwr_in_dbm = output_pwr_in_dbm;
+    ctx->rf_freq_in_hz     = rf_freq_in_hz;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_pkt_payload( const void* context, const uint8_t* buffer, const uint16_t size )
+{
+    ral_sim_context_t* ctx = ( ral_sim_context_t* ) context;
+
+    if( size > RAL_SIM_BUFFER_SIZE )
+    {
+        return RAL_STATUS_ERROR;
+    }
+    memcpy( ctx->tx_buffer, buffer, size );
+    ctx->tx_size = size;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_pkt_payload( const void* context, uint16_t max_size_in_bytes, uint8_t* buffer,
+                                      uint16_t* size_in_bytes )
+{
+    ral_sim_context_t* ctx = ( ral_sim_context_t* ) context;
+
+    if( size_in_bytes != NULL )
+    {
+        *size_in_bytes = ctx->rx_size;
+    }
+    if( ctx->rx_size > max_size_in_bytes )
+    {
+        return RAL_STATUS_ERROR;
+    }
+    memcpy( buffer, ctx->rx_buffer, ctx->rx_size );
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_irq_status( const void* context, ral_irq_t* irq )
+{
+    *irq = ( ( const ral_sim_context_t* ) context )->irq_status;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_clear_irq_status( const void* context, const ral_irq_t irq )
+{
+    ( ( ral_sim_context_t* ) context )->irq_status &= ~irq;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_and_clear_irq_status( const void* context, ral_irq_t* irq )
+{
+    ral_sim_context_t* ctx = ( ral_sim_context_t* ) context;
+
+    if( irq != NULL )
+    {
+        *irq = ctx->irq_status;
+    }
+    ctx->irq_status = RAL_IRQ_NONE;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_dio_irq_params( const void* context, const ral_irq_t irq )
+{
+    ( ( ral_sim_context_t* ) context )->irq_mask = irq;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_rf_freq( const void* context, const uint32_t freq_in_hz )
+{
+    ( ( ral_sim_context_t* ) context )->rf_freq_in_hz = freq_in_hz;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_pkt_type( const void* context, const ral_pkt_type_t pkt_type )
+{
+    if( pkt_type == RAL_PKT_TYPE_FLRC )
+    {
+        return RAL_STATUS_UNSUPPORTED_FEATURE;
+    }
+    ( ( ral_sim_context_t* ) context )->pkt_type = pkt_type;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_pkt_type( const void* context, ral_pkt_type_t* pkt_type )
+{
+    *pkt_type = ( ( const ral_sim_context_t* ) context )->pkt_type;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_gfsk_mod_params( const void* context, const ral_gfsk_mod_params_t* params )
+{
+    ( ( ral_sim_context_t* ) context )->gfsk_mod_params = *params;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_gfsk_pkt_params( const void* context, const ral_gfsk_pkt_params_t* params )
+{
+    ( ( ral_sim_context_t* ) context )->gfsk_pkt_params = *params;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_lora_mod_params( const void* context, const ral_lora_mod_params_t* params )
+{
+    ( ( ral_sim_context_t* ) context )->lora_mod_params = *params;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_lora_pkt_params( const void* context, const ral_lora_pkt_params_t* params )
+{
+    ( ( ral_sim_context_t* ) context )->lora_pkt_params = *params;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_lora_cad_params( const void* context, const ral_lora_cad_params_t* params )
+{
+    ( ( ral_sim_context_t* ) context )->lora_cad_params = *params;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_lora_symb_nb_timeout( const void* context, const uint8_t nb_of_symbs )
+{
+    ( ( ral_sim_context_t* ) context )->lora_symb_nb_timeout = nb_of_symbs;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_flrc_mod_params( const void* context, const ral_flrc_mod_params_t* params )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_set_flrc_pkt_params( const void* context, const ral_flrc_pkt_params_t* params )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_get_gfsk_rx_pkt_status( const void* context, ral_gfsk_rx_pkt_status_t* rx_pkt_status )
+{
+    *rx_pkt_status = ( ( const ral_sim_context_t* ) context )->gfsk_rx_pkt_status;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_lora_rx_pkt_status( const void* context, ral_lora_rx_pkt_status_t* rx_pkt_status )
+{
+    *rx_pkt_status = ( ( const ral_sim_context_t* ) context )->lora_rx_pkt_status;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_flrc_rx_pkt_status( const void* context, ral_flrc_rx_pkt_status_t* rx_pkt_status )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_get_rssi_inst( const void* context, int16_t* rssi_in_dbm )
+{
+    *rssi_in_dbm = ( ( const ral_sim_context_t* ) context )->rssi_inst_in_dbm;
+    return RAL_STATUS_OK;
+}
+
+uint32_t ral_sim_get_lora_time_on_air_in_ms( const ral_lora_pkt_params_t* pkt_p, const ral_lora_mod_params_t* mod_p )
+{
+    return ( ral_sim_get_lora_time_on_air_in_us( pkt_p, mod_p ) + 999 ) / 1000;
+}
+
+uint32_t ral_sim_get_gfsk_time_on_air_in_ms( const ral_gfsk_pkt_params_t* pkt_p, const ral_gfsk_mod_params_t* mod_p )
+{
+    return ( ral_sim_get_gfsk_time_on_air_in_us( pkt_p, mod_p ) + 999 ) / 1000;
+}
+
+uint32_t ral_sim_get_flrc_time_on_air_in_ms( const ral_flrc_pkt_params_t* pkt_p, const ral_flrc_mod_params_t* mod_p )
+{
+    return 0;
+}
+
+ral_status_t ral_sim_set_gfsk_sync_word( const void* context, const uint8_t* sync_word, const uint8_t sync_word_len )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_lora_sync_word( const void* context, const uint8_t sync_word )
+{
+    ( ( ral_sim_context_t* ) context )->lora_sync_word = sync_word;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_flrc_sync_word( const void* context, const uint8_t* sync_word, const uint8_t sync_word_len )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_set_gfsk_crc_params( const void* context, const uint16_t seed, const uint16_t polynomial )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_set_flrc_crc_params( const void* context, const uint32_t seed )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_set_gfsk_whitening_seed( const void* context, const uint16_t seed )
+{
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_lr_fhss_init( const void* context, const ral_lr_fhss_params_t* lr_fhss_params )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_lr_fhss_build_frame( const void* context, const ral_lr_fhss_params_t* lr_fhss_params,
+                                          ral_lr_fhss_memory_state_t state, uint16_t hop_sequence_id,
+                                          const uint8_t* payload, uint16_t payload_length )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_lr_fhss_handle_hop( const void* context, const ral_lr_fhss_params_t* lr_fhss_params,
+                                         ral_lr_fhss_memory_state_t state )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_lr_fhss_handle_tx_done( const void* context, const ral_lr_fhss_params_t* lr_fhss_params,
+                                             ral_lr_fhss_memory_state_t state )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_lr_fhss_get_time_on_air_in_ms( const void* context, const ral_lr_fhss_params_t* lr_fhss_params,
+                                                    uint16_t payload_length, uint32_t* time_on_air )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_lr_fhss_get_hop_sequence_count( const void* context, const ral_lr_fhss_params_t* lr_fhss_params )
+{
+    return RAL_STATUS_UNSUPPORTED_FEATURE;
+}
+
+ral_status_t ral_sim_get_lora_rx_pkt_cr_crc( const void* context, ral_lora_cr_t* cr, bool* is_crc_present )
+{
+    const ral_sim_context_t* ctx = ( const ral_sim_context_t* ) context;
+
+    *cr             = ctx->lora_mod_params.cr;
+    *is_crc_present = ctx->lora_pkt_params.crc_is_on;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_tx_consumption_in_ua( const void* context, const int8_t output_pwr_in_dbm,
+                                               const uint32_t rf_freq_in_hz, uint32_t* pwr_consumption_in_ua )
+{
+    *pwr_consumption_in_ua = RAL_SIM_TX_CONSUMPTION_BASE_UA;
+    if( output_pwr_in_dbm > 0 )
+    {
+        *pwr_consumption_in_ua += ( uint32_t ) output_pwr_in_dbm * RAL_SIM_TX_CONSUMPTION_UA_PER_DBM;
+    }
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_gfsk_rx_consumption_in_ua( const void* context, const uint32_t br_in_bps,
+                                                    const uint32_t bw_dsb_in_hz, const bool rx_boosted,
+                                                    uint32_t* pwr_consumption_in_ua )
+{
+    *pwr_consumption_in_ua =
+        ( rx_boosted == true ) ? RAL_SIM_GFSK_RX_BOOSTED_CONSUMPTION : RAL_SIM_GFSK_RX_CONSUMPTION;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_lora_rx_consumption_in_ua( const void* context, const ral_lora_bw_t bw,
+                                                    const bool rx_boosted, uint32_t* pwr_consumption_in_ua )
+{
+    *pwr_consumption_in_ua =
+        ( rx_boosted == true ) ? RAL_SIM_LORA_RX_BOOSTED_CONSUMPTION : RAL_SIM_LORA_RX_CONSUMPTION;
+    return RAL_STATUS_OK;
+}
+
+ral_status_t ral_sim_get_random_numbers( const void* context, uint32_t* numbers, unsigned int n )
+{
+    ral_sim_context_t* ctx = ( ral_sim_context_t* ) context;
+
+    if( ctx->random_seed == 0 )
+    {
+        ctx->random_seed = 1;
+    }
+    for( unsigned int i = 0; i < n; i++ )
+    {
+        // xorshift32: deterministic for a given seed so that simulations can be replayed
+        ctx->random_seed ^= ctx->random_seed << 13;
+        ctx->random_seed ^= ctx->random_seed >> 17;
+        ctx->random_seed ^= ctx->random_seed << 5;
+        numbers[i] = ctx->random_seed;
+    }
+    return RAL_STATUS_OK;
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint32_t ral_sim_get_lora_bw_in_hz( const ral_lora_bw_t bw )
+{
+    switch( bw )
+    {
+    case RAL_LORA_BW_007_KHZ:
+        return 7812;
+    case RAL_LORA_BW_010_KHZ:
+        return 10417;
+    case RAL_LORA_BW_015_KHZ:
+        return 15625;
+    case RAL_LORA_BW_020_KHZ:
+        return 20833;
+    case RAL_LORA_BW_031_KHZ:
+        return 31250;
+    case RAL_LORA_BW_041_KHZ:
+        return 41667;
+    case RAL_LORA_BW_062_KHZ:
+        return 62500;
+    case RAL_LORA_BW_125_KHZ:
+        return 125000;
+    case RAL_LORA_BW_200_KHZ:
+        return 203125;
+    case RAL_LORA_BW_250_KHZ:
+        return 250000;
+    case RAL_LORA_BW_400_KHZ:
+        return 406250;
+    case RAL_LORA_BW_500_KHZ:
+        return 500000;
+    case RAL_LORA_BW_800_KHZ:
+        return 812500;
+    case RAL_LORA_BW_1600_KHZ:
+        return 1625000;
+    default:
+        return 0;
+    }
+}
+
+static uint32_t ral_sim_get_lora_symbol_time_in_us( const ral_lora_mod_params_t* mod_p )
+{
+    uint32_t bw_in_hz = ral_sim_get_lora_bw_in_hz( mod_p->bw );
+
+    if( bw_in_hz == 0 )
+    {
+        return 0;
+    }
+    return ( uint32_t ) ( ( ( ( uint64_t ) 1 << mod_p->sf ) * 1000000 ) / bw_in_hz );
+}
+
+static void ral_sim_start_operation( ral_sim_context_t* ctx, const ral_sim_mode_t mode, const uint32_t duration_us,
+                                     const ral_irq_t irq )
+{
+    ctx->mode                     = mode;
+    ctx->irq_pending              = irq;
+    ctx->operation_duration_in_us = duration_us;
+    ral_sim_bsp_schedule_irq( ctx, duration_us );
+}
+
+static void ral_sim_stop_operation( ral_sim_context_t* ctx, const ral_sim_mode_t mode )
+{
+    if( ctx->irq_pending != RAL_IRQ_NONE )
+    {
+        ral_sim_bsp_cancel_irq( ctx );
+        ctx->irq_pending = RAL_IRQ_NONE;
+    }
+    ctx->mode                     = mode;
+    ctx->operation_duration_in_us = 0;
+}
+
+static void ral_sim_start_rx_packet( ral_sim_context_t* ctx )
+{
+    ral_irq_t irq = RAL_IRQ_RX_DONE;
+
+    if( ctx->rx_packet_crc_error == true )
+    {
+        irq |= RAL_IRQ_RX_CRC_ERROR;
+    }
+    else if( ctx->pkt_type == RAL_PKT_TYPE_LORA )
+    {
+        irq |= RAL_IRQ_RX_HDR_OK;
+    }
+    ctx->rx_packet_is_available = false;
+    ral_sim_start_operation( ctx, RAL_SIM_MODE_RX, ral_sim_get_current_time_on_air_in_us( ctx, ctx->rx_size ), irq );
+}
+
+static uint32_t ral_sim_get_current_time_on_air_in_us( const ral_sim_context_t* ctx, const uint16_t payload_length )
+{
+    if( ctx->pkt_type == RAL_PKT_TYPE_LORA )
+    {
+        ral_lora_pkt_params_t pkt_params = ctx->lora_pkt_params;
+
+        pkt_params.pld_len_in_bytes = ( uint8_t ) payload_length;
+        return ral_sim_get_lora_time_on_air_in_us( &pkt_params, &ctx->lora_mod_params );
+    }
+    else
+    {
+        ral_gfsk_pkt_params_t pkt_params = ctx->gfsk_pkt_params;
+
+        pkt_params.pld_len_in_bytes = ( uint8_t ) payload_length;
+        return ral_sim_get_gfsk_time_on_air_in_us( &pkt_params, &ctx->gfsk_mod_params );
+    }
+}
+
+/* --- EOF ------------------------------------------------------------------ */
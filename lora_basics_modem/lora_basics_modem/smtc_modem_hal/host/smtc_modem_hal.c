@@ -0,0 +1,699 @@
+/**
+ * @file      smtc_modem_hal.c
+ *
+ * @brief     Modem Hardware Abstraction Layer implementation for host simulation
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "smtc_modem_hal.h"
+#include "smtc_modem_hal_sim.h"
+#include "smtc_modem_hal_dbg_trace.h"
+#include "ral_sim.h"
+#include "ral_sim_bsp.h"
+
+// for variadic args
+#include <stdio.h>
+#include <stdarg.h>
+
+// for abort
+#include <stdlib.h>
+
+// for memcpy
+#include <string.h>
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE MACROS-----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE CONSTANTS -------------------------------------------------------
+ */
+
+#define SIM_BATTERY_LEVEL 254
+#define SIM_TEMPERATURE 25
+#define SIM_VOLTAGE 165  // 3.3V with the 1/50 step of smtc_modem_hal_get_voltage
+#define SIM_BOARD_DELAY_MS 1
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE TYPES -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE VARIABLES -------------------------------------------------------
+ */
+
+static uint64_t                   sim_time_in_us;
+static smtc_modem_hal_sim_node_t  sim_default_node;
+static smtc_modem_hal_sim_node_t* sim_nodes = &sim_default_node;
+static smtc_modem_hal_sim_node_t* sim_node  = &sim_default_node;
+static void ( *sim_select_callback )( smtc_modem_hal_sim_node_t* node );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
+ */
+
+/**
+ * @brief Get the current time of the selected node and charge the cost of the read
+ *
+ * @returns Virtual time in microseconds
+ */
+static uint64_t sim_read_time_in_us( void );
+
+/**
+ * @brief Reset the state of a node
+ *
+ * @param [in] node Node to reset
+ * @param [in] seed Seed of the random number generator
+ */
+static void sim_reset_node( smtc_modem_hal_sim_node_t* node, const uint32_t seed );
+
+/**
+ * @brief Get the earliest armed event of a node
+ *
+ * @param [in] node Node
+ *
+ * @returns Pointer to the event, NULL if none is armed
+ */
+static smtc_modem_hal_sim_event_t* sim_get_next_event( smtc_modem_hal_sim_node_t* node );
+
+/**
+ * @brief Run the handler of an event of the selected node
+ *
+ * @param [in] event Event to process
+ */
+static void sim_process_event( smtc_modem_hal_sim_event_t* event );
+
+/**
+ * @brief Get a 32-bit pseudo random number from the generator of the selected node
+ *
+ * @returns Random number
+ */
+static uint32_t sim_rand( void );
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
+ */
+
+/* ------------ Simulation control ------------*/
+
+void smtc_modem_hal_sim_init( const uint32_t seed )
+{
+    sim_time_in_us = 0;
+    sim_reset_node( &sim_default_node, seed );
+    sim_default_node.next = NULL;
+    sim_nodes             = &sim_default_node;
+    sim_node              = &sim_default_node;
+}
+
+void smtc_modem_hal_sim_node_init( smtc_modem_hal_sim_node_t* node, const uint32_t seed )
+{
+    sim_reset_node( node, seed );
+    node->next = sim_nodes;
+    sim_nodes  = node;
+}
+
+void smtc_modem_hal_sim_select_node( smtc_modem_hal_sim_node_t* node )
+{
+    if( node->time_in_us < sim_time_in_us )
+    {
+        node->time_in_us = sim_time_in_us;
+    }
+    sim_node = node;
+    if( sim_select_callback != NULL )
+    {
+        sim_select_callback( node );
+    }
+}
+
+smtc_modem_hal_sim_node_t* smtc_modem_hal_sim_get_selected_node( void )
+{
+    return sim_node;
+}
+
+void smtc_modem_hal_sim_set_select_callback( void ( *callback )( smtc_modem_hal_sim_node_t* node ) )
+{
+    sim_select_callback = callback;
+}
+
+smtc_modem_hal_sim_node_t* smtc_modem_hal_sim_run_next_event( const uint64_t end_time_in_us )
+{
+    smtc_modem_hal_sim_node_t*  next_node  = NULL;
+    smtc_modem_hal_sim_event_t* next_event = NULL;
+
+    for( smtc_modem_hal_sim_node_t* node = sim_nodes; node != NULL; node = node->next )
+    {
+        smtc_modem_hal_sim_event_t* event = sim_get_next_event( node );
+
+        if( ( event != NULL ) && ( ( next_event == NULL ) || ( event->deadline_in_us < next_event->deadline_in_us ) ) )
+        {
+            next_node  = node;
+            next_event = event;
+        }
+    }
+
+    if( ( next_event == NULL ) || ( next_event->deadline_in_us > end_time_in_us ) )
+    {
+        if( sim_time_in_us < end_time_in_us )
+        {
+            sim_time_in_us = end_time_in_us;
+        }
+        return NULL;
+    }
+
+    if( sim_time_in_us < next_event->deadline_in_us )
+    {
+        sim_time_in_us = next_event->deadline_in_us;
+    }
+    if( next_node->time_in_us < sim_time_in_us )
+    {
+        // The node was sleeping until this event
+        next_node->stats.sleep_time_in_us += sim_time_in_us - next_node->time_in_us;
+        next_node->stats.nb_wakeups++;
+    }
+    smtc_modem_hal_sim_select_node( next_node );
+    smtc_modem_hal_sim_process_events( );
+    return next_node;
+}
+
+uint64_t smtc_modem_hal_sim_get_time_in_us( void )
+{
+    return sim_node->time_in_us;
+}
+
+void smtc_modem_hal_sim_advance_time_in_us( const uint32_t delay_in_us )
+{
+    sim_node->time_in_us += delay_in_us;
+    sim_node->stats.awake_time_in_us += delay_in_us;
+}
+
+bool smtc_modem_hal_sim_sleep_in_ms( const uint32_t sleep_time_in_ms )
+{
+    if( smtc_modem_hal_sim_process_events( ) == true )
+    {
+        return true;
+    }
+
+    uint64_t                    wakeup_time_in_us = sim_node->time_in_us + ( ( uint64_t ) sleep_time_in_ms * 1000 );
+    smtc_modem_hal_sim_event_t* event             = sim_get_next_event( sim_node );
+    bool                        is_woken_up       = false;
+
+    if( ( event != NULL ) && ( event->deadline_in_us <= wakeup_time_in_us ) )
+    {
+        wakeup_time_in_us = event->deadline_in_us;
+        is_woken_up       = true;
+        sim_node->stats.nb_wakeups++;
+    }
+
+    if( wakeup_time_in_us > sim_node->time_in_us )
+    {
+        sim_node->stats.sleep_time_in_us += wakeup_time_in_us - sim_node->time_in_us;
+        sim_node->time_in_us = wakeup_time_in_us;
+    }
+    if( sim_time_in_us < sim_node->time_in_us )
+    {
+        sim_time_in_us = sim_node->time_in_us;
+    }
+
+    if( is_woken_up == true )
+    {
+        smtc_modem_hal_sim_process_events( );
+    }
+    return is_woken_up;
+}
+
+bool smtc_modem_hal_sim_process_events( void )
+{
+    bool                        processed = false;
+    smtc_modem_hal_sim_event_t* event     = sim_get_next_event( sim_node );
+
+    // Interrupts are only served when the modem allows it, as on target
+    while( ( sim_node->modem_irq_enabled == true ) && ( event != NULL ) &&
+           ( event->deadline_in_us <= sim_node->time_in_us ) )
+    {
+        sim_process_event( event );
+        processed = true;
+        event     = sim_get_next_event( sim_node );
+    }
+    return processed;
+}
+
+bool smtc_modem_hal_sim_get_next_event_delay_in_us( uint64_t* delay_in_us )
+{
+    smtc_modem_hal_sim_event_t* event = sim_get_next_event( sim_node );
+
+    if( event == NULL )
+    {
+        return false;
+    }
+    *delay_in_us =
+        ( event->deadline_in_us > sim_node->time_in_us ) ? ( event->deadline_in_us - sim_node->time_in_us ) : 0;
+    return true;
+}
+
+void smtc_modem_hal_sim_set_time_read_cost_in_us( const uint32_t cost_in_us )
+{
+    sim_node->time_read_cost_in_us = cost_in_us;
+}
+
+void smtc_modem_hal_sim_set_tcxo_startup_delay_ms( const uint32_t delay_in_ms )
+{
+    sim_node->tcxo_startup_delay_ms = delay_in_ms;
+}
+
+void smtc_modem_hal_sim_set_reset_callback( void ( *callback )( void ) )
+{
+    sim_node->reset_callback = callback;
+}
+
+void smtc_modem_hal_sim_set_trace_enabled( const bool enable )
+{
+    sim_node->trace_enabled = enable;
+}
+
+void smtc_modem_hal_sim_get_stats( smtc_modem_hal_sim_stats_t* stats )
+{
+    *stats = sim_node->stats;
+}
+
+/* ------------ Simulated radio board support ------------*/
+
+void ral_sim_bsp_schedule_irq( const void* context, const uint32_t delay_in_us )
+{
+    sim_node->radio_context              = context;
+    sim_node->radio_event.deadline_in_us = sim_node->time_in_us + delay_in_us;
+    sim_node->radio_event.is_armed       = true;
+}
+
+void ral_sim_bsp_cancel_irq( const void* context )
+{
+    if( sim_node->radio_context == context )
+    {
+        sim_node->radio_event.is_armed = false;
+    }
+}
+
+/* ------------ Reset management ------------*/
+
+void smtc_modem_hal_reset_mcu( void )
+{
+    if( sim_node->reset_callback == NULL )
+    {
+        abort( );
+    }
+    sim_node->reset_callback( );
+}
+
+/* ------------ Watchdog management ------------*/
+
+void smtc_modem_hal_reload_wdog( void )
+{
+}
+
+/* ------------ Time management ------------*/
+
+uint32_t smtc_modem_hal_get_time_in_s( void )
+{
+    return ( uint32_t ) ( sim_read_time_in_us( ) / 1000000 );
+}
+
+uint32_t smtc_modem_hal_get_compensated_time_in_s( void )
+{
+    return smtc_modem_hal_get_time_in_s( );
+}
+
+int32_t smtc_modem_hal_get_time_compensation_in_s( void )
+{
+    return 0;
+}
+
+uint32_t smtc_modem_hal_get_time_in_ms( void )
+{
+    return ( uint32_t ) ( sim_read_time_in_us( ) / 1000 );
+}
+
+uint32_t smtc_modem_hal_get_time_in_100us( void )
+{
+    return ( uint32_t ) ( sim_read_time_in_us( ) / 100 );
+}
+
+uint32_t smtc_modem_hal_get_radio_irq_timestamp_in_100us( void )
+{
+    return sim_node->radio_irq_timestamp_in_100us;
+}
+
+/* ------------ Timer management ------------*/
+
+void smtc_modem_hal_start_timer( const uint32_t milliseconds, void ( *callback )( void* context ), void* context )
+{
+    sim_node->timer_event.deadline_in_us = sim_node->time_in_us + ( ( uint64_t ) milliseconds * 1000 );
+    sim_node->timer_event.callback       = callback;
+    sim_node->timer_event.context        = context;
+    sim_node->timer_event.is_armed       = true;
+}
+
+void smtc_modem_hal_stop_timer( void )
+{
+    sim_node->timer_event.is_armed = false;
+}
+
+/* ------------ IRQ management ------------*/
+
+void smtc_modem_hal_disable_modem_irq( void )
+{
+    sim_node->modem_irq_enabled = false;
+}
+
+void smtc_modem_hal_enable_modem_irq( void )
+{
+    sim_node->modem_irq_enabled = true;
+}
+
+/* ------------ Context saving management ------------*/
+
+void smtc_modem_hal_context_restore( const modem_context_type_t ctx_type, uint8_t* buffer, const uint32_t size )
+{
+    if( ( ctx_type >= MODEM_CONTEXT_TYPE_SIZE ) || ( size > SMTC_MODEM_HAL_SIM_CONTEXT_SIZE ) )
+    {
+        smtc_modem_hal_mcu_panic( "restore context %d of %u bytes not supported\n", ctx_type, size );
+        return;
+    }
+    memcpy( buffer, sim_node->nvm[ctx_type], size );
+}
+
+void smtc_modem_hal_context_store( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size )
+{
+    if( ( ctx_type >= MODEM_CONTEXT_TYPE_SIZE ) || ( size > SMTC_MODEM_HAL_SIM_CONTEXT_SIZE ) )
+    {
+        smtc_modem_hal_mcu_panic( "store context %d of %u bytes not supported\n", ctx_type, size );
+        return;
+    }
+    // Same behavior as a flash page: erased then written
+    memset( sim_node->nvm[ctx_type], 0xFF, SMTC_MODEM_HAL_SIM_CONTEXT_SIZE );
+    memcpy( sim_node->nvm[ctx_type], buffer, size );
+    sim_node->stats.nb_context_stores[ctx_type]++;
+    sim_node->stats.nb_context_store_bytes[ctx_type] += size;
+}
+
+void smtc_modem_hal_context_journal_read( const uint32_t offset, uint8_t* buffer, const uint32_t size )
+{
+    if( ( offset > sizeof( sim_node->context_journal ) ) || ( size > ( sizeof( sim_node->context_journal ) - offset ) ) )
+    {
+        smtc_modem_hal_mcu_panic( "read journal at %u, %u bytes out of range\n", offset, size );
+        return;
+    }
+    memcpy( buffer, &sim_node->context_journal[offset], size );
+}
+
+void smtc_modem_hal_context_journal_write( const uint32_t offset, const uint8_t* buffer, const uint32_t size )
+{
+    if( ( offset > sizeof( sim_node->context_journal ) ) ||
+        ( size > ( sizeof( sim_node->context_journal ) - offset ) ) || ( ( offset % 8 ) != 0 ) || ( ( size % 8 ) != 0 ) )
+    {
+        smtc_modem_hal_mcu_panic( "write journal at %u, %u bytes not supported\n", offset, size );
+        return;
+    }
+    // Same behavior as a flash memory: the bytes can only be written once after an erase
+    for( uint32_t i = 0; i < size; i++ )
+    {
+        if( sim_node->context_journal[offset + i] != 0xFF )
+        {
+            smtc_modem_hal_mcu_panic( "write journal at %u not erased\n", offset + i );
+            return;
+        }
+    }
+    memcpy( &sim_node->context_journal[offset], buffer, size );
+    sim_node->stats.nb_context_journal_write_bytes += size;
+}
+
+void smtc_modem_hal_context_journal_erase_page( const uint32_t page )
+{
+    if( page >= SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES )
+    {
+        smtc_modem_hal_mcu_panic( "erase journal page %u out of range\n", page );
+        return;
+    }
+    memset( &sim_node->context_journal[page * SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE], 0xFF,
+            SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE );
+    sim_node->stats.nb_context_journal_erases++;
+}
+
+void smtc_modem_hal_store_crashlog( uint8_t crashlog[CRASH_LOG_SIZE] )
+{
+    memcpy( sim_node->crashlog, crashlog, CRASH_LOG_SIZE );
+}
+
+void smtc_modem_hal_restore_crashlog( uint8_t crashlog[CRASH_LOG_SIZE] )
+{
+    memcpy( crashlog, sim_node->crashlog, CRASH_LOG_SIZE );
+}
+
+void smtc_modem_hal_set_crashlog_status( bool available )
+{
+    sim_node->crashlog_available = available;
+}
+
+bool smtc_modem_hal_get_crashlog_status( void )
+{
+    return sim_node->crashlog_available;
+}
+
+/* ------------ assert management ------------*/
+
+void smtc_modem_hal_assert_fail( uint8_t* func, uint32_t line )
+{
+    smtc_modem_hal_store_crashlog( ( uint8_t* ) func );
+    smtc_modem_hal_set_crashlog_status( true );
+    smtc_modem_hal_print_trace(
+        "\x1B[0;31m"  // red color
+        "crash log :%s:%u\n"
+        "\x1B[0m",  // revert default color
+        func, line );
+    smtc_modem_hal_reset_mcu( );
+}
+
+/* ------------ Random management ------------*/
+
+uint32_t smtc_modem_hal_get_random_nb( void )
+{
+    return sim_rand( );
+}
+
+uint32_t smtc_modem_hal_get_random_nb_in_range( const uint32_t val_1, const uint32_t val_2 )
+{
+    if( val_1 <= val_2 )
+    {
+        return ( uint32_t ) ( ( ( uint64_t ) sim_rand( ) % ( ( uint64_t ) val_2 - val_1 + 1 ) ) + val_1 );
+    }
+    else
+    {
+        return ( uint32_t ) ( ( ( uint64_t ) sim_rand( ) % ( ( uint64_t ) val_1 - val_2 + 1 ) ) + val_2 );
+    }
+}
+
+int32_t smtc_modem_hal_get_signed_random_nb_in_range( const int32_t val_1, const int32_t val_2 )
+{
+    int64_t low  = ( val_1 <= val_2 ) ? val_1 : val_2;
+    int64_t high = ( val_1 <= val_2 ) ? val_2 : val_1;
+
+    return ( int32_t ) ( ( int64_t ) ( sim_rand( ) % ( uint64_t ) ( high - low + 1 ) ) + low );
+}
+
+/* ------------ CRC management ------------*/
+
+uint32_t smtc_modem_hal_crc32_update( const uint32_t crc, const uint8_t* buffer, const uint32_t length )
+{
+    uint32_t running_crc = crc;
+
+    // Bit per bit, as a CRC unit
+    for( uint32_t index = 0; index < length; index++ )
+    {
+        running_crc ^= buffer[index];
+        for( uint8_t bit = 0; bit < 8; bit++ )
+        {
+            running_crc = ( running_crc >> 1 ) ^ ( 0xEDB88320 & -( running_crc & 1 ) );
+        }
+    }
+    return running_crc;
+}
+
+/* ------------ Radio env management ------------*/
+
+void smtc_modem_hal_irq_config_radio_irq( void ( *callback )( void* context ), void* context )
+{
+    sim_node->radio_event.callback = callback;
+    sim_node->radio_event.context  = context;
+}
+
+void smtc_modem_hal_radio_irq_clear_pending( void )
+{
+    // The simulated radio raises its interrupt only once per operation
+}
+
+void smtc_modem_hal_start_radio_tcxo( void )
+{
+}
+
+void smtc_modem_hal_stop_radio_tcxo( void )
+{
+}
+
+uint32_t smtc_modem_hal_get_radio_tcxo_startup_delay_ms( void )
+{
+    return sim_node->tcxo_startup_delay_ms;
+}
+
+/* ------------ Environment management ------------*/
+
+uint8_t smtc_modem_hal_get_battery_level( void )
+{
+    return SIM_BATTERY_LEVEL;
+}
+
+int8_t smtc_modem_hal_get_temperature( void )
+{
+    return SIM_TEMPERATURE;
+}
+
+uint8_t smtc_modem_hal_get_voltage( void )
+{
+    return SIM_VOLTAGE;
+}
+
+int8_t smtc_modem_hal_get_board_delay_ms( void )
+{
+    return SIM_BOARD_DELAY_MS;
+}
+
+/* ------------ Trace management ------------*/
+
+void smtc_modem_hal_print_trace( const char* fmt, ... )
+{
+    if( sim_node->trace_enabled == false )
+    {
+        return;
+    }
+
+    va_list args;
+    va_start( args, fmt );
+    vprintf( fmt, args );
+    va_end( args );
+}
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+static uint64_t sim_read_time_in_us( void )
+{
+    uint64_t now = sim_node->time_in_us;
+
+    smtc_modem_hal_sim_advance_time_in_us( sim_node->time_read_cost_in_us );
+    return now;
+}
+
+static void sim_reset_node( smtc_modem_hal_sim_node_t* node, const uint32_t seed )
+{
+    memset( node, 0, sizeof( *node ) );
+    node->time_in_us           = sim_time_in_us;
+    node->random_state         = ( seed != 0 ) ? seed : 1;
+    node->time_read_cost_in_us = SMTC_MODEM_HAL_SIM_DEFAULT_TIME_READ_COST_US;
+    node->modem_irq_enabled    = true;
+    node->trace_enabled        = true;
+    // Erased flash reads as 0xFF
+    memset( node->nvm, 0xFF, sizeof( node->nvm ) );
+    memset( node->context_journal, 0xFF, sizeof( node->context_journal ) );
+}
+
+static smtc_modem_hal_sim_event_t* sim_get_next_event( smtc_modem_hal_sim_node_t* node )
+{
+    // On equal deadlines the radio interrupt is served first, like the higher priority radio EXTI on target
+    if( ( node->radio_event.is_armed == true ) &&
+        ( ( node->timer_event.is_armed == false ) ||
+          ( node->radio_event.deadline_in_us <= node->timer_event.deadline_in_us ) ) )
+    {
+        return &node->radio_event;
+    }
+    if( node->timer_event.is_armed == true )
+    {
+        return &node->timer_event;
+    }
+    return NULL;
+}
+
+static void sim_process_event( smtc_modem_hal_sim_event_t* event )
+{
+    event->is_armed = false;
+
+    if( event == &sim_node->radio_event )
+    {
+        sim_node->stats.nb_radio_irqs++;
+        // The radio driver may start a new operation (CAD exit modes) and re-arm the event
+        if( ral_sim_process_irq( sim_node->radio_context ) == false )
+        {
+            return;
+        }
+        sim_node->radio_irq_timestamp_in_100us = ( uint32_t ) ( sim_node->time_in_us / 100 );
+    }
+    else
+    {
+        sim_node->stats.nb_timer_irqs++;
+    }
+
+    if( event->callback != NULL )
+    {
+        event->callback( event->context );
+    }
+}
+
+static uint32_t sim_rand( void )
+{
+    // xorshift32
+    sim_node->random_state ^= sim_node->random_state << 13;
+    sim_node->random_state ^= sim_node->random_state >> 17;
+    sim_node->random_state ^= sim_node->random_state << 5;
+    return sim_node->random_state;
+}
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -0,0 +1,291 @@
+/**
+ * @file      smtc_modem_hal_sim.h
+ *
+ * @brief     Simulation control interface of the host implementation of the modem HAL
+ *
+ * The Clear BSD License
+ * Copyright Semtech Corporation 2021. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the disclaimer
+ * below) provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Semtech corporation nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE GRANTED BY
+ * THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ * CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT
+ * NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL SEMTECH CORPORATION BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SMTC_MODEM_HAL_SIM_H__
+#define SMTC_MODEM_HAL_SIM_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- DEPENDENCIES ------------------------------------------------------------
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "smtc_modem_hal.h"
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC MACROS -----------------------------------------------------------
+ */
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC CONSTANTS --------------------------------------------------------
+ */
+
+/**
+ * @brief Size of the RAM area emulating the non-volatile storage of each context type
+ */
+#define SMTC_MODEM_HAL_SIM_CONTEXT_SIZE 1024
+
+/**
+ * @brief Size of the RAM area emulating the flash pages of the context journal
+ */
+#define SMTC_MODEM_HAL_SIM_CONTEXT_JOURNAL_SIZE \
+    ( SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES * SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE )
+
+/**
+ * @brief Virtual time consumed by each time read (busy-wait loops of the stack rely on time going forward)
+ */
+#define SMTC_MODEM_HAL_SIM_DEFAULT_TIME_READ_COST_US 1
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC TYPES ------------------------------------------------------------
+ */
+
+/**
+ * @brief Simulation statistics
+ */
+typedef struct smtc_modem_hal_sim_stats_s
+{
+    uint64_t sleep_time_in_us;                                 //!< Virtual time spent in sleep
+    uint64_t awake_time_in_us;                                 //!< Virtual time spent running the stack
+    uint32_t nb_wakeups;                                       //!< Number of wake-ups from sleep
+    uint32_t nb_timer_irqs;                                    //!< Number of low power timer interrupts
+    uint32_t nb_radio_irqs;                                    //!< Number of radio interrupts
+    uint32_t nb_context_stores[MODEM_CONTEXT_TYPE_SIZE];       //!< Number of stores per context type
+    uint32_t nb_context_store_bytes[MODEM_CONTEXT_TYPE_SIZE];  //!< Number of bytes stored per context type
+    uint32_t nb_context_journal_erases;                        //!< Number of page erases of the context journal
+    uint32_t nb_context_journal_write_bytes;                   //!< Number of bytes written to the context journal
+} smtc_modem_hal_sim_stats_t;
+
+/**
+ * @brief Event of a simulated MCU (interrupt source)
+ */
+typedef struct smtc_modem_hal_sim_event_s
+{
+    bool     is_armed;
+    uint64_t deadline_in_us;
+    void ( *callback )( void* context );
+    void* context;
+} smtc_modem_hal_sim_event_t;
+
+/**
+ * @brief Simulated MCU
+ *
+ * Several MCUs can be simulated in the same process, each one running its own stack instance. All the modem HAL
+ * functions apply to the node selected with @ref smtc_modem_hal_sim_select_node. The fields are private to the HAL.
+ */
+typedef struct smtc_modem_hal_sim_node_s smtc_modem_hal_sim_node_t;
+
+struct smtc_modem_hal_sim_node_s
+{
+    uint64_t                   time_in_us;  //!< Local time, ahead of the simulation time while the node runs
+    uint32_t                   random_state;
+    uint32_t                   time_read_cost_in_us;
+    uint32_t                   tcxo_startup_delay_ms;
+    bool                       modem_irq_enabled;
+    bool                       trace_enabled;
+    void                       ( *reset_callback )( void );
+    smtc_modem_hal_sim_event_t timer_event;
+    smtc_modem_hal_sim_event_t radio_event;
+    const void*                radio_context;
+    uint32_t                   radio_irq_timestamp_in_100us;
+    uint8_t                    nvm[MODEM_CONTEXT_TYPE_SIZE][SMTC_MODEM_HAL_SIM_CONTEXT_SIZE];
+    uint8_t                    context_journal[SMTC_MODEM_HAL_SIM_CONTEXT_JOURNAL_SIZE];
+    uint8_t                    crashlog[CRASH_LOG_SIZE];
+    bool                       crashlog_available;
+    smtc_modem_hal_sim_stats_t stats;
+    void*                      user_context;  //!< Free pointer for the simulation harness
+    smtc_modem_hal_sim_node_t* next;
+};
+
+/*
+ * -----------------------------------------------------------------------------
+ * --- PUBLIC FUNCTIONS PROTOTYPES ---------------------------------------------
+ */
+
+/**
+ * @brief Initialize the simulation
+ *
+ * Must be called before any other function of the modem HAL.
+ *
+ * @remark Time is reset to 0, the additional nodes are removed and the default node is initialized and selected: a
+ * single-node simulation needs nothing else.
+ *
+ * @param [in] seed Seed of the random number generator of the default node
+ */
+void smtc_modem_hal_sim_init( const uint32_t seed );
+
+/**
+ * @brief Initialize an additional node and add it to the simulation
+ *
+ * @remark Timers are stopped, the non-volatile storage is erased and the statistics are cleared
+ *
+ * @param [in] node Node to initialize
+ * @param [in] seed Seed of the random number generator of the node
+ */
+void smtc_modem_hal_sim_node_init( smtc_modem_hal_sim_node_t* node, const uint32_t seed );
+
+/**
+ * @brief Select the node the modem HAL functions apply to
+ *
+ * @remark The node local time catches up with the simulation time
+ *
+ * @param [in] node Node to select
+ */
+void smtc_modem_hal_sim_select_node( smtc_modem_hal_sim_node_t* node );
+
+/**
+ * @brief Get the selected node
+ *
+ * @returns Selected node
+ */
+smtc_modem_hal_sim_node_t* smtc_modem_hal_sim_get_selected_node( void );
+
+/**
+ * @brief Set the function called each time a node is selected
+ *
+ * @remark Used to switch the state that cannot be attached to a node by the HAL (e.g. secure element data)
+ *
+ * @param [in] callback Selection callback
+ */
+void smtc_modem_hal_sim_set_select_callback( void ( *callback )( smtc_modem_hal_sim_node_t* node ) );
+
+/**
+ * @brief Process the earliest event of all nodes
+ *
+ * The simulation time jumps to the event deadline, the owner node is selected and its due events are processed.
+ *
+ * @param [in] end_time_in_us Simulation time not to go beyond
+ *
+ * @returns The node that processed an event, NULL if no event is due before end_time_in_us (simulation time is then
+ * set to end_time_in_us)
+ */
+smtc_modem_hal_sim_node_t* smtc_modem_hal_sim_run_next_event( const uint64_t end_time_in_us );
+
+/**
+ * @brief Get the current virtual time of the selected node
+ *
+ * @returns Virtual time in microseconds
+ */
+uint64_t smtc_modem_hal_sim_get_time_in_us( void );
+
+/**
+ * @brief Move the virtual time of the selected node forward, as if the MCU was running
+ *
+ * @remark No pending event is processed
+ *
+ * @param [in] delay_in_us Duration in microseconds
+ */
+void smtc_modem_hal_sim_advance_time_in_us( const uint32_t delay_in_us );
+
+/**
+ * @brief Sleep until the next event or until the given duration has elapsed (single-node simulation)
+ *
+ * Events already due are processed right away. Otherwise the virtual time jumps to the earliest of the next event and
+ * the end of the sleep period, and the event (if any) is processed. This mimics an MCU waking up on interrupt.
+ *
+ * @param [in] sleep_time_in_ms Maximum sleep duration in milliseconds
+ *
+ * @returns True if an event woke up the MCU, false if the full sleep duration elapsed
+ */
+bool smtc_modem_hal_sim_sleep_in_ms( const uint32_t sleep_time_in_ms );
+
+/**
+ * @brief Process all events of the selected node due at its current virtual time
+ *
+ * @returns True if at least one event was processed
+ */
+bool smtc_modem_hal_sim_process_events( void );
+
+/**
+ * @brief Get the time remaining until the next event of the selected node
+ *
+ * @param [out] delay_in_us Delay in microseconds (0 if the event is already due)
+ *
+ * @returns True if an event is pending, false otherwise
+ */
+bool smtc_modem_hal_sim_get_next_event_delay_in_us( uint64_t* delay_in_us );
+
+/**
+ * @brief Set the virtual time consumed by each time read on the selected node
+ *
+ * @param [in] cost_in_us Cost in microseconds (must not be 0 if the stack busy-waits)
+ */
+void smtc_modem_hal_sim_set_time_read_cost_in_us( const uint32_t cost_in_us );
+
+/**
+ * @brief Set the TCXO startup delay reported to the stack of the selected node
+ *
+ * @param [in] delay_in_ms Delay in milliseconds
+ */
+void smtc_modem_hal_sim_set_tcxo_startup_delay_ms( const uint32_t delay_in_ms );
+
+/**
+ * @brief Set the function called in place of an MCU reset of the selected node
+ *
+ * @remark Without callback a reset aborts the process
+ *
+ * @param [in] callback Reset callback
+ */
+void smtc_modem_hal_sim_set_reset_callback( void ( *callback )( void ) );
+
+/**
+ * @brief Enable or disable the trace output on stdout for the selected node
+ *
+ * @param [in] enable Trace enable
+ */
+void smtc_modem_hal_sim_set_trace_enabled( const bool enable );
+
+/**
+ * @brief Get the simulation statistics of the selected node
+ *
+ * @param [out] stats Statistics
+ */
+void smtc_modem_hal_sim_get_stats( smtc_modem_hal_sim_stats_t* stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // SMTC_MODEM_HAL_SIM_H__
+
+/* --- EOF ------------------------------------------------------------------ */
@@ -105,6 +105,22 @@ extern "C" {
  */
 #define CRASH_LOG_SIZE 32
 
+/**
+ * @brief Size in byte of a page of the context journal area
+ *
+ * @remark Only used when the modem is built with ADD_SMTC_CONTEXT_JOURNAL, see smtc_context_journal.h
+ */
+#ifndef SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE
+#define SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE 2048
+#endif
+
+/**
+ * @brief Number of pages of the context journal area, at least 2
+ */
+#ifndef SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES
+#define SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES 2
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC TYPES ------------------------------------------------------------
@@ -257,6 +273,38 @@ void smtc_modem_hal_context_restore( const modem_context_type_t ctx_type, uint8_
  */
 void smtc_modem_hal_context_store( const modem_context_type_t ctx_type, const uint8_t* buffer, const uint32_t size );
 
+/**
+ * @brief Reads the context journal area
+ *
+ * @remark Only needed when the modem is built with ADD_SMTC_CONTEXT_JOURNAL. The area is made of
+ * SMTC_MODEM_HAL_CONTEXT_JOURNAL_NB_PAGES pages of SMTC_MODEM_HAL_CONTEXT_JOURNAL_PAGE_SIZE bytes, erased bytes read
+ * 0xFF.
+ *
+ * @param [in] offset     Offset in the area to read from
+ * @param [out] buffer    Buffer pointer to write to
+ * @param [in] size       Size to read in bytes
+ */
+void smtc_modem_hal_context_journal_read( const uint32_t offset, uint8_t* buffer, const uint32_t size );
+
+/**
+ * @brief Writes the context journal area
+ *
+ * @remark The written bytes have been erased and are written only once. Offset and size are multiples of 8 bytes. The
+ * function returns once the data is in the non volatile memory.
+ *
+ * @param [in] offset     Offset in the area to write to
+ * @param [in] buffer     Buffer pointer to write from
+ * @param [in] size       Size to write in bytes
+ */
+void smtc_modem_hal_context_journal_write( const uint32_t offset, const uint8_t* buffer, const uint32_t size );
+
+/**
+ * @brief Erases a page of the context journal area
+ *
+ * @param [in] page       Index of the page in the area
+ */
+void smtc_modem_hal_context_journal_erase_page( const uint32_t page );
+
 /* ------------ Crashlog management ------------*/
 
 /**
@@ -336,6 +384,23 @@ uint32_t smtc_modem_hal_get_random_nb_in_range( const uint32_t val_1, const uint
  */
 int32_t smtc_modem_hal_get_signed_random_nb_in_range( const int32_t val_1, const int32_t val_2 );
 
+/* ------------ CRC management ------------*/
+
+/**
+ * @brief Updates a running CRC-32 (polynomial 0x04C11DB7, reflected input and output) with the next part of the data
+ *
+ * @remark Only used when the modem is built with SMTC_CRC32_HAL, see smtc_crc32.h, e.g. to compute the crc with the CRC
+ * unit of the MCU. The running crc is neither inverted on entry nor on exit, the CRC unit has to be loaded with crc as
+ * initial value.
+ *
+ * @param [in] crc        Running crc
+ * @param [in] buffer     Next part of the data
+ * @param [in] length     Size of the part in bytes
+ *
+ * @return uint32_t Running crc
+ */
+uint32_t smtc_modem_hal_crc32_update( const uint32_t crc, const uint8_t* buffer, const uint32_t length );
+
 /* ------------ Radio env management ------------*/
 
 /**
@@ -82,6 +82,8 @@ static volatile radio_mode_t radio_mode = RADIO_AWAKE;
 
 /**
  * @brief Wait until radio busy pin returns to 0
+ *
+ * @remark The MCU sleeps until the busy pin falling edge
  */
 static void lr11xx_hal_wait_on_busy( const hal_gpio_pin_names_t busy_pin );
 
@@ -124,14 +126,8 @@ lr11xx_hal_status_t lr11xx_hal_write( const void* context, const uint8_t* comman
 
     // Put NSS low to start spi transaction
     hal_gpio_set_value( lr11xx_context->nss, 0 );
-    for( uint16_t i = 0; i < command_length; i++ )
-    {
-        hal_spi_in_out( lr11xx_context->spi_id, command[i] );
-    }
-    for( uint16_t i = 0; i < data_length; i++ )
-    {
-        hal_spi_in_out( lr11xx_context->spi_id, data[i] );
-    }
+    hal_spi_transfer( lr11xx_context->spi_id, command, NULL, command_length );
+    hal_spi_transfer( lr11xx_context->spi_id, data, NULL, data_length );
 
 #if defined( USE_LR11XX_CRC_OVER_SPI )
     // Send the CRC byte at the end of the transaction
@@ -173,10 +169,7 @@ lr11xx_hal_status_t lr11xx_hal_read( const void* context, const uint8_t* command
 
     // Put NSS low to start spi transaction
     hal_gpio_set_value( lr11xx_context->nss, 0 );
-    for( uint16_t i = 0; i < command_length; i++ )
-    {
-        hal_spi_in_out( lr11xx_context->spi_id, command[i] );
-    }
+    hal_spi_transfer( lr11xx_context->spi_id, command, NULL, command_length );
 
 #if defined( USE_LR11XX_CRC_OVER_SPI )
     // Send the CRC byte at the end of the transaction
@@ -198,10 +191,7 @@ lr11xx_hal_status_t lr11xx_hal_read( const void* context, const uint8_t* command
         hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
 #endif
 
-        for( uint16_t i = 0; i < data_length; i++ )
-        {
-            data[i] = hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
-        }
+        hal_spi_transfer( lr11xx_context->spi_id, NULL, data, data_length );
 
 #if defined( USE_LR11XX_CRC_OVER_SPI )
         // read crc sent by lr11xx at the end of the transaction
@@ -242,11 +232,7 @@ lr11xx_hal_status_t lr11xx_hal_direct_read( const void* radio, uint8_t* data, co
 
     // Put NSS low to start spi transaction
     hal_gpio_set_value( lr11xx_context->nss, 0 );
-
-    for( uint16_t i = 0; i < data_length; i++ )
-    {
-        data[i] = hal_spi_in_out( lr11xx_context->spi_id, LR11XX_NOP );
-    }
+    hal_spi_transfer( lr11xx_context->spi_id, NULL, data, data_length );
 
 #if defined( USE_LR11XX_CRC_OVER_SPI )
     // read crc sent by lr11xx by sending one more NOP
@@ -302,9 +288,7 @@ lr11xx_hal_status_t lr11xx_hal_wakeup( const void* context )
 
 static void lr11xx_hal_wait_on_busy( const hal_gpio_pin_names_t busy_pin )
 {
-    while( hal_gpio_get_value( busy_pin ) == 1 )
-    {
-    };
+    hal_gpio_wait_for_value( busy_pin, HAL_GPIO_RESET );
 }
 
 static void lr11xx_hal_check_device_ready( const lr11xx_hal_context_t* lr11xx_context )
@@ -41,6 +41,7 @@
 
 #include "smtc_hal.h"
 #include "stm32l4xx_hal.h"
+#include "stm32l4xx_ll_exti.h"
 
 /*
  * -----------------------------------------------------------------------------
@@ -199,6 +200,45 @@ uint32_t hal_gpio_get_value( const hal_gpio_pin_names_t pin )
     return ( HAL_GPIO_ReadPin( gpio_port, ( ( 1 << ( pin & 0x0F ) ) ) ) != GPIO_PIN_RESET ) ? 1 : 0;
 }
 
+void hal_gpio_wait_for_value( const hal_gpio_pin_names_t pin, const hal_gpio_state_t value )
+{
+    const uint32_t line      = pin & 0x0F;
+    const uint32_t exti_line = 1 << line;
+
+    if( LL_EXTI_IsEnabledIT_0_31( exti_line ) != 0 )
+    {
+        // The EXTI line already raises an interrupt, possibly for a pin of another port
+        while( hal_gpio_get_value( pin ) != value )
+        {
+        };
+        return;
+    }
+
+    // Route the pin to its EXTI line, and raise an event on the edge leading to the value
+    __HAL_RCC_SYSCFG_CLK_ENABLE( );
+    MODIFY_REG( SYSCFG->EXTICR[line >> 2], 0x0F << ( 4 * ( line & 0x03 ) ),
+                ( ( pin & 0xF0 ) >> 4 ) << ( 4 * ( line & 0x03 ) ) );
+    if( value == HAL_GPIO_SET )
+    {
+        LL_EXTI_EnableRisingTrig_0_31( exti_line );
+    }
+    else
+    {
+        LL_EXTI_EnableFallingTrig_0_31( exti_line );
+    }
+    LL_EXTI_EnableEvent_0_31( exti_line );
+
+    // An edge between the read and WFE sets the event register, so WFE then returns at once
+    while( hal_gpio_get_value( pin ) != value )
+    {
+        __WFE( );
+    }
+
+    LL_EXTI_DisableEvent_0_31( exti_line );
+    LL_EXTI_DisableRisingTrig_0_31( exti_line );
+    LL_EXTI_DisableFallingTrig_0_31( exti_line );
+}
+
 void hal_gpio_clear_pending_irq( const hal_gpio_pin_names_t pin )
 {
     switch( pin & 0x0F )
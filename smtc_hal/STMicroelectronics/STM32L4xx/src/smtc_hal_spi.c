@@ -43,6 +43,7 @@
 #include "smtc_hal.h"
 #include "stm32l4xx_hal.h"
 #include "stm32l4xx_ll_spi.h"
+#include "stm32l4xx_ll_dma.h"
 #include "modem_pinout.h"
 
 /*
@@ -55,6 +56,11 @@
  * --- PRIVATE CONSTANTS -------------------------------------------------------
  */
 
+/*!
+ * @brief Number of bytes the polled transfers send ahead of the received ones, the size of the SPI RX FIFO
+ */
+#define HAL_SPI_FIFO_SIZE 4
+
 /*
  * -----------------------------------------------------------------------------
  * --- PRIVATE TYPES -----------------------------------------------------------
@@ -68,6 +74,13 @@ typedef struct hal_spi_s
     SPI_TypeDef*      interface;
     SPI_HandleTypeDef handle;
     struct
+    {
+        DMA_TypeDef* controller;
+        uint32_t     rx_channel;
+        uint32_t     tx_channel;
+        IRQn_Type    rx_irq;
+    } dma;
+    struct
     {
         hal_gpio_pin_names_t mosi;
         hal_gpio_pin_names_t miso;
@@ -85,6 +98,13 @@ static hal_spi_t hal_spi[] = {
         {
             .interface = SPI1,
             .handle    = { NULL },
+            .dma =
+                {
+                    .controller = DMA1,
+                    .rx_channel = LL_DMA_CHANNEL_2,
+                    .tx_channel = LL_DMA_CHANNEL_3,
+                    .rx_irq     = DMA1_Channel2_IRQn,
+                },
             .pins =
                 {
                     .mosi = NC,
@@ -96,6 +116,13 @@ static hal_spi_t hal_spi[] = {
         {
             .interface = SPI2,
             .handle    = { NULL },
+            .dma =
+                {
+                    .controller = DMA1,
+                    .rx_channel = LL_DMA_CHANNEL_4,
+                    .tx_channel = LL_DMA_CHANNEL_5,
+                    .rx_irq     = DMA1_Channel4_IRQn,
+                },
             .pins =
                 {
                     .mosi = NC,
@@ -110,6 +137,29 @@ static hal_spi_t hal_spi[] = {
  * --- PRIVATE FUNCTIONS DECLARATION -------------------------------------------
  */
 
+#if( HAL_SPI_USE_DMA == HAL_FEATURE_ON )
+/*!
+ * @brief Configures the DMA channels of the SPI peripheral
+ *
+ * @param [in] spi SPI peripheral
+ */
+static void hal_spi_dma_init( const hal_spi_t* spi );
+
+/*!
+ * @brief Moves a transfer with the DMA, the MCU sleeping until its end
+ *
+ * @remark The end of the transfer raises the DMA RX channel interrupt, which is kept disabled in the NVIC: it only
+ *         wakes the MCU up through the SEVONPEND event, so the transfer also completes with the interrupts disabled.
+ *
+ * @param [in]  spi      SPI peripheral
+ * @param [in]  out_data Bytes to be sent, 0x00 are sent when NULL
+ * @param [out] in_data  Received bytes, discarded when NULL
+ * @param [in]  length   Number of bytes to be sent and received
+ */
+static void hal_spi_dma_transfer( const hal_spi_t* spi, const uint8_t* out_data, uint8_t* in_data,
+                                  const uint16_t length );
+#endif
+
 /*
  * -----------------------------------------------------------------------------
  * --- PUBLIC FUNCTIONS DEFINITION ---------------------------------------------
@@ -143,6 +193,10 @@ void hal_spi_init( const uint32_t id, const hal_gpio_pin_names_t mosi, const hal
         mcu_panic( );
     }
     __HAL_SPI_ENABLE( &hal_spi[local_id].handle );
+
+#if( HAL_SPI_USE_DMA == HAL_FEATURE_ON )
+    hal_spi_dma_init( &hal_spi[local_id] );
+#endif
 }
 
 void hal_spi_deinit( const uint32_t id )
@@ -169,6 +223,42 @@ uint16_t hal_spi_in_out( const uint32_t id, const uint16_t out_data )
     return LL_SPI_ReceiveData8( hal_spi[local_id].interface );
 }
 
+void hal_spi_transfer( const uint32_t id, const uint8_t* out_data, uint8_t* in_data, const uint16_t length )
+{
+    assert_param( ( id > 0 ) && ( ( id - 1 ) < sizeof( hal_spi ) ) );
+    uint32_t local_id = id - 1;
+
+#if( HAL_SPI_USE_DMA == HAL_FEATURE_ON )
+    if( length >= HAL_SPI_DMA_MIN_LENGTH )
+    {
+        hal_spi_dma_transfer( &hal_spi[local_id], out_data, in_data, length );
+        return;
+    }
+#endif
+
+    // Keep the TX FIFO fed while reading back, without sending more bytes than the RX FIFO holds
+    uint16_t tx_index = 0;
+    uint16_t rx_index = 0;
+    while( rx_index < length )
+    {
+        if( ( tx_index < length ) && ( ( tx_index - rx_index ) < HAL_SPI_FIFO_SIZE ) &&
+            ( LL_SPI_IsActiveFlag_TXE( hal_spi[local_id].interface ) != 0 ) )
+        {
+            LL_SPI_TransmitData8( hal_spi[local_id].interface, ( out_data != NULL ) ? out_data[tx_index] : 0x00 );
+            tx_index++;
+        }
+        if( LL_SPI_IsActiveFlag_RXNE( hal_spi[local_id].interface ) != 0 )
+        {
+            const uint8_t data = LL_SPI_ReceiveData8( hal_spi[local_id].interface );
+            if( in_data != NULL )
+            {
+                in_data[rx_index] = data;
+            }
+            rx_index++;
+        }
+    }
+}
+
 void HAL_SPI_MspInit( SPI_HandleTypeDef* spiHandle )
 {
     if( spiHandle->Instance == hal_spi[0].interface )
@@ -239,4 +329,81 @@ void HAL_SPI_MspDeInit( SPI_HandleTypeDef* spiHandle )
     }
 }
 
+/*
+ * -----------------------------------------------------------------------------
+ * --- PRIVATE FUNCTIONS DEFINITION --------------------------------------------
+ */
+
+#if( HAL_SPI_USE_DMA == HAL_FEATURE_ON )
+static void hal_spi_dma_init( const hal_spi_t* spi )
+{
+    const uint32_t configuration = LL_DMA_MODE_NORMAL | LL_DMA_PERIPH_NOINCREMENT | LL_DMA_PDATAALIGN_BYTE |
+                                   LL_DMA_MDATAALIGN_BYTE | LL_DMA_PRIORITY_HIGH;
+
+    __HAL_RCC_DMA1_CLK_ENABLE( );
+
+    LL_DMA_ConfigTransfer( spi->dma.controller, spi->dma.rx_channel,
+                           LL_DMA_DIRECTION_PERIPH_TO_MEMORY | configuration );
+    LL_DMA_SetPeriphAddress( spi->dma.controller, spi->dma.rx_channel, LL_SPI_DMA_GetRegAddr( spi->interface ) );
+    LL_DMA_SetPeriphRequest( spi->dma.controller, spi->dma.rx_channel, LL_DMA_REQUEST_1 );
+    LL_DMA_EnableIT_TC( spi->dma.controller, spi->dma.rx_channel );
+    LL_DMA_EnableIT_TE( spi->dma.controller, spi->dma.rx_channel );
+
+    LL_DMA_ConfigTransfer( spi->dma.controller, spi->dma.tx_channel,
+                           LL_DMA_DIRECTION_MEMORY_TO_PERIPH | configuration );
+    LL_DMA_SetPeriphAddress( spi->dma.controller, spi->dma.tx_channel, LL_SPI_DMA_GetRegAddr( spi->interface ) );
+    LL_DMA_SetPeriphRequest( spi->dma.controller, spi->dma.tx_channel, LL_DMA_REQUEST_1 );
+
+    // Let the pending DMA interrupt wake the MCU up from WFE while it stays disabled in the NVIC
+    HAL_NVIC_DisableIRQ( spi->dma.rx_irq );
+    SET_BIT( SCB->SCR, SCB_SCR_SEVONPEND_Msk );
+}
+
+static void hal_spi_dma_transfer( const hal_spi_t* spi, const uint8_t* out_data, uint8_t* in_data,
+                                  const uint16_t length )
+{
+    static const uint8_t nop_data   = 0x00;
+    static uint8_t       drop_data  = 0x00;
+    const uint32_t       rx_shift   = spi->dma.rx_channel * 4;
+    const uint32_t       tx_shift   = spi->dma.tx_channel * 4;
+
+    LL_DMA_SetMemoryAddress( spi->dma.controller, spi->dma.rx_channel,
+                             ( in_data != NULL ) ? ( uint32_t ) in_data : ( uint32_t ) &drop_data );
+    LL_DMA_SetMemoryIncMode( spi->dma.controller, spi->dma.rx_channel,
+                             ( in_data != NULL ) ? LL_DMA_MEMORY_INCREMENT : LL_DMA_MEMORY_NOINCREMENT );
+    LL_DMA_SetDataLength( spi->dma.controller, spi->dma.rx_channel, length );
+
+    LL_DMA_SetMemoryAddress( spi->dma.controller, spi->dma.tx_channel,
+                             ( out_data != NULL ) ? ( uint32_t ) out_data : ( uint32_t ) &nop_data );
+    LL_DMA_SetMemoryIncMode( spi->dma.controller, spi->dma.tx_channel,
+                             ( out_data != NULL ) ? LL_DMA_MEMORY_INCREMENT : LL_DMA_MEMORY_NOINCREMENT );
+    LL_DMA_SetDataLength( spi->dma.controller, spi->dma.tx_channel, length );
+
+    // RX requests are enabled first so that no received byte is missed
+    LL_SPI_EnableDMAReq_RX( spi->interface );
+    LL_DMA_EnableChannel( spi->dma.controller, spi->dma.rx_channel );
+    LL_DMA_EnableChannel( spi->dma.controller, spi->dma.tx_channel );
+    LL_SPI_EnableDMAReq_TX( spi->interface );
+
+    const uint32_t error_flags = ( DMA_ISR_TEIF1 << rx_shift ) | ( DMA_ISR_TEIF1 << tx_shift );
+    while( READ_BIT( spi->dma.controller->ISR, ( DMA_ISR_TCIF1 << rx_shift ) | error_flags ) == 0 )
+    {
+        __WFE( );
+    }
+    const bool error = READ_BIT( spi->dma.controller->ISR, error_flags ) != 0;
+
+    LL_DMA_DisableChannel( spi->dma.controller, spi->dma.tx_channel );
+    LL_DMA_DisableChannel( spi->dma.controller, spi->dma.rx_channel );
+    LL_SPI_DisableDMAReq_TX( spi->interface );
+    LL_SPI_DisableDMAReq_RX( spi->interface );
+    WRITE_REG( spi->dma.controller->IFCR, ( DMA_IFCR_CGIF1 << rx_shift ) | ( DMA_IFCR_CGIF1 << tx_shift ) );
+    NVIC_ClearPendingIRQ( spi->dma.rx_irq );
+
+    if( error == true )
+    {
+        mcu_panic( );
+    }
+}
+#endif
+
 /* --- EOF ------------------------------------------------------------------ */
@@ -190,6 +190,17 @@ void hal_gpio_toggle( const hal_gpio_pin_names_t pin );
  */
 uint32_t hal_gpio_get_value( const hal_gpio_pin_names_t pin );
 
+/*!
+ * @brief Waits until MCU input pin state is the given value
+ *
+ * @remark The MCU sleeps until the edge leading to the value, through an event of the pin EXTI line, so the wait also
+ *         works with the interrupts disabled. The pin is polled when its EXTI line is already used by an interrupt.
+ *
+ * @param [in] pin   MCU pin to be waited on
+ * @param [in] value MCU pin state to be waited for
+ */
+void hal_gpio_wait_for_value( const hal_gpio_pin_names_t pin, const hal_gpio_state_t value );
+
 /*!
  * @brief Clears a pending irq on a pin
  *
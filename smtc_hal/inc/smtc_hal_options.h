@@ -75,6 +75,20 @@ extern "C" {
 #define HAL_USE_PRINTF_UART                         HAL_FEATURE_ON
 #define HAL_PRINT_BUFFER_SIZE                       255
 
+/* HAL_FEATURE_OFF to poll all the bulk SPI transfers */
+#ifndef HAL_SPI_USE_DMA
+#define HAL_SPI_USE_DMA                             HAL_FEATURE_ON
+#endif // HAL_SPI_USE_DMA
+
+/*!
+ * Minimum length in bytes of a bulk SPI transfer moved by the DMA
+ *
+ * @remark Shorter transfers are polled, as setting up the DMA takes longer than sending them
+ */
+#ifndef HAL_SPI_DMA_MIN_LENGTH
+#define HAL_SPI_DMA_MIN_LENGTH                      16
+#endif // HAL_SPI_DMA_MIN_LENGTH
+
 /* HAL_FEATURE_OFF to not use watchdog */
 #define HAL_USE_WATCHDOG                            HAL_FEATURE_ON
 
@@ -91,6 +91,19 @@ void hal_spi_deinit( const uint32_t id );
  */
 uint16_t hal_spi_in_out( const uint32_t id, const uint16_t out_data );
 
+/*!
+ * @brief Sends out_data and receives in_data, length bytes each
+ *
+ * @remark Transfers of at least HAL_SPI_DMA_MIN_LENGTH bytes are moved by the DMA, while the MCU sleeps, when
+ *         HAL_SPI_USE_DMA is on. The others are polled.
+ *
+ * @param [in]  id       SPI interface id [1:N]
+ * @param [in]  out_data Bytes to be sent, 0x00 are sent when NULL
+ * @param [out] in_data  Received bytes, discarded when NULL
+ * @param [in]  length   Number of bytes to be sent and received
+ */
+void hal_spi_transfer( const uint32_t id, const uint8_t* out_data, uint8_t* in_data, const uint16_t length );
+
 #ifdef __cplusplus
 }
 #endif